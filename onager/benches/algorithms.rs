@@ -0,0 +1,288 @@
+//! Benchmarks of graph builds and algorithms on generated and SNAP graphs.
+//!
+//! Every benchmark runs a few untimed warm-up passes and then a fixed number of
+//! timed samples, and the timings are written as one JSON document. Each sample
+//! is also profiled, so the report carries the iterations, threads, and peak
+//! memory of the algorithm besides its time.
+//!
+//! The run is configured with environment variables:
+//!
+//! * `ONAGER_BENCH_SIZES` - Comma-separated node counts of the generated graphs (default `1000,10000,100000`)
+//! * `ONAGER_BENCH_SAMPLES` - Timed samples per benchmark (default 5)
+//! * `ONAGER_BENCH_SNAP` - Comma-separated paths of SNAP edge lists to add to the generated graphs
+//! * `ONAGER_BENCH_FILTER` - Only run benchmarks whose `graph/benchmark` name contains this string
+//! * `ONAGER_BENCH_OUTPUT` - File to write the report to instead of stdout
+
+use std::error::Error;
+use std::time::Instant;
+
+use onager::algorithms::triangles::TriangleCensus;
+use onager::algorithms::{
+    compute_betweenness_csr, compute_bfs_csr, compute_degree_csr, compute_kcore_csr,
+    compute_louvain_parallel_csr, compute_pagerank_csr, generate_barabasi_albert,
+    generate_erdos_renyi, generate_watts_strogatz, GeneratorResult,
+};
+use onager::csr::CsrGraph;
+use onager::profile;
+use onager::workers::worker_count;
+use serde::Serialize;
+
+type BenchResult<T> = Result<T, Box<dyn Error>>;
+
+const SEED: u64 = 42;
+const WARMUP: usize = 1;
+const BETWEENNESS_SAMPLES: usize = 64;
+const PROFILE_CONNECTION: u64 = 0;
+
+#[derive(Serialize)]
+struct Report {
+    suite: &'static str,
+    samples: usize,
+    available_threads: usize,
+    results: Vec<Measurement>,
+}
+
+#[derive(Serialize)]
+struct Measurement {
+    graph: String,
+    nodes: usize,
+    edges: usize,
+    benchmark: &'static str,
+    phase: &'static str,
+    min_ns: u64,
+    median_ns: u64,
+    mean_ns: u64,
+    iterations: Option<i64>,
+    threads: u64,
+    peak_bytes: u64,
+}
+
+struct Input {
+    name: String,
+    src: Vec<i64>,
+    dst: Vec<i64>,
+}
+
+type Algorithm = fn(&CsrGraph) -> BenchResult<()>;
+
+const ALGORITHMS: &[(&str, Algorithm)] = &[
+    ("pagerank", |csr| {
+        compute_pagerank_csr(csr, 0.85, 100, 1e-6, &[])?;
+        Ok(())
+    }),
+    ("degree", |csr| {
+        compute_degree_csr(csr)?;
+        Ok(())
+    }),
+    ("triangles", |csr| {
+        TriangleCensus::from_csr(csr);
+        Ok(())
+    }),
+    ("kcore", |csr| {
+        compute_kcore_csr(csr)?;
+        Ok(())
+    }),
+    ("louvain", |csr| {
+        compute_louvain_parallel_csr(csr, Some(SEED))?;
+        Ok(())
+    }),
+    ("bfs", |csr| {
+        let source = csr.ids().first().copied().unwrap_or_default();
+        compute_bfs_csr(csr, source)?;
+        Ok(())
+    }),
+    ("betweenness_sampled", |csr| {
+        let samples = BETWEENNESS_SAMPLES.min(csr.node_count());
+        compute_betweenness_csr(csr, true, Some(samples), SEED)?;
+        Ok(())
+    }),
+];
+
+fn env_or<T: std::str::FromStr>(name: &str, default: T) -> BenchResult<T> {
+    match std::env::var(name) {
+        Ok(value) => value
+            .trim()
+            .parse()
+            .map_err(|_| format!("invalid value for {name}: {value}").into()),
+        Err(_) => Ok(default),
+    }
+}
+
+fn env_list(name: &str) -> Vec<String> {
+    std::env::var(name)
+        .map(|value| {
+            value
+                .split(',')
+                .map(str::trim)
+                .filter(|s| !s.is_empty())
+                .map(str::to_string)
+                .collect()
+        })
+        .unwrap_or_default()
+}
+
+fn generated(name: String, result: GeneratorResult) -> Input {
+    Input {
+        name,
+        src: result.src,
+        dst: result.dst,
+    }
+}
+
+fn generated_inputs(sizes: &[usize]) -> BenchResult<Vec<Input>> {
+    let mut inputs = Vec::new();
+    for &n in sizes {
+        inputs.push(generated(
+            format!("barabasi_albert_{n}"),
+            generate_barabasi_albert(n, 4.min(n), SEED)?,
+        ));
+        inputs.push(generated(
+            format!("erdos_renyi_{n}"),
+            generate_erdos_renyi(n, (8.0 / n as f64).min(1.0), SEED)?,
+        ));
+        if n > 8 {
+            inputs.push(generated(
+                format!("watts_strogatz_{n}"),
+                generate_watts_strogatz(n, 8, 0.1, SEED)?,
+            ));
+        }
+    }
+    Ok(inputs)
+}
+
+/// Reads a SNAP edge list: whitespace-separated node pairs, with `#` comment lines.
+fn snap_input(path: &str) -> BenchResult<Input> {
+    let text = std::fs::read_to_string(path).map_err(|e| format!("{path}: {e}"))?;
+    let mut src = Vec::new();
+    let mut dst = Vec::new();
+    for (line_no, line) in text.lines().enumerate() {
+        let line = line.trim();
+        if line.is_empty() || line.starts_with('#') {
+            continue;
+        }
+        let mut fields = line.split_whitespace();
+        match (fields.next(), fields.next()) {
+            (Some(u), Some(v)) => {
+                src.push(u.parse()?);
+                dst.push(v.parse()?);
+            }
+            _ => return Err(format!("{path}:{}: expected two node IDs", line_no + 1).into()),
+        }
+    }
+    let name = std::path::Path::new(path)
+        .file_stem()
+        .map(|s| s.to_string_lossy().into_owned())
+        .unwrap_or_else(|| path.to_string());
+    Ok(Input { name, src, dst })
+}
+
+/// Times `samples` runs of `f` after the warm-up, profiling each run.
+fn measure(samples: usize, mut f: impl FnMut() -> BenchResult<()>) -> BenchResult<Sample> {
+    for _ in 0..WARMUP {
+        f()?;
+    }
+    let mut times = Vec::with_capacity(samples);
+    let mut last = profile::OnagerProfile::default();
+    for _ in 0..samples {
+        profile::begin(PROFILE_CONNECTION, 0);
+        let started = Instant::now();
+        let outcome = f();
+        let elapsed = started.elapsed();
+        profile::finish();
+        outcome?;
+        times.push(u64::try_from(elapsed.as_nanos()).unwrap_or(u64::MAX));
+        if let Some((_, p)) = profile::last(PROFILE_CONNECTION) {
+            last = p;
+        }
+    }
+    times.sort_unstable();
+    let total: u128 = times.iter().map(|&t| u128::from(t)).sum();
+    Ok(Sample {
+        min_ns: times.first().copied().unwrap_or_default(),
+        median_ns: times.get(times.len() / 2).copied().unwrap_or_default(),
+        mean_ns: u64::try_from(total / times.len().max(1) as u128).unwrap_or(u64::MAX),
+        profile: last,
+    })
+}
+
+struct Sample {
+    min_ns: u64,
+    median_ns: u64,
+    mean_ns: u64,
+    profile: profile::OnagerProfile,
+}
+
+fn main() -> BenchResult<()> {
+    let sizes: Vec<usize> = match std::env::var("ONAGER_BENCH_SIZES") {
+        Ok(value) => value
+            .split(',')
+            .map(|s| s.trim().parse())
+            .collect::<Result<_, _>>()
+            .map_err(|_| format!("invalid value for ONAGER_BENCH_SIZES: {value}"))?,
+        Err(_) => vec![1_000, 10_000, 100_000],
+    };
+    let samples: usize = env_or("ONAGER_BENCH_SAMPLES", 5)?;
+    if samples == 0 {
+        return Err("ONAGER_BENCH_SAMPLES must be > 0".into());
+    }
+    let filter = std::env::var("ONAGER_BENCH_FILTER").unwrap_or_default();
+
+    let mut inputs = generated_inputs(&sizes)?;
+    for path in env_list("ONAGER_BENCH_SNAP") {
+        inputs.push(snap_input(&path)?);
+    }
+
+    let mut results = Vec::new();
+    for input in &inputs {
+        let csr = CsrGraph::from_edges(&input.src, &input.dst, None, false)?;
+        let mut record = |benchmark: &'static str, phase: &'static str, sample: Sample| {
+            eprintln!(
+                "{}/{benchmark}: median {:.3} ms",
+                input.name,
+                sample.median_ns as f64 / 1e6
+            );
+            results.push(Measurement {
+                graph: input.name.clone(),
+                nodes: csr.node_count(),
+                edges: input.src.len(),
+                benchmark,
+                phase,
+                min_ns: sample.min_ns,
+                median_ns: sample.median_ns,
+                mean_ns: sample.mean_ns,
+                iterations: (sample.profile.iterations >= 0).then_some(sample.profile.iterations),
+                threads: sample.profile.threads,
+                peak_bytes: sample.profile.peak_bytes,
+            });
+        };
+
+        if format!("{}/csr_build", input.name).contains(&filter) {
+            let sample = measure(samples, || {
+                CsrGraph::from_edges(&input.src, &input.dst, None, false)?;
+                Ok(())
+            })?;
+            record("csr_build", "build", sample);
+        }
+        for &(benchmark, run) in ALGORITHMS {
+            if !format!("{}/{benchmark}", input.name).contains(&filter) {
+                continue;
+            }
+            let sample = measure(samples, || run(&csr))?;
+            record(benchmark, "compute", sample);
+        }
+    }
+    profile::forget(PROFILE_CONNECTION);
+
+    let report = Report {
+        suite: "algorithms",
+        samples,
+        available_threads: worker_count(),
+        results,
+    };
+    let json = serde_json::to_string_pretty(&report)?;
+    match std::env::var("ONAGER_BENCH_OUTPUT") {
+        Ok(path) => std::fs::write(path, json + "\n")?,
+        Err(_) => println!("{json}"),
+    }
+    Ok(())
+}
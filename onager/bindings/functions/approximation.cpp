@@ -5,7 +5,6 @@
  * Maximum Clique, Independent Set, Vertex Cover approximations.
  */
 #include "functions.hpp"
-#include <mutex>
 
 namespace duckdb {
 
@@ -15,11 +14,9 @@ using namespace onager;
 // Maximum Clique Approximation
 // =============================================================================
 
-struct MaxCliqueGlobalState : public GlobalTableFunctionState {
-  std::mutex input_mutex;
-  std::vector<int64_t> src_nodes, dst_nodes, result_nodes;
+struct MaxCliqueGlobalState : public InputGlobalState {
+  OnagerResultHandle result;
   idx_t output_idx = 0; bool computed = false;
-  idx_t MaxThreads() const override { return 1; }
 };
 
 static unique_ptr<FunctionData> MaxCliqueBind(ClientContext &ctx, TableFunctionBindInput &input, vector<LogicalType> &rt, vector<string> &nm) {
@@ -28,42 +25,24 @@ static unique_ptr<FunctionData> MaxCliqueBind(ClientContext &ctx, TableFunctionB
   return make_uniq<TableFunctionData>();
 }
 static unique_ptr<GlobalTableFunctionState> MaxCliqueInitGlobal(ClientContext &ctx, TableFunctionInitInput &input) { return make_uniq<MaxCliqueGlobalState>(); }
-static OperatorResultType MaxCliqueInOut(ExecutionContext &ctx, TableFunctionInput &data, DataChunk &input, DataChunk &output) {
-  auto &gs = data.global_state->Cast<MaxCliqueGlobalState>();
-  std::lock_guard<std::mutex> lock(gs.input_mutex);
-  auto s = FlatVector::GetData<int64_t>(input.data[0]); auto d = FlatVector::GetData<int64_t>(input.data[1]);
-  for (idx_t i = 0; i < input.size(); i++) { gs.src_nodes.push_back(s[i]); gs.dst_nodes.push_back(d[i]); }
-  output.SetCardinality(0); return OperatorResultType::NEED_MORE_INPUT;
-}
 static OperatorFinalizeResultType MaxCliqueFinal(ExecutionContext &ctx, TableFunctionInput &data, DataChunk &output) {
   auto &gs = data.global_state->Cast<MaxCliqueGlobalState>();
-  std::lock_guard<std::mutex> lock(gs.input_mutex);
+  if (!FinishInput(ctx, data)) { output.SetCardinality(0); return OperatorFinalizeResultType::FINISHED; }
   if (!gs.computed) {
-    if (gs.src_nodes.empty()) { gs.computed = true; output.SetCardinality(0); return OperatorFinalizeResultType::FINISHED; }
-    int64_t nc = ::onager::onager_compute_max_clique(gs.src_nodes.data(), gs.dst_nodes.data(), gs.src_nodes.size(), nullptr);
-    if (nc < 0) throw InvalidInputException("Max clique failed: " + GetOnagerError());
-    gs.result_nodes.resize(nc);
-    ::onager::onager_compute_max_clique(gs.src_nodes.data(), gs.dst_nodes.data(), gs.src_nodes.size(), gs.result_nodes.data());
+    if (gs.input.Size() == 0) { gs.computed = true; output.SetCardinality(0); return OperatorFinalizeResultType::FINISHED; }
+    gs.result.Set(::onager::onager_compute_max_clique(gs.input.I64(0), gs.input.I64(1), gs.input.Size()), "Max clique");
     gs.computed = true;
   }
-  idx_t rem = gs.result_nodes.size() - gs.output_idx;
-  if (rem == 0) { output.SetCardinality(0); return OperatorFinalizeResultType::FINISHED; }
-  idx_t to = MinValue<idx_t>(rem, STANDARD_VECTOR_SIZE);
-  auto n = GetFlatVectorDataWritable<int64_t>(output.data[0]);
-  for (idx_t i = 0; i < to; i++) { n[i] = gs.result_nodes[gs.output_idx+i]; }
-  gs.output_idx += to; output.SetCardinality(to);
-  return gs.output_idx >= gs.result_nodes.size() ? OperatorFinalizeResultType::FINISHED : OperatorFinalizeResultType::HAVE_MORE_OUTPUT;
+  return EmitResultChunk(gs.result, gs.output_idx, output);
 }
 
 // =============================================================================
 // Independent Set Approximation
 // =============================================================================
 
-struct IndependentSetGlobalState : public GlobalTableFunctionState {
-  std::mutex input_mutex;
-  std::vector<int64_t> src_nodes, dst_nodes, result_nodes;
+struct IndependentSetGlobalState : public InputGlobalState {
+  OnagerResultHandle result;
   idx_t output_idx = 0; bool computed = false;
-  idx_t MaxThreads() const override { return 1; }
 };
 
 static unique_ptr<FunctionData> IndependentSetBind(ClientContext &ctx, TableFunctionBindInput &input, vector<LogicalType> &rt, vector<string> &nm) {
@@ -72,42 +51,24 @@ static unique_ptr<FunctionData> IndependentSetBind(ClientContext &ctx, TableFunc
   return make_uniq<TableFunctionData>();
 }
 static unique_ptr<GlobalTableFunctionState> IndependentSetInitGlobal(ClientContext &ctx, TableFunctionInitInput &input) { return make_uniq<IndependentSetGlobalState>(); }
-static OperatorResultType IndependentSetInOut(ExecutionContext &ctx, TableFunctionInput &data, DataChunk &input, DataChunk &output) {
-  auto &gs = data.global_state->Cast<IndependentSetGlobalState>();
-  std::lock_guard<std::mutex> lock(gs.input_mutex);
-  auto s = FlatVector::GetData<int64_t>(input.data[0]); auto d = FlatVector::GetData<int64_t>(input.data[1]);
-  for (idx_t i = 0; i < input.size(); i++) { gs.src_nodes.push_back(s[i]); gs.dst_nodes.push_back(d[i]); }
-  output.SetCardinality(0); return OperatorResultType::NEED_MORE_INPUT;
-}
 static OperatorFinalizeResultType IndependentSetFinal(ExecutionContext &ctx, TableFunctionInput &data, DataChunk &output) {
   auto &gs = data.global_state->Cast<IndependentSetGlobalState>();
-  std::lock_guard<std::mutex> lock(gs.input_mutex);
+  if (!FinishInput(ctx, data)) { output.SetCardinality(0); return OperatorFinalizeResultType::FINISHED; }
   if (!gs.computed) {
-    if (gs.src_nodes.empty()) { gs.computed = true; output.SetCardinality(0); return OperatorFinalizeResultType::FINISHED; }
-    int64_t nc = ::onager::onager_compute_independent_set(gs.src_nodes.data(), gs.dst_nodes.data(), gs.src_nodes.size(), nullptr);
-    if (nc < 0) throw InvalidInputException("Independent set failed: " + GetOnagerError());
-    gs.result_nodes.resize(nc);
-    ::onager::onager_compute_independent_set(gs.src_nodes.data(), gs.dst_nodes.data(), gs.src_nodes.size(), gs.result_nodes.data());
+    if (gs.input.Size() == 0) { gs.computed = true; output.SetCardinality(0); return OperatorFinalizeResultType::FINISHED; }
+    gs.result.Set(::onager::onager_compute_independent_set(gs.input.I64(0), gs.input.I64(1), gs.input.Size()), "Independent set");
     gs.computed = true;
   }
-  idx_t rem = gs.result_nodes.size() - gs.output_idx;
-  if (rem == 0) { output.SetCardinality(0); return OperatorFinalizeResultType::FINISHED; }
-  idx_t to = MinValue<idx_t>(rem, STANDARD_VECTOR_SIZE);
-  auto n = GetFlatVectorDataWritable<int64_t>(output.data[0]);
-  for (idx_t i = 0; i < to; i++) { n[i] = gs.result_nodes[gs.output_idx+i]; }
-  gs.output_idx += to; output.SetCardinality(to);
-  return gs.output_idx >= gs.result_nodes.size() ? OperatorFinalizeResultType::FINISHED : OperatorFinalizeResultType::HAVE_MORE_OUTPUT;
+  return EmitResultChunk(gs.result, gs.output_idx, output);
 }
 
 // =============================================================================
 // Vertex Cover Approximation
 // =============================================================================
 
-struct VertexCoverGlobalState : public GlobalTableFunctionState {
-  std::mutex input_mutex;
-  std::vector<int64_t> src_nodes, dst_nodes, result_nodes;
+struct VertexCoverGlobalState : public InputGlobalState {
+  OnagerResultHandle result;
   idx_t output_idx = 0; bool computed = false;
-  idx_t MaxThreads() const override { return 1; }
 };
 
 static unique_ptr<FunctionData> VertexCoverBind(ClientContext &ctx, TableFunctionBindInput &input, vector<LogicalType> &rt, vector<string> &nm) {
@@ -116,44 +77,24 @@ static unique_ptr<FunctionData> VertexCoverBind(ClientContext &ctx, TableFunctio
   return make_uniq<TableFunctionData>();
 }
 static unique_ptr<GlobalTableFunctionState> VertexCoverInitGlobal(ClientContext &ctx, TableFunctionInitInput &input) { return make_uniq<VertexCoverGlobalState>(); }
-static OperatorResultType VertexCoverInOut(ExecutionContext &ctx, TableFunctionInput &data, DataChunk &input, DataChunk &output) {
-  auto &gs = data.global_state->Cast<VertexCoverGlobalState>();
-  std::lock_guard<std::mutex> lock(gs.input_mutex);
-  auto s = FlatVector::GetData<int64_t>(input.data[0]); auto d = FlatVector::GetData<int64_t>(input.data[1]);
-  for (idx_t i = 0; i < input.size(); i++) { gs.src_nodes.push_back(s[i]); gs.dst_nodes.push_back(d[i]); }
-  output.SetCardinality(0); return OperatorResultType::NEED_MORE_INPUT;
-}
 static OperatorFinalizeResultType VertexCoverFinal(ExecutionContext &ctx, TableFunctionInput &data, DataChunk &output) {
   auto &gs = data.global_state->Cast<VertexCoverGlobalState>();
-  std::lock_guard<std::mutex> lock(gs.input_mutex);
+  if (!FinishInput(ctx, data)) { output.SetCardinality(0); return OperatorFinalizeResultType::FINISHED; }
   if (!gs.computed) {
-    if (gs.src_nodes.empty()) { gs.computed = true; output.SetCardinality(0); return OperatorFinalizeResultType::FINISHED; }
-    int64_t nc = ::onager::onager_compute_vertex_cover(gs.src_nodes.data(), gs.dst_nodes.data(), gs.src_nodes.size(), nullptr);
-    if (nc < 0) throw InvalidInputException("Vertex cover failed: " + GetOnagerError());
-    gs.result_nodes.resize(nc);
-    ::onager::onager_compute_vertex_cover(gs.src_nodes.data(), gs.dst_nodes.data(), gs.src_nodes.size(), gs.result_nodes.data());
+    if (gs.input.Size() == 0) { gs.computed = true; output.SetCardinality(0); return OperatorFinalizeResultType::FINISHED; }
+    gs.result.Set(::onager::onager_compute_vertex_cover(gs.input.I64(0), gs.input.I64(1), gs.input.Size()), "Vertex cover");
     gs.computed = true;
   }
-  idx_t rem = gs.result_nodes.size() - gs.output_idx;
-  if (rem == 0) { output.SetCardinality(0); return OperatorFinalizeResultType::FINISHED; }
-  idx_t to = MinValue<idx_t>(rem, STANDARD_VECTOR_SIZE);
-  auto n = GetFlatVectorDataWritable<int64_t>(output.data[0]);
-  for (idx_t i = 0; i < to; i++) { n[i] = gs.result_nodes[gs.output_idx+i]; }
-  gs.output_idx += to; output.SetCardinality(to);
-  return gs.output_idx >= gs.result_nodes.size() ? OperatorFinalizeResultType::FINISHED : OperatorFinalizeResultType::HAVE_MORE_OUTPUT;
+  return EmitResultChunk(gs.result, gs.output_idx, output);
 }
 
 // =============================================================================
 // TSP Approximation
 // =============================================================================
 
-struct TspGlobalState : public GlobalTableFunctionState {
-  std::mutex input_mutex;
-  std::vector<int64_t> src_nodes, dst_nodes, result_tour;
-  std::vector<double> weights;
-  double result_cost = 0.0;
+struct TspGlobalState : public InputGlobalState {
+  OnagerResultHandle result;
   idx_t output_idx = 0; bool computed = false;
-  idx_t MaxThreads() const override { return 1; }
 };
 
 static unique_ptr<FunctionData> TspBind(ClientContext &ctx, TableFunctionBindInput &input, vector<LogicalType> &rt, vector<string> &nm) {
@@ -163,34 +104,22 @@ static unique_ptr<FunctionData> TspBind(ClientContext &ctx, TableFunctionBindInp
   return make_uniq<TableFunctionData>();
 }
 static unique_ptr<GlobalTableFunctionState> TspInitGlobal(ClientContext &ctx, TableFunctionInitInput &input) { return make_uniq<TspGlobalState>(); }
-static OperatorResultType TspInOut(ExecutionContext &ctx, TableFunctionInput &data, DataChunk &input, DataChunk &output) {
-  auto &gs = data.global_state->Cast<TspGlobalState>();
-  std::lock_guard<std::mutex> lock(gs.input_mutex);
-  auto s = FlatVector::GetData<int64_t>(input.data[0]); auto d = FlatVector::GetData<int64_t>(input.data[1]);
-  auto w = FlatVector::GetData<double>(input.data[2]);
-  for (idx_t i = 0; i < input.size(); i++) {
-    gs.src_nodes.push_back(s[i]); gs.dst_nodes.push_back(d[i]); gs.weights.push_back(w[i]);
-  }
-  output.SetCardinality(0); return OperatorResultType::NEED_MORE_INPUT;
-}
 static OperatorFinalizeResultType TspFinal(ExecutionContext &ctx, TableFunctionInput &data, DataChunk &output) {
   auto &gs = data.global_state->Cast<TspGlobalState>();
-  std::lock_guard<std::mutex> lock(gs.input_mutex);
+  if (!FinishInput(ctx, data)) { output.SetCardinality(0); return OperatorFinalizeResultType::FINISHED; }
   if (!gs.computed) {
-    if (gs.src_nodes.empty()) { gs.computed = true; output.SetCardinality(0); return OperatorFinalizeResultType::FINISHED; }
-    int64_t nc = ::onager::onager_compute_tsp(gs.src_nodes.data(), gs.dst_nodes.data(), gs.weights.data(), gs.src_nodes.size(), nullptr, nullptr);
-    if (nc < 0) throw InvalidInputException("TSP failed: " + GetOnagerError());
-    gs.result_tour.resize(nc);
-    ::onager::onager_compute_tsp(gs.src_nodes.data(), gs.dst_nodes.data(), gs.weights.data(), gs.src_nodes.size(), gs.result_tour.data(), &gs.result_cost);
+    if (gs.input.Size() == 0) { gs.computed = true; output.SetCardinality(0); return OperatorFinalizeResultType::FINISHED; }
+    gs.result.Set(::onager::onager_compute_tsp(gs.input.I64(0), gs.input.I64(1), gs.input.F64(0), gs.input.Size()), "TSP");
     gs.computed = true;
   }
-  idx_t rem = gs.result_tour.size() - gs.output_idx;
+  idx_t rem = gs.result.Size() - gs.output_idx;
   if (rem == 0) { output.SetCardinality(0); return OperatorFinalizeResultType::FINISHED; }
   idx_t to = MinValue<idx_t>(rem, STANDARD_VECTOR_SIZE);
+  auto tour = gs.result.I64(0);
   auto ord = GetFlatVectorDataWritable<int64_t>(output.data[0]); auto n = GetFlatVectorDataWritable<int64_t>(output.data[1]);
-  for (idx_t i = 0; i < to; i++) { ord[i] = static_cast<int64_t>(gs.output_idx + i); n[i] = gs.result_tour[gs.output_idx+i]; }
+  for (idx_t i = 0; i < to; i++) { ord[i] = static_cast<int64_t>(gs.output_idx + i); n[i] = tour[gs.output_idx+i]; }
   gs.output_idx += to; output.SetCardinality(to);
-  return gs.output_idx >= gs.result_tour.size() ? OperatorFinalizeResultType::FINISHED : OperatorFinalizeResultType::HAVE_MORE_OUTPUT;
+  return gs.output_idx >= gs.result.Size() ? OperatorFinalizeResultType::FINISHED : OperatorFinalizeResultType::HAVE_MORE_OUTPUT;
 }
 
 // =============================================================================
@@ -201,25 +130,29 @@ namespace onager {
 
 void RegisterApproximationFunctions(ExtensionLoader &loader) {
   TableFunction max_clique("onager_apx_max_clique", {LogicalType::TABLE}, nullptr, MaxCliqueBind, MaxCliqueInitGlobal);
-  max_clique.in_out_function = MaxCliqueInOut;
+  max_clique.in_out_function = CollectInput;
+  max_clique.init_local = InitInputLocal<2>;
   max_clique.in_out_function_final = MaxCliqueFinal;
   ONAGER_SET_NO_ORDER(max_clique);
   loader.RegisterFunction(max_clique);
 
   TableFunction independent_set("onager_apx_independent_set", {LogicalType::TABLE}, nullptr, IndependentSetBind, IndependentSetInitGlobal);
-  independent_set.in_out_function = IndependentSetInOut;
+  independent_set.in_out_function = CollectInput;
+  independent_set.init_local = InitInputLocal<2>;
   independent_set.in_out_function_final = IndependentSetFinal;
   ONAGER_SET_NO_ORDER(independent_set);
   loader.RegisterFunction(independent_set);
 
   TableFunction vertex_cover("onager_apx_vertex_cover", {LogicalType::TABLE}, nullptr, VertexCoverBind, VertexCoverInitGlobal);
-  vertex_cover.in_out_function = VertexCoverInOut;
+  vertex_cover.in_out_function = CollectInput;
+  vertex_cover.init_local = InitInputLocal<2>;
   vertex_cover.in_out_function_final = VertexCoverFinal;
   ONAGER_SET_NO_ORDER(vertex_cover);
   loader.RegisterFunction(vertex_cover);
 
   TableFunction tsp("onager_apx_tsp", {LogicalType::TABLE}, nullptr, TspBind, TspInitGlobal);
-  tsp.in_out_function = TspInOut;
+  tsp.in_out_function = CollectInput;
+  tsp.init_local = InitInputLocal<2, 1>;
   tsp.in_out_function_final = TspFinal;
   ONAGER_SET_NO_ORDER(tsp);
   loader.RegisterFunction(tsp);
@@ -5,7 +5,6 @@
  * PageRank, Degree, Betweenness, Closeness, Eigenvector, Katz, Harmonic.
  */
 #include "functions.hpp"
-#include <mutex>
 
 namespace duckdb {
 
@@ -15,290 +14,254 @@ using namespace onager;
 // PageRank Table Function
 // =============================================================================
 
-struct PageRankBindData : public TableFunctionData {
+struct PageRankBindData : public GraphBindData {
   double damping = 0.85;
   int64_t iterations = 100;
+  double tolerance = 1e-6;
   bool directed = true;
+  bool prior = false;
+  WeightColumn weights;
 };
 
-struct PageRankGlobalState : public GlobalTableFunctionState {
-  std::mutex input_mutex;
-  std::vector<int64_t> src_nodes;
-  std::vector<int64_t> dst_nodes;
-  std::vector<int64_t> result_nodes;
-  std::vector<double> result_ranks;
+struct PageRankGlobalState : public InputGlobalState {
+  OnagerResultHandle result;
+  OutputLayout layout;
   idx_t output_idx = 0;
   bool computed = false;
-  idx_t MaxThreads() const override { return 1; }
 };
 
-
+// With graph := 'name', an input table of (node_id, rank) rows from an earlier
+// run seeds the starting vector, which cuts the passes needed after small edits.
 static unique_ptr<FunctionData> PageRankBind(ClientContext &context,
                                               TableFunctionBindInput &input,
                                               vector<LogicalType> &return_types,
                                               vector<string> &names) {
   auto bind_data = make_uniq<PageRankBindData>();
-  CheckInt64Input(input, "onager_pagerank");
+  if (!BindGraphName(input, bind_data->graph)) {
+    CheckInt64Input(input, "onager_pagerank");
+    bind_data->weights.Bind(input);
+  } else if (!input.input_table_types.empty()) {
+    if (input.input_table_types.size() != 2 || input.input_table_types[0] != LogicalType::BIGINT || input.input_table_types[1] != LogicalType::DOUBLE) {
+      throw InvalidInputException("onager_ctr_pagerank with graph requires prior (node_id BIGINT, rank DOUBLE) columns. Please cast them (e.g. rank::double)");
+    }
+    bind_data->prior = true;
+  }
   for (auto &kv : input.named_parameters) {
     if (kv.first == "damping") bind_data->damping = kv.second.GetValue<double>();
     else if (kv.first == "iterations") bind_data->iterations = kv.second.GetValue<int64_t>();
+    else if (kv.first == "tolerance") bind_data->tolerance = kv.second.GetValue<double>();
     else if (kv.first == "directed") bind_data->directed = kv.second.GetValue<bool>();
   }
   return_types.push_back(LogicalType::BIGINT); names.push_back("node_id");
   return_types.push_back(LogicalType::DOUBLE); names.push_back("rank");
+  return_types.push_back(LogicalType::BIGINT); names.push_back("iterations");
+  SetPushdownSchema(bind_data->pushdown, return_types, {0});
   return std::move(bind_data);
 }
 
 static unique_ptr<GlobalTableFunctionState> PageRankInitGlobal(ClientContext &context, TableFunctionInitInput &input) {
-  return make_uniq<PageRankGlobalState>();
+  auto gs = make_uniq<PageRankGlobalState>();
+  gs->layout.Init(input.column_ids, input.bind_data->Cast<PageRankBindData>().pushdown.schema);
+  return std::move(gs);
 }
 
-static OperatorResultType PageRankInOut(ExecutionContext &context, TableFunctionInput &data,
-                                         DataChunk &input, DataChunk &output) {
-  auto &gs = data.global_state->Cast<PageRankGlobalState>();
-  std::lock_guard<std::mutex> lock(gs.input_mutex);
-  auto src = FlatVector::GetData<int64_t>(input.data[0]);
-  auto dst = FlatVector::GetData<int64_t>(input.data[1]);
-  for (idx_t i = 0; i < input.size(); i++) {
-    gs.src_nodes.push_back(src[i]);
-    gs.dst_nodes.push_back(dst[i]);
-  }
-  output.SetCardinality(0);
-  return OperatorResultType::NEED_MORE_INPUT;
+static unique_ptr<LocalTableFunctionState> PageRankInitLocal(ExecutionContext &context, TableFunctionInitInput &input, GlobalTableFunctionState *global_state) {
+  auto &bind = input.bind_data->Cast<PageRankBindData>();
+  return bind.prior ? MakeInputLocal(global_state, 1, 1) : bind.weights.MakeLocal(global_state);
 }
 
 static OperatorFinalizeResultType PageRankFinal(ExecutionContext &context, TableFunctionInput &data, DataChunk &output) {
   auto &bind = data.bind_data->Cast<PageRankBindData>();
   auto &gs = data.global_state->Cast<PageRankGlobalState>();
-  std::lock_guard<std::mutex> lock(gs.input_mutex);
+  if (!FinishInput(context, data, bind.prior)) { output.SetCardinality(0); return OperatorFinalizeResultType::FINISHED; }
   if (!gs.computed) {
-    if (gs.src_nodes.empty()) { gs.computed = true; output.SetCardinality(0); return OperatorFinalizeResultType::FINISHED; }
-    size_t ec = gs.src_nodes.size();
-    int64_t nc = ::onager::onager_compute_pagerank(gs.src_nodes.data(), gs.dst_nodes.data(), ec,
-        bind.damping, static_cast<size_t>(bind.iterations), bind.directed, nullptr, nullptr);
-    if (nc < 0) throw InvalidInputException("PageRank failed: " + GetOnagerError());
-    gs.result_nodes.resize(static_cast<size_t>(nc)); gs.result_ranks.resize(static_cast<size_t>(nc));
-    ::onager::onager_compute_pagerank(gs.src_nodes.data(), gs.dst_nodes.data(), ec,
-        bind.damping, static_cast<size_t>(bind.iterations), bind.directed, gs.result_nodes.data(), gs.result_ranks.data());
+    if (bind.prior) {
+      gs.result.Set(::onager::onager_graph_compute_pagerank(bind.graph.c_str(), bind.damping, static_cast<size_t>(bind.iterations), bind.tolerance, gs.input.I64(0), gs.input.F64(0), gs.input.Size()), "PageRank");
+      ApplyNodeFilters(gs.result, bind.pushdown);
+      gs.computed = true;
+      return gs.layout.Emit(gs.result, gs.output_idx, output);
+    }
+    if (gs.input.Size() == 0) { gs.computed = true; output.SetCardinality(0); return OperatorFinalizeResultType::FINISHED; }
+    size_t ec = gs.input.Size();
+    gs.result.Set(::onager::onager_compute_pagerank(gs.input.I64(0), gs.input.I64(1), ec, bind.weights.Data(gs.input), bind.weights.Size(gs.input), bind.damping, static_cast<size_t>(bind.iterations), bind.tolerance, bind.directed), "PageRank");
+    ApplyNodeFilters(gs.result, bind.pushdown);
     gs.computed = true;
   }
-  idx_t rem = gs.result_nodes.size() - gs.output_idx;
-  if (rem == 0) { output.SetCardinality(0); return OperatorFinalizeResultType::FINISHED; }
-  idx_t to = MinValue<idx_t>(rem, STANDARD_VECTOR_SIZE);
-  auto ndata = GetFlatVectorDataWritable<int64_t>(output.data[0]);
-  auto rdata = GetFlatVectorDataWritable<double>(output.data[1]);
-  for (idx_t i = 0; i < to; i++) { ndata[i] = gs.result_nodes[gs.output_idx+i]; rdata[i] = gs.result_ranks[gs.output_idx+i]; }
-  gs.output_idx += to; output.SetCardinality(to);
-  return gs.output_idx >= gs.result_nodes.size() ? OperatorFinalizeResultType::FINISHED : OperatorFinalizeResultType::HAVE_MORE_OUTPUT;
+  return gs.layout.Emit(gs.result, gs.output_idx, output);
+}
+static void PageRankGraphScan(ClientContext &ctx, TableFunctionInput &data, DataChunk &output) {
+  auto &bd = data.bind_data->Cast<PageRankBindData>();
+  EmitGraphResult(ctx, data, output, "PageRank", [&](const char *graph) { return ::onager::onager_graph_compute_pagerank(graph, bd.damping, static_cast<size_t>(bd.iterations), bd.tolerance, nullptr, nullptr, 0); });
 }
 
 // =============================================================================
 // Degree Centrality Table Function
 // =============================================================================
 
-struct DegreeBindData : public TableFunctionData { bool directed = true; };
-struct DegreeGlobalState : public GlobalTableFunctionState {
-  std::mutex input_mutex;
-  std::vector<int64_t> src_nodes, dst_nodes, result_nodes;
-  std::vector<double> result_in, result_out;
+struct DegreeBindData : public GraphBindData { bool directed = true; };
+struct DegreeGlobalState : public InputGlobalState {
+  OnagerResultHandle result;
+  OutputLayout layout;
   idx_t output_idx = 0; bool computed = false;
-  idx_t MaxThreads() const override { return 1; }
 };
 
 static unique_ptr<FunctionData> DegreeBind(ClientContext &ctx, TableFunctionBindInput &input, vector<LogicalType> &rt, vector<string> &nm) {
   auto bd = make_uniq<DegreeBindData>();
-  CheckInt64Input(input, "onager_degree");
+  if (!BindGraphName(input, bd->graph)) CheckInt64Input(input, "onager_degree");
   for (auto &kv : input.named_parameters) if (kv.first == "directed") bd->directed = kv.second.GetValue<bool>();
   rt.push_back(LogicalType::BIGINT); nm.push_back("node_id");
   rt.push_back(LogicalType::DOUBLE); nm.push_back("in_degree");
   rt.push_back(LogicalType::DOUBLE); nm.push_back("out_degree");
+  SetPushdownSchema(bd->pushdown, rt, {0});
   return std::move(bd);
 }
-static unique_ptr<GlobalTableFunctionState> DegreeInitGlobal(ClientContext &ctx, TableFunctionInitInput &input) { return make_uniq<DegreeGlobalState>(); }
-static OperatorResultType DegreeInOut(ExecutionContext &ctx, TableFunctionInput &data, DataChunk &input, DataChunk &output) {
-  auto &gs = data.global_state->Cast<DegreeGlobalState>();
-  std::lock_guard<std::mutex> lock(gs.input_mutex);
-  auto s = FlatVector::GetData<int64_t>(input.data[0]); auto d = FlatVector::GetData<int64_t>(input.data[1]);
-  for (idx_t i = 0; i < input.size(); i++) { gs.src_nodes.push_back(s[i]); gs.dst_nodes.push_back(d[i]); }
-  output.SetCardinality(0); return OperatorResultType::NEED_MORE_INPUT;
+static unique_ptr<GlobalTableFunctionState> DegreeInitGlobal(ClientContext &ctx, TableFunctionInitInput &input) {
+  auto gs = make_uniq<DegreeGlobalState>();
+  gs->layout.Init(input.column_ids, input.bind_data->Cast<DegreeBindData>().pushdown.schema);
+  return std::move(gs);
 }
 static OperatorFinalizeResultType DegreeFinal(ExecutionContext &ctx, TableFunctionInput &data, DataChunk &output) {
   auto &bd = data.bind_data->Cast<DegreeBindData>(); auto &gs = data.global_state->Cast<DegreeGlobalState>();
-  std::lock_guard<std::mutex> lock(gs.input_mutex);
+  if (!FinishInput(ctx, data)) { output.SetCardinality(0); return OperatorFinalizeResultType::FINISHED; }
   if (!gs.computed) {
-    if (gs.src_nodes.empty()) { gs.computed = true; output.SetCardinality(0); return OperatorFinalizeResultType::FINISHED; }
-    int64_t nc = ::onager::onager_compute_degree(gs.src_nodes.data(), gs.dst_nodes.data(), gs.src_nodes.size(), bd.directed, nullptr, nullptr, nullptr);
-    if (nc < 0) throw InvalidInputException("Degree failed: " + GetOnagerError());
-    gs.result_nodes.resize(nc); gs.result_in.resize(nc); gs.result_out.resize(nc);
-    ::onager::onager_compute_degree(gs.src_nodes.data(), gs.dst_nodes.data(), gs.src_nodes.size(), bd.directed, gs.result_nodes.data(), gs.result_in.data(), gs.result_out.data());
+    if (gs.input.Size() == 0) { gs.computed = true; output.SetCardinality(0); return OperatorFinalizeResultType::FINISHED; }
+    gs.result.Set(::onager::onager_compute_degree(gs.input.I64(0), gs.input.I64(1), gs.input.Size(), bd.directed), "Degree");
+    ApplyNodeFilters(gs.result, bd.pushdown);
     gs.computed = true;
   }
-  idx_t rem = gs.result_nodes.size() - gs.output_idx;
-  if (rem == 0) { output.SetCardinality(0); return OperatorFinalizeResultType::FINISHED; }
-  idx_t to = MinValue<idx_t>(rem, STANDARD_VECTOR_SIZE);
-  auto n = GetFlatVectorDataWritable<int64_t>(output.data[0]); auto id = GetFlatVectorDataWritable<double>(output.data[1]); auto od = GetFlatVectorDataWritable<double>(output.data[2]);
-  for (idx_t i = 0; i < to; i++) { n[i] = gs.result_nodes[gs.output_idx+i]; id[i] = gs.result_in[gs.output_idx+i]; od[i] = gs.result_out[gs.output_idx+i]; }
-  gs.output_idx += to; output.SetCardinality(to);
-  return gs.output_idx >= gs.result_nodes.size() ? OperatorFinalizeResultType::FINISHED : OperatorFinalizeResultType::HAVE_MORE_OUTPUT;
+  return gs.layout.Emit(gs.result, gs.output_idx, output);
+}
+static void DegreeGraphScan(ClientContext &ctx, TableFunctionInput &data, DataChunk &output) {
+  EmitGraphResult(ctx, data, output, "Degree", [](const char *graph) { return ::onager::onager_graph_compute_degree(graph); });
 }
 
 // =============================================================================
 // Betweenness Centrality Table Function
 // =============================================================================
 
-struct BetweennessBindData : public TableFunctionData { bool normalized = true; };
-struct BetweennessGlobalState : public GlobalTableFunctionState {
-  std::mutex input_mutex;
-  std::vector<int64_t> src_nodes, dst_nodes, result_nodes;
-  std::vector<double> result_centralities;
+struct BetweennessBindData : public GraphBindData { bool normalized = true; int64_t samples = 0; int64_t seed = 42; WeightColumn weights; };
+struct BetweennessGlobalState : public InputGlobalState {
+  OnagerResultHandle result;
   idx_t output_idx = 0; bool computed = false;
-  idx_t MaxThreads() const override { return 1; }
 };
 
 static unique_ptr<FunctionData> BetweennessBind(ClientContext &ctx, TableFunctionBindInput &input, vector<LogicalType> &rt, vector<string> &nm) {
   auto bd = make_uniq<BetweennessBindData>();
-  CheckInt64Input(input, "onager_betweenness");
-  for (auto &kv : input.named_parameters) if (kv.first == "normalized") bd->normalized = kv.second.GetValue<bool>();
+  if (!BindGraphName(input, bd->graph)) {
+    CheckInt64Input(input, "onager_betweenness");
+    bd->weights.Bind(input);
+  }
+  for (auto &kv : input.named_parameters) {
+    if (kv.first == "normalized") bd->normalized = kv.second.GetValue<bool>();
+    else if (kv.first == "samples") bd->samples = kv.second.GetValue<int64_t>();
+    else if (kv.first == "seed") bd->seed = kv.second.GetValue<int64_t>();
+  }
+  if (input.named_parameters.count("samples") && bd->samples <= 0) throw InvalidInputException("onager_betweenness requires samples > 0");
   rt.push_back(LogicalType::BIGINT); nm.push_back("node_id");
   rt.push_back(LogicalType::DOUBLE); nm.push_back("betweenness");
   return std::move(bd);
 }
 static unique_ptr<GlobalTableFunctionState> BetweennessInitGlobal(ClientContext &ctx, TableFunctionInitInput &input) { return make_uniq<BetweennessGlobalState>(); }
-static OperatorResultType BetweennessInOut(ExecutionContext &ctx, TableFunctionInput &data, DataChunk &input, DataChunk &output) {
-  auto &gs = data.global_state->Cast<BetweennessGlobalState>();
-  std::lock_guard<std::mutex> lock(gs.input_mutex);
-  auto s = FlatVector::GetData<int64_t>(input.data[0]); auto d = FlatVector::GetData<int64_t>(input.data[1]);
-  for (idx_t i = 0; i < input.size(); i++) { gs.src_nodes.push_back(s[i]); gs.dst_nodes.push_back(d[i]); }
-  output.SetCardinality(0); return OperatorResultType::NEED_MORE_INPUT;
+static unique_ptr<LocalTableFunctionState> BetweennessInitLocal(ExecutionContext &ctx, TableFunctionInitInput &input, GlobalTableFunctionState *global_state) {
+  return input.bind_data->Cast<BetweennessBindData>().weights.MakeLocal(global_state);
 }
 static OperatorFinalizeResultType BetweennessFinal(ExecutionContext &ctx, TableFunctionInput &data, DataChunk &output) {
   auto &bd = data.bind_data->Cast<BetweennessBindData>(); auto &gs = data.global_state->Cast<BetweennessGlobalState>();
-  std::lock_guard<std::mutex> lock(gs.input_mutex);
+  if (!FinishInput(ctx, data)) { output.SetCardinality(0); return OperatorFinalizeResultType::FINISHED; }
   if (!gs.computed) {
-    if (gs.src_nodes.empty()) { gs.computed = true; output.SetCardinality(0); return OperatorFinalizeResultType::FINISHED; }
-    int64_t nc = ::onager::onager_compute_betweenness(gs.src_nodes.data(), gs.dst_nodes.data(), gs.src_nodes.size(), bd.normalized, nullptr, nullptr);
-    if (nc < 0) throw InvalidInputException("Betweenness failed: " + GetOnagerError());
-    gs.result_nodes.resize(nc); gs.result_centralities.resize(nc);
-    ::onager::onager_compute_betweenness(gs.src_nodes.data(), gs.dst_nodes.data(), gs.src_nodes.size(), bd.normalized, gs.result_nodes.data(), gs.result_centralities.data());
+    if (gs.input.Size() == 0) { gs.computed = true; output.SetCardinality(0); return OperatorFinalizeResultType::FINISHED; }
+    gs.result.Set(::onager::onager_compute_betweenness(gs.input.I64(0), gs.input.I64(1), gs.input.Size(), bd.weights.Data(gs.input), bd.weights.Size(gs.input), bd.normalized, static_cast<size_t>(bd.samples), static_cast<uint64_t>(bd.seed)), "Betweenness");
     gs.computed = true;
   }
-  idx_t rem = gs.result_nodes.size() - gs.output_idx;
-  if (rem == 0) { output.SetCardinality(0); return OperatorFinalizeResultType::FINISHED; }
-  idx_t to = MinValue<idx_t>(rem, STANDARD_VECTOR_SIZE);
-  auto n = GetFlatVectorDataWritable<int64_t>(output.data[0]); auto c = GetFlatVectorDataWritable<double>(output.data[1]);
-  for (idx_t i = 0; i < to; i++) { n[i] = gs.result_nodes[gs.output_idx+i]; c[i] = gs.result_centralities[gs.output_idx+i]; }
-  gs.output_idx += to; output.SetCardinality(to);
-  return gs.output_idx >= gs.result_nodes.size() ? OperatorFinalizeResultType::FINISHED : OperatorFinalizeResultType::HAVE_MORE_OUTPUT;
+  return EmitResultChunk(gs.result, gs.output_idx, output);
+}
+static void BetweennessGraphScan(ClientContext &ctx, TableFunctionInput &data, DataChunk &output) {
+  auto &bd = data.bind_data->Cast<BetweennessBindData>();
+  EmitGraphResult(ctx, data, output, "Betweenness", [&](const char *graph) { return ::onager::onager_graph_compute_betweenness(graph, bd.normalized, static_cast<size_t>(bd.samples), static_cast<uint64_t>(bd.seed)); });
 }
 
 // =============================================================================
 // Closeness Centrality Table Function
 // =============================================================================
 
-struct ClosenessGlobalState : public GlobalTableFunctionState {
-  std::mutex input_mutex;
-  std::vector<int64_t> src_nodes, dst_nodes, result_nodes;
-  std::vector<double> result_centralities;
+struct ClosenessBindData : public GraphBindData { WeightColumn weights; };
+struct ClosenessGlobalState : public InputGlobalState {
+  OnagerResultHandle result;
   idx_t output_idx = 0; bool computed = false;
-  idx_t MaxThreads() const override { return 1; }
 };
 
 static unique_ptr<FunctionData> ClosenessBind(ClientContext &ctx, TableFunctionBindInput &input, vector<LogicalType> &rt, vector<string> &nm) {
-  CheckInt64Input(input, "onager_closeness");
+  auto bd = make_uniq<ClosenessBindData>();
+  if (!BindGraphName(input, bd->graph)) {
+    CheckInt64Input(input, "onager_closeness");
+    bd->weights.Bind(input);
+  }
   rt.push_back(LogicalType::BIGINT); nm.push_back("node_id");
   rt.push_back(LogicalType::DOUBLE); nm.push_back("closeness");
-  return make_uniq<TableFunctionData>();
+  return std::move(bd);
 }
 static unique_ptr<GlobalTableFunctionState> ClosenessInitGlobal(ClientContext &ctx, TableFunctionInitInput &input) { return make_uniq<ClosenessGlobalState>(); }
-static OperatorResultType ClosenessInOut(ExecutionContext &ctx, TableFunctionInput &data, DataChunk &input, DataChunk &output) {
-  auto &gs = data.global_state->Cast<ClosenessGlobalState>();
-  std::lock_guard<std::mutex> lock(gs.input_mutex);
-  auto s = FlatVector::GetData<int64_t>(input.data[0]); auto d = FlatVector::GetData<int64_t>(input.data[1]);
-  for (idx_t i = 0; i < input.size(); i++) { gs.src_nodes.push_back(s[i]); gs.dst_nodes.push_back(d[i]); }
-  output.SetCardinality(0); return OperatorResultType::NEED_MORE_INPUT;
+static unique_ptr<LocalTableFunctionState> ClosenessInitLocal(ExecutionContext &ctx, TableFunctionInitInput &input, GlobalTableFunctionState *global_state) {
+  return input.bind_data->Cast<ClosenessBindData>().weights.MakeLocal(global_state);
 }
 static OperatorFinalizeResultType ClosenessFinal(ExecutionContext &ctx, TableFunctionInput &data, DataChunk &output) {
-  auto &gs = data.global_state->Cast<ClosenessGlobalState>();
-  std::lock_guard<std::mutex> lock(gs.input_mutex);
+  auto &bd = data.bind_data->Cast<ClosenessBindData>(); auto &gs = data.global_state->Cast<ClosenessGlobalState>();
+  if (!FinishInput(ctx, data)) { output.SetCardinality(0); return OperatorFinalizeResultType::FINISHED; }
   if (!gs.computed) {
-    if (gs.src_nodes.empty()) { gs.computed = true; output.SetCardinality(0); return OperatorFinalizeResultType::FINISHED; }
-    int64_t nc = ::onager::onager_compute_closeness(gs.src_nodes.data(), gs.dst_nodes.data(), gs.src_nodes.size(), nullptr, nullptr);
-    if (nc < 0) throw InvalidInputException("Closeness failed: " + GetOnagerError());
-    gs.result_nodes.resize(nc); gs.result_centralities.resize(nc);
-    ::onager::onager_compute_closeness(gs.src_nodes.data(), gs.dst_nodes.data(), gs.src_nodes.size(), gs.result_nodes.data(), gs.result_centralities.data());
+    if (gs.input.Size() == 0) { gs.computed = true; output.SetCardinality(0); return OperatorFinalizeResultType::FINISHED; }
+    gs.result.Set(::onager::onager_compute_closeness(gs.input.I64(0), gs.input.I64(1), gs.input.Size(), bd.weights.Data(gs.input), bd.weights.Size(gs.input)), "Closeness");
     gs.computed = true;
   }
-  idx_t rem = gs.result_nodes.size() - gs.output_idx;
-  if (rem == 0) { output.SetCardinality(0); return OperatorFinalizeResultType::FINISHED; }
-  idx_t to = MinValue<idx_t>(rem, STANDARD_VECTOR_SIZE);
-  auto n = GetFlatVectorDataWritable<int64_t>(output.data[0]); auto c = GetFlatVectorDataWritable<double>(output.data[1]);
-  for (idx_t i = 0; i < to; i++) { n[i] = gs.result_nodes[gs.output_idx+i]; c[i] = gs.result_centralities[gs.output_idx+i]; }
-  gs.output_idx += to; output.SetCardinality(to);
-  return gs.output_idx >= gs.result_nodes.size() ? OperatorFinalizeResultType::FINISHED : OperatorFinalizeResultType::HAVE_MORE_OUTPUT;
+  return EmitResultChunk(gs.result, gs.output_idx, output);
+}
+static void ClosenessGraphScan(ClientContext &ctx, TableFunctionInput &data, DataChunk &output) {
+  EmitGraphResult(ctx, data, output, "Closeness", [](const char *graph) { return ::onager::onager_graph_compute_closeness(graph); });
 }
 
 // =============================================================================
 // Harmonic Centrality Table Function
 // =============================================================================
 
-struct HarmonicGlobalState : public GlobalTableFunctionState {
-  std::mutex input_mutex;
-  std::vector<int64_t> src_nodes, dst_nodes, result_nodes;
-  std::vector<double> result_centralities;
+struct HarmonicGlobalState : public InputGlobalState {
+  OnagerResultHandle result;
   idx_t output_idx = 0; bool computed = false;
-  idx_t MaxThreads() const override { return 1; }
 };
 
 static unique_ptr<FunctionData> HarmonicBind(ClientContext &ctx, TableFunctionBindInput &input, vector<LogicalType> &rt, vector<string> &nm) {
-  CheckInt64Input(input, "onager_harmonic");
+  auto bd = make_uniq<GraphBindData>();
+  if (!BindGraphName(input, bd->graph)) CheckInt64Input(input, "onager_harmonic");
   rt.push_back(LogicalType::BIGINT); nm.push_back("node_id");
   rt.push_back(LogicalType::DOUBLE); nm.push_back("harmonic");
-  return make_uniq<TableFunctionData>();
+  return std::move(bd);
 }
 static unique_ptr<GlobalTableFunctionState> HarmonicInitGlobal(ClientContext &ctx, TableFunctionInitInput &input) { return make_uniq<HarmonicGlobalState>(); }
-static OperatorResultType HarmonicInOut(ExecutionContext &ctx, TableFunctionInput &data, DataChunk &input, DataChunk &output) {
-  auto &gs = data.global_state->Cast<HarmonicGlobalState>();
-  std::lock_guard<std::mutex> lock(gs.input_mutex);
-  auto s = FlatVector::GetData<int64_t>(input.data[0]); auto d = FlatVector::GetData<int64_t>(input.data[1]);
-  for (idx_t i = 0; i < input.size(); i++) { gs.src_nodes.push_back(s[i]); gs.dst_nodes.push_back(d[i]); }
-  output.SetCardinality(0); return OperatorResultType::NEED_MORE_INPUT;
-}
 static OperatorFinalizeResultType HarmonicFinal(ExecutionContext &ctx, TableFunctionInput &data, DataChunk &output) {
   auto &gs = data.global_state->Cast<HarmonicGlobalState>();
-  std::lock_guard<std::mutex> lock(gs.input_mutex);
+  if (!FinishInput(ctx, data)) { output.SetCardinality(0); return OperatorFinalizeResultType::FINISHED; }
   if (!gs.computed) {
-    if (gs.src_nodes.empty()) { gs.computed = true; output.SetCardinality(0); return OperatorFinalizeResultType::FINISHED; }
-    int64_t nc = ::onager::onager_compute_harmonic(gs.src_nodes.data(), gs.dst_nodes.data(), gs.src_nodes.size(), nullptr, nullptr);
-    if (nc < 0) throw InvalidInputException("Harmonic failed: " + GetOnagerError());
-    gs.result_nodes.resize(nc); gs.result_centralities.resize(nc);
-    ::onager::onager_compute_harmonic(gs.src_nodes.data(), gs.dst_nodes.data(), gs.src_nodes.size(), gs.result_nodes.data(), gs.result_centralities.data());
+    if (gs.input.Size() == 0) { gs.computed = true; output.SetCardinality(0); return OperatorFinalizeResultType::FINISHED; }
+    gs.result.Set(::onager::onager_compute_harmonic(gs.input.I64(0), gs.input.I64(1), gs.input.Size()), "Harmonic");
     gs.computed = true;
   }
-  idx_t rem = gs.result_nodes.size() - gs.output_idx;
-  if (rem == 0) { output.SetCardinality(0); return OperatorFinalizeResultType::FINISHED; }
-  idx_t to = MinValue<idx_t>(rem, STANDARD_VECTOR_SIZE);
-  auto n = GetFlatVectorDataWritable<int64_t>(output.data[0]); auto c = GetFlatVectorDataWritable<double>(output.data[1]);
-  for (idx_t i = 0; i < to; i++) { n[i] = gs.result_nodes[gs.output_idx+i]; c[i] = gs.result_centralities[gs.output_idx+i]; }
-  gs.output_idx += to; output.SetCardinality(to);
-  return gs.output_idx >= gs.result_nodes.size() ? OperatorFinalizeResultType::FINISHED : OperatorFinalizeResultType::HAVE_MORE_OUTPUT;
+  return EmitResultChunk(gs.result, gs.output_idx, output);
+}
+static void HarmonicGraphScan(ClientContext &ctx, TableFunctionInput &data, DataChunk &output) {
+  EmitGraphResult(ctx, data, output, "Harmonic", [](const char *graph) { return ::onager::onager_graph_compute_harmonic(graph); });
 }
 
 // =============================================================================
 // Katz Centrality Table Function
 // =============================================================================
 
-struct KatzBindData : public TableFunctionData { double alpha = 0.1; int64_t max_iter = 100; double tolerance = 1e-6; };
-struct KatzGlobalState : public GlobalTableFunctionState {
-  std::mutex input_mutex;
-  std::vector<int64_t> src_nodes, dst_nodes, result_nodes;
-  std::vector<double> result_centralities;
+struct KatzBindData : public GraphBindData { double alpha = 0.1; int64_t max_iter = 100; double tolerance = 1e-6; };
+struct KatzGlobalState : public InputGlobalState {
+  OnagerResultHandle result;
   idx_t output_idx = 0; bool computed = false;
-  idx_t MaxThreads() const override { return 1; }
 };
 
 static unique_ptr<FunctionData> KatzBind(ClientContext &ctx, TableFunctionBindInput &input, vector<LogicalType> &rt, vector<string> &nm) {
   auto bd = make_uniq<KatzBindData>();
-  CheckInt64Input(input, "onager_katz");
+  if (!BindGraphName(input, bd->graph)) CheckInt64Input(input, "onager_katz");
   for (auto &kv : input.named_parameters) {
     if (kv.first == "alpha") bd->alpha = kv.second.GetValue<double>();
     if (kv.first == "max_iter") bd->max_iter = kv.second.GetValue<int64_t>();
@@ -309,49 +272,34 @@ static unique_ptr<FunctionData> KatzBind(ClientContext &ctx, TableFunctionBindIn
   return std::move(bd);
 }
 static unique_ptr<GlobalTableFunctionState> KatzInitGlobal(ClientContext &ctx, TableFunctionInitInput &input) { return make_uniq<KatzGlobalState>(); }
-static OperatorResultType KatzInOut(ExecutionContext &ctx, TableFunctionInput &data, DataChunk &input, DataChunk &output) {
-  auto &gs = data.global_state->Cast<KatzGlobalState>();
-  std::lock_guard<std::mutex> lock(gs.input_mutex);
-  auto s = FlatVector::GetData<int64_t>(input.data[0]); auto d = FlatVector::GetData<int64_t>(input.data[1]);
-  for (idx_t i = 0; i < input.size(); i++) { gs.src_nodes.push_back(s[i]); gs.dst_nodes.push_back(d[i]); }
-  output.SetCardinality(0); return OperatorResultType::NEED_MORE_INPUT;
-}
 static OperatorFinalizeResultType KatzFinal(ExecutionContext &ctx, TableFunctionInput &data, DataChunk &output) {
   auto &bd = data.bind_data->Cast<KatzBindData>(); auto &gs = data.global_state->Cast<KatzGlobalState>();
-  std::lock_guard<std::mutex> lock(gs.input_mutex);
+  if (!FinishInput(ctx, data)) { output.SetCardinality(0); return OperatorFinalizeResultType::FINISHED; }
   if (!gs.computed) {
-    if (gs.src_nodes.empty()) { gs.computed = true; output.SetCardinality(0); return OperatorFinalizeResultType::FINISHED; }
-    int64_t nc = ::onager::onager_compute_katz(gs.src_nodes.data(), gs.dst_nodes.data(), gs.src_nodes.size(), bd.alpha, bd.max_iter, bd.tolerance, nullptr, nullptr);
-    if (nc < 0) throw InvalidInputException("Katz failed: " + GetOnagerError());
-    gs.result_nodes.resize(nc); gs.result_centralities.resize(nc);
-    ::onager::onager_compute_katz(gs.src_nodes.data(), gs.dst_nodes.data(), gs.src_nodes.size(), bd.alpha, bd.max_iter, bd.tolerance, gs.result_nodes.data(), gs.result_centralities.data());
+    if (gs.input.Size() == 0) { gs.computed = true; output.SetCardinality(0); return OperatorFinalizeResultType::FINISHED; }
+    gs.result.Set(::onager::onager_compute_katz(gs.input.I64(0), gs.input.I64(1), gs.input.Size(), bd.alpha, bd.max_iter, bd.tolerance), "Katz");
     gs.computed = true;
   }
-  idx_t rem = gs.result_nodes.size() - gs.output_idx;
-  if (rem == 0) { output.SetCardinality(0); return OperatorFinalizeResultType::FINISHED; }
-  idx_t to = MinValue<idx_t>(rem, STANDARD_VECTOR_SIZE);
-  auto n = GetFlatVectorDataWritable<int64_t>(output.data[0]); auto c = GetFlatVectorDataWritable<double>(output.data[1]);
-  for (idx_t i = 0; i < to; i++) { n[i] = gs.result_nodes[gs.output_idx+i]; c[i] = gs.result_centralities[gs.output_idx+i]; }
-  gs.output_idx += to; output.SetCardinality(to);
-  return gs.output_idx >= gs.result_nodes.size() ? OperatorFinalizeResultType::FINISHED : OperatorFinalizeResultType::HAVE_MORE_OUTPUT;
+  return EmitResultChunk(gs.result, gs.output_idx, output);
+}
+static void KatzGraphScan(ClientContext &ctx, TableFunctionInput &data, DataChunk &output) {
+  auto &bd = data.bind_data->Cast<KatzBindData>();
+  EmitGraphResult(ctx, data, output, "Katz", [&](const char *graph) { return ::onager::onager_graph_compute_katz(graph, bd.alpha, bd.max_iter, bd.tolerance); });
 }
 
 // =============================================================================
 // Eigenvector Centrality Table Function
 // =============================================================================
 
-struct EigenvectorBindData : public TableFunctionData { int64_t max_iter = 100; double tolerance = 1e-6; };
-struct EigenvectorGlobalState : public GlobalTableFunctionState {
-  std::mutex input_mutex;
-  std::vector<int64_t> src_nodes, dst_nodes, result_nodes;
-  std::vector<double> result_centralities;
+struct EigenvectorBindData : public GraphBindData { int64_t max_iter = 100; double tolerance = 1e-6; };
+struct EigenvectorGlobalState : public InputGlobalState {
+  OnagerResultHandle result;
   idx_t output_idx = 0; bool computed = false;
-  idx_t MaxThreads() const override { return 1; }
 };
 
 static unique_ptr<FunctionData> EigenvectorBind(ClientContext &ctx, TableFunctionBindInput &input, vector<LogicalType> &rt, vector<string> &nm) {
   auto bd = make_uniq<EigenvectorBindData>();
-  CheckInt64Input(input, "onager_eigenvector");
+  if (!BindGraphName(input, bd->graph)) CheckInt64Input(input, "onager_eigenvector");
   for (auto &kv : input.named_parameters) {
     if (kv.first == "max_iter") bd->max_iter = kv.second.GetValue<int64_t>();
     if (kv.first == "tolerance") bd->tolerance = kv.second.GetValue<double>();
@@ -361,31 +309,19 @@ static unique_ptr<FunctionData> EigenvectorBind(ClientContext &ctx, TableFunctio
   return std::move(bd);
 }
 static unique_ptr<GlobalTableFunctionState> EigenvectorInitGlobal(ClientContext &ctx, TableFunctionInitInput &input) { return make_uniq<EigenvectorGlobalState>(); }
-static OperatorResultType EigenvectorInOut(ExecutionContext &ctx, TableFunctionInput &data, DataChunk &input, DataChunk &output) {
-  auto &gs = data.global_state->Cast<EigenvectorGlobalState>();
-  std::lock_guard<std::mutex> lock(gs.input_mutex);
-  auto s = FlatVector::GetData<int64_t>(input.data[0]); auto d = FlatVector::GetData<int64_t>(input.data[1]);
-  for (idx_t i = 0; i < input.size(); i++) { gs.src_nodes.push_back(s[i]); gs.dst_nodes.push_back(d[i]); }
-  output.SetCardinality(0); return OperatorResultType::NEED_MORE_INPUT;
-}
 static OperatorFinalizeResultType EigenvectorFinal(ExecutionContext &ctx, TableFunctionInput &data, DataChunk &output) {
   auto &bd = data.bind_data->Cast<EigenvectorBindData>(); auto &gs = data.global_state->Cast<EigenvectorGlobalState>();
-  std::lock_guard<std::mutex> lock(gs.input_mutex);
+  if (!FinishInput(ctx, data)) { output.SetCardinality(0); return OperatorFinalizeResultType::FINISHED; }
   if (!gs.computed) {
-    if (gs.src_nodes.empty()) { gs.computed = true; output.SetCardinality(0); return OperatorFinalizeResultType::FINISHED; }
-    int64_t nc = ::onager::onager_compute_eigenvector(gs.src_nodes.data(), gs.dst_nodes.data(), gs.src_nodes.size(), bd.max_iter, bd.tolerance, nullptr, nullptr);
-    if (nc < 0) throw InvalidInputException("Eigenvector failed: " + GetOnagerError());
-    gs.result_nodes.resize(nc); gs.result_centralities.resize(nc);
-    ::onager::onager_compute_eigenvector(gs.src_nodes.data(), gs.dst_nodes.data(), gs.src_nodes.size(), bd.max_iter, bd.tolerance, gs.result_nodes.data(), gs.result_centralities.data());
+    if (gs.input.Size() == 0) { gs.computed = true; output.SetCardinality(0); return OperatorFinalizeResultType::FINISHED; }
+    gs.result.Set(::onager::onager_compute_eigenvector(gs.input.I64(0), gs.input.I64(1), gs.input.Size(), bd.max_iter, bd.tolerance), "Eigenvector");
     gs.computed = true;
   }
-  idx_t rem = gs.result_nodes.size() - gs.output_idx;
-  if (rem == 0) { output.SetCardinality(0); return OperatorFinalizeResultType::FINISHED; }
-  idx_t to = MinValue<idx_t>(rem, STANDARD_VECTOR_SIZE);
-  auto n = GetFlatVectorDataWritable<int64_t>(output.data[0]); auto c = GetFlatVectorDataWritable<double>(output.data[1]);
-  for (idx_t i = 0; i < to; i++) { n[i] = gs.result_nodes[gs.output_idx+i]; c[i] = gs.result_centralities[gs.output_idx+i]; }
-  gs.output_idx += to; output.SetCardinality(to);
-  return gs.output_idx >= gs.result_nodes.size() ? OperatorFinalizeResultType::FINISHED : OperatorFinalizeResultType::HAVE_MORE_OUTPUT;
+  return EmitResultChunk(gs.result, gs.output_idx, output);
+}
+static void EigenvectorGraphScan(ClientContext &ctx, TableFunctionInput &data, DataChunk &output) {
+  auto &bd = data.bind_data->Cast<EigenvectorBindData>();
+  EmitGraphResult(ctx, data, output, "Eigenvector", [&](const char *graph) { return ::onager::onager_graph_compute_eigenvector(graph, bd.max_iter, bd.tolerance); });
 }
 
 // =============================================================================
@@ -396,56 +332,69 @@ namespace onager {
 
 void RegisterCentralityFunctions(ExtensionLoader &loader) {
   TableFunction pagerank("onager_ctr_pagerank", {LogicalType::TABLE}, nullptr, PageRankBind, PageRankInitGlobal);
-  pagerank.in_out_function = PageRankInOut;
+  pagerank.in_out_function = CollectInput;
+  pagerank.init_local = PageRankInitLocal;
   pagerank.in_out_function_final = PageRankFinal;
   pagerank.named_parameters["damping"] = LogicalType::DOUBLE;
   pagerank.named_parameters["iterations"] = LogicalType::BIGINT;
+  pagerank.named_parameters["tolerance"] = LogicalType::DOUBLE;
+  pagerank.named_parameters["graph"] = LogicalType::VARCHAR;
   pagerank.named_parameters["directed"] = LogicalType::BOOLEAN;
+  EnablePushdown(pagerank);
   ONAGER_SET_NO_ORDER(pagerank);
-  loader.RegisterFunction(pagerank);
+  RegisterWithGraphOverload(loader, pagerank, PageRankGraphScan);
 
   TableFunction degree("onager_ctr_degree", {LogicalType::TABLE}, nullptr, DegreeBind, DegreeInitGlobal);
-  degree.in_out_function = DegreeInOut;
+  degree.in_out_function = CollectInput;
+  degree.init_local = InitInputLocal<2>;
   degree.in_out_function_final = DegreeFinal;
   degree.named_parameters["directed"] = LogicalType::BOOLEAN;
+  EnablePushdown(degree);
   ONAGER_SET_NO_ORDER(degree);
-  loader.RegisterFunction(degree);
+  RegisterWithGraphOverload(loader, degree, DegreeGraphScan);
 
   TableFunction betweenness("onager_ctr_betweenness", {LogicalType::TABLE}, nullptr, BetweennessBind, BetweennessInitGlobal);
-  betweenness.in_out_function = BetweennessInOut;
+  betweenness.in_out_function = CollectInput;
+  betweenness.init_local = BetweennessInitLocal;
   betweenness.in_out_function_final = BetweennessFinal;
   betweenness.named_parameters["normalized"] = LogicalType::BOOLEAN;
+  betweenness.named_parameters["samples"] = LogicalType::BIGINT;
+  betweenness.named_parameters["seed"] = LogicalType::BIGINT;
   ONAGER_SET_NO_ORDER(betweenness);
-  loader.RegisterFunction(betweenness);
+  RegisterWithGraphOverload(loader, betweenness, BetweennessGraphScan);
 
   TableFunction closeness("onager_ctr_closeness", {LogicalType::TABLE}, nullptr, ClosenessBind, ClosenessInitGlobal);
-  closeness.in_out_function = ClosenessInOut;
+  closeness.in_out_function = CollectInput;
+  closeness.init_local = ClosenessInitLocal;
   closeness.in_out_function_final = ClosenessFinal;
   ONAGER_SET_NO_ORDER(closeness);
-  loader.RegisterFunction(closeness);
+  RegisterWithGraphOverload(loader, closeness, ClosenessGraphScan);
 
   TableFunction harmonic("onager_ctr_harmonic", {LogicalType::TABLE}, nullptr, HarmonicBind, HarmonicInitGlobal);
-  harmonic.in_out_function = HarmonicInOut;
+  harmonic.in_out_function = CollectInput;
+  harmonic.init_local = InitInputLocal<2>;
   harmonic.in_out_function_final = HarmonicFinal;
   ONAGER_SET_NO_ORDER(harmonic);
-  loader.RegisterFunction(harmonic);
+  RegisterWithGraphOverload(loader, harmonic, HarmonicGraphScan);
 
   TableFunction katz("onager_ctr_katz", {LogicalType::TABLE}, nullptr, KatzBind, KatzInitGlobal);
-  katz.in_out_function = KatzInOut;
+  katz.in_out_function = CollectInput;
+  katz.init_local = InitInputLocal<2>;
   katz.in_out_function_final = KatzFinal;
   katz.named_parameters["alpha"] = LogicalType::DOUBLE;
   katz.named_parameters["max_iter"] = LogicalType::BIGINT;
   katz.named_parameters["tolerance"] = LogicalType::DOUBLE;
   ONAGER_SET_NO_ORDER(katz);
-  loader.RegisterFunction(katz);
+  RegisterWithGraphOverload(loader, katz, KatzGraphScan);
 
   TableFunction eigenvector("onager_ctr_eigenvector", {LogicalType::TABLE}, nullptr, EigenvectorBind, EigenvectorInitGlobal);
-  eigenvector.in_out_function = EigenvectorInOut;
+  eigenvector.in_out_function = CollectInput;
+  eigenvector.init_local = InitInputLocal<2>;
   eigenvector.in_out_function_final = EigenvectorFinal;
   eigenvector.named_parameters["max_iter"] = LogicalType::BIGINT;
   eigenvector.named_parameters["tolerance"] = LogicalType::DOUBLE;
   ONAGER_SET_NO_ORDER(eigenvector);
-  loader.RegisterFunction(eigenvector);
+  RegisterWithGraphOverload(loader, eigenvector, EigenvectorGraphScan);
 }
 
 // Forward declare VoteRank registration (defined at end of file)
@@ -468,11 +417,9 @@ namespace duckdb {
 using namespace onager;
 
 struct VoteRankBindData : public TableFunctionData { int64_t num_seeds = 10; };
-struct VoteRankGlobalState : public GlobalTableFunctionState {
-  std::mutex input_mutex;
-  std::vector<int64_t> src_nodes, dst_nodes, result_nodes;
+struct VoteRankGlobalState : public InputGlobalState {
+  OnagerResultHandle result;
   idx_t output_idx = 0; bool computed = false;
-  idx_t MaxThreads() const override { return 1; }
 };
 
 static unique_ptr<FunctionData> VoteRankBind(ClientContext &ctx, TableFunctionBindInput &input, vector<LogicalType> &rt, vector<string> &nm) {
@@ -485,38 +432,23 @@ static unique_ptr<FunctionData> VoteRankBind(ClientContext &ctx, TableFunctionBi
   return std::move(bd);
 }
 static unique_ptr<GlobalTableFunctionState> VoteRankInitGlobal(ClientContext &ctx, TableFunctionInitInput &input) { return make_uniq<VoteRankGlobalState>(); }
-static OperatorResultType VoteRankInOut(ExecutionContext &ctx, TableFunctionInput &data, DataChunk &input, DataChunk &output) {
-  auto &gs = data.global_state->Cast<VoteRankGlobalState>();
-  std::lock_guard<std::mutex> lock(gs.input_mutex);
-  auto s = FlatVector::GetData<int64_t>(input.data[0]); auto d = FlatVector::GetData<int64_t>(input.data[1]);
-  for (idx_t i = 0; i < input.size(); i++) { gs.src_nodes.push_back(s[i]); gs.dst_nodes.push_back(d[i]); }
-  output.SetCardinality(0); return OperatorResultType::NEED_MORE_INPUT;
-}
 static OperatorFinalizeResultType VoteRankFinal(ExecutionContext &ctx, TableFunctionInput &data, DataChunk &output) {
   auto &bd = data.bind_data->Cast<VoteRankBindData>(); auto &gs = data.global_state->Cast<VoteRankGlobalState>();
-  std::lock_guard<std::mutex> lock(gs.input_mutex);
+  if (!FinishInput(ctx, data)) { output.SetCardinality(0); return OperatorFinalizeResultType::FINISHED; }
   if (!gs.computed) {
-    if (gs.src_nodes.empty()) { gs.computed = true; output.SetCardinality(0); return OperatorFinalizeResultType::FINISHED; }
-    int64_t nc = ::onager::onager_compute_voterank(gs.src_nodes.data(), gs.dst_nodes.data(), gs.src_nodes.size(), bd.num_seeds, nullptr);
-    if (nc < 0) throw InvalidInputException("VoteRank failed: " + GetOnagerError());
-    gs.result_nodes.resize(nc);
-    ::onager::onager_compute_voterank(gs.src_nodes.data(), gs.dst_nodes.data(), gs.src_nodes.size(), bd.num_seeds, gs.result_nodes.data());
+    if (gs.input.Size() == 0) { gs.computed = true; output.SetCardinality(0); return OperatorFinalizeResultType::FINISHED; }
+    gs.result.Set(::onager::onager_compute_voterank(gs.input.I64(0), gs.input.I64(1), gs.input.Size(), bd.num_seeds), "VoteRank");
     gs.computed = true;
   }
-  idx_t rem = gs.result_nodes.size() - gs.output_idx;
-  if (rem == 0) { output.SetCardinality(0); return OperatorFinalizeResultType::FINISHED; }
-  idx_t to = MinValue<idx_t>(rem, STANDARD_VECTOR_SIZE);
-  auto n = GetFlatVectorDataWritable<int64_t>(output.data[0]);
-  for (idx_t i = 0; i < to; i++) { n[i] = gs.result_nodes[gs.output_idx+i]; }
-  gs.output_idx += to; output.SetCardinality(to);
-  return gs.output_idx >= gs.result_nodes.size() ? OperatorFinalizeResultType::FINISHED : OperatorFinalizeResultType::HAVE_MORE_OUTPUT;
+  return EmitResultChunk(gs.result, gs.output_idx, output);
 }
 
 namespace onager {
 // Register VoteRank separately to avoid restructuring entire file
 void RegisterVoteRankFunction(ExtensionLoader &loader) {
   TableFunction voterank("onager_ctr_voterank", {LogicalType::TABLE}, nullptr, VoteRankBind, VoteRankInitGlobal);
-  voterank.in_out_function = VoteRankInOut;
+  voterank.in_out_function = CollectInput;
+  voterank.init_local = InitInputLocal<2>;
   voterank.in_out_function_final = VoteRankFinal;
   voterank.named_parameters["num_seeds"] = LogicalType::BIGINT;
   ONAGER_SET_NO_ORDER(voterank);
@@ -533,12 +465,9 @@ namespace duckdb {
 using namespace onager;
 
 struct LocalReachingBindData : public TableFunctionData { int64_t distance = 2; };
-struct LocalReachingGlobalState : public GlobalTableFunctionState {
-  std::mutex input_mutex;
-  std::vector<int64_t> src_nodes, dst_nodes, result_nodes;
-  std::vector<double> result_centrality;
+struct LocalReachingGlobalState : public InputGlobalState {
+  OnagerResultHandle result;
   idx_t output_idx = 0; bool computed = false;
-  idx_t MaxThreads() const override { return 1; }
 };
 
 static unique_ptr<FunctionData> LocalReachingBind(ClientContext &ctx, TableFunctionBindInput &input, vector<LogicalType> &rt, vector<string> &nm) {
@@ -552,43 +481,24 @@ static unique_ptr<FunctionData> LocalReachingBind(ClientContext &ctx, TableFunct
   return std::move(bd);
 }
 static unique_ptr<GlobalTableFunctionState> LocalReachingInitGlobal(ClientContext &ctx, TableFunctionInitInput &input) { return make_uniq<LocalReachingGlobalState>(); }
-static OperatorResultType LocalReachingInOut(ExecutionContext &ctx, TableFunctionInput &data, DataChunk &input, DataChunk &output) {
-  auto &gs = data.global_state->Cast<LocalReachingGlobalState>();
-  std::lock_guard<std::mutex> lock(gs.input_mutex);
-  auto s = FlatVector::GetData<int64_t>(input.data[0]); auto d = FlatVector::GetData<int64_t>(input.data[1]);
-  for (idx_t i = 0; i < input.size(); i++) { gs.src_nodes.push_back(s[i]); gs.dst_nodes.push_back(d[i]); }
-  output.SetCardinality(0); return OperatorResultType::NEED_MORE_INPUT;
-}
 static OperatorFinalizeResultType LocalReachingFinal(ExecutionContext &ctx, TableFunctionInput &data, DataChunk &output) {
   auto &bd = data.bind_data->Cast<LocalReachingBindData>(); auto &gs = data.global_state->Cast<LocalReachingGlobalState>();
-  std::lock_guard<std::mutex> lock(gs.input_mutex);
+  if (!FinishInput(ctx, data)) { output.SetCardinality(0); return OperatorFinalizeResultType::FINISHED; }
   if (!gs.computed) {
-    if (gs.src_nodes.empty()) { gs.computed = true; output.SetCardinality(0); return OperatorFinalizeResultType::FINISHED; }
-    int64_t nc = ::onager::onager_compute_local_reaching(gs.src_nodes.data(), gs.dst_nodes.data(), gs.src_nodes.size(), bd.distance, nullptr, nullptr);
-    if (nc < 0) throw InvalidInputException("LocalReaching failed: " + GetOnagerError());
-    gs.result_nodes.resize(nc); gs.result_centrality.resize(nc);
-    ::onager::onager_compute_local_reaching(gs.src_nodes.data(), gs.dst_nodes.data(), gs.src_nodes.size(), bd.distance, gs.result_nodes.data(), gs.result_centrality.data());
+    if (gs.input.Size() == 0) { gs.computed = true; output.SetCardinality(0); return OperatorFinalizeResultType::FINISHED; }
+    gs.result.Set(::onager::onager_compute_local_reaching(gs.input.I64(0), gs.input.I64(1), gs.input.Size(), bd.distance), "LocalReaching");
     gs.computed = true;
   }
-  idx_t rem = gs.result_nodes.size() - gs.output_idx;
-  if (rem == 0) { output.SetCardinality(0); return OperatorFinalizeResultType::FINISHED; }
-  idx_t to = MinValue<idx_t>(rem, STANDARD_VECTOR_SIZE);
-  auto n = GetFlatVectorDataWritable<int64_t>(output.data[0]); auto c = GetFlatVectorDataWritable<double>(output.data[1]);
-  for (idx_t i = 0; i < to; i++) { n[i] = gs.result_nodes[gs.output_idx+i]; c[i] = gs.result_centrality[gs.output_idx+i]; }
-  gs.output_idx += to; output.SetCardinality(to);
-  return gs.output_idx >= gs.result_nodes.size() ? OperatorFinalizeResultType::FINISHED : OperatorFinalizeResultType::HAVE_MORE_OUTPUT;
+  return EmitResultChunk(gs.result, gs.output_idx, output);
 }
 
 // =============================================================================
 // Laplacian Centrality Table Function
 // =============================================================================
 
-struct LaplacianGlobalState : public GlobalTableFunctionState {
-  std::mutex input_mutex;
-  std::vector<int64_t> src_nodes, dst_nodes, result_nodes;
-  std::vector<double> result_centrality;
+struct LaplacianGlobalState : public InputGlobalState {
+  OnagerResultHandle result;
   idx_t output_idx = 0; bool computed = false;
-  idx_t MaxThreads() const override { return 1; }
 };
 
 static unique_ptr<FunctionData> LaplacianBind(ClientContext &ctx, TableFunctionBindInput &input, vector<LogicalType> &rt, vector<string> &nm) {
@@ -598,37 +508,22 @@ static unique_ptr<FunctionData> LaplacianBind(ClientContext &ctx, TableFunctionB
   return make_uniq<TableFunctionData>();
 }
 static unique_ptr<GlobalTableFunctionState> LaplacianInitGlobal(ClientContext &ctx, TableFunctionInitInput &input) { return make_uniq<LaplacianGlobalState>(); }
-static OperatorResultType LaplacianInOut(ExecutionContext &ctx, TableFunctionInput &data, DataChunk &input, DataChunk &output) {
-  auto &gs = data.global_state->Cast<LaplacianGlobalState>();
-  std::lock_guard<std::mutex> lock(gs.input_mutex);
-  auto s = FlatVector::GetData<int64_t>(input.data[0]); auto d = FlatVector::GetData<int64_t>(input.data[1]);
-  for (idx_t i = 0; i < input.size(); i++) { gs.src_nodes.push_back(s[i]); gs.dst_nodes.push_back(d[i]); }
-  output.SetCardinality(0); return OperatorResultType::NEED_MORE_INPUT;
-}
 static OperatorFinalizeResultType LaplacianFinal(ExecutionContext &ctx, TableFunctionInput &data, DataChunk &output) {
   auto &gs = data.global_state->Cast<LaplacianGlobalState>();
-  std::lock_guard<std::mutex> lock(gs.input_mutex);
+  if (!FinishInput(ctx, data)) { output.SetCardinality(0); return OperatorFinalizeResultType::FINISHED; }
   if (!gs.computed) {
-    if (gs.src_nodes.empty()) { gs.computed = true; output.SetCardinality(0); return OperatorFinalizeResultType::FINISHED; }
-    int64_t nc = ::onager::onager_compute_laplacian(gs.src_nodes.data(), gs.dst_nodes.data(), gs.src_nodes.size(), nullptr, nullptr);
-    if (nc < 0) throw InvalidInputException("Laplacian failed: " + GetOnagerError());
-    gs.result_nodes.resize(nc); gs.result_centrality.resize(nc);
-    ::onager::onager_compute_laplacian(gs.src_nodes.data(), gs.dst_nodes.data(), gs.src_nodes.size(), gs.result_nodes.data(), gs.result_centrality.data());
+    if (gs.input.Size() == 0) { gs.computed = true; output.SetCardinality(0); return OperatorFinalizeResultType::FINISHED; }
+    gs.result.Set(::onager::onager_compute_laplacian(gs.input.I64(0), gs.input.I64(1), gs.input.Size()), "Laplacian");
     gs.computed = true;
   }
-  idx_t rem = gs.result_nodes.size() - gs.output_idx;
-  if (rem == 0) { output.SetCardinality(0); return OperatorFinalizeResultType::FINISHED; }
-  idx_t to = MinValue<idx_t>(rem, STANDARD_VECTOR_SIZE);
-  auto n = GetFlatVectorDataWritable<int64_t>(output.data[0]); auto c = GetFlatVectorDataWritable<double>(output.data[1]);
-  for (idx_t i = 0; i < to; i++) { n[i] = gs.result_nodes[gs.output_idx+i]; c[i] = gs.result_centrality[gs.output_idx+i]; }
-  gs.output_idx += to; output.SetCardinality(to);
-  return gs.output_idx >= gs.result_nodes.size() ? OperatorFinalizeResultType::FINISHED : OperatorFinalizeResultType::HAVE_MORE_OUTPUT;
+  return EmitResultChunk(gs.result, gs.output_idx, output);
 }
 
 namespace onager {
 void RegisterLocalReachingFunction(ExtensionLoader &loader) {
   TableFunction lr("onager_ctr_local_reaching", {LogicalType::TABLE}, nullptr, LocalReachingBind, LocalReachingInitGlobal);
-  lr.in_out_function = LocalReachingInOut;
+  lr.in_out_function = CollectInput;
+  lr.init_local = InitInputLocal<2>;
   lr.in_out_function_final = LocalReachingFinal;
   lr.named_parameters["distance"] = LogicalType::BIGINT;
   ONAGER_SET_NO_ORDER(lr);
@@ -636,7 +531,8 @@ void RegisterLocalReachingFunction(ExtensionLoader &loader) {
 }
 void RegisterLaplacianFunction(ExtensionLoader &loader) {
   TableFunction lap("onager_ctr_laplacian", {LogicalType::TABLE}, nullptr, LaplacianBind, LaplacianInitGlobal);
-  lap.in_out_function = LaplacianInOut;
+  lap.in_out_function = CollectInput;
+  lap.init_local = InitInputLocal<2>;
   lap.in_out_function_final = LaplacianFinal;
   ONAGER_SET_NO_ORDER(lap);
   loader.RegisterFunction(lap);
@@ -2,10 +2,9 @@
  * @file community.cpp
  * @brief Community detection table functions for Onager DuckDB extension.
  *
- * Louvain, Connected Components, Label Propagation, Girvan-Newman.
+ * Louvain, Connected Components, Label Propagation, Girvan-Newman, K-Core.
  */
 #include "functions.hpp"
-#include <mutex>
 
 namespace duckdb {
 
@@ -15,138 +14,102 @@ using namespace onager;
 // Louvain Community Detection
 // =============================================================================
 
-struct LouvainBindData : public TableFunctionData { int64_t seed = -1; };
-struct LouvainGlobalState : public GlobalTableFunctionState {
-  std::mutex input_mutex;
-  std::vector<int64_t> src_nodes, dst_nodes, result_nodes, result_communities;
+struct LouvainBindData : public GraphBindData { int64_t seed = -1; WeightColumn weights; };
+struct LouvainGlobalState : public InputGlobalState {
+  OnagerResultHandle result;
   idx_t output_idx = 0; bool computed = false;
-  idx_t MaxThreads() const override { return 1; }
 };
 
 static unique_ptr<FunctionData> LouvainBind(ClientContext &ctx, TableFunctionBindInput &input, vector<LogicalType> &rt, vector<string> &nm) {
   auto bd = make_uniq<LouvainBindData>();
-  CheckInt64Input(input, "onager_cmm_louvain");
+  if (!BindGraphName(input, bd->graph)) {
+    CheckInt64Input(input, "onager_cmm_louvain");
+    bd->weights.Bind(input);
+  }
   for (auto &kv : input.named_parameters) if (kv.first == "seed") bd->seed = kv.second.GetValue<int64_t>();
   rt.push_back(LogicalType::BIGINT); nm.push_back("node_id");
   rt.push_back(LogicalType::BIGINT); nm.push_back("community");
   return std::move(bd);
 }
 static unique_ptr<GlobalTableFunctionState> LouvainInitGlobal(ClientContext &ctx, TableFunctionInitInput &input) { return make_uniq<LouvainGlobalState>(); }
-static OperatorResultType LouvainInOut(ExecutionContext &ctx, TableFunctionInput &data, DataChunk &input, DataChunk &output) {
-  auto &gs = data.global_state->Cast<LouvainGlobalState>();
-  std::lock_guard<std::mutex> lock(gs.input_mutex);
-  auto s = FlatVector::GetData<int64_t>(input.data[0]); auto d = FlatVector::GetData<int64_t>(input.data[1]);
-  for (idx_t i = 0; i < input.size(); i++) { gs.src_nodes.push_back(s[i]); gs.dst_nodes.push_back(d[i]); }
-  output.SetCardinality(0); return OperatorResultType::NEED_MORE_INPUT;
+static unique_ptr<LocalTableFunctionState> LouvainInitLocal(ExecutionContext &ctx, TableFunctionInitInput &input, GlobalTableFunctionState *global_state) {
+  return input.bind_data->Cast<LouvainBindData>().weights.MakeLocal(global_state);
 }
 static OperatorFinalizeResultType LouvainFinal(ExecutionContext &ctx, TableFunctionInput &data, DataChunk &output) {
   auto &bd = data.bind_data->Cast<LouvainBindData>(); auto &gs = data.global_state->Cast<LouvainGlobalState>();
-  std::lock_guard<std::mutex> lock(gs.input_mutex);
+  if (!FinishInput(ctx, data)) { output.SetCardinality(0); return OperatorFinalizeResultType::FINISHED; }
   if (!gs.computed) {
-    if (gs.src_nodes.empty()) { gs.computed = true; output.SetCardinality(0); return OperatorFinalizeResultType::FINISHED; }
-    int64_t nc = ::onager::onager_compute_louvain(gs.src_nodes.data(), gs.dst_nodes.data(), gs.src_nodes.size(), bd.seed, nullptr, nullptr);
-    if (nc < 0) throw InvalidInputException("Louvain failed: " + GetOnagerError());
-    gs.result_nodes.resize(nc); gs.result_communities.resize(nc);
-    ::onager::onager_compute_louvain(gs.src_nodes.data(), gs.dst_nodes.data(), gs.src_nodes.size(), bd.seed, gs.result_nodes.data(), gs.result_communities.data());
+    if (gs.input.Size() == 0) { gs.computed = true; output.SetCardinality(0); return OperatorFinalizeResultType::FINISHED; }
+    gs.result.Set(::onager::onager_compute_louvain(gs.input.I64(0), gs.input.I64(1), gs.input.Size(), bd.weights.Data(gs.input), bd.weights.Size(gs.input), bd.seed), "Louvain");
     gs.computed = true;
   }
-  idx_t rem = gs.result_nodes.size() - gs.output_idx;
-  if (rem == 0) { output.SetCardinality(0); return OperatorFinalizeResultType::FINISHED; }
-  idx_t to = MinValue<idx_t>(rem, STANDARD_VECTOR_SIZE);
-  auto n = GetFlatVectorDataWritable<int64_t>(output.data[0]); auto c = GetFlatVectorDataWritable<int64_t>(output.data[1]);
-  for (idx_t i = 0; i < to; i++) { n[i] = gs.result_nodes[gs.output_idx+i]; c[i] = gs.result_communities[gs.output_idx+i]; }
-  gs.output_idx += to; output.SetCardinality(to);
-  return gs.output_idx >= gs.result_nodes.size() ? OperatorFinalizeResultType::FINISHED : OperatorFinalizeResultType::HAVE_MORE_OUTPUT;
+  return EmitResultChunk(gs.result, gs.output_idx, output);
+}
+static void LouvainGraphScan(ClientContext &ctx, TableFunctionInput &data, DataChunk &output) {
+  auto &bd = data.bind_data->Cast<LouvainBindData>();
+  EmitGraphResult(ctx, data, output, "Louvain", [&](const char *graph) { return ::onager::onager_graph_compute_louvain(graph, bd.seed); });
 }
 
 // =============================================================================
 // Connected Components
 // =============================================================================
 
-struct ComponentsGlobalState : public GlobalTableFunctionState {
-  std::mutex input_mutex;
-  std::vector<int64_t> src_nodes, dst_nodes, result_nodes, result_components;
+struct ComponentsGlobalState : public InputGlobalState {
+  OnagerResultHandle result;
   idx_t output_idx = 0; bool computed = false;
-  idx_t MaxThreads() const override { return 1; }
 };
 
 static unique_ptr<FunctionData> ComponentsBind(ClientContext &ctx, TableFunctionBindInput &input, vector<LogicalType> &rt, vector<string> &nm) {
-  CheckInt64Input(input, "onager_cmm_components");
+  auto bd = make_uniq<GraphBindData>();
+  if (!BindGraphName(input, bd->graph)) CheckInt64Input(input, "onager_cmm_components");
   rt.push_back(LogicalType::BIGINT); nm.push_back("node_id");
   rt.push_back(LogicalType::BIGINT); nm.push_back("component");
-  return make_uniq<TableFunctionData>();
+  return std::move(bd);
 }
 static unique_ptr<GlobalTableFunctionState> ComponentsInitGlobal(ClientContext &ctx, TableFunctionInitInput &input) { return make_uniq<ComponentsGlobalState>(); }
-static OperatorResultType ComponentsInOut(ExecutionContext &ctx, TableFunctionInput &data, DataChunk &input, DataChunk &output) {
-  auto &gs = data.global_state->Cast<ComponentsGlobalState>();
-  std::lock_guard<std::mutex> lock(gs.input_mutex);
-  auto s = FlatVector::GetData<int64_t>(input.data[0]); auto d = FlatVector::GetData<int64_t>(input.data[1]);
-  for (idx_t i = 0; i < input.size(); i++) { gs.src_nodes.push_back(s[i]); gs.dst_nodes.push_back(d[i]); }
-  output.SetCardinality(0); return OperatorResultType::NEED_MORE_INPUT;
-}
 static OperatorFinalizeResultType ComponentsFinal(ExecutionContext &ctx, TableFunctionInput &data, DataChunk &output) {
   auto &gs = data.global_state->Cast<ComponentsGlobalState>();
-  std::lock_guard<std::mutex> lock(gs.input_mutex);
+  if (!FinishInput(ctx, data)) { output.SetCardinality(0); return OperatorFinalizeResultType::FINISHED; }
   if (!gs.computed) {
-    if (gs.src_nodes.empty()) { gs.computed = true; output.SetCardinality(0); return OperatorFinalizeResultType::FINISHED; }
-    int64_t nc = ::onager::onager_compute_connected_components(gs.src_nodes.data(), gs.dst_nodes.data(), gs.src_nodes.size(), nullptr, nullptr);
-    if (nc < 0) throw InvalidInputException("Components failed: " + GetOnagerError());
-    gs.result_nodes.resize(nc); gs.result_components.resize(nc);
-    ::onager::onager_compute_connected_components(gs.src_nodes.data(), gs.dst_nodes.data(), gs.src_nodes.size(), gs.result_nodes.data(), gs.result_components.data());
+    if (gs.input.Size() == 0) { gs.computed = true; output.SetCardinality(0); return OperatorFinalizeResultType::FINISHED; }
+    gs.result.Set(::onager::onager_compute_connected_components(gs.input.I64(0), gs.input.I64(1), gs.input.Size()), "Components");
     gs.computed = true;
   }
-  idx_t rem = gs.result_nodes.size() - gs.output_idx;
-  if (rem == 0) { output.SetCardinality(0); return OperatorFinalizeResultType::FINISHED; }
-  idx_t to = MinValue<idx_t>(rem, STANDARD_VECTOR_SIZE);
-  auto n = GetFlatVectorDataWritable<int64_t>(output.data[0]); auto c = GetFlatVectorDataWritable<int64_t>(output.data[1]);
-  for (idx_t i = 0; i < to; i++) { n[i] = gs.result_nodes[gs.output_idx+i]; c[i] = gs.result_components[gs.output_idx+i]; }
-  gs.output_idx += to; output.SetCardinality(to);
-  return gs.output_idx >= gs.result_nodes.size() ? OperatorFinalizeResultType::FINISHED : OperatorFinalizeResultType::HAVE_MORE_OUTPUT;
+  return EmitResultChunk(gs.result, gs.output_idx, output);
+}
+static void ComponentsGraphScan(ClientContext &ctx, TableFunctionInput &data, DataChunk &output) {
+  EmitGraphResult(ctx, data, output, "Components", [](const char *graph) { return ::onager::onager_graph_compute_connected_components(graph); });
 }
 
 // =============================================================================
 // Label Propagation
 // =============================================================================
 
-struct LabelPropGlobalState : public GlobalTableFunctionState {
-  std::mutex input_mutex;
-  std::vector<int64_t> src_nodes, dst_nodes, result_nodes, result_labels;
+struct LabelPropGlobalState : public InputGlobalState {
+  OnagerResultHandle result;
   idx_t output_idx = 0; bool computed = false;
-  idx_t MaxThreads() const override { return 1; }
 };
 
 static unique_ptr<FunctionData> LabelPropBind(ClientContext &ctx, TableFunctionBindInput &input, vector<LogicalType> &rt, vector<string> &nm) {
-  CheckInt64Input(input, "onager_cmm_label_prop");
+  auto bd = make_uniq<GraphBindData>();
+  if (!BindGraphName(input, bd->graph)) CheckInt64Input(input, "onager_cmm_label_prop");
   rt.push_back(LogicalType::BIGINT); nm.push_back("node_id");
   rt.push_back(LogicalType::BIGINT); nm.push_back("label");
-  return make_uniq<TableFunctionData>();
+  return std::move(bd);
 }
 static unique_ptr<GlobalTableFunctionState> LabelPropInitGlobal(ClientContext &ctx, TableFunctionInitInput &input) { return make_uniq<LabelPropGlobalState>(); }
-static OperatorResultType LabelPropInOut(ExecutionContext &ctx, TableFunctionInput &data, DataChunk &input, DataChunk &output) {
-  auto &gs = data.global_state->Cast<LabelPropGlobalState>();
-  std::lock_guard<std::mutex> lock(gs.input_mutex);
-  auto s = FlatVector::GetData<int64_t>(input.data[0]); auto d = FlatVector::GetData<int64_t>(input.data[1]);
-  for (idx_t i = 0; i < input.size(); i++) { gs.src_nodes.push_back(s[i]); gs.dst_nodes.push_back(d[i]); }
-  output.SetCardinality(0); return OperatorResultType::NEED_MORE_INPUT;
-}
 static OperatorFinalizeResultType LabelPropFinal(ExecutionContext &ctx, TableFunctionInput &data, DataChunk &output) {
   auto &gs = data.global_state->Cast<LabelPropGlobalState>();
-  std::lock_guard<std::mutex> lock(gs.input_mutex);
+  if (!FinishInput(ctx, data)) { output.SetCardinality(0); return OperatorFinalizeResultType::FINISHED; }
   if (!gs.computed) {
-    if (gs.src_nodes.empty()) { gs.computed = true; output.SetCardinality(0); return OperatorFinalizeResultType::FINISHED; }
-    int64_t nc = ::onager::onager_compute_label_propagation(gs.src_nodes.data(), gs.dst_nodes.data(), gs.src_nodes.size(), nullptr, nullptr);
-    if (nc < 0) throw InvalidInputException("Label propagation failed: " + GetOnagerError());
-    gs.result_nodes.resize(nc); gs.result_labels.resize(nc);
-    ::onager::onager_compute_label_propagation(gs.src_nodes.data(), gs.dst_nodes.data(), gs.src_nodes.size(), gs.result_nodes.data(), gs.result_labels.data());
+    if (gs.input.Size() == 0) { gs.computed = true; output.SetCardinality(0); return OperatorFinalizeResultType::FINISHED; }
+    gs.result.Set(::onager::onager_compute_label_propagation(gs.input.I64(0), gs.input.I64(1), gs.input.Size()), "Label propagation");
     gs.computed = true;
   }
-  idx_t rem = gs.result_nodes.size() - gs.output_idx;
-  if (rem == 0) { output.SetCardinality(0); return OperatorFinalizeResultType::FINISHED; }
-  idx_t to = MinValue<idx_t>(rem, STANDARD_VECTOR_SIZE);
-  auto n = GetFlatVectorDataWritable<int64_t>(output.data[0]); auto l = GetFlatVectorDataWritable<int64_t>(output.data[1]);
-  for (idx_t i = 0; i < to; i++) { n[i] = gs.result_nodes[gs.output_idx+i]; l[i] = gs.result_labels[gs.output_idx+i]; }
-  gs.output_idx += to; output.SetCardinality(to);
-  return gs.output_idx >= gs.result_nodes.size() ? OperatorFinalizeResultType::FINISHED : OperatorFinalizeResultType::HAVE_MORE_OUTPUT;
+  return EmitResultChunk(gs.result, gs.output_idx, output);
+}
+static void LabelPropGraphScan(ClientContext &ctx, TableFunctionInput &data, DataChunk &output) {
+  EmitGraphResult(ctx, data, output, "Label propagation", [](const char *graph) { return ::onager::onager_graph_compute_label_propagation(graph); });
 }
 
 // =============================================================================
@@ -154,11 +117,9 @@ static OperatorFinalizeResultType LabelPropFinal(ExecutionContext &ctx, TableFun
 // =============================================================================
 
 struct GirvanNewmanBindData : public TableFunctionData { int64_t target_communities = 2; };
-struct GirvanNewmanGlobalState : public GlobalTableFunctionState {
-  std::mutex input_mutex;
-  std::vector<int64_t> src_nodes, dst_nodes, result_ids, result_communities;
+struct GirvanNewmanGlobalState : public InputGlobalState {
+  OnagerResultHandle result;
   idx_t output_idx = 0; bool computed = false;
-  idx_t MaxThreads() const override { return 1; }
 };
 
 static unique_ptr<FunctionData> GirvanNewmanBind(ClientContext &ctx, TableFunctionBindInput &input, vector<LogicalType> &rt, vector<string> &nm) {
@@ -170,31 +131,15 @@ static unique_ptr<FunctionData> GirvanNewmanBind(ClientContext &ctx, TableFuncti
   return std::move(bd);
 }
 static unique_ptr<GlobalTableFunctionState> GirvanNewmanInitGlobal(ClientContext &ctx, TableFunctionInitInput &input) { return make_uniq<GirvanNewmanGlobalState>(); }
-static OperatorResultType GirvanNewmanInOut(ExecutionContext &ctx, TableFunctionInput &data, DataChunk &input, DataChunk &output) {
-  auto &gs = data.global_state->Cast<GirvanNewmanGlobalState>();
-  std::lock_guard<std::mutex> lock(gs.input_mutex);
-  auto s = FlatVector::GetData<int64_t>(input.data[0]); auto d = FlatVector::GetData<int64_t>(input.data[1]);
-  for (idx_t i = 0; i < input.size(); i++) { gs.src_nodes.push_back(s[i]); gs.dst_nodes.push_back(d[i]); }
-  output.SetCardinality(0); return OperatorResultType::NEED_MORE_INPUT;
-}
 static OperatorFinalizeResultType GirvanNewmanFinal(ExecutionContext &ctx, TableFunctionInput &data, DataChunk &output) {
   auto &bd = data.bind_data->Cast<GirvanNewmanBindData>(); auto &gs = data.global_state->Cast<GirvanNewmanGlobalState>();
-  std::lock_guard<std::mutex> lock(gs.input_mutex);
+  if (!FinishInput(ctx, data)) { output.SetCardinality(0); return OperatorFinalizeResultType::FINISHED; }
   if (!gs.computed) {
-    if (gs.src_nodes.empty()) { gs.computed = true; output.SetCardinality(0); return OperatorFinalizeResultType::FINISHED; }
-    int64_t nc = ::onager::onager_compute_girvan_newman(gs.src_nodes.data(), gs.dst_nodes.data(), gs.src_nodes.size(), bd.target_communities, nullptr, nullptr);
-    if (nc < 0) throw InvalidInputException("Girvan-Newman failed: " + GetOnagerError());
-    gs.result_ids.resize(nc); gs.result_communities.resize(nc);
-    ::onager::onager_compute_girvan_newman(gs.src_nodes.data(), gs.dst_nodes.data(), gs.src_nodes.size(), bd.target_communities, gs.result_ids.data(), gs.result_communities.data());
+    if (gs.input.Size() == 0) { gs.computed = true; output.SetCardinality(0); return OperatorFinalizeResultType::FINISHED; }
+    gs.result.Set(::onager::onager_compute_girvan_newman(gs.input.I64(0), gs.input.I64(1), gs.input.Size(), bd.target_communities), "Girvan-Newman");
     gs.computed = true;
   }
-  idx_t rem = gs.result_ids.size() - gs.output_idx;
-  if (rem == 0) { output.SetCardinality(0); return OperatorFinalizeResultType::FINISHED; }
-  idx_t to = MinValue<idx_t>(rem, STANDARD_VECTOR_SIZE);
-  auto n = GetFlatVectorDataWritable<int64_t>(output.data[0]); auto c = GetFlatVectorDataWritable<int64_t>(output.data[1]);
-  for (idx_t i = 0; i < to; i++) { n[i] = gs.result_ids[gs.output_idx+i]; c[i] = gs.result_communities[gs.output_idx+i]; }
-  gs.output_idx += to; output.SetCardinality(to);
-  return gs.output_idx >= gs.result_ids.size() ? OperatorFinalizeResultType::FINISHED : OperatorFinalizeResultType::HAVE_MORE_OUTPUT;
+  return EmitResultChunk(gs.result, gs.output_idx, output);
 }
 
 // =============================================================================
@@ -202,11 +147,9 @@ static OperatorFinalizeResultType GirvanNewmanFinal(ExecutionContext &ctx, Table
 // =============================================================================
 
 struct SpectralBindData : public TableFunctionData { int64_t k = 2; int64_t seed = -1; };
-struct SpectralGlobalState : public GlobalTableFunctionState {
-  std::mutex input_mutex;
-  std::vector<int64_t> src_nodes, dst_nodes, result_nodes, result_communities;
+struct SpectralGlobalState : public InputGlobalState {
+  OnagerResultHandle result;
   idx_t output_idx = 0; bool computed = false;
-  idx_t MaxThreads() const override { return 1; }
 };
 
 static unique_ptr<FunctionData> SpectralBind(ClientContext &ctx, TableFunctionBindInput &input, vector<LogicalType> &rt, vector<string> &nm) {
@@ -221,31 +164,15 @@ static unique_ptr<FunctionData> SpectralBind(ClientContext &ctx, TableFunctionBi
   return std::move(bd);
 }
 static unique_ptr<GlobalTableFunctionState> SpectralInitGlobal(ClientContext &ctx, TableFunctionInitInput &input) { return make_uniq<SpectralGlobalState>(); }
-static OperatorResultType SpectralInOut(ExecutionContext &ctx, TableFunctionInput &data, DataChunk &input, DataChunk &output) {
-  auto &gs = data.global_state->Cast<SpectralGlobalState>();
-  std::lock_guard<std::mutex> lock(gs.input_mutex);
-  auto s = FlatVector::GetData<int64_t>(input.data[0]); auto d = FlatVector::GetData<int64_t>(input.data[1]);
-  for (idx_t i = 0; i < input.size(); i++) { gs.src_nodes.push_back(s[i]); gs.dst_nodes.push_back(d[i]); }
-  output.SetCardinality(0); return OperatorResultType::NEED_MORE_INPUT;
-}
 static OperatorFinalizeResultType SpectralFinal(ExecutionContext &ctx, TableFunctionInput &data, DataChunk &output) {
   auto &bd = data.bind_data->Cast<SpectralBindData>(); auto &gs = data.global_state->Cast<SpectralGlobalState>();
-  std::lock_guard<std::mutex> lock(gs.input_mutex);
+  if (!FinishInput(ctx, data)) { output.SetCardinality(0); return OperatorFinalizeResultType::FINISHED; }
   if (!gs.computed) {
-    if (gs.src_nodes.empty()) { gs.computed = true; output.SetCardinality(0); return OperatorFinalizeResultType::FINISHED; }
-    int64_t nc = ::onager::onager_compute_spectral_clustering(gs.src_nodes.data(), gs.dst_nodes.data(), gs.src_nodes.size(), bd.k, bd.seed, nullptr, nullptr);
-    if (nc < 0) throw InvalidInputException("Spectral clustering failed: " + GetOnagerError());
-    gs.result_nodes.resize(nc); gs.result_communities.resize(nc);
-    ::onager::onager_compute_spectral_clustering(gs.src_nodes.data(), gs.dst_nodes.data(), gs.src_nodes.size(), bd.k, bd.seed, gs.result_nodes.data(), gs.result_communities.data());
+    if (gs.input.Size() == 0) { gs.computed = true; output.SetCardinality(0); return OperatorFinalizeResultType::FINISHED; }
+    gs.result.Set(::onager::onager_compute_spectral_clustering(gs.input.I64(0), gs.input.I64(1), gs.input.Size(), bd.k, bd.seed), "Spectral clustering");
     gs.computed = true;
   }
-  idx_t rem = gs.result_nodes.size() - gs.output_idx;
-  if (rem == 0) { output.SetCardinality(0); return OperatorFinalizeResultType::FINISHED; }
-  idx_t to = MinValue<idx_t>(rem, STANDARD_VECTOR_SIZE);
-  auto n = GetFlatVectorDataWritable<int64_t>(output.data[0]); auto c = GetFlatVectorDataWritable<int64_t>(output.data[1]);
-  for (idx_t i = 0; i < to; i++) { n[i] = gs.result_nodes[gs.output_idx+i]; c[i] = gs.result_communities[gs.output_idx+i]; }
-  gs.output_idx += to; output.SetCardinality(to);
-  return gs.output_idx >= gs.result_nodes.size() ? OperatorFinalizeResultType::FINISHED : OperatorFinalizeResultType::HAVE_MORE_OUTPUT;
+  return EmitResultChunk(gs.result, gs.output_idx, output);
 }
 
 // =============================================================================
@@ -253,11 +180,9 @@ static OperatorFinalizeResultType SpectralFinal(ExecutionContext &ctx, TableFunc
 // =============================================================================
 
 struct InfomapBindData : public TableFunctionData { int64_t max_iter = 100; int64_t seed = -1; };
-struct InfomapGlobalState : public GlobalTableFunctionState {
-  std::mutex input_mutex;
-  std::vector<int64_t> src_nodes, dst_nodes, result_nodes, result_communities;
+struct InfomapGlobalState : public InputGlobalState {
+  OnagerResultHandle result;
   idx_t output_idx = 0; bool computed = false;
-  idx_t MaxThreads() const override { return 1; }
 };
 
 static unique_ptr<FunctionData> InfomapBind(ClientContext &ctx, TableFunctionBindInput &input, vector<LogicalType> &rt, vector<string> &nm) {
@@ -272,31 +197,63 @@ static unique_ptr<FunctionData> InfomapBind(ClientContext &ctx, TableFunctionBin
   return std::move(bd);
 }
 static unique_ptr<GlobalTableFunctionState> InfomapInitGlobal(ClientContext &ctx, TableFunctionInitInput &input) { return make_uniq<InfomapGlobalState>(); }
-static OperatorResultType InfomapInOut(ExecutionContext &ctx, TableFunctionInput &data, DataChunk &input, DataChunk &output) {
-  auto &gs = data.global_state->Cast<InfomapGlobalState>();
-  std::lock_guard<std::mutex> lock(gs.input_mutex);
-  auto s = FlatVector::GetData<int64_t>(input.data[0]); auto d = FlatVector::GetData<int64_t>(input.data[1]);
-  for (idx_t i = 0; i < input.size(); i++) { gs.src_nodes.push_back(s[i]); gs.dst_nodes.push_back(d[i]); }
-  output.SetCardinality(0); return OperatorResultType::NEED_MORE_INPUT;
-}
 static OperatorFinalizeResultType InfomapFinal(ExecutionContext &ctx, TableFunctionInput &data, DataChunk &output) {
   auto &bd = data.bind_data->Cast<InfomapBindData>(); auto &gs = data.global_state->Cast<InfomapGlobalState>();
-  std::lock_guard<std::mutex> lock(gs.input_mutex);
+  if (!FinishInput(ctx, data)) { output.SetCardinality(0); return OperatorFinalizeResultType::FINISHED; }
   if (!gs.computed) {
-    if (gs.src_nodes.empty()) { gs.computed = true; output.SetCardinality(0); return OperatorFinalizeResultType::FINISHED; }
-    int64_t nc = ::onager::onager_compute_infomap(gs.src_nodes.data(), gs.dst_nodes.data(), gs.src_nodes.size(), bd.max_iter, bd.seed, nullptr, nullptr);
-    if (nc < 0) throw InvalidInputException("Infomap failed: " + GetOnagerError());
-    gs.result_nodes.resize(nc); gs.result_communities.resize(nc);
-    ::onager::onager_compute_infomap(gs.src_nodes.data(), gs.dst_nodes.data(), gs.src_nodes.size(), bd.max_iter, bd.seed, gs.result_nodes.data(), gs.result_communities.data());
+    if (gs.input.Size() == 0) { gs.computed = true; output.SetCardinality(0); return OperatorFinalizeResultType::FINISHED; }
+    gs.result.Set(::onager::onager_compute_infomap(gs.input.I64(0), gs.input.I64(1), gs.input.Size(), bd.max_iter, bd.seed), "Infomap");
     gs.computed = true;
   }
-  idx_t rem = gs.result_nodes.size() - gs.output_idx;
-  if (rem == 0) { output.SetCardinality(0); return OperatorFinalizeResultType::FINISHED; }
-  idx_t to = MinValue<idx_t>(rem, STANDARD_VECTOR_SIZE);
-  auto n = GetFlatVectorDataWritable<int64_t>(output.data[0]); auto c = GetFlatVectorDataWritable<int64_t>(output.data[1]);
-  for (idx_t i = 0; i < to; i++) { n[i] = gs.result_nodes[gs.output_idx+i]; c[i] = gs.result_communities[gs.output_idx+i]; }
-  gs.output_idx += to; output.SetCardinality(to);
-  return gs.output_idx >= gs.result_nodes.size() ? OperatorFinalizeResultType::FINISHED : OperatorFinalizeResultType::HAVE_MORE_OUTPUT;
+  return EmitResultChunk(gs.result, gs.output_idx, output);
+}
+
+// =============================================================================
+// K-Core Decomposition
+// =============================================================================
+
+struct KCoreBindData : public GraphBindData { int64_t k = -1; };
+struct KCoreGlobalState : public InputGlobalState {
+  OnagerResultHandle result;
+  idx_t output_idx = 0; bool computed = false;
+};
+
+static unique_ptr<FunctionData> KCoreBind(ClientContext &ctx, TableFunctionBindInput &input, vector<LogicalType> &rt, vector<string> &nm) {
+  auto bd = make_uniq<KCoreBindData>();
+  if (!BindGraphName(input, bd->graph)) CheckInt64Input(input, "onager_cmm_kcore");
+  for (auto &kv : input.named_parameters) {
+    if (kv.first == "k") {
+      bd->k = kv.second.GetValue<int64_t>();
+      if (bd->k < 0) throw InvalidInputException("onager_cmm_kcore requires k to be non-negative");
+    }
+  }
+  // With k, the function returns the edges of the k-core instead of core numbers
+  if (bd->k >= 0) {
+    rt.push_back(LogicalType::BIGINT); nm.push_back("src");
+    rt.push_back(LogicalType::BIGINT); nm.push_back("dst");
+  } else {
+    rt.push_back(LogicalType::BIGINT); nm.push_back("node_id");
+    rt.push_back(LogicalType::BIGINT); nm.push_back("core_number");
+  }
+  return std::move(bd);
+}
+static unique_ptr<GlobalTableFunctionState> KCoreInitGlobal(ClientContext &ctx, TableFunctionInitInput &input) { return make_uniq<KCoreGlobalState>(); }
+static OperatorFinalizeResultType KCoreFinal(ExecutionContext &ctx, TableFunctionInput &data, DataChunk &output) {
+  auto &bd = data.bind_data->Cast<KCoreBindData>(); auto &gs = data.global_state->Cast<KCoreGlobalState>();
+  if (!FinishInput(ctx, data)) { output.SetCardinality(0); return OperatorFinalizeResultType::FINISHED; }
+  if (!gs.computed) {
+    if (gs.input.Size() == 0) { gs.computed = true; output.SetCardinality(0); return OperatorFinalizeResultType::FINISHED; }
+    if (bd.k >= 0) gs.result.Set(::onager::onager_compute_kcore_edges(gs.input.I64(0), gs.input.I64(1), gs.input.Size(), bd.k), "K-core");
+    else gs.result.Set(::onager::onager_compute_kcore(gs.input.I64(0), gs.input.I64(1), gs.input.Size()), "K-core");
+    gs.computed = true;
+  }
+  return EmitResultChunk(gs.result, gs.output_idx, output);
+}
+static void KCoreGraphScan(ClientContext &ctx, TableFunctionInput &data, DataChunk &output) {
+  auto &bd = data.bind_data->Cast<KCoreBindData>();
+  EmitGraphResult(ctx, data, output, "K-core", [&](const char *graph) {
+    return bd.k >= 0 ? ::onager::onager_graph_compute_kcore_edges(graph, bd.k) : ::onager::onager_graph_compute_kcore(graph);
+  });
 }
 
 // =============================================================================
@@ -307,33 +264,38 @@ namespace onager {
 
 void RegisterCommunityFunctions(ExtensionLoader &loader) {
   TableFunction louvain("onager_cmm_louvain", {LogicalType::TABLE}, nullptr, LouvainBind, LouvainInitGlobal);
-  louvain.in_out_function = LouvainInOut;
+  louvain.in_out_function = CollectInput;
+  louvain.init_local = LouvainInitLocal;
   louvain.in_out_function_final = LouvainFinal;
   louvain.named_parameters["seed"] = LogicalType::BIGINT;
   ONAGER_SET_NO_ORDER(louvain);
-  loader.RegisterFunction(louvain);
+  RegisterWithGraphOverload(loader, louvain, LouvainGraphScan);
 
   TableFunction components("onager_cmm_components", {LogicalType::TABLE}, nullptr, ComponentsBind, ComponentsInitGlobal);
-  components.in_out_function = ComponentsInOut;
+  components.in_out_function = CollectInput;
+  components.init_local = InitInputLocal<2>;
   components.in_out_function_final = ComponentsFinal;
   ONAGER_SET_NO_ORDER(components);
-  loader.RegisterFunction(components);
+  RegisterWithGraphOverload(loader, components, ComponentsGraphScan);
 
   TableFunction label_prop("onager_cmm_label_prop", {LogicalType::TABLE}, nullptr, LabelPropBind, LabelPropInitGlobal);
-  label_prop.in_out_function = LabelPropInOut;
+  label_prop.in_out_function = CollectInput;
+  label_prop.init_local = InitInputLocal<2>;
   label_prop.in_out_function_final = LabelPropFinal;
   ONAGER_SET_NO_ORDER(label_prop);
-  loader.RegisterFunction(label_prop);
+  RegisterWithGraphOverload(loader, label_prop, LabelPropGraphScan);
 
   TableFunction girvan_newman("onager_cmm_girvan_newman", {LogicalType::TABLE}, nullptr, GirvanNewmanBind, GirvanNewmanInitGlobal);
-  girvan_newman.in_out_function = GirvanNewmanInOut;
+  girvan_newman.in_out_function = CollectInput;
+  girvan_newman.init_local = InitInputLocal<2>;
   girvan_newman.in_out_function_final = GirvanNewmanFinal;
   girvan_newman.named_parameters["communities"] = LogicalType::BIGINT;
   ONAGER_SET_NO_ORDER(girvan_newman);
   loader.RegisterFunction(girvan_newman);
 
   TableFunction spectral("onager_cmm_spectral", {LogicalType::TABLE}, nullptr, SpectralBind, SpectralInitGlobal);
-  spectral.in_out_function = SpectralInOut;
+  spectral.in_out_function = CollectInput;
+  spectral.init_local = InitInputLocal<2>;
   spectral.in_out_function_final = SpectralFinal;
   spectral.named_parameters["k"] = LogicalType::BIGINT;
   spectral.named_parameters["seed"] = LogicalType::BIGINT;
@@ -341,12 +303,21 @@ void RegisterCommunityFunctions(ExtensionLoader &loader) {
   loader.RegisterFunction(spectral);
 
   TableFunction infomap("onager_cmm_infomap", {LogicalType::TABLE}, nullptr, InfomapBind, InfomapInitGlobal);
-  infomap.in_out_function = InfomapInOut;
+  infomap.in_out_function = CollectInput;
+  infomap.init_local = InitInputLocal<2>;
   infomap.in_out_function_final = InfomapFinal;
   infomap.named_parameters["max_iter"] = LogicalType::BIGINT;
   infomap.named_parameters["seed"] = LogicalType::BIGINT;
   ONAGER_SET_NO_ORDER(infomap);
   loader.RegisterFunction(infomap);
+
+  TableFunction kcore("onager_cmm_kcore", {LogicalType::TABLE}, nullptr, KCoreBind, KCoreInitGlobal);
+  kcore.in_out_function = CollectInput;
+  kcore.init_local = InitInputLocal<2>;
+  kcore.in_out_function_final = KCoreFinal;
+  kcore.named_parameters["k"] = LogicalType::BIGINT;
+  ONAGER_SET_NO_ORDER(kcore);
+  RegisterWithGraphOverload(loader, kcore, KCoreGraphScan);
 }
 
 } // namespace onager
@@ -10,6 +10,55 @@ namespace duckdb {
 
 using namespace onager;
 
+// =============================================================================
+// Streaming Edge Cursors
+// =============================================================================
+// Generators hand out one resumable cursor per partition. Each thread claims the
+// next partition and pulls up to STANDARD_VECTOR_SIZE edges per call straight into
+// the output vectors, so the full edge list is never materialized.
+
+struct EdgeGeneratorGlobalState : public GlobalTableFunctionState {
+  EdgeGeneratorGlobalState(::onager::OnagerEdgeGenerator *generator_p, const std::string &what) : generator(generator_p) {
+    if (!generator) throw InvalidInputException(what + " failed: " + GetOnagerError());
+    partitions = ::onager::onager_edge_generator_partitions(generator);
+  }
+  ~EdgeGeneratorGlobalState() override { ::onager::onager_free_edge_generator(generator); }
+  ::onager::OnagerEdgeGenerator *generator;
+  idx_t partitions = 0;
+  std::atomic<idx_t> next_partition {0};
+  idx_t MaxThreads() const override { return MaxValue<idx_t>(partitions, 1); }
+};
+struct EdgeCursorLocalState : public LocalTableFunctionState {
+  ~EdgeCursorLocalState() override { ::onager::onager_free_edge_cursor(cursor); }
+  ::onager::OnagerEdgeCursor *cursor = nullptr;
+};
+
+static unique_ptr<LocalTableFunctionState> EdgeCursorInitLocal(ExecutionContext &ctx, TableFunctionInitInput &input, GlobalTableFunctionState *global_state) {
+  return make_uniq<EdgeCursorLocalState>();
+}
+static void EdgeCursorFunction(ClientContext &ctx, TableFunctionInput &data, DataChunk &output) {
+  auto &gs = data.global_state->Cast<EdgeGeneratorGlobalState>(); auto &ls = data.local_state->Cast<EdgeCursorLocalState>();
+  auto src = GetFlatVectorDataWritable<int64_t>(output.data[0]);
+  auto dst = GetFlatVectorDataWritable<int64_t>(output.data[1]);
+  idx_t count = 0;
+  while (count < STANDARD_VECTOR_SIZE) {
+    if (!ls.cursor) {
+      idx_t partition = gs.next_partition++;
+      if (partition >= gs.partitions) break;
+      ls.cursor = ::onager::onager_edge_generator_cursor(gs.generator, partition);
+      if (!ls.cursor) throw InvalidInputException("Edge generator failed: " + GetOnagerError());
+    }
+    idx_t wanted = STANDARD_VECTOR_SIZE - count;
+    idx_t written = ::onager::onager_edge_cursor_next(ls.cursor, src + count, dst + count, wanted);
+    count += written;
+    if (written < wanted) {
+      ::onager::onager_free_edge_cursor(ls.cursor);
+      ls.cursor = nullptr;
+    }
+  }
+  output.SetCardinality(count);
+}
+
 // =============================================================================
 // Erdős-Rényi Random Graph
 // =============================================================================
@@ -17,11 +66,6 @@ using namespace onager;
 struct ErdosRenyiBindData : public TableFunctionData {
   int64_t n = 10; double p = 0.5; int64_t seed = 42;
 };
-struct ErdosRenyiGlobalState : public GlobalTableFunctionState {
-  std::vector<int64_t> result_src, result_dst;
-  idx_t output_idx = 0; bool computed = false;
-  idx_t MaxThreads() const override { return 1; }
-};
 
 static unique_ptr<FunctionData> ErdosRenyiBind(ClientContext &ctx, TableFunctionBindInput &input, vector<LogicalType> &rt, vector<string> &nm) {
   auto bd = make_uniq<ErdosRenyiBindData>();
@@ -32,22 +76,9 @@ static unique_ptr<FunctionData> ErdosRenyiBind(ClientContext &ctx, TableFunction
   rt.push_back(LogicalType::BIGINT); nm.push_back("dst");
   return std::move(bd);
 }
-static unique_ptr<GlobalTableFunctionState> ErdosRenyiInitGlobal(ClientContext &ctx, TableFunctionInitInput &input) { return make_uniq<ErdosRenyiGlobalState>(); }
-static void ErdosRenyiFunction(ClientContext &ctx, TableFunctionInput &data, DataChunk &output) {
-  auto &bd = data.bind_data->Cast<ErdosRenyiBindData>(); auto &gs = data.global_state->Cast<ErdosRenyiGlobalState>();
-  if (!gs.computed) {
-    int64_t ec = ::onager::onager_generate_erdos_renyi(static_cast<size_t>(bd.n), bd.p, static_cast<uint64_t>(bd.seed), nullptr, nullptr);
-    if (ec < 0) throw InvalidInputException("Erdos-Renyi failed: " + GetOnagerError());
-    gs.result_src.resize(ec); gs.result_dst.resize(ec);
-    ::onager::onager_generate_erdos_renyi(static_cast<size_t>(bd.n), bd.p, static_cast<uint64_t>(bd.seed), gs.result_src.data(), gs.result_dst.data());
-    gs.computed = true;
-  }
-  idx_t rem = gs.result_src.size() - gs.output_idx;
-  if (rem == 0) { output.SetCardinality(0); return; }
-  idx_t to = MinValue<idx_t>(rem, STANDARD_VECTOR_SIZE);
-  auto s = GetFlatVectorDataWritable<int64_t>(output.data[0]); auto d = GetFlatVectorDataWritable<int64_t>(output.data[1]);
-  for (idx_t i = 0; i < to; i++) { s[i] = gs.result_src[gs.output_idx+i]; d[i] = gs.result_dst[gs.output_idx+i]; }
-  gs.output_idx += to; output.SetCardinality(to);
+static unique_ptr<GlobalTableFunctionState> ErdosRenyiInitGlobal(ClientContext &ctx, TableFunctionInitInput &input) {
+  auto &bd = input.bind_data->Cast<ErdosRenyiBindData>();
+  return make_uniq<EdgeGeneratorGlobalState>(::onager::onager_edge_generator_erdos_renyi(static_cast<size_t>(bd.n), bd.p, static_cast<uint64_t>(bd.seed)), "Erdos-Renyi");
 }
 
 // =============================================================================
@@ -57,11 +88,6 @@ static void ErdosRenyiFunction(ClientContext &ctx, TableFunctionInput &data, Dat
 struct BarabasiAlbertBindData : public TableFunctionData {
   int64_t n = 10; int64_t m = 2; int64_t seed = 42;
 };
-struct BarabasiAlbertGlobalState : public GlobalTableFunctionState {
-  std::vector<int64_t> result_src, result_dst;
-  idx_t output_idx = 0; bool computed = false;
-  idx_t MaxThreads() const override { return 1; }
-};
 
 static unique_ptr<FunctionData> BarabasiAlbertBind(ClientContext &ctx, TableFunctionBindInput &input, vector<LogicalType> &rt, vector<string> &nm) {
   auto bd = make_uniq<BarabasiAlbertBindData>();
@@ -72,22 +98,9 @@ static unique_ptr<FunctionData> BarabasiAlbertBind(ClientContext &ctx, TableFunc
   rt.push_back(LogicalType::BIGINT); nm.push_back("dst");
   return std::move(bd);
 }
-static unique_ptr<GlobalTableFunctionState> BarabasiAlbertInitGlobal(ClientContext &ctx, TableFunctionInitInput &input) { return make_uniq<BarabasiAlbertGlobalState>(); }
-static void BarabasiAlbertFunction(ClientContext &ctx, TableFunctionInput &data, DataChunk &output) {
-  auto &bd = data.bind_data->Cast<BarabasiAlbertBindData>(); auto &gs = data.global_state->Cast<BarabasiAlbertGlobalState>();
-  if (!gs.computed) {
-    int64_t ec = ::onager::onager_generate_barabasi_albert(static_cast<size_t>(bd.n), static_cast<size_t>(bd.m), static_cast<uint64_t>(bd.seed), nullptr, nullptr);
-    if (ec < 0) throw InvalidInputException("Barabasi-Albert failed: " + GetOnagerError());
-    gs.result_src.resize(ec); gs.result_dst.resize(ec);
-    ::onager::onager_generate_barabasi_albert(static_cast<size_t>(bd.n), static_cast<size_t>(bd.m), static_cast<uint64_t>(bd.seed), gs.result_src.data(), gs.result_dst.data());
-    gs.computed = true;
-  }
-  idx_t rem = gs.result_src.size() - gs.output_idx;
-  if (rem == 0) { output.SetCardinality(0); return; }
-  idx_t to = MinValue<idx_t>(rem, STANDARD_VECTOR_SIZE);
-  auto s = GetFlatVectorDataWritable<int64_t>(output.data[0]); auto d = GetFlatVectorDataWritable<int64_t>(output.data[1]);
-  for (idx_t i = 0; i < to; i++) { s[i] = gs.result_src[gs.output_idx+i]; d[i] = gs.result_dst[gs.output_idx+i]; }
-  gs.output_idx += to; output.SetCardinality(to);
+static unique_ptr<GlobalTableFunctionState> BarabasiAlbertInitGlobal(ClientContext &ctx, TableFunctionInitInput &input) {
+  auto &bd = input.bind_data->Cast<BarabasiAlbertBindData>();
+  return make_uniq<EdgeGeneratorGlobalState>(::onager::onager_edge_generator_barabasi_albert(static_cast<size_t>(bd.n), static_cast<size_t>(bd.m), static_cast<uint64_t>(bd.seed)), "Barabasi-Albert");
 }
 
 // =============================================================================
@@ -97,11 +110,6 @@ static void BarabasiAlbertFunction(ClientContext &ctx, TableFunctionInput &data,
 struct WattsStrogatzBindData : public TableFunctionData {
   int64_t n = 10; int64_t k = 4; double beta = 0.5; int64_t seed = 42;
 };
-struct WattsStrogatzGlobalState : public GlobalTableFunctionState {
-  std::vector<int64_t> result_src, result_dst;
-  idx_t output_idx = 0; bool computed = false;
-  idx_t MaxThreads() const override { return 1; }
-};
 
 static unique_ptr<FunctionData> WattsStrogatzBind(ClientContext &ctx, TableFunctionBindInput &input, vector<LogicalType> &rt, vector<string> &nm) {
   auto bd = make_uniq<WattsStrogatzBindData>();
@@ -113,22 +121,9 @@ static unique_ptr<FunctionData> WattsStrogatzBind(ClientContext &ctx, TableFunct
   rt.push_back(LogicalType::BIGINT); nm.push_back("dst");
   return std::move(bd);
 }
-static unique_ptr<GlobalTableFunctionState> WattsStrogatzInitGlobal(ClientContext &ctx, TableFunctionInitInput &input) { return make_uniq<WattsStrogatzGlobalState>(); }
-static void WattsStrogatzFunction(ClientContext &ctx, TableFunctionInput &data, DataChunk &output) {
-  auto &bd = data.bind_data->Cast<WattsStrogatzBindData>(); auto &gs = data.global_state->Cast<WattsStrogatzGlobalState>();
-  if (!gs.computed) {
-    int64_t ec = ::onager::onager_generate_watts_strogatz(static_cast<size_t>(bd.n), static_cast<size_t>(bd.k), bd.beta, static_cast<uint64_t>(bd.seed), nullptr, nullptr);
-    if (ec < 0) throw InvalidInputException("Watts-Strogatz failed: " + GetOnagerError());
-    gs.result_src.resize(ec); gs.result_dst.resize(ec);
-    ::onager::onager_generate_watts_strogatz(static_cast<size_t>(bd.n), static_cast<size_t>(bd.k), bd.beta, static_cast<uint64_t>(bd.seed), gs.result_src.data(), gs.result_dst.data());
-    gs.computed = true;
-  }
-  idx_t rem = gs.result_src.size() - gs.output_idx;
-  if (rem == 0) { output.SetCardinality(0); return; }
-  idx_t to = MinValue<idx_t>(rem, STANDARD_VECTOR_SIZE);
-  auto s = GetFlatVectorDataWritable<int64_t>(output.data[0]); auto d = GetFlatVectorDataWritable<int64_t>(output.data[1]);
-  for (idx_t i = 0; i < to; i++) { s[i] = gs.result_src[gs.output_idx+i]; d[i] = gs.result_dst[gs.output_idx+i]; }
-  gs.output_idx += to; output.SetCardinality(to);
+static unique_ptr<GlobalTableFunctionState> WattsStrogatzInitGlobal(ClientContext &ctx, TableFunctionInitInput &input) {
+  auto &bd = input.bind_data->Cast<WattsStrogatzBindData>();
+  return make_uniq<EdgeGeneratorGlobalState>(::onager::onager_edge_generator_watts_strogatz(static_cast<size_t>(bd.n), static_cast<size_t>(bd.k), bd.beta, static_cast<uint64_t>(bd.seed)), "Watts-Strogatz");
 }
 
 // =============================================================================
@@ -138,17 +133,20 @@ static void WattsStrogatzFunction(ClientContext &ctx, TableFunctionInput &data,
 namespace onager {
 
 void RegisterGeneratorFunctions(ExtensionLoader &loader) {
-  TableFunction erdos_renyi("onager_gen_erdos_renyi", {LogicalType::BIGINT, LogicalType::DOUBLE}, ErdosRenyiFunction, ErdosRenyiBind, ErdosRenyiInitGlobal);
+  TableFunction erdos_renyi("onager_gen_erdos_renyi", {LogicalType::BIGINT, LogicalType::DOUBLE}, EdgeCursorFunction, ErdosRenyiBind, ErdosRenyiInitGlobal);
+  erdos_renyi.init_local = EdgeCursorInitLocal;
   erdos_renyi.named_parameters["seed"] = LogicalType::BIGINT;
   ONAGER_SET_NO_ORDER(erdos_renyi);
   loader.RegisterFunction(erdos_renyi);
 
-  TableFunction barabasi_albert("onager_gen_barabasi_albert", {LogicalType::BIGINT, LogicalType::BIGINT}, BarabasiAlbertFunction, BarabasiAlbertBind, BarabasiAlbertInitGlobal);
+  TableFunction barabasi_albert("onager_gen_barabasi_albert", {LogicalType::BIGINT, LogicalType::BIGINT}, EdgeCursorFunction, BarabasiAlbertBind, BarabasiAlbertInitGlobal);
+  barabasi_albert.init_local = EdgeCursorInitLocal;
   barabasi_albert.named_parameters["seed"] = LogicalType::BIGINT;
   ONAGER_SET_NO_ORDER(barabasi_albert);
   loader.RegisterFunction(barabasi_albert);
 
-  TableFunction watts_strogatz("onager_gen_watts_strogatz", {LogicalType::BIGINT, LogicalType::BIGINT, LogicalType::DOUBLE}, WattsStrogatzFunction, WattsStrogatzBind, WattsStrogatzInitGlobal);
+  TableFunction watts_strogatz("onager_gen_watts_strogatz", {LogicalType::BIGINT, LogicalType::BIGINT, LogicalType::DOUBLE}, EdgeCursorFunction, WattsStrogatzBind, WattsStrogatzInitGlobal);
+  watts_strogatz.init_local = EdgeCursorInitLocal;
   watts_strogatz.named_parameters["seed"] = LogicalType::BIGINT;
   ONAGER_SET_NO_ORDER(watts_strogatz);
   loader.RegisterFunction(watts_strogatz);
@@ -5,209 +5,198 @@
  * Jaccard, Adamic-Adar, Preferential Attachment, Resource Allocation, Common Neighbors.
  */
 #include "functions.hpp"
-#include <mutex>
 
 namespace duckdb {
 
 using namespace onager;
 
+// =============================================================================
+// Shared Link Scoring Options
+// =============================================================================
+// The scored metrics accept top_k, which keeps the k best new links per node, or
+// graph, which scores the input rows as candidate (node1, node2) pairs against a
+// registry graph. Without either option every node pair is scored, except that
+// node filters pushed down onto node1 or node2 go into the Rust call, which then
+// only scores the pairs they allow.
+
+enum LinkMetricCode : uint32_t { LINK_JACCARD = 0, LINK_ADAMIC_ADAR = 1, LINK_RESOURCE_ALLOC = 2, LINK_PREF_ATTACH = 3 };
+
+struct LinkBindData : public GraphBindData {
+  int64_t top_k = 0;
+};
+
+static unique_ptr<LinkBindData> BindLinkOptions(TableFunctionBindInput &input, const std::string &fn) {
+  auto bd = make_uniq<LinkBindData>();
+  CheckInt64Input(input, fn);
+  BindGraphName(input, bd->graph);
+  for (auto &kv : input.named_parameters) if (kv.first == "top_k") bd->top_k = kv.second.GetValue<int64_t>();
+  if (input.named_parameters.count("top_k") && bd->top_k <= 0) throw InvalidInputException(fn + " requires top_k > 0");
+  if (bd->top_k > 0 && !bd->graph.empty()) throw InvalidInputException(fn + " does not support top_k together with graph");
+  return bd;
+}
+
+/** @brief Returns the pushed-down node filter on an output column, inactive if there is none. */
+static ::onager::OnagerNodeFilter LinkNodeFilter(const PushdownInfo &info, idx_t column) {
+  for (auto &filter : info.filters) {
+    if (filter.column == column) return ::onager::OnagerNodeFilter {true, filter.ids.data(), filter.ids.size()};
+  }
+  return ::onager::OnagerNodeFilter {false, nullptr, 0};
+}
+
+static ::onager::OnagerResult *ComputeLinkScores(const LinkBindData &bd, LinkMetricCode metric, const InputBuffer &input) {
+  if (!bd.graph.empty()) return ::onager::onager_graph_score_link_pairs(bd.graph.c_str(), input.I64(0), input.I64(1), input.Size(), metric);
+  if (bd.top_k > 0) return ::onager::onager_compute_link_top_k(input.I64(0), input.I64(1), input.Size(), metric, static_cast<size_t>(bd.top_k));
+  return ::onager::onager_compute_link_scores(input.I64(0), input.I64(1), input.Size(), metric,
+                                              LinkNodeFilter(bd.pushdown, 0), LinkNodeFilter(bd.pushdown, 1));
+}
+
 // =============================================================================
 // Jaccard Coefficient
 // =============================================================================
 
-struct JaccardGlobalState : public GlobalTableFunctionState {
-  std::mutex input_mutex;
-  std::vector<int64_t> src_nodes, dst_nodes, result_n1, result_n2;
-  std::vector<double> result_scores;
+struct JaccardGlobalState : public InputGlobalState {
+  OnagerResultHandle result;
+  OutputLayout layout;
   idx_t output_idx = 0; bool computed = false;
-  idx_t MaxThreads() const override { return 1; }
 };
 
 static unique_ptr<FunctionData> JaccardBind(ClientContext &ctx, TableFunctionBindInput &input, vector<LogicalType> &rt, vector<string> &nm) {
-  CheckInt64Input(input, "onager_lnk_jaccard");
+  auto bd = BindLinkOptions(input, "onager_lnk_jaccard");
   rt.push_back(LogicalType::BIGINT); nm.push_back("node1");
   rt.push_back(LogicalType::BIGINT); nm.push_back("node2");
   rt.push_back(LogicalType::DOUBLE); nm.push_back("coefficient");
-  return make_uniq<TableFunctionData>();
+  SetPushdownSchema(bd->pushdown, rt, {0, 1});
+  return std::move(bd);
 }
-static unique_ptr<GlobalTableFunctionState> JaccardInitGlobal(ClientContext &ctx, TableFunctionInitInput &input) { return make_uniq<JaccardGlobalState>(); }
-static OperatorResultType JaccardInOut(ExecutionContext &ctx, TableFunctionInput &data, DataChunk &input, DataChunk &output) {
-  auto &gs = data.global_state->Cast<JaccardGlobalState>();
-  std::lock_guard<std::mutex> lock(gs.input_mutex);
-  auto s = FlatVector::GetData<int64_t>(input.data[0]); auto d = FlatVector::GetData<int64_t>(input.data[1]);
-  for (idx_t i = 0; i < input.size(); i++) { gs.src_nodes.push_back(s[i]); gs.dst_nodes.push_back(d[i]); }
-  output.SetCardinality(0); return OperatorResultType::NEED_MORE_INPUT;
+static unique_ptr<GlobalTableFunctionState> JaccardInitGlobal(ClientContext &ctx, TableFunctionInitInput &input) {
+  auto gs = make_uniq<JaccardGlobalState>();
+  gs->layout.Init(input.column_ids, input.bind_data->Cast<LinkBindData>().pushdown.schema);
+  return std::move(gs);
 }
 static OperatorFinalizeResultType JaccardFinal(ExecutionContext &ctx, TableFunctionInput &data, DataChunk &output) {
-  auto &gs = data.global_state->Cast<JaccardGlobalState>();
-  std::lock_guard<std::mutex> lock(gs.input_mutex);
+  auto &bd = data.bind_data->Cast<LinkBindData>(); auto &gs = data.global_state->Cast<JaccardGlobalState>();
+  if (!FinishInput(ctx, data)) { output.SetCardinality(0); return OperatorFinalizeResultType::FINISHED; }
   if (!gs.computed) {
-    if (gs.src_nodes.empty()) { gs.computed = true; output.SetCardinality(0); return OperatorFinalizeResultType::FINISHED; }
-    int64_t nc = ::onager::onager_compute_jaccard(gs.src_nodes.data(), gs.dst_nodes.data(), gs.src_nodes.size(), nullptr, nullptr, nullptr);
-    if (nc < 0) throw InvalidInputException("Jaccard failed: " + GetOnagerError());
-    gs.result_n1.resize(nc); gs.result_n2.resize(nc); gs.result_scores.resize(nc);
-    ::onager::onager_compute_jaccard(gs.src_nodes.data(), gs.dst_nodes.data(), gs.src_nodes.size(), gs.result_n1.data(), gs.result_n2.data(), gs.result_scores.data());
+    if (gs.input.Size() == 0) { gs.computed = true; output.SetCardinality(0); return OperatorFinalizeResultType::FINISHED; }
+    gs.result.Set(ComputeLinkScores(bd, LINK_JACCARD, gs.input), "Jaccard");
+    ApplyNodeFilters(gs.result, bd.pushdown);
     gs.computed = true;
   }
-  idx_t rem = gs.result_n1.size() - gs.output_idx;
-  if (rem == 0) { output.SetCardinality(0); return OperatorFinalizeResultType::FINISHED; }
-  idx_t to = MinValue<idx_t>(rem, STANDARD_VECTOR_SIZE);
-  auto n1 = GetFlatVectorDataWritable<int64_t>(output.data[0]); auto n2 = GetFlatVectorDataWritable<int64_t>(output.data[1]); auto sc = GetFlatVectorDataWritable<double>(output.data[2]);
-  for (idx_t i = 0; i < to; i++) { n1[i] = gs.result_n1[gs.output_idx+i]; n2[i] = gs.result_n2[gs.output_idx+i]; sc[i] = gs.result_scores[gs.output_idx+i]; }
-  gs.output_idx += to; output.SetCardinality(to);
-  return gs.output_idx >= gs.result_n1.size() ? OperatorFinalizeResultType::FINISHED : OperatorFinalizeResultType::HAVE_MORE_OUTPUT;
+  return gs.layout.Emit(gs.result, gs.output_idx, output);
 }
 
 // =============================================================================
 // Adamic-Adar Index
 // =============================================================================
 
-struct AdamicAdarGlobalState : public GlobalTableFunctionState {
-  std::mutex input_mutex;
-  std::vector<int64_t> src_nodes, dst_nodes, result_n1, result_n2;
-  std::vector<double> result_scores;
+struct AdamicAdarGlobalState : public InputGlobalState {
+  OnagerResultHandle result;
+  OutputLayout layout;
   idx_t output_idx = 0; bool computed = false;
-  idx_t MaxThreads() const override { return 1; }
 };
 
 static unique_ptr<FunctionData> AdamicAdarBind(ClientContext &ctx, TableFunctionBindInput &input, vector<LogicalType> &rt, vector<string> &nm) {
-  CheckInt64Input(input, "onager_lnk_adamic_adar");
+  auto bd = BindLinkOptions(input, "onager_lnk_adamic_adar");
   rt.push_back(LogicalType::BIGINT); nm.push_back("node1");
   rt.push_back(LogicalType::BIGINT); nm.push_back("node2");
   rt.push_back(LogicalType::DOUBLE); nm.push_back("score");
-  return make_uniq<TableFunctionData>();
+  SetPushdownSchema(bd->pushdown, rt, {0, 1});
+  return std::move(bd);
 }
-static unique_ptr<GlobalTableFunctionState> AdamicAdarInitGlobal(ClientContext &ctx, TableFunctionInitInput &input) { return make_uniq<AdamicAdarGlobalState>(); }
-static OperatorResultType AdamicAdarInOut(ExecutionContext &ctx, TableFunctionInput &data, DataChunk &input, DataChunk &output) {
-  auto &gs = data.global_state->Cast<AdamicAdarGlobalState>();
-  std::lock_guard<std::mutex> lock(gs.input_mutex);
-  auto s = FlatVector::GetData<int64_t>(input.data[0]); auto d = FlatVector::GetData<int64_t>(input.data[1]);
-  for (idx_t i = 0; i < input.size(); i++) { gs.src_nodes.push_back(s[i]); gs.dst_nodes.push_back(d[i]); }
-  output.SetCardinality(0); return OperatorResultType::NEED_MORE_INPUT;
+static unique_ptr<GlobalTableFunctionState> AdamicAdarInitGlobal(ClientContext &ctx, TableFunctionInitInput &input) {
+  auto gs = make_uniq<AdamicAdarGlobalState>();
+  gs->layout.Init(input.column_ids, input.bind_data->Cast<LinkBindData>().pushdown.schema);
+  return std::move(gs);
 }
 static OperatorFinalizeResultType AdamicAdarFinal(ExecutionContext &ctx, TableFunctionInput &data, DataChunk &output) {
-  auto &gs = data.global_state->Cast<AdamicAdarGlobalState>();
-  std::lock_guard<std::mutex> lock(gs.input_mutex);
+  auto &bd = data.bind_data->Cast<LinkBindData>(); auto &gs = data.global_state->Cast<AdamicAdarGlobalState>();
+  if (!FinishInput(ctx, data)) { output.SetCardinality(0); return OperatorFinalizeResultType::FINISHED; }
   if (!gs.computed) {
-    if (gs.src_nodes.empty()) { gs.computed = true; output.SetCardinality(0); return OperatorFinalizeResultType::FINISHED; }
-    int64_t nc = ::onager::onager_compute_adamic_adar(gs.src_nodes.data(), gs.dst_nodes.data(), gs.src_nodes.size(), nullptr, nullptr, nullptr);
-    if (nc < 0) throw InvalidInputException("Adamic-Adar failed: " + GetOnagerError());
-    gs.result_n1.resize(nc); gs.result_n2.resize(nc); gs.result_scores.resize(nc);
-    ::onager::onager_compute_adamic_adar(gs.src_nodes.data(), gs.dst_nodes.data(), gs.src_nodes.size(), gs.result_n1.data(), gs.result_n2.data(), gs.result_scores.data());
+    if (gs.input.Size() == 0) { gs.computed = true; output.SetCardinality(0); return OperatorFinalizeResultType::FINISHED; }
+    gs.result.Set(ComputeLinkScores(bd, LINK_ADAMIC_ADAR, gs.input), "Adamic-Adar");
+    ApplyNodeFilters(gs.result, bd.pushdown);
     gs.computed = true;
   }
-  idx_t rem = gs.result_n1.size() - gs.output_idx;
-  if (rem == 0) { output.SetCardinality(0); return OperatorFinalizeResultType::FINISHED; }
-  idx_t to = MinValue<idx_t>(rem, STANDARD_VECTOR_SIZE);
-  auto n1 = GetFlatVectorDataWritable<int64_t>(output.data[0]); auto n2 = GetFlatVectorDataWritable<int64_t>(output.data[1]); auto sc = GetFlatVectorDataWritable<double>(output.data[2]);
-  for (idx_t i = 0; i < to; i++) { n1[i] = gs.result_n1[gs.output_idx+i]; n2[i] = gs.result_n2[gs.output_idx+i]; sc[i] = gs.result_scores[gs.output_idx+i]; }
-  gs.output_idx += to; output.SetCardinality(to);
-  return gs.output_idx >= gs.result_n1.size() ? OperatorFinalizeResultType::FINISHED : OperatorFinalizeResultType::HAVE_MORE_OUTPUT;
+  return gs.layout.Emit(gs.result, gs.output_idx, output);
 }
 
 // =============================================================================
 // Preferential Attachment
 // =============================================================================
 
-struct PrefAttachGlobalState : public GlobalTableFunctionState {
-  std::mutex input_mutex;
-  std::vector<int64_t> src_nodes, dst_nodes, result_n1, result_n2;
-  std::vector<double> result_scores;
+struct PrefAttachGlobalState : public InputGlobalState {
+  OnagerResultHandle result;
+  OutputLayout layout;
   idx_t output_idx = 0; bool computed = false;
-  idx_t MaxThreads() const override { return 1; }
 };
 
 static unique_ptr<FunctionData> PrefAttachBind(ClientContext &ctx, TableFunctionBindInput &input, vector<LogicalType> &rt, vector<string> &nm) {
-  CheckInt64Input(input, "onager_lnk_pref_attach");
+  auto bd = BindLinkOptions(input, "onager_lnk_pref_attach");
   rt.push_back(LogicalType::BIGINT); nm.push_back("node1");
   rt.push_back(LogicalType::BIGINT); nm.push_back("node2");
   rt.push_back(LogicalType::DOUBLE); nm.push_back("score");
-  return make_uniq<TableFunctionData>();
+  SetPushdownSchema(bd->pushdown, rt, {0, 1});
+  return std::move(bd);
 }
-static unique_ptr<GlobalTableFunctionState> PrefAttachInitGlobal(ClientContext &ctx, TableFunctionInitInput &input) { return make_uniq<PrefAttachGlobalState>(); }
-static OperatorResultType PrefAttachInOut(ExecutionContext &ctx, TableFunctionInput &data, DataChunk &input, DataChunk &output) {
-  auto &gs = data.global_state->Cast<PrefAttachGlobalState>();
-  std::lock_guard<std::mutex> lock(gs.input_mutex);
-  auto s = FlatVector::GetData<int64_t>(input.data[0]); auto d = FlatVector::GetData<int64_t>(input.data[1]);
-  for (idx_t i = 0; i < input.size(); i++) { gs.src_nodes.push_back(s[i]); gs.dst_nodes.push_back(d[i]); }
-  output.SetCardinality(0); return OperatorResultType::NEED_MORE_INPUT;
+static unique_ptr<GlobalTableFunctionState> PrefAttachInitGlobal(ClientContext &ctx, TableFunctionInitInput &input) {
+  auto gs = make_uniq<PrefAttachGlobalState>();
+  gs->layout.Init(input.column_ids, input.bind_data->Cast<LinkBindData>().pushdown.schema);
+  return std::move(gs);
 }
 static OperatorFinalizeResultType PrefAttachFinal(ExecutionContext &ctx, TableFunctionInput &data, DataChunk &output) {
-  auto &gs = data.global_state->Cast<PrefAttachGlobalState>();
-  std::lock_guard<std::mutex> lock(gs.input_mutex);
+  auto &bd = data.bind_data->Cast<LinkBindData>(); auto &gs = data.global_state->Cast<PrefAttachGlobalState>();
+  if (!FinishInput(ctx, data)) { output.SetCardinality(0); return OperatorFinalizeResultType::FINISHED; }
   if (!gs.computed) {
-    if (gs.src_nodes.empty()) { gs.computed = true; output.SetCardinality(0); return OperatorFinalizeResultType::FINISHED; }
-    int64_t nc = ::onager::onager_compute_preferential_attachment(gs.src_nodes.data(), gs.dst_nodes.data(), gs.src_nodes.size(), nullptr, nullptr, nullptr);
-    if (nc < 0) throw InvalidInputException("Preferential Attachment failed: " + GetOnagerError());
-    gs.result_n1.resize(nc); gs.result_n2.resize(nc); gs.result_scores.resize(nc);
-    ::onager::onager_compute_preferential_attachment(gs.src_nodes.data(), gs.dst_nodes.data(), gs.src_nodes.size(), gs.result_n1.data(), gs.result_n2.data(), gs.result_scores.data());
+    if (gs.input.Size() == 0) { gs.computed = true; output.SetCardinality(0); return OperatorFinalizeResultType::FINISHED; }
+    gs.result.Set(ComputeLinkScores(bd, LINK_PREF_ATTACH, gs.input), "Preferential Attachment");
+    ApplyNodeFilters(gs.result, bd.pushdown);
     gs.computed = true;
   }
-  idx_t rem = gs.result_n1.size() - gs.output_idx;
-  if (rem == 0) { output.SetCardinality(0); return OperatorFinalizeResultType::FINISHED; }
-  idx_t to = MinValue<idx_t>(rem, STANDARD_VECTOR_SIZE);
-  auto n1 = GetFlatVectorDataWritable<int64_t>(output.data[0]); auto n2 = GetFlatVectorDataWritable<int64_t>(output.data[1]); auto sc = GetFlatVectorDataWritable<double>(output.data[2]);
-  for (idx_t i = 0; i < to; i++) { n1[i] = gs.result_n1[gs.output_idx+i]; n2[i] = gs.result_n2[gs.output_idx+i]; sc[i] = gs.result_scores[gs.output_idx+i]; }
-  gs.output_idx += to; output.SetCardinality(to);
-  return gs.output_idx >= gs.result_n1.size() ? OperatorFinalizeResultType::FINISHED : OperatorFinalizeResultType::HAVE_MORE_OUTPUT;
+  return gs.layout.Emit(gs.result, gs.output_idx, output);
 }
 
 // =============================================================================
 // Resource Allocation
 // =============================================================================
 
-struct ResourceAllocGlobalState : public GlobalTableFunctionState {
-  std::mutex input_mutex;
-  std::vector<int64_t> src_nodes, dst_nodes, result_n1, result_n2;
-  std::vector<double> result_scores;
+struct ResourceAllocGlobalState : public InputGlobalState {
+  OnagerResultHandle result;
+  OutputLayout layout;
   idx_t output_idx = 0; bool computed = false;
-  idx_t MaxThreads() const override { return 1; }
 };
 
 static unique_ptr<FunctionData> ResourceAllocBind(ClientContext &ctx, TableFunctionBindInput &input, vector<LogicalType> &rt, vector<string> &nm) {
-  CheckInt64Input(input, "onager_lnk_resource_alloc");
+  auto bd = BindLinkOptions(input, "onager_lnk_resource_alloc");
   rt.push_back(LogicalType::BIGINT); nm.push_back("node1");
   rt.push_back(LogicalType::BIGINT); nm.push_back("node2");
   rt.push_back(LogicalType::DOUBLE); nm.push_back("score");
-  return make_uniq<TableFunctionData>();
+  SetPushdownSchema(bd->pushdown, rt, {0, 1});
+  return std::move(bd);
 }
-static unique_ptr<GlobalTableFunctionState> ResourceAllocInitGlobal(ClientContext &ctx, TableFunctionInitInput &input) { return make_uniq<ResourceAllocGlobalState>(); }
-static OperatorResultType ResourceAllocInOut(ExecutionContext &ctx, TableFunctionInput &data, DataChunk &input, DataChunk &output) {
-  auto &gs = data.global_state->Cast<ResourceAllocGlobalState>();
-  std::lock_guard<std::mutex> lock(gs.input_mutex);
-  auto s = FlatVector::GetData<int64_t>(input.data[0]); auto d = FlatVector::GetData<int64_t>(input.data[1]);
-  for (idx_t i = 0; i < input.size(); i++) { gs.src_nodes.push_back(s[i]); gs.dst_nodes.push_back(d[i]); }
-  output.SetCardinality(0); return OperatorResultType::NEED_MORE_INPUT;
+static unique_ptr<GlobalTableFunctionState> ResourceAllocInitGlobal(ClientContext &ctx, TableFunctionInitInput &input) {
+  auto gs = make_uniq<ResourceAllocGlobalState>();
+  gs->layout.Init(input.column_ids, input.bind_data->Cast<LinkBindData>().pushdown.schema);
+  return std::move(gs);
 }
 static OperatorFinalizeResultType ResourceAllocFinal(ExecutionContext &ctx, TableFunctionInput &data, DataChunk &output) {
-  auto &gs = data.global_state->Cast<ResourceAllocGlobalState>();
-  std::lock_guard<std::mutex> lock(gs.input_mutex);
+  auto &bd = data.bind_data->Cast<LinkBindData>(); auto &gs = data.global_state->Cast<ResourceAllocGlobalState>();
+  if (!FinishInput(ctx, data)) { output.SetCardinality(0); return OperatorFinalizeResultType::FINISHED; }
   if (!gs.computed) {
-    if (gs.src_nodes.empty()) { gs.computed = true; output.SetCardinality(0); return OperatorFinalizeResultType::FINISHED; }
-    int64_t nc = ::onager::onager_compute_resource_allocation(gs.src_nodes.data(), gs.dst_nodes.data(), gs.src_nodes.size(), nullptr, nullptr, nullptr);
-    if (nc < 0) throw InvalidInputException("Resource Allocation failed: " + GetOnagerError());
-    gs.result_n1.resize(nc); gs.result_n2.resize(nc); gs.result_scores.resize(nc);
-    ::onager::onager_compute_resource_allocation(gs.src_nodes.data(), gs.dst_nodes.data(), gs.src_nodes.size(), gs.result_n1.data(), gs.result_n2.data(), gs.result_scores.data());
+    if (gs.input.Size() == 0) { gs.computed = true; output.SetCardinality(0); return OperatorFinalizeResultType::FINISHED; }
+    gs.result.Set(ComputeLinkScores(bd, LINK_RESOURCE_ALLOC, gs.input), "Resource Allocation");
+    ApplyNodeFilters(gs.result, bd.pushdown);
     gs.computed = true;
   }
-  idx_t rem = gs.result_n1.size() - gs.output_idx;
-  if (rem == 0) { output.SetCardinality(0); return OperatorFinalizeResultType::FINISHED; }
-  idx_t to = MinValue<idx_t>(rem, STANDARD_VECTOR_SIZE);
-  auto n1 = GetFlatVectorDataWritable<int64_t>(output.data[0]); auto n2 = GetFlatVectorDataWritable<int64_t>(output.data[1]); auto sc = GetFlatVectorDataWritable<double>(output.data[2]);
-  for (idx_t i = 0; i < to; i++) { n1[i] = gs.result_n1[gs.output_idx+i]; n2[i] = gs.result_n2[gs.output_idx+i]; sc[i] = gs.result_scores[gs.output_idx+i]; }
-  gs.output_idx += to; output.SetCardinality(to);
-  return gs.output_idx >= gs.result_n1.size() ? OperatorFinalizeResultType::FINISHED : OperatorFinalizeResultType::HAVE_MORE_OUTPUT;
+  return gs.layout.Emit(gs.result, gs.output_idx, output);
 }
 
 // =============================================================================
 // Common Neighbors
 // =============================================================================
 
-struct CommonNeighborsGlobalState : public GlobalTableFunctionState {
-  std::mutex input_mutex;
-  std::vector<int64_t> src_nodes, dst_nodes, result_n1, result_n2, result_counts;
+struct CommonNeighborsGlobalState : public InputGlobalState {
+  OnagerResultHandle result;
   idx_t output_idx = 0; bool computed = false;
-  idx_t MaxThreads() const override { return 1; }
 };
 
 static unique_ptr<FunctionData> CommonNeighborsBind(ClientContext &ctx, TableFunctionBindInput &input, vector<LogicalType> &rt, vector<string> &nm) {
@@ -218,31 +207,15 @@ static unique_ptr<FunctionData> CommonNeighborsBind(ClientContext &ctx, TableFun
   return make_uniq<TableFunctionData>();
 }
 static unique_ptr<GlobalTableFunctionState> CommonNeighborsInitGlobal(ClientContext &ctx, TableFunctionInitInput &input) { return make_uniq<CommonNeighborsGlobalState>(); }
-static OperatorResultType CommonNeighborsInOut(ExecutionContext &ctx, TableFunctionInput &data, DataChunk &input, DataChunk &output) {
-  auto &gs = data.global_state->Cast<CommonNeighborsGlobalState>();
-  std::lock_guard<std::mutex> lock(gs.input_mutex);
-  auto s = FlatVector::GetData<int64_t>(input.data[0]); auto d = FlatVector::GetData<int64_t>(input.data[1]);
-  for (idx_t i = 0; i < input.size(); i++) { gs.src_nodes.push_back(s[i]); gs.dst_nodes.push_back(d[i]); }
-  output.SetCardinality(0); return OperatorResultType::NEED_MORE_INPUT;
-}
 static OperatorFinalizeResultType CommonNeighborsFinal(ExecutionContext &ctx, TableFunctionInput &data, DataChunk &output) {
   auto &gs = data.global_state->Cast<CommonNeighborsGlobalState>();
-  std::lock_guard<std::mutex> lock(gs.input_mutex);
+  if (!FinishInput(ctx, data)) { output.SetCardinality(0); return OperatorFinalizeResultType::FINISHED; }
   if (!gs.computed) {
-    if (gs.src_nodes.empty()) { gs.computed = true; output.SetCardinality(0); return OperatorFinalizeResultType::FINISHED; }
-    int64_t nc = ::onager::onager_compute_common_neighbors(gs.src_nodes.data(), gs.dst_nodes.data(), gs.src_nodes.size(), nullptr, nullptr, nullptr);
-    if (nc < 0) throw InvalidInputException("CommonNeighbors failed: " + GetOnagerError());
-    gs.result_n1.resize(nc); gs.result_n2.resize(nc); gs.result_counts.resize(nc);
-    ::onager::onager_compute_common_neighbors(gs.src_nodes.data(), gs.dst_nodes.data(), gs.src_nodes.size(), gs.result_n1.data(), gs.result_n2.data(), gs.result_counts.data());
+    if (gs.input.Size() == 0) { gs.computed = true; output.SetCardinality(0); return OperatorFinalizeResultType::FINISHED; }
+    gs.result.Set(::onager::onager_compute_common_neighbors(gs.input.I64(0), gs.input.I64(1), gs.input.Size()), "CommonNeighbors");
     gs.computed = true;
   }
-  idx_t rem = gs.result_n1.size() - gs.output_idx;
-  if (rem == 0) { output.SetCardinality(0); return OperatorFinalizeResultType::FINISHED; }
-  idx_t to = MinValue<idx_t>(rem, STANDARD_VECTOR_SIZE);
-  auto n1 = GetFlatVectorDataWritable<int64_t>(output.data[0]); auto n2 = GetFlatVectorDataWritable<int64_t>(output.data[1]); auto cnt = GetFlatVectorDataWritable<int64_t>(output.data[2]);
-  for (idx_t i = 0; i < to; i++) { n1[i] = gs.result_n1[gs.output_idx+i]; n2[i] = gs.result_n2[gs.output_idx+i]; cnt[i] = gs.result_counts[gs.output_idx+i]; }
-  gs.output_idx += to; output.SetCardinality(to);
-  return gs.output_idx >= gs.result_n1.size() ? OperatorFinalizeResultType::FINISHED : OperatorFinalizeResultType::HAVE_MORE_OUTPUT;
+  return EmitResultChunk(gs.result, gs.output_idx, output);
 }
 
 // =============================================================================
@@ -253,31 +226,48 @@ namespace onager {
 
 void RegisterLinkFunctions(ExtensionLoader &loader) {
   TableFunction jaccard("onager_lnk_jaccard", {LogicalType::TABLE}, nullptr, JaccardBind, JaccardInitGlobal);
-  jaccard.in_out_function = JaccardInOut;
+  jaccard.in_out_function = CollectInput;
+  jaccard.init_local = InitInputLocal<2>;
+  jaccard.named_parameters["top_k"] = LogicalType::BIGINT;
+  jaccard.named_parameters["graph"] = LogicalType::VARCHAR;
   jaccard.in_out_function_final = JaccardFinal;
+  EnablePushdown(jaccard);
   ONAGER_SET_NO_ORDER(jaccard);
   loader.RegisterFunction(jaccard);
 
   TableFunction adamic_adar("onager_lnk_adamic_adar", {LogicalType::TABLE}, nullptr, AdamicAdarBind, AdamicAdarInitGlobal);
-  adamic_adar.in_out_function = AdamicAdarInOut;
+  adamic_adar.in_out_function = CollectInput;
+  adamic_adar.init_local = InitInputLocal<2>;
+  adamic_adar.named_parameters["top_k"] = LogicalType::BIGINT;
+  adamic_adar.named_parameters["graph"] = LogicalType::VARCHAR;
   adamic_adar.in_out_function_final = AdamicAdarFinal;
+  EnablePushdown(adamic_adar);
   ONAGER_SET_NO_ORDER(adamic_adar);
   loader.RegisterFunction(adamic_adar);
 
   TableFunction pref_attach("onager_lnk_pref_attach", {LogicalType::TABLE}, nullptr, PrefAttachBind, PrefAttachInitGlobal);
-  pref_attach.in_out_function = PrefAttachInOut;
+  pref_attach.in_out_function = CollectInput;
+  pref_attach.init_local = InitInputLocal<2>;
+  pref_attach.named_parameters["top_k"] = LogicalType::BIGINT;
+  pref_attach.named_parameters["graph"] = LogicalType::VARCHAR;
   pref_attach.in_out_function_final = PrefAttachFinal;
+  EnablePushdown(pref_attach);
   ONAGER_SET_NO_ORDER(pref_attach);
   loader.RegisterFunction(pref_attach);
 
   TableFunction resource_alloc("onager_lnk_resource_alloc", {LogicalType::TABLE}, nullptr, ResourceAllocBind, ResourceAllocInitGlobal);
-  resource_alloc.in_out_function = ResourceAllocInOut;
+  resource_alloc.in_out_function = CollectInput;
+  resource_alloc.init_local = InitInputLocal<2>;
+  resource_alloc.named_parameters["top_k"] = LogicalType::BIGINT;
+  resource_alloc.named_parameters["graph"] = LogicalType::VARCHAR;
   resource_alloc.in_out_function_final = ResourceAllocFinal;
+  EnablePushdown(resource_alloc);
   ONAGER_SET_NO_ORDER(resource_alloc);
   loader.RegisterFunction(resource_alloc);
 
   TableFunction common_neighbors("onager_lnk_common_neighbors", {LogicalType::TABLE}, nullptr, CommonNeighborsBind, CommonNeighborsInitGlobal);
-  common_neighbors.in_out_function = CommonNeighborsInOut;
+  common_neighbors.in_out_function = CollectInput;
+  common_neighbors.init_local = InitInputLocal<2>;
   common_neighbors.in_out_function_final = CommonNeighborsFinal;
   ONAGER_SET_NO_ORDER(common_neighbors);
   loader.RegisterFunction(common_neighbors);
@@ -2,10 +2,9 @@
  * @file parallel.cpp
  * @brief Parallel algorithm table functions for Onager DuckDB extension.
  *
- * Parallel PageRank, BFS, Shortest Paths, Connected Components, Clustering Coefficients, Triangle Count.
+ * Parallel PageRank, BFS, Shortest Paths, Connected Components, Clustering Coefficients, Triangle Count, Louvain.
  */
 #include "functions.hpp"
-#include <mutex>
 
 namespace duckdb {
 
@@ -15,57 +14,64 @@ using namespace onager;
 // Parallel PageRank
 // =============================================================================
 
-struct ParallelPageRankBindData : public TableFunctionData {
+struct ParallelPageRankBindData : public GraphBindData {
   double damping = 0.85;
   int64_t iterations = 100;
+  double tolerance = 1e-6;
   bool directed = true;
+  bool prior = false;
+  WeightColumn weights;
 };
-struct ParallelPageRankGlobalState : public GlobalTableFunctionState {
-  std::mutex input_mutex;
-  std::vector<int64_t> src_nodes, dst_nodes, result_nodes;
-  std::vector<double> result_ranks;
+struct ParallelPageRankGlobalState : public InputGlobalState {
+  OnagerResultHandle result;
   idx_t output_idx = 0; bool computed = false;
-  idx_t MaxThreads() const override { return 1; }
 };
 
 static unique_ptr<FunctionData> ParallelPageRankBind(ClientContext &ctx, TableFunctionBindInput &input, vector<LogicalType> &rt, vector<string> &nm) {
   auto bd = make_uniq<ParallelPageRankBindData>();
-  CheckInt64Input(input, "onager_par_pagerank");
+  if (!BindGraphName(input, bd->graph)) {
+    CheckInt64Input(input, "onager_par_pagerank");
+    bd->weights.Bind(input);
+  } else if (!input.input_table_types.empty()) {
+    if (input.input_table_types.size() != 2 || input.input_table_types[0] != LogicalType::BIGINT || input.input_table_types[1] != LogicalType::DOUBLE) {
+      throw InvalidInputException("onager_par_pagerank with graph requires prior (node_id BIGINT, rank DOUBLE) columns. Please cast them (e.g. rank::double)");
+    }
+    bd->prior = true;
+  }
   for (auto &kv : input.named_parameters) {
     if (kv.first == "damping") bd->damping = kv.second.GetValue<double>();
     if (kv.first == "iterations") bd->iterations = kv.second.GetValue<int64_t>();
+    if (kv.first == "tolerance") bd->tolerance = kv.second.GetValue<double>();
     if (kv.first == "directed") bd->directed = kv.second.GetValue<bool>();
   }
   rt.push_back(LogicalType::BIGINT); nm.push_back("node_id");
   rt.push_back(LogicalType::DOUBLE); nm.push_back("rank");
+  rt.push_back(LogicalType::BIGINT); nm.push_back("iterations");
   return std::move(bd);
 }
 static unique_ptr<GlobalTableFunctionState> ParallelPageRankInitGlobal(ClientContext &ctx, TableFunctionInitInput &input) { return make_uniq<ParallelPageRankGlobalState>(); }
-static OperatorResultType ParallelPageRankInOut(ExecutionContext &ctx, TableFunctionInput &data, DataChunk &input, DataChunk &output) {
-  auto &gs = data.global_state->Cast<ParallelPageRankGlobalState>();
-  std::lock_guard<std::mutex> lock(gs.input_mutex);
-  auto s = FlatVector::GetData<int64_t>(input.data[0]); auto d = FlatVector::GetData<int64_t>(input.data[1]);
-  for (idx_t i = 0; i < input.size(); i++) { gs.src_nodes.push_back(s[i]); gs.dst_nodes.push_back(d[i]); }
-  output.SetCardinality(0); return OperatorResultType::NEED_MORE_INPUT;
+static unique_ptr<LocalTableFunctionState> ParallelPageRankInitLocal(ExecutionContext &ctx, TableFunctionInitInput &input, GlobalTableFunctionState *global_state) {
+  auto &bd = input.bind_data->Cast<ParallelPageRankBindData>();
+  return bd.prior ? MakeInputLocal(global_state, 1, 1) : bd.weights.MakeLocal(global_state);
 }
 static OperatorFinalizeResultType ParallelPageRankFinal(ExecutionContext &ctx, TableFunctionInput &data, DataChunk &output) {
   auto &bd = data.bind_data->Cast<ParallelPageRankBindData>(); auto &gs = data.global_state->Cast<ParallelPageRankGlobalState>();
-  std::lock_guard<std::mutex> lock(gs.input_mutex);
+  if (!FinishInput(ctx, data, bd.prior)) { output.SetCardinality(0); return OperatorFinalizeResultType::FINISHED; }
   if (!gs.computed) {
-    if (gs.src_nodes.empty()) { gs.computed = true; output.SetCardinality(0); return OperatorFinalizeResultType::FINISHED; }
-    int64_t nc = ::onager::onager_compute_pagerank_parallel(gs.src_nodes.data(), gs.dst_nodes.data(), gs.src_nodes.size(), nullptr, 0, bd.damping, bd.iterations, bd.directed, nullptr, nullptr);
-    if (nc < 0) throw InvalidInputException("Parallel PageRank failed: " + GetOnagerError());
-    gs.result_nodes.resize(nc); gs.result_ranks.resize(nc);
-    ::onager::onager_compute_pagerank_parallel(gs.src_nodes.data(), gs.dst_nodes.data(), gs.src_nodes.size(), nullptr, 0, bd.damping, bd.iterations, bd.directed, gs.result_nodes.data(), gs.result_ranks.data());
+    if (bd.prior) {
+      gs.result.Set(::onager::onager_graph_compute_pagerank(bd.graph.c_str(), bd.damping, bd.iterations, bd.tolerance, gs.input.I64(0), gs.input.F64(0), gs.input.Size()), "Parallel PageRank");
+      gs.computed = true;
+      return EmitResultChunk(gs.result, gs.output_idx, output);
+    }
+    if (gs.input.Size() == 0) { gs.computed = true; output.SetCardinality(0); return OperatorFinalizeResultType::FINISHED; }
+    gs.result.Set(::onager::onager_compute_pagerank_parallel(gs.input.I64(0), gs.input.I64(1), gs.input.Size(), bd.weights.Data(gs.input), bd.weights.Size(gs.input), bd.damping, bd.iterations, bd.tolerance, bd.directed), "Parallel PageRank");
     gs.computed = true;
   }
-  idx_t rem = gs.result_nodes.size() - gs.output_idx;
-  if (rem == 0) { output.SetCardinality(0); return OperatorFinalizeResultType::FINISHED; }
-  idx_t to = MinValue<idx_t>(rem, STANDARD_VECTOR_SIZE);
-  auto n = GetFlatVectorDataWritable<int64_t>(output.data[0]); auto r = GetFlatVectorDataWritable<double>(output.data[1]);
-  for (idx_t i = 0; i < to; i++) { n[i] = gs.result_nodes[gs.output_idx+i]; r[i] = gs.result_ranks[gs.output_idx+i]; }
-  gs.output_idx += to; output.SetCardinality(to);
-  return gs.output_idx >= gs.result_nodes.size() ? OperatorFinalizeResultType::FINISHED : OperatorFinalizeResultType::HAVE_MORE_OUTPUT;
+  return EmitResultChunk(gs.result, gs.output_idx, output);
+}
+static void ParallelPageRankGraphScan(ClientContext &ctx, TableFunctionInput &data, DataChunk &output) {
+  auto &bd = data.bind_data->Cast<ParallelPageRankBindData>();
+  EmitGraphResult(ctx, data, output, "Parallel PageRank", [&](const char *graph) { return ::onager::onager_graph_compute_pagerank(graph, bd.damping, bd.iterations, bd.tolerance, nullptr, nullptr, 0); });
 }
 
 // =============================================================================
@@ -73,11 +79,9 @@ static OperatorFinalizeResultType ParallelPageRankFinal(ExecutionContext &ctx, T
 // =============================================================================
 
 struct ParallelBfsBindData : public TableFunctionData { int64_t source = 0; };
-struct ParallelBfsGlobalState : public GlobalTableFunctionState {
-  std::mutex input_mutex;
-  std::vector<int64_t> src_nodes, dst_nodes, result_order;
+struct ParallelBfsGlobalState : public InputGlobalState {
+  OnagerResultHandle result;
   idx_t output_idx = 0; bool computed = false;
-  idx_t MaxThreads() const override { return 1; }
 };
 
 static unique_ptr<FunctionData> ParallelBfsBind(ClientContext &ctx, TableFunctionBindInput &input, vector<LogicalType> &rt, vector<string> &nm) {
@@ -88,31 +92,15 @@ static unique_ptr<FunctionData> ParallelBfsBind(ClientContext &ctx, TableFunctio
   return std::move(bd);
 }
 static unique_ptr<GlobalTableFunctionState> ParallelBfsInitGlobal(ClientContext &ctx, TableFunctionInitInput &input) { return make_uniq<ParallelBfsGlobalState>(); }
-static OperatorResultType ParallelBfsInOut(ExecutionContext &ctx, TableFunctionInput &data, DataChunk &input, DataChunk &output) {
-  auto &gs = data.global_state->Cast<ParallelBfsGlobalState>();
-  std::lock_guard<std::mutex> lock(gs.input_mutex);
-  auto s = FlatVector::GetData<int64_t>(input.data[0]); auto d = FlatVector::GetData<int64_t>(input.data[1]);
-  for (idx_t i = 0; i < input.size(); i++) { gs.src_nodes.push_back(s[i]); gs.dst_nodes.push_back(d[i]); }
-  output.SetCardinality(0); return OperatorResultType::NEED_MORE_INPUT;
-}
 static OperatorFinalizeResultType ParallelBfsFinal(ExecutionContext &ctx, TableFunctionInput &data, DataChunk &output) {
   auto &bd = data.bind_data->Cast<ParallelBfsBindData>(); auto &gs = data.global_state->Cast<ParallelBfsGlobalState>();
-  std::lock_guard<std::mutex> lock(gs.input_mutex);
+  if (!FinishInput(ctx, data)) { output.SetCardinality(0); return OperatorFinalizeResultType::FINISHED; }
   if (!gs.computed) {
-    if (gs.src_nodes.empty()) { gs.computed = true; output.SetCardinality(0); return OperatorFinalizeResultType::FINISHED; }
-    int64_t nc = ::onager::onager_compute_bfs_parallel(gs.src_nodes.data(), gs.dst_nodes.data(), gs.src_nodes.size(), bd.source, nullptr);
-    if (nc < 0) throw InvalidInputException("Parallel BFS failed: " + GetOnagerError());
-    gs.result_order.resize(nc);
-    ::onager::onager_compute_bfs_parallel(gs.src_nodes.data(), gs.dst_nodes.data(), gs.src_nodes.size(), bd.source, gs.result_order.data());
+    if (gs.input.Size() == 0) { gs.computed = true; output.SetCardinality(0); return OperatorFinalizeResultType::FINISHED; }
+    gs.result.Set(::onager::onager_compute_bfs_parallel(gs.input.I64(0), gs.input.I64(1), gs.input.Size(), bd.source), "Parallel BFS");
     gs.computed = true;
   }
-  idx_t rem = gs.result_order.size() - gs.output_idx;
-  if (rem == 0) { output.SetCardinality(0); return OperatorFinalizeResultType::FINISHED; }
-  idx_t to = MinValue<idx_t>(rem, STANDARD_VECTOR_SIZE);
-  auto n = GetFlatVectorDataWritable<int64_t>(output.data[0]);
-  for (idx_t i = 0; i < to; i++) { n[i] = gs.result_order[gs.output_idx+i]; }
-  gs.output_idx += to; output.SetCardinality(to);
-  return gs.output_idx >= gs.result_order.size() ? OperatorFinalizeResultType::FINISHED : OperatorFinalizeResultType::HAVE_MORE_OUTPUT;
+  return EmitResultChunk(gs.result, gs.output_idx, output);
 }
 
 // =============================================================================
@@ -120,12 +108,9 @@ static OperatorFinalizeResultType ParallelBfsFinal(ExecutionContext &ctx, TableF
 // =============================================================================
 
 struct ParallelPathsBindData : public TableFunctionData { int64_t source = 0; };
-struct ParallelPathsGlobalState : public GlobalTableFunctionState {
-  std::mutex input_mutex;
-  std::vector<int64_t> src_nodes, dst_nodes, result_nodes;
-  std::vector<double> result_distances;
+struct ParallelPathsGlobalState : public InputGlobalState {
+  OnagerResultHandle result;
   idx_t output_idx = 0; bool computed = false;
-  idx_t MaxThreads() const override { return 1; }
 };
 
 static unique_ptr<FunctionData> ParallelPathsBind(ClientContext &ctx, TableFunctionBindInput &input, vector<LogicalType> &rt, vector<string> &nm) {
@@ -137,42 +122,24 @@ static unique_ptr<FunctionData> ParallelPathsBind(ClientContext &ctx, TableFunct
   return std::move(bd);
 }
 static unique_ptr<GlobalTableFunctionState> ParallelPathsInitGlobal(ClientContext &ctx, TableFunctionInitInput &input) { return make_uniq<ParallelPathsGlobalState>(); }
-static OperatorResultType ParallelPathsInOut(ExecutionContext &ctx, TableFunctionInput &data, DataChunk &input, DataChunk &output) {
-  auto &gs = data.global_state->Cast<ParallelPathsGlobalState>();
-  std::lock_guard<std::mutex> lock(gs.input_mutex);
-  auto s = FlatVector::GetData<int64_t>(input.data[0]); auto d = FlatVector::GetData<int64_t>(input.data[1]);
-  for (idx_t i = 0; i < input.size(); i++) { gs.src_nodes.push_back(s[i]); gs.dst_nodes.push_back(d[i]); }
-  output.SetCardinality(0); return OperatorResultType::NEED_MORE_INPUT;
-}
 static OperatorFinalizeResultType ParallelPathsFinal(ExecutionContext &ctx, TableFunctionInput &data, DataChunk &output) {
   auto &bd = data.bind_data->Cast<ParallelPathsBindData>(); auto &gs = data.global_state->Cast<ParallelPathsGlobalState>();
-  std::lock_guard<std::mutex> lock(gs.input_mutex);
+  if (!FinishInput(ctx, data)) { output.SetCardinality(0); return OperatorFinalizeResultType::FINISHED; }
   if (!gs.computed) {
-    if (gs.src_nodes.empty()) { gs.computed = true; output.SetCardinality(0); return OperatorFinalizeResultType::FINISHED; }
-    int64_t nc = ::onager::onager_compute_shortest_paths_parallel(gs.src_nodes.data(), gs.dst_nodes.data(), gs.src_nodes.size(), bd.source, nullptr, nullptr);
-    if (nc < 0) throw InvalidInputException("Parallel shortest paths failed: " + GetOnagerError());
-    gs.result_nodes.resize(nc); gs.result_distances.resize(nc);
-    ::onager::onager_compute_shortest_paths_parallel(gs.src_nodes.data(), gs.dst_nodes.data(), gs.src_nodes.size(), bd.source, gs.result_nodes.data(), gs.result_distances.data());
+    if (gs.input.Size() == 0) { gs.computed = true; output.SetCardinality(0); return OperatorFinalizeResultType::FINISHED; }
+    gs.result.Set(::onager::onager_compute_shortest_paths_parallel(gs.input.I64(0), gs.input.I64(1), gs.input.Size(), bd.source), "Parallel shortest paths");
     gs.computed = true;
   }
-  idx_t rem = gs.result_nodes.size() - gs.output_idx;
-  if (rem == 0) { output.SetCardinality(0); return OperatorFinalizeResultType::FINISHED; }
-  idx_t to = MinValue<idx_t>(rem, STANDARD_VECTOR_SIZE);
-  auto n = GetFlatVectorDataWritable<int64_t>(output.data[0]); auto d = GetFlatVectorDataWritable<double>(output.data[1]);
-  for (idx_t i = 0; i < to; i++) { n[i] = gs.result_nodes[gs.output_idx+i]; d[i] = gs.result_distances[gs.output_idx+i]; }
-  gs.output_idx += to; output.SetCardinality(to);
-  return gs.output_idx >= gs.result_nodes.size() ? OperatorFinalizeResultType::FINISHED : OperatorFinalizeResultType::HAVE_MORE_OUTPUT;
+  return EmitResultChunk(gs.result, gs.output_idx, output);
 }
 
 // =============================================================================
 // Parallel Connected Components
 // =============================================================================
 
-struct ParallelComponentsGlobalState : public GlobalTableFunctionState {
-  std::mutex input_mutex;
-  std::vector<int64_t> src_nodes, dst_nodes, result_nodes, result_components;
+struct ParallelComponentsGlobalState : public InputGlobalState {
+  OnagerResultHandle result;
   idx_t output_idx = 0; bool computed = false;
-  idx_t MaxThreads() const override { return 1; }
 };
 
 static unique_ptr<FunctionData> ParallelComponentsBind(ClientContext &ctx, TableFunctionBindInput &input, vector<LogicalType> &rt, vector<string> &nm) {
@@ -182,43 +149,24 @@ static unique_ptr<FunctionData> ParallelComponentsBind(ClientContext &ctx, Table
   return make_uniq<TableFunctionData>();
 }
 static unique_ptr<GlobalTableFunctionState> ParallelComponentsInitGlobal(ClientContext &ctx, TableFunctionInitInput &input) { return make_uniq<ParallelComponentsGlobalState>(); }
-static OperatorResultType ParallelComponentsInOut(ExecutionContext &ctx, TableFunctionInput &data, DataChunk &input, DataChunk &output) {
-  auto &gs = data.global_state->Cast<ParallelComponentsGlobalState>();
-  std::lock_guard<std::mutex> lock(gs.input_mutex);
-  auto s = FlatVector::GetData<int64_t>(input.data[0]); auto d = FlatVector::GetData<int64_t>(input.data[1]);
-  for (idx_t i = 0; i < input.size(); i++) { gs.src_nodes.push_back(s[i]); gs.dst_nodes.push_back(d[i]); }
-  output.SetCardinality(0); return OperatorResultType::NEED_MORE_INPUT;
-}
 static OperatorFinalizeResultType ParallelComponentsFinal(ExecutionContext &ctx, TableFunctionInput &data, DataChunk &output) {
   auto &gs = data.global_state->Cast<ParallelComponentsGlobalState>();
-  std::lock_guard<std::mutex> lock(gs.input_mutex);
+  if (!FinishInput(ctx, data)) { output.SetCardinality(0); return OperatorFinalizeResultType::FINISHED; }
   if (!gs.computed) {
-    if (gs.src_nodes.empty()) { gs.computed = true; output.SetCardinality(0); return OperatorFinalizeResultType::FINISHED; }
-    int64_t nc = ::onager::onager_compute_components_parallel(gs.src_nodes.data(), gs.dst_nodes.data(), gs.src_nodes.size(), nullptr, nullptr);
-    if (nc < 0) throw InvalidInputException("Parallel components failed: " + GetOnagerError());
-    gs.result_nodes.resize(nc); gs.result_components.resize(nc);
-    ::onager::onager_compute_components_parallel(gs.src_nodes.data(), gs.dst_nodes.data(), gs.src_nodes.size(), gs.result_nodes.data(), gs.result_components.data());
+    if (gs.input.Size() == 0) { gs.computed = true; output.SetCardinality(0); return OperatorFinalizeResultType::FINISHED; }
+    gs.result.Set(::onager::onager_compute_components_parallel(gs.input.I64(0), gs.input.I64(1), gs.input.Size()), "Parallel components");
     gs.computed = true;
   }
-  idx_t rem = gs.result_nodes.size() - gs.output_idx;
-  if (rem == 0) { output.SetCardinality(0); return OperatorFinalizeResultType::FINISHED; }
-  idx_t to = MinValue<idx_t>(rem, STANDARD_VECTOR_SIZE);
-  auto n = GetFlatVectorDataWritable<int64_t>(output.data[0]); auto c = GetFlatVectorDataWritable<int64_t>(output.data[1]);
-  for (idx_t i = 0; i < to; i++) { n[i] = gs.result_nodes[gs.output_idx+i]; c[i] = gs.result_components[gs.output_idx+i]; }
-  gs.output_idx += to; output.SetCardinality(to);
-  return gs.output_idx >= gs.result_nodes.size() ? OperatorFinalizeResultType::FINISHED : OperatorFinalizeResultType::HAVE_MORE_OUTPUT;
+  return EmitResultChunk(gs.result, gs.output_idx, output);
 }
 
 // =============================================================================
 // Parallel Clustering Coefficients
 // =============================================================================
 
-struct ParallelClusteringGlobalState : public GlobalTableFunctionState {
-  std::mutex input_mutex;
-  std::vector<int64_t> src_nodes, dst_nodes, result_nodes;
-  std::vector<double> result_coefficients;
+struct ParallelClusteringGlobalState : public InputGlobalState {
+  OnagerResultHandle result;
   idx_t output_idx = 0; bool computed = false;
-  idx_t MaxThreads() const override { return 1; }
 };
 
 static unique_ptr<FunctionData> ParallelClusteringBind(ClientContext &ctx, TableFunctionBindInput &input, vector<LogicalType> &rt, vector<string> &nm) {
@@ -228,42 +176,24 @@ static unique_ptr<FunctionData> ParallelClusteringBind(ClientContext &ctx, Table
   return make_uniq<TableFunctionData>();
 }
 static unique_ptr<GlobalTableFunctionState> ParallelClusteringInitGlobal(ClientContext &ctx, TableFunctionInitInput &input) { return make_uniq<ParallelClusteringGlobalState>(); }
-static OperatorResultType ParallelClusteringInOut(ExecutionContext &ctx, TableFunctionInput &data, DataChunk &input, DataChunk &output) {
-  auto &gs = data.global_state->Cast<ParallelClusteringGlobalState>();
-  std::lock_guard<std::mutex> lock(gs.input_mutex);
-  auto s = FlatVector::GetData<int64_t>(input.data[0]); auto d = FlatVector::GetData<int64_t>(input.data[1]);
-  for (idx_t i = 0; i < input.size(); i++) { gs.src_nodes.push_back(s[i]); gs.dst_nodes.push_back(d[i]); }
-  output.SetCardinality(0); return OperatorResultType::NEED_MORE_INPUT;
-}
 static OperatorFinalizeResultType ParallelClusteringFinal(ExecutionContext &ctx, TableFunctionInput &data, DataChunk &output) {
   auto &gs = data.global_state->Cast<ParallelClusteringGlobalState>();
-  std::lock_guard<std::mutex> lock(gs.input_mutex);
+  if (!FinishInput(ctx, data)) { output.SetCardinality(0); return OperatorFinalizeResultType::FINISHED; }
   if (!gs.computed) {
-    if (gs.src_nodes.empty()) { gs.computed = true; output.SetCardinality(0); return OperatorFinalizeResultType::FINISHED; }
-    int64_t nc = ::onager::onager_compute_clustering_parallel(gs.src_nodes.data(), gs.dst_nodes.data(), gs.src_nodes.size(), nullptr, nullptr);
-    if (nc < 0) throw InvalidInputException("Parallel clustering failed: " + GetOnagerError());
-    gs.result_nodes.resize(nc); gs.result_coefficients.resize(nc);
-    ::onager::onager_compute_clustering_parallel(gs.src_nodes.data(), gs.dst_nodes.data(), gs.src_nodes.size(), gs.result_nodes.data(), gs.result_coefficients.data());
+    if (gs.input.Size() == 0) { gs.computed = true; output.SetCardinality(0); return OperatorFinalizeResultType::FINISHED; }
+    gs.result.Set(::onager::onager_compute_clustering_parallel(gs.input.I64(0), gs.input.I64(1), gs.input.Size()), "Parallel clustering");
     gs.computed = true;
   }
-  idx_t rem = gs.result_nodes.size() - gs.output_idx;
-  if (rem == 0) { output.SetCardinality(0); return OperatorFinalizeResultType::FINISHED; }
-  idx_t to = MinValue<idx_t>(rem, STANDARD_VECTOR_SIZE);
-  auto n = GetFlatVectorDataWritable<int64_t>(output.data[0]); auto c = GetFlatVectorDataWritable<double>(output.data[1]);
-  for (idx_t i = 0; i < to; i++) { n[i] = gs.result_nodes[gs.output_idx+i]; c[i] = gs.result_coefficients[gs.output_idx+i]; }
-  gs.output_idx += to; output.SetCardinality(to);
-  return gs.output_idx >= gs.result_nodes.size() ? OperatorFinalizeResultType::FINISHED : OperatorFinalizeResultType::HAVE_MORE_OUTPUT;
+  return EmitResultChunk(gs.result, gs.output_idx, output);
 }
 
 // =============================================================================
 // Parallel Triangle Count
 // =============================================================================
 
-struct ParallelTrianglesGlobalState : public GlobalTableFunctionState {
-  std::mutex input_mutex;
-  std::vector<int64_t> src_nodes, dst_nodes, result_nodes, result_counts;
+struct ParallelTrianglesGlobalState : public InputGlobalState {
+  OnagerResultHandle result;
   idx_t output_idx = 0; bool computed = false;
-  idx_t MaxThreads() const override { return 1; }
 };
 
 static unique_ptr<FunctionData> ParallelTrianglesBind(ClientContext &ctx, TableFunctionBindInput &input, vector<LogicalType> &rt, vector<string> &nm) {
@@ -273,31 +203,58 @@ static unique_ptr<FunctionData> ParallelTrianglesBind(ClientContext &ctx, TableF
   return make_uniq<TableFunctionData>();
 }
 static unique_ptr<GlobalTableFunctionState> ParallelTrianglesInitGlobal(ClientContext &ctx, TableFunctionInitInput &input) { return make_uniq<ParallelTrianglesGlobalState>(); }
-static OperatorResultType ParallelTrianglesInOut(ExecutionContext &ctx, TableFunctionInput &data, DataChunk &input, DataChunk &output) {
-  auto &gs = data.global_state->Cast<ParallelTrianglesGlobalState>();
-  std::lock_guard<std::mutex> lock(gs.input_mutex);
-  auto s = FlatVector::GetData<int64_t>(input.data[0]); auto d = FlatVector::GetData<int64_t>(input.data[1]);
-  for (idx_t i = 0; i < input.size(); i++) { gs.src_nodes.push_back(s[i]); gs.dst_nodes.push_back(d[i]); }
-  output.SetCardinality(0); return OperatorResultType::NEED_MORE_INPUT;
-}
 static OperatorFinalizeResultType ParallelTrianglesFinal(ExecutionContext &ctx, TableFunctionInput &data, DataChunk &output) {
   auto &gs = data.global_state->Cast<ParallelTrianglesGlobalState>();
-  std::lock_guard<std::mutex> lock(gs.input_mutex);
+  if (!FinishInput(ctx, data)) { output.SetCardinality(0); return OperatorFinalizeResultType::FINISHED; }
   if (!gs.computed) {
-    if (gs.src_nodes.empty()) { gs.computed = true; output.SetCardinality(0); return OperatorFinalizeResultType::FINISHED; }
-    int64_t nc = ::onager::onager_compute_triangles_parallel(gs.src_nodes.data(), gs.dst_nodes.data(), gs.src_nodes.size(), nullptr, nullptr);
-    if (nc < 0) throw InvalidInputException("Parallel triangles failed: " + GetOnagerError());
-    gs.result_nodes.resize(nc); gs.result_counts.resize(nc);
-    ::onager::onager_compute_triangles_parallel(gs.src_nodes.data(), gs.dst_nodes.data(), gs.src_nodes.size(), gs.result_nodes.data(), gs.result_counts.data());
+    if (gs.input.Size() == 0) { gs.computed = true; output.SetCardinality(0); return OperatorFinalizeResultType::FINISHED; }
+    gs.result.Set(::onager::onager_compute_triangles_parallel(gs.input.I64(0), gs.input.I64(1), gs.input.Size()), "Parallel triangles");
     gs.computed = true;
   }
-  idx_t rem = gs.result_nodes.size() - gs.output_idx;
-  if (rem == 0) { output.SetCardinality(0); return OperatorFinalizeResultType::FINISHED; }
-  idx_t to = MinValue<idx_t>(rem, STANDARD_VECTOR_SIZE);
-  auto n = GetFlatVectorDataWritable<int64_t>(output.data[0]); auto c = GetFlatVectorDataWritable<int64_t>(output.data[1]);
-  for (idx_t i = 0; i < to; i++) { n[i] = gs.result_nodes[gs.output_idx+i]; c[i] = gs.result_counts[gs.output_idx+i]; }
-  gs.output_idx += to; output.SetCardinality(to);
-  return gs.output_idx >= gs.result_nodes.size() ? OperatorFinalizeResultType::FINISHED : OperatorFinalizeResultType::HAVE_MORE_OUTPUT;
+  return EmitResultChunk(gs.result, gs.output_idx, output);
+}
+
+// =============================================================================
+// Parallel Louvain
+// =============================================================================
+
+struct ParallelLouvainBindData : public GraphBindData {
+  int64_t seed = -1;
+  WeightColumn weights;
+};
+struct ParallelLouvainGlobalState : public InputGlobalState {
+  OnagerResultHandle result;
+  idx_t output_idx = 0; bool computed = false;
+};
+
+static unique_ptr<FunctionData> ParallelLouvainBind(ClientContext &ctx, TableFunctionBindInput &input, vector<LogicalType> &rt, vector<string> &nm) {
+  auto bd = make_uniq<ParallelLouvainBindData>();
+  if (!BindGraphName(input, bd->graph)) {
+    CheckInt64Input(input, "onager_par_louvain");
+    bd->weights.Bind(input);
+  }
+  for (auto &kv : input.named_parameters) if (kv.first == "seed") bd->seed = kv.second.GetValue<int64_t>();
+  rt.push_back(LogicalType::BIGINT); nm.push_back("node_id");
+  rt.push_back(LogicalType::BIGINT); nm.push_back("community");
+  return std::move(bd);
+}
+static unique_ptr<GlobalTableFunctionState> ParallelLouvainInitGlobal(ClientContext &ctx, TableFunctionInitInput &input) { return make_uniq<ParallelLouvainGlobalState>(); }
+static unique_ptr<LocalTableFunctionState> ParallelLouvainInitLocal(ExecutionContext &ctx, TableFunctionInitInput &input, GlobalTableFunctionState *global_state) {
+  return input.bind_data->Cast<ParallelLouvainBindData>().weights.MakeLocal(global_state);
+}
+static OperatorFinalizeResultType ParallelLouvainFinal(ExecutionContext &ctx, TableFunctionInput &data, DataChunk &output) {
+  auto &bd = data.bind_data->Cast<ParallelLouvainBindData>(); auto &gs = data.global_state->Cast<ParallelLouvainGlobalState>();
+  if (!FinishInput(ctx, data)) { output.SetCardinality(0); return OperatorFinalizeResultType::FINISHED; }
+  if (!gs.computed) {
+    if (gs.input.Size() == 0) { gs.computed = true; output.SetCardinality(0); return OperatorFinalizeResultType::FINISHED; }
+    gs.result.Set(::onager::onager_compute_louvain_parallel(gs.input.I64(0), gs.input.I64(1), gs.input.Size(), bd.weights.Data(gs.input), bd.weights.Size(gs.input), bd.seed), "Parallel Louvain");
+    gs.computed = true;
+  }
+  return EmitResultChunk(gs.result, gs.output_idx, output);
+}
+static void ParallelLouvainGraphScan(ClientContext &ctx, TableFunctionInput &data, DataChunk &output) {
+  auto &bd = data.bind_data->Cast<ParallelLouvainBindData>();
+  EmitGraphResult(ctx, data, output, "Parallel Louvain", [&](const char *graph) { return ::onager::onager_graph_compute_louvain_parallel(graph, bd.seed); });
 }
 
 // =============================================================================
@@ -308,45 +265,61 @@ namespace onager {
 
 void RegisterParallelFunctions(ExtensionLoader &loader) {
   TableFunction par_pr("onager_par_pagerank", {LogicalType::TABLE}, nullptr, ParallelPageRankBind, ParallelPageRankInitGlobal);
-  par_pr.in_out_function = ParallelPageRankInOut;
+  par_pr.in_out_function = CollectInput;
+  par_pr.init_local = ParallelPageRankInitLocal;
   par_pr.in_out_function_final = ParallelPageRankFinal;
   par_pr.named_parameters["damping"] = LogicalType::DOUBLE;
   par_pr.named_parameters["iterations"] = LogicalType::BIGINT;
+  par_pr.named_parameters["tolerance"] = LogicalType::DOUBLE;
   par_pr.named_parameters["directed"] = LogicalType::BOOLEAN;
+  par_pr.named_parameters["graph"] = LogicalType::VARCHAR;
   ONAGER_SET_NO_ORDER(par_pr);
-  loader.RegisterFunction(par_pr);
+  RegisterWithGraphOverload(loader, par_pr, ParallelPageRankGraphScan);
 
   TableFunction par_bfs("onager_par_bfs", {LogicalType::TABLE}, nullptr, ParallelBfsBind, ParallelBfsInitGlobal);
-  par_bfs.in_out_function = ParallelBfsInOut;
+  par_bfs.in_out_function = CollectInput;
+  par_bfs.init_local = InitInputLocal<2>;
   par_bfs.in_out_function_final = ParallelBfsFinal;
   par_bfs.named_parameters["source"] = LogicalType::BIGINT;
   ONAGER_SET_NO_ORDER(par_bfs);
   loader.RegisterFunction(par_bfs);
 
   TableFunction par_paths("onager_par_shortest_paths", {LogicalType::TABLE}, nullptr, ParallelPathsBind, ParallelPathsInitGlobal);
-  par_paths.in_out_function = ParallelPathsInOut;
+  par_paths.in_out_function = CollectInput;
+  par_paths.init_local = InitInputLocal<2>;
   par_paths.in_out_function_final = ParallelPathsFinal;
   par_paths.named_parameters["source"] = LogicalType::BIGINT;
   ONAGER_SET_NO_ORDER(par_paths);
   loader.RegisterFunction(par_paths);
 
   TableFunction par_components("onager_par_components", {LogicalType::TABLE}, nullptr, ParallelComponentsBind, ParallelComponentsInitGlobal);
-  par_components.in_out_function = ParallelComponentsInOut;
+  par_components.in_out_function = CollectInput;
+  par_components.init_local = InitInputLocal<2>;
   par_components.in_out_function_final = ParallelComponentsFinal;
   ONAGER_SET_NO_ORDER(par_components);
   loader.RegisterFunction(par_components);
 
   TableFunction par_clustering("onager_par_clustering", {LogicalType::TABLE}, nullptr, ParallelClusteringBind, ParallelClusteringInitGlobal);
-  par_clustering.in_out_function = ParallelClusteringInOut;
+  par_clustering.in_out_function = CollectInput;
+  par_clustering.init_local = InitInputLocal<2>;
   par_clustering.in_out_function_final = ParallelClusteringFinal;
   ONAGER_SET_NO_ORDER(par_clustering);
   loader.RegisterFunction(par_clustering);
 
   TableFunction par_triangles("onager_par_triangles", {LogicalType::TABLE}, nullptr, ParallelTrianglesBind, ParallelTrianglesInitGlobal);
-  par_triangles.in_out_function = ParallelTrianglesInOut;
+  par_triangles.in_out_function = CollectInput;
+  par_triangles.init_local = InitInputLocal<2>;
   par_triangles.in_out_function_final = ParallelTrianglesFinal;
   ONAGER_SET_NO_ORDER(par_triangles);
   loader.RegisterFunction(par_triangles);
+
+  TableFunction par_louvain("onager_par_louvain", {LogicalType::TABLE}, nullptr, ParallelLouvainBind, ParallelLouvainInitGlobal);
+  par_louvain.in_out_function = CollectInput;
+  par_louvain.init_local = ParallelLouvainInitLocal;
+  par_louvain.in_out_function_final = ParallelLouvainFinal;
+  par_louvain.named_parameters["seed"] = LogicalType::BIGINT;
+  ONAGER_SET_NO_ORDER(par_louvain);
+  RegisterWithGraphOverload(loader, par_louvain, ParallelLouvainGraphScan);
 }
 
 } // namespace onager
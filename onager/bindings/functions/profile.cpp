@@ -0,0 +1,121 @@
+/**
+ * @file profile.cpp
+ * @brief Call profile and graph build cache table functions for the Onager DuckDB extension.
+ *
+ * Reports the phase timings and sizes of the last Onager call on the connection,
+ * and the counters of the graph build cache.
+ */
+#include "functions.hpp"
+
+namespace duckdb {
+
+using namespace onager;
+
+// =============================================================================
+// Last Call Profile
+// =============================================================================
+
+struct LastProfileBindData : public TableFunctionData {
+  bool found = false;
+  std::string function;
+  ::onager::OnagerProfile profile {};
+};
+
+struct LastProfileGlobalState : public GlobalTableFunctionState {
+  bool done = false;
+};
+
+static unique_ptr<FunctionData> LastProfileBind(ClientContext &ctx, TableFunctionBindInput &input, vector<LogicalType> &rt, vector<string> &nm) {
+  auto bd = make_uniq<LastProfileBindData>();
+  uint64_t connection = ProfileConnection(ctx);
+  bd->found = ::onager::onager_last_profile(connection, &bd->profile);
+  if (auto function = ::onager::onager_last_profile_function(connection)) {
+    bd->function = function;
+    ::onager::onager_free(function);
+  }
+  rt.push_back(LogicalType::VARCHAR); nm.push_back("function");
+  rt.push_back(LogicalType::DOUBLE); nm.push_back("ingest_ms");
+  rt.push_back(LogicalType::DOUBLE); nm.push_back("build_ms");
+  rt.push_back(LogicalType::DOUBLE); nm.push_back("compute_ms");
+  rt.push_back(LogicalType::DOUBLE); nm.push_back("output_ms");
+  rt.push_back(LogicalType::BIGINT); nm.push_back("nodes");
+  rt.push_back(LogicalType::BIGINT); nm.push_back("edges");
+  rt.push_back(LogicalType::BIGINT); nm.push_back("iterations");
+  rt.push_back(LogicalType::BIGINT); nm.push_back("threads");
+  rt.push_back(LogicalType::BIGINT); nm.push_back("peak_bytes");
+  rt.push_back(LogicalType::BIGINT); nm.push_back("rows");
+  return std::move(bd);
+}
+static unique_ptr<GlobalTableFunctionState> LastProfileInitGlobal(ClientContext &ctx, TableFunctionInitInput &input) { return make_uniq<LastProfileGlobalState>(); }
+static void LastProfileScan(ClientContext &ctx, TableFunctionInput &data, DataChunk &output) {
+  auto &bd = data.bind_data->Cast<LastProfileBindData>(); auto &gs = data.global_state->Cast<LastProfileGlobalState>();
+  if (gs.done || !bd.found) { output.SetCardinality(0); return; }
+  auto &p = bd.profile;
+  auto ms = [](uint64_t ns) { return Value::DOUBLE(static_cast<double>(ns) / 1e6); };
+  auto count = [](uint64_t n) { return Value::BIGINT(static_cast<int64_t>(n)); };
+  output.SetValue(0, 0, bd.function.empty() ? Value(LogicalType::VARCHAR) : Value(bd.function));
+  output.SetValue(1, 0, ms(p.ingest_ns));
+  output.SetValue(2, 0, ms(p.build_ns));
+  output.SetValue(3, 0, ms(p.compute_ns));
+  output.SetValue(4, 0, ms(p.output_ns));
+  output.SetValue(5, 0, count(p.nodes));
+  output.SetValue(6, 0, count(p.edges));
+  output.SetValue(7, 0, p.iterations < 0 ? Value(LogicalType::BIGINT) : Value::BIGINT(p.iterations));
+  output.SetValue(8, 0, count(p.threads));
+  output.SetValue(9, 0, count(p.peak_bytes));
+  output.SetValue(10, 0, count(p.rows));
+  output.SetCardinality(1);
+  gs.done = true;
+}
+
+// =============================================================================
+// Graph Build Cache Statistics
+// =============================================================================
+
+struct GraphCacheStatsGlobalState : public GlobalTableFunctionState {
+  ::onager::GraphCacheStats stats {};
+  bool done = false;
+};
+
+static unique_ptr<FunctionData> GraphCacheStatsBind(ClientContext &ctx, TableFunctionBindInput &input, vector<LogicalType> &rt, vector<string> &nm) {
+  rt.push_back(LogicalType::BIGINT); nm.push_back("capacity");
+  rt.push_back(LogicalType::BIGINT); nm.push_back("entries");
+  rt.push_back(LogicalType::BIGINT); nm.push_back("hits");
+  rt.push_back(LogicalType::BIGINT); nm.push_back("misses");
+  rt.push_back(LogicalType::BIGINT); nm.push_back("bytes");
+  return make_uniq<TableFunctionData>();
+}
+static unique_ptr<GlobalTableFunctionState> GraphCacheStatsInitGlobal(ClientContext &ctx, TableFunctionInitInput &input) {
+  auto gs = make_uniq<GraphCacheStatsGlobalState>();
+  ::onager::onager_graph_cache_stats(&gs->stats);
+  return std::move(gs);
+}
+static void GraphCacheStatsScan(ClientContext &ctx, TableFunctionInput &data, DataChunk &output) {
+  auto &gs = data.global_state->Cast<GraphCacheStatsGlobalState>();
+  if (gs.done) { output.SetCardinality(0); return; }
+  auto count = [](uint64_t n) { return Value::BIGINT(static_cast<int64_t>(n)); };
+  output.SetValue(0, 0, count(gs.stats.capacity));
+  output.SetValue(1, 0, count(gs.stats.entries));
+  output.SetValue(2, 0, count(gs.stats.hits));
+  output.SetValue(3, 0, count(gs.stats.misses));
+  output.SetValue(4, 0, count(gs.stats.bytes));
+  output.SetCardinality(1);
+  gs.done = true;
+}
+
+// =============================================================================
+// Registration
+// =============================================================================
+
+namespace onager {
+
+void RegisterProfileFunctions(ExtensionLoader &loader) {
+  TableFunction last_profile("onager_last_profile", {}, LastProfileScan, LastProfileBind, LastProfileInitGlobal);
+  loader.RegisterFunction(last_profile);
+
+  TableFunction cache_stats("onager_graph_cache_stats", {}, GraphCacheStatsScan, GraphCacheStatsBind, GraphCacheStatsInitGlobal);
+  loader.RegisterFunction(cache_stats);
+}
+
+} // namespace onager
+} // namespace duckdb
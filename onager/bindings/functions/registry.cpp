@@ -0,0 +1,173 @@
+/**
+ * @file registry.cpp
+ * @brief Graph registry table functions for Onager DuckDB extension.
+ *
+ * Bulk loading of registry graphs and batches of edge inserts and deletes
+ * from a table input.
+ */
+#include "functions.hpp"
+
+namespace duckdb {
+
+using namespace onager;
+
+// =============================================================================
+// Bulk Graph Loader
+// =============================================================================
+
+struct LoadGraphBindData : public TableFunctionData {
+  std::string graph;
+  int32_t directed = -1;
+  WeightColumn weights;
+};
+struct LoadGraphGlobalState : public InputGlobalState {
+  OnagerResultHandle result;
+  idx_t output_idx = 0; bool computed = false;
+};
+
+static unique_ptr<FunctionData> LoadGraphBind(ClientContext &ctx, TableFunctionBindInput &input, vector<LogicalType> &rt, vector<string> &nm) {
+  auto bd = make_uniq<LoadGraphBindData>();
+  if (input.inputs.empty() || input.inputs[0].IsNull()) throw InvalidInputException("onager_load_graph requires a graph name");
+  bd->graph = input.inputs[0].GetValue<string>();
+  CheckInt64Input(input, "onager_load_graph");
+  bd->weights.Bind(input);
+  for (auto &kv : input.named_parameters) if (kv.first == "directed") bd->directed = kv.second.GetValue<bool>() ? 1 : 0;
+  rt.push_back(LogicalType::BIGINT); nm.push_back("nodes_added");
+  rt.push_back(LogicalType::BIGINT); nm.push_back("edges_added");
+  return std::move(bd);
+}
+static unique_ptr<GlobalTableFunctionState> LoadGraphInitGlobal(ClientContext &ctx, TableFunctionInitInput &input) { return make_uniq<LoadGraphGlobalState>(); }
+static unique_ptr<LocalTableFunctionState> LoadGraphInitLocal(ExecutionContext &ctx, TableFunctionInitInput &input, GlobalTableFunctionState *global_state) {
+  return input.bind_data->Cast<LoadGraphBindData>().weights.MakeLocal(global_state);
+}
+static OperatorFinalizeResultType LoadGraphFinal(ExecutionContext &ctx, TableFunctionInput &data, DataChunk &output) {
+  auto &bd = data.bind_data->Cast<LoadGraphBindData>(); auto &gs = data.global_state->Cast<LoadGraphGlobalState>();
+  if (!FinishInput(ctx, data, true)) { output.SetCardinality(0); return OperatorFinalizeResultType::FINISHED; }
+  if (!gs.computed) {
+    gs.result.Set(::onager::onager_load_graph(bd.graph.c_str(), gs.input.I64(0), gs.input.I64(1), bd.weights.Data(gs.input), gs.input.Size(), bd.directed), "Loading graph " + bd.graph);
+    gs.computed = true;
+  }
+  return EmitResultChunk(gs.result, gs.output_idx, output);
+}
+
+// =============================================================================
+// Delta Batches
+// =============================================================================
+
+struct ApplyDeltaBindData : public TableFunctionData {
+  std::string graph;
+  WeightColumn weights;
+};
+/** @brief Collects the changes on one thread, so the buffer holds them in input order. */
+struct ApplyDeltaGlobalState : public LoadGraphGlobalState {
+  idx_t MaxThreads() const override { return 1; }
+};
+
+static unique_ptr<FunctionData> ApplyDeltaBind(ClientContext &ctx, TableFunctionBindInput &input, vector<LogicalType> &rt, vector<string> &nm) {
+  auto bd = make_uniq<ApplyDeltaBindData>();
+  if (input.inputs.empty() || input.inputs[0].IsNull()) throw InvalidInputException("onager_apply_delta requires a graph name");
+  bd->graph = input.inputs[0].GetValue<string>();
+  auto &types = input.input_table_types;
+  if (types.size() < 3) throw InvalidInputException("onager_apply_delta requires a table with (op, src, dst) columns");
+  if (types[0] != LogicalType::VARCHAR) throw InvalidInputException("onager_apply_delta requires the op column to be VARCHAR ('insert' or 'delete'). Found: " + types[0].ToString());
+  if (types[1] != LogicalType::BIGINT || types[2] != LogicalType::BIGINT) {
+    throw InvalidInputException("onager_apply_delta requires (src, dst) columns to be BIGINT. Please cast inputs to BIGINT (e.g. column::bigint). Found: " + types[1].ToString() + ", " + types[2].ToString());
+  }
+  bd->weights.Bind(input, 3);
+  rt.push_back(LogicalType::BIGINT); nm.push_back("edges_inserted");
+  rt.push_back(LogicalType::BIGINT); nm.push_back("edges_deleted");
+  return std::move(bd);
+}
+static unique_ptr<GlobalTableFunctionState> ApplyDeltaInitGlobal(ClientContext &ctx, TableFunctionInitInput &input) { return make_uniq<ApplyDeltaGlobalState>(); }
+static unique_ptr<LocalTableFunctionState> ApplyDeltaInitLocal(ExecutionContext &ctx, TableFunctionInitInput &input, GlobalTableFunctionState *global_state) {
+  return input.bind_data->Cast<ApplyDeltaBindData>().weights.MakeLocal(global_state);
+}
+
+/** @brief Replaces NULL weights of an input chunk with 1.0, the weight of an unweighted edge. */
+template <typename T>
+static void DefaultNullWeights(Vector &weights, idx_t count) {
+  UnifiedVectorFormat format;
+  weights.ToUnifiedFormat(count, format);
+  if (format.validity.AllValid()) return;
+  Vector filled(weights.GetType(), count);
+  auto out = FlatVector::GetData<T>(filled);
+  auto values = reinterpret_cast<const T *>(format.data);
+  for (idx_t i = 0; i < count; i++) {
+    auto idx = format.sel->get_index(i);
+    out[i] = format.validity.RowIsValid(idx) ? values[idx] : T(1);
+  }
+  weights.Reference(filled);
+}
+
+/**
+ * @brief Replaces the op column of an input chunk with operation codes and buffers the chunk.
+ *
+ * 'insert' becomes 1 and 'delete' becomes -1, the codes onager_apply_delta takes.
+ * Integer weights are cast to DOUBLE, and NULL weights become 1.0.
+ * @throws InvalidInputException for any other op, including NULL
+ */
+static OperatorResultType ApplyDeltaCollect(ExecutionContext &ctx, TableFunctionInput &data, DataChunk &input, DataChunk &output) {
+  idx_t count = input.size();
+  Vector codes(LogicalType::BIGINT, count);
+  auto out = FlatVector::GetData<int64_t>(codes);
+  UnifiedVectorFormat format;
+  input.data[0].ToUnifiedFormat(count, format);
+  auto ops = reinterpret_cast<const string_t *>(format.data);
+  for (idx_t i = 0; i < count; i++) {
+    auto idx = format.sel->get_index(i);
+    auto op = format.validity.RowIsValid(idx) ? ops[idx].GetString() : std::string("NULL");
+    if (op == "insert") out[i] = 1;
+    else if (op == "delete") out[i] = -1;
+    else throw InvalidInputException("onager_apply_delta requires op to be 'insert' or 'delete'. Found: " + op);
+  }
+  input.data[0].Reference(codes);
+  auto &weights = data.bind_data->Cast<ApplyDeltaBindData>().weights;
+  if (weights.present) {
+    auto &column = input.data[weights.column];
+    if (weights.is_float) {
+      DefaultNullWeights<float>(column, count);
+    } else {
+      if (column.GetType().id() != LogicalTypeId::DOUBLE) {
+        Vector cast(LogicalType::DOUBLE, count);
+        VectorOperations::DefaultCast(column, cast, count);
+        column.Reference(cast);
+      }
+      DefaultNullWeights<double>(column, count);
+    }
+  }
+  return CollectInput(ctx, data, input, output);
+}
+static OperatorFinalizeResultType ApplyDeltaFinal(ExecutionContext &ctx, TableFunctionInput &data, DataChunk &output) {
+  auto &bd = data.bind_data->Cast<ApplyDeltaBindData>(); auto &gs = data.global_state->Cast<ApplyDeltaGlobalState>();
+  if (!FinishInput(ctx, data, true)) { output.SetCardinality(0); return OperatorFinalizeResultType::FINISHED; }
+  if (!gs.computed) {
+    gs.result.Set(::onager::onager_apply_delta(bd.graph.c_str(), gs.input.I64(0), gs.input.I64(1), gs.input.I64(2), bd.weights.Data(gs.input), gs.input.Size()), "Applying delta to graph " + bd.graph);
+    gs.computed = true;
+  }
+  return EmitResultChunk(gs.result, gs.output_idx, output);
+}
+
+// =============================================================================
+// Registration
+// =============================================================================
+
+namespace onager {
+
+void RegisterRegistryFunctions(ExtensionLoader &loader) {
+  TableFunction load_graph("onager_load_graph", {LogicalType::VARCHAR, LogicalType::TABLE}, nullptr, LoadGraphBind, LoadGraphInitGlobal);
+  load_graph.in_out_function = CollectInput;
+  load_graph.init_local = LoadGraphInitLocal;
+  load_graph.in_out_function_final = LoadGraphFinal;
+  load_graph.named_parameters["directed"] = LogicalType::BOOLEAN;
+  ONAGER_SET_NO_ORDER(load_graph);
+  loader.RegisterFunction(load_graph);
+
+  TableFunction apply_delta("onager_apply_delta", {LogicalType::VARCHAR, LogicalType::TABLE}, nullptr, ApplyDeltaBind, ApplyDeltaInitGlobal);
+  apply_delta.in_out_function = ApplyDeltaCollect;
+  apply_delta.init_local = ApplyDeltaInitLocal;
+  apply_delta.in_out_function_final = ApplyDeltaFinal;
+  loader.RegisterFunction(apply_delta);
+}
+
+} // namespace onager
+} // namespace duckdb
@@ -33,40 +33,67 @@ static void GetLastError(DataChunk &args, ExpressionState &state, Vector &result
   ConstantVector::SetNull(result, false);
 }
 
-static void GetNodeInDegree(DataChunk &args, ExpressionState &state, Vector &result) {
+/**
+ * @brief Fills the result with node degrees from a registry graph.
+ *
+ * When the graph name is constant, the whole vector of node IDs crosses the FFI
+ * boundary in one call, which resolves the graph and takes the registry read
+ * lock once per chunk. Otherwise each row is looked up separately.
+ */
+static void GetNodeDegrees(DataChunk &args, Vector &result, bool inbound) {
   auto count = args.size();
-  UnifiedVectorFormat name_data, node_data;
-  args.data[0].ToUnifiedFormat(count, name_data);
-  args.data[1].ToUnifiedFormat(count, node_data);
+  auto &name_vector = args.data[0];
+  auto &node_vector = args.data[1];
+  UnifiedVectorFormat node_data;
+  node_vector.ToUnifiedFormat(count, node_data);
 
-  auto result_data = GetFlatVectorDataWritable<int64_t>(result);
-  auto &result_validity = GetFlatVectorValidityWritable(result);
-
-  for (idx_t i = 0; i < count; i++) {
-    auto name = ((string_t*)name_data.data)[name_data.sel->get_index(i)];
-    auto node = ((int64_t*)node_data.data)[node_data.sel->get_index(i)];
-    int64_t degree = ::onager::onager_graph_node_in_degree(name.GetString().c_str(), node);
-    if (degree < 0) {
-      result_validity.SetInvalid(i);
+  if (name_vector.GetVectorType() == VectorType::CONSTANT_VECTOR) {
+    if (ConstantVector::IsNull(name_vector)) {
+      result.SetVectorType(VectorType::CONSTANT_VECTOR);
+      ConstantVector::SetNull(result, true);
+      return;
+    }
+    auto name = ConstantVector::GetData<string_t>(name_vector)[0].GetString();
+    std::vector<int64_t> gathered;
+    const int64_t *nodes;
+    if (node_vector.GetVectorType() == VectorType::FLAT_VECTOR) {
+      nodes = FlatVector::GetData<int64_t>(node_vector);
     } else {
-      result_data[i] = degree;
+      gathered.resize(count);
+      auto values = reinterpret_cast<const int64_t *>(node_data.data);
+      for (idx_t i = 0; i < count; i++) gathered[i] = values[node_data.sel->get_index(i)];
+      nodes = gathered.data();
     }
-  }
-}
 
-static void GetNodeOutDegree(DataChunk &args, ExpressionState &state, Vector &result) {
-  auto count = args.size();
-  UnifiedVectorFormat name_data, node_data;
-  args.data[0].ToUnifiedFormat(count, name_data);
-  args.data[1].ToUnifiedFormat(count, node_data);
+    result.SetVectorType(VectorType::FLAT_VECTOR);
+    auto result_data = GetFlatVectorDataWritable<int64_t>(result);
+    auto &result_validity = GetFlatVectorValidityWritable(result);
+    if (::onager::onager_graph_node_degrees(name.c_str(), nodes, count, inbound, result_data) < 0) {
+      for (idx_t i = 0; i < count; i++) result_validity.SetInvalid(i);
+      return;
+    }
+    for (idx_t i = 0; i < count; i++) {
+      if (result_data[i] < 0 || !node_data.validity.RowIsValid(node_data.sel->get_index(i))) result_validity.SetInvalid(i);
+    }
+    return;
+  }
 
+  UnifiedVectorFormat name_data;
+  name_vector.ToUnifiedFormat(count, name_data);
   auto result_data = GetFlatVectorDataWritable<int64_t>(result);
   auto &result_validity = GetFlatVectorValidityWritable(result);
 
   for (idx_t i = 0; i < count; i++) {
-    auto name = ((string_t*)name_data.data)[name_data.sel->get_index(i)];
-    auto node = ((int64_t*)node_data.data)[node_data.sel->get_index(i)];
-    int64_t degree = ::onager::onager_graph_node_out_degree(name.GetString().c_str(), node);
+    auto name_idx = name_data.sel->get_index(i);
+    auto node_idx = node_data.sel->get_index(i);
+    if (!name_data.validity.RowIsValid(name_idx) || !node_data.validity.RowIsValid(node_idx)) {
+      result_validity.SetInvalid(i);
+      continue;
+    }
+    auto name = ((string_t*)name_data.data)[name_idx];
+    auto node = ((int64_t*)node_data.data)[node_idx];
+    int64_t degree = inbound ? ::onager::onager_graph_node_in_degree(name.GetString().c_str(), node)
+                             : ::onager::onager_graph_node_out_degree(name.GetString().c_str(), node);
     if (degree < 0) {
       result_validity.SetInvalid(i);
     } else {
@@ -75,6 +102,14 @@ static void GetNodeOutDegree(DataChunk &args, ExpressionState &state, Vector &re
   }
 }
 
+static void GetNodeInDegree(DataChunk &args, ExpressionState &state, Vector &result) {
+  GetNodeDegrees(args, result, true);
+}
+
+static void GetNodeOutDegree(DataChunk &args, ExpressionState &state, Vector &result) {
+  GetNodeDegrees(args, result, false);
+}
+
 // =============================================================================
 // Graph Management Scalar Functions
 // =============================================================================
@@ -105,6 +140,42 @@ static void DropGraph(DataChunk &args, ExpressionState &state, Vector &result) {
   }
 }
 
+/**
+ * @brief Runs onager_save_graph or onager_open_graph on each row.
+ *
+ * The file is read or written by Rust, so paths are expanded by the client's
+ * file system and checked against enable_external_access and allowed_directories
+ * first, as DuckDB checks paths it opens itself.
+ * @throws PermissionException if the connection may not access a path
+ */
+static void SaveOrOpenGraph(DataChunk &args, ExpressionState &state, Vector &result, const std::string &fn_name, int32_t (*fn)(const char *, const char *)) {
+  auto &ctx = state.GetContext();
+  auto &config = DBConfig::GetConfig(ctx);
+  auto &fs = FileSystem::GetFileSystem(ctx);
+  auto count = args.size();
+  UnifiedVectorFormat name_data, path_data;
+  args.data[0].ToUnifiedFormat(count, name_data);
+  args.data[1].ToUnifiedFormat(count, path_data);
+
+  auto result_data = GetFlatVectorDataWritable<int32_t>(result);
+  for (idx_t i = 0; i < count; i++) {
+    auto name = ((string_t*)name_data.data)[name_data.sel->get_index(i)];
+    auto path = fs.ExpandPath(((string_t*)path_data.data)[path_data.sel->get_index(i)].GetString());
+    if (!config.options.enable_external_access && !config.CanAccessFile(path, FileType::FILE_TYPE_REGULAR)) {
+      throw PermissionException(fn_name + " cannot access '" + path + "': file system access is disabled by configuration");
+    }
+    result_data[i] = fn(name.GetString().c_str(), path.c_str());
+  }
+}
+
+static void SaveGraph(DataChunk &args, ExpressionState &state, Vector &result) {
+  SaveOrOpenGraph(args, state, result, "onager_save_graph", ::onager::onager_save_graph);
+}
+
+static void OpenGraph(DataChunk &args, ExpressionState &state, Vector &result) {
+  SaveOrOpenGraph(args, state, result, "onager_open_graph", ::onager::onager_open_graph);
+}
+
 static void AddNode(DataChunk &args, ExpressionState &state, Vector &result) {
   auto count = args.size();
   UnifiedVectorFormat name_data, node_data;
@@ -197,6 +268,10 @@ void RegisterScalarFunctions(ExtensionLoader &loader) {
       {LogicalType::VARCHAR, LogicalType::BOOLEAN}, LogicalType::INTEGER, CreateGraph));
   loader.RegisterFunction(ScalarFunction("onager_drop_graph",
       {LogicalType::VARCHAR}, LogicalType::INTEGER, DropGraph));
+  loader.RegisterFunction(ScalarFunction("onager_save_graph",
+      {LogicalType::VARCHAR, LogicalType::VARCHAR}, LogicalType::INTEGER, SaveGraph));
+  loader.RegisterFunction(ScalarFunction("onager_open_graph",
+      {LogicalType::VARCHAR, LogicalType::VARCHAR}, LogicalType::INTEGER, OpenGraph));
   loader.RegisterFunction(ScalarFunction("onager_add_node",
       {LogicalType::VARCHAR, LogicalType::BIGINT}, LogicalType::INTEGER, AddNode));
   loader.RegisterFunction(ScalarFunction("onager_add_edge",
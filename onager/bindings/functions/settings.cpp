@@ -0,0 +1,55 @@
+/**
+ * @file settings.cpp
+ * @brief Extension settings for the Onager DuckDB extension.
+ *
+ * Settings are registered as DuckDB extension options. Process-wide settings are
+ * forwarded to the Rust core when they are set, and per-connection ones are read
+ * when a call starts.
+ */
+#include "functions.hpp"
+
+namespace duckdb {
+
+using namespace onager;
+
+// =============================================================================
+// Graph Build Cache
+// =============================================================================
+
+// The size bounds the bytes of the cached graphs. A plain number counts bytes,
+// and anything else is read like memory_limit, such as '512MB' or '2GiB'.
+
+static void SetGraphCacheSize(ClientContext &context, SetScope scope, Value &parameter) {
+  auto size = parameter.ToString();
+  if (!size.empty() && size[0] == '-') throw InvalidInputException("onager_graph_cache_size must be >= 0");
+  bool plain = !size.empty() && size.find_first_not_of("0123456789") == std::string::npos;
+  idx_t bytes = plain ? std::strtoull(size.c_str(), nullptr, 10) : DBConfig::ParseMemoryLimit(size);
+  ::onager::onager_graph_cache_set_size(bytes);
+}
+
+// =============================================================================
+// Thread Budget
+// =============================================================================
+
+static void SetThreads(ClientContext &context, SetScope scope, Value &parameter) {
+  if (parameter.GetValue<int64_t>() < 0) throw InvalidInputException("onager_threads must be >= 0");
+}
+
+// =============================================================================
+// Registration
+// =============================================================================
+
+namespace onager {
+
+void RegisterSettings(ExtensionLoader &loader) {
+  auto &config = DBConfig::GetConfig(loader.GetDatabaseInstance());
+  config.AddExtensionOption("onager_graph_cache_size",
+                            "Memory that Onager keeps built graphs in for later calls on the same edges, such as '1GB' (0 turns the cache off)",
+                            LogicalType::VARCHAR, Value("0"), SetGraphCacheSize);
+  config.AddExtensionOption("onager_threads",
+                            "Number of threads Onager algorithms run on (0 uses DuckDB's threads setting)",
+                            LogicalType::BIGINT, Value::BIGINT(0), SetThreads);
+}
+
+} // namespace onager
+} // namespace duckdb
@@ -2,10 +2,9 @@
  * @file subgraphs.cpp
  * @brief Subgraph extraction table functions for Onager DuckDB extension.
  *
- * Ego Graph, K-Hop Neighbors, Induced Subgraph.
+ * Ego Graph, K-Hop Neighbors, Induced Subgraph, and their many-center forms.
  */
 #include "functions.hpp"
-#include <mutex>
 
 namespace duckdb {
 
@@ -16,11 +15,9 @@ using namespace onager;
 // =============================================================================
 
 struct EgoGraphBindData : public TableFunctionData { int64_t center = 0; int64_t radius = 1; };
-struct EgoGraphGlobalState : public GlobalTableFunctionState {
-  std::mutex input_mutex;
-  std::vector<int64_t> src_nodes, dst_nodes, result_src, result_dst;
+struct EgoGraphGlobalState : public InputGlobalState {
+  OnagerResultHandle result;
   idx_t output_idx = 0; bool computed = false;
-  idx_t MaxThreads() const override { return 1; }
 };
 
 static unique_ptr<FunctionData> EgoGraphBind(ClientContext &ctx, TableFunctionBindInput &input, vector<LogicalType> &rt, vector<string> &nm) {
@@ -35,31 +32,15 @@ static unique_ptr<FunctionData> EgoGraphBind(ClientContext &ctx, TableFunctionBi
   return std::move(bd);
 }
 static unique_ptr<GlobalTableFunctionState> EgoGraphInitGlobal(ClientContext &ctx, TableFunctionInitInput &input) { return make_uniq<EgoGraphGlobalState>(); }
-static OperatorResultType EgoGraphInOut(ExecutionContext &ctx, TableFunctionInput &data, DataChunk &input, DataChunk &output) {
-  auto &gs = data.global_state->Cast<EgoGraphGlobalState>();
-  std::lock_guard<std::mutex> lock(gs.input_mutex);
-  auto s = FlatVector::GetData<int64_t>(input.data[0]); auto d = FlatVector::GetData<int64_t>(input.data[1]);
-  for (idx_t i = 0; i < input.size(); i++) { gs.src_nodes.push_back(s[i]); gs.dst_nodes.push_back(d[i]); }
-  output.SetCardinality(0); return OperatorResultType::NEED_MORE_INPUT;
-}
 static OperatorFinalizeResultType EgoGraphFinal(ExecutionContext &ctx, TableFunctionInput &data, DataChunk &output) {
   auto &bd = data.bind_data->Cast<EgoGraphBindData>(); auto &gs = data.global_state->Cast<EgoGraphGlobalState>();
-  std::lock_guard<std::mutex> lock(gs.input_mutex);
+  if (!FinishInput(ctx, data)) { output.SetCardinality(0); return OperatorFinalizeResultType::FINISHED; }
   if (!gs.computed) {
-    if (gs.src_nodes.empty()) { gs.computed = true; output.SetCardinality(0); return OperatorFinalizeResultType::FINISHED; }
-    int64_t nc = ::onager::onager_compute_ego_graph(gs.src_nodes.data(), gs.dst_nodes.data(), gs.src_nodes.size(), bd.center, bd.radius, nullptr, nullptr);
-    if (nc < 0) throw InvalidInputException("Ego graph failed: " + GetOnagerError());
-    gs.result_src.resize(nc); gs.result_dst.resize(nc);
-    ::onager::onager_compute_ego_graph(gs.src_nodes.data(), gs.dst_nodes.data(), gs.src_nodes.size(), bd.center, bd.radius, gs.result_src.data(), gs.result_dst.data());
+    if (gs.input.Size() == 0) { gs.computed = true; output.SetCardinality(0); return OperatorFinalizeResultType::FINISHED; }
+    gs.result.Set(::onager::onager_compute_ego_graph(gs.input.I64(0), gs.input.I64(1), gs.input.Size(), bd.center, bd.radius), "Ego graph");
     gs.computed = true;
   }
-  idx_t rem = gs.result_src.size() - gs.output_idx;
-  if (rem == 0) { output.SetCardinality(0); return OperatorFinalizeResultType::FINISHED; }
-  idx_t to = MinValue<idx_t>(rem, STANDARD_VECTOR_SIZE);
-  auto s = GetFlatVectorDataWritable<int64_t>(output.data[0]); auto d = GetFlatVectorDataWritable<int64_t>(output.data[1]);
-  for (idx_t i = 0; i < to; i++) { s[i] = gs.result_src[gs.output_idx+i]; d[i] = gs.result_dst[gs.output_idx+i]; }
-  gs.output_idx += to; output.SetCardinality(to);
-  return gs.output_idx >= gs.result_src.size() ? OperatorFinalizeResultType::FINISHED : OperatorFinalizeResultType::HAVE_MORE_OUTPUT;
+  return EmitResultChunk(gs.result, gs.output_idx, output);
 }
 
 // =============================================================================
@@ -67,11 +48,9 @@ static OperatorFinalizeResultType EgoGraphFinal(ExecutionContext &ctx, TableFunc
 // =============================================================================
 
 struct KHopBindData : public TableFunctionData { int64_t start = 0; int64_t k = 1; };
-struct KHopGlobalState : public GlobalTableFunctionState {
-  std::mutex input_mutex;
-  std::vector<int64_t> src_nodes, dst_nodes, result_nodes;
+struct KHopGlobalState : public InputGlobalState {
+  OnagerResultHandle result;
   idx_t output_idx = 0; bool computed = false;
-  idx_t MaxThreads() const override { return 1; }
 };
 
 static unique_ptr<FunctionData> KHopBind(ClientContext &ctx, TableFunctionBindInput &input, vector<LogicalType> &rt, vector<string> &nm) {
@@ -85,42 +64,24 @@ static unique_ptr<FunctionData> KHopBind(ClientContext &ctx, TableFunctionBindIn
   return std::move(bd);
 }
 static unique_ptr<GlobalTableFunctionState> KHopInitGlobal(ClientContext &ctx, TableFunctionInitInput &input) { return make_uniq<KHopGlobalState>(); }
-static OperatorResultType KHopInOut(ExecutionContext &ctx, TableFunctionInput &data, DataChunk &input, DataChunk &output) {
-  auto &gs = data.global_state->Cast<KHopGlobalState>();
-  std::lock_guard<std::mutex> lock(gs.input_mutex);
-  auto s = FlatVector::GetData<int64_t>(input.data[0]); auto d = FlatVector::GetData<int64_t>(input.data[1]);
-  for (idx_t i = 0; i < input.size(); i++) { gs.src_nodes.push_back(s[i]); gs.dst_nodes.push_back(d[i]); }
-  output.SetCardinality(0); return OperatorResultType::NEED_MORE_INPUT;
-}
 static OperatorFinalizeResultType KHopFinal(ExecutionContext &ctx, TableFunctionInput &data, DataChunk &output) {
   auto &bd = data.bind_data->Cast<KHopBindData>(); auto &gs = data.global_state->Cast<KHopGlobalState>();
-  std::lock_guard<std::mutex> lock(gs.input_mutex);
+  if (!FinishInput(ctx, data)) { output.SetCardinality(0); return OperatorFinalizeResultType::FINISHED; }
   if (!gs.computed) {
-    if (gs.src_nodes.empty()) { gs.computed = true; output.SetCardinality(0); return OperatorFinalizeResultType::FINISHED; }
-    int64_t nc = ::onager::onager_compute_k_hop_neighbors(gs.src_nodes.data(), gs.dst_nodes.data(), gs.src_nodes.size(), bd.start, bd.k, nullptr);
-    if (nc < 0) throw InvalidInputException("K-hop neighbors failed: " + GetOnagerError());
-    gs.result_nodes.resize(nc);
-    ::onager::onager_compute_k_hop_neighbors(gs.src_nodes.data(), gs.dst_nodes.data(), gs.src_nodes.size(), bd.start, bd.k, gs.result_nodes.data());
+    if (gs.input.Size() == 0) { gs.computed = true; output.SetCardinality(0); return OperatorFinalizeResultType::FINISHED; }
+    gs.result.Set(::onager::onager_compute_k_hop_neighbors(gs.input.I64(0), gs.input.I64(1), gs.input.Size(), bd.start, bd.k), "K-hop neighbors");
     gs.computed = true;
   }
-  idx_t rem = gs.result_nodes.size() - gs.output_idx;
-  if (rem == 0) { output.SetCardinality(0); return OperatorFinalizeResultType::FINISHED; }
-  idx_t to = MinValue<idx_t>(rem, STANDARD_VECTOR_SIZE);
-  auto n = GetFlatVectorDataWritable<int64_t>(output.data[0]);
-  for (idx_t i = 0; i < to; i++) { n[i] = gs.result_nodes[gs.output_idx+i]; }
-  gs.output_idx += to; output.SetCardinality(to);
-  return gs.output_idx >= gs.result_nodes.size() ? OperatorFinalizeResultType::FINISHED : OperatorFinalizeResultType::HAVE_MORE_OUTPUT;
+  return EmitResultChunk(gs.result, gs.output_idx, output);
 }
 
 // =============================================================================
 // Induced Subgraph
 // =============================================================================
 
-struct InducedSubgraphGlobalState : public GlobalTableFunctionState {
-  std::mutex input_mutex;
-  std::vector<int64_t> src_nodes, dst_nodes, filter_nodes, result_src, result_dst;
+struct InducedSubgraphGlobalState : public InputGlobalState {
+  OnagerResultHandle result;
   idx_t output_idx = 0; bool computed = false;
-  idx_t MaxThreads() const override { return 1; }
 };
 
 static unique_ptr<FunctionData> InducedSubgraphBind(ClientContext &ctx, TableFunctionBindInput &input, vector<LogicalType> &rt, vector<string> &nm) {
@@ -130,37 +91,104 @@ static unique_ptr<FunctionData> InducedSubgraphBind(ClientContext &ctx, TableFun
   return make_uniq<TableFunctionData>();
 }
 static unique_ptr<GlobalTableFunctionState> InducedSubgraphInitGlobal(ClientContext &ctx, TableFunctionInitInput &input) { return make_uniq<InducedSubgraphGlobalState>(); }
-static OperatorResultType InducedSubgraphInOut(ExecutionContext &ctx, TableFunctionInput &data, DataChunk &input, DataChunk &output) {
+static OperatorFinalizeResultType InducedSubgraphFinal(ExecutionContext &ctx, TableFunctionInput &data, DataChunk &output) {
   auto &gs = data.global_state->Cast<InducedSubgraphGlobalState>();
-  std::lock_guard<std::mutex> lock(gs.input_mutex);
-  auto s = FlatVector::GetData<int64_t>(input.data[0]);
-  auto d = FlatVector::GetData<int64_t>(input.data[1]);
-  auto f = FlatVector::GetData<int64_t>(input.data[2]);
-  for (idx_t i = 0; i < input.size(); i++) {
-    gs.src_nodes.push_back(s[i]);
-    gs.dst_nodes.push_back(d[i]);
-    gs.filter_nodes.push_back(f[i]);
+  if (!FinishInput(ctx, data)) { output.SetCardinality(0); return OperatorFinalizeResultType::FINISHED; }
+  if (!gs.computed) {
+    if (gs.input.Size() == 0) { gs.computed = true; output.SetCardinality(0); return OperatorFinalizeResultType::FINISHED; }
+    gs.result.Set(::onager::onager_compute_induced_subgraph(gs.input.I64(0), gs.input.I64(1), gs.input.Size(), gs.input.I64(2), gs.input.Size()), "Induced subgraph");
+    gs.computed = true;
   }
-  output.SetCardinality(0); return OperatorResultType::NEED_MORE_INPUT;
+  return EmitResultChunk(gs.result, gs.output_idx, output);
 }
-static OperatorFinalizeResultType InducedSubgraphFinal(ExecutionContext &ctx, TableFunctionInput &data, DataChunk &output) {
-  auto &gs = data.global_state->Cast<InducedSubgraphGlobalState>();
-  std::lock_guard<std::mutex> lock(gs.input_mutex);
+
+// =============================================================================
+// Neighborhoods of Many Centers
+// =============================================================================
+// K-hop nodes or ego graph edges of many centers over one graph build. Centers
+// come from the centers list when the input is an edge table, or from the input
+// rows when graph names a registry graph. Rust workers run a bounded BFS per
+// center in parallel and the final callback drains their rows one vector at a time.
+
+struct NeighborhoodBindData : public GraphBindData {
+  vector<int64_t> centers; int64_t radius = 1; bool edges = false;
+};
+struct NeighborhoodGlobalState : public InputGlobalState {
+  ~NeighborhoodGlobalState() override { ::onager::onager_free_neighborhood_stream(stream); }
+  ::onager::OnagerNeighborhoodStream *stream = nullptr;
+  bool computed = false;
+};
+
+static unique_ptr<FunctionData> NeighborhoodBind(TableFunctionBindInput &input, vector<LogicalType> &rt, vector<string> &nm, const std::string &fn, const std::string &radius_name, bool edges) {
+  auto bd = make_uniq<NeighborhoodBindData>();
+  bd->edges = edges;
+  bool has_centers = false;
+  for (auto &kv : input.named_parameters) {
+    if (kv.first == radius_name) {
+      if (kv.second.IsNull()) throw InvalidInputException(fn + " " + radius_name + " must not be NULL");
+      bd->radius = kv.second.GetValue<int64_t>();
+      if (bd->radius < 0) throw InvalidInputException(fn + " requires " + radius_name + " to be non-negative");
+    }
+    if (kv.first != "centers") continue;
+    if (kv.second.IsNull()) throw InvalidInputException(fn + " centers must not be NULL");
+    for (auto &child : ListValue::GetChildren(kv.second)) {
+      if (child.IsNull()) throw InvalidInputException(fn + " centers must not contain NULL");
+      bd->centers.push_back(child.GetValue<int64_t>());
+    }
+    has_centers = true;
+  }
+  if (BindGraphName(input, bd->graph)) {
+    if (has_centers) throw InvalidInputException(fn + " takes its centers from the input table when graph is given");
+    if (input.input_table_types.empty() || input.input_table_types[0] != LogicalType::BIGINT) {
+      throw InvalidInputException(fn + " with graph requires a BIGINT center column. Please cast it to BIGINT (e.g. column::bigint)");
+    }
+  } else {
+    if (!has_centers) throw InvalidInputException(fn + " requires centers := [...] or graph := 'name'");
+    CheckInt64Input(input, fn);
+  }
+  rt.push_back(LogicalType::BIGINT); nm.push_back("center");
+  rt.push_back(LogicalType::BIGINT); nm.push_back(edges ? "src" : "node_id");
+  rt.push_back(LogicalType::BIGINT); nm.push_back(edges ? "dst" : "hop");
+  return std::move(bd);
+}
+static unique_ptr<FunctionData> MultiEgoGraphBind(ClientContext &ctx, TableFunctionBindInput &input, vector<LogicalType> &rt, vector<string> &nm) {
+  return NeighborhoodBind(input, rt, nm, "onager_sub_multi_ego_graph", "radius", true);
+}
+static unique_ptr<FunctionData> MultiKHopBind(ClientContext &ctx, TableFunctionBindInput &input, vector<LogicalType> &rt, vector<string> &nm) {
+  return NeighborhoodBind(input, rt, nm, "onager_sub_multi_k_hop", "k", false);
+}
+static unique_ptr<GlobalTableFunctionState> NeighborhoodInitGlobal(ClientContext &ctx, TableFunctionInitInput &input) { return make_uniq<NeighborhoodGlobalState>(); }
+static unique_ptr<LocalTableFunctionState> NeighborhoodInitLocal(ExecutionContext &ctx, TableFunctionInitInput &input, GlobalTableFunctionState *global_state) {
+  auto &bd = input.bind_data->Cast<NeighborhoodBindData>();
+  return MakeInputLocal(global_state, bd.graph.empty() ? 2 : 1, 0);
+}
+static OperatorFinalizeResultType NeighborhoodFinal(ExecutionContext &ctx, TableFunctionInput &data, DataChunk &output) {
+  auto &bd = data.bind_data->Cast<NeighborhoodBindData>(); auto &gs = data.global_state->Cast<NeighborhoodGlobalState>();
+  if (!FinishInput(ctx, data, !bd.graph.empty())) { output.SetCardinality(0); return OperatorFinalizeResultType::FINISHED; }
   if (!gs.computed) {
-    if (gs.src_nodes.empty()) { gs.computed = true; output.SetCardinality(0); return OperatorFinalizeResultType::FINISHED; }
-    int64_t nc = ::onager::onager_compute_induced_subgraph(gs.src_nodes.data(), gs.dst_nodes.data(), gs.src_nodes.size(), gs.filter_nodes.data(), gs.filter_nodes.size(), nullptr, nullptr);
-    if (nc < 0) throw InvalidInputException("Induced subgraph failed: " + GetOnagerError());
-    gs.result_src.resize(nc); gs.result_dst.resize(nc);
-    ::onager::onager_compute_induced_subgraph(gs.src_nodes.data(), gs.dst_nodes.data(), gs.src_nodes.size(), gs.filter_nodes.data(), gs.filter_nodes.size(), gs.result_src.data(), gs.result_dst.data());
     gs.computed = true;
+    auto radius = static_cast<uintptr_t>(bd.radius);
+    if (!bd.graph.empty()) {
+      gs.stream = ::onager::onager_graph_neighborhood_search(bd.graph.c_str(), gs.input.I64(0), gs.input.Size(), radius, bd.edges);
+    } else {
+      if (gs.input.Size() == 0) { output.SetCardinality(0); return OperatorFinalizeResultType::FINISHED; }
+      gs.stream = ::onager::onager_neighborhood_search(gs.input.I64(0), gs.input.I64(1), gs.input.Size(), bd.centers.data(), bd.centers.size(), radius, bd.edges);
+    }
+    if (!gs.stream) ThrowOnagerError("Neighborhood search");
+  }
+  if (!gs.stream) { output.SetCardinality(0); return OperatorFinalizeResultType::FINISHED; }
+  auto center = GetFlatVectorDataWritable<int64_t>(output.data[0]);
+  auto first = GetFlatVectorDataWritable<int64_t>(output.data[1]);
+  auto second = GetFlatVectorDataWritable<int64_t>(output.data[2]);
+  int64_t count = ::onager::onager_neighborhood_stream_next(gs.stream, center, first, second, STANDARD_VECTOR_SIZE);
+  if (count < 0) ThrowOnagerError("Neighborhood search");
+  output.SetCardinality(static_cast<idx_t>(count));
+  if (static_cast<idx_t>(count) < STANDARD_VECTOR_SIZE) {
+    ::onager::onager_free_neighborhood_stream(gs.stream);
+    gs.stream = nullptr;
+    return OperatorFinalizeResultType::FINISHED;
   }
-  idx_t rem = gs.result_src.size() - gs.output_idx;
-  if (rem == 0) { output.SetCardinality(0); return OperatorFinalizeResultType::FINISHED; }
-  idx_t to = MinValue<idx_t>(rem, STANDARD_VECTOR_SIZE);
-  auto s = GetFlatVectorDataWritable<int64_t>(output.data[0]); auto d = GetFlatVectorDataWritable<int64_t>(output.data[1]);
-  for (idx_t i = 0; i < to; i++) { s[i] = gs.result_src[gs.output_idx+i]; d[i] = gs.result_dst[gs.output_idx+i]; }
-  gs.output_idx += to; output.SetCardinality(to);
-  return gs.output_idx >= gs.result_src.size() ? OperatorFinalizeResultType::FINISHED : OperatorFinalizeResultType::HAVE_MORE_OUTPUT;
+  return OperatorFinalizeResultType::HAVE_MORE_OUTPUT;
 }
 
 // =============================================================================
@@ -171,7 +199,8 @@ namespace onager {
 
 void RegisterSubgraphFunctions(ExtensionLoader &loader) {
   TableFunction ego_graph("onager_sub_ego_graph", {LogicalType::TABLE}, nullptr, EgoGraphBind, EgoGraphInitGlobal);
-  ego_graph.in_out_function = EgoGraphInOut;
+  ego_graph.in_out_function = CollectInput;
+  ego_graph.init_local = InitInputLocal<2>;
   ego_graph.in_out_function_final = EgoGraphFinal;
   ego_graph.named_parameters["center"] = LogicalType::BIGINT;
   ego_graph.named_parameters["radius"] = LogicalType::BIGINT;
@@ -179,7 +208,8 @@ void RegisterSubgraphFunctions(ExtensionLoader &loader) {
   loader.RegisterFunction(ego_graph);
 
   TableFunction k_hop("onager_sub_k_hop", {LogicalType::TABLE}, nullptr, KHopBind, KHopInitGlobal);
-  k_hop.in_out_function = KHopInOut;
+  k_hop.in_out_function = CollectInput;
+  k_hop.init_local = InitInputLocal<2>;
   k_hop.in_out_function_final = KHopFinal;
   k_hop.named_parameters["start"] = LogicalType::BIGINT;
   k_hop.named_parameters["k"] = LogicalType::BIGINT;
@@ -187,10 +217,31 @@ void RegisterSubgraphFunctions(ExtensionLoader &loader) {
   loader.RegisterFunction(k_hop);
 
   TableFunction induced("onager_sub_induced", {LogicalType::TABLE}, nullptr, InducedSubgraphBind, InducedSubgraphInitGlobal);
-  induced.in_out_function = InducedSubgraphInOut;
+  induced.in_out_function = CollectInput;
+  induced.init_local = InitInputLocal<3>;
   induced.in_out_function_final = InducedSubgraphFinal;
   ONAGER_SET_NO_ORDER(induced);
   loader.RegisterFunction(induced);
+
+  TableFunction multi_ego_graph("onager_sub_multi_ego_graph", {LogicalType::TABLE}, nullptr, MultiEgoGraphBind, NeighborhoodInitGlobal);
+  multi_ego_graph.in_out_function = CollectInput;
+  multi_ego_graph.init_local = NeighborhoodInitLocal;
+  multi_ego_graph.in_out_function_final = NeighborhoodFinal;
+  multi_ego_graph.named_parameters["centers"] = LogicalType::LIST(LogicalType::BIGINT);
+  multi_ego_graph.named_parameters["graph"] = LogicalType::VARCHAR;
+  multi_ego_graph.named_parameters["radius"] = LogicalType::BIGINT;
+  ONAGER_SET_NO_ORDER(multi_ego_graph);
+  loader.RegisterFunction(multi_ego_graph);
+
+  TableFunction multi_k_hop("onager_sub_multi_k_hop", {LogicalType::TABLE}, nullptr, MultiKHopBind, NeighborhoodInitGlobal);
+  multi_k_hop.in_out_function = CollectInput;
+  multi_k_hop.init_local = NeighborhoodInitLocal;
+  multi_k_hop.in_out_function_final = NeighborhoodFinal;
+  multi_k_hop.named_parameters["centers"] = LogicalType::LIST(LogicalType::BIGINT);
+  multi_k_hop.named_parameters["graph"] = LogicalType::VARCHAR;
+  multi_k_hop.named_parameters["k"] = LogicalType::BIGINT;
+  ONAGER_SET_NO_ORDER(multi_k_hop);
+  loader.RegisterFunction(multi_k_hop);
 }
 
 } // namespace onager
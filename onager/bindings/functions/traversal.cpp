@@ -2,10 +2,9 @@
  * @file traversal.cpp
  * @brief Traversal and path table functions for Onager DuckDB extension.
  *
- * Dijkstra, BFS, DFS, Bellman-Ford, Floyd-Warshall.
+ * Dijkstra, BFS, DFS, Bellman-Ford, Floyd-Warshall, multi-source and pair distances.
  */
 #include "functions.hpp"
-#include <mutex>
 
 namespace duckdb {
 
@@ -15,143 +14,106 @@ using namespace onager;
 // Dijkstra Shortest Paths
 // =============================================================================
 
-struct DijkstraBindData : public TableFunctionData { int64_t source = 0; };
-struct DijkstraGlobalState : public GlobalTableFunctionState {
-  std::mutex input_mutex;
-  std::vector<int64_t> src_nodes, dst_nodes, result_nodes;
-  std::vector<double> result_distances;
+struct DijkstraBindData : public GraphBindData { int64_t source = 0; WeightColumn weights; };
+struct DijkstraGlobalState : public InputGlobalState {
+  OnagerResultHandle result;
   idx_t output_idx = 0; bool computed = false;
-  idx_t MaxThreads() const override { return 1; }
 };
 
 static unique_ptr<FunctionData> DijkstraBind(ClientContext &ctx, TableFunctionBindInput &input, vector<LogicalType> &rt, vector<string> &nm) {
   auto bd = make_uniq<DijkstraBindData>();
-  CheckInt64Input(input, "onager_pth_dijkstra");
+  if (!BindGraphName(input, bd->graph)) {
+    CheckInt64Input(input, "onager_pth_dijkstra");
+    bd->weights.Bind(input);
+  }
   for (auto &kv : input.named_parameters) if (kv.first == "source") bd->source = kv.second.GetValue<int64_t>();
   rt.push_back(LogicalType::BIGINT); nm.push_back("node_id");
   rt.push_back(LogicalType::DOUBLE); nm.push_back("distance");
   return std::move(bd);
 }
 static unique_ptr<GlobalTableFunctionState> DijkstraInitGlobal(ClientContext &ctx, TableFunctionInitInput &input) { return make_uniq<DijkstraGlobalState>(); }
-static OperatorResultType DijkstraInOut(ExecutionContext &ctx, TableFunctionInput &data, DataChunk &input, DataChunk &output) {
-  auto &gs = data.global_state->Cast<DijkstraGlobalState>();
-  std::lock_guard<std::mutex> lock(gs.input_mutex);
-  auto s = FlatVector::GetData<int64_t>(input.data[0]); auto d = FlatVector::GetData<int64_t>(input.data[1]);
-  for (idx_t i = 0; i < input.size(); i++) { gs.src_nodes.push_back(s[i]); gs.dst_nodes.push_back(d[i]); }
-  output.SetCardinality(0); return OperatorResultType::NEED_MORE_INPUT;
+static unique_ptr<LocalTableFunctionState> DijkstraInitLocal(ExecutionContext &ctx, TableFunctionInitInput &input, GlobalTableFunctionState *global_state) {
+  return input.bind_data->Cast<DijkstraBindData>().weights.MakeLocal(global_state);
 }
 static OperatorFinalizeResultType DijkstraFinal(ExecutionContext &ctx, TableFunctionInput &data, DataChunk &output) {
   auto &bd = data.bind_data->Cast<DijkstraBindData>(); auto &gs = data.global_state->Cast<DijkstraGlobalState>();
-  std::lock_guard<std::mutex> lock(gs.input_mutex);
+  if (!FinishInput(ctx, data)) { output.SetCardinality(0); return OperatorFinalizeResultType::FINISHED; }
   if (!gs.computed) {
-    if (gs.src_nodes.empty()) { gs.computed = true; output.SetCardinality(0); return OperatorFinalizeResultType::FINISHED; }
-    int64_t nc = ::onager::onager_compute_dijkstra(gs.src_nodes.data(), gs.dst_nodes.data(), gs.src_nodes.size(), bd.source, nullptr, nullptr);
-    if (nc < 0) throw InvalidInputException("Dijkstra failed: " + GetOnagerError());
-    gs.result_nodes.resize(nc); gs.result_distances.resize(nc);
-    ::onager::onager_compute_dijkstra(gs.src_nodes.data(), gs.dst_nodes.data(), gs.src_nodes.size(), bd.source, gs.result_nodes.data(), gs.result_distances.data());
+    if (gs.input.Size() == 0) { gs.computed = true; output.SetCardinality(0); return OperatorFinalizeResultType::FINISHED; }
+    gs.result.Set(::onager::onager_compute_dijkstra(gs.input.I64(0), gs.input.I64(1), gs.input.Size(), bd.weights.Data(gs.input), bd.weights.Size(gs.input), bd.source), "Dijkstra");
     gs.computed = true;
   }
-  idx_t rem = gs.result_nodes.size() - gs.output_idx;
-  if (rem == 0) { output.SetCardinality(0); return OperatorFinalizeResultType::FINISHED; }
-  idx_t to = MinValue<idx_t>(rem, STANDARD_VECTOR_SIZE);
-  auto n = GetFlatVectorDataWritable<int64_t>(output.data[0]); auto d = GetFlatVectorDataWritable<double>(output.data[1]);
-  for (idx_t i = 0; i < to; i++) { n[i] = gs.result_nodes[gs.output_idx+i]; d[i] = gs.result_distances[gs.output_idx+i]; }
-  gs.output_idx += to; output.SetCardinality(to);
-  return gs.output_idx >= gs.result_nodes.size() ? OperatorFinalizeResultType::FINISHED : OperatorFinalizeResultType::HAVE_MORE_OUTPUT;
+  return EmitResultChunk(gs.result, gs.output_idx, output);
+}
+static void DijkstraGraphScan(ClientContext &ctx, TableFunctionInput &data, DataChunk &output) {
+  auto &bd = data.bind_data->Cast<DijkstraBindData>();
+  EmitGraphResult(ctx, data, output, "Dijkstra", [&](const char *graph) { return ::onager::onager_graph_compute_dijkstra(graph, bd.source); });
 }
 
 // =============================================================================
 // BFS Traversal
 // =============================================================================
 
-struct BfsBindData : public TableFunctionData { int64_t source = 0; };
-struct BfsGlobalState : public GlobalTableFunctionState {
-  std::mutex input_mutex;
-  std::vector<int64_t> src_nodes, dst_nodes, result_order;
+struct BfsBindData : public GraphBindData { int64_t source = 0; };
+struct BfsGlobalState : public InputGlobalState {
+  OnagerResultHandle result;
   idx_t output_idx = 0; bool computed = false;
-  idx_t MaxThreads() const override { return 1; }
 };
 
 static unique_ptr<FunctionData> BfsBind(ClientContext &ctx, TableFunctionBindInput &input, vector<LogicalType> &rt, vector<string> &nm) {
   auto bd = make_uniq<BfsBindData>();
-  CheckInt64Input(input, "onager_trv_bfs");
+  if (!BindGraphName(input, bd->graph)) CheckInt64Input(input, "onager_trv_bfs");
   for (auto &kv : input.named_parameters) if (kv.first == "source") bd->source = kv.second.GetValue<int64_t>();
   rt.push_back(LogicalType::BIGINT); nm.push_back("node_id");
   return std::move(bd);
 }
 static unique_ptr<GlobalTableFunctionState> BfsInitGlobal(ClientContext &ctx, TableFunctionInitInput &input) { return make_uniq<BfsGlobalState>(); }
-static OperatorResultType BfsInOut(ExecutionContext &ctx, TableFunctionInput &data, DataChunk &input, DataChunk &output) {
-  auto &gs = data.global_state->Cast<BfsGlobalState>();
-  std::lock_guard<std::mutex> lock(gs.input_mutex);
-  auto s = FlatVector::GetData<int64_t>(input.data[0]); auto d = FlatVector::GetData<int64_t>(input.data[1]);
-  for (idx_t i = 0; i < input.size(); i++) { gs.src_nodes.push_back(s[i]); gs.dst_nodes.push_back(d[i]); }
-  output.SetCardinality(0); return OperatorResultType::NEED_MORE_INPUT;
-}
 static OperatorFinalizeResultType BfsFinal(ExecutionContext &ctx, TableFunctionInput &data, DataChunk &output) {
   auto &bd = data.bind_data->Cast<BfsBindData>(); auto &gs = data.global_state->Cast<BfsGlobalState>();
-  std::lock_guard<std::mutex> lock(gs.input_mutex);
+  if (!FinishInput(ctx, data)) { output.SetCardinality(0); return OperatorFinalizeResultType::FINISHED; }
   if (!gs.computed) {
-    if (gs.src_nodes.empty()) { gs.computed = true; output.SetCardinality(0); return OperatorFinalizeResultType::FINISHED; }
-    int64_t nc = ::onager::onager_compute_bfs(gs.src_nodes.data(), gs.dst_nodes.data(), gs.src_nodes.size(), bd.source, nullptr);
-    if (nc < 0) throw InvalidInputException("BFS failed: " + GetOnagerError());
-    gs.result_order.resize(nc);
-    ::onager::onager_compute_bfs(gs.src_nodes.data(), gs.dst_nodes.data(), gs.src_nodes.size(), bd.source, gs.result_order.data());
+    if (gs.input.Size() == 0) { gs.computed = true; output.SetCardinality(0); return OperatorFinalizeResultType::FINISHED; }
+    gs.result.Set(::onager::onager_compute_bfs(gs.input.I64(0), gs.input.I64(1), gs.input.Size(), bd.source), "BFS");
     gs.computed = true;
   }
-  idx_t rem = gs.result_order.size() - gs.output_idx;
-  if (rem == 0) { output.SetCardinality(0); return OperatorFinalizeResultType::FINISHED; }
-  idx_t to = MinValue<idx_t>(rem, STANDARD_VECTOR_SIZE);
-  auto n = GetFlatVectorDataWritable<int64_t>(output.data[0]);
-  for (idx_t i = 0; i < to; i++) { n[i] = gs.result_order[gs.output_idx+i]; }
-  gs.output_idx += to; output.SetCardinality(to);
-  return gs.output_idx >= gs.result_order.size() ? OperatorFinalizeResultType::FINISHED : OperatorFinalizeResultType::HAVE_MORE_OUTPUT;
+  return EmitResultChunk(gs.result, gs.output_idx, output);
+}
+static void BfsGraphScan(ClientContext &ctx, TableFunctionInput &data, DataChunk &output) {
+  auto &bd = data.bind_data->Cast<BfsBindData>();
+  EmitGraphResult(ctx, data, output, "BFS", [&](const char *graph) { return ::onager::onager_graph_compute_bfs(graph, bd.source); });
 }
 
 // =============================================================================
 // DFS Traversal
 // =============================================================================
 
-struct DfsBindData : public TableFunctionData { int64_t source = 0; };
-struct DfsGlobalState : public GlobalTableFunctionState {
-  std::mutex input_mutex;
-  std::vector<int64_t> src_nodes, dst_nodes, result_order;
+struct DfsBindData : public GraphBindData { int64_t source = 0; };
+struct DfsGlobalState : public InputGlobalState {
+  OnagerResultHandle result;
   idx_t output_idx = 0; bool computed = false;
-  idx_t MaxThreads() const override { return 1; }
 };
 
 static unique_ptr<FunctionData> DfsBind(ClientContext &ctx, TableFunctionBindInput &input, vector<LogicalType> &rt, vector<string> &nm) {
   auto bd = make_uniq<DfsBindData>();
-  CheckInt64Input(input, "onager_trv_dfs");
+  if (!BindGraphName(input, bd->graph)) CheckInt64Input(input, "onager_trv_dfs");
   for (auto &kv : input.named_parameters) if (kv.first == "source") bd->source = kv.second.GetValue<int64_t>();
   rt.push_back(LogicalType::BIGINT); nm.push_back("node_id");
   return std::move(bd);
 }
 static unique_ptr<GlobalTableFunctionState> DfsInitGlobal(ClientContext &ctx, TableFunctionInitInput &input) { return make_uniq<DfsGlobalState>(); }
-static OperatorResultType DfsInOut(ExecutionContext &ctx, TableFunctionInput &data, DataChunk &input, DataChunk &output) {
-  auto &gs = data.global_state->Cast<DfsGlobalState>();
-  std::lock_guard<std::mutex> lock(gs.input_mutex);
-  auto s = FlatVector::GetData<int64_t>(input.data[0]); auto d = FlatVector::GetData<int64_t>(input.data[1]);
-  for (idx_t i = 0; i < input.size(); i++) { gs.src_nodes.push_back(s[i]); gs.dst_nodes.push_back(d[i]); }
-  output.SetCardinality(0); return OperatorResultType::NEED_MORE_INPUT;
-}
 static OperatorFinalizeResultType DfsFinal(ExecutionContext &ctx, TableFunctionInput &data, DataChunk &output) {
   auto &bd = data.bind_data->Cast<DfsBindData>(); auto &gs = data.global_state->Cast<DfsGlobalState>();
-  std::lock_guard<std::mutex> lock(gs.input_mutex);
+  if (!FinishInput(ctx, data)) { output.SetCardinality(0); return OperatorFinalizeResultType::FINISHED; }
   if (!gs.computed) {
-    if (gs.src_nodes.empty()) { gs.computed = true; output.SetCardinality(0); return OperatorFinalizeResultType::FINISHED; }
-    int64_t nc = ::onager::onager_compute_dfs(gs.src_nodes.data(), gs.dst_nodes.data(), gs.src_nodes.size(), bd.source, nullptr);
-    if (nc < 0) throw InvalidInputException("DFS failed: " + GetOnagerError());
-    gs.result_order.resize(nc);
-    ::onager::onager_compute_dfs(gs.src_nodes.data(), gs.dst_nodes.data(), gs.src_nodes.size(), bd.source, gs.result_order.data());
+    if (gs.input.Size() == 0) { gs.computed = true; output.SetCardinality(0); return OperatorFinalizeResultType::FINISHED; }
+    gs.result.Set(::onager::onager_compute_dfs(gs.input.I64(0), gs.input.I64(1), gs.input.Size(), bd.source), "DFS");
     gs.computed = true;
   }
-  idx_t rem = gs.result_order.size() - gs.output_idx;
-  if (rem == 0) { output.SetCardinality(0); return OperatorFinalizeResultType::FINISHED; }
-  idx_t to = MinValue<idx_t>(rem, STANDARD_VECTOR_SIZE);
-  auto n = GetFlatVectorDataWritable<int64_t>(output.data[0]);
-  for (idx_t i = 0; i < to; i++) { n[i] = gs.result_order[gs.output_idx+i]; }
-  gs.output_idx += to; output.SetCardinality(to);
-  return gs.output_idx >= gs.result_order.size() ? OperatorFinalizeResultType::FINISHED : OperatorFinalizeResultType::HAVE_MORE_OUTPUT;
+  return EmitResultChunk(gs.result, gs.output_idx, output);
+}
+static void DfsGraphScan(ClientContext &ctx, TableFunctionInput &data, DataChunk &output) {
+  auto &bd = data.bind_data->Cast<DfsBindData>();
+  EmitGraphResult(ctx, data, output, "DFS", [&](const char *graph) { return ::onager::onager_graph_compute_dfs(graph, bd.source); });
 }
 
 // =============================================================================
@@ -159,12 +121,9 @@ static OperatorFinalizeResultType DfsFinal(ExecutionContext &ctx, TableFunctionI
 // =============================================================================
 
 struct BellmanFordBindData : public TableFunctionData { int64_t source = 0; };
-struct BellmanFordGlobalState : public GlobalTableFunctionState {
-  std::mutex input_mutex;
-  std::vector<int64_t> src_nodes, dst_nodes, result_nodes;
-  std::vector<double> weights, result_distances;
+struct BellmanFordGlobalState : public InputGlobalState {
+  OnagerResultHandle result;
   idx_t output_idx = 0; bool computed = false;
-  idx_t MaxThreads() const override { return 1; }
 };
 
 static unique_ptr<FunctionData> BellmanFordBind(ClientContext &ctx, TableFunctionBindInput &input, vector<LogicalType> &rt, vector<string> &nm) {
@@ -176,44 +135,28 @@ static unique_ptr<FunctionData> BellmanFordBind(ClientContext &ctx, TableFunctio
   return std::move(bd);
 }
 static unique_ptr<GlobalTableFunctionState> BellmanFordInitGlobal(ClientContext &ctx, TableFunctionInitInput &input) { return make_uniq<BellmanFordGlobalState>(); }
-static OperatorResultType BellmanFordInOut(ExecutionContext &ctx, TableFunctionInput &data, DataChunk &input, DataChunk &output) {
-  auto &gs = data.global_state->Cast<BellmanFordGlobalState>();
-  std::lock_guard<std::mutex> lock(gs.input_mutex);
-  auto s = FlatVector::GetData<int64_t>(input.data[0]); auto d = FlatVector::GetData<int64_t>(input.data[1]);
-  auto w = FlatVector::GetData<double>(input.data[2]);
-  for (idx_t i = 0; i < input.size(); i++) { gs.src_nodes.push_back(s[i]); gs.dst_nodes.push_back(d[i]); gs.weights.push_back(w[i]); }
-  output.SetCardinality(0); return OperatorResultType::NEED_MORE_INPUT;
-}
 static OperatorFinalizeResultType BellmanFordFinal(ExecutionContext &ctx, TableFunctionInput &data, DataChunk &output) {
   auto &bd = data.bind_data->Cast<BellmanFordBindData>(); auto &gs = data.global_state->Cast<BellmanFordGlobalState>();
-  std::lock_guard<std::mutex> lock(gs.input_mutex);
+  if (!FinishInput(ctx, data)) { output.SetCardinality(0); return OperatorFinalizeResultType::FINISHED; }
   if (!gs.computed) {
-    if (gs.src_nodes.empty()) { gs.computed = true; output.SetCardinality(0); return OperatorFinalizeResultType::FINISHED; }
-    int64_t nc = ::onager::onager_compute_bellman_ford(gs.src_nodes.data(), gs.dst_nodes.data(), gs.weights.data(), gs.src_nodes.size(), bd.source, nullptr, nullptr);
-    if (nc < 0) throw InvalidInputException("Bellman-Ford failed: " + GetOnagerError());
-    gs.result_nodes.resize(nc); gs.result_distances.resize(nc);
-    ::onager::onager_compute_bellman_ford(gs.src_nodes.data(), gs.dst_nodes.data(), gs.weights.data(), gs.src_nodes.size(), bd.source, gs.result_nodes.data(), gs.result_distances.data());
+    if (gs.input.Size() == 0) { gs.computed = true; output.SetCardinality(0); return OperatorFinalizeResultType::FINISHED; }
+    gs.result.Set(::onager::onager_compute_bellman_ford(gs.input.I64(0), gs.input.I64(1), gs.input.F64(0), gs.input.Size(), bd.source), "Bellman-Ford");
     gs.computed = true;
   }
-  idx_t rem = gs.result_nodes.size() - gs.output_idx;
-  if (rem == 0) { output.SetCardinality(0); return OperatorFinalizeResultType::FINISHED; }
-  idx_t to = MinValue<idx_t>(rem, STANDARD_VECTOR_SIZE);
-  auto n = GetFlatVectorDataWritable<int64_t>(output.data[0]); auto d = GetFlatVectorDataWritable<double>(output.data[1]);
-  for (idx_t i = 0; i < to; i++) { n[i] = gs.result_nodes[gs.output_idx+i]; d[i] = gs.result_distances[gs.output_idx+i]; }
-  gs.output_idx += to; output.SetCardinality(to);
-  return gs.output_idx >= gs.result_nodes.size() ? OperatorFinalizeResultType::FINISHED : OperatorFinalizeResultType::HAVE_MORE_OUTPUT;
+  return EmitResultChunk(gs.result, gs.output_idx, output);
 }
 
 // =============================================================================
 // Floyd-Warshall All-Pairs Shortest Paths
 // =============================================================================
 
-struct FloydWarshallGlobalState : public GlobalTableFunctionState {
-  std::mutex input_mutex;
-  std::vector<int64_t> src_nodes, dst_nodes, result_src, result_dst;
-  std::vector<double> weights, result_distances;
-  idx_t output_idx = 0; bool computed = false;
-  idx_t MaxThreads() const override { return 1; }
+// The distance matrix is checked against DuckDB's memory_limit before it is
+// allocated, and reachable pairs are pulled out of it one vector at a time.
+
+struct FloydWarshallGlobalState : public InputGlobalState {
+  ~FloydWarshallGlobalState() override { ::onager::onager_free_distance_matrix(matrix); }
+  ::onager::OnagerDistanceMatrix *matrix = nullptr;
+  idx_t memory_limit = 0; bool computed = false;
 };
 
 static unique_ptr<FunctionData> FloydWarshallBind(ClientContext &ctx, TableFunctionBindInput &input, vector<LogicalType> &rt, vector<string> &nm) {
@@ -223,33 +166,150 @@ static unique_ptr<FunctionData> FloydWarshallBind(ClientContext &ctx, TableFunct
   rt.push_back(LogicalType::DOUBLE); nm.push_back("distance");
   return make_uniq<TableFunctionData>();
 }
-static unique_ptr<GlobalTableFunctionState> FloydWarshallInitGlobal(ClientContext &ctx, TableFunctionInitInput &input) { return make_uniq<FloydWarshallGlobalState>(); }
-static OperatorResultType FloydWarshallInOut(ExecutionContext &ctx, TableFunctionInput &data, DataChunk &input, DataChunk &output) {
-  auto &gs = data.global_state->Cast<FloydWarshallGlobalState>();
-  std::lock_guard<std::mutex> lock(gs.input_mutex);
-  auto s = FlatVector::GetData<int64_t>(input.data[0]); auto d = FlatVector::GetData<int64_t>(input.data[1]);
-  auto w = FlatVector::GetData<double>(input.data[2]);
-  for (idx_t i = 0; i < input.size(); i++) { gs.src_nodes.push_back(s[i]); gs.dst_nodes.push_back(d[i]); gs.weights.push_back(w[i]); }
-  output.SetCardinality(0); return OperatorResultType::NEED_MORE_INPUT;
+static unique_ptr<GlobalTableFunctionState> FloydWarshallInitGlobal(ClientContext &ctx, TableFunctionInitInput &input) {
+  auto gs = make_uniq<FloydWarshallGlobalState>();
+  gs->memory_limit = GetMemoryLimit(ctx);
+  return std::move(gs);
 }
 static OperatorFinalizeResultType FloydWarshallFinal(ExecutionContext &ctx, TableFunctionInput &data, DataChunk &output) {
   auto &gs = data.global_state->Cast<FloydWarshallGlobalState>();
-  std::lock_guard<std::mutex> lock(gs.input_mutex);
+  if (!FinishInput(ctx, data)) { output.SetCardinality(0); return OperatorFinalizeResultType::FINISHED; }
   if (!gs.computed) {
-    if (gs.src_nodes.empty()) { gs.computed = true; output.SetCardinality(0); return OperatorFinalizeResultType::FINISHED; }
-    int64_t nc = ::onager::onager_compute_floyd_warshall(gs.src_nodes.data(), gs.dst_nodes.data(), gs.weights.data(), gs.src_nodes.size(), nullptr, nullptr, nullptr);
-    if (nc < 0) throw InvalidInputException("Floyd-Warshall failed: " + GetOnagerError());
-    gs.result_src.resize(nc); gs.result_dst.resize(nc); gs.result_distances.resize(nc);
-    ::onager::onager_compute_floyd_warshall(gs.src_nodes.data(), gs.dst_nodes.data(), gs.weights.data(), gs.src_nodes.size(), gs.result_src.data(), gs.result_dst.data(), gs.result_distances.data());
     gs.computed = true;
+    if (gs.input.Size() == 0) { output.SetCardinality(0); return OperatorFinalizeResultType::FINISHED; }
+    gs.matrix = ::onager::onager_floyd_warshall_matrix(gs.input.I64(0), gs.input.I64(1), gs.input.F64(0), gs.input.Size(), static_cast<size_t>(gs.memory_limit));
+    if (!gs.matrix) throw InvalidInputException("Floyd-Warshall failed: " + GetOnagerError());
   }
-  idx_t rem = gs.result_src.size() - gs.output_idx;
-  if (rem == 0) { output.SetCardinality(0); return OperatorFinalizeResultType::FINISHED; }
-  idx_t to = MinValue<idx_t>(rem, STANDARD_VECTOR_SIZE);
-  auto s = GetFlatVectorDataWritable<int64_t>(output.data[0]); auto d = GetFlatVectorDataWritable<int64_t>(output.data[1]); auto w = GetFlatVectorDataWritable<double>(output.data[2]);
-  for (idx_t i = 0; i < to; i++) { s[i] = gs.result_src[gs.output_idx+i]; d[i] = gs.result_dst[gs.output_idx+i]; w[i] = gs.result_distances[gs.output_idx+i]; }
-  gs.output_idx += to; output.SetCardinality(to);
-  return gs.output_idx >= gs.result_src.size() ? OperatorFinalizeResultType::FINISHED : OperatorFinalizeResultType::HAVE_MORE_OUTPUT;
+  if (!gs.matrix) { output.SetCardinality(0); return OperatorFinalizeResultType::FINISHED; }
+  auto src = GetFlatVectorDataWritable<int64_t>(output.data[0]);
+  auto dst = GetFlatVectorDataWritable<int64_t>(output.data[1]);
+  auto dist = GetFlatVectorDataWritable<double>(output.data[2]);
+  idx_t count = ::onager::onager_distance_matrix_next(gs.matrix, src, dst, dist, STANDARD_VECTOR_SIZE);
+  output.SetCardinality(count);
+  if (count < STANDARD_VECTOR_SIZE) {
+    ::onager::onager_free_distance_matrix(gs.matrix);
+    gs.matrix = nullptr;
+    return OperatorFinalizeResultType::FINISHED;
+  }
+  return OperatorFinalizeResultType::HAVE_MORE_OUTPUT;
+}
+
+// =============================================================================
+// Multi-Source Distances
+// =============================================================================
+// Distances from many sources over one graph build. Sources come from the
+// sources list when the input is an edge table, or from the input rows when
+// graph names a registry graph. Rust workers search source batches in parallel
+// and the final callback drains their rows one vector at a time.
+
+struct MultiSourceBindData : public GraphBindData {
+  vector<int64_t> sources; WeightColumn weights;
+};
+struct MultiSourceGlobalState : public InputGlobalState {
+  ~MultiSourceGlobalState() override { ::onager::onager_free_distance_stream(stream); }
+  ::onager::OnagerDistanceStream *stream = nullptr;
+  bool computed = false;
+};
+
+static unique_ptr<FunctionData> MultiSourceBind(ClientContext &ctx, TableFunctionBindInput &input, vector<LogicalType> &rt, vector<string> &nm) {
+  auto bd = make_uniq<MultiSourceBindData>();
+  const std::string fn = "onager_pth_multi_source";
+  bool has_sources = false;
+  for (auto &kv : input.named_parameters) {
+    if (kv.first != "sources") continue;
+    if (kv.second.IsNull()) throw InvalidInputException(fn + " sources must not be NULL");
+    for (auto &child : ListValue::GetChildren(kv.second)) {
+      if (child.IsNull()) throw InvalidInputException(fn + " sources must not contain NULL");
+      bd->sources.push_back(child.GetValue<int64_t>());
+    }
+    has_sources = true;
+  }
+  if (BindGraphName(input, bd->graph)) {
+    if (has_sources) throw InvalidInputException(fn + " takes its sources from the input table when graph is given");
+    if (input.input_table_types.empty() || input.input_table_types[0] != LogicalType::BIGINT) {
+      throw InvalidInputException(fn + " with graph requires a BIGINT source column. Please cast it to BIGINT (e.g. column::bigint)");
+    }
+  } else {
+    if (!has_sources) throw InvalidInputException(fn + " requires sources := [...] or graph := 'name'");
+    CheckInt64Input(input, fn);
+    bd->weights.Bind(input);
+  }
+  rt.push_back(LogicalType::BIGINT); nm.push_back("source");
+  rt.push_back(LogicalType::BIGINT); nm.push_back("node_id");
+  rt.push_back(LogicalType::DOUBLE); nm.push_back("distance");
+  return std::move(bd);
+}
+static unique_ptr<GlobalTableFunctionState> MultiSourceInitGlobal(ClientContext &ctx, TableFunctionInitInput &input) { return make_uniq<MultiSourceGlobalState>(); }
+static unique_ptr<LocalTableFunctionState> MultiSourceInitLocal(ExecutionContext &ctx, TableFunctionInitInput &input, GlobalTableFunctionState *global_state) {
+  auto &bd = input.bind_data->Cast<MultiSourceBindData>();
+  if (!bd.graph.empty()) return MakeInputLocal(global_state, 1, 0);
+  return bd.weights.MakeLocal(global_state);
+}
+static OperatorFinalizeResultType MultiSourceFinal(ExecutionContext &ctx, TableFunctionInput &data, DataChunk &output) {
+  auto &bd = data.bind_data->Cast<MultiSourceBindData>(); auto &gs = data.global_state->Cast<MultiSourceGlobalState>();
+  if (!FinishInput(ctx, data, !bd.graph.empty())) { output.SetCardinality(0); return OperatorFinalizeResultType::FINISHED; }
+  if (!gs.computed) {
+    gs.computed = true;
+    if (!bd.graph.empty()) {
+      gs.stream = ::onager::onager_graph_multi_source_search(bd.graph.c_str(), gs.input.I64(0), gs.input.Size());
+    } else {
+      if (gs.input.Size() == 0) { output.SetCardinality(0); return OperatorFinalizeResultType::FINISHED; }
+      gs.stream = ::onager::onager_multi_source_search(gs.input.I64(0), gs.input.I64(1), bd.weights.Data(gs.input), gs.input.Size(), bd.sources.data(), bd.sources.size());
+    }
+    if (!gs.stream) ThrowOnagerError("Multi-source search");
+  }
+  if (!gs.stream) { output.SetCardinality(0); return OperatorFinalizeResultType::FINISHED; }
+  auto source = GetFlatVectorDataWritable<int64_t>(output.data[0]);
+  auto node = GetFlatVectorDataWritable<int64_t>(output.data[1]);
+  auto dist = GetFlatVectorDataWritable<double>(output.data[2]);
+  int64_t count = ::onager::onager_distance_stream_next(gs.stream, source, node, dist, STANDARD_VECTOR_SIZE);
+  if (count < 0) ThrowOnagerError("Multi-source search");
+  output.SetCardinality(static_cast<idx_t>(count));
+  if (static_cast<idx_t>(count) < STANDARD_VECTOR_SIZE) {
+    ::onager::onager_free_distance_stream(gs.stream);
+    gs.stream = nullptr;
+    return OperatorFinalizeResultType::FINISHED;
+  }
+  return OperatorFinalizeResultType::HAVE_MORE_OUTPUT;
+}
+
+// =============================================================================
+// Bidirectional Pair Distances
+// =============================================================================
+// Each input row is a (src, dst) query pair answered against a registry graph
+// by a bidirectional search that stops when the two frontiers meet.
+
+struct PairDistanceBindData : public GraphBindData { double max_depth = -1; };
+struct PairDistanceGlobalState : public InputGlobalState {
+  OnagerResultHandle result;
+  idx_t output_idx = 0; bool computed = false;
+};
+
+static unique_ptr<FunctionData> PairDistanceBind(ClientContext &ctx, TableFunctionBindInput &input, vector<LogicalType> &rt, vector<string> &nm) {
+  auto bd = make_uniq<PairDistanceBindData>();
+  const std::string fn = "onager_pth_bidirectional";
+  if (!BindGraphName(input, bd->graph)) throw InvalidInputException(fn + " requires graph := 'name'");
+  CheckInt64Input(input, fn);
+  for (auto &kv : input.named_parameters) {
+    if (kv.first != "max_depth") continue;
+    if (kv.second.IsNull()) throw InvalidInputException(fn + " max_depth must not be NULL");
+    bd->max_depth = kv.second.GetValue<double>();
+    if (bd->max_depth < 0) throw InvalidInputException(fn + " requires max_depth >= 0");
+  }
+  rt.push_back(LogicalType::BIGINT); nm.push_back("src");
+  rt.push_back(LogicalType::BIGINT); nm.push_back("dst");
+  rt.push_back(LogicalType::DOUBLE); nm.push_back("distance");
+  return std::move(bd);
+}
+static unique_ptr<GlobalTableFunctionState> PairDistanceInitGlobal(ClientContext &ctx, TableFunctionInitInput &input) { return make_uniq<PairDistanceGlobalState>(); }
+static OperatorFinalizeResultType PairDistanceFinal(ExecutionContext &ctx, TableFunctionInput &data, DataChunk &output) {
+  auto &bd = data.bind_data->Cast<PairDistanceBindData>(); auto &gs = data.global_state->Cast<PairDistanceGlobalState>();
+  if (!FinishInput(ctx, data, true)) { output.SetCardinality(0); return OperatorFinalizeResultType::FINISHED; }
+  if (!gs.computed) {
+    gs.result.Set(::onager::onager_graph_compute_pair_distances(bd.graph.c_str(), gs.input.I64(0), gs.input.I64(1), gs.input.Size(), bd.max_depth), "Bidirectional search");
+    gs.computed = true;
+  }
+  return EmitResultChunk(gs.result, gs.output_idx, output);
 }
 
 // =============================================================================
@@ -260,38 +320,61 @@ namespace onager {
 
 void RegisterTraversalFunctions(ExtensionLoader &loader) {
   TableFunction dijkstra("onager_pth_dijkstra", {LogicalType::TABLE}, nullptr, DijkstraBind, DijkstraInitGlobal);
-  dijkstra.in_out_function = DijkstraInOut;
+  dijkstra.in_out_function = CollectInput;
+  dijkstra.init_local = DijkstraInitLocal;
   dijkstra.in_out_function_final = DijkstraFinal;
   dijkstra.named_parameters["source"] = LogicalType::BIGINT;
   ONAGER_SET_NO_ORDER(dijkstra);
-  loader.RegisterFunction(dijkstra);
+  RegisterWithGraphOverload(loader, dijkstra, DijkstraGraphScan);
 
   TableFunction bfs("onager_trv_bfs", {LogicalType::TABLE}, nullptr, BfsBind, BfsInitGlobal);
-  bfs.in_out_function = BfsInOut;
+  bfs.in_out_function = CollectInput;
+  bfs.init_local = InitInputLocal<2>;
   bfs.in_out_function_final = BfsFinal;
   bfs.named_parameters["source"] = LogicalType::BIGINT;
   ONAGER_SET_NO_ORDER(bfs);
-  loader.RegisterFunction(bfs);
+  RegisterWithGraphOverload(loader, bfs, BfsGraphScan);
 
   TableFunction dfs("onager_trv_dfs", {LogicalType::TABLE}, nullptr, DfsBind, DfsInitGlobal);
-  dfs.in_out_function = DfsInOut;
+  dfs.in_out_function = CollectInput;
+  dfs.init_local = InitInputLocal<2>;
   dfs.in_out_function_final = DfsFinal;
   dfs.named_parameters["source"] = LogicalType::BIGINT;
   ONAGER_SET_NO_ORDER(dfs);
-  loader.RegisterFunction(dfs);
+  RegisterWithGraphOverload(loader, dfs, DfsGraphScan);
 
   TableFunction bellman_ford("onager_pth_bellman_ford", {LogicalType::TABLE}, nullptr, BellmanFordBind, BellmanFordInitGlobal);
-  bellman_ford.in_out_function = BellmanFordInOut;
+  bellman_ford.in_out_function = CollectInput;
+  bellman_ford.init_local = InitInputLocal<2, 1>;
   bellman_ford.in_out_function_final = BellmanFordFinal;
   bellman_ford.named_parameters["source"] = LogicalType::BIGINT;
   ONAGER_SET_NO_ORDER(bellman_ford);
   loader.RegisterFunction(bellman_ford);
 
   TableFunction floyd_warshall("onager_pth_floyd_warshall", {LogicalType::TABLE}, nullptr, FloydWarshallBind, FloydWarshallInitGlobal);
-  floyd_warshall.in_out_function = FloydWarshallInOut;
+  floyd_warshall.in_out_function = CollectInput;
+  floyd_warshall.init_local = InitInputLocal<2, 1>;
   floyd_warshall.in_out_function_final = FloydWarshallFinal;
   ONAGER_SET_NO_ORDER(floyd_warshall);
   loader.RegisterFunction(floyd_warshall);
+
+  TableFunction multi_source("onager_pth_multi_source", {LogicalType::TABLE}, nullptr, MultiSourceBind, MultiSourceInitGlobal);
+  multi_source.in_out_function = CollectInput;
+  multi_source.init_local = MultiSourceInitLocal;
+  multi_source.in_out_function_final = MultiSourceFinal;
+  multi_source.named_parameters["sources"] = LogicalType::LIST(LogicalType::BIGINT);
+  multi_source.named_parameters["graph"] = LogicalType::VARCHAR;
+  ONAGER_SET_NO_ORDER(multi_source);
+  loader.RegisterFunction(multi_source);
+
+  TableFunction bidirectional("onager_pth_bidirectional", {LogicalType::TABLE}, nullptr, PairDistanceBind, PairDistanceInitGlobal);
+  bidirectional.in_out_function = CollectInput;
+  bidirectional.init_local = InitInputLocal<2>;
+  bidirectional.in_out_function_final = PairDistanceFinal;
+  bidirectional.named_parameters["graph"] = LogicalType::VARCHAR;
+  bidirectional.named_parameters["max_depth"] = LogicalType::DOUBLE;
+  ONAGER_SET_NO_ORDER(bidirectional);
+  loader.RegisterFunction(bidirectional);
 }
 
 } // namespace onager
@@ -6,14 +6,30 @@
 
 #include "duckdb.hpp"
 #include "duckdb/common/exception.hpp"
+#include "duckdb/common/file_system.hpp"
 #include "duckdb/common/types/data_chunk.hpp"
 #include "duckdb/common/types/value.hpp"
 #include "duckdb/common/types/vector.hpp"
+#include "duckdb/common/vector_operations/vector_operations.hpp"
 #include "duckdb/function/scalar_function.hpp"
 #include "duckdb/function/table_function.hpp"
+#include "duckdb/main/client_context_state.hpp"
+#include "duckdb/main/config.hpp"
 #include "duckdb/main/extension/extension_loader.hpp"
+#include "duckdb/parallel/task_scheduler.hpp"
+#include "duckdb/planner/expression/bound_columnref_expression.hpp"
+#include "duckdb/planner/expression/bound_comparison_expression.hpp"
+#include "duckdb/planner/expression/bound_constant_expression.hpp"
+#include "duckdb/planner/expression/bound_operator_expression.hpp"
+#include "duckdb/planner/operator/logical_get.hpp"
+#include "duckdb/storage/buffer_manager.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <cstdint>
+#include <cstring>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
 
@@ -80,6 +96,625 @@ inline std::string GetOnagerError() {
   return err ? std::string(err) : std::string("unknown error");
 }
 
+/**
+ * @brief Throws the error of the Onager call that just failed.
+ * @param what The algorithm name for error messages
+ * @throws InterruptException if the call stopped because the query was interrupted
+ * @throws InvalidInputException with the last Onager error otherwise
+ */
+[[noreturn]] inline void ThrowOnagerError(const std::string &what) {
+  if (::onager::onager_last_call_interrupted()) throw InterruptException();
+  throw InvalidInputException(what + " failed: " + GetOnagerError());
+}
+
+// =============================================================================
+// Call Profiles
+// =============================================================================
+// The Rust core keeps the profile of the last Onager call of every connection,
+// which onager_last_profile() reports. A table function opens the profile right
+// before it computes, on the thread that computes, and its result then adds the
+// time spent emitting rows.
+
+using ProfileClock = std::chrono::steady_clock;
+
+/** @brief Returns the nanoseconds elapsed since a time point. */
+inline uint64_t ElapsedNanos(ProfileClock::time_point since) {
+  return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(ProfileClock::now() - since).count());
+}
+
+/**
+ * @brief Per-connection state that names the connection's profiles.
+ *
+ * Every connection gets a key no other connection has had, even one whose
+ * ClientContext reuses a freed address, and its profile is forgotten when the
+ * connection closes and the state is destroyed with its context.
+ */
+class ProfileState : public ClientContextState {
+public:
+  ProfileState() : key(next_key.fetch_add(1)) {}
+  ~ProfileState() override { ::onager::onager_forget_profile(key); }
+
+  const uint64_t key;
+
+private:
+  static inline std::atomic<uint64_t> next_key {1};
+};
+
+/** @brief Returns the key that identifies a connection's profiles. */
+inline uint64_t ProfileConnection(ClientContext &context) {
+  return context.registered_state->GetOrCreate<ProfileState>("onager_profile")->key;
+}
+
+/**
+ * @brief Opens a profile for the next Onager call on this thread.
+ * @param context The client context of the query
+ * @param ingest_ns The time spent collecting the input
+ */
+inline void BeginProfile(ClientContext &context, uint64_t ingest_ns = 0) {
+  ::onager::onager_profile_begin(ProfileConnection(context), ingest_ns);
+}
+
+// =============================================================================
+// Cancellation and Progress
+// =============================================================================
+// Every Onager call a table function makes carries the callbacks of a
+// CallControl kept in the function's global state. Long-running algorithms poll
+// the query's interrupted flag through it between iterations or blocks of
+// sources, so Ctrl-C or interrupt() stops them, and they report the fraction of
+// their work done, which registry graph overloads hand to DuckDB's progress bar.
+// The call also carries its thread budget: onager_threads when it is set above
+// zero, and DuckDB's threads setting otherwise. Rust allocations are invisible
+// to DuckDB's buffer manager, so it also carries the memory left under
+// memory_limit, which the Rust core checks graph builds and other large
+// allocations against before making them. Functions whose weight column is
+// FLOAT also ask for the graphs they build to store 4-byte weights.
+
+/** @brief Cancellation and progress state of the Onager call of one table function. */
+struct CallControl {
+  ClientContext *context = nullptr;
+  /** @brief Fraction of the call's work done, from 0 to 1. */
+  std::atomic<double> progress {0.0};
+  /** @brief Store the edge weights of graphs built during the call as 4-byte floats. */
+  bool float_weights = false;
+};
+
+inline bool CallInterrupted(void *data) {
+  auto context = static_cast<CallControl *>(data)->context;
+  return context && context->interrupted.load(std::memory_order_relaxed);
+}
+
+inline void CallProgress(void *data, double fraction) {
+  static_cast<CallControl *>(data)->progress.store(fraction, std::memory_order_relaxed);
+}
+
+/**
+ * @brief Returns the number of threads an Onager call of the given client may run on.
+ * @param context The client context of the query
+ */
+inline uint64_t GetThreadBudget(ClientContext &context) {
+  Value threads;
+  if (context.TryGetCurrentSetting("onager_threads", threads) && !threads.IsNull()) {
+    auto override_threads = threads.GetValue<int64_t>();
+    if (override_threads > 0) return static_cast<uint64_t>(override_threads);
+  }
+  auto scheduler_threads = TaskScheduler::GetScheduler(context).NumberOfThreads();
+  return scheduler_threads > 0 ? static_cast<uint64_t>(scheduler_threads) : 1;
+}
+
+/**
+ * @brief Returns the memory an Onager call may use beyond what DuckDB's buffer manager tracks.
+ *
+ * This is memory_limit minus the memory DuckDB uses and the input the call
+ * holds outside the buffer manager. The Rust core subtracts its own allocations.
+ * @param context The client context of the query
+ * @param held_bytes The bytes of input the table function has collected
+ */
+inline uint64_t GetMemoryHeadroom(ClientContext &context, idx_t held_bytes) {
+  auto &buffer_manager = BufferManager::GetBufferManager(context);
+  auto limit = buffer_manager.GetMaxMemory();
+  auto used = buffer_manager.GetUsedMemory() + held_bytes;
+  return limit > used ? static_cast<uint64_t>(limit - used) : 0;
+}
+
+/**
+ * @brief Opens a profile and installs the cancellation callbacks, thread budget, and memory limit for the next Onager
+ * call on this thread.
+ * @param context The client context of the query
+ * @param control The control in the global state, which outlives the call
+ * @param ingest_ns The time spent collecting the input
+ * @param held_bytes The bytes of input the table function has collected
+ */
+inline void BeginCall(ClientContext &context, CallControl &control, uint64_t ingest_ns = 0, idx_t held_bytes = 0) {
+  BeginProfile(context, ingest_ns);
+  control.context = &context;
+  ::onager::onager_call_begin(::onager::OnagerCallControl {CallInterrupted, CallProgress, &control,
+                                                           GetThreadBudget(context),
+                                                           GetMemoryHeadroom(context, held_bytes),
+                                                           control.float_weights});
+}
+
+/**
+ * @brief Owning wrapper around a result returned by an Onager compute function.
+ *
+ * Each algorithm runs once and returns its output columns in a Rust-owned result.
+ * The wrapper exposes the row count and column pointers and frees the result
+ * when it is reset or destroyed.
+ */
+class OnagerResultHandle {
+public:
+  OnagerResultHandle() = default;
+  ~OnagerResultHandle() { Reset(); }
+  OnagerResultHandle(const OnagerResultHandle &) = delete;
+  OnagerResultHandle &operator=(const OnagerResultHandle &) = delete;
+
+  /**
+   * @brief Takes ownership of a result.
+   * @param result The pointer returned by the compute function
+   * @param what The algorithm name for error messages
+   * @throws InterruptException if result is null because the query was interrupted
+   * @throws InvalidInputException with the last Onager error if result is null otherwise
+   */
+  void Set(::onager::OnagerResult *result, const std::string &what) {
+    if (!result) ThrowOnagerError(what);
+    Reset();
+    ptr = result;
+    ::onager::onager_result_profile_function(ptr, what.c_str());
+  }
+
+  /** @brief Frees the owned result, if any. */
+  void Reset() {
+    if (ptr) {
+      ::onager::onager_free_result(ptr);
+      ptr = nullptr;
+    }
+  }
+
+  idx_t Size() const { return ::onager::onager_result_len(ptr); }
+  const int64_t *I64(idx_t column) const { return ::onager::onager_result_i64_column(ptr, column); }
+  const double *F64(idx_t column) const { return ::onager::onager_result_f64_column(ptr, column); }
+  double Scalar() const { return ::onager::onager_result_scalar(ptr); }
+
+  /** @brief Adds time spent emitting rows to the profile of the call that returned the result. */
+  void NoteOutput(uint64_t elapsed_ns, idx_t rows) const { ::onager::onager_result_note_output(ptr, elapsed_ns, rows); }
+
+  /** @brief Keeps only the rows whose value in integer column `column` is in the sorted ID list. */
+  void RetainRows(idx_t column, const vector<int64_t> &ids) {
+    ::onager::onager_result_retain_rows(ptr, column, ids.data(), ids.size());
+  }
+
+private:
+  ::onager::OnagerResult *ptr = nullptr;
+};
+
+/**
+ * @brief Copies `count` rows of one result column, starting at `offset`, into an output vector.
+ *
+ * Result columns are contiguous Rust buffers with the same layout as flat
+ * DuckDB vectors, so each chunk is a single bulk copy.
+ */
+inline void CopyResultColumn(const OnagerResultHandle &result, bool is_double, idx_t column, idx_t offset, idx_t count,
+                             Vector &vec) {
+  if (is_double) {
+    auto src = result.F64(column);
+    if (!src) throw InternalException("Onager result is missing a DOUBLE column");
+    memcpy(GetFlatVectorDataWritable<double>(vec), src + offset, count * sizeof(double));
+  } else {
+    auto src = result.I64(column);
+    if (!src) throw InternalException("Onager result is missing a BIGINT column");
+    memcpy(GetFlatVectorDataWritable<int64_t>(vec), src + offset, count * sizeof(int64_t));
+  }
+}
+
+/**
+ * @brief Finishes emitting a chunk and frees the result once its last row has been emitted.
+ *
+ * Freeing early releases the Rust buffers while the rest of the query still
+ * runs, instead of when the global state is destroyed.
+ * @param started When emitting the chunk began, for the call profile
+ */
+inline OperatorFinalizeResultType FinishResultChunk(OnagerResultHandle &result, idx_t &offset, idx_t count,
+                                                    idx_t total, DataChunk &output, ProfileClock::time_point started) {
+  result.NoteOutput(ElapsedNanos(started), count);
+  offset += count;
+  output.SetCardinality(count);
+  if (offset < total) return OperatorFinalizeResultType::HAVE_MORE_OUTPUT;
+  result.Reset();
+  return OperatorFinalizeResultType::FINISHED;
+}
+
+/**
+ * @brief Emits the next chunk of a result into the output chunk.
+ *
+ * DOUBLE output columns are filled from the result's floating-point columns in
+ * order, and all other output columns from its integer columns in order.
+ * @param result The computed result, freed after its last chunk
+ * @param offset The number of rows already emitted, advanced by this call
+ * @param output The output chunk
+ * @return FINISHED once every row has been emitted, HAVE_MORE_OUTPUT otherwise
+ */
+inline OperatorFinalizeResultType EmitResultChunk(OnagerResultHandle &result, idx_t &offset, DataChunk &output) {
+  auto started = ProfileClock::now();
+  idx_t total = result.Size();
+  if (offset >= total) { output.SetCardinality(0); return OperatorFinalizeResultType::FINISHED; }
+  idx_t count = MinValue<idx_t>(total - offset, STANDARD_VECTOR_SIZE);
+  idx_t i64_col = 0, f64_col = 0;
+  for (idx_t c = 0; c < output.ColumnCount(); c++) {
+    auto &vec = output.data[c];
+    bool is_double = vec.GetType().id() == LogicalTypeId::DOUBLE;
+    CopyResultColumn(result, is_double, is_double ? f64_col++ : i64_col++, offset, count, vec);
+  }
+  return FinishResultChunk(result, offset, count, total, output, started);
+}
+
+// =============================================================================
+// Projection and Node Filter Pushdown
+// =============================================================================
+// Functions that opt in with EnablePushdown record their full output schema at
+// bind time. DuckDB then only asks for the columns a query reads, and hands
+// equality and IN filters on node ID columns to the bind data. The filters also
+// stay in the plan above the function, so the recorded node sets only have to
+// contain every row that passes them. Their job is to drop the other rows from
+// the Rust result before anything is copied into DuckDB vectors.
+
+/** @brief Node IDs that pushed-down filters allow in one BIGINT output column. */
+struct NodeFilter {
+  idx_t column = 0;
+  vector<int64_t> ids;
+};
+
+/** @brief Output schema and node filters of a function that supports pushdown. */
+struct PushdownInfo {
+  vector<LogicalType> schema;
+  vector<idx_t> node_columns;
+  vector<NodeFilter> filters;
+};
+
+/**
+ * @brief Bind data base class for functions that have a registry graph overload or support pushdown.
+ */
+struct GraphBindData : public TableFunctionData {
+  std::string graph;
+  PushdownInfo pushdown;
+};
+
+/**
+ * @brief Returns the index of a schema column among the result columns of its kind.
+ *
+ * Results hold DOUBLE columns and all other columns in two separate lists, each
+ * in schema order.
+ */
+inline idx_t ResultColumnIndex(const vector<LogicalType> &schema, idx_t column) {
+  bool is_double = schema[column].id() == LogicalTypeId::DOUBLE;
+  idx_t index = 0;
+  for (idx_t c = 0; c < column; c++) {
+    if ((schema[c].id() == LogicalTypeId::DOUBLE) == is_double) index++;
+  }
+  return index;
+}
+
+/**
+ * @brief Maps the columns DuckDB requested from a function to the columns of its full result.
+ *
+ * A layout without a schema is inactive, and chunks are then emitted with every
+ * output column in schema order.
+ */
+class OutputLayout {
+public:
+  /**
+   * @brief Records the requested columns.
+   * @param column_ids The column IDs of the table function init input
+   * @param schema The full output schema, or empty if the function does not support projection pushdown
+   */
+  void Init(const vector<column_t> &column_ids, const vector<LogicalType> &schema) {
+    columns.clear();
+    active = !schema.empty();
+    if (!active) return;
+    for (auto id : column_ids) {
+      Source source;
+      if (id < schema.size()) {
+        source.present = true;
+        source.is_double = schema[id].id() == LogicalTypeId::DOUBLE;
+        source.column = ResultColumnIndex(schema, id);
+      }
+      columns.push_back(source);
+    }
+  }
+
+  /**
+   * @brief Emits the next chunk of a result with only the requested columns.
+   *
+   * Requested columns outside the schema, such as the row ID DuckDB asks for
+   * when a query reads no column, are emitted as NULL constants.
+   * @see EmitResultChunk
+   */
+  OperatorFinalizeResultType Emit(OnagerResultHandle &result, idx_t &offset, DataChunk &output) const {
+    if (!active) return EmitResultChunk(result, offset, output);
+    auto started = ProfileClock::now();
+    idx_t total = result.Size();
+    if (offset >= total) { output.SetCardinality(0); return OperatorFinalizeResultType::FINISHED; }
+    idx_t count = MinValue<idx_t>(total - offset, STANDARD_VECTOR_SIZE);
+    for (idx_t c = 0; c < output.ColumnCount(); c++) {
+      auto &vec = output.data[c];
+      if (c >= columns.size() || !columns[c].present) {
+        vec.Reference(Value(vec.GetType()));
+        continue;
+      }
+      CopyResultColumn(result, columns[c].is_double, columns[c].column, offset, count, vec);
+    }
+    return FinishResultChunk(result, offset, count, total, output, started);
+  }
+
+private:
+  struct Source {
+    bool present = false;
+    bool is_double = false;
+    idx_t column = 0;
+  };
+
+  bool active = false;
+  vector<Source> columns;
+};
+
+/**
+ * @brief Records the output schema and node ID columns of a function that supports pushdown.
+ * @param info The pushdown info in the bind data
+ * @param schema The output types returned by the bind function
+ * @param node_columns The BIGINT output columns that hold node IDs
+ */
+inline void SetPushdownSchema(PushdownInfo &info, const vector<LogicalType> &schema, vector<idx_t> node_columns) {
+  info.schema = schema;
+  info.node_columns = std::move(node_columns);
+}
+
+/** @brief Returns the output column of a column reference to a node ID column of the function, if it is one. */
+inline bool MatchNodeColumn(const LogicalGet &get, const PushdownInfo &info, const Expression &expr, idx_t &column) {
+  if (expr.GetExpressionClass() != ExpressionClass::BOUND_COLUMN_REF) return false;
+  auto &binding = expr.Cast<BoundColumnRefExpression>().binding;
+  auto &column_ids = get.GetColumnIds();
+  if (binding.table_index != get.table_index || binding.column_index >= column_ids.size()) return false;
+  column = column_ids[binding.column_index].GetPrimaryIndex();
+  return std::find(info.node_columns.begin(), info.node_columns.end(), column) != info.node_columns.end();
+}
+
+/** @brief Appends the value of a non-NULL BIGINT constant to the ID list, if the expression is one. */
+inline bool MatchNodeConstant(const Expression &expr, vector<int64_t> &ids) {
+  if (expr.GetExpressionClass() != ExpressionClass::BOUND_CONSTANT) return false;
+  auto &value = expr.Cast<BoundConstantExpression>().value;
+  if (value.IsNull() || value.type().id() != LogicalTypeId::BIGINT) return false;
+  ids.push_back(value.GetValue<int64_t>());
+  return true;
+}
+
+/**
+ * @brief Matches `node_column = constant` and `node_column IN (constants)` filters.
+ * @param column Receives the filtered output column
+ * @param ids Receives the allowed node IDs
+ */
+inline bool MatchNodeFilter(const LogicalGet &get, const PushdownInfo &info, const Expression &expr, idx_t &column,
+                            vector<int64_t> &ids) {
+  if (expr.GetExpressionClass() == ExpressionClass::BOUND_COMPARISON &&
+      expr.GetExpressionType() == ExpressionType::COMPARE_EQUAL) {
+    auto &comparison = expr.Cast<BoundComparisonExpression>();
+    return (MatchNodeColumn(get, info, *comparison.left, column) && MatchNodeConstant(*comparison.right, ids)) ||
+           (MatchNodeColumn(get, info, *comparison.right, column) && MatchNodeConstant(*comparison.left, ids));
+  }
+  if (expr.GetExpressionClass() == ExpressionClass::BOUND_OPERATOR &&
+      expr.GetExpressionType() == ExpressionType::COMPARE_IN) {
+    auto &children = expr.Cast<BoundOperatorExpression>().children;
+    if (children.size() < 2 || !MatchNodeColumn(get, info, *children[0], column)) return false;
+    for (idx_t i = 1; i < children.size(); i++) {
+      if (!MatchNodeConstant(*children[i], ids)) return false;
+    }
+    return true;
+  }
+  return false;
+}
+
+/**
+ * @brief Complex filter pushdown callback that records node ID filters in PushdownInfo.
+ *
+ * Filters on the same column more than once keep the intersection of their IDs.
+ * Every filter stays in the list, so DuckDB still applies it above the function.
+ */
+inline void PushdownNodeFilters(ClientContext &context, LogicalGet &get, FunctionData *bind_data,
+                                vector<unique_ptr<Expression>> &filters) {
+  auto &info = bind_data->Cast<GraphBindData>().pushdown;
+  for (auto &filter : filters) {
+    idx_t column;
+    vector<int64_t> ids;
+    if (!MatchNodeFilter(get, info, *filter, column, ids)) continue;
+    std::sort(ids.begin(), ids.end());
+    ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+    auto existing = std::find_if(info.filters.begin(), info.filters.end(),
+                                 [&](const NodeFilter &f) { return f.column == column; });
+    if (existing == info.filters.end()) {
+      info.filters.push_back(NodeFilter {column, std::move(ids)});
+      continue;
+    }
+    vector<int64_t> both;
+    std::set_intersection(existing->ids.begin(), existing->ids.end(), ids.begin(), ids.end(), std::back_inserter(both));
+    existing->ids = std::move(both);
+  }
+}
+
+/** @brief Drops the result rows that the recorded node filters exclude. */
+inline void ApplyNodeFilters(OnagerResultHandle &result, const PushdownInfo &info) {
+  for (auto &filter : info.filters) result.RetainRows(ResultColumnIndex(info.schema, filter.column), filter.ids);
+}
+
+/**
+ * @brief Opts a table function into projection and node filter pushdown.
+ *
+ * The bind function must call SetPushdownSchema, the global state must call
+ * OutputLayout::Init with the init input column IDs, and the computed result
+ * must go through ApplyNodeFilters and OutputLayout::Emit.
+ * @param fn A table function whose bind data derives from GraphBindData
+ */
+inline void EnablePushdown(TableFunction &fn) {
+  fn.projection_pushdown = true;
+  fn.pushdown_complex_filter = PushdownNodeFilters;
+}
+
+/**
+ * @brief Row-aligned input columns collected from a table function's input table.
+ *
+ * The leading input columns are stored as BIGINT columns and the ones after
+ * them as DOUBLE columns, widening FLOAT input columns and casting other
+ * numeric ones. Flat vectors are appended with a bulk copy.
+ */
+class InputBuffer {
+public:
+  void Init(idx_t i64_columns, idx_t f64_columns) {
+    i64.resize(i64_columns);
+    f64.resize(f64_columns);
+  }
+
+  /** @brief Appends the configured columns of an input chunk. */
+  void Append(DataChunk &input) {
+    idx_t count = input.size();
+    if (count == 0) return;
+    for (idx_t c = 0; c < i64.size(); c++) AppendColumn<int64_t>(input.data[c], count, i64[c]);
+    for (idx_t c = 0; c < f64.size(); c++) {
+      auto &vec = input.data[i64.size() + c];
+      if (vec.GetType().id() == LogicalTypeId::FLOAT) {
+        AppendColumn<float>(vec, count, f64[c]);
+      } else if (vec.GetType().id() == LogicalTypeId::DOUBLE) {
+        AppendColumn<double>(vec, count, f64[c]);
+      } else {
+        Vector cast(LogicalType::DOUBLE, count);
+        VectorOperations::DefaultCast(vec, cast, count);
+        AppendColumn<double>(cast, count, f64[c]);
+      }
+    }
+    rows += count;
+  }
+
+  /** @brief Moves the rows of another buffer with the same layout into this one. */
+  void Merge(InputBuffer &other) {
+    if (rows == 0) {
+      i64 = std::move(other.i64);
+      f64 = std::move(other.f64);
+    } else {
+      for (idx_t c = 0; c < i64.size(); c++) i64[c].insert(i64[c].end(), other.i64[c].begin(), other.i64[c].end());
+      for (idx_t c = 0; c < f64.size(); c++) f64[c].insert(f64[c].end(), other.f64[c].begin(), other.f64[c].end());
+    }
+    rows += other.rows;
+    other.i64.clear();
+    other.f64.clear();
+    other.rows = 0;
+  }
+
+  idx_t Size() const { return rows; }
+  /** @brief Returns the bytes the buffered columns hold. */
+  idx_t Bytes() const { return rows * (i64.size() * sizeof(int64_t) + f64.size() * sizeof(double)); }
+  const int64_t *I64(idx_t column) const { return i64[column].data(); }
+  const double *F64(idx_t column) const { return f64[column].data(); }
+
+private:
+  template <typename SOURCE, typename T>
+  static void AppendColumn(Vector &vec, idx_t count, std::vector<T> &out) {
+    idx_t offset = out.size();
+    out.resize(offset + count);
+    if (vec.GetVectorType() == VectorType::FLAT_VECTOR) {
+      auto values = FlatVector::GetData<SOURCE>(vec);
+      std::copy(values, values + count, out.begin() + offset);
+      return;
+    }
+    UnifiedVectorFormat format;
+    vec.ToUnifiedFormat(count, format);
+    auto values = reinterpret_cast<const SOURCE *>(format.data);
+    for (idx_t i = 0; i < count; i++) out[offset + i] = values[format.sel->get_index(i)];
+  }
+
+  std::vector<std::vector<int64_t>> i64;
+  std::vector<std::vector<double>> f64;
+  idx_t rows = 0;
+};
+
+/**
+ * @brief Global state for table functions that collect their whole input before computing.
+ *
+ * Each DuckDB worker appends to its own InputLocalState. When a worker's input is
+ * exhausted its buffer is merged here, and the last worker to finish computes and
+ * emits the result.
+ */
+struct InputGlobalState : public GlobalTableFunctionState {
+  ProfileClock::time_point started = ProfileClock::now();
+  CallControl control;
+  std::mutex input_mutex;
+  InputBuffer input;
+  idx_t active_locals = 0;
+  bool input_complete = false;
+  idx_t MaxThreads() const override { return GlobalTableFunctionState::MAX_THREADS; }
+};
+
+/** @brief Per-worker input buffer for table functions using InputGlobalState. */
+struct InputLocalState : public LocalTableFunctionState {
+  InputBuffer input;
+  bool merged = false;
+  bool owns_output = false;
+};
+
+/**
+ * @brief Creates a worker's input state with the given column layout and registers it with the global state.
+ * @param float_weights Whether graphs the call builds store 4-byte weights, see CallControl
+ */
+inline unique_ptr<LocalTableFunctionState> MakeInputLocal(GlobalTableFunctionState *global_state, idx_t i64_columns,
+                                                          idx_t f64_columns, bool float_weights = false) {
+  auto &gs = global_state->Cast<InputGlobalState>();
+  auto ls = make_uniq<InputLocalState>();
+  ls->input.Init(i64_columns, f64_columns);
+  std::lock_guard<std::mutex> lock(gs.input_mutex);
+  gs.active_locals++;
+  gs.control.float_weights = float_weights;
+  return std::move(ls);
+}
+
+/**
+ * @brief Local state initializer reading I64_COLUMNS BIGINT columns followed by F64_COLUMNS DOUBLE columns.
+ */
+template <idx_t I64_COLUMNS, idx_t F64_COLUMNS = 0>
+unique_ptr<LocalTableFunctionState> InitInputLocal(ExecutionContext &context, TableFunctionInitInput &input,
+                                                   GlobalTableFunctionState *global_state) {
+  return MakeInputLocal(global_state, I64_COLUMNS, F64_COLUMNS);
+}
+
+/** @brief In-out callback that appends each input chunk to the worker's local buffer. */
+inline OperatorResultType CollectInput(ExecutionContext &context, TableFunctionInput &data, DataChunk &input,
+                                       DataChunk &output) {
+  data.local_state->Cast<InputLocalState>().input.Append(input);
+  output.SetCardinality(0);
+  return OperatorResultType::NEED_MORE_INPUT;
+}
+
+/**
+ * @brief Merges the worker's input into the global buffer once its input is exhausted.
+ *
+ * The worker that finishes last opens the call profile, with the time since the
+ * global state was created as the ingestion time, and installs the cancellation
+ * callbacks, thread budget, and memory limit of the Onager call it is about to
+ * make. Without input rows it only does so when computes_without_input is set,
+ * since most functions then return no rows without calling into Rust.
+ * @param computes_without_input Whether the function calls into Rust even when its input is empty, as functions on a
+ * registry graph do
+ * @return true if this worker finished last and must compute and emit the result
+ */
+inline bool FinishInput(ExecutionContext &context, TableFunctionInput &data, bool computes_without_input = false) {
+  auto &ls = data.local_state->Cast<InputLocalState>();
+  if (!ls.merged) {
+    auto &gs = data.global_state->Cast<InputGlobalState>();
+    std::lock_guard<std::mutex> lock(gs.input_mutex);
+    gs.input.Merge(ls.input);
+    ls.merged = true;
+    if (--gs.active_locals == 0 && !gs.input_complete) {
+      gs.input_complete = true;
+      ls.owns_output = true;
+      if (gs.input.Size() > 0 || computes_without_input) BeginCall(context.client, gs.control, ElapsedNanos(gs.started), gs.input.Bytes());
+    }
+  }
+  return ls.owns_output;
+}
+
 /**
  * @brief Validates that input table has BIGINT columns for (src, dst).
  * @param input The table function bind input
@@ -96,8 +731,146 @@ inline void CheckInt64Input(TableFunctionBindInput &input, const std::string &na
   }
 }
 
+/**
+ * @brief Optional edge weight column after (src, dst) in a table function's input.
+ *
+ * The weight column follows the BIGINT columns, which are (src, dst) unless
+ * Bind is given another position.
+ *
+ * Any numeric column is a weight column and is buffered as DOUBLE. A FLOAT
+ * column also has the graph built from it store its weights in 4 bytes each,
+ * which loses nothing since the input had no more precision. A column of any
+ * other type is not a weight, and the graph is unweighted.
+ */
+struct WeightColumn {
+  bool present = false;
+  bool is_float = false;
+  idx_t column = 2;
+
+  /**
+   * @brief Reads the type of the weight input column, if there is one.
+   * @param input The table function bind input
+   * @param position Index of the weight column, after that many BIGINT columns
+   */
+  void Bind(TableFunctionBindInput &input, idx_t position = 2) {
+    column = position;
+    if (input.input_table_types.size() <= column) return;
+    auto &type = input.input_table_types[column];
+    if (!type.IsNumeric()) return;
+    present = true;
+    is_float = type == LogicalType::FLOAT;
+  }
+
+  /** @brief Creates a worker's input state for the BIGINT columns and the weight column if present. */
+  unique_ptr<LocalTableFunctionState> MakeLocal(GlobalTableFunctionState *global_state) const {
+    return MakeInputLocal(global_state, column, present ? 1 : 0, is_float);
+  }
+
+  /** @brief Returns the buffered weights, or nullptr without a weight column. */
+  const double *Data(const InputBuffer &input) const { return present ? input.F64(0) : nullptr; }
+  /** @brief Returns the number of buffered weights. */
+  idx_t Size(const InputBuffer &input) const { return present ? input.Size() : 0; }
+};
+
+/**
+ * @brief Returns DuckDB's memory_limit in bytes for the given client.
+ * @param context The client context
+ */
+inline idx_t GetMemoryLimit(ClientContext &context) {
+  return BufferManager::GetBufferManager(context).GetMaxMemory();
+}
+
+// =============================================================================
+// Registry Graph Overloads
+// =============================================================================
+// Algorithms that accept a table input can also run on a named graph from the
+// graph registry, e.g. onager_ctr_pagerank(graph := 'g'). The overload takes no
+// positional arguments, shares the bind function and named parameters of the
+// table version, and reuses the graph's cached CSR form on the Rust side.
+
+/**
+ * @brief Reads the `graph` named parameter of a registry graph overload.
+ * @param input The table function bind input
+ * @param graph Receives the graph name
+ * @return true if the call names a registry graph, false if it takes a table input
+ * @throws InvalidInputException if the graph name is NULL
+ */
+inline bool BindGraphName(TableFunctionBindInput &input, std::string &graph) {
+  auto entry = input.named_parameters.find("graph");
+  if (entry == input.named_parameters.end()) return false;
+  if (entry->second.IsNull()) throw InvalidInputException("graph name must not be NULL");
+  graph = entry->second.GetValue<std::string>();
+  return true;
+}
+
+/** @brief Global state for registry graph overloads. */
+struct GraphScanState : public GlobalTableFunctionState {
+  OnagerResultHandle result;
+  OutputLayout layout;
+  CallControl control;
+  idx_t output_idx = 0;
+  bool computed = false;
+};
+
+/** @brief Progress callback of registry graph overloads, in percent of the computation done. */
+inline double GraphScanProgress(ClientContext &context, const FunctionData *bind_data,
+                                const GlobalTableFunctionState *global_state) {
+  return 100.0 * global_state->Cast<GraphScanState>().control.progress.load(std::memory_order_relaxed);
+}
+
+inline unique_ptr<GlobalTableFunctionState> GraphScanInitGlobal(ClientContext &context, TableFunctionInitInput &input) {
+  auto gs = make_uniq<GraphScanState>();
+  gs->layout.Init(input.column_ids, input.bind_data->Cast<GraphBindData>().pushdown.schema);
+  return std::move(gs);
+}
+
+/**
+ * @brief Computes a registry graph result on the first call and emits it chunk by chunk.
+ * @param context The client context, for the call profile
+ * @param data The table function input
+ * @param output The output chunk
+ * @param what The algorithm name for error messages
+ * @param compute Callable taking the graph name and returning the result of an onager_graph_compute_* function
+ */
+template <typename F>
+inline void EmitGraphResult(ClientContext &context, TableFunctionInput &data, DataChunk &output, const std::string &what,
+                            F &&compute) {
+  auto &bind = data.bind_data->Cast<GraphBindData>();
+  auto &gs = data.global_state->Cast<GraphScanState>();
+  if (!gs.computed) {
+    BeginCall(context, gs.control);
+    gs.result.Set(compute(bind.graph.c_str()), what);
+    ApplyNodeFilters(gs.result, bind.pushdown);
+    gs.control.progress.store(1.0, std::memory_order_relaxed);
+    gs.computed = true;
+  }
+  gs.layout.Emit(gs.result, gs.output_idx, output);
+}
+
+/**
+ * @brief Registers a table-input function together with its registry graph overload.
+ * @param loader The extension loader
+ * @param table_fn The table-input function, whose bind data derives from GraphBindData
+ * @param scan The scan function of the registry graph overload
+ */
+inline void RegisterWithGraphOverload(ExtensionLoader &loader, const TableFunction &table_fn, table_function_t scan) {
+  TableFunction graph_fn(table_fn.name, {}, scan, table_fn.bind, GraphScanInitGlobal);
+  graph_fn.named_parameters = table_fn.named_parameters;
+  graph_fn.named_parameters["graph"] = LogicalType::VARCHAR;
+  graph_fn.projection_pushdown = table_fn.projection_pushdown;
+  graph_fn.pushdown_complex_filter = table_fn.pushdown_complex_filter;
+  graph_fn.table_scan_progress = GraphScanProgress;
+  TableFunctionSet set(table_fn.name);
+  set.AddFunction(table_fn);
+  set.AddFunction(graph_fn);
+  loader.RegisterFunction(set);
+}
+
 // Forward declarations for modular function registration
 void RegisterScalarFunctions(ExtensionLoader &loader);
+void RegisterRegistryFunctions(ExtensionLoader &loader);
+void RegisterProfileFunctions(ExtensionLoader &loader);
+void RegisterSettings(ExtensionLoader &loader);
 void RegisterCentralityFunctions(ExtensionLoader &loader);
 void RegisterAllCentralityFunctions(ExtensionLoader &loader);
 void RegisterCommunityFunctions(ExtensionLoader &loader);
@@ -18,6 +18,114 @@
 namespace onager {
 #endif  // __cplusplus
 
+/**
+ * Column-oriented algorithm result owned by Rust.
+ *
+ * Algorithms run once and hand their output to C++ through an opaque pointer.
+ * C++ reads the row count and column pointers, then releases the result with
+ * `onager_free_result`.
+ */
+typedef struct OnagerResult OnagerResult;
+
+/**
+ * Resumable cursor over the edges of one generator partition.
+ */
+typedef struct OnagerEdgeCursor OnagerEdgeCursor;
+
+/**
+ * Streaming edge generator owned by Rust.
+ *
+ * C++ opens one cursor per partition, pulls edges in chunks with
+ * `onager_edge_cursor_next`, and releases both with their free functions.
+ */
+typedef struct OnagerEdgeGenerator OnagerEdgeGenerator;
+
+/**
+ * All-pairs distance matrix owned by Rust.
+ *
+ * C++ pulls reachable pairs in chunks with `onager_distance_matrix_next` and
+ * releases the matrix with `onager_free_distance_matrix`.
+ */
+typedef struct OnagerDistanceMatrix OnagerDistanceMatrix;
+
+/**
+ * Stream of `(source, node, distance)` rows owned by Rust.
+ *
+ * C++ pulls rows in chunks with `onager_distance_stream_next` and releases the
+ * stream with `onager_free_distance_stream`, which also stops its workers.
+ */
+typedef struct OnagerDistanceStream OnagerDistanceStream;
+
+/**
+ * Stream of neighborhood rows owned by Rust.
+ *
+ * Rows are `(center, node, hop)` or `(center, src, dst)`, depending on how the
+ * search was started. C++ pulls rows in chunks with `onager_neighborhood_stream_next`
+ * and releases the stream with `onager_free_neighborhood_stream`, which also stops
+ * its workers.
+ */
+typedef struct OnagerNeighborhoodStream OnagerNeighborhoodStream;
+
+/**
+ * Counters and size of the graph build cache.
+ */
+typedef struct GraphCacheStats {
+  uint64_t capacity;
+  uint64_t entries;
+  uint64_t hits;
+  uint64_t misses;
+  uint64_t bytes;
+} GraphCacheStats;
+
+/**
+ * Callbacks and thread budget C++ passes for one FFI call.
+ *
+ * `interrupted` and `progress` may be called from several threads at once, and
+ * `data` must stay valid until the call returns. Either callback may be null.
+ * `threads` is the number of threads the call may run on, or 0 for one per core.
+ * `memory_limit` is the number of bytes Rust code in the process may hold while
+ * the call runs, or `u64::MAX` for no limit. `float_weights` asks for the edge
+ * weights of graphs built during the call to be stored in 4 bytes each.
+ */
+typedef struct OnagerCallControl {
+  bool (*interrupted)(void *data);
+  void (*progress)(void *data, double fraction);
+  void *data;
+  uint64_t threads;
+  uint64_t memory_limit;
+  bool float_weights;
+} OnagerCallControl;
+
+/**
+ * Node IDs that query filters allow in one output column of a link score.
+ *
+ * An inactive filter allows every node, and `ids` may then be null. An active
+ * filter with no IDs allows none.
+ */
+typedef struct OnagerNodeFilter {
+  bool active;
+  const int64_t *ids;
+  uintptr_t len;
+} OnagerNodeFilter;
+
+/**
+ * Phase timings and sizes of one profiled call.
+ *
+ * Times are in nanoseconds. `iterations` is -1 for algorithms that do not iterate.
+ */
+typedef struct OnagerProfile {
+  uint64_t ingest_ns;
+  uint64_t build_ns;
+  uint64_t compute_ns;
+  uint64_t output_ns;
+  uint64_t nodes;
+  uint64_t edges;
+  int64_t iterations;
+  uint64_t threads;
+  uint64_t peak_bytes;
+  uint64_t rows;
+} OnagerProfile;
+
 #ifdef __cplusplus
 extern "C" {
 #endif // __cplusplus
@@ -26,80 +134,73 @@ extern "C" {
  * Compute Maximum Clique Approximation.
  */
 
-int64_t onager_compute_max_clique(const int64_t *src_ptr,
-                                  const int64_t *dst_ptr,
-                                  uintptr_t edge_count,
-                                  int64_t *out_nodes);
+OnagerResult *onager_compute_max_clique(const int64_t *src_ptr,
+                                        const int64_t *dst_ptr,
+                                        uintptr_t edge_count);
 
 /**
  * Compute Maximum Independent Set Approximation.
  */
 
-int64_t onager_compute_independent_set(const int64_t *src_ptr,
-                                       const int64_t *dst_ptr,
-                                       uintptr_t edge_count,
-                                       int64_t *out_nodes);
+OnagerResult *onager_compute_independent_set(const int64_t *src_ptr,
+                                             const int64_t *dst_ptr,
+                                             uintptr_t edge_count);
 
 /**
  * Compute Minimum Vertex Cover Approximation.
  */
 
-int64_t onager_compute_vertex_cover(const int64_t *src_ptr,
-                                    const int64_t *dst_ptr,
-                                    uintptr_t edge_count,
-                                    int64_t *out_nodes);
+OnagerResult *onager_compute_vertex_cover(const int64_t *src_ptr,
+                                          const int64_t *dst_ptr,
+                                          uintptr_t edge_count);
 
 /**
  * Compute TSP Approximation.
- * Returns tour length and writes tour nodes to out_tour and cost to out_cost.
+ * Returns the tour as a result with the tour cost attached as its scalar.
  */
 
-int64_t onager_compute_tsp(const int64_t *src_ptr,
-                           const int64_t *dst_ptr,
-                           const double *weight_ptr,
-                           uintptr_t edge_count,
-                           int64_t *out_tour,
-                           double *out_cost);
+OnagerResult *onager_compute_tsp(const int64_t *src_ptr,
+                                 const int64_t *dst_ptr,
+                                 const double *weight_ptr,
+                                 uintptr_t edge_count);
 
 /**
  * Compute PageRank on edge arrays.
+ * `weights_ptr` may be null for an unweighted graph.
  */
 
-int64_t onager_compute_pagerank(const int64_t *src_ptr,
-                                const int64_t *dst_ptr,
-                                uintptr_t edge_count,
-                                double damping,
-                                uintptr_t iterations,
-                                bool directed,
-                                int64_t *out_nodes,
-                                double *out_ranks);
+OnagerResult *onager_compute_pagerank(const int64_t *src_ptr,
+                                      const int64_t *dst_ptr,
+                                      uintptr_t edge_count,
+                                      const double *weights_ptr,
+                                      uintptr_t weights_count,
+                                      double damping,
+                                      uintptr_t iterations,
+                                      double tolerance,
+                                      bool directed);
 
 /**
  * Compute PageRank using parallel algorithm.
  */
 
-int64_t onager_compute_pagerank_parallel(const int64_t *src_ptr,
-                                         const int64_t *dst_ptr,
-                                         uintptr_t edge_count,
-                                         const double *weights_ptr,
-                                         uintptr_t weights_count,
-                                         double damping,
-                                         uintptr_t iterations,
-                                         bool directed,
-                                         int64_t *out_node_ids,
-                                         double *out_ranks);
+OnagerResult *onager_compute_pagerank_parallel(const int64_t *src_ptr,
+                                               const int64_t *dst_ptr,
+                                               uintptr_t edge_count,
+                                               const double *weights_ptr,
+                                               uintptr_t weights_count,
+                                               double damping,
+                                               uintptr_t iterations,
+                                               double tolerance,
+                                               bool directed);
 
 /**
  * Compute degree centrality on edge arrays.
  */
 
-int64_t onager_compute_degree(const int64_t *src_ptr,
-                              const int64_t *dst_ptr,
-                              uintptr_t edge_count,
-                              bool directed,
-                              int64_t *out_nodes,
-                              double *out_in_degree,
-                              double *out_out_degree);
+OnagerResult *onager_compute_degree(const int64_t *src_ptr,
+                                    const int64_t *dst_ptr,
+                                    uintptr_t edge_count,
+                                    bool directed);
 
 /**
  * Compute in-degree of a single node (scalar).
@@ -121,90 +222,84 @@ int64_t onager_compute_node_out_degree(const int64_t *src_ptr,
 
 /**
  * Compute betweenness centrality on edge arrays.
+ * A nonzero samples count uses that many random pivot sources chosen with seed,
+ * and `weights_ptr` may be null for an unweighted graph.
  */
 
-int64_t onager_compute_betweenness(const int64_t *src_ptr,
-                                   const int64_t *dst_ptr,
-                                   uintptr_t edge_count,
-                                   bool normalized,
-                                   int64_t *out_nodes,
-                                   double *out_centralities);
+OnagerResult *onager_compute_betweenness(const int64_t *src_ptr,
+                                         const int64_t *dst_ptr,
+                                         uintptr_t edge_count,
+                                         const double *weights_ptr,
+                                         uintptr_t weights_count,
+                                         bool normalized,
+                                         uintptr_t samples,
+                                         uint64_t seed);
 
 /**
  * Compute closeness centrality.
+ * `weights_ptr` may be null for an unweighted graph.
  */
 
-int64_t onager_compute_closeness(const int64_t *src_ptr,
-                                 const int64_t *dst_ptr,
-                                 uintptr_t edge_count,
-                                 int64_t *out_nodes,
-                                 double *out_centralities);
+OnagerResult *onager_compute_closeness(const int64_t *src_ptr,
+                                       const int64_t *dst_ptr,
+                                       uintptr_t edge_count,
+                                       const double *weights_ptr,
+                                       uintptr_t weights_count);
 
 /**
  * Compute eigenvector centrality.
  */
 
-int64_t onager_compute_eigenvector(const int64_t *src_ptr,
-                                   const int64_t *dst_ptr,
-                                   uintptr_t edge_count,
-                                   uintptr_t max_iter,
-                                   double tolerance,
-                                   int64_t *out_nodes,
-                                   double *out_centralities);
+OnagerResult *onager_compute_eigenvector(const int64_t *src_ptr,
+                                         const int64_t *dst_ptr,
+                                         uintptr_t edge_count,
+                                         uintptr_t max_iter,
+                                         double tolerance);
 
 /**
  * Compute Katz centrality.
  */
 
-int64_t onager_compute_katz(const int64_t *src_ptr,
-                            const int64_t *dst_ptr,
-                            uintptr_t edge_count,
-                            double alpha,
-                            uintptr_t max_iter,
-                            double tolerance,
-                            int64_t *out_nodes,
-                            double *out_centralities);
+OnagerResult *onager_compute_katz(const int64_t *src_ptr,
+                                  const int64_t *dst_ptr,
+                                  uintptr_t edge_count,
+                                  double alpha,
+                                  uintptr_t max_iter,
+                                  double tolerance);
 
 /**
  * Compute harmonic centrality.
  */
 
-int64_t onager_compute_harmonic(const int64_t *src_ptr,
-                                const int64_t *dst_ptr,
-                                uintptr_t edge_count,
-                                int64_t *out_nodes,
-                                double *out_centralities);
+OnagerResult *onager_compute_harmonic(const int64_t *src_ptr,
+                                      const int64_t *dst_ptr,
+                                      uintptr_t edge_count);
 
 /**
  * Compute VoteRank for influential spreaders.
  */
 
-int64_t onager_compute_voterank(const int64_t *src_ptr,
-                                const int64_t *dst_ptr,
-                                uintptr_t edge_count,
-                                uintptr_t num_seeds,
-                                int64_t *out_nodes);
+OnagerResult *onager_compute_voterank(const int64_t *src_ptr,
+                                      const int64_t *dst_ptr,
+                                      uintptr_t edge_count,
+                                      uintptr_t num_seeds);
 
 /**
  * Compute Local Reaching Centrality.
  */
 
-int64_t onager_compute_local_reaching(const int64_t *src_ptr,
-                                      const int64_t *dst_ptr,
-                                      uintptr_t edge_count,
-                                      uintptr_t distance,
-                                      int64_t *out_nodes,
-                                      double *out_centralities);
+OnagerResult *onager_compute_local_reaching(const int64_t *src_ptr,
+                                            const int64_t *dst_ptr,
+                                            uintptr_t edge_count,
+                                            uintptr_t distance);
 
 /**
  * Compute Laplacian Centrality.
  */
 
-int64_t onager_compute_laplacian(const int64_t *src_ptr,
-                                 const int64_t *dst_ptr,
-                                 uintptr_t edge_count,
-                                 int64_t *out_nodes,
-                                 double *out_centralities);
+OnagerResult *onager_compute_laplacian(const int64_t *src_ptr,
+                                       const int64_t *dst_ptr,
+                                       uintptr_t edge_count);
 
 /**
  * Returns the last error message, or null if no error is set.
@@ -225,6 +320,129 @@ int64_t onager_compute_laplacian(const int64_t *src_ptr,
  */
  char *onager_get_version(void);
 
+/**
+ * Returns the number of rows in a result, or 0 for a null result.
+ * # Safety
+ * The pointer must be null or have been returned by an Onager compute function.
+ */
+ uintptr_t onager_result_len(const OnagerResult *result);
+
+/**
+ * Returns a pointer to an integer column of a result, or null if the column does not exist.
+ * The pointer stays valid until the result is freed.
+ * # Safety
+ * The pointer must be null or have been returned by an Onager compute function.
+ */
+ const int64_t *onager_result_i64_column(const OnagerResult *result, uintptr_t column);
+
+/**
+ * Returns a pointer to a floating-point column of a result, or null if the column does not exist.
+ * The pointer stays valid until the result is freed.
+ * # Safety
+ * The pointer must be null or have been returned by an Onager compute function.
+ */
+ const double *onager_result_f64_column(const OnagerResult *result, uintptr_t column);
+
+/**
+ * Returns the scalar value attached to a result, or NaN if there is none.
+ * # Safety
+ * The pointer must be null or have been returned by an Onager compute function.
+ */
+ double onager_result_scalar(const OnagerResult *result);
+
+/**
+ * Keeps only the rows of a result whose value in integer column `column` is one of the given IDs.
+ *
+ * Table functions use this to drop the rows that a pushed-down node filter
+ * would discard before they are copied into DuckDB vectors. Column pointers
+ * read before this call are no longer valid.
+ * # Safety
+ * The result pointer must be null or have been returned by an Onager compute function,
+ * and `ids_ptr` must point to `ids_count` IDs sorted in ascending order.
+ */
+ void onager_result_retain_rows(OnagerResult *result,
+                                uintptr_t column,
+                                const int64_t *ids_ptr,
+                                uintptr_t ids_count);
+
+/**
+ * Names the function in the profile of the call that returned a result.
+ * # Safety
+ * The result pointer must be null or have been returned by an Onager compute function,
+ * and `function` must be null or a valid null-terminated C string.
+ */
+ void onager_result_profile_function(const OnagerResult *result, const char *function);
+
+/**
+ * Adds time spent emitting rows of a result to the profile of the call that returned it.
+ * # Safety
+ * The result pointer must be null or have been returned by an Onager compute function.
+ */
+ void onager_result_note_output(const OnagerResult *result, uint64_t elapsed_ns, uint64_t rows);
+
+/**
+ * Opens a profile for the next Onager call on this thread.
+ *
+ * `connection` identifies the DuckDB connection the profile belongs to, and
+ * `ingest_ns` is the time spent collecting the call's input.
+ */
+ void onager_profile_begin(uint64_t connection, uint64_t ingest_ns);
+
+/**
+ * Installs the cancellation and progress callbacks of the next Onager call on this thread.
+ *
+ * The callbacks must stay valid until that call returns, and may be called
+ * from worker threads while it runs.
+ */
+ void onager_call_begin(OnagerCallControl callbacks);
+
+/**
+ * Returns whether the last Onager call on this thread stopped because its query was interrupted.
+ */
+ bool onager_last_call_interrupted(void);
+
+/**
+ * Copies the last profile of a connection into `out`.
+ *
+ * Returns false, leaving `out` untouched, if the connection has no profile.
+ * # Safety
+ * `out` must be null or point to a writable OnagerProfile.
+ */
+ bool onager_last_profile(uint64_t connection, OnagerProfile *out);
+
+/**
+ * Returns the function name of the last profile of a connection, or null if there is none.
+ * The caller must free the string with onager_free.
+ */
+ char *onager_last_profile_function(uint64_t connection);
+
+/**
+ * Forgets the last profile of a connection, for when the connection closes.
+ */
+void onager_forget_profile(uint64_t connection);
+
+/**
+ * Sets the most bytes of built graphs the graph build cache keeps. Zero turns the cache off.
+ */
+ void onager_graph_cache_set_size(uint64_t size);
+
+/**
+ * Copies the graph build cache's counters and size into `out`.
+ *
+ * Returns false if `out` is null.
+ * # Safety
+ * `out` must be null or point to a writable GraphCacheStats.
+ */
+ bool onager_graph_cache_stats(GraphCacheStats *out);
+
+/**
+ * Frees a result returned by an Onager compute function.
+ * # Safety
+ * The pointer must be null or have been returned by an Onager compute function,
+ * and must not be used after this call.
+ */
+ void onager_free_result(OnagerResult *result);
+
 /**
  * Creates a new graph with the given name.
  * # Safety
@@ -239,6 +457,20 @@ int64_t onager_compute_laplacian(const int64_t *src_ptr,
  */
  int32_t onager_drop_graph(const char *name);
 
+/**
+ * Writes a graph to a snapshot file at the given path.
+ * # Safety
+ * The name and path pointers must be valid null-terminated C strings.
+ */
+ int32_t onager_save_graph(const char *name, const char *path);
+
+/**
+ * Creates a graph with the given name from a snapshot file.
+ * # Safety
+ * The name and path pointers must be valid null-terminated C strings.
+ */
+ int32_t onager_open_graph(const char *name, const char *path);
+
 /**
  * Returns a JSON array of all graph names.
  */
@@ -258,6 +490,44 @@ int64_t onager_compute_laplacian(const int64_t *src_ptr,
  */
  int32_t onager_add_edge(const char *graph_name, int64_t src, int64_t dst, double weight);
 
+/**
+ * Loads edge arrays into the specified graph in one batch, creating it if needed.
+ *
+ * `directed` is 1 for directed, 0 for undirected, and negative to keep the
+ * direction of an existing graph or create a directed one. The result has one
+ * row with the number of nodes and edges added.
+ * # Safety
+ * The graph_name pointer must be a valid null-terminated C string. Unless
+ * edge_count is 0, src_ptr and dst_ptr must point to edge_count values, and
+ * weights_ptr must be null or point to edge_count values.
+ */
+
+OnagerResult *onager_load_graph(const char *graph_name,
+                                const int64_t *src_ptr,
+                                const int64_t *dst_ptr,
+                                const double *weights_ptr,
+                                uintptr_t edge_count,
+                                int32_t directed);
+
+/**
+ * Applies a batch of edge inserts and deletes to the specified graph, in order.
+ *
+ * Each entry of `ops_ptr` is 1 to insert the edge and -1 to delete every edge
+ * between its endpoints. The result has one row with the number of edges
+ * inserted and deleted.
+ * # Safety
+ * The graph_name pointer must be a valid null-terminated C string. Unless
+ * edge_count is 0, ops_ptr, src_ptr, and dst_ptr must point to edge_count
+ * values, and weights_ptr must be null or point to edge_count values.
+ */
+
+OnagerResult *onager_apply_delta(const char *graph_name,
+                                 const int64_t *ops_ptr,
+                                 const int64_t *src_ptr,
+                                 const int64_t *dst_ptr,
+                                 const double *weights_ptr,
+                                 uintptr_t edge_count);
+
 /**
  * Returns the number of nodes in the graph.
  * # Safety
@@ -286,157 +556,189 @@ int64_t onager_compute_laplacian(const int64_t *src_ptr,
  */
  int64_t onager_graph_node_out_degree(const char *graph_name, int64_t node);
 
+/**
+ * Writes the in-degree (`inbound`) or out-degree of each node to `out_ptr`.
+ *
+ * Nodes that are not in the graph get -1. Returns 0 on success and -1 if the
+ * graph does not exist or the arguments are invalid.
+ * # Safety
+ * The graph_name pointer must be a valid null-terminated C string, and unless
+ * count is 0, nodes_ptr and out_ptr must each point to count values.
+ */
+int32_t onager_graph_node_degrees(const char *graph_name,
+                                  const int64_t *nodes_ptr,
+                                  uintptr_t count,
+                                  bool inbound,
+                                  int64_t *out_ptr);
+
 /**
  * Compute Louvain community detection.
+ * `weights_ptr` may be null for an unweighted graph.
  */
 
-int64_t onager_compute_louvain(const int64_t *src_ptr,
-                               const int64_t *dst_ptr,
-                               uintptr_t edge_count,
-                               int64_t seed,
-                               int64_t *out_nodes,
-                               int64_t *out_communities);
+OnagerResult *onager_compute_louvain(const int64_t *src_ptr,
+                                     const int64_t *dst_ptr,
+                                     uintptr_t edge_count,
+                                     const double *weights_ptr,
+                                     uintptr_t weights_count,
+                                     int64_t seed);
 
 /**
  * Compute connected components.
  */
 
-int64_t onager_compute_connected_components(const int64_t *src_ptr,
-                                            const int64_t *dst_ptr,
-                                            uintptr_t edge_count,
-                                            int64_t *out_nodes,
-                                            int64_t *out_components);
+OnagerResult *onager_compute_connected_components(const int64_t *src_ptr,
+                                                  const int64_t *dst_ptr,
+                                                  uintptr_t edge_count);
 
 /**
  * Compute label propagation.
  */
 
-int64_t onager_compute_label_propagation(const int64_t *src_ptr,
-                                         const int64_t *dst_ptr,
-                                         uintptr_t edge_count,
-                                         int64_t *out_node_ids,
-                                         int64_t *out_labels);
+OnagerResult *onager_compute_label_propagation(const int64_t *src_ptr,
+                                               const int64_t *dst_ptr,
+                                               uintptr_t edge_count);
 
 /**
  * Compute Girvan-Newman community detection.
  */
 
-int64_t onager_compute_girvan_newman(const int64_t *src_ptr,
-                                     const int64_t *dst_ptr,
-                                     uintptr_t edge_count,
-                                     int64_t target_communities,
-                                     int64_t *out_nodes,
-                                     int64_t *out_communities);
+OnagerResult *onager_compute_girvan_newman(const int64_t *src_ptr,
+                                           const int64_t *dst_ptr,
+                                           uintptr_t edge_count,
+                                           int64_t target_communities);
 
 /**
  * Compute spectral clustering.
  */
 
-int64_t onager_compute_spectral_clustering(const int64_t *src_ptr,
-                                           const int64_t *dst_ptr,
-                                           uintptr_t edge_count,
-                                           uintptr_t k,
-                                           int64_t seed,
-                                           int64_t *out_nodes,
-                                           int64_t *out_communities);
+OnagerResult *onager_compute_spectral_clustering(const int64_t *src_ptr,
+                                                 const int64_t *dst_ptr,
+                                                 uintptr_t edge_count,
+                                                 uintptr_t k,
+                                                 int64_t seed);
 
 /**
  * Compute infomap community detection.
  */
 
-int64_t onager_compute_infomap(const int64_t *src_ptr,
-                               const int64_t *dst_ptr,
-                               uintptr_t edge_count,
-                               uintptr_t max_iter,
-                               int64_t seed,
-                               int64_t *out_nodes,
-                               int64_t *out_communities);
+OnagerResult *onager_compute_infomap(const int64_t *src_ptr,
+                                     const int64_t *dst_ptr,
+                                     uintptr_t edge_count,
+                                     uintptr_t max_iter,
+                                     int64_t seed);
 
 /**
- * Generate Erdős-Rényi random graph.
+ * Compute the core number of every node.
  */
 
-int64_t onager_generate_erdos_renyi(uintptr_t n,
-                                    double p,
-                                    uint64_t seed,
-                                    int64_t *out_src,
-                                    int64_t *out_dst);
+OnagerResult *onager_compute_kcore(const int64_t *src_ptr,
+                                   const int64_t *dst_ptr,
+                                   uintptr_t edge_count);
 
 /**
- * Generate Barabási-Albert graph.
+ * Extract the edges of the k-core.
  */
 
-int64_t onager_generate_barabasi_albert(uintptr_t n,
-                                        uintptr_t m,
-                                        uint64_t seed,
-                                        int64_t *out_src,
-                                        int64_t *out_dst);
+OnagerResult *onager_compute_kcore_edges(const int64_t *src_ptr,
+                                         const int64_t *dst_ptr,
+                                         uintptr_t edge_count,
+                                         int64_t k);
 
 /**
- * Generate Watts-Strogatz graph.
+ * Open a streaming Erdős-Rényi generator.
  */
 
-int64_t onager_generate_watts_strogatz(uintptr_t n,
-                                       uintptr_t k,
-                                       double beta,
-                                       uint64_t seed,
-                                       int64_t *out_src,
-                                       int64_t *out_dst);
+OnagerEdgeGenerator *onager_edge_generator_erdos_renyi(uintptr_t n,
+                                                       double p,
+                                                       uint64_t seed);
 
 /**
- * Compute Jaccard coefficient.
+ * Open a streaming Barabási-Albert generator.
  */
 
-int64_t onager_compute_jaccard(const int64_t *src_ptr,
-                               const int64_t *dst_ptr,
-                               uintptr_t edge_count,
-                               int64_t *out_node1,
-                               int64_t *out_node2,
-                               double *out_coefficients);
+OnagerEdgeGenerator *onager_edge_generator_barabasi_albert(uintptr_t n,
+                                                           uintptr_t m,
+                                                           uint64_t seed);
 
 /**
- * Compute Adamic-Adar index.
+ * Open a streaming Watts-Strogatz generator.
  */
 
-int64_t onager_compute_adamic_adar(const int64_t *src_ptr,
-                                   const int64_t *dst_ptr,
-                                   uintptr_t edge_count,
-                                   int64_t *out_node1,
-                                   int64_t *out_node2,
-                                   double *out_scores);
+OnagerEdgeGenerator *onager_edge_generator_watts_strogatz(uintptr_t n,
+                                                          uintptr_t k,
+                                                          double beta,
+                                                          uint64_t seed);
 
 /**
- * Compute preferential attachment.
+ * Get the number of partitions of a generator.
  */
+ uintptr_t onager_edge_generator_partitions(const OnagerEdgeGenerator *generator);
 
-int64_t onager_compute_preferential_attachment(const int64_t *src_ptr,
-                                               const int64_t *dst_ptr,
-                                               uintptr_t edge_count,
-                                               int64_t *out_node1,
-                                               int64_t *out_node2,
-                                               double *out_scores);
+/**
+ * Open the cursor for one partition of a generator.
+ */
+
+OnagerEdgeCursor *onager_edge_generator_cursor(const OnagerEdgeGenerator *generator,
+                                               uintptr_t partition);
 
 /**
- * Compute resource allocation index.
+ * Write up to capacity edges from a cursor into the output arrays.
+ * Returns the number of edges written; fewer than capacity means the cursor is exhausted.
  */
 
-int64_t onager_compute_resource_allocation(const int64_t *src_ptr,
-                                           const int64_t *dst_ptr,
-                                           uintptr_t edge_count,
-                                           int64_t *out_node1,
-                                           int64_t *out_node2,
-                                           double *out_scores);
+uintptr_t onager_edge_cursor_next(OnagerEdgeCursor *cursor,
+                                  int64_t *src_out,
+                                  int64_t *dst_out,
+                                  uintptr_t capacity);
+
+/**
+ * Free an edge generator.
+ * # Safety
+ * The pointer must be null or returned by an `onager_edge_generator_*` function.
+ */
+ void onager_free_edge_generator(OnagerEdgeGenerator *generator);
+
+/**
+ * Free an edge cursor.
+ * # Safety
+ * The pointer must be null or returned by `onager_edge_generator_cursor`.
+ */
+ void onager_free_edge_cursor(OnagerEdgeCursor *cursor);
+
+/**
+ * Score every pair of distinct nodes for a link prediction metric.
+ * Metric codes: 0 Jaccard, 1 Adamic-Adar, 2 resource allocation, 3 preferential attachment.
+ *
+ * Rows have node1 below node2. Only pairs whose nodes pass `node1` and `node2`
+ * are scored.
+ */
+
+OnagerResult *onager_compute_link_scores(const int64_t *src_ptr,
+                                         const int64_t *dst_ptr,
+                                         uintptr_t edge_count,
+                                         uint32_t metric,
+                                         OnagerNodeFilter node1,
+                                         OnagerNodeFilter node2);
 
 /**
  * Compute common neighbors count.
  */
 
-int64_t onager_compute_common_neighbors(const int64_t *src_ptr,
+OnagerResult *onager_compute_common_neighbors(const int64_t *src_ptr,
+                                              const int64_t *dst_ptr,
+                                              uintptr_t edge_count);
+
+/**
+ * Compute the top-k new links per node for a link prediction metric.
+ * Metric codes: 0 Jaccard, 1 Adamic-Adar, 2 resource allocation, 3 preferential attachment.
+ */
+
+OnagerResult *onager_compute_link_top_k(const int64_t *src_ptr,
                                         const int64_t *dst_ptr,
                                         uintptr_t edge_count,
-                                        int64_t *out_node1,
-                                        int64_t *out_node2,
-                                        int64_t *out_counts);
+                                        uint32_t metric,
+                                        uintptr_t top_k);
 
 /**
  * Compute graph diameter.
@@ -482,11 +784,9 @@ double onager_compute_transitivity(const int64_t *src_ptr,
  * Compute triangle count for each node.
  */
 
-int64_t onager_compute_triangle_count(const int64_t *src_ptr,
-                                      const int64_t *dst_ptr,
-                                      uintptr_t edge_count,
-                                      int64_t *out_nodes,
-                                      int64_t *out_counts);
+OnagerResult *onager_compute_triangle_count(const int64_t *src_ptr,
+                                            const int64_t *dst_ptr,
+                                            uintptr_t edge_count);
 
 /**
  * Compute assortativity coefficient.
@@ -511,184 +811,470 @@ double onager_compute_graph_density(const int64_t *src_ptr,
  * Compute Prim's MST on weighted edge arrays.
  */
 
-int64_t onager_compute_prim_mst(const int64_t *src_ptr,
-                                const int64_t *dst_ptr,
-                                const double *weight_ptr,
-                                uintptr_t edge_count,
-                                int64_t *out_src,
-                                int64_t *out_dst,
-                                double *out_weight,
-                                double *out_total);
+OnagerResult *onager_compute_prim_mst(const int64_t *src_ptr,
+                                      const int64_t *dst_ptr,
+                                      const double *weight_ptr,
+                                      uintptr_t edge_count);
 
 /**
  * Compute Kruskal's MST on weighted edge arrays.
  */
 
-int64_t onager_compute_kruskal_mst(const int64_t *src_ptr,
-                                   const int64_t *dst_ptr,
-                                   const double *weight_ptr,
-                                   uintptr_t edge_count,
-                                   int64_t *out_src,
-                                   int64_t *out_dst,
-                                   double *out_weight,
-                                   double *out_total);
+OnagerResult *onager_compute_kruskal_mst(const int64_t *src_ptr,
+                                         const int64_t *dst_ptr,
+                                         const double *weight_ptr,
+                                         uintptr_t edge_count);
 
 /**
  * Compute parallel BFS from a single source.
  */
 
-int64_t onager_compute_bfs_parallel(const int64_t *src_ptr,
-                                    const int64_t *dst_ptr,
-                                    uintptr_t edge_count,
-                                    int64_t source,
-                                    int64_t *out_order);
+OnagerResult *onager_compute_bfs_parallel(const int64_t *src_ptr,
+                                          const int64_t *dst_ptr,
+                                          uintptr_t edge_count,
+                                          int64_t source);
 
 /**
  * Compute parallel shortest paths from a single source.
  */
 
-int64_t onager_compute_shortest_paths_parallel(const int64_t *src_ptr,
-                                               const int64_t *dst_ptr,
-                                               uintptr_t edge_count,
-                                               int64_t source,
-                                               int64_t *out_nodes,
-                                               double *out_distances);
+OnagerResult *onager_compute_shortest_paths_parallel(const int64_t *src_ptr,
+                                                     const int64_t *dst_ptr,
+                                                     uintptr_t edge_count,
+                                                     int64_t source);
 
 /**
  * Compute parallel connected components.
  */
 
-int64_t onager_compute_components_parallel(const int64_t *src_ptr,
-                                           const int64_t *dst_ptr,
-                                           uintptr_t edge_count,
-                                           int64_t *out_nodes,
-                                           int64_t *out_components);
+OnagerResult *onager_compute_components_parallel(const int64_t *src_ptr,
+                                                 const int64_t *dst_ptr,
+                                                 uintptr_t edge_count);
 
 /**
  * Compute parallel clustering coefficients.
  */
 
-int64_t onager_compute_clustering_parallel(const int64_t *src_ptr,
-                                           const int64_t *dst_ptr,
-                                           uintptr_t edge_count,
-                                           int64_t *out_nodes,
-                                           double *out_coefficients);
+OnagerResult *onager_compute_clustering_parallel(const int64_t *src_ptr,
+                                                 const int64_t *dst_ptr,
+                                                 uintptr_t edge_count);
 
 /**
  * Compute parallel triangle count.
  */
 
-int64_t onager_compute_triangles_parallel(const int64_t *src_ptr,
-                                          const int64_t *dst_ptr,
-                                          uintptr_t edge_count,
-                                          int64_t *out_nodes,
-                                          int64_t *out_counts);
+OnagerResult *onager_compute_triangles_parallel(const int64_t *src_ptr,
+                                                const int64_t *dst_ptr,
+                                                uintptr_t edge_count);
+
+/**
+ * Compute Louvain community detection in parallel.
+ *
+ * `weights_ptr` may be null for an unweighted graph, and a negative seed selects
+ * the default seed.
+ */
+
+OnagerResult *onager_compute_louvain_parallel(const int64_t *src_ptr,
+                                              const int64_t *dst_ptr,
+                                              uintptr_t edge_count,
+                                              const double *weights_ptr,
+                                              uintptr_t weights_count,
+                                              int64_t seed);
 
 /**
  * Compute personalized PageRank.
  */
 
-int64_t onager_compute_personalized_pagerank(const int64_t *src_ptr,
-                                             const int64_t *dst_ptr,
-                                             uintptr_t edge_count,
-                                             const int64_t *pers_nodes_ptr,
-                                             const double *pers_weights_ptr,
-                                             uintptr_t pers_count,
-                                             double damping,
-                                             uintptr_t max_iter,
-                                             double tolerance,
-                                             int64_t *out_nodes,
-                                             double *out_scores);
+OnagerResult *onager_compute_personalized_pagerank(const int64_t *src_ptr,
+                                                   const int64_t *dst_ptr,
+                                                   uintptr_t edge_count,
+                                                   const int64_t *pers_nodes_ptr,
+                                                   const double *pers_weights_ptr,
+                                                   uintptr_t pers_count,
+                                                   double damping,
+                                                   uintptr_t max_iter,
+                                                   double tolerance);
 
 /**
- * Compute ego graph.
+ * Compute PageRank on a named graph.
+ *
+ * The `prior_count` pairs of `prior_nodes_ptr` and `prior_ranks_ptr` seed the
+ * starting vector with the ranks of an earlier run; a count of zero starts uniform.
+ * # Safety
+ * The graph_name pointer must be a valid null-terminated C string, and the prior
+ * pointers must be valid for `prior_count` elements when it is non-zero.
  */
 
-int64_t onager_compute_ego_graph(const int64_t *src_ptr,
-                                 const int64_t *dst_ptr,
-                                 uintptr_t edge_count,
-                                 int64_t center,
-                                 uintptr_t radius,
-                                 int64_t *out_src,
-                                 int64_t *out_dst);
+OnagerResult *onager_graph_compute_pagerank(const char *graph_name,
+                                            double damping,
+                                            uintptr_t iterations,
+                                            double tolerance,
+                                            const int64_t *prior_nodes_ptr,
+                                            const double *prior_ranks_ptr,
+                                            uintptr_t prior_count);
 
 /**
- * Compute k-hop neighbors.
+ * Compute degree centrality on a named graph.
+ * # Safety
+ * The graph_name pointer must be a valid null-terminated C string.
+ */
+
+OnagerResult *onager_graph_compute_degree(const char *graph_name);
+
+/**
+ * Compute betweenness centrality on a named graph.
+ * A nonzero samples count uses that many random pivot sources chosen with seed.
+ * # Safety
+ * The graph_name pointer must be a valid null-terminated C string.
+ */
+
+OnagerResult *onager_graph_compute_betweenness(const char *graph_name,
+                                               bool normalized,
+                                               uintptr_t samples,
+                                               uint64_t seed);
+
+/**
+ * Compute closeness centrality on a named graph.
+ * # Safety
+ * The graph_name pointer must be a valid null-terminated C string.
  */
 
-int64_t onager_compute_k_hop_neighbors(const int64_t *src_ptr,
+OnagerResult *onager_graph_compute_closeness(const char *graph_name);
+
+/**
+ * Compute harmonic centrality on a named graph.
+ * # Safety
+ * The graph_name pointer must be a valid null-terminated C string.
+ */
+
+OnagerResult *onager_graph_compute_harmonic(const char *graph_name);
+
+/**
+ * Compute eigenvector centrality on a named graph.
+ * # Safety
+ * The graph_name pointer must be a valid null-terminated C string.
+ */
+
+OnagerResult *onager_graph_compute_eigenvector(const char *graph_name,
+                                               uintptr_t max_iter,
+                                               double tolerance);
+
+/**
+ * Compute Katz centrality on a named graph.
+ * # Safety
+ * The graph_name pointer must be a valid null-terminated C string.
+ */
+
+OnagerResult *onager_graph_compute_katz(const char *graph_name,
+                                        double alpha,
+                                        uintptr_t max_iter,
+                                        double tolerance);
+
+/**
+ * Compute Louvain community detection on a named graph.
+ * # Safety
+ * The graph_name pointer must be a valid null-terminated C string.
+ */
+
+OnagerResult *onager_graph_compute_louvain(const char *graph_name,
+                                           int64_t seed);
+
+/**
+ * Compute Louvain community detection in parallel on a named graph, using its edge weights.
+ * # Safety
+ * The graph_name pointer must be a valid null-terminated C string.
+ */
+
+OnagerResult *onager_graph_compute_louvain_parallel(const char *graph_name,
+                                                    int64_t seed);
+
+/**
+ * Compute connected components on a named graph.
+ *
+ * The components are kept up to date as edges are inserted, see
+ * [`graph::connected_components`], and numbered by their smallest node ID.
+ * # Safety
+ * The graph_name pointer must be a valid null-terminated C string.
+ */
+
+OnagerResult *onager_graph_compute_connected_components(const char *graph_name);
+
+/**
+ * Compute label propagation on a named graph.
+ * # Safety
+ * The graph_name pointer must be a valid null-terminated C string.
+ */
+
+OnagerResult *onager_graph_compute_label_propagation(const char *graph_name);
+
+/**
+ * Compute the core number of every node of a named graph.
+ * # Safety
+ * The graph_name pointer must be a valid null-terminated C string.
+ */
+
+OnagerResult *onager_graph_compute_kcore(const char *graph_name);
+
+/**
+ * Extract the edges of the k-core of a named graph.
+ * # Safety
+ * The graph_name pointer must be a valid null-terminated C string.
+ */
+
+OnagerResult *onager_graph_compute_kcore_edges(const char *graph_name, int64_t k);
+
+/**
+ * Compute Dijkstra shortest distances on a named graph.
+ * # Safety
+ * The graph_name pointer must be a valid null-terminated C string.
+ */
+
+OnagerResult *onager_graph_compute_dijkstra(const char *graph_name,
+                                            int64_t source_node);
+
+/**
+ * Compute BFS traversal on a named graph.
+ * # Safety
+ * The graph_name pointer must be a valid null-terminated C string.
+ */
+
+OnagerResult *onager_graph_compute_bfs(const char *graph_name,
+                                       int64_t source_node);
+
+/**
+ * Compute DFS traversal on a named graph.
+ * # Safety
+ * The graph_name pointer must be a valid null-terminated C string.
+ */
+
+OnagerResult *onager_graph_compute_dfs(const char *graph_name,
+                                       int64_t source_node);
+
+/**
+ * Score candidate node pairs on a named graph with a link prediction metric.
+ * Metric codes match `onager_compute_link_top_k`. The node pointers may be null when
+ * pair_count is 0.
+ * # Safety
+ * The graph_name pointer must be a valid null-terminated C string, and the node
+ * pointers must point to pair_count values each.
+ */
+
+OnagerResult *onager_graph_score_link_pairs(const char *graph_name,
+                                            const int64_t *node1_ptr,
+                                            const int64_t *node2_ptr,
+                                            uintptr_t pair_count,
+                                            uint32_t metric);
+
+/**
+ * Start a multi-source distance search on a named graph.
+ * The sources pointer may be null when source_count is 0. The search copies
+ * the adjacency it needs, so the registry lock is released before rows are read.
+ * # Safety
+ * The graph_name pointer must be a valid null-terminated C string, and the sources
+ * pointer must point to source_count values.
+ */
+
+OnagerDistanceStream *onager_graph_multi_source_search(const char *graph_name,
+                                                       const int64_t *sources_ptr,
+                                                       uintptr_t source_count);
+
+/**
+ * Start a search for the nodes or edges within radius hops of each center on a named graph.
+ * Emits `(center, src, dst)` edge rows when edges is true and `(center, node, hop)`
+ * rows otherwise. The centers pointer may be null when center_count is 0. The
+ * search copies the adjacency it needs, so the registry lock is released before
+ * rows are read.
+ * # Safety
+ * The graph_name pointer must be a valid null-terminated C string, and the centers
+ * pointer must point to center_count values.
+ */
+
+OnagerNeighborhoodStream *onager_graph_neighborhood_search(const char *graph_name,
+                                                           const int64_t *centers_ptr,
+                                                           uintptr_t center_count,
+                                                           uintptr_t radius,
+                                                           bool edges);
+
+/**
+ * Compute the distance of candidate node pairs on a named graph with a bidirectional search.
+ * A negative max_depth means no cutoff. The node pointers may be null when pair_count is 0.
+ * # Safety
+ * The graph_name pointer must be a valid null-terminated C string, and the node
+ * pointers must point to pair_count values each.
+ */
+
+OnagerResult *onager_graph_compute_pair_distances(const char *graph_name,
+                                                  const int64_t *src_ptr,
+                                                  const int64_t *dst_ptr,
+                                                  uintptr_t pair_count,
+                                                  double max_depth);
+
+/**
+ * Compute ego graph.
+ */
+
+OnagerResult *onager_compute_ego_graph(const int64_t *src_ptr,
                                        const int64_t *dst_ptr,
                                        uintptr_t edge_count,
-                                       int64_t start,
-                                       uintptr_t k,
-                                       int64_t *out_nodes);
+                                       int64_t center,
+                                       uintptr_t radius);
+
+/**
+ * Compute k-hop neighbors.
+ */
+
+OnagerResult *onager_compute_k_hop_neighbors(const int64_t *src_ptr,
+                                             const int64_t *dst_ptr,
+                                             uintptr_t edge_count,
+                                             int64_t start,
+                                             uintptr_t k);
 
 /**
  * Compute induced subgraph.
  */
 
-int64_t onager_compute_induced_subgraph(const int64_t *src_ptr,
-                                        const int64_t *dst_ptr,
-                                        uintptr_t edge_count,
-                                        const int64_t *node_ids_ptr,
-                                        uintptr_t node_count,
-                                        int64_t *out_src,
-                                        int64_t *out_dst);
+OnagerResult *onager_compute_induced_subgraph(const int64_t *src_ptr,
+                                              const int64_t *dst_ptr,
+                                              uintptr_t edge_count,
+                                              const int64_t *node_ids_ptr,
+                                              uintptr_t node_count);
+
+/**
+ * Start a search for the nodes or edges within radius hops of each center.
+ * Emits `(center, src, dst)` edge rows when edges is true and `(center, node, hop)`
+ * rows otherwise. The centers pointer may be null when center_count is 0.
+ */
+
+OnagerNeighborhoodStream *onager_neighborhood_search(const int64_t *src_ptr,
+                                                     const int64_t *dst_ptr,
+                                                     uintptr_t edge_count,
+                                                     const int64_t *centers_ptr,
+                                                     uintptr_t center_count,
+                                                     uintptr_t radius,
+                                                     bool edges);
+
+/**
+ * Write up to capacity rows from a neighborhood stream into the output arrays.
+ * Returns the number of rows written, where fewer than capacity means the
+ * stream is exhausted, or -1 on error. Reading from a stream whose query was
+ * interrupted fails, with `onager_last_call_interrupted` set.
+ */
+
+int64_t onager_neighborhood_stream_next(OnagerNeighborhoodStream *stream,
+                                        int64_t *center_out,
+                                        int64_t *first_out,
+                                        int64_t *second_out,
+                                        uintptr_t capacity);
+
+/**
+ * Free a neighborhood stream and stop its workers.
+ * # Safety
+ * The pointer must be null or returned by a neighborhood search function.
+ */
+ void onager_free_neighborhood_stream(OnagerNeighborhoodStream *stream);
 
 /**
  * Compute Dijkstra shortest paths.
+ * `weights_ptr` may be null for an unweighted graph.
  */
 
-int64_t onager_compute_dijkstra(const int64_t *src_ptr,
-                                const int64_t *dst_ptr,
-                                uintptr_t edge_count,
-                                int64_t source_node,
-                                int64_t *out_nodes,
-                                double *out_distances);
+OnagerResult *onager_compute_dijkstra(const int64_t *src_ptr,
+                                      const int64_t *dst_ptr,
+                                      uintptr_t edge_count,
+                                      const double *weights_ptr,
+                                      uintptr_t weights_count,
+                                      int64_t source_node);
 
 /**
  * Compute BFS traversal.
  */
 
-int64_t onager_compute_bfs(const int64_t *src_ptr,
-                           const int64_t *dst_ptr,
-                           uintptr_t edge_count,
-                           int64_t source_node,
-                           int64_t *out_order);
+OnagerResult *onager_compute_bfs(const int64_t *src_ptr,
+                                 const int64_t *dst_ptr,
+                                 uintptr_t edge_count,
+                                 int64_t source_node);
 
 /**
  * Compute DFS traversal.
  */
 
-int64_t onager_compute_dfs(const int64_t *src_ptr,
-                           const int64_t *dst_ptr,
-                           uintptr_t edge_count,
-                           int64_t source_node,
-                           int64_t *out_order);
+OnagerResult *onager_compute_dfs(const int64_t *src_ptr,
+                                 const int64_t *dst_ptr,
+                                 uintptr_t edge_count,
+                                 int64_t source_node);
 
 /**
  * Compute Bellman-Ford shortest paths on weighted edge arrays.
  */
 
-int64_t onager_compute_bellman_ford(const int64_t *src_ptr,
-                                    const int64_t *dst_ptr,
-                                    const double *weight_ptr,
-                                    uintptr_t edge_count,
-                                    int64_t source,
-                                    int64_t *out_nodes,
-                                    double *out_distances);
+OnagerResult *onager_compute_bellman_ford(const int64_t *src_ptr,
+                                          const int64_t *dst_ptr,
+                                          const double *weight_ptr,
+                                          uintptr_t edge_count,
+                                          int64_t source);
 
 /**
- * Compute Floyd-Warshall all-pairs shortest paths.
+ * Compute the Floyd-Warshall distance matrix for streaming.
+ * A nonzero memory_limit caps the matrix size in bytes; the call fails before
+ * allocating when the graph needs more.
  */
 
-int64_t onager_compute_floyd_warshall(const int64_t *src_ptr,
-                                      const int64_t *dst_ptr,
-                                      const double *weight_ptr,
-                                      uintptr_t edge_count,
-                                      int64_t *out_src,
-                                      int64_t *out_dst,
-                                      double *out_distances);
+OnagerDistanceMatrix *onager_floyd_warshall_matrix(const int64_t *src_ptr,
+                                                   const int64_t *dst_ptr,
+                                                   const double *weight_ptr,
+                                                   uintptr_t edge_count,
+                                                   uintptr_t memory_limit);
+
+/**
+ * Write up to capacity reachable pairs from a distance matrix into the output arrays.
+ * Returns the number of pairs written; fewer than capacity means the matrix is exhausted.
+ */
+
+uintptr_t onager_distance_matrix_next(OnagerDistanceMatrix *matrix,
+                                      int64_t *src_out,
+                                      int64_t *dst_out,
+                                      double *dist_out,
+                                      uintptr_t capacity);
+
+/**
+ * Free a distance matrix.
+ * # Safety
+ * The pointer must be null or returned by `onager_floyd_warshall_matrix`.
+ */
+ void onager_free_distance_matrix(OnagerDistanceMatrix *matrix);
+
+/**
+ * Start a multi-source distance search over edge arrays.
+ * The weight pointer may be null for an unweighted search, and the sources
+ * pointer may be null when source_count is 0.
+ */
+
+OnagerDistanceStream *onager_multi_source_search(const int64_t *src_ptr,
+                                                 const int64_t *dst_ptr,
+                                                 const double *weight_ptr,
+                                                 uintptr_t edge_count,
+                                                 const int64_t *sources_ptr,
+                                                 uintptr_t source_count);
+
+/**
+ * Write up to capacity rows from a distance stream into the output arrays.
+ * Returns the number of rows written, where fewer than capacity means the
+ * stream is exhausted, or -1 on error. Reading from a stream whose query was
+ * interrupted fails, with `onager_last_call_interrupted` set.
+ */
+
+int64_t onager_distance_stream_next(OnagerDistanceStream *stream,
+                                    int64_t *source_out,
+                                    int64_t *node_out,
+                                    double *dist_out,
+                                    uintptr_t capacity);
+
+/**
+ * Free a distance stream and stop its workers.
+ * # Safety
+ * The pointer must be null or returned by a multi-source search function.
+ */
+ void onager_free_distance_stream(OnagerDistanceStream *stream);
 
 /**
  * Compute shortest distance between two nodes (scalar).
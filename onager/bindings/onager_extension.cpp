@@ -20,8 +20,11 @@ namespace duckdb {
 void OnagerExtension::Load(ExtensionLoader &loader) {
   loader.SetDescription("Onager: Graph Data Analytics Extension");
 
-  // Register all functions from modular files
+  // Register settings and all functions from modular files
+  onager::RegisterSettings(loader);
   onager::RegisterScalarFunctions(loader);
+  onager::RegisterRegistryFunctions(loader);
+  onager::RegisterProfileFunctions(loader);
   onager::RegisterAllCentralityFunctions(loader);
   onager::RegisterCommunityFunctions(loader);
   onager::RegisterTraversalFunctions(loader);
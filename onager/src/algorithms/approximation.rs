@@ -6,10 +6,9 @@ use graphina::approximation::clique::max_clique;
 use graphina::approximation::independent_set::maximum_independent_set;
 use graphina::approximation::tsp::traveling_salesman_problem;
 use graphina::approximation::vertex_cover::min_weighted_vertex_cover;
-use graphina::core::types::{Graph, NodeId};
 
+use crate::cache;
 use crate::error::{OnagerError, Result};
-use std::collections::HashMap;
 
 /// Result of maximum clique computation.
 pub struct CliqueResult {
@@ -30,32 +29,15 @@ pub fn compute_max_clique(src: &[i64], dst: &[i64]) -> Result<CliqueResult> {
         });
     }
 
-    let mut node_set: HashMap<i64, NodeId> = HashMap::new();
-    let mut reverse_map: HashMap<NodeId, i64> = HashMap::new();
-    let mut graph: Graph<i64, f64> = Graph::new();
-    for &node in src.iter().chain(dst.iter()) {
-        if !node_set.contains_key(&node) {
-            let id = graph.add_node(node);
-            node_set.insert(node, id);
-            reverse_map.insert(id, node);
-        }
-    }
-    for i in 0..src.len() {
-        let src_id = *node_set.get(&src[i]).ok_or_else(|| {
-            OnagerError::InvalidArgument(format!("Source node {} not found in graph", src[i]))
-        })?;
-        let dst_id = *node_set.get(&dst[i]).ok_or_else(|| {
-            OnagerError::InvalidArgument(format!("Destination node {} not found in graph", dst[i]))
-        })?;
-        graph.add_edge(src_id, dst_id, 1.0);
-    }
+    let csr = cache::csr_from_edges(src, dst, None, false)?;
+    let (graph, node_index) = csr.to_graph(|_| 1.0)?;
 
     // Graphina's max_clique returns HashSet<NodeId>
     let clique_nodes = max_clique(&graph);
 
     let mut result_nodes = Vec::with_capacity(clique_nodes.len());
     for node_id in clique_nodes {
-        if let Some(&ext_id) = reverse_map.get(&node_id) {
+        if let Some(&ext_id) = node_index.external_id(&node_id) {
             result_nodes.push(ext_id);
         }
     }
@@ -86,31 +68,14 @@ pub fn compute_independent_set(src: &[i64], dst: &[i64]) -> Result<IndependentSe
         });
     }
 
-    let mut node_set: HashMap<i64, NodeId> = HashMap::new();
-    let mut reverse_map: HashMap<NodeId, i64> = HashMap::new();
-    let mut graph: Graph<i64, f64> = Graph::new();
-    for &node in src.iter().chain(dst.iter()) {
-        if !node_set.contains_key(&node) {
-            let id = graph.add_node(node);
-            node_set.insert(node, id);
-            reverse_map.insert(id, node);
-        }
-    }
-    for i in 0..src.len() {
-        let src_id = *node_set.get(&src[i]).ok_or_else(|| {
-            OnagerError::InvalidArgument(format!("Source node {} not found in graph", src[i]))
-        })?;
-        let dst_id = *node_set.get(&dst[i]).ok_or_else(|| {
-            OnagerError::InvalidArgument(format!("Destination node {} not found in graph", dst[i]))
-        })?;
-        graph.add_edge(src_id, dst_id, 1.0);
-    }
+    let csr = cache::csr_from_edges(src, dst, None, false)?;
+    let (graph, node_index) = csr.to_graph(|_| 1.0)?;
 
     let indep_set = maximum_independent_set(&graph);
 
     let mut result_nodes = Vec::with_capacity(indep_set.len());
     for node_id in indep_set {
-        if let Some(&ext_id) = reverse_map.get(&node_id) {
+        if let Some(&ext_id) = node_index.external_id(&node_id) {
             result_nodes.push(ext_id);
         }
     }
@@ -139,31 +104,14 @@ pub fn compute_vertex_cover(src: &[i64], dst: &[i64]) -> Result<VertexCoverResul
         });
     }
 
-    let mut node_set: HashMap<i64, NodeId> = HashMap::new();
-    let mut reverse_map: HashMap<NodeId, i64> = HashMap::new();
-    let mut graph: Graph<i64, f64> = Graph::new();
-    for &node in src.iter().chain(dst.iter()) {
-        if !node_set.contains_key(&node) {
-            let id = graph.add_node(node);
-            node_set.insert(node, id);
-            reverse_map.insert(id, node);
-        }
-    }
-    for i in 0..src.len() {
-        let src_id = *node_set.get(&src[i]).ok_or_else(|| {
-            OnagerError::InvalidArgument(format!("Source node {} not found in graph", src[i]))
-        })?;
-        let dst_id = *node_set.get(&dst[i]).ok_or_else(|| {
-            OnagerError::InvalidArgument(format!("Destination node {} not found in graph", dst[i]))
-        })?;
-        graph.add_edge(src_id, dst_id, 1.0);
-    }
+    let csr = cache::csr_from_edges(src, dst, None, false)?;
+    let (graph, node_index) = csr.to_graph(|_| 1.0)?;
 
     let cover = min_weighted_vertex_cover(&graph, None);
 
     let mut result_nodes = Vec::with_capacity(cover.len());
     for node_id in cover {
-        if let Some(&ext_id) = reverse_map.get(&node_id) {
+        if let Some(&ext_id) = node_index.external_id(&node_id) {
             result_nodes.push(ext_id);
         }
     }
@@ -193,32 +141,15 @@ pub fn compute_tsp(src: &[i64], dst: &[i64], weights: &[f64]) -> Result<TspResul
         ));
     }
 
-    let mut node_set: HashMap<i64, NodeId> = HashMap::new();
-    let mut reverse_map: HashMap<NodeId, i64> = HashMap::new();
-    let mut graph: Graph<i64, f64> = Graph::new();
-    for &node in src.iter().chain(dst.iter()) {
-        if !node_set.contains_key(&node) {
-            let id = graph.add_node(node);
-            node_set.insert(node, id);
-            reverse_map.insert(id, node);
-        }
-    }
-    for i in 0..src.len() {
-        let src_id = *node_set.get(&src[i]).ok_or_else(|| {
-            OnagerError::InvalidArgument(format!("Source node {} not found in graph", src[i]))
-        })?;
-        let dst_id = *node_set.get(&dst[i]).ok_or_else(|| {
-            OnagerError::InvalidArgument(format!("Destination node {} not found in graph", dst[i]))
-        })?;
-        graph.add_edge(src_id, dst_id, weights[i]);
-    }
+    let csr = cache::csr_from_edges(src, dst, Some(weights), false)?;
+    let (graph, node_index) = csr.to_graph(|w| w)?;
 
     let (tour_internal, cost) =
         traveling_salesman_problem(&graph).map_err(|e| OnagerError::GraphError(e.to_string()))?;
 
     let mut tour = Vec::with_capacity(tour_internal.len());
     for node_id in tour_internal {
-        if let Some(&ext_id) = reverse_map.get(&node_id) {
+        if let Some(&ext_id) = node_index.external_id(&node_id) {
             tour.push(ext_id);
         }
     }
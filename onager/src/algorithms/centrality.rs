@@ -1,110 +1,184 @@
 //! Centrality algorithms module.
 //!
 //! PageRank, Degree, Betweenness, Closeness, Eigenvector, Katz, Harmonic centrality, VoteRank.
+//!
+//! Betweenness, closeness, and harmonic centrality share a native engine that runs
+//! one search per source in parallel over the undirected neighbor sets: a BFS,
+//! or for betweenness and closeness on graphs with edge weights other than 1.0,
+//! a Dijkstra search over the lightest edge between each pair of nodes.
+//! PageRank, Katz, and eigenvector centrality run on the pull-based power-iteration
+//! engine in [`power`], and PageRank can start from the ranks of an earlier run.
+//! Both engines stop early when the query is interrupted and report progress by
+//! sources or passes done.
+
+use std::cmp::Reverse;
+use std::collections::BinaryHeap;
+use std::sync::atomic::{AtomicUsize, Ordering};
 
-use graphina::centrality::betweenness::betweenness_centrality;
-use graphina::centrality::closeness::closeness_centrality;
 use graphina::centrality::degree::{in_degree_centrality, out_degree_centrality};
-use graphina::centrality::eigenvector::eigenvector_centrality;
-use graphina::centrality::harmonic::harmonic_centrality;
-use graphina::centrality::katz::katz_centrality;
 use graphina::centrality::other::{laplacian_centrality, local_reaching_centrality, voterank};
-use graphina::centrality::pagerank::pagerank;
-use graphina::core::types::{Digraph, Graph, NodeId};
 use ordered_float::OrderedFloat;
 
+use crate::algorithms::power::{self, PullGraph};
+use crate::cache;
+use crate::control;
+use crate::csr::{CsrGraph, NeighborSets, WeightSlice, WeightedSets};
 use crate::error::{OnagerError, Result};
-use std::collections::HashMap;
+use crate::rng::SplitMix64;
+use crate::workers::{fold_blocks, map_blocks};
 
 /// Result of PageRank computation.
 pub struct PageRankResult {
     pub node_ids: Vec<i64>,
     pub ranks: Vec<f64>,
+    /// Number of power-iteration passes that ran before convergence or the limit.
+    pub iterations: usize,
 }
 
 /// Compute PageRank on a graph defined by edge arrays.
 pub fn compute_pagerank(
     src: &[i64],
     dst: &[i64],
-    _weights: &[f64],
+    weights: &[f64],
     damping: f64,
     iterations: usize,
+    tolerance: f64,
     directed: bool,
 ) -> Result<PageRankResult> {
-    if src.len() != dst.len() {
+    let csr = cache::csr_from_edges(src, dst, (!weights.is_empty()).then_some(weights), directed)?;
+    compute_pagerank_csr(&csr, damping, iterations, tolerance, &[])
+}
+
+/// Compute PageRank on a prebuilt CSR graph, following its edge direction.
+///
+/// The CSR's edge weights scale the share of rank each edge carries when it has
+/// them. `prior` holds `(node_id, rank)` pairs from an earlier run that seed the
+/// starting vector, see [`pagerank_csr`].
+pub fn compute_pagerank_csr(
+    csr: &CsrGraph,
+    damping: f64,
+    iterations: usize,
+    tolerance: f64,
+    prior: &[(i64, f64)],
+) -> Result<PageRankResult> {
+    pagerank_csr(csr, true, damping, iterations, tolerance, prior)
+}
+
+/// Runs PageRank by power iteration on a CSR graph.
+///
+/// Rank is pulled along the incoming edges of each node (all edges for undirected
+/// graphs) by the [`power`] engine. Rank held by nodes without outgoing edges is
+/// spread uniformly. The iteration stops once the L1 change of a pass is below
+/// `tolerance` times the node count, or after `max_iter` passes.
+///
+/// The starting vector is uniform unless `prior` is given. Prior ranks seed their
+/// nodes, nodes missing from `prior` start at `1/n`, prior nodes that are not in
+/// the graph are ignored, and the vector is renormalized to sum to one. Starting
+/// from the ranks of a slightly different graph usually converges in far fewer
+/// passes than starting from the uniform vector.
+///
+/// # Arguments
+/// * `csr` - The graph
+/// * `weighted` - Whether edge weights scale the share of rank each edge carries
+/// * `damping` - Probability of following an edge rather than jumping, in `[0, 1)`
+/// * `max_iter` - Maximum number of passes
+/// * `tolerance` - Convergence tolerance per node
+/// * `prior` - Starting `(node_id, rank)` pairs, or empty for a uniform start
+pub fn pagerank_csr(
+    csr: &CsrGraph,
+    weighted: bool,
+    damping: f64,
+    max_iter: usize,
+    tolerance: f64,
+    prior: &[(i64, f64)],
+) -> Result<PageRankResult> {
+    if !(0.0..1.0).contains(&damping) {
         return Err(OnagerError::InvalidArgument(
-            "src and dst arrays must have same length".to_string(),
+            "damping must be in [0, 1)".to_string(),
+        ));
+    }
+    if max_iter == 0 {
+        return Err(OnagerError::InvalidArgument(
+            "iterations must be positive".to_string(),
+        ));
+    }
+    if tolerance.is_nan() || tolerance < 0.0 {
+        return Err(OnagerError::InvalidArgument(
+            "tolerance must be non-negative".to_string(),
         ));
     }
 
-    let mut node_set: HashMap<i64, NodeId> = HashMap::new();
-    let tolerance = 1e-6;
+    let n = csr.node_count();
+    if n == 0 {
+        return Ok(PageRankResult {
+            node_ids: Vec::new(),
+            ranks: Vec::new(),
+            iterations: 0,
+        });
+    }
 
-    if directed {
-        let mut graph: Digraph<i64, f64> = Digraph::new();
-        for &node in src.iter().chain(dst.iter()) {
-            if !node_set.contains_key(&node) {
-                let id = graph.add_node(node);
-                node_set.insert(node, id);
-            }
+    let undirected = !csr.is_directed();
+    let mut out_total = Vec::with_capacity(n);
+    for u in 0..n as u32 {
+        let mut total = edge_total(csr.out_weights(u), csr.out_degree(u), weighted)?;
+        if undirected {
+            total += edge_total(csr.in_weights(u), csr.in_degree(u), weighted)?;
         }
-        for i in 0..src.len() {
-            let src_id = *node_set.get(&src[i]).ok_or_else(|| {
-                OnagerError::InvalidArgument(format!("Source node {} not found in graph", src[i]))
-            })?;
-            let dst_id = *node_set.get(&dst[i]).ok_or_else(|| {
-                OnagerError::InvalidArgument(format!(
-                    "Destination node {} not found in graph",
-                    dst[i]
-                ))
-            })?;
-            graph.add_edge(src_id, dst_id, 1.0);
-        }
-        let ranks = pagerank(&graph, damping, iterations, tolerance, None)
-            .map_err(|e| OnagerError::GraphError(e.to_string()))?;
-        let mut result_nodes = Vec::with_capacity(node_set.len());
-        let mut result_ranks = Vec::with_capacity(node_set.len());
-        for (ext_id, int_id) in &node_set {
-            result_nodes.push(*ext_id);
-            result_ranks.push(*ranks.get(int_id).unwrap_or(&0.0));
-        }
-        Ok(PageRankResult {
-            node_ids: result_nodes,
-            ranks: result_ranks,
-        })
-    } else {
-        let mut graph: Graph<i64, f64> = Graph::new();
-        for &node in src.iter().chain(dst.iter()) {
-            if !node_set.contains_key(&node) {
-                let id = graph.add_node(node);
-                node_set.insert(node, id);
+        out_total.push(total);
+    }
+
+    let graph = PullGraph::new(csr, undirected, weighted);
+    let start = initial_ranks(csr, prior)?;
+    let run = power::pagerank(&graph, &out_total, damping, max_iter, tolerance, start)?;
+    Ok(PageRankResult {
+        node_ids: csr.ids().to_vec(),
+        ranks: run.values,
+        iterations: run.passes,
+    })
+}
+
+/// Returns the total weight of a node's edges, or their count when unweighted.
+fn edge_total(weights: Option<WeightSlice>, degree: usize, weighted: bool) -> Result<f64> {
+    match weights {
+        Some(w) if weighted => {
+            if w.iter().any(|x| x.is_nan() || x < 0.0) {
+                return Err(OnagerError::InvalidArgument(
+                    "PageRank requires non-negative edge weights".to_string(),
+                ));
             }
+            Ok(w.iter().sum())
         }
-        for i in 0..src.len() {
-            let src_id = *node_set.get(&src[i]).ok_or_else(|| {
-                OnagerError::InvalidArgument(format!("Source node {} not found in graph", src[i]))
-            })?;
-            let dst_id = *node_set.get(&dst[i]).ok_or_else(|| {
-                OnagerError::InvalidArgument(format!(
-                    "Destination node {} not found in graph",
-                    dst[i]
-                ))
-            })?;
-            graph.add_edge(src_id, dst_id, 1.0);
+        _ => Ok(degree as f64),
+    }
+}
+
+/// Builds the starting PageRank vector from prior `(node_id, rank)` pairs.
+fn initial_ranks(csr: &CsrGraph, prior: &[(i64, f64)]) -> Result<Vec<f64>> {
+    let n = csr.node_count();
+    let uniform = 1.0 / n as f64;
+    if prior.is_empty() {
+        return Ok(vec![uniform; n]);
+    }
+    let mut seeded = vec![None; n];
+    for &(node, rank) in prior {
+        if !rank.is_finite() || rank < 0.0 {
+            return Err(OnagerError::InvalidArgument(format!(
+                "Prior rank of node {} must be a non-negative number",
+                node
+            )));
         }
-        let ranks = pagerank(&graph, damping, iterations, tolerance, None)
-            .map_err(|e| OnagerError::GraphError(e.to_string()))?;
-        let mut result_nodes = Vec::with_capacity(node_set.len());
-        let mut result_ranks = Vec::with_capacity(node_set.len());
-        for (ext_id, int_id) in &node_set {
-            result_nodes.push(*ext_id);
-            result_ranks.push(*ranks.get(int_id).unwrap_or(&0.0));
+        if let Some(u) = csr.dense_id(node) {
+            seeded[u as usize] = Some(rank);
         }
-        Ok(PageRankResult {
-            node_ids: result_nodes,
-            ranks: result_ranks,
-        })
     }
+    let mut rank: Vec<f64> = seeded.into_iter().map(|r| r.unwrap_or(uniform)).collect();
+    let total: f64 = rank.iter().sum();
+    if total > 0.0 {
+        rank.iter_mut().for_each(|r| *r /= total);
+    } else {
+        rank.fill(uniform);
+    }
+    Ok(rank)
 }
 
 /// Result of degree centrality computation.
@@ -116,42 +190,22 @@ pub struct DegreeResult {
 
 /// Compute degree centrality.
 pub fn compute_degree(src: &[i64], dst: &[i64], directed: bool) -> Result<DegreeResult> {
-    if src.len() != dst.len() {
-        return Err(OnagerError::InvalidArgument(
-            "src and dst arrays must have same length".to_string(),
-        ));
-    }
-
-    let mut node_set: HashMap<i64, NodeId> = HashMap::new();
+    let csr = cache::csr_from_edges(src, dst, None, directed)?;
+    compute_degree_csr(&csr)
+}
 
-    if directed {
-        let mut graph: Digraph<i64, f64> = Digraph::new();
-        for &node in src.iter().chain(dst.iter()) {
-            if !node_set.contains_key(&node) {
-                let id = graph.add_node(node);
-                node_set.insert(node, id);
-            }
-        }
-        for i in 0..src.len() {
-            let src_id = *node_set.get(&src[i]).ok_or_else(|| {
-                OnagerError::InvalidArgument(format!("Source node {} not found in graph", src[i]))
-            })?;
-            let dst_id = *node_set.get(&dst[i]).ok_or_else(|| {
-                OnagerError::InvalidArgument(format!(
-                    "Destination node {} not found in graph",
-                    dst[i]
-                ))
-            })?;
-            graph.add_edge(src_id, dst_id, 1.0);
-        }
+/// Compute degree centrality on a prebuilt CSR graph, following its edge direction.
+pub fn compute_degree_csr(csr: &CsrGraph) -> Result<DegreeResult> {
+    if csr.is_directed() {
+        let (graph, node_index) = csr.to_digraph(|_| 1.0)?;
         let in_deg =
             in_degree_centrality(&graph).map_err(|e| OnagerError::GraphError(e.to_string()))?;
         let out_deg =
             out_degree_centrality(&graph).map_err(|e| OnagerError::GraphError(e.to_string()))?;
-        let mut result_nodes = Vec::with_capacity(node_set.len());
-        let mut result_in = Vec::with_capacity(node_set.len());
-        let mut result_out = Vec::with_capacity(node_set.len());
-        for (ext_id, int_id) in &node_set {
+        let mut result_nodes = Vec::with_capacity(node_index.len());
+        let mut result_in = Vec::with_capacity(node_index.len());
+        let mut result_out = Vec::with_capacity(node_index.len());
+        for (ext_id, int_id) in node_index.iter() {
             result_nodes.push(*ext_id);
             result_in.push(*in_deg.get(int_id).unwrap_or(&0.0));
             result_out.push(*out_deg.get(int_id).unwrap_or(&0.0));
@@ -162,30 +216,12 @@ pub fn compute_degree(src: &[i64], dst: &[i64], directed: bool) -> Result<Degree
             out_degrees: result_out,
         })
     } else {
-        let mut graph: Graph<i64, f64> = Graph::new();
-        for &node in src.iter().chain(dst.iter()) {
-            if !node_set.contains_key(&node) {
-                let id = graph.add_node(node);
-                node_set.insert(node, id);
-            }
-        }
-        for i in 0..src.len() {
-            let src_id = *node_set.get(&src[i]).ok_or_else(|| {
-                OnagerError::InvalidArgument(format!("Source node {} not found in graph", src[i]))
-            })?;
-            let dst_id = *node_set.get(&dst[i]).ok_or_else(|| {
-                OnagerError::InvalidArgument(format!(
-                    "Destination node {} not found in graph",
-                    dst[i]
-                ))
-            })?;
-            graph.add_edge(src_id, dst_id, 1.0);
-        }
+        let (graph, node_index) = csr.to_graph(|_| 1.0)?;
         let deg =
             in_degree_centrality(&graph).map_err(|e| OnagerError::GraphError(e.to_string()))?;
-        let mut result_nodes = Vec::with_capacity(node_set.len());
-        let mut result_deg = Vec::with_capacity(node_set.len());
-        for (ext_id, int_id) in &node_set {
+        let mut result_nodes = Vec::with_capacity(node_index.len());
+        let mut result_deg = Vec::with_capacity(node_index.len());
+        for (ext_id, int_id) in node_index.iter() {
             result_nodes.push(*ext_id);
             result_deg.push(*deg.get(int_id).unwrap_or(&0.0));
         }
@@ -204,50 +240,90 @@ pub struct BetweennessResult {
 }
 
 /// Compute betweenness centrality.
+///
+/// `weights` is either empty or holds one positive weight per edge.
 pub fn compute_betweenness(
     src: &[i64],
     dst: &[i64],
+    weights: &[f64],
     normalized: bool,
 ) -> Result<BetweennessResult> {
-    if src.len() != dst.len() {
+    let csr = cache::csr_from_edges(src, dst, (!weights.is_empty()).then_some(weights), false)?;
+    compute_betweenness_csr(&csr, normalized, None, 0)
+}
+
+/// Compute approximate betweenness centrality from `samples` random pivot sources.
+pub fn compute_betweenness_sampled(
+    src: &[i64],
+    dst: &[i64],
+    weights: &[f64],
+    normalized: bool,
+    samples: usize,
+    seed: u64,
+) -> Result<BetweennessResult> {
+    let csr = cache::csr_from_edges(src, dst, (!weights.is_empty()).then_some(weights), false)?;
+    compute_betweenness_csr(&csr, normalized, Some(samples), seed)
+}
+
+/// Compute betweenness centrality on a prebuilt CSR graph.
+///
+/// Runs Brandes' algorithm from every source in parallel, with one dependency
+/// accumulator per worker that is summed at the end. With `samples`, only that many
+/// pivot sources chosen with `seed` are used and the scores are scaled by
+/// n / samples. Edges are treated as undirected, so unnormalized scores count each
+/// pair once, and normalized scores are divided by (n - 1)(n - 2) / 2. When the
+/// CSR has edge weights other than 1.0, shortest paths follow them, and every
+/// weight must be positive.
+pub fn compute_betweenness_csr(
+    csr: &CsrGraph,
+    normalized: bool,
+    samples: Option<usize>,
+    seed: u64,
+) -> Result<BetweennessResult> {
+    if csr.edge_count() == 0 {
         return Err(OnagerError::InvalidArgument(
-            "src and dst arrays must have same length".to_string(),
+            "Cannot compute betweenness on empty graph".to_string(),
         ));
     }
-    if src.is_empty() {
+    if samples == Some(0) {
         return Err(OnagerError::InvalidArgument(
-            "Cannot compute betweenness on empty graph".to_string(),
+            "samples must be > 0".to_string(),
         ));
     }
 
-    let mut node_set: HashMap<i64, NodeId> = HashMap::new();
-    let mut graph: Graph<i64, OrderedFloat<f64>> = Graph::new();
-    for &node in src.iter().chain(dst.iter()) {
-        if !node_set.contains_key(&node) {
-            let id = graph.add_node(node);
-            node_set.insert(node, id);
+    let n = csr.node_count();
+    let sources: Vec<u32> = match samples {
+        Some(k) if k < n => SplitMix64::new(seed).sample(n, k),
+        _ => (0..n as u32).collect(),
+    };
+    let mut centralities = if csr.is_weighted() {
+        check_path_weights(csr, "betweenness")?;
+        let sets = WeightedSets::from_csr(csr);
+        dependency_sums(n, &sources, || WeightedPathScratch::new(&sets))?
+    } else {
+        let sets = NeighborSets::from_csr(csr);
+        dependency_sums(n, &sources, || PathScratch::new(&sets))?
+    };
+
+    // Each undirected pair is seen from both endpoints.
+    let mut scale = if normalized {
+        if n > 2 {
+            1.0 / ((n - 1) as f64 * (n - 2) as f64)
+        } else {
+            1.0
         }
+    } else {
+        0.5
+    };
+    if sources.len() < n {
+        scale *= n as f64 / sources.len() as f64;
     }
-    for i in 0..src.len() {
-        let src_id = *node_set.get(&src[i]).ok_or_else(|| {
-            OnagerError::InvalidArgument(format!("Source node {} not found in graph", src[i]))
-        })?;
-        let dst_id = *node_set.get(&dst[i]).ok_or_else(|| {
-            OnagerError::InvalidArgument(format!("Destination node {} not found in graph", dst[i]))
-        })?;
-        graph.add_edge(src_id, dst_id, OrderedFloat(1.0));
-    }
-    let centralities = betweenness_centrality(&graph, normalized)
-        .map_err(|e| OnagerError::GraphError(e.to_string()))?;
-    let mut result_nodes = Vec::with_capacity(node_set.len());
-    let mut result_cent = Vec::with_capacity(node_set.len());
-    for (ext_id, int_id) in &node_set {
-        result_nodes.push(*ext_id);
-        result_cent.push(*centralities.get(int_id).unwrap_or(&0.0));
+    for c in &mut centralities {
+        *c *= scale;
     }
     Ok(BetweennessResult {
-        node_ids: result_nodes,
-        centralities: result_cent,
+        node_ids: csr.ids().to_vec(),
+        centralities,
     })
 }
 
@@ -258,46 +334,44 @@ pub struct ClosenessResult {
 }
 
 /// Compute closeness centrality.
-pub fn compute_closeness(src: &[i64], dst: &[i64]) -> Result<ClosenessResult> {
-    if src.len() != dst.len() {
-        return Err(OnagerError::InvalidArgument(
-            "src and dst arrays must have same length".to_string(),
-        ));
-    }
-    if src.is_empty() {
+///
+/// `weights` is either empty or holds one positive weight per edge.
+pub fn compute_closeness(src: &[i64], dst: &[i64], weights: &[f64]) -> Result<ClosenessResult> {
+    let csr = cache::csr_from_edges(src, dst, (!weights.is_empty()).then_some(weights), false)?;
+    compute_closeness_csr(&csr)
+}
+
+/// Compute closeness centrality on a prebuilt CSR graph.
+///
+/// Runs one search per node in parallel and treats edges as undirected. A node that
+/// reaches r nodes, itself included, at a total distance d scores (r - 1) / d,
+/// scaled by (r - 1) / (n - 1) so that nodes in small components are not favored.
+/// Distances follow the CSR's edge weights when any of them is not 1.0, and every
+/// weight must then be positive.
+pub fn compute_closeness_csr(csr: &CsrGraph) -> Result<ClosenessResult> {
+    if csr.edge_count() == 0 {
         return Err(OnagerError::InvalidArgument(
             "Cannot compute closeness on empty graph".to_string(),
         ));
     }
 
-    let mut node_set: HashMap<i64, NodeId> = HashMap::new();
-    let mut graph: Graph<i64, OrderedFloat<f64>> = Graph::new();
-    for &node in src.iter().chain(dst.iter()) {
-        if !node_set.contains_key(&node) {
-            let id = graph.add_node(node);
-            node_set.insert(node, id);
-        }
-    }
-    for i in 0..src.len() {
-        let src_id = *node_set.get(&src[i]).ok_or_else(|| {
-            OnagerError::InvalidArgument(format!("Source node {} not found in graph", src[i]))
-        })?;
-        let dst_id = *node_set.get(&dst[i]).ok_or_else(|| {
-            OnagerError::InvalidArgument(format!("Destination node {} not found in graph", dst[i]))
-        })?;
-        graph.add_edge(src_id, dst_id, OrderedFloat(1.0));
-    }
-    let centralities =
-        closeness_centrality(&graph).map_err(|e| OnagerError::GraphError(e.to_string()))?;
-    let mut result_nodes = Vec::with_capacity(node_set.len());
-    let mut result_cent = Vec::with_capacity(node_set.len());
-    for (ext_id, int_id) in &node_set {
-        result_nodes.push(*ext_id);
-        result_cent.push(*centralities.get(int_id).unwrap_or(&0.0));
+    let n = csr.node_count();
+    let weighted = csr.is_weighted();
+    if weighted {
+        check_path_weights(csr, "closeness")?;
     }
+    let centralities = per_source_paths(csr, weighted, |search| {
+        let reached = search.order().len() as f64 - 1.0;
+        let total: f64 = search.order().iter().map(|&v| search.distance(v)).sum();
+        if total > 0.0 && n > 1 {
+            (reached / total) * (reached / (n - 1) as f64)
+        } else {
+            0.0
+        }
+    })?;
     Ok(ClosenessResult {
-        node_ids: result_nodes,
-        centralities: result_cent,
+        node_ids: csr.ids().to_vec(),
+        centralities,
     })
 }
 
@@ -314,45 +388,27 @@ pub fn compute_eigenvector(
     max_iter: usize,
     tolerance: f64,
 ) -> Result<EigenvectorResult> {
-    if src.len() != dst.len() {
-        return Err(OnagerError::InvalidArgument(
-            "src and dst arrays must have same length".to_string(),
-        ));
-    }
-    if src.is_empty() {
+    let csr = cache::csr_from_edges(src, dst, None, false)?;
+    compute_eigenvector_csr(&csr, max_iter, tolerance)
+}
+
+/// Compute eigenvector centrality on a prebuilt CSR graph.
+pub fn compute_eigenvector_csr(
+    csr: &CsrGraph,
+    max_iter: usize,
+    tolerance: f64,
+) -> Result<EigenvectorResult> {
+    if csr.edge_count() == 0 {
         return Err(OnagerError::InvalidArgument(
             "Cannot compute eigenvector on empty graph".to_string(),
         ));
     }
 
-    let mut node_set: HashMap<i64, NodeId> = HashMap::new();
-    let mut graph: Graph<i64, f64> = Graph::new();
-    for &node in src.iter().chain(dst.iter()) {
-        if !node_set.contains_key(&node) {
-            let id = graph.add_node(node);
-            node_set.insert(node, id);
-        }
-    }
-    for i in 0..src.len() {
-        let src_id = *node_set.get(&src[i]).ok_or_else(|| {
-            OnagerError::InvalidArgument(format!("Source node {} not found in graph", src[i]))
-        })?;
-        let dst_id = *node_set.get(&dst[i]).ok_or_else(|| {
-            OnagerError::InvalidArgument(format!("Destination node {} not found in graph", dst[i]))
-        })?;
-        graph.add_edge(src_id, dst_id, 1.0);
-    }
-    let centralities = eigenvector_centrality(&graph, max_iter, tolerance)
-        .map_err(|e| OnagerError::GraphError(e.to_string()))?;
-    let mut result_nodes = Vec::with_capacity(node_set.len());
-    let mut result_cent = Vec::with_capacity(node_set.len());
-    for (ext_id, int_id) in &node_set {
-        result_nodes.push(*ext_id);
-        result_cent.push(*centralities.get(int_id).unwrap_or(&0.0));
-    }
+    let graph = PullGraph::new(csr, true, false);
+    let run = power::eigenvector(&graph, max_iter, tolerance)?;
     Ok(EigenvectorResult {
-        node_ids: result_nodes,
-        centralities: result_cent,
+        node_ids: csr.ids().to_vec(),
+        centralities: run.values,
     })
 }
 
@@ -370,45 +426,35 @@ pub fn compute_katz(
     max_iter: usize,
     tolerance: f64,
 ) -> Result<KatzResult> {
-    if src.len() != dst.len() {
-        return Err(OnagerError::InvalidArgument(
-            "src and dst arrays must have same length".to_string(),
-        ));
-    }
-    if src.is_empty() {
+    let csr = cache::csr_from_edges(src, dst, None, false)?;
+    compute_katz_csr(&csr, alpha, max_iter, tolerance)
+}
+
+/// Compute Katz centrality on a prebuilt CSR graph.
+pub fn compute_katz_csr(
+    csr: &CsrGraph,
+    alpha: f64,
+    max_iter: usize,
+    tolerance: f64,
+) -> Result<KatzResult> {
+    if csr.edge_count() == 0 {
         return Err(OnagerError::InvalidArgument(
             "Cannot compute Katz on empty graph".to_string(),
         ));
     }
 
-    let mut node_set: HashMap<i64, NodeId> = HashMap::new();
-    let mut graph: Graph<i64, f64> = Graph::new();
-    for &node in src.iter().chain(dst.iter()) {
-        if !node_set.contains_key(&node) {
-            let id = graph.add_node(node);
-            node_set.insert(node, id);
-        }
-    }
-    for i in 0..src.len() {
-        let src_id = *node_set.get(&src[i]).ok_or_else(|| {
-            OnagerError::InvalidArgument(format!("Source node {} not found in graph", src[i]))
-        })?;
-        let dst_id = *node_set.get(&dst[i]).ok_or_else(|| {
-            OnagerError::InvalidArgument(format!("Destination node {} not found in graph", dst[i]))
-        })?;
-        graph.add_edge(src_id, dst_id, 1.0);
-    }
-    let centralities = katz_centrality(&graph, alpha, None, max_iter, tolerance)
-        .map_err(|e| OnagerError::GraphError(e.to_string()))?;
-    let mut result_nodes = Vec::with_capacity(node_set.len());
-    let mut result_cent = Vec::with_capacity(node_set.len());
-    for (ext_id, int_id) in &node_set {
-        result_nodes.push(*ext_id);
-        result_cent.push(*centralities.get(int_id).unwrap_or(&0.0));
+    let graph = PullGraph::new(csr, true, false);
+    let run = power::katz(&graph, alpha, 1.0, max_iter, tolerance)?;
+    if !run.converged {
+        return Err(OnagerError::GraphError(format!(
+            "Katz centrality did not converge in {} iterations; alpha may be too large for this graph",
+            max_iter
+        )));
     }
+    let norm = run.values.iter().map(|x| x * x).sum::<f64>().sqrt();
     Ok(KatzResult {
-        node_ids: result_nodes,
-        centralities: result_cent,
+        node_ids: csr.ids().to_vec(),
+        centralities: run.values.into_iter().map(|x| x / norm).collect(),
     })
 }
 
@@ -420,46 +466,326 @@ pub struct HarmonicResult {
 
 /// Compute harmonic centrality.
 pub fn compute_harmonic(src: &[i64], dst: &[i64]) -> Result<HarmonicResult> {
-    if src.len() != dst.len() {
-        return Err(OnagerError::InvalidArgument(
-            "src and dst arrays must have same length".to_string(),
-        ));
-    }
-    if src.is_empty() {
+    let csr = cache::csr_from_edges(src, dst, None, false)?;
+    compute_harmonic_csr(&csr)
+}
+
+/// Compute harmonic centrality on a prebuilt CSR graph.
+///
+/// Runs one BFS per node in parallel, treats edges as undirected, and sums the
+/// inverse distances to every reachable node.
+pub fn compute_harmonic_csr(csr: &CsrGraph) -> Result<HarmonicResult> {
+    if csr.edge_count() == 0 {
         return Err(OnagerError::InvalidArgument(
             "Cannot compute harmonic on empty graph".to_string(),
         ));
     }
 
-    let mut node_set: HashMap<i64, NodeId> = HashMap::new();
-    let mut graph: Graph<i64, OrderedFloat<f64>> = Graph::new();
-    for &node in src.iter().chain(dst.iter()) {
-        if !node_set.contains_key(&node) {
-            let id = graph.add_node(node);
-            node_set.insert(node, id);
+    let centralities = per_source_paths(csr, false, |search| {
+        search
+            .order()
+            .iter()
+            .skip(1)
+            .map(|&v| 1.0 / search.distance(v))
+            .sum()
+    })?;
+    Ok(HarmonicResult {
+        node_ids: csr.ids().to_vec(),
+        centralities,
+    })
+}
+
+/// Sources per block for the parallel shortest-path engine.
+const SOURCE_BLOCK: usize = 64;
+
+/// Single-source shortest-path search that the parallel engine runs from every source.
+trait PathSearch {
+    /// Searches from `source`, counting shortest paths.
+    /// Only the entries touched by the previous source are reset.
+    fn search(&mut self, source: u32);
+
+    /// Adds the dependencies of the last source to `acc`, walking nodes in
+    /// reverse order of distance. Predecessors are found by distance instead of
+    /// being stored.
+    fn accumulate_dependencies(&mut self, source: u32, acc: &mut [f64]);
+
+    /// Returns the nodes the last search reached in order of distance, starting with the source.
+    fn order(&self) -> &[u32];
+
+    /// Returns the distance of a node the last search reached.
+    fn distance(&self, node: u32) -> f64;
+}
+
+/// Per-worker state for unweighted single-source shortest paths, reused across sources.
+struct PathScratch<'a> {
+    sets: &'a NeighborSets,
+    /// Hop distance from the current source, `u32::MAX` if unreached.
+    dist: Vec<u32>,
+    /// Number of shortest paths from the current source.
+    sigma: Vec<f64>,
+    /// Brandes dependency of the current source on each node.
+    delta: Vec<f64>,
+    /// Reached nodes in BFS order, starting with the source.
+    order: Vec<u32>,
+}
+
+impl<'a> PathScratch<'a> {
+    fn new(sets: &'a NeighborSets) -> Self {
+        let n = sets.node_count();
+        PathScratch {
+            sets,
+            dist: vec![u32::MAX; n],
+            sigma: vec![0.0; n],
+            delta: vec![0.0; n],
+            order: Vec::with_capacity(n),
         }
     }
-    for i in 0..src.len() {
-        let src_id = *node_set.get(&src[i]).ok_or_else(|| {
-            OnagerError::InvalidArgument(format!("Source node {} not found in graph", src[i]))
-        })?;
-        let dst_id = *node_set.get(&dst[i]).ok_or_else(|| {
-            OnagerError::InvalidArgument(format!("Destination node {} not found in graph", dst[i]))
-        })?;
-        graph.add_edge(src_id, dst_id, OrderedFloat(1.0));
-    }
-    let centralities =
-        harmonic_centrality(&graph).map_err(|e| OnagerError::GraphError(e.to_string()))?;
-    let mut result_nodes = Vec::with_capacity(node_set.len());
-    let mut result_cent = Vec::with_capacity(node_set.len());
-    for (ext_id, int_id) in &node_set {
-        result_nodes.push(*ext_id);
-        result_cent.push(*centralities.get(int_id).unwrap_or(&0.0));
+}
+
+impl PathSearch for PathScratch<'_> {
+    /// Runs a BFS from `source`.
+    fn search(&mut self, source: u32) {
+        for &v in &self.order {
+            let v = v as usize;
+            self.dist[v] = u32::MAX;
+            self.sigma[v] = 0.0;
+            self.delta[v] = 0.0;
+        }
+        self.order.clear();
+        self.dist[source as usize] = 0;
+        self.sigma[source as usize] = 1.0;
+        self.order.push(source);
+        let mut head = 0;
+        while head < self.order.len() {
+            let v = self.order[head];
+            head += 1;
+            let next = self.dist[v as usize] + 1;
+            for &w in self.sets.get(v) {
+                let w = w as usize;
+                if self.dist[w] == u32::MAX {
+                    self.dist[w] = next;
+                    self.order.push(w as u32);
+                }
+                if self.dist[w] == next {
+                    self.sigma[w] += self.sigma[v as usize];
+                }
+            }
+        }
     }
-    Ok(HarmonicResult {
-        node_ids: result_nodes,
-        centralities: result_cent,
-    })
+
+    fn accumulate_dependencies(&mut self, source: u32, acc: &mut [f64]) {
+        for &w in self.order.iter().rev() {
+            let w = w as usize;
+            let dw = self.dist[w];
+            if dw == 0 {
+                continue;
+            }
+            let share = (1.0 + self.delta[w]) / self.sigma[w];
+            for &v in self.sets.get(w as u32) {
+                let v = v as usize;
+                if self.dist[v] == dw - 1 {
+                    self.delta[v] += self.sigma[v] * share;
+                }
+            }
+            if w != source as usize {
+                acc[w] += self.delta[w];
+            }
+        }
+    }
+
+    fn order(&self) -> &[u32] {
+        &self.order
+    }
+
+    fn distance(&self, node: u32) -> f64 {
+        f64::from(self.dist[node as usize])
+    }
+}
+
+/// Per-worker state for weighted single-source shortest paths, reused across sources.
+///
+/// Weights must be positive, so that every node is settled after the
+/// predecessors on its shortest paths and its path count is final by then.
+struct WeightedPathScratch<'a> {
+    sets: &'a WeightedSets,
+    /// Distance from the current source, infinite if unreached.
+    dist: Vec<f64>,
+    /// Number of shortest paths from the current source.
+    sigma: Vec<f64>,
+    /// Brandes dependency of the current source on each node.
+    delta: Vec<f64>,
+    /// Reached nodes in the order Dijkstra settled them, starting with the source.
+    order: Vec<u32>,
+    heap: BinaryHeap<Reverse<(OrderedFloat<f64>, u32)>>,
+}
+
+impl<'a> WeightedPathScratch<'a> {
+    fn new(sets: &'a WeightedSets) -> Self {
+        let n = sets.node_count();
+        WeightedPathScratch {
+            sets,
+            dist: vec![f64::INFINITY; n],
+            sigma: vec![0.0; n],
+            delta: vec![0.0; n],
+            order: Vec::with_capacity(n),
+            heap: BinaryHeap::new(),
+        }
+    }
+}
+
+impl PathSearch for WeightedPathScratch<'_> {
+    /// Runs Dijkstra from `source`. Every node it reaches is settled, so the
+    /// settled order covers all the entries to reset.
+    fn search(&mut self, source: u32) {
+        for &v in &self.order {
+            let v = v as usize;
+            self.dist[v] = f64::INFINITY;
+            self.sigma[v] = 0.0;
+            self.delta[v] = 0.0;
+        }
+        self.order.clear();
+        self.heap.clear();
+        self.dist[source as usize] = 0.0;
+        self.sigma[source as usize] = 1.0;
+        self.heap.push(Reverse((OrderedFloat(0.0), source)));
+        while let Some(Reverse((OrderedFloat(d), v))) = self.heap.pop() {
+            if d > self.dist[v as usize] {
+                continue;
+            }
+            self.order.push(v);
+            let (neighbors, weights) = self.sets.get(v);
+            for (&w, &weight) in neighbors.iter().zip(weights) {
+                let w = w as usize;
+                let nd = d + weight;
+                if nd < self.dist[w] {
+                    self.dist[w] = nd;
+                    self.sigma[w] = self.sigma[v as usize];
+                    self.heap.push(Reverse((OrderedFloat(nd), w as u32)));
+                } else if nd == self.dist[w] {
+                    self.sigma[w] += self.sigma[v as usize];
+                }
+            }
+        }
+    }
+
+    fn accumulate_dependencies(&mut self, source: u32, acc: &mut [f64]) {
+        for &w in self.order.iter().rev() {
+            let w = w as usize;
+            if w == source as usize {
+                continue;
+            }
+            let share = (1.0 + self.delta[w]) / self.sigma[w];
+            let (neighbors, weights) = self.sets.get(w as u32);
+            for (&v, &weight) in neighbors.iter().zip(weights) {
+                let v = v as usize;
+                if self.dist[v] + weight == self.dist[w] {
+                    self.delta[v] += self.sigma[v] * share;
+                }
+            }
+            acc[w] += self.delta[w];
+        }
+    }
+
+    fn order(&self) -> &[u32] {
+        &self.order
+    }
+
+    fn distance(&self, node: u32) -> f64 {
+        self.dist[node as usize]
+    }
+}
+
+/// Fails unless every edge weight of the CSR is positive and finite, as the
+/// weighted shortest-path engine requires.
+fn check_path_weights(csr: &CsrGraph, algorithm: &str) -> Result<()> {
+    match csr.find_weight(|w| !(w > 0.0 && w.is_finite())) {
+        Some(w) => Err(OnagerError::InvalidArgument(format!(
+            "Weighted {} requires positive edge weights, found {}",
+            algorithm, w
+        ))),
+        None => Ok(()),
+    }
+}
+
+/// Sums the dependencies of every source in `sources` in parallel, with one
+/// accumulator per worker that is summed at the end.
+///
+/// Blocks of sources are skipped once the query is interrupted, and the call then fails.
+fn dependency_sums<S: PathSearch + Send>(
+    n: usize,
+    sources: &[u32],
+    init: impl Fn() -> S + Sync,
+) -> Result<Vec<f64>> {
+    let done = AtomicUsize::new(0);
+    let partials = fold_blocks(
+        sources.len(),
+        SOURCE_BLOCK,
+        || (init(), vec![0.0; n]),
+        |(scratch, acc), range| {
+            if control::interrupted() {
+                return;
+            }
+            let count = range.len();
+            for &source in &sources[range] {
+                scratch.search(source);
+                scratch.accumulate_dependencies(source, acc);
+            }
+            control::report(
+                done.fetch_add(count, Ordering::Relaxed) + count,
+                sources.len(),
+            );
+        },
+    );
+    control::check()?;
+    let mut sums = vec![0.0; n];
+    for (_, acc) in partials {
+        for (c, a) in sums.iter_mut().zip(acc) {
+            *c += a;
+        }
+    }
+    Ok(sums)
+}
+
+/// Runs a search from every node in parallel and maps each finished search to a score.
+///
+/// Searches follow the edge weights with `weighted`, and count hops otherwise.
+/// Blocks of sources are skipped once the query is interrupted, and the call then fails.
+fn per_source_paths(
+    csr: &CsrGraph,
+    weighted: bool,
+    score: impl Fn(&dyn PathSearch) -> f64 + Sync,
+) -> Result<Vec<f64>> {
+    if weighted {
+        let sets = WeightedSets::from_csr(csr);
+        map_sources(csr.node_count(), || WeightedPathScratch::new(&sets), &score)
+    } else {
+        let sets = NeighborSets::from_csr(csr);
+        map_sources(csr.node_count(), || PathScratch::new(&sets), &score)
+    }
+}
+
+fn map_sources<S: PathSearch + Send>(
+    n: usize,
+    init: impl Fn() -> S + Sync,
+    score: &(impl Fn(&dyn PathSearch) -> f64 + Sync),
+) -> Result<Vec<f64>> {
+    let done = AtomicUsize::new(0);
+    let blocks = map_blocks(n, SOURCE_BLOCK, init, |scratch, sources| {
+        if control::interrupted() {
+            return Vec::new();
+        }
+        let count = sources.len();
+        let scores = sources
+            .map(|source| {
+                scratch.search(source as u32);
+                score(scratch)
+            })
+            .collect::<Vec<f64>>();
+        control::report(done.fetch_add(count, Ordering::Relaxed) + count, n);
+        scores
+    });
+    control::check()?;
+    Ok(blocks.into_iter().flatten().collect())
 }
 
 /// Result of single-node degree computation.
@@ -528,30 +854,13 @@ pub fn compute_voterank(src: &[i64], dst: &[i64], num_seeds: usize) -> Result<Vo
         });
     }
 
-    let mut node_set: HashMap<i64, NodeId> = HashMap::new();
-    let mut reverse_map: HashMap<NodeId, i64> = HashMap::new();
-    let mut graph: Graph<i64, f64> = Graph::new();
-    for &node in src.iter().chain(dst.iter()) {
-        if !node_set.contains_key(&node) {
-            let id = graph.add_node(node);
-            node_set.insert(node, id);
-            reverse_map.insert(id, node);
-        }
-    }
-    for i in 0..src.len() {
-        let src_id = *node_set.get(&src[i]).ok_or_else(|| {
-            OnagerError::InvalidArgument(format!("Source node {} not found in graph", src[i]))
-        })?;
-        let dst_id = *node_set.get(&dst[i]).ok_or_else(|| {
-            OnagerError::InvalidArgument(format!("Destination node {} not found in graph", dst[i]))
-        })?;
-        graph.add_edge(src_id, dst_id, 1.0);
-    }
+    let csr = cache::csr_from_edges(src, dst, None, false)?;
+    let (graph, node_index) = csr.to_graph(|_| 1.0)?;
 
     let seeds = voterank(&graph, num_seeds);
     let mut result_nodes = Vec::with_capacity(seeds.len());
     for node_id in seeds {
-        if let Some(&ext_id) = reverse_map.get(&node_id) {
+        if let Some(&ext_id) = node_index.external_id(&node_id) {
             result_nodes.push(ext_id);
         }
     }
@@ -586,32 +895,15 @@ pub fn compute_local_reaching(
         });
     }
 
-    let mut node_set: HashMap<i64, NodeId> = HashMap::new();
-    let mut reverse_map: HashMap<NodeId, i64> = HashMap::new();
-    let mut graph: Graph<i64, f64> = Graph::new();
-    for &node in src.iter().chain(dst.iter()) {
-        if !node_set.contains_key(&node) {
-            let id = graph.add_node(node);
-            node_set.insert(node, id);
-            reverse_map.insert(id, node);
-        }
-    }
-    for i in 0..src.len() {
-        let src_id = *node_set.get(&src[i]).ok_or_else(|| {
-            OnagerError::InvalidArgument(format!("Source node {} not found in graph", src[i]))
-        })?;
-        let dst_id = *node_set.get(&dst[i]).ok_or_else(|| {
-            OnagerError::InvalidArgument(format!("Destination node {} not found in graph", dst[i]))
-        })?;
-        graph.add_edge(src_id, dst_id, 1.0);
-    }
+    let csr = cache::csr_from_edges(src, dst, None, false)?;
+    let (graph, node_index) = csr.to_graph(|_| 1.0)?;
 
     let centrality_map = local_reaching_centrality(&graph, distance)
         .map_err(|e| OnagerError::GraphError(e.to_string()))?;
 
-    let mut result_nodes = Vec::with_capacity(node_set.len());
-    let mut result_centrality = Vec::with_capacity(node_set.len());
-    for (ext_id, int_id) in &node_set {
+    let mut result_nodes = Vec::with_capacity(node_index.len());
+    let mut result_centrality = Vec::with_capacity(node_index.len());
+    for (ext_id, int_id) in node_index.iter() {
         result_nodes.push(*ext_id);
         result_centrality.push(*centrality_map.get(int_id).unwrap_or(&0.0));
     }
@@ -643,32 +935,15 @@ pub fn compute_laplacian(src: &[i64], dst: &[i64]) -> Result<LaplacianResult> {
         });
     }
 
-    let mut node_set: HashMap<i64, NodeId> = HashMap::new();
-    let mut reverse_map: HashMap<NodeId, i64> = HashMap::new();
-    let mut graph: Graph<i64, f64> = Graph::new();
-    for &node in src.iter().chain(dst.iter()) {
-        if !node_set.contains_key(&node) {
-            let id = graph.add_node(node);
-            node_set.insert(node, id);
-            reverse_map.insert(id, node);
-        }
-    }
-    for i in 0..src.len() {
-        let src_id = *node_set.get(&src[i]).ok_or_else(|| {
-            OnagerError::InvalidArgument(format!("Source node {} not found in graph", src[i]))
-        })?;
-        let dst_id = *node_set.get(&dst[i]).ok_or_else(|| {
-            OnagerError::InvalidArgument(format!("Destination node {} not found in graph", dst[i]))
-        })?;
-        graph.add_edge(src_id, dst_id, 1.0);
-    }
+    let csr = cache::csr_from_edges(src, dst, None, false)?;
+    let (graph, node_index) = csr.to_graph(|_| 1.0)?;
 
     let centrality_map =
         laplacian_centrality(&graph).map_err(|e| OnagerError::GraphError(e.to_string()))?;
 
-    let mut result_nodes = Vec::with_capacity(node_set.len());
-    let mut result_centrality = Vec::with_capacity(node_set.len());
-    for (ext_id, int_id) in &node_set {
+    let mut result_nodes = Vec::with_capacity(node_index.len());
+    let mut result_centrality = Vec::with_capacity(node_index.len());
+    for (ext_id, int_id) in node_index.iter() {
         result_nodes.push(*ext_id);
         result_centrality.push(*centrality_map.get(int_id).unwrap_or(&0.0));
     }
@@ -696,7 +971,7 @@ mod tests {
     #[test]
     fn test_pagerank_triangle() {
         let (src, dst) = triangle_graph();
-        let result = compute_pagerank(&src, &dst, &[], 0.85, 100, false).unwrap();
+        let result = compute_pagerank(&src, &dst, &[], 0.85, 100, 1e-6, false).unwrap();
 
         assert_eq!(result.node_ids.len(), 3);
         assert_eq!(result.ranks.len(), 3);
@@ -708,12 +983,85 @@ mod tests {
     #[test]
     fn test_pagerank_directed() {
         let (src, dst) = triangle_graph();
-        let result = compute_pagerank(&src, &dst, &[], 0.85, 100, true).unwrap();
+        let result = compute_pagerank(&src, &dst, &[], 0.85, 100, 1e-6, true).unwrap();
 
         assert_eq!(result.node_ids.len(), 3);
         assert!(!result.ranks.is_empty());
     }
 
+    #[test]
+    fn test_pagerank_dangling_node() {
+        // 1 -> 2 and 2 has no out-edges, so its rank is spread uniformly
+        let result = compute_pagerank(&[1], &[2], &[], 0.85, 100, 1e-10, true).unwrap();
+        assert_eq!(result.node_ids, vec![1, 2]);
+        assert!((result.ranks[0] - 0.350877).abs() < 1e-5);
+        assert!((result.ranks[1] - 0.649123).abs() < 1e-5);
+        assert!(result.iterations < 100);
+    }
+
+    #[test]
+    fn test_pagerank_zero_tolerance_runs_every_pass() {
+        let (src, dst) = star_graph();
+        let result = compute_pagerank(&src, &dst, &[], 0.85, 7, 0.0, false).unwrap();
+        assert_eq!(result.iterations, 7);
+    }
+
+    fn random_edges(n: u64, m: usize, seed: u64) -> (Vec<i64>, Vec<i64>) {
+        let mut rng = SplitMix64::new(seed);
+        (0..m)
+            .map(|_| (rng.below(n) as i64, rng.below(n) as i64))
+            .unzip()
+    }
+
+    #[test]
+    fn test_pagerank_prior_converges_faster() {
+        let (mut src, mut dst) = random_edges(500, 3000, 7);
+        let csr = CsrGraph::from_edges(&src, &dst, None, true).unwrap();
+        let before = compute_pagerank_csr(&csr, 0.85, 200, 1e-9, &[]).unwrap();
+
+        src.push(3);
+        dst.push(11);
+        let csr = CsrGraph::from_edges(&src, &dst, None, true).unwrap();
+        let cold = compute_pagerank_csr(&csr, 0.85, 200, 1e-9, &[]).unwrap();
+        let prior: Vec<(i64, f64)> = before
+            .node_ids
+            .iter()
+            .copied()
+            .zip(before.ranks.iter().copied())
+            .collect();
+        let warm = compute_pagerank_csr(&csr, 0.85, 200, 1e-9, &prior).unwrap();
+
+        assert!(warm.iterations < cold.iterations);
+        assert_eq!(warm.node_ids, cold.node_ids);
+        for (w, c) in warm.ranks.iter().zip(&cold.ranks) {
+            assert!((w - c).abs() < 1e-6);
+        }
+    }
+
+    #[test]
+    fn test_pagerank_prior_fills_missing_nodes() {
+        let (src, dst) = triangle_graph();
+        let csr = CsrGraph::from_edges(&src, &dst, None, true).unwrap();
+        // Node 9 is not in the graph and nodes 2 and 3 are missing from the prior
+        let result = compute_pagerank_csr(&csr, 0.85, 100, 1e-9, &[(1, 0.5), (9, 0.5)]).unwrap();
+        let sum: f64 = result.ranks.iter().sum();
+        assert!((sum - 1.0).abs() < 1e-9);
+        for rank in &result.ranks {
+            assert!((rank - 1.0 / 3.0).abs() < 1e-6);
+        }
+    }
+
+    #[test]
+    fn test_pagerank_invalid_arguments() {
+        let (src, dst) = triangle_graph();
+        assert!(compute_pagerank(&src, &dst, &[], 1.0, 100, 1e-6, true).is_err());
+        assert!(compute_pagerank(&src, &dst, &[], 0.85, 0, 1e-6, true).is_err());
+        assert!(compute_pagerank(&src, &dst, &[], 0.85, 100, -1.0, true).is_err());
+        let csr = CsrGraph::from_edges(&src, &dst, None, true).unwrap();
+        assert!(compute_pagerank_csr(&csr, 0.85, 100, 1e-6, &[(1, -0.5)]).is_err());
+        assert!(compute_pagerank_csr(&csr, 0.85, 100, 1e-6, &[(1, f64::NAN)]).is_err());
+    }
+
     #[test]
     fn test_degree_undirected() {
         let (src, dst) = star_graph();
@@ -738,7 +1086,7 @@ mod tests {
         // Path graph: 1-2-3-4 (node 2 and 3 have high betweenness)
         let src = vec![1, 2, 3];
         let dst = vec![2, 3, 4];
-        let result = compute_betweenness(&src, &dst, true).unwrap();
+        let result = compute_betweenness(&src, &dst, &[], true).unwrap();
 
         assert_eq!(result.node_ids.len(), 4);
         assert!(!result.centralities.is_empty());
@@ -747,7 +1095,7 @@ mod tests {
     #[test]
     fn test_closeness() {
         let (src, dst) = triangle_graph();
-        let result = compute_closeness(&src, &dst).unwrap();
+        let result = compute_closeness(&src, &dst, &[]).unwrap();
 
         assert_eq!(result.node_ids.len(), 3);
         // All nodes in triangle should have equal closeness
@@ -801,14 +1149,14 @@ mod tests {
     #[test]
     fn test_empty_graph_returns_empty() {
         // Empty graph returns empty results (not an error)
-        let result = compute_pagerank(&[], &[], &[], 0.85, 100, false).unwrap();
+        let result = compute_pagerank(&[], &[], &[], 0.85, 100, 1e-6, false).unwrap();
         assert!(result.node_ids.is_empty());
         assert!(result.ranks.is_empty());
     }
 
     #[test]
     fn test_mismatched_arrays_error() {
-        let result = compute_pagerank(&[1, 2], &[2], &[], 0.85, 100, false);
+        let result = compute_pagerank(&[1, 2], &[2], &[], 0.85, 100, 1e-6, false);
         assert!(result.is_err());
     }
 
@@ -849,4 +1197,100 @@ mod tests {
         let result = compute_laplacian(&[], &[]).unwrap();
         assert!(result.node_ids.is_empty());
     }
+
+    fn assert_close(actual: &[f64], expected: &[f64]) {
+        assert_eq!(actual.len(), expected.len());
+        for (a, e) in actual.iter().zip(expected) {
+            assert!((a - e).abs() < 1e-9, "{:?} != {:?}", actual, expected);
+        }
+    }
+
+    #[test]
+    fn test_betweenness_values() {
+        // Path graph: 1-2-3-4
+        let (src, dst) = (vec![1, 2, 3], vec![2, 3, 4]);
+        let raw = compute_betweenness(&src, &dst, &[], false).unwrap();
+        assert_close(&raw.centralities, &[0.0, 2.0, 2.0, 0.0]);
+        let normalized = compute_betweenness(&src, &dst, &[], true).unwrap();
+        assert_close(&normalized.centralities, &[0.0, 2.0 / 3.0, 2.0 / 3.0, 0.0]);
+
+        // Star with hub 1 and four leaves, plus a duplicate edge that must not count twice
+        let (src, dst) = (vec![1, 1, 1, 1, 2], vec![2, 3, 4, 5, 1]);
+        let star = compute_betweenness(&src, &dst, &[], false).unwrap();
+        assert_close(&star.centralities, &[6.0, 0.0, 0.0, 0.0, 0.0]);
+    }
+
+    #[test]
+    fn test_betweenness_sampled() {
+        let (src, dst) = star_graph();
+        let exact = compute_betweenness(&src, &dst, &[], true).unwrap();
+        let all = compute_betweenness_sampled(&src, &dst, &[], true, 100, 7).unwrap();
+        assert_close(&all.centralities, &exact.centralities);
+
+        let src: Vec<i64> = (0..200).collect();
+        let dst: Vec<i64> = (1..201).collect();
+        let a = compute_betweenness_sampled(&src, &dst, &[], false, 20, 7).unwrap();
+        let b = compute_betweenness_sampled(&src, &dst, &[], false, 20, 7).unwrap();
+        assert_close(&a.centralities, &b.centralities);
+        assert!(a.centralities.iter().sum::<f64>() > 0.0);
+        assert!(compute_betweenness_sampled(&src, &dst, &[], false, 0, 7).is_err());
+    }
+
+    #[test]
+    fn test_closeness_and_harmonic_values() {
+        let (src, dst) = (vec![1, 2, 3], vec![2, 3, 4]);
+        let closeness = compute_closeness(&src, &dst, &[]).unwrap();
+        assert_close(&closeness.centralities, &[0.5, 0.75, 0.75, 0.5]);
+        let harmonic = compute_harmonic(&src, &dst).unwrap();
+        let end = 1.0 + 0.5 + 1.0 / 3.0;
+        assert_close(&harmonic.centralities, &[end, 2.5, 2.5, end]);
+
+        // Two components: each node reaches one of the three other nodes
+        let closeness = compute_closeness(&[1, 3], &[2, 4], &[]).unwrap();
+        assert_close(&closeness.centralities, &[1.0 / 3.0; 4]);
+    }
+
+    #[test]
+    fn test_weighted_paths_follow_weights() {
+        // Triangle where the direct edge 1-3 is longer than the detour through 2
+        let (src, dst, weights) = (vec![1, 2, 1], vec![2, 3, 3], vec![1.0, 1.0, 5.0]);
+        let unweighted = compute_betweenness(&src, &dst, &[], false).unwrap();
+        assert_close(&unweighted.centralities, &[0.0; 3]);
+        let weighted = compute_betweenness(&src, &dst, &weights, false).unwrap();
+        assert_close(&weighted.centralities, &[0.0, 1.0, 0.0]);
+        let closeness = compute_closeness(&src, &dst, &weights).unwrap();
+        assert_close(&closeness.centralities, &[2.0 / 3.0, 1.0, 2.0 / 3.0]);
+
+        let negative = compute_betweenness(&src, &dst, &[1.0, 0.0, 5.0], false);
+        assert!(negative.is_err_and(|e| e.to_string().contains("positive edge weights")));
+        assert!(compute_closeness(&src, &dst, &[1.0, f64::NAN, 5.0]).is_err());
+    }
+
+    #[test]
+    fn test_uniform_weights_match_hop_counts() {
+        // A grid has many tied shortest paths, which weighted counting must match
+        let side = 6i64;
+        let (mut src, mut dst) = (Vec::new(), Vec::new());
+        for r in 0..side {
+            for c in 0..side {
+                let u = r * side + c;
+                if c + 1 < side {
+                    src.push(u);
+                    dst.push(u + 1);
+                }
+                if r + 1 < side {
+                    src.push(u);
+                    dst.push(u + side);
+                }
+            }
+        }
+        let weights = vec![2.0; src.len()];
+        let hops = compute_betweenness(&src, &dst, &[], true).unwrap();
+        let weighted = compute_betweenness(&src, &dst, &weights, true).unwrap();
+        assert_close(&weighted.centralities, &hops.centralities);
+        let hops = compute_closeness(&src, &dst, &[]).unwrap();
+        let weighted = compute_closeness(&src, &dst, &weights).unwrap();
+        let halved: Vec<f64> = hops.centralities.iter().map(|c| c / 2.0).collect();
+        assert_close(&weighted.centralities, &halved);
+    }
 }
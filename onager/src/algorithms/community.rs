@@ -8,10 +8,35 @@ use graphina::community::infomap::infomap;
 use graphina::community::label_propagation::label_propagation;
 use graphina::community::louvain::louvain;
 use graphina::community::spectral::spectral_clustering;
-use graphina::core::types::{Graph, NodeId};
+use graphina::core::types::NodeId;
 
+use crate::cache;
+use crate::csr::{CsrGraph, NodeIndex};
 use crate::error::{OnagerError, Result};
-use std::collections::HashMap;
+
+/// Numbers graphina's communities in the order it returns them and lists their members by node.
+///
+/// Returns the external ID and community number of every member, in node ID
+/// order rather than grouped by community.
+fn members_by_node<'a, C>(node_index: &NodeIndex, communities: &'a [C]) -> (Vec<i64>, Vec<i64>)
+where
+    &'a C: IntoIterator<Item = &'a NodeId>,
+{
+    let mut labels = vec![-1i64; node_index.len()];
+    for (label, community) in communities.iter().enumerate() {
+        for node in community {
+            if let Some(u) = node_index.dense_id(node) {
+                labels[u as usize] = label as i64;
+            }
+        }
+    }
+    node_index
+        .iter()
+        .zip(labels)
+        .filter(|&(_, label)| label >= 0)
+        .map(|((&id, _), label)| (id, label))
+        .unzip()
+}
 
 /// Result of Louvain community detection.
 pub struct LouvainResult {
@@ -20,50 +45,37 @@ pub struct LouvainResult {
 }
 
 /// Compute Louvain community detection.
-pub fn compute_louvain(src: &[i64], dst: &[i64], seed: Option<u64>) -> Result<LouvainResult> {
-    if src.len() != dst.len() {
+///
+/// `weights` is either empty or holds one non-negative weight per edge.
+pub fn compute_louvain(
+    src: &[i64],
+    dst: &[i64],
+    weights: &[f64],
+    seed: Option<u64>,
+) -> Result<LouvainResult> {
+    let csr = cache::csr_from_edges(src, dst, (!weights.is_empty()).then_some(weights), false)?;
+    compute_louvain_csr(&csr, seed)
+}
+
+/// Compute Louvain community detection on a prebuilt CSR graph.
+///
+/// The CSR's edge weights are used when it has them.
+pub fn compute_louvain_csr(csr: &CsrGraph, seed: Option<u64>) -> Result<LouvainResult> {
+    if csr.edge_count() == 0 {
         return Err(OnagerError::InvalidArgument(
-            "src and dst arrays must have same length".to_string(),
+            "Cannot compute on empty graph".to_string(),
         ));
     }
-    if src.is_empty() {
+    if csr.find_weight(|w| !w.is_finite() || w < 0.0).is_some() {
         return Err(OnagerError::InvalidArgument(
-            "Cannot compute on empty graph".to_string(),
+            "Louvain requires non-negative edge weights".to_string(),
         ));
     }
 
-    let mut node_set: HashMap<i64, NodeId> = HashMap::new();
-    let mut reverse_map: HashMap<NodeId, i64> = HashMap::new();
-    let mut graph: Graph<i64, f64> = Graph::new();
-
-    for &node in src.iter().chain(dst.iter()) {
-        if !node_set.contains_key(&node) {
-            let id = graph.add_node(node);
-            node_set.insert(node, id);
-            reverse_map.insert(id, node);
-        }
-    }
-    for i in 0..src.len() {
-        let src_id = *node_set.get(&src[i]).ok_or_else(|| {
-            OnagerError::InvalidArgument(format!("Source node {} not found in graph", src[i]))
-        })?;
-        let dst_id = *node_set.get(&dst[i]).ok_or_else(|| {
-            OnagerError::InvalidArgument(format!("Destination node {} not found in graph", dst[i]))
-        })?;
-        graph.add_edge(src_id, dst_id, 1.0);
-    }
+    let (graph, node_index) = csr.to_graph(|w| w)?;
 
     let communities = louvain(&graph, seed).map_err(|e| OnagerError::GraphError(e.to_string()))?;
-    let mut result_nodes = Vec::new();
-    let mut result_comms = Vec::new();
-    for (comm_id, community) in communities.iter().enumerate() {
-        for &internal_id in community {
-            if let Some(&ext_id) = reverse_map.get(&internal_id) {
-                result_nodes.push(ext_id);
-                result_comms.push(comm_id as i64);
-            }
-        }
-    }
+    let (result_nodes, result_comms) = members_by_node(&node_index, &communities);
     Ok(LouvainResult {
         node_ids: result_nodes,
         community_ids: result_comms,
@@ -78,49 +90,22 @@ pub struct ConnectedComponentsResult {
 
 /// Compute connected components.
 pub fn compute_connected_components(src: &[i64], dst: &[i64]) -> Result<ConnectedComponentsResult> {
-    if src.len() != dst.len() {
-        return Err(OnagerError::InvalidArgument(
-            "src and dst arrays must have same length".to_string(),
-        ));
-    }
-    if src.is_empty() {
+    let csr = cache::csr_from_edges(src, dst, None, false)?;
+    compute_connected_components_csr(&csr)
+}
+
+/// Compute connected components on a prebuilt CSR graph.
+pub fn compute_connected_components_csr(csr: &CsrGraph) -> Result<ConnectedComponentsResult> {
+    if csr.edge_count() == 0 {
         return Err(OnagerError::InvalidArgument(
             "Cannot compute on empty graph".to_string(),
         ));
     }
 
-    let mut node_set: HashMap<i64, NodeId> = HashMap::new();
-    let mut reverse_map: HashMap<NodeId, i64> = HashMap::new();
-    let mut graph: Graph<i64, f64> = Graph::new();
-
-    for &node in src.iter().chain(dst.iter()) {
-        if !node_set.contains_key(&node) {
-            let id = graph.add_node(node);
-            node_set.insert(node, id);
-            reverse_map.insert(id, node);
-        }
-    }
-    for i in 0..src.len() {
-        let src_id = *node_set.get(&src[i]).ok_or_else(|| {
-            OnagerError::InvalidArgument(format!("Source node {} not found in graph", src[i]))
-        })?;
-        let dst_id = *node_set.get(&dst[i]).ok_or_else(|| {
-            OnagerError::InvalidArgument(format!("Destination node {} not found in graph", dst[i]))
-        })?;
-        graph.add_edge(src_id, dst_id, 1.0);
-    }
+    let (graph, node_index) = csr.to_graph(|_| 1.0)?;
 
     let components = connected_components(&graph);
-    let mut result_nodes = Vec::new();
-    let mut result_comps = Vec::new();
-    for (comp_id, component) in components.iter().enumerate() {
-        for &internal_id in component {
-            if let Some(&ext_id) = reverse_map.get(&internal_id) {
-                result_nodes.push(ext_id);
-                result_comps.push(comp_id as i64);
-            }
-        }
-    }
+    let (result_nodes, result_comps) = members_by_node(&node_index, &components);
     Ok(ConnectedComponentsResult {
         node_ids: result_nodes,
         component_ids: result_comps,
@@ -135,45 +120,28 @@ pub struct LabelPropagationResult {
 
 /// Compute label propagation community detection.
 pub fn compute_label_propagation(src: &[i64], dst: &[i64]) -> Result<LabelPropagationResult> {
-    if src.len() != dst.len() {
-        return Err(OnagerError::InvalidArgument(
-            "src and dst arrays must have same length".to_string(),
-        ));
-    }
-    if src.is_empty() {
+    let csr = cache::csr_from_edges(src, dst, None, false)?;
+    compute_label_propagation_csr(&csr)
+}
+
+/// Compute label propagation community detection on a prebuilt CSR graph.
+pub fn compute_label_propagation_csr(csr: &CsrGraph) -> Result<LabelPropagationResult> {
+    if csr.edge_count() == 0 {
         return Err(OnagerError::InvalidArgument(
             "Cannot compute on empty graph".to_string(),
         ));
     }
 
-    let mut node_set: HashMap<i64, NodeId> = HashMap::new();
-    let mut graph: Graph<i64, f64> = Graph::new();
-
-    for &node in src.iter().chain(dst.iter()) {
-        if !node_set.contains_key(&node) {
-            let id = graph.add_node(node);
-            node_set.insert(node, id);
-        }
-    }
-    for i in 0..src.len() {
-        let src_id = *node_set.get(&src[i]).ok_or_else(|| {
-            OnagerError::InvalidArgument(format!("Source node {} not found in graph", src[i]))
-        })?;
-        let dst_id = *node_set.get(&dst[i]).ok_or_else(|| {
-            OnagerError::InvalidArgument(format!("Destination node {} not found in graph", dst[i]))
-        })?;
-        graph.add_edge(src_id, dst_id, 1.0);
-    }
+    let (graph, node_index) = csr.to_graph(|_| 1.0)?;
 
     let labels_vec =
         label_propagation(&graph, 100, None).map_err(|e| OnagerError::GraphError(e.to_string()))?;
-    let reverse_map: HashMap<NodeId, i64> = node_set.iter().map(|(&k, &v)| (v, k)).collect();
     let node_list: Vec<NodeId> = graph.nodes().map(|(id, _)| id).collect();
 
     let mut node_ids = Vec::with_capacity(labels_vec.len());
     let mut labels = Vec::with_capacity(labels_vec.len());
     for (i, label) in labels_vec.into_iter().enumerate() {
-        if let Some(&ext_id) = reverse_map.get(&node_list[i]) {
+        if let Some(&ext_id) = node_index.external_id(&node_list[i]) {
             node_ids.push(ext_id);
             labels.push(label as i64);
         }
@@ -210,40 +178,13 @@ pub fn compute_girvan_newman(
         ));
     }
 
-    let mut node_set: HashMap<i64, NodeId> = HashMap::new();
-    let mut reverse_map: HashMap<NodeId, i64> = HashMap::new();
-    let mut graph: Graph<i64, f64> = Graph::new();
-
-    for &node in src.iter().chain(dst.iter()) {
-        if !node_set.contains_key(&node) {
-            let id = graph.add_node(node);
-            node_set.insert(node, id);
-            reverse_map.insert(id, node);
-        }
-    }
-    for i in 0..src.len() {
-        let src_id = *node_set.get(&src[i]).ok_or_else(|| {
-            OnagerError::InvalidArgument(format!("Source node {} not found in graph", src[i]))
-        })?;
-        let dst_id = *node_set.get(&dst[i]).ok_or_else(|| {
-            OnagerError::InvalidArgument(format!("Destination node {} not found in graph", dst[i]))
-        })?;
-        graph.add_edge(src_id, dst_id, 1.0);
-    }
+    let csr = cache::csr_from_edges(src, dst, None, false)?;
+    let (graph, node_index) = csr.to_graph(|_| 1.0)?;
 
     let communities = girvan_newman(&graph, target_communities as usize)
         .map_err(|e| OnagerError::GraphError(e.to_string()))?;
 
-    let mut result_nodes = Vec::new();
-    let mut result_comms = Vec::new();
-    for (comm_id, community) in communities.iter().enumerate() {
-        for &internal_id in community {
-            if let Some(&ext_id) = reverse_map.get(&internal_id) {
-                result_nodes.push(ext_id);
-                result_comms.push(comm_id as i64);
-            }
-        }
-    }
+    let (result_nodes, result_comms) = members_by_node(&node_index, &communities);
     Ok(GirvanNewmanResult {
         node_ids: result_nodes,
         community_ids: result_comms,
@@ -280,40 +221,13 @@ pub fn compute_spectral_clustering(
         ));
     }
 
-    let mut node_set: HashMap<i64, NodeId> = HashMap::new();
-    let mut reverse_map: HashMap<NodeId, i64> = HashMap::new();
-    let mut graph: Graph<i64, f64> = Graph::new();
-
-    for &node in src.iter().chain(dst.iter()) {
-        if !node_set.contains_key(&node) {
-            let id = graph.add_node(node);
-            node_set.insert(node, id);
-            reverse_map.insert(id, node);
-        }
-    }
-    for i in 0..src.len() {
-        let src_id = *node_set.get(&src[i]).ok_or_else(|| {
-            OnagerError::InvalidArgument(format!("Source node {} not found in graph", src[i]))
-        })?;
-        let dst_id = *node_set.get(&dst[i]).ok_or_else(|| {
-            OnagerError::InvalidArgument(format!("Destination node {} not found in graph", dst[i]))
-        })?;
-        graph.add_edge(src_id, dst_id, 1.0);
-    }
+    let csr = cache::csr_from_edges(src, dst, None, false)?;
+    let (graph, node_index) = csr.to_graph(|_| 1.0)?;
 
     let communities =
         spectral_clustering(&graph, k, seed).map_err(|e| OnagerError::GraphError(e.to_string()))?;
 
-    let mut result_nodes = Vec::new();
-    let mut result_comms = Vec::new();
-    for (comm_id, community) in communities.iter().enumerate() {
-        for &internal_id in community {
-            if let Some(&ext_id) = reverse_map.get(&internal_id) {
-                result_nodes.push(ext_id);
-                result_comms.push(comm_id as i64);
-            }
-        }
-    }
+    let (result_nodes, result_comms) = members_by_node(&node_index, &communities);
     Ok(SpectralClusteringResult {
         node_ids: result_nodes,
         community_ids: result_comms,
@@ -350,34 +264,17 @@ pub fn compute_infomap(
         ));
     }
 
-    let mut node_set: HashMap<i64, NodeId> = HashMap::new();
-    let mut graph: Graph<i64, f64> = Graph::new();
-
-    for &node in src.iter().chain(dst.iter()) {
-        if !node_set.contains_key(&node) {
-            let id = graph.add_node(node);
-            node_set.insert(node, id);
-        }
-    }
-    for i in 0..src.len() {
-        let src_id = *node_set.get(&src[i]).ok_or_else(|| {
-            OnagerError::InvalidArgument(format!("Source node {} not found in graph", src[i]))
-        })?;
-        let dst_id = *node_set.get(&dst[i]).ok_or_else(|| {
-            OnagerError::InvalidArgument(format!("Destination node {} not found in graph", dst[i]))
-        })?;
-        graph.add_edge(src_id, dst_id, 1.0);
-    }
+    let csr = cache::csr_from_edges(src, dst, None, false)?;
+    let (graph, node_index) = csr.to_graph(|_| 1.0)?;
 
     let modules =
         infomap(&graph, max_iter, seed).map_err(|e| OnagerError::GraphError(e.to_string()))?;
-    let reverse_map: HashMap<NodeId, i64> = node_set.iter().map(|(&k, &v)| (v, k)).collect();
     let node_list: Vec<NodeId> = graph.nodes().map(|(id, _)| id).collect();
 
     let mut node_ids = Vec::with_capacity(modules.len());
     let mut community_ids = Vec::with_capacity(modules.len());
     for (i, module) in modules.into_iter().enumerate() {
-        if let Some(&ext_id) = reverse_map.get(&node_list[i]) {
+        if let Some(&ext_id) = node_index.external_id(&node_list[i]) {
             node_ids.push(ext_id);
             community_ids.push(module as i64);
         }
@@ -420,7 +317,7 @@ mod tests {
         let src = vec![1, 2, 3];
         let dst = vec![2, 3, 1];
 
-        let result = compute_louvain(&src, &dst, None).unwrap();
+        let result = compute_louvain(&src, &dst, &[], None).unwrap();
 
         assert_eq!(result.node_ids.len(), 3);
     }
@@ -491,9 +388,24 @@ mod tests {
         assert!(result.is_err());
     }
 
+    #[test]
+    fn test_louvain_uses_weights() {
+        // A 4-cycle whose heavy edges pair up 1-2 and 3-4
+        let (src, dst) = ([1, 2, 3, 4], [2, 3, 4, 1]);
+        let result = compute_louvain(&src, &dst, &[10.0, 0.1, 10.0, 0.1], Some(1)).unwrap();
+        let community = |node: i64| {
+            let i = result.node_ids.iter().position(|&n| n == node).unwrap();
+            result.community_ids[i]
+        };
+        assert_eq!(community(1), community(2));
+        assert_eq!(community(3), community(4));
+        assert_ne!(community(1), community(3));
+        assert!(compute_louvain(&src, &dst, &[1.0, -1.0, 1.0, 1.0], None).is_err());
+    }
+
     #[test]
     fn test_empty_graph_errors() {
-        assert!(compute_louvain(&[], &[], None).is_err());
+        assert!(compute_louvain(&[], &[], &[], None).is_err());
         assert!(compute_connected_components(&[], &[]).is_err());
         assert!(compute_label_propagation(&[], &[]).is_err());
         assert!(compute_girvan_newman(&[], &[], 2).is_err());
@@ -503,6 +415,6 @@ mod tests {
 
     #[test]
     fn test_mismatched_arrays_error() {
-        assert!(compute_louvain(&[1, 2], &[2], None).is_err());
+        assert!(compute_louvain(&[1, 2], &[2], &[], None).is_err());
     }
 }
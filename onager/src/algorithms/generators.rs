@@ -1,11 +1,17 @@
 //! Graph generators module.
 //!
 //! Erdős-Rényi, Barabási-Albert, Watts-Strogatz.
-
-use graphina::core::generators::{barabasi_albert_graph, erdos_renyi_graph, watts_strogatz_graph};
-use graphina::core::types::{Graph, Undirected};
+//!
+//! Generators stream their edges through resumable cursors instead of building a graph first.
+//! Erdős-Rényi and Watts-Strogatz split the node range into fixed-size blocks, and each block
+//! has its own cursor and random stream, so blocks can be generated in parallel and the edge
+//! set for a seed does not depend on how many threads consume it.
 
 use crate::error::{OnagerError, Result};
+use crate::rng::SplitMix64;
+
+/// Number of source nodes covered by one partition of a block-partitioned generator.
+pub const GENERATOR_BLOCK_NODES: usize = 4096;
 
 /// Result of graph generation.
 pub struct GeneratorResult {
@@ -13,50 +19,330 @@ pub struct GeneratorResult {
     pub dst: Vec<i64>,
 }
 
-/// Generate an Erdős-Rényi random graph.
-pub fn generate_erdos_renyi(n: usize, p: f64, seed: u64) -> Result<GeneratorResult> {
-    if n == 0 {
-        return Err(OnagerError::InvalidArgument("n must be > 0".to_string()));
+#[derive(Clone, Copy)]
+enum EdgeModel {
+    ErdosRenyi { p: f64 },
+    BarabasiAlbert { m: usize },
+    WattsStrogatz { k: usize, beta: f64 },
+}
+
+/// Validated generator parameters that hand out one edge cursor per partition.
+pub struct EdgeGenerator {
+    n: usize,
+    seed: u64,
+    model: EdgeModel,
+    block_nodes: usize,
+}
+
+impl EdgeGenerator {
+    /// Creates an Erdős-Rényi G(n, p) generator.
+    pub fn erdos_renyi(n: usize, p: f64, seed: u64) -> Result<Self> {
+        if n == 0 {
+            return Err(OnagerError::InvalidArgument("n must be > 0".to_string()));
+        }
+        if !(0.0..=1.0).contains(&p) {
+            return Err(OnagerError::InvalidArgument(
+                "p must be in [0, 1]".to_string(),
+            ));
+        }
+        Ok(Self::new(n, seed, EdgeModel::ErdosRenyi { p }))
     }
-    if !(0.0..=1.0).contains(&p) {
-        return Err(OnagerError::InvalidArgument(
-            "p must be in [0, 1]".to_string(),
-        ));
+
+    /// Creates a Barabási-Albert preferential attachment generator.
+    pub fn barabasi_albert(n: usize, m: usize, seed: u64) -> Result<Self> {
+        if n == 0 || m == 0 {
+            return Err(OnagerError::InvalidArgument(
+                "n and m must be > 0".to_string(),
+            ));
+        }
+        if m > n {
+            return Err(OnagerError::InvalidArgument("m must be <= n".to_string()));
+        }
+        Ok(Self::new(n, seed, EdgeModel::BarabasiAlbert { m }))
     }
 
-    let graph: Graph<u32, f32> = erdos_renyi_graph::<Undirected>(n, p, seed)
-        .map_err(|e| OnagerError::GraphError(e.to_string()))?;
+    /// Creates a Watts-Strogatz small-world generator.
+    pub fn watts_strogatz(n: usize, k: usize, beta: f64, seed: u64) -> Result<Self> {
+        if n == 0 {
+            return Err(OnagerError::InvalidArgument("n must be > 0".to_string()));
+        }
+        if !k.is_multiple_of(2) || k >= n {
+            return Err(OnagerError::InvalidArgument(
+                "k must be even and < n".to_string(),
+            ));
+        }
+        if !(0.0..=1.0).contains(&beta) {
+            return Err(OnagerError::InvalidArgument(
+                "beta must be in [0, 1]".to_string(),
+            ));
+        }
+        Ok(Self::new(n, seed, EdgeModel::WattsStrogatz { k, beta }))
+    }
 
-    let mut src = Vec::new();
-    let mut dst = Vec::new();
-    for (u, v, _) in graph.edges() {
-        src.push(u.index() as i64);
-        dst.push(v.index() as i64);
+    fn new(n: usize, seed: u64, model: EdgeModel) -> Self {
+        Self {
+            n,
+            seed,
+            model,
+            block_nodes: GENERATOR_BLOCK_NODES,
+        }
     }
-    Ok(GeneratorResult { src, dst })
-}
 
-/// Generate a Barabási-Albert preferential attachment graph.
-pub fn generate_barabasi_albert(n: usize, m: usize, seed: u64) -> Result<GeneratorResult> {
-    if n == 0 || m == 0 {
-        return Err(OnagerError::InvalidArgument(
-            "n and m must be > 0".to_string(),
-        ));
+    /// Number of independent partitions.
+    /// Barabási-Albert depends on all previous edges and always has a single partition.
+    pub fn partition_count(&self) -> usize {
+        match self.model {
+            EdgeModel::BarabasiAlbert { .. } => 1,
+            _ => self.n.div_ceil(self.block_nodes),
+        }
     }
-    if m > n {
-        return Err(OnagerError::InvalidArgument("m must be <= n".to_string()));
+
+    /// Opens the cursor for a partition. Partitions past the end yield no edges.
+    pub fn cursor(&self, partition: usize) -> EdgeCursor {
+        let n = self.n as u64;
+        let lo = (partition as u64)
+            .saturating_mul(self.block_nodes as u64)
+            .min(n);
+        let hi = lo.saturating_add(self.block_nodes as u64).min(n);
+        let mut rng = SplitMix64::for_partition(self.seed, partition);
+        let state = if partition >= self.partition_count() {
+            CursorState::Done
+        } else {
+            match self.model {
+                EdgeModel::ErdosRenyi { p } if p > 0.0 => {
+                    let log_q = (1.0 - p).ln();
+                    let v = (lo + 1).saturating_add(geometric_skip(&mut rng, log_q));
+                    CursorState::ErdosRenyi {
+                        n,
+                        log_q,
+                        u: lo,
+                        v,
+                        hi,
+                        rng,
+                    }
+                }
+                EdgeModel::ErdosRenyi { .. } => CursorState::Done,
+                EdgeModel::WattsStrogatz { k, beta } => CursorState::WattsStrogatz {
+                    n,
+                    half_k: (k / 2) as u64,
+                    beta,
+                    u: lo,
+                    j: 1,
+                    hi,
+                    rewired: Vec::with_capacity(k / 2),
+                    rng,
+                },
+                EdgeModel::BarabasiAlbert { m } => CursorState::BarabasiAlbert {
+                    n,
+                    m,
+                    star: 1,
+                    source: (m as u64 + 1).min(n),
+                    targets: Vec::with_capacity(m),
+                    next_target: 0,
+                    repeated: Vec::new(),
+                    rng,
+                },
+            }
+        };
+        EdgeCursor { state }
     }
+}
+
+/// Number of candidate pairs skipped before the next Erdős-Rényi edge.
+/// `log_q` is ln(1 - p); p = 1 gives negative infinity and a skip of zero.
+fn geometric_skip(rng: &mut SplitMix64, log_q: f64) -> u64 {
+    let skip = ((1.0 - rng.next_f64()).ln() / log_q).floor();
+    // Float to integer casts saturate, so very small p cannot overflow the skip.
+    skip as u64
+}
+
+enum CursorState {
+    ErdosRenyi {
+        n: u64,
+        log_q: f64,
+        u: u64,
+        v: u64,
+        hi: u64,
+        rng: SplitMix64,
+    },
+    WattsStrogatz {
+        n: u64,
+        half_k: u64,
+        beta: f64,
+        u: u64,
+        j: u64,
+        hi: u64,
+        rewired: Vec<u64>,
+        rng: SplitMix64,
+    },
+    BarabasiAlbert {
+        n: u64,
+        m: usize,
+        star: u64,
+        source: u64,
+        targets: Vec<u64>,
+        next_target: usize,
+        repeated: Vec<u64>,
+        rng: SplitMix64,
+    },
+    Done,
+}
+
+/// Resumable cursor over the edges of one generator partition.
+pub struct EdgeCursor {
+    state: CursorState,
+}
 
-    let graph: Graph<u32, f32> = barabasi_albert_graph::<Undirected>(n, m, seed)
-        .map_err(|e| OnagerError::GraphError(e.to_string()))?;
+impl EdgeCursor {
+    /// Writes up to `min(src.len(), dst.len())` edges and returns how many were written.
+    /// A return value smaller than the capacity means the partition is exhausted.
+    pub fn next_batch(&mut self, src: &mut [i64], dst: &mut [i64]) -> usize {
+        let capacity = src.len().min(dst.len());
+        let mut count = 0;
+        match &mut self.state {
+            CursorState::ErdosRenyi {
+                n,
+                log_q,
+                u,
+                v,
+                hi,
+                rng,
+            } => {
+                while count < capacity {
+                    // Carry the candidate position into the following rows; row u holds v in (u, n).
+                    while *v >= *n && *u < *hi {
+                        let over = *v - *n;
+                        *u += 1;
+                        *v = (*u + 1).saturating_add(over);
+                    }
+                    if *u >= *hi {
+                        break;
+                    }
+                    src[count] = *u as i64;
+                    dst[count] = *v as i64;
+                    count += 1;
+                    *v = (*v + 1).saturating_add(geometric_skip(rng, *log_q));
+                }
+            }
+            CursorState::WattsStrogatz {
+                n,
+                half_k,
+                beta,
+                u,
+                j,
+                hi,
+                rewired,
+                rng,
+            } => {
+                // Targets outside the lattice neighbourhood of u that are still free.
+                let free = *n - 1 - 2 * *half_k;
+                while count < capacity && *u < *hi {
+                    if *j > *half_k {
+                        *u += 1;
+                        *j = 1;
+                        rewired.clear();
+                        continue;
+                    }
+                    let mut target = (*u + *j) % *n;
+                    if free > rewired.len() as u64 && rng.next_f64() < *beta {
+                        // Avoid self-loops, lattice neighbours, and targets already rewired from u.
+                        loop {
+                            let w = rng.below(*n);
+                            let dist = w.abs_diff(*u).min(*n - w.abs_diff(*u));
+                            if dist > *half_k && !rewired.contains(&w) {
+                                target = w;
+                                break;
+                            }
+                        }
+                        rewired.push(target);
+                    }
+                    src[count] = *u as i64;
+                    dst[count] = target as i64;
+                    count += 1;
+                    *j += 1;
+                }
+            }
+            CursorState::BarabasiAlbert {
+                n,
+                m,
+                star,
+                source,
+                targets,
+                next_target,
+                repeated,
+                rng,
+            } => {
+                // Start from a star on node 0, then attach each new node to m distinct
+                // existing nodes chosen in proportion to their degree.
+                while count < capacity && *star < (*m as u64 + 1).min(*n) {
+                    src[count] = 0;
+                    dst[count] = *star as i64;
+                    count += 1;
+                    repeated.push(0);
+                    repeated.push(*star);
+                    *star += 1;
+                }
+                while count < capacity && *source < *n {
+                    if targets.is_empty() {
+                        while targets.len() < *m {
+                            let t = repeated[rng.below(repeated.len() as u64) as usize];
+                            if !targets.contains(&t) {
+                                targets.push(t);
+                            }
+                        }
+                        *next_target = 0;
+                    }
+                    src[count] = *source as i64;
+                    dst[count] = targets[*next_target] as i64;
+                    count += 1;
+                    *next_target += 1;
+                    if *next_target == targets.len() {
+                        repeated.extend_from_slice(targets);
+                        repeated.extend(std::iter::repeat_n(*source, *m));
+                        targets.clear();
+                        *source += 1;
+                    }
+                }
+            }
+            CursorState::Done => {}
+        }
+        if count < capacity {
+            self.state = CursorState::Done;
+        }
+        count
+    }
+}
 
+/// Collects every partition of a generator into edge arrays.
+fn collect_edges(generator: &EdgeGenerator) -> GeneratorResult {
+    const BATCH: usize = 2048;
     let mut src = Vec::new();
     let mut dst = Vec::new();
-    for (u, v, _) in graph.edges() {
-        src.push(u.index() as i64);
-        dst.push(v.index() as i64);
+    for partition in 0..generator.partition_count() {
+        let mut cursor = generator.cursor(partition);
+        loop {
+            let start = src.len();
+            src.resize(start + BATCH, 0);
+            dst.resize(start + BATCH, 0);
+            let written = cursor.next_batch(&mut src[start..], &mut dst[start..]);
+            src.truncate(start + written);
+            dst.truncate(start + written);
+            if written < BATCH {
+                break;
+            }
+        }
     }
-    Ok(GeneratorResult { src, dst })
+    GeneratorResult { src, dst }
+}
+
+/// Generate an Erdős-Rényi random graph.
+pub fn generate_erdos_renyi(n: usize, p: f64, seed: u64) -> Result<GeneratorResult> {
+    Ok(collect_edges(&EdgeGenerator::erdos_renyi(n, p, seed)?))
+}
+
+/// Generate a Barabási-Albert preferential attachment graph.
+pub fn generate_barabasi_albert(n: usize, m: usize, seed: u64) -> Result<GeneratorResult> {
+    Ok(collect_edges(&EdgeGenerator::barabasi_albert(n, m, seed)?))
 }
 
 /// Generate a Watts-Strogatz small-world graph.
@@ -66,30 +352,9 @@ pub fn generate_watts_strogatz(
     beta: f64,
     seed: u64,
 ) -> Result<GeneratorResult> {
-    if n == 0 {
-        return Err(OnagerError::InvalidArgument("n must be > 0".to_string()));
-    }
-    if !k.is_multiple_of(2) || k >= n {
-        return Err(OnagerError::InvalidArgument(
-            "k must be even and < n".to_string(),
-        ));
-    }
-    if !(0.0..=1.0).contains(&beta) {
-        return Err(OnagerError::InvalidArgument(
-            "beta must be in [0, 1]".to_string(),
-        ));
-    }
-
-    let graph: Graph<u32, f32> = watts_strogatz_graph::<Undirected>(n, k, beta, seed)
-        .map_err(|e| OnagerError::GraphError(e.to_string()))?;
-
-    let mut src = Vec::new();
-    let mut dst = Vec::new();
-    for (u, v, _) in graph.edges() {
-        src.push(u.index() as i64);
-        dst.push(v.index() as i64);
-    }
-    Ok(GeneratorResult { src, dst })
+    Ok(collect_edges(&EdgeGenerator::watts_strogatz(
+        n, k, beta, seed,
+    )?))
 }
 
 #[cfg(test)]
@@ -205,4 +470,107 @@ mod tests {
         assert_eq!(result1.src, result2.src);
         assert_eq!(result1.dst, result2.dst);
     }
+    fn collect_partitions(generator: &EdgeGenerator, batch: usize) -> Vec<(i64, i64)> {
+        let mut edges = Vec::new();
+        let mut src = vec![0; batch];
+        let mut dst = vec![0; batch];
+        for partition in 0..generator.partition_count() {
+            let mut cursor = generator.cursor(partition);
+            loop {
+                let written = cursor.next_batch(&mut src, &mut dst);
+                edges.extend(
+                    src[..written]
+                        .iter()
+                        .copied()
+                        .zip(dst[..written].iter().copied()),
+                );
+                if written < batch {
+                    break;
+                }
+            }
+        }
+        edges
+    }
+
+    #[test]
+    fn test_cursor_resumes_across_batches() {
+        let generator = EdgeGenerator::erdos_renyi(300, 0.05, 7).unwrap();
+        let whole = generate_erdos_renyi(300, 0.05, 7).unwrap();
+        let small = collect_partitions(&generator, 7);
+        let expected: Vec<(i64, i64)> = whole.src.into_iter().zip(whole.dst).collect();
+        assert_eq!(small, expected);
+
+        let generator = EdgeGenerator::barabasi_albert(200, 3, 7).unwrap();
+        let whole = generate_barabasi_albert(200, 3, 7).unwrap();
+        let expected: Vec<(i64, i64)> = whole.src.into_iter().zip(whole.dst).collect();
+        assert_eq!(collect_partitions(&generator, 5), expected);
+    }
+
+    #[test]
+    fn test_erdos_renyi_partitioned_complete_graph() {
+        let mut generator = EdgeGenerator::erdos_renyi(100, 1.0, 42).unwrap();
+        generator.block_nodes = 16;
+        assert_eq!(generator.partition_count(), 7);
+
+        let mut edges = collect_partitions(&generator, 64);
+        assert!(edges.iter().all(|&(u, v)| u < v && v < 100));
+        edges.sort_unstable();
+        edges.dedup();
+        assert_eq!(edges.len(), 100 * 99 / 2);
+    }
+
+    #[test]
+    fn test_erdos_renyi_skip_sampling_density() {
+        let mut generator = EdgeGenerator::erdos_renyi(2000, 0.01, 3).unwrap();
+        generator.block_nodes = 64;
+        let mut edges = collect_partitions(&generator, 1024);
+        let total = edges.len();
+        edges.sort_unstable();
+        edges.dedup();
+        assert_eq!(edges.len(), total);
+        // Expected 19990 edges with a standard deviation of about 141.
+        assert!((19_000..=21_000).contains(&total), "got {total} edges");
+    }
+
+    #[test]
+    fn test_cursor_past_last_partition_is_empty() {
+        let generator = EdgeGenerator::watts_strogatz(10, 4, 0.3, 42).unwrap();
+        let mut cursor = generator.cursor(generator.partition_count());
+        let mut src = [0; 4];
+        let mut dst = [0; 4];
+        assert_eq!(cursor.next_batch(&mut src, &mut dst), 0);
+    }
+
+    #[test]
+    fn test_watts_strogatz_edge_count() {
+        let mut generator = EdgeGenerator::watts_strogatz(1000, 6, 0.2, 9).unwrap();
+        generator.block_nodes = 100;
+        let edges = collect_partitions(&generator, 100);
+        assert_eq!(edges.len(), 1000 * 6 / 2);
+        assert!(edges.iter().all(|&(u, v)| u != v));
+    }
+
+    #[test]
+    fn test_watts_strogatz_beta_bounds() {
+        let lattice = generate_watts_strogatz(20, 4, 0.0, 1).unwrap();
+        for (u, v) in lattice.src.iter().zip(&lattice.dst) {
+            let dist = (v - u).rem_euclid(20);
+            assert!(dist == 1 || dist == 2);
+        }
+
+        let rewired = generate_watts_strogatz(20, 4, 1.0, 1).unwrap();
+        assert_eq!(rewired.src.len(), 40);
+        for (u, v) in rewired.src.iter().zip(&rewired.dst) {
+            let d = (v - u).rem_euclid(20);
+            assert!(d.min(20 - d) > 2);
+        }
+    }
+
+    #[test]
+    fn test_barabasi_albert_edge_count() {
+        let result = generate_barabasi_albert(50, 3, 42).unwrap();
+        // Star on the first m + 1 nodes, then m edges for every later node.
+        assert_eq!(result.src.len(), 3 + (50 - 4) * 3);
+        assert!(result.src.iter().zip(&result.dst).all(|(u, v)| u != v));
+    }
 }
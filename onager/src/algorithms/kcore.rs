@@ -0,0 +1,223 @@
+//! K-core decomposition module.
+//!
+//! Core numbers come from the bucket-based peeling of Batagelj and Zaversnik,
+//! which runs in O(n + m) time. Nodes sit in an array sorted by their current
+//! degree, with the start of every degree bucket recorded, so removing the node
+//! of lowest degree and moving each of its neighbors one bucket down are both
+//! constant-time swaps. Edges are treated as undirected, and self-loops and
+//! parallel edges are ignored.
+
+use crate::cache;
+use crate::csr::{CsrGraph, NeighborSets};
+use crate::error::{OnagerError, Result};
+
+/// Result of k-core decomposition.
+pub struct KCoreResult {
+    pub node_ids: Vec<i64>,
+    pub core_numbers: Vec<i64>,
+}
+
+/// Result of k-core subgraph extraction.
+pub struct KCoreEdgesResult {
+    pub src: Vec<i64>,
+    pub dst: Vec<i64>,
+}
+
+/// Compute the core number of every node.
+pub fn compute_kcore(src: &[i64], dst: &[i64]) -> Result<KCoreResult> {
+    let csr = cache::csr_from_edges(src, dst, None, false)?;
+    compute_kcore_csr(&csr)
+}
+
+/// Compute the core number of every node of a prebuilt CSR graph.
+pub fn compute_kcore_csr(csr: &CsrGraph) -> Result<KCoreResult> {
+    if csr.edge_count() == 0 {
+        return Err(OnagerError::InvalidArgument(
+            "Cannot compute on empty graph".to_string(),
+        ));
+    }
+
+    let cores = core_numbers(&NeighborSets::from_csr(csr));
+    Ok(KCoreResult {
+        node_ids: csr.ids().to_vec(),
+        core_numbers: cores.into_iter().map(i64::from).collect(),
+    })
+}
+
+/// Extract the edges of the k-core, the largest subgraph whose nodes all have degree at least `k`.
+pub fn compute_kcore_edges(src: &[i64], dst: &[i64], k: i64) -> Result<KCoreEdgesResult> {
+    let csr = cache::csr_from_edges(src, dst, None, false)?;
+    compute_kcore_edges_csr(&csr, k)
+}
+
+/// Extract the edges of the k-core of a prebuilt CSR graph.
+///
+/// Every edge of the graph whose endpoints both have a core number of at least
+/// `k` is returned once, in its stored direction, grouped by source node.
+pub fn compute_kcore_edges_csr(csr: &CsrGraph, k: i64) -> Result<KCoreEdgesResult> {
+    if k < 0 {
+        return Err(OnagerError::InvalidArgument(
+            "k must be non-negative".to_string(),
+        ));
+    }
+    if csr.edge_count() == 0 {
+        return Err(OnagerError::InvalidArgument(
+            "Cannot compute on empty graph".to_string(),
+        ));
+    }
+
+    let cores = core_numbers(&NeighborSets::from_csr(csr));
+    let kept = |u: u32| i64::from(cores[u as usize]) >= k;
+    let ids = csr.ids();
+    let mut result = KCoreEdgesResult {
+        src: Vec::new(),
+        dst: Vec::new(),
+    };
+    for u in (0..csr.node_count() as u32).filter(|&u| kept(u)) {
+        for &v in csr.out_neighbors(u).iter().filter(|&&v| kept(v)) {
+            result.src.push(ids[u as usize]);
+            result.dst.push(ids[v as usize]);
+        }
+    }
+    Ok(result)
+}
+
+/// Peels the nodes in order of their remaining degree and returns the core number of each.
+fn core_numbers(sets: &NeighborSets) -> Vec<u32> {
+    let n = sets.node_count();
+    let mut degree: Vec<u32> = (0..n as u32).map(|u| sets.degree(u) as u32).collect();
+    let max_degree = degree.iter().copied().max().unwrap_or(0) as usize;
+
+    // Counting sort by degree: `start[d]` is the first slot of bucket `d`.
+    let mut start = vec![0usize; max_degree + 2];
+    for &d in &degree {
+        start[d as usize + 1] += 1;
+    }
+    for d in 0..=max_degree {
+        start[d + 1] += start[d];
+    }
+    let mut order = vec![0u32; n];
+    let mut position = vec![0usize; n];
+    let mut next = start.clone();
+    for u in 0..n {
+        let d = degree[u] as usize;
+        position[u] = next[d];
+        order[next[d]] = u as u32;
+        next[d] += 1;
+    }
+
+    for i in 0..n {
+        let u = order[i];
+        for &v in sets.get(u) {
+            let dv = degree[v as usize];
+            if dv > degree[u as usize] {
+                // Swap v with the first node of its bucket, then shrink the bucket
+                // past it, which moves v into the bucket below.
+                let first = start[dv as usize];
+                let w = order[first];
+                if w != v {
+                    order.swap(first, position[v as usize]);
+                    position[w as usize] = position[v as usize];
+                    position[v as usize] = first;
+                }
+                start[dv as usize] += 1;
+                degree[v as usize] -= 1;
+            }
+        }
+    }
+    degree
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    fn cores_of(src: &[i64], dst: &[i64]) -> Vec<(i64, i64)> {
+        let result = compute_kcore(src, dst).unwrap();
+        result
+            .node_ids
+            .into_iter()
+            .zip(result.core_numbers)
+            .collect()
+    }
+
+    #[test]
+    fn test_kcore_clique_with_tail() {
+        // 4-clique 1-2-3-4 with a path 4-5-6
+        let src = [1, 1, 1, 2, 2, 3, 4, 5];
+        let dst = [2, 3, 4, 3, 4, 4, 5, 6];
+        assert_eq!(
+            cores_of(&src, &dst),
+            vec![(1, 3), (2, 3), (3, 3), (4, 3), (5, 1), (6, 1)]
+        );
+    }
+
+    #[test]
+    fn test_kcore_ignores_loops_and_duplicates() {
+        // Triangle with a doubled edge, a reversed copy, and a self-loop
+        let src = [1, 2, 2, 3, 1, 3];
+        let dst = [2, 1, 3, 1, 3, 3];
+        assert_eq!(cores_of(&src, &dst), vec![(1, 2), (2, 2), (3, 2)]);
+    }
+
+    #[test]
+    fn test_kcore_matches_naive_peeling() {
+        // Ring with chords plus a hub, checked against repeated removal
+        let mut src = Vec::new();
+        let mut dst = Vec::new();
+        for i in 0..40i64 {
+            src.extend([i, i, 100]);
+            dst.extend([(i + 1) % 40, (i * 7 + 3) % 40, i]);
+        }
+        let csr = CsrGraph::from_edges(&src, &dst, None, false).unwrap();
+        let sets = NeighborSets::from_csr(&csr);
+        let n = csr.node_count();
+        let mut naive = vec![0u32; n];
+        for k in 1..=n as u32 {
+            let mut alive: Vec<bool> = vec![true; n];
+            loop {
+                let drop: Vec<usize> = (0..n)
+                    .filter(|&u| {
+                        alive[u]
+                            && (sets
+                                .get(u as u32)
+                                .iter()
+                                .filter(|&&v| alive[v as usize])
+                                .count() as u32)
+                                < k
+                    })
+                    .collect();
+                if drop.is_empty() {
+                    break;
+                }
+                for u in drop {
+                    alive[u] = false;
+                }
+            }
+            for u in (0..n).filter(|&u| alive[u]) {
+                naive[u] = k;
+            }
+        }
+        assert_eq!(core_numbers(&sets), naive);
+    }
+
+    #[test]
+    fn test_kcore_edges() {
+        let src = [1, 1, 1, 2, 2, 3, 4, 5];
+        let dst = [2, 3, 4, 3, 4, 4, 5, 6];
+        let result = compute_kcore_edges(&src, &dst, 3).unwrap();
+        let mut edges: Vec<(i64, i64)> = result.src.into_iter().zip(result.dst).collect();
+        edges.sort_unstable();
+        assert_eq!(edges, vec![(1, 2), (1, 3), (1, 4), (2, 3), (2, 4), (3, 4)]);
+
+        assert_eq!(compute_kcore_edges(&src, &dst, 0).unwrap().src.len(), 8);
+        assert!(compute_kcore_edges(&src, &dst, 4).unwrap().src.is_empty());
+    }
+
+    #[test]
+    fn test_kcore_invalid_input() {
+        assert!(compute_kcore(&[], &[]).is_err());
+        assert!(compute_kcore(&[1, 2], &[2]).is_err());
+        assert!(compute_kcore_edges(&[1], &[2], -1).is_err());
+    }
+}
@@ -1,14 +1,25 @@
 //! Link prediction algorithms module.
 //!
 //! Jaccard, Adamic-Adar, Preferential Attachment, Resource Allocation, Common Neighbors.
-
-use graphina::core::types::{Graph, NodeId};
-use graphina::links::allocation::resource_allocation_index;
-use graphina::links::attachment::preferential_attachment;
-use graphina::links::similarity::{adamic_adar_index, common_neighbors, jaccard_coefficient};
-
+//!
+//! The all-pairs, top-k, and candidate-pair engines work on undirected neighbor
+//! sets built from the CSR and run in parallel over blocks of source nodes or
+//! pairs. The all-pairs engine takes the node IDs that query filters allow in
+//! each column and only scores the pairs they leave.
+
+use std::cmp::Reverse;
+use std::collections::BinaryHeap;
+use std::mem::size_of;
+
+use graphina::core::types::NodeId;
+use graphina::links::similarity::common_neighbors;
+use ordered_float::OrderedFloat;
+
+use crate::cache;
+use crate::control;
+use crate::csr::{CsrGraph, NeighborSets};
 use crate::error::{OnagerError, Result};
-use std::collections::HashMap;
+use crate::workers::map_blocks;
 
 /// Result of link prediction computation.
 pub struct LinkPredictionResult {
@@ -22,6 +33,34 @@ pub type JaccardResult = LinkPredictionResult;
 
 /// Compute Jaccard coefficient for all node pairs.
 pub fn compute_jaccard(src: &[i64], dst: &[i64]) -> Result<LinkPredictionResult> {
+    compute_link_scores(src, dst, LinkMetric::Jaccard, None, None)
+}
+
+/// Compute Adamic-Adar index for all node pairs.
+pub fn compute_adamic_adar(src: &[i64], dst: &[i64]) -> Result<LinkPredictionResult> {
+    compute_link_scores(src, dst, LinkMetric::AdamicAdar, None, None)
+}
+
+/// Compute preferential attachment for all node pairs.
+pub fn compute_preferential_attachment(src: &[i64], dst: &[i64]) -> Result<LinkPredictionResult> {
+    compute_link_scores(src, dst, LinkMetric::PreferentialAttachment, None, None)
+}
+
+/// Compute resource allocation index for all node pairs.
+pub fn compute_resource_allocation(src: &[i64], dst: &[i64]) -> Result<LinkPredictionResult> {
+    compute_link_scores(src, dst, LinkMetric::ResourceAllocation, None, None)
+}
+
+/// Score all node pairs of an edge list, or only those the node filters allow.
+///
+/// See [`score_all_pairs_csr`] for the pairs and the filters.
+pub fn compute_link_scores(
+    src: &[i64],
+    dst: &[i64],
+    metric: LinkMetric,
+    node1: Option<&[i64]>,
+    node2: Option<&[i64]>,
+) -> Result<LinkPredictionResult> {
     if src.len() != dst.len() {
         return Err(OnagerError::InvalidArgument(
             "src and dst arrays must have same length".to_string(),
@@ -32,47 +71,19 @@ pub fn compute_jaccard(src: &[i64], dst: &[i64]) -> Result<LinkPredictionResult>
             "Cannot compute on empty graph".to_string(),
         ));
     }
+    let csr = cache::csr_from_edges(src, dst, None, false)?;
+    score_all_pairs_csr(&csr, metric, node1, node2)
+}
 
-    let mut node_set: HashMap<i64, NodeId> = HashMap::new();
-    let mut graph: Graph<i64, f64> = Graph::new();
-    for &node in src.iter().chain(dst.iter()) {
-        if !node_set.contains_key(&node) {
-            let id = graph.add_node(node);
-            node_set.insert(node, id);
-        }
-    }
-    for i in 0..src.len() {
-        let src_id = *node_set.get(&src[i]).ok_or_else(|| {
-            OnagerError::InvalidArgument(format!("Source node {} not found in graph", src[i]))
-        })?;
-        let dst_id = *node_set.get(&dst[i]).ok_or_else(|| {
-            OnagerError::InvalidArgument(format!("Destination node {} not found in graph", dst[i]))
-        })?;
-        graph.add_edge(src_id, dst_id, 1.0);
-    }
-
-    let results = jaccard_coefficient(&graph, None);
-    let reverse_map: HashMap<NodeId, i64> = node_set.iter().map(|(&k, &v)| (v, k)).collect();
-
-    let mut node1 = Vec::with_capacity(results.len());
-    let mut node2 = Vec::with_capacity(results.len());
-    let mut scores = Vec::with_capacity(results.len());
-    for ((u, v), coef) in results {
-        if let (Some(&ext_u), Some(&ext_v)) = (reverse_map.get(&u), reverse_map.get(&v)) {
-            node1.push(ext_u);
-            node2.push(ext_v);
-            scores.push(coef);
-        }
-    }
-    Ok(LinkPredictionResult {
-        node1,
-        node2,
-        scores,
-    })
+/// Result of common neighbors computation.
+pub struct CommonNeighborsResult {
+    pub node1: Vec<i64>,
+    pub node2: Vec<i64>,
+    pub counts: Vec<i64>,
 }
 
-/// Compute Adamic-Adar index for all node pairs.
-pub fn compute_adamic_adar(src: &[i64], dst: &[i64]) -> Result<LinkPredictionResult> {
+/// Compute common neighbors count for all node pairs.
+pub fn compute_common_neighbors(src: &[i64], dst: &[i64]) -> Result<CommonNeighborsResult> {
     if src.len() != dst.len() {
         return Err(OnagerError::InvalidArgument(
             "src and dst arrays must have same length".to_string(),
@@ -84,138 +95,230 @@ pub fn compute_adamic_adar(src: &[i64], dst: &[i64]) -> Result<LinkPredictionRes
         ));
     }
 
-    let mut node_set: HashMap<i64, NodeId> = HashMap::new();
-    let mut graph: Graph<i64, f64> = Graph::new();
-    for &node in src.iter().chain(dst.iter()) {
-        if !node_set.contains_key(&node) {
-            let id = graph.add_node(node);
-            node_set.insert(node, id);
-        }
-    }
-    for i in 0..src.len() {
-        let src_id = *node_set.get(&src[i]).ok_or_else(|| {
-            OnagerError::InvalidArgument(format!("Source node {} not found in graph", src[i]))
-        })?;
-        let dst_id = *node_set.get(&dst[i]).ok_or_else(|| {
-            OnagerError::InvalidArgument(format!("Destination node {} not found in graph", dst[i]))
-        })?;
-        graph.add_edge(src_id, dst_id, 1.0);
-    }
-
-    let results = adamic_adar_index(&graph, None);
-    let reverse_map: HashMap<NodeId, i64> = node_set.iter().map(|(&k, &v)| (v, k)).collect();
-
-    let mut node1 = Vec::with_capacity(results.len());
-    let mut node2 = Vec::with_capacity(results.len());
-    let mut scores = Vec::with_capacity(results.len());
-    for ((u, v), coef) in results {
-        if let (Some(&ext_u), Some(&ext_v)) = (reverse_map.get(&u), reverse_map.get(&v)) {
-            node1.push(ext_u);
-            node2.push(ext_v);
-            scores.push(coef);
+    let csr = cache::csr_from_edges(src, dst, None, false)?;
+    let (graph, node_index) = csr.to_graph(|_| 1.0)?;
+
+    let nodes: Vec<NodeId> = node_index.handles().to_vec();
+
+    let mut node1 = Vec::new();
+    let mut node2 = Vec::new();
+    let mut counts = Vec::new();
+
+    // Compute common neighbors for all pairs
+    for i in 0..nodes.len() {
+        for j in (i + 1)..nodes.len() {
+            let u = nodes[i];
+            let v = nodes[j];
+            let count = common_neighbors(&graph, u, v);
+            if let (Some(&ext_u), Some(&ext_v)) =
+                (node_index.external_id(&u), node_index.external_id(&v))
+            {
+                node1.push(ext_u);
+                node2.push(ext_v);
+                counts.push(count as i64);
+            }
         }
     }
-    Ok(LinkPredictionResult {
+
+    Ok(CommonNeighborsResult {
         node1,
         node2,
-        scores,
+        counts,
     })
 }
 
-/// Compute preferential attachment for all node pairs.
-pub fn compute_preferential_attachment(src: &[i64], dst: &[i64]) -> Result<LinkPredictionResult> {
-    if src.len() != dst.len() {
-        return Err(OnagerError::InvalidArgument(
-            "src and dst arrays must have same length".to_string(),
-        ));
+/// Link prediction score used by the top-k and candidate-pair engines.
+#[derive(Clone, Copy, Debug, PartialEq, Eq)]
+pub enum LinkMetric {
+    Jaccard,
+    AdamicAdar,
+    ResourceAllocation,
+    PreferentialAttachment,
+}
+
+impl LinkMetric {
+    /// Maps an FFI metric code to a metric.
+    pub fn from_code(code: u32) -> Result<Self> {
+        match code {
+            0 => Ok(LinkMetric::Jaccard),
+            1 => Ok(LinkMetric::AdamicAdar),
+            2 => Ok(LinkMetric::ResourceAllocation),
+            3 => Ok(LinkMetric::PreferentialAttachment),
+            _ => Err(OnagerError::InvalidArgument(format!(
+                "Unknown link prediction metric code {}",
+                code
+            ))),
+        }
     }
-    if src.is_empty() {
-        return Err(OnagerError::InvalidArgument(
-            "Cannot compute on empty graph".to_string(),
-        ));
+}
+
+/// Nodes per block for the parallel link prediction engines.
+const LINK_BLOCK: usize = 1024;
+
+/// Weight a common neighbor contributes to a pair score.
+fn contribution(sets: &NeighborSets, metric: LinkMetric, z: u32) -> f64 {
+    let d = sets.degree(z) as f64;
+    match metric {
+        LinkMetric::AdamicAdar => 1.0 / d.ln(),
+        LinkMetric::ResourceAllocation => 1.0 / d,
+        _ => 1.0,
     }
+}
 
-    let mut node_set: HashMap<i64, NodeId> = HashMap::new();
-    let mut graph: Graph<i64, f64> = Graph::new();
-    for &node in src.iter().chain(dst.iter()) {
-        if !node_set.contains_key(&node) {
-            let id = graph.add_node(node);
-            node_set.insert(node, id);
+/// Final score of a pair from its accumulated common-neighbor sum.
+fn finish(sets: &NeighborSets, metric: LinkMetric, u: u32, v: u32, common: f64) -> f64 {
+    let (du, dv) = (sets.degree(u) as f64, sets.degree(v) as f64);
+    match metric {
+        LinkMetric::Jaccard => {
+            let union = du + dv - common;
+            if union > 0.0 {
+                common / union
+            } else {
+                0.0
+            }
         }
+        LinkMetric::PreferentialAttachment => du * dv,
+        _ => common,
     }
-    for i in 0..src.len() {
-        let src_id = *node_set.get(&src[i]).ok_or_else(|| {
-            OnagerError::InvalidArgument(format!("Source node {} not found in graph", src[i]))
-        })?;
-        let dst_id = *node_set.get(&dst[i]).ok_or_else(|| {
-            OnagerError::InvalidArgument(format!("Destination node {} not found in graph", dst[i]))
-        })?;
-        graph.add_edge(src_id, dst_id, 1.0);
-    }
-
-    let results = preferential_attachment(&graph, None);
-    let reverse_map: HashMap<NodeId, i64> = node_set.iter().map(|(&k, &v)| (v, k)).collect();
-
-    let mut node1 = Vec::with_capacity(results.len());
-    let mut node2 = Vec::with_capacity(results.len());
-    let mut scores = Vec::with_capacity(results.len());
-    for ((u, v), coef) in results {
-        if let (Some(&ext_u), Some(&ext_v)) = (reverse_map.get(&u), reverse_map.get(&v)) {
-            node1.push(ext_u);
-            node2.push(ext_v);
-            scores.push(coef);
+}
+
+/// Scores one pair by merging the two sorted neighbor lists.
+fn score_pair(sets: &NeighborSets, metric: LinkMetric, u: u32, v: u32) -> f64 {
+    let mut common = 0.0;
+    if metric != LinkMetric::PreferentialAttachment {
+        let (a, b) = (sets.get(u), sets.get(v));
+        let (mut i, mut j) = (0, 0);
+        while i < a.len() && j < b.len() {
+            match a[i].cmp(&b[j]) {
+                std::cmp::Ordering::Less => i += 1,
+                std::cmp::Ordering::Greater => j += 1,
+                std::cmp::Ordering::Equal => {
+                    common += contribution(sets, metric, a[i]);
+                    i += 1;
+                    j += 1;
+                }
+            }
         }
     }
-    Ok(LinkPredictionResult {
-        node1,
-        node2,
-        scores,
-    })
+    finish(sets, metric, u, v, common)
 }
 
-/// Compute resource allocation index for all node pairs.
-pub fn compute_resource_allocation(src: &[i64], dst: &[i64]) -> Result<LinkPredictionResult> {
-    if src.len() != dst.len() {
-        return Err(OnagerError::InvalidArgument(
-            "src and dst arrays must have same length".to_string(),
-        ));
+/// Heap entry ordered by score, then by the smaller node ID.
+type Ranked = (OrderedFloat<f64>, Reverse<u32>);
+
+/// Per-worker scratch space for the top-k engine.
+struct TopKScratch {
+    acc: Vec<f64>,
+    touched: Vec<u32>,
+    mark: Vec<u32>,
+    heap: BinaryHeap<Reverse<Ranked>>,
+}
+
+/// Pushes a candidate into a heap that keeps the `k` best entries.
+fn push_bounded(heap: &mut BinaryHeap<Reverse<Ranked>>, k: usize, score: f64, v: u32) {
+    let entry = (OrderedFloat(score), Reverse(v));
+    if heap.len() < k {
+        heap.push(Reverse(entry));
+    } else if heap.peek().is_some_and(|Reverse(min)| entry > *min) {
+        heap.pop();
+        heap.push(Reverse(entry));
     }
-    if src.is_empty() {
+}
+
+/// Compute the `k` highest-scoring new links for every node of a CSR graph.
+///
+/// Candidates for node u are the nodes that are not u and not already adjacent to u.
+/// Jaccard, Adamic-Adar, and resource allocation only score nodes within two hops,
+/// since every other pair scores zero. Preferential attachment walks nodes in
+/// decreasing degree order. Pairs with a zero score are omitted. Rows are ordered
+/// by node1 and then by decreasing score, and edges are treated as undirected.
+pub fn compute_link_top_k_csr(
+    csr: &CsrGraph,
+    metric: LinkMetric,
+    k: usize,
+) -> Result<LinkPredictionResult> {
+    if k == 0 {
         return Err(OnagerError::InvalidArgument(
-            "Cannot compute on empty graph".to_string(),
+            "top_k must be > 0".to_string(),
         ));
     }
-
-    let mut node_set: HashMap<i64, NodeId> = HashMap::new();
-    let mut graph: Graph<i64, f64> = Graph::new();
-    for &node in src.iter().chain(dst.iter()) {
-        if !node_set.contains_key(&node) {
-            let id = graph.add_node(node);
-            node_set.insert(node, id);
-        }
-    }
-    for i in 0..src.len() {
-        let src_id = *node_set.get(&src[i]).ok_or_else(|| {
-            OnagerError::InvalidArgument(format!("Source node {} not found in graph", src[i]))
-        })?;
-        let dst_id = *node_set.get(&dst[i]).ok_or_else(|| {
-            OnagerError::InvalidArgument(format!("Destination node {} not found in graph", dst[i]))
-        })?;
-        graph.add_edge(src_id, dst_id, 1.0);
-    }
-
-    let results = resource_allocation_index(&graph, None);
-    let reverse_map: HashMap<NodeId, i64> = node_set.iter().map(|(&k, &v)| (v, k)).collect();
-
-    let mut node1 = Vec::with_capacity(results.len());
-    let mut node2 = Vec::with_capacity(results.len());
-    let mut scores = Vec::with_capacity(results.len());
-    for ((u, v), coef) in results {
-        if let (Some(&ext_u), Some(&ext_v)) = (reverse_map.get(&u), reverse_map.get(&v)) {
-            node1.push(ext_u);
-            node2.push(ext_v);
-            scores.push(coef);
+    let n = csr.node_count();
+    let sets = NeighborSets::from_csr(csr);
+    let by_degree: Vec<u32> = if metric == LinkMetric::PreferentialAttachment {
+        let mut order: Vec<u32> = (0..n as u32).collect();
+        order.sort_by_key(|&v| Reverse(sets.degree(v)));
+        order
+    } else {
+        Vec::new()
+    };
+
+    let init = || TopKScratch {
+        acc: if by_degree.is_empty() {
+            vec![0.0; n]
+        } else {
+            Vec::new()
+        },
+        touched: Vec::new(),
+        mark: vec![u32::MAX; n],
+        heap: BinaryHeap::with_capacity(k + 1),
+    };
+    let blocks = map_blocks(n, LINK_BLOCK, init, |s, nodes| {
+        let mut rows = Vec::new();
+        for u in nodes {
+            let u = u as u32;
+            for &z in sets.get(u) {
+                s.mark[z as usize] = u;
+            }
+            if metric == LinkMetric::PreferentialAttachment {
+                let du = sets.degree(u);
+                for &v in &by_degree {
+                    let dv = sets.degree(v);
+                    if s.heap.len() == k || du == 0 || dv == 0 {
+                        break;
+                    }
+                    if v != u && s.mark[v as usize] != u {
+                        push_bounded(&mut s.heap, k, (du * dv) as f64, v);
+                    }
+                }
+            } else {
+                for &z in sets.get(u) {
+                    let c = contribution(&sets, metric, z);
+                    for &w in sets.get(z) {
+                        if w != u {
+                            if s.acc[w as usize] == 0.0 {
+                                s.touched.push(w);
+                            }
+                            s.acc[w as usize] += c;
+                        }
+                    }
+                }
+                for &w in &s.touched {
+                    let common = std::mem::take(&mut s.acc[w as usize]);
+                    if s.mark[w as usize] != u {
+                        push_bounded(&mut s.heap, k, finish(&sets, metric, u, w, common), w);
+                    }
+                }
+                s.touched.clear();
+            }
+            let start = rows.len();
+            rows.extend(
+                s.heap
+                    .drain()
+                    .map(|Reverse((score, Reverse(v)))| (u, v, score.0)),
+            );
+            rows[start..].sort_unstable_by(|a, b| b.2.total_cmp(&a.2).then(a.1.cmp(&b.1)));
         }
+        rows
+    });
+
+    let total: usize = blocks.iter().map(Vec::len).sum();
+    let mut node1 = Vec::with_capacity(total);
+    let mut node2 = Vec::with_capacity(total);
+    let mut scores = Vec::with_capacity(total);
+    for (u, v, score) in blocks.into_iter().flatten() {
+        node1.push(csr.external_id(u));
+        node2.push(csr.external_id(v));
+        scores.push(score);
     }
     Ok(LinkPredictionResult {
         node1,
@@ -224,15 +327,13 @@ pub fn compute_resource_allocation(src: &[i64], dst: &[i64]) -> Result<LinkPredi
     })
 }
 
-/// Result of common neighbors computation.
-pub struct CommonNeighborsResult {
-    pub node1: Vec<i64>,
-    pub node2: Vec<i64>,
-    pub counts: Vec<i64>,
-}
-
-/// Compute common neighbors count for all node pairs.
-pub fn compute_common_neighbors(src: &[i64], dst: &[i64]) -> Result<CommonNeighborsResult> {
+/// Compute the `k` highest-scoring new links for every node of an edge list.
+pub fn compute_link_top_k(
+    src: &[i64],
+    dst: &[i64],
+    metric: LinkMetric,
+    k: usize,
+) -> Result<LinkPredictionResult> {
     if src.len() != dst.len() {
         return Err(OnagerError::InvalidArgument(
             "src and dst arrays must have same length".to_string(),
@@ -243,50 +344,145 @@ pub fn compute_common_neighbors(src: &[i64], dst: &[i64]) -> Result<CommonNeighb
             "Cannot compute on empty graph".to_string(),
         ));
     }
+    let csr = cache::csr_from_edges(src, dst, None, false)?;
+    compute_link_top_k_csr(&csr, metric, k)
+}
 
-    let mut node_set: HashMap<i64, NodeId> = HashMap::new();
-    let mut graph: Graph<i64, f64> = Graph::new();
-    for &node in src.iter().chain(dst.iter()) {
-        if !node_set.contains_key(&node) {
-            let id = graph.add_node(node);
-            node_set.insert(node, id);
-        }
-    }
-    for i in 0..src.len() {
-        let src_id = *node_set.get(&src[i]).ok_or_else(|| {
-            OnagerError::InvalidArgument(format!("Source node {} not found in graph", src[i]))
-        })?;
-        let dst_id = *node_set.get(&dst[i]).ok_or_else(|| {
-            OnagerError::InvalidArgument(format!("Destination node {} not found in graph", dst[i]))
-        })?;
-        graph.add_edge(src_id, dst_id, 1.0);
+/// Score candidate pairs on a CSR graph, one row per pair in input order.
+///
+/// Pairs with a node that is not in the graph score zero. Edges are treated as undirected.
+pub fn score_link_pairs_csr(
+    csr: &CsrGraph,
+    node1: &[i64],
+    node2: &[i64],
+    metric: LinkMetric,
+) -> Result<LinkPredictionResult> {
+    if node1.len() != node2.len() {
+        return Err(OnagerError::InvalidArgument(
+            "node1 and node2 arrays must have same length".to_string(),
+        ));
     }
+    let sets = NeighborSets::from_csr(csr);
+    let blocks = map_blocks(
+        node1.len(),
+        LINK_BLOCK,
+        || (),
+        |_, pairs| {
+            pairs
+                .map(|i| match (csr.dense_id(node1[i]), csr.dense_id(node2[i])) {
+                    (Some(u), Some(v)) => score_pair(&sets, metric, u, v),
+                    _ => 0.0,
+                })
+                .collect::<Vec<f64>>()
+        },
+    );
+    Ok(LinkPredictionResult {
+        node1: node1.to_vec(),
+        node2: node2.to_vec(),
+        scores: blocks.into_iter().flatten().collect(),
+    })
+}
 
-    let reverse_map: HashMap<NodeId, i64> = node_set.iter().map(|(&k, &v)| (v, k)).collect();
-    let nodes: Vec<NodeId> = node_set.values().cloned().collect();
-
-    let mut node1 = Vec::new();
-    let mut node2 = Vec::new();
-    let mut counts = Vec::new();
+/// Per-worker scratch space for the all-pairs engine.
+struct PairScratch {
+    acc: Vec<f64>,
+    touched: Vec<u32>,
+}
 
-    // Compute common neighbors for all pairs
-    for i in 0..nodes.len() {
-        for j in (i + 1)..nodes.len() {
-            let u = nodes[i];
-            let v = nodes[j];
-            let count = common_neighbors(&graph, u, v);
-            if let (Some(&ext_u), Some(&ext_v)) = (reverse_map.get(&u), reverse_map.get(&v)) {
-                node1.push(ext_u);
-                node2.push(ext_v);
-                counts.push(count as i64);
+/// Score every pair of distinct nodes of a CSR graph, once per pair.
+///
+/// Rows have node1 below node2 and are ordered by node1, then by node2. Adjacent
+/// pairs and pairs without a common neighbor are included with their score. `node1` and `node2`
+/// restrict the pairs to those whose node in that column is listed, so node
+/// filters pushed down from a query skip the other pairs instead of dropping
+/// their rows afterwards. Listed IDs that are not in the graph are ignored.
+/// Edges are treated as undirected.
+pub fn score_all_pairs_csr(
+    csr: &CsrGraph,
+    metric: LinkMetric,
+    node1: Option<&[i64]>,
+    node2: Option<&[i64]>,
+) -> Result<LinkPredictionResult> {
+    let n = csr.node_count();
+    let dense = |ids: &[i64]| {
+        let mut dense: Vec<u32> = ids.iter().filter_map(|&id| csr.dense_id(id)).collect();
+        dense.sort_unstable();
+        dense.dedup();
+        dense
+    };
+    let firsts = node1.map_or_else(|| (0..n as u32).collect(), dense);
+    let seconds = node2.map(dense);
+    let later = |u: u32| match &seconds {
+        Some(s) => s.partition_point(|&v| v <= u),
+        None => u as usize + 1,
+    };
+    let pairs: usize = firsts
+        .iter()
+        .map(|&u| seconds.as_ref().map_or(n, Vec::len) - later(u))
+        .sum();
+    control::reserve(
+        &format!("scores of {} node pairs", pairs),
+        pairs * (2 * size_of::<i64>() + size_of::<f64>()),
+    )?;
+
+    let sets = NeighborSets::from_csr(csr);
+    let init = || PairScratch {
+        acc: if metric == LinkMetric::PreferentialAttachment {
+            Vec::new()
+        } else {
+            vec![0.0; n]
+        },
+        touched: Vec::new(),
+    };
+    let blocks = map_blocks(firsts.len(), LINK_BLOCK, init, |s, range| {
+        let mut rows = Vec::new();
+        if control::interrupted() {
+            return rows;
+        }
+        for &u in &firsts[range] {
+            if metric != LinkMetric::PreferentialAttachment {
+                for &z in sets.get(u) {
+                    let c = contribution(&sets, metric, z);
+                    for &w in sets.get(z) {
+                        if w > u {
+                            if s.acc[w as usize] == 0.0 {
+                                s.touched.push(w);
+                            }
+                            s.acc[w as usize] += c;
+                        }
+                    }
+                }
             }
+            let mut score = |v: u32| {
+                let common = s.acc.get(v as usize).copied().unwrap_or(0.0);
+                rows.push((u, v, finish(&sets, metric, u, v, common)));
+            };
+            match &seconds {
+                Some(list) => list[later(u)..].iter().for_each(|&v| score(v)),
+                None => (u + 1..n as u32).for_each(score),
+            }
+            for &w in &s.touched {
+                s.acc[w as usize] = 0.0;
+            }
+            s.touched.clear();
         }
+        rows
+    });
+    control::check()?;
+
+    let total: usize = blocks.iter().map(Vec::len).sum();
+    let mut node1 = Vec::with_capacity(total);
+    let mut node2 = Vec::with_capacity(total);
+    let mut scores = Vec::with_capacity(total);
+    for (u, v, score) in blocks.into_iter().flatten() {
+        node1.push(csr.external_id(u));
+        node2.push(csr.external_id(v));
+        scores.push(score);
     }
-
-    Ok(CommonNeighborsResult {
+    Ok(LinkPredictionResult {
         node1,
         node2,
-        counts,
+        scores,
     })
 }
 
@@ -402,4 +598,148 @@ mod tests {
             assert!(count >= 0);
         }
     }
+
+    /// Deterministic pseudo-random undirected graph.
+    fn random_graph(n: i64, edges: usize) -> (Vec<i64>, Vec<i64>) {
+        let mut state: u64 = 12345;
+        let mut next = || {
+            state = state.wrapping_mul(6364136223846793005).wrapping_add(1);
+            ((state >> 33) % n as u64) as i64
+        };
+        (0..edges).map(|_| (next(), next())).unzip()
+    }
+
+    #[test]
+    fn test_link_top_k_on_triangle_with_extra() {
+        let (src, dst) = triangle_with_extra();
+        let result = compute_link_top_k(&src, &dst, LinkMetric::Jaccard, 1).unwrap();
+        let rows: Vec<(i64, i64, f64)> = result
+            .node1
+            .iter()
+            .zip(&result.node2)
+            .zip(&result.scores)
+            .map(|((&a, &b), &s)| (a, b, s))
+            .collect();
+        // Node 3 is adjacent to every other node, so it has no candidates.
+        assert_eq!(rows, vec![(1, 4, 0.5), (2, 4, 0.5), (4, 1, 0.5)]);
+    }
+
+    #[test]
+    fn test_link_top_k_matches_pair_scores() {
+        let (src, dst) = random_graph(60, 180);
+        let csr = CsrGraph::from_edges(&src, &dst, None, false).unwrap();
+        let n = csr.node_count() as u32;
+        let k = 5;
+        for metric in [
+            LinkMetric::Jaccard,
+            LinkMetric::AdamicAdar,
+            LinkMetric::ResourceAllocation,
+            LinkMetric::PreferentialAttachment,
+        ] {
+            let top = compute_link_top_k_csr(&csr, metric, k).unwrap();
+            for u in 0..n {
+                let ext_u = csr.external_id(u);
+                let adjacent: Vec<u32> = csr.neighbors(u).collect();
+                let candidates: Vec<i64> = (0..n)
+                    .filter(|&v| v != u && !adjacent.contains(&v))
+                    .map(|v| csr.external_id(v))
+                    .collect();
+                let firsts = vec![ext_u; candidates.len()];
+                let scored = score_link_pairs_csr(&csr, &firsts, &candidates, metric).unwrap();
+                let mut expected: Vec<(i64, f64)> = scored
+                    .node2
+                    .into_iter()
+                    .zip(scored.scores)
+                    .filter(|&(_, s)| s > 0.0)
+                    .collect();
+                expected.sort_by(|a, b| b.1.total_cmp(&a.1).then(a.0.cmp(&b.0)));
+                expected.truncate(k);
+
+                let actual: Vec<(i64, f64)> = top
+                    .node1
+                    .iter()
+                    .zip(&top.node2)
+                    .zip(&top.scores)
+                    .filter(|((&a, _), _)| a == ext_u)
+                    .map(|((_, &b), &s)| (b, s))
+                    .collect();
+                assert_eq!(actual, expected, "{:?} for node {}", metric, ext_u);
+            }
+        }
+    }
+
+    #[test]
+    fn test_score_link_pairs() {
+        let (src, dst) = triangle_with_extra();
+        let csr = CsrGraph::from_edges(&src, &dst, None, false).unwrap();
+        let result =
+            score_link_pairs_csr(&csr, &[1, 4, 1], &[4, 2, 99], LinkMetric::Jaccard).unwrap();
+        assert_eq!(result.node1, vec![1, 4, 1]);
+        assert_eq!(result.node2, vec![4, 2, 99]);
+        assert_eq!(result.scores, vec![0.5, 0.5, 0.0]);
+
+        let pa =
+            score_link_pairs_csr(&csr, &[3], &[4], LinkMetric::PreferentialAttachment).unwrap();
+        assert_eq!(pa.scores, vec![3.0]);
+    }
+
+    #[test]
+    fn test_all_pairs_match_pair_scores() {
+        let (src, dst) = random_graph(40, 100);
+        let csr = CsrGraph::from_edges(&src, &dst, None, false).unwrap();
+        for metric in [
+            LinkMetric::Jaccard,
+            LinkMetric::AdamicAdar,
+            LinkMetric::ResourceAllocation,
+            LinkMetric::PreferentialAttachment,
+        ] {
+            let all = score_all_pairs_csr(&csr, metric, None, None).unwrap();
+            let n = csr.node_count();
+            assert_eq!(all.node1.len(), n * (n - 1) / 2);
+            assert!(all.node1.iter().zip(&all.node2).all(|(a, b)| a < b));
+            let pairs = score_link_pairs_csr(&csr, &all.node1, &all.node2, metric).unwrap();
+            for (a, b) in all.scores.iter().zip(&pairs.scores) {
+                assert!((a - b).abs() < 1e-12, "{:?}", metric);
+            }
+        }
+    }
+
+    #[test]
+    fn test_all_pairs_filters_keep_matching_rows() {
+        let (src, dst) = random_graph(40, 100);
+        let csr = CsrGraph::from_edges(&src, &dst, None, false).unwrap();
+        let rows = |r: LinkPredictionResult| -> Vec<(i64, i64, u64)> {
+            r.node1
+                .into_iter()
+                .zip(r.node2)
+                .zip(r.scores)
+                .map(|((a, b), s)| (a, b, s.to_bits()))
+                .collect()
+        };
+        let all = rows(score_all_pairs_csr(&csr, LinkMetric::AdamicAdar, None, None).unwrap());
+        let (firsts, seconds) = ([3, 7, 7, 999], [5, 20, 31]);
+        for (node1, node2) in [
+            (Some(&firsts[..]), None),
+            (None, Some(&seconds[..])),
+            (Some(&firsts[..]), Some(&seconds[..])),
+            (Some(&[][..]), None),
+        ] {
+            let filtered = score_all_pairs_csr(&csr, LinkMetric::AdamicAdar, node1, node2);
+            let expected: Vec<_> = all
+                .iter()
+                .filter(|r| node1.is_none_or(|ids| ids.contains(&r.0)))
+                .filter(|r| node2.is_none_or(|ids| ids.contains(&r.1)))
+                .copied()
+                .collect();
+            assert_eq!(rows(filtered.unwrap()), expected);
+        }
+    }
+
+    #[test]
+    fn test_link_top_k_invalid() {
+        let (src, dst) = triangle_with_extra();
+        assert!(compute_link_top_k(&src, &dst, LinkMetric::Jaccard, 0).is_err());
+        assert!(compute_link_top_k(&[], &[], LinkMetric::Jaccard, 3).is_err());
+        assert!(LinkMetric::from_code(9).is_err());
+    }
 }
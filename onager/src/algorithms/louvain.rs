@@ -0,0 +1,450 @@
+//! Parallel Louvain community detection.
+//!
+//! Every level runs parallel local moving followed by parallel coarsening. Local
+//! moving visits the nodes in a seeded random order that is split into rounds.
+//! Within a round, workers choose the best community of each node against the
+//! community weights at the start of the round, and the moves are then applied in
+//! node order, so the result depends only on the seed and not on the number of
+//! threads. A node that is alone in its community only joins another singleton
+//! with a smaller ID, which keeps pairs of nodes from swapping communities
+//! forever. After the first pass, only nodes with a neighbor that moved are
+//! visited again. Coarsening merges the rows of each community's members into
+//! one weighted row per community, one block of communities per worker.
+
+use crate::algorithms::community::LouvainResult;
+use crate::cache;
+use crate::control;
+use crate::csr::CsrGraph;
+use crate::error::{OnagerError, Result};
+use crate::rng::SplitMix64;
+use crate::workers::map_blocks;
+
+/// Rounds per local-moving pass. More rounds see more of the moves made earlier
+/// in the pass, at the cost of one synchronization per round.
+const LOUVAIN_ROUNDS: usize = 8;
+
+/// Upper bound on local-moving passes per level.
+const LOUVAIN_MAX_PASSES: usize = 32;
+
+/// Nodes or communities per parallel block.
+const LOUVAIN_BLOCK: usize = 1024;
+
+/// Gains below this fraction of a node's degree are treated as no gain.
+const LOUVAIN_MIN_GAIN: f64 = 1e-12;
+
+/// Seed used when the caller does not give one.
+const LOUVAIN_DEFAULT_SEED: u64 = 0x5EED;
+
+/// Compute Louvain community detection in parallel on edge arrays.
+///
+/// The edges are undirected, and `weights` is either empty or holds one
+/// non-negative weight per edge.
+pub fn compute_louvain_parallel(
+    src: &[i64],
+    dst: &[i64],
+    weights: &[f64],
+    seed: Option<u64>,
+) -> Result<LouvainResult> {
+    if !weights.is_empty() && weights.len() != src.len() {
+        return Err(OnagerError::InvalidArgument(
+            "weights must be empty or same length as edges".to_string(),
+        ));
+    }
+    let csr = cache::csr_from_edges(src, dst, (!weights.is_empty()).then_some(weights), false)?;
+    compute_louvain_parallel_csr(&csr, seed)
+}
+
+/// Compute Louvain community detection in parallel on a prebuilt CSR graph.
+///
+/// Edges are treated as undirected whatever the direction of the CSR, and the
+/// CSR's edge weights are used when it has them.
+pub fn compute_louvain_parallel_csr(csr: &CsrGraph, seed: Option<u64>) -> Result<LouvainResult> {
+    if csr.edge_count() == 0 {
+        return Err(OnagerError::InvalidArgument(
+            "Cannot compute on empty graph".to_string(),
+        ));
+    }
+
+    let mut graph = LevelGraph::from_csr(csr)?;
+    let mut rng = SplitMix64::new(seed.unwrap_or(LOUVAIN_DEFAULT_SEED));
+    let mut membership: Vec<u32> = (0..csr.node_count() as u32).collect();
+    loop {
+        let communities = local_moving(&graph, &mut rng);
+        control::check()?;
+        let (dense, count) = renumber(&communities);
+        if count == graph.node_count() {
+            break;
+        }
+        for m in membership.iter_mut() {
+            *m = dense[*m as usize];
+        }
+        graph = graph.coarsen(&dense, count);
+    }
+
+    Ok(LouvainResult {
+        node_ids: csr.ids().to_vec(),
+        community_ids: membership.into_iter().map(i64::from).collect(),
+    })
+}
+
+/// A symmetric weighted graph of one Louvain level.
+///
+/// Row `v` holds every `(neighbor, weight)` entry of the adjacency matrix, so an
+/// undirected edge appears in both rows and a self-loop of weight `w` adds `2w`
+/// to the diagonal. Coarsened levels keep the internal weight of a community as
+/// its self-loop.
+struct LevelGraph {
+    offsets: Vec<usize>,
+    targets: Vec<u32>,
+    weights: Vec<f64>,
+    /// Weighted degree of every node.
+    degree: Vec<f64>,
+    /// Sum of all degrees, twice the total edge weight.
+    total: f64,
+}
+
+impl LevelGraph {
+    fn from_csr(csr: &CsrGraph) -> Result<Self> {
+        let n = csr.node_count();
+        let mut offsets = Vec::with_capacity(n + 1);
+        let mut targets = Vec::with_capacity(2 * csr.edge_count());
+        let mut weights = Vec::with_capacity(2 * csr.edge_count());
+        offsets.push(0);
+        for v in 0..n as u32 {
+            for (neighbors, w) in [
+                (csr.out_neighbors(v), csr.out_weights(v)),
+                (csr.in_neighbors(v), csr.in_weights(v)),
+            ] {
+                targets.extend_from_slice(neighbors);
+                match w {
+                    Some(w) => weights.extend(w.iter()),
+                    None => weights.resize(targets.len(), 1.0),
+                }
+            }
+            offsets.push(targets.len());
+        }
+        if weights.iter().any(|w| !w.is_finite() || *w < 0.0) {
+            return Err(OnagerError::InvalidArgument(
+                "Louvain requires non-negative edge weights".to_string(),
+            ));
+        }
+        Ok(Self::from_rows(offsets, targets, weights))
+    }
+
+    fn from_rows(offsets: Vec<usize>, targets: Vec<u32>, weights: Vec<f64>) -> Self {
+        let degree: Vec<f64> = offsets
+            .windows(2)
+            .map(|w| weights[w[0]..w[1]].iter().sum())
+            .collect();
+        let total = degree.iter().sum();
+        LevelGraph {
+            offsets,
+            targets,
+            weights,
+            degree,
+            total,
+        }
+    }
+
+    fn node_count(&self) -> usize {
+        self.degree.len()
+    }
+
+    fn row(&self, v: usize) -> impl Iterator<Item = (u32, f64)> + '_ {
+        let edges = self.offsets[v]..self.offsets[v + 1];
+        self.targets[edges.clone()]
+            .iter()
+            .copied()
+            .zip(self.weights[edges].iter().copied())
+    }
+
+    /// Builds the next level, with one node per community of `community`.
+    fn coarsen(&self, community: &[u32], count: usize) -> LevelGraph {
+        // Members of every community, grouped by a counting sort.
+        let mut start = vec![0usize; count + 1];
+        for &c in community {
+            start[c as usize + 1] += 1;
+        }
+        for c in 0..count {
+            start[c + 1] += start[c];
+        }
+        let mut fill = start.clone();
+        let mut members = vec![0u32; community.len()];
+        for (v, &c) in community.iter().enumerate() {
+            members[fill[c as usize]] = v as u32;
+            fill[c as usize] += 1;
+        }
+
+        let blocks = map_blocks(count, LOUVAIN_BLOCK, Vec::new, |entries, range| {
+            let mut lens = Vec::with_capacity(range.len());
+            let mut targets = Vec::new();
+            let mut weights = Vec::new();
+            for c in range {
+                entries.clear();
+                for &v in &members[start[c]..start[c + 1]] {
+                    entries.extend(
+                        self.row(v as usize)
+                            .map(|(u, w)| (community[u as usize], w)),
+                    );
+                }
+                let before = targets.len();
+                merge_entries(entries, |d, w| {
+                    targets.push(d);
+                    weights.push(w);
+                });
+                lens.push(targets.len() - before);
+            }
+            (lens, targets, weights)
+        });
+
+        let edges = blocks.iter().map(|(_, t, _)| t.len()).sum();
+        let mut offsets = Vec::with_capacity(count + 1);
+        let mut targets = Vec::with_capacity(edges);
+        let mut weights = Vec::with_capacity(edges);
+        offsets.push(0);
+        for (lens, t, w) in blocks {
+            for len in lens {
+                offsets.push(offsets[offsets.len() - 1] + len);
+            }
+            targets.extend(t);
+            weights.extend(w);
+        }
+        LevelGraph::from_rows(offsets, targets, weights)
+    }
+}
+
+/// Sorts `(community, weight)` entries and calls `emit` once per community with
+/// the total weight, in community order.
+fn merge_entries(entries: &mut [(u32, f64)], mut emit: impl FnMut(u32, f64)) {
+    entries.sort_unstable_by_key(|&(c, _)| c);
+    let mut i = 0;
+    while i < entries.len() {
+        let c = entries[i].0;
+        let mut total = 0.0;
+        while i < entries.len() && entries[i].0 == c {
+            total += entries[i].1;
+            i += 1;
+        }
+        emit(c, total);
+    }
+}
+
+/// Community state shared by the workers of one round.
+struct Communities {
+    of: Vec<u32>,
+    /// Total degree of the members of every community.
+    weight: Vec<f64>,
+    size: Vec<u32>,
+}
+
+/// Moves nodes between communities until no node can improve modularity, and
+/// returns the community of every node.
+fn local_moving(graph: &LevelGraph, rng: &mut SplitMix64) -> Vec<u32> {
+    let n = graph.node_count();
+    let mut state = Communities {
+        of: (0..n as u32).collect(),
+        weight: graph.degree.clone(),
+        size: vec![1; n],
+    };
+    if graph.total <= 0.0 {
+        return state.of;
+    }
+
+    // Only nodes whose neighborhood changed since they were last visited are
+    // visited again.
+    let mut active = vec![true; n];
+    for _ in 0..LOUVAIN_MAX_PASSES {
+        // The caller fails the call once this returns.
+        if control::interrupted() {
+            break;
+        }
+        let order: Vec<u32> = rng
+            .sample(n, n)
+            .into_iter()
+            .filter(|&v| active[v as usize])
+            .collect();
+        if order.is_empty() {
+            break;
+        }
+        for nodes in order.chunks(order.len().div_ceil(LOUVAIN_ROUNDS)) {
+            let mut moves: Vec<(u32, u32)> =
+                map_blocks(nodes.len(), LOUVAIN_BLOCK, Vec::new, |entries, range| {
+                    nodes[range]
+                        .iter()
+                        .filter_map(|&v| best_community(graph, &state, v, entries).map(|c| (v, c)))
+                        .collect::<Vec<_>>()
+                })
+                .into_iter()
+                .flatten()
+                .collect();
+            for &v in nodes {
+                active[v as usize] = false;
+            }
+            moves.sort_unstable_by_key(|&(v, _)| v);
+            for &(v, c) in &moves {
+                let (v, c) = (v as usize, c as usize);
+                let own = state.of[v] as usize;
+                let k = graph.degree[v];
+                state.weight[own] -= k;
+                state.size[own] -= 1;
+                state.weight[c] += k;
+                state.size[c] += 1;
+                state.of[v] = c as u32;
+                for (u, _) in graph.row(v) {
+                    active[u as usize] = true;
+                }
+            }
+        }
+    }
+    state.of
+}
+
+/// Returns the community that improves modularity the most when `v` joins it, or
+/// None if staying in its own community is at least as good.
+fn best_community(
+    graph: &LevelGraph,
+    state: &Communities,
+    v: u32,
+    entries: &mut Vec<(u32, f64)>,
+) -> Option<u32> {
+    let own = state.of[v as usize];
+    let k = graph.degree[v as usize];
+    entries.clear();
+    entries.extend(
+        graph
+            .row(v as usize)
+            .filter(|&(u, _)| u != v)
+            .map(|(u, w)| (state.of[u as usize], w)),
+    );
+
+    // Gain of joining a community, up to a constant: the weight to c minus its expected value.
+    let gain = |to: f64, weight: f64| to - k * weight / graph.total;
+    let mut stay = gain(0.0, state.weight[own as usize] - k);
+    let mut best: Option<(u32, f64)> = None;
+    merge_entries(entries, |c, to| {
+        if c == own {
+            stay = gain(to, state.weight[own as usize] - k);
+        } else {
+            let g = gain(to, state.weight[c as usize]);
+            if best.is_none_or(|(_, b)| g > b) {
+                best = Some((c, g));
+            }
+        }
+    });
+
+    let (c, g) = best?;
+    if g <= stay + LOUVAIN_MIN_GAIN * k {
+        return None;
+    }
+    if state.size[own as usize] == 1 && state.size[c as usize] == 1 && c > own {
+        return None;
+    }
+    Some(c)
+}
+
+/// Renumbers community labels densely in order of first appearance.
+fn renumber(communities: &[u32]) -> (Vec<u32>, usize) {
+    let mut label = vec![u32::MAX; communities.len()];
+    let mut count = 0;
+    let dense = communities
+        .iter()
+        .map(|&c| {
+            let slot = &mut label[c as usize];
+            if *slot == u32::MAX {
+                *slot = count;
+                count += 1;
+            }
+            *slot
+        })
+        .collect();
+    (dense, count as usize)
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    /// Two 5-cliques joined by a single edge.
+    fn two_cliques() -> (Vec<i64>, Vec<i64>) {
+        let mut src = Vec::new();
+        let mut dst = Vec::new();
+        for base in [0, 10] {
+            for i in 0..5 {
+                for j in i + 1..5 {
+                    src.push(base + i);
+                    dst.push(base + j);
+                }
+            }
+        }
+        src.push(4);
+        dst.push(10);
+        (src, dst)
+    }
+
+    fn community_of(result: &LouvainResult, node: i64) -> i64 {
+        let i = result.node_ids.iter().position(|&n| n == node).unwrap();
+        result.community_ids[i]
+    }
+
+    #[test]
+    fn test_louvain_parallel_two_cliques() {
+        let (src, dst) = two_cliques();
+        let result = compute_louvain_parallel(&src, &dst, &[], Some(42)).unwrap();
+        assert_eq!(result.node_ids.len(), 10);
+        for node in 1..5 {
+            assert_eq!(community_of(&result, node), community_of(&result, 0));
+            assert_eq!(community_of(&result, 10 + node), community_of(&result, 10));
+        }
+        assert_ne!(community_of(&result, 0), community_of(&result, 10));
+    }
+
+    #[test]
+    fn test_louvain_parallel_is_reproducible() {
+        let mut rng = SplitMix64::new(3);
+        let (src, dst): (Vec<i64>, Vec<i64>) = (0..4000)
+            .map(|_| (rng.below(600) as i64, rng.below(600) as i64))
+            .unzip();
+        let a = compute_louvain_parallel(&src, &dst, &[], Some(9)).unwrap();
+        let b = compute_louvain_parallel(&src, &dst, &[], Some(9)).unwrap();
+        assert_eq!(a.community_ids, b.community_ids);
+        let communities: std::collections::HashSet<i64> = a.community_ids.iter().copied().collect();
+        assert!(communities.len() > 1 && communities.len() < 600);
+    }
+
+    #[test]
+    fn test_louvain_parallel_weights_pick_partition() {
+        // A 4-cycle whose heavy edges pair 1 with 2 and 3 with 4
+        let src = vec![1, 2, 3, 4];
+        let dst = vec![2, 3, 4, 1];
+        let result = compute_louvain_parallel(&src, &dst, &[10.0, 1.0, 10.0, 1.0], None).unwrap();
+        assert_eq!(community_of(&result, 1), community_of(&result, 2));
+        assert_eq!(community_of(&result, 3), community_of(&result, 4));
+        assert_ne!(community_of(&result, 1), community_of(&result, 3));
+
+        let result = compute_louvain_parallel(&src, &dst, &[1.0, 10.0, 1.0, 10.0], None).unwrap();
+        assert_eq!(community_of(&result, 2), community_of(&result, 3));
+        assert_eq!(community_of(&result, 4), community_of(&result, 1));
+    }
+
+    #[test]
+    fn test_louvain_parallel_invalid_input() {
+        assert!(compute_louvain_parallel(&[], &[], &[], None).is_err());
+        assert!(compute_louvain_parallel(&[1, 2], &[2], &[], None).is_err());
+        assert!(compute_louvain_parallel(&[1, 2], &[2, 3], &[1.0], None).is_err());
+        assert!(compute_louvain_parallel(&[1, 2], &[2, 3], &[1.0, -1.0], None).is_err());
+    }
+
+    #[test]
+    fn test_coarsen_keeps_total_weight() {
+        let (src, dst) = two_cliques();
+        let csr = CsrGraph::from_edges(&src, &dst, None, false).unwrap();
+        let graph = LevelGraph::from_csr(&csr).unwrap();
+        let community: Vec<u32> = (0..10).map(|v| if v < 5 { 0 } else { 1 }).collect();
+        let coarse = graph.coarsen(&community, 2);
+        assert_eq!(coarse.node_count(), 2);
+        assert_eq!(coarse.total, graph.total);
+        // Each clique keeps its 10 internal edges counted twice, plus the bridge
+        let row: Vec<(u32, f64)> = coarse.row(0).collect();
+        assert_eq!(row, vec![(0, 20.0), (1, 1.0)]);
+    }
+}
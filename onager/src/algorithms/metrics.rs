@@ -2,16 +2,13 @@
 //!
 //! Diameter, Radius, Average Clustering, Average Path Length, Transitivity, Triangle Count, Assortativity.
 
-use graphina::core::types::{Graph, NodeId};
-use graphina::metrics::{
-    assortativity, average_clustering_coefficient, average_path_length, diameter, radius,
-    transitivity,
-};
-use graphina::parallel::triangles_parallel;
+use graphina::metrics::{assortativity, average_path_length, diameter, radius};
 use ordered_float::OrderedFloat;
 
+use crate::algorithms::triangles::TriangleCensus;
+use crate::cache;
+use crate::csr::CsrGraph;
 use crate::error::{OnagerError, Result};
-use std::collections::HashMap;
 
 /// Compute graph diameter (longest shortest path).
 pub fn compute_diameter(src: &[i64], dst: &[i64]) -> Result<i64> {
@@ -26,23 +23,8 @@ pub fn compute_diameter(src: &[i64], dst: &[i64]) -> Result<i64> {
         ));
     }
 
-    let mut node_set: HashMap<i64, NodeId> = HashMap::new();
-    let mut graph: Graph<i64, OrderedFloat<f64>> = Graph::new();
-    for &node in src.iter().chain(dst.iter()) {
-        if !node_set.contains_key(&node) {
-            let id = graph.add_node(node);
-            node_set.insert(node, id);
-        }
-    }
-    for i in 0..src.len() {
-        let src_id = *node_set.get(&src[i]).ok_or_else(|| {
-            OnagerError::InvalidArgument(format!("Source node {} not found in graph", src[i]))
-        })?;
-        let dst_id = *node_set.get(&dst[i]).ok_or_else(|| {
-            OnagerError::InvalidArgument(format!("Destination node {} not found in graph", dst[i]))
-        })?;
-        graph.add_edge(src_id, dst_id, OrderedFloat(1.0));
-    }
+    let csr = cache::csr_from_edges(src, dst, None, false)?;
+    let (graph, _) = csr.to_graph(|_| OrderedFloat(1.0))?;
     Ok(diameter(&graph).map(|d| d as i64).unwrap_or(-1))
 }
 
@@ -59,23 +41,8 @@ pub fn compute_radius(src: &[i64], dst: &[i64]) -> Result<i64> {
         ));
     }
 
-    let mut node_set: HashMap<i64, NodeId> = HashMap::new();
-    let mut graph: Graph<i64, OrderedFloat<f64>> = Graph::new();
-    for &node in src.iter().chain(dst.iter()) {
-        if !node_set.contains_key(&node) {
-            let id = graph.add_node(node);
-            node_set.insert(node, id);
-        }
-    }
-    for i in 0..src.len() {
-        let src_id = *node_set.get(&src[i]).ok_or_else(|| {
-            OnagerError::InvalidArgument(format!("Source node {} not found in graph", src[i]))
-        })?;
-        let dst_id = *node_set.get(&dst[i]).ok_or_else(|| {
-            OnagerError::InvalidArgument(format!("Destination node {} not found in graph", dst[i]))
-        })?;
-        graph.add_edge(src_id, dst_id, OrderedFloat(1.0));
-    }
+    let csr = cache::csr_from_edges(src, dst, None, false)?;
+    let (graph, _) = csr.to_graph(|_| OrderedFloat(1.0))?;
     Ok(radius(&graph).map(|v| v as i64).unwrap_or(-1))
 }
 
@@ -92,24 +59,8 @@ pub fn compute_avg_clustering(src: &[i64], dst: &[i64]) -> Result<f64> {
         ));
     }
 
-    let mut node_set: HashMap<i64, NodeId> = HashMap::new();
-    let mut graph: Graph<i64, f64> = Graph::new();
-    for &node in src.iter().chain(dst.iter()) {
-        if !node_set.contains_key(&node) {
-            let id = graph.add_node(node);
-            node_set.insert(node, id);
-        }
-    }
-    for i in 0..src.len() {
-        let src_id = *node_set.get(&src[i]).ok_or_else(|| {
-            OnagerError::InvalidArgument(format!("Source node {} not found in graph", src[i]))
-        })?;
-        let dst_id = *node_set.get(&dst[i]).ok_or_else(|| {
-            OnagerError::InvalidArgument(format!("Destination node {} not found in graph", dst[i]))
-        })?;
-        graph.add_edge(src_id, dst_id, 1.0);
-    }
-    Ok(average_clustering_coefficient(&graph))
+    let csr = cache::csr_from_edges(src, dst, None, false)?;
+    Ok(TriangleCensus::from_csr(&csr).average_clustering())
 }
 
 /// Compute average path length.
@@ -125,23 +76,8 @@ pub fn compute_avg_path_length(src: &[i64], dst: &[i64]) -> Result<f64> {
         ));
     }
 
-    let mut node_set: HashMap<i64, NodeId> = HashMap::new();
-    let mut graph: Graph<i64, OrderedFloat<f64>> = Graph::new();
-    for &node in src.iter().chain(dst.iter()) {
-        if !node_set.contains_key(&node) {
-            let id = graph.add_node(node);
-            node_set.insert(node, id);
-        }
-    }
-    for i in 0..src.len() {
-        let src_id = *node_set.get(&src[i]).ok_or_else(|| {
-            OnagerError::InvalidArgument(format!("Source node {} not found in graph", src[i]))
-        })?;
-        let dst_id = *node_set.get(&dst[i]).ok_or_else(|| {
-            OnagerError::InvalidArgument(format!("Destination node {} not found in graph", dst[i]))
-        })?;
-        graph.add_edge(src_id, dst_id, OrderedFloat(1.0));
-    }
+    let csr = cache::csr_from_edges(src, dst, None, false)?;
+    let (graph, _) = csr.to_graph(|_| OrderedFloat(1.0))?;
     Ok(average_path_length(&graph).unwrap_or(f64::NAN))
 }
 
@@ -158,24 +94,8 @@ pub fn compute_transitivity(src: &[i64], dst: &[i64]) -> Result<f64> {
         ));
     }
 
-    let mut node_set: HashMap<i64, NodeId> = HashMap::new();
-    let mut graph: Graph<i64, f64> = Graph::new();
-    for &node in src.iter().chain(dst.iter()) {
-        if !node_set.contains_key(&node) {
-            let id = graph.add_node(node);
-            node_set.insert(node, id);
-        }
-    }
-    for i in 0..src.len() {
-        let src_id = *node_set.get(&src[i]).ok_or_else(|| {
-            OnagerError::InvalidArgument(format!("Source node {} not found in graph", src[i]))
-        })?;
-        let dst_id = *node_set.get(&dst[i]).ok_or_else(|| {
-            OnagerError::InvalidArgument(format!("Destination node {} not found in graph", dst[i]))
-        })?;
-        graph.add_edge(src_id, dst_id, 1.0);
-    }
-    Ok(transitivity(&graph))
+    let csr = cache::csr_from_edges(src, dst, None, false)?;
+    Ok(TriangleCensus::from_csr(&csr).transitivity())
 }
 
 /// Result of triangle counting.
@@ -197,40 +117,16 @@ pub fn compute_triangle_count(src: &[i64], dst: &[i64]) -> Result<TriangleResult
         ));
     }
 
-    let mut node_set: HashMap<i64, NodeId> = HashMap::new();
-    let mut reverse_map: HashMap<NodeId, i64> = HashMap::new();
-    let mut graph: Graph<i64, f64> = Graph::new();
-    for &node in src.iter().chain(dst.iter()) {
-        if !node_set.contains_key(&node) {
-            let id = graph.add_node(node);
-            node_set.insert(node, id);
-            reverse_map.insert(id, node);
-        }
-    }
-    for i in 0..src.len() {
-        let src_id = *node_set.get(&src[i]).ok_or_else(|| {
-            OnagerError::InvalidArgument(format!("Source node {} not found in graph", src[i]))
-        })?;
-        let dst_id = *node_set.get(&dst[i]).ok_or_else(|| {
-            OnagerError::InvalidArgument(format!("Destination node {} not found in graph", dst[i]))
-        })?;
-        graph.add_edge(src_id, dst_id, 1.0);
-    }
-
-    let triangles = triangles_parallel(&graph);
-
-    let mut result_nodes = Vec::with_capacity(triangles.len());
-    let mut result_counts = Vec::with_capacity(triangles.len());
-    for (node_id, count) in triangles {
-        if let Some(&ext_id) = reverse_map.get(&node_id) {
-            result_nodes.push(ext_id);
-            result_counts.push(count as i64);
-        }
-    }
-    Ok(TriangleResult {
-        node_ids: result_nodes,
-        triangle_counts: result_counts,
-    })
+    let csr = cache::csr_from_edges(src, dst, None, false)?;
+    Ok(triangle_result(&csr, &TriangleCensus::from_csr(&csr)))
+}
+
+/// Pairs the per-node counts of a census with the external IDs of its graph.
+pub(crate) fn triangle_result(csr: &CsrGraph, census: &TriangleCensus) -> TriangleResult {
+    TriangleResult {
+        node_ids: csr.ids().to_vec(),
+        triangle_counts: census.triangles().iter().map(|&t| t as i64).collect(),
+    }
 }
 
 /// Compute assortativity coefficient.
@@ -248,23 +144,8 @@ pub fn compute_assortativity(src: &[i64], dst: &[i64]) -> Result<f64> {
         ));
     }
 
-    let mut node_set: HashMap<i64, NodeId> = HashMap::new();
-    let mut graph: Graph<i64, f64> = Graph::new();
-    for &node in src.iter().chain(dst.iter()) {
-        if !node_set.contains_key(&node) {
-            let id = graph.add_node(node);
-            node_set.insert(node, id);
-        }
-    }
-    for i in 0..src.len() {
-        let src_id = *node_set.get(&src[i]).ok_or_else(|| {
-            OnagerError::InvalidArgument(format!("Source node {} not found in graph", src[i]))
-        })?;
-        let dst_id = *node_set.get(&dst[i]).ok_or_else(|| {
-            OnagerError::InvalidArgument(format!("Destination node {} not found in graph", dst[i]))
-        })?;
-        graph.add_edge(src_id, dst_id, 1.0);
-    }
+    let csr = cache::csr_from_edges(src, dst, None, false)?;
+    let (graph, _) = csr.to_graph(|_| 1.0)?;
     Ok(assortativity(&graph))
 }
 
@@ -287,11 +168,10 @@ pub fn compute_graph_density(src: &[i64], dst: &[i64], directed: bool) -> Result
     }
 
     // Count unique nodes
-    let mut node_set: std::collections::HashSet<i64> = std::collections::HashSet::new();
-    for &node in src.iter().chain(dst.iter()) {
-        node_set.insert(node);
-    }
-    let n = node_set.len() as f64;
+    let mut ids: Vec<i64> = src.iter().chain(dst.iter()).copied().collect();
+    ids.sort_unstable();
+    ids.dedup();
+    let n = ids.len() as f64;
 
     if n < 2.0 {
         return Ok(0.0); // Single node graph has no edges possible
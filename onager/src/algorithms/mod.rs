@@ -10,13 +10,18 @@ pub mod approximation;
 pub mod centrality;
 pub mod community;
 pub mod generators;
+pub mod kcore;
 pub mod links;
+pub mod louvain;
 pub mod metrics;
 pub mod mst;
 pub mod parallel;
 pub mod personalized;
+pub mod power;
+pub mod search;
 pub mod subgraphs;
 pub mod traversal;
+pub mod triangles;
 
 #[cfg(test)]
 mod regression_tests;
@@ -26,11 +31,14 @@ pub use approximation::*;
 pub use centrality::*;
 pub use community::*;
 pub use generators::*;
+pub use kcore::*;
 pub use links::*;
+pub use louvain::*;
 pub use metrics::*;
 pub use mst::*;
 pub use parallel::*;
 pub use personalized::*;
+pub use search::*;
 pub use subgraphs::*;
 pub use traversal::*;
 
@@ -2,12 +2,11 @@
 //!
 //! Prim's and Kruskal's MST algorithms.
 
-use graphina::core::types::{Graph, NodeId};
 use graphina::mst::algorithms::{kruskal_mst, prim_mst};
 use ordered_float::OrderedFloat;
 
+use crate::cache;
 use crate::error::{OnagerError, Result};
-use std::collections::HashMap;
 
 /// Result of MST computation.
 pub struct MstResult {
@@ -30,26 +29,8 @@ pub fn compute_prim_mst(src: &[i64], dst: &[i64], weights: &[f64]) -> Result<Mst
         ));
     }
 
-    let mut node_set: HashMap<i64, NodeId> = HashMap::new();
-    let mut reverse_map: HashMap<NodeId, i64> = HashMap::new();
-    let mut graph: Graph<i64, OrderedFloat<f64>> = Graph::new();
-
-    for &node in src.iter().chain(dst.iter()) {
-        if !node_set.contains_key(&node) {
-            let id = graph.add_node(node);
-            node_set.insert(node, id);
-            reverse_map.insert(id, node);
-        }
-    }
-    for i in 0..src.len() {
-        let src_id = *node_set.get(&src[i]).ok_or_else(|| {
-            OnagerError::InvalidArgument(format!("Source node {} not found in graph", src[i]))
-        })?;
-        let dst_id = *node_set.get(&dst[i]).ok_or_else(|| {
-            OnagerError::InvalidArgument(format!("Destination node {} not found in graph", dst[i]))
-        })?;
-        graph.add_edge(src_id, dst_id, OrderedFloat(weights[i]));
-    }
+    let csr = cache::csr_from_edges(src, dst, Some(weights), false)?;
+    let (graph, node_index) = csr.to_graph(OrderedFloat)?;
 
     let (mst_edges, total_weight) =
         prim_mst(&graph).map_err(|e| OnagerError::GraphError(e.to_string()))?;
@@ -59,7 +40,10 @@ pub fn compute_prim_mst(src: &[i64], dst: &[i64], weights: &[f64]) -> Result<Mst
     let mut result_weights = Vec::with_capacity(mst_edges.len());
 
     for edge in mst_edges {
-        if let (Some(&s), Some(&d)) = (reverse_map.get(&edge.u), reverse_map.get(&edge.v)) {
+        if let (Some(&s), Some(&d)) = (
+            node_index.external_id(&edge.u),
+            node_index.external_id(&edge.v),
+        ) {
             result_src.push(s);
             result_dst.push(d);
             result_weights.push(edge.weight.into_inner());
@@ -87,26 +71,8 @@ pub fn compute_kruskal_mst(src: &[i64], dst: &[i64], weights: &[f64]) -> Result<
         ));
     }
 
-    let mut node_set: HashMap<i64, NodeId> = HashMap::new();
-    let mut reverse_map: HashMap<NodeId, i64> = HashMap::new();
-    let mut graph: Graph<i64, OrderedFloat<f64>> = Graph::new();
-
-    for &node in src.iter().chain(dst.iter()) {
-        if !node_set.contains_key(&node) {
-            let id = graph.add_node(node);
-            node_set.insert(node, id);
-            reverse_map.insert(id, node);
-        }
-    }
-    for i in 0..src.len() {
-        let src_id = *node_set.get(&src[i]).ok_or_else(|| {
-            OnagerError::InvalidArgument(format!("Source node {} not found in graph", src[i]))
-        })?;
-        let dst_id = *node_set.get(&dst[i]).ok_or_else(|| {
-            OnagerError::InvalidArgument(format!("Destination node {} not found in graph", dst[i]))
-        })?;
-        graph.add_edge(src_id, dst_id, OrderedFloat(weights[i]));
-    }
+    let csr = cache::csr_from_edges(src, dst, Some(weights), false)?;
+    let (graph, node_index) = csr.to_graph(OrderedFloat)?;
 
     let (mst_edges, total_weight) =
         kruskal_mst(&graph).map_err(|e| OnagerError::GraphError(e.to_string()))?;
@@ -116,7 +82,10 @@ pub fn compute_kruskal_mst(src: &[i64], dst: &[i64], weights: &[f64]) -> Result<
     let mut result_weights = Vec::with_capacity(mst_edges.len());
 
     for edge in mst_edges {
-        if let (Some(&s), Some(&d)) = (reverse_map.get(&edge.u), reverse_map.get(&edge.v)) {
+        if let (Some(&s), Some(&d)) = (
+            node_index.external_id(&edge.u),
+            node_index.external_id(&edge.v),
+        ) {
             result_src.push(s);
             result_dst.push(d);
             result_weights.push(edge.weight.into_inner());
@@ -1,27 +1,122 @@
 //! Parallel algorithms module.
 //!
 //! Parallel PageRank, BFS, shortest paths, connected components, clustering, triangles.
+//! Everything runs natively on the CSR graph through the worker helpers, so the
+//! thread budget of the call bounds every algorithm here.
 
-use graphina::core::types::{Digraph, Graph, NodeId};
-use graphina::parallel::{
-    bfs_parallel, clustering_coefficients_parallel, connected_components_parallel,
-    pagerank_parallel, shortest_paths_parallel, triangles_parallel,
-};
-
-use crate::algorithms::centrality::PageRankResult;
+use crate::algorithms::centrality::{pagerank_csr, PageRankResult};
 use crate::algorithms::community::ConnectedComponentsResult;
-use crate::algorithms::metrics::TriangleResult;
+use crate::algorithms::metrics::{triangle_result, TriangleResult};
 use crate::algorithms::traversal::BfsResult;
+use crate::algorithms::triangles::TriangleCensus;
+use crate::cache;
+use crate::control;
+use crate::csr::CsrGraph;
 use crate::error::{OnagerError, Result};
-use std::collections::HashMap;
+use crate::workers::map_blocks;
+
+/// Frontier size from which a BFS level is expanded by several workers.
+const PARALLEL_FRONTIER: usize = 4096;
+
+/// Frontier nodes per block of a parallel BFS level.
+const FRONTIER_BLOCK: usize = 1024;
+
+/// Runs a level-synchronous BFS over undirected neighbors from `source`.
+///
+/// Returns the visit order and the hop distance of every node, with `u32::MAX`
+/// for nodes that are not reached. Large levels are expanded in parallel, and
+/// new nodes are claimed in frontier order, so the visit order is the same for
+/// any number of threads.
+fn level_bfs(csr: &CsrGraph, source: u32) -> Result<(Vec<u32>, Vec<u32>)> {
+    let n = csr.node_count();
+    let mut dist = vec![u32::MAX; n];
+    dist[source as usize] = 0;
+    let mut order = vec![source];
+    let mut start = 0;
+    let mut level = 0;
+    while start < order.len() {
+        control::checkpoint(order.len(), n)?;
+        let end = order.len();
+        level += 1;
+        if end - start >= PARALLEL_FRONTIER {
+            let (frontier, seen) = (&order[start..end], &dist);
+            let found = map_blocks(
+                frontier.len(),
+                FRONTIER_BLOCK,
+                || (),
+                |_, range| {
+                    let mut next = Vec::new();
+                    for &u in &frontier[range] {
+                        next.extend(csr.neighbors(u).filter(|&v| seen[v as usize] == u32::MAX));
+                    }
+                    next
+                },
+            );
+            for v in found.into_iter().flatten() {
+                if dist[v as usize] == u32::MAX {
+                    dist[v as usize] = level;
+                    order.push(v);
+                }
+            }
+        } else {
+            for i in start..end {
+                for v in csr.neighbors(order[i]) {
+                    if dist[v as usize] == u32::MAX {
+                        dist[v as usize] = level;
+                        order.push(v);
+                    }
+                }
+            }
+        }
+        start = end;
+    }
+    Ok((order, dist))
+}
+
+/// Labels every node with its undirected component, numbered by the first node of each.
+fn component_labels(csr: &CsrGraph) -> Vec<i64> {
+    let n = csr.node_count();
+    let mut parent: Vec<u32> = (0..n as u32).collect();
+    let find = |parent: &mut Vec<u32>, mut x: u32| {
+        while parent[x as usize] != x {
+            let grandparent = parent[parent[x as usize] as usize];
+            parent[x as usize] = grandparent;
+            x = grandparent;
+        }
+        x
+    };
+    for u in 0..n as u32 {
+        for &v in csr.out_neighbors(u) {
+            let (a, b) = (find(&mut parent, u), find(&mut parent, v));
+            if a != b {
+                parent[a.max(b) as usize] = a.min(b);
+            }
+        }
+    }
+    let mut labels = vec![-1i64; n];
+    let mut next = 0;
+    for u in 0..n as u32 {
+        let root = find(&mut parent, u) as usize;
+        if labels[root] < 0 {
+            labels[root] = next;
+            next += 1;
+        }
+        labels[u as usize] = labels[root];
+    }
+    labels
+}
 
 /// Compute PageRank using parallel algorithm.
+///
+/// Runs the native power iteration of [`pagerank_csr`], with the edge weights
+/// scaling the share of rank each edge carries when they are given.
 pub fn compute_pagerank_parallel(
     src: &[i64],
     dst: &[i64],
     weights: &[f64],
     damping: f64,
     iterations: usize,
+    tolerance: f64,
     directed: bool,
 ) -> Result<PageRankResult> {
     if src.len() != dst.len() {
@@ -40,83 +135,15 @@ pub fn compute_pagerank_parallel(
         ));
     }
 
-    let mut node_set: HashMap<i64, NodeId> = HashMap::new();
-
-    if directed {
-        let mut graph: Digraph<i64, f64> = Digraph::new();
-        for &node in src.iter().chain(dst.iter()) {
-            if !node_set.contains_key(&node) {
-                let id = graph.add_node(node);
-                node_set.insert(node, id);
-            }
-        }
-        for i in 0..src.len() {
-            let src_id = *node_set.get(&src[i]).ok_or_else(|| {
-                OnagerError::InvalidArgument(format!("Source node {} not found in graph", src[i]))
-            })?;
-            let dst_id = *node_set.get(&dst[i]).ok_or_else(|| {
-                OnagerError::InvalidArgument(format!(
-                    "Destination node {} not found in graph",
-                    dst[i]
-                ))
-            })?;
-            let weight = if weights.is_empty() { 1.0 } else { weights[i] };
-            graph.add_edge(src_id, dst_id, weight);
-        }
-
-        let ranks = pagerank_parallel(&graph, damping, iterations, 1e-6, None);
-        let reverse_map: HashMap<NodeId, i64> = node_set.iter().map(|(&k, &v)| (v, k)).collect();
-
-        let mut node_ids = Vec::with_capacity(ranks.len());
-        let mut rank_values = Vec::with_capacity(ranks.len());
-        for (node_id, rank) in ranks {
-            if let Some(&ext_id) = reverse_map.get(&node_id) {
-                node_ids.push(ext_id);
-                rank_values.push(rank);
-            }
-        }
-        Ok(PageRankResult {
-            node_ids,
-            ranks: rank_values,
-        })
-    } else {
-        let mut graph: Graph<i64, f64> = Graph::new();
-        for &node in src.iter().chain(dst.iter()) {
-            if !node_set.contains_key(&node) {
-                let id = graph.add_node(node);
-                node_set.insert(node, id);
-            }
-        }
-        for i in 0..src.len() {
-            let src_id = *node_set.get(&src[i]).ok_or_else(|| {
-                OnagerError::InvalidArgument(format!("Source node {} not found in graph", src[i]))
-            })?;
-            let dst_id = *node_set.get(&dst[i]).ok_or_else(|| {
-                OnagerError::InvalidArgument(format!(
-                    "Destination node {} not found in graph",
-                    dst[i]
-                ))
-            })?;
-            let weight = if weights.is_empty() { 1.0 } else { weights[i] };
-            graph.add_edge(src_id, dst_id, weight);
-        }
-
-        let ranks = pagerank_parallel(&graph, damping, iterations, 1e-6, None);
-        let reverse_map: HashMap<NodeId, i64> = node_set.iter().map(|(&k, &v)| (v, k)).collect();
-
-        let mut node_ids = Vec::with_capacity(ranks.len());
-        let mut rank_values = Vec::with_capacity(ranks.len());
-        for (node_id, rank) in ranks {
-            if let Some(&ext_id) = reverse_map.get(&node_id) {
-                node_ids.push(ext_id);
-                rank_values.push(rank);
-            }
-        }
-        Ok(PageRankResult {
-            node_ids,
-            ranks: rank_values,
-        })
-    }
+    let csr = cache::csr_from_edges(src, dst, (!weights.is_empty()).then_some(weights), directed)?;
+    pagerank_csr(
+        &csr,
+        !weights.is_empty(),
+        damping,
+        iterations,
+        tolerance,
+        &[],
+    )
 }
 
 /// Compute parallel BFS traversal from a single source.
@@ -132,40 +159,12 @@ pub fn compute_bfs_parallel(src: &[i64], dst: &[i64], source: i64) -> Result<Bfs
         ));
     }
 
-    let mut node_set: HashMap<i64, NodeId> = HashMap::new();
-    let mut reverse_map: HashMap<NodeId, i64> = HashMap::new();
-    let mut graph: Graph<i64, f64> = Graph::new();
-
-    for &node in src.iter().chain(dst.iter()) {
-        if !node_set.contains_key(&node) {
-            let id = graph.add_node(node);
-            node_set.insert(node, id);
-            reverse_map.insert(id, node);
-        }
-    }
-    for i in 0..src.len() {
-        let src_id = *node_set.get(&src[i]).ok_or_else(|| {
-            OnagerError::InvalidArgument(format!("Source node {} not found in graph", src[i]))
-        })?;
-        let dst_id = *node_set.get(&dst[i]).ok_or_else(|| {
-            OnagerError::InvalidArgument(format!("Destination node {} not found in graph", dst[i]))
-        })?;
-        graph.add_edge(src_id, dst_id, 1.0);
-    }
-
-    let source_id = node_set
-        .get(&source)
+    let csr = cache::csr_from_edges(src, dst, None, false)?;
+    let source = csr
+        .dense_id(source)
         .ok_or(OnagerError::NodeNotFound(source))?;
-
-    // bfs_parallel takes a slice of sources - we pass a single source
-    let results = bfs_parallel(&graph, &[*source_id]);
-    // Get the first (and only) result
-    let visit_order = results.into_iter().next().unwrap_or_default();
-
-    let order: Vec<i64> = visit_order
-        .into_iter()
-        .filter_map(|node_id| reverse_map.get(&node_id).copied())
-        .collect();
+    let (visited, _) = level_bfs(&csr, source)?;
+    let order: Vec<i64> = visited.into_iter().map(|u| csr.external_id(u)).collect();
 
     Ok(BfsResult {
         node_ids: order.clone(),
@@ -180,6 +179,8 @@ pub struct ShortestPathsParallelResult {
 }
 
 /// Compute parallel shortest paths from a single source.
+///
+/// Returns the hop distance of every reachable node, in node ID order.
 pub fn compute_shortest_paths_parallel(
     src: &[i64],
     dst: &[i64],
@@ -196,46 +197,22 @@ pub fn compute_shortest_paths_parallel(
         ));
     }
 
-    let mut node_set: HashMap<i64, NodeId> = HashMap::new();
-    let mut reverse_map: HashMap<NodeId, i64> = HashMap::new();
-    let mut graph: Graph<i64, f64> = Graph::new();
-
-    for &node in src.iter().chain(dst.iter()) {
-        if !node_set.contains_key(&node) {
-            let id = graph.add_node(node);
-            node_set.insert(node, id);
-            reverse_map.insert(id, node);
-        }
-    }
-    for i in 0..src.len() {
-        let src_id = *node_set.get(&src[i]).ok_or_else(|| {
-            OnagerError::InvalidArgument(format!("Source node {} not found in graph", src[i]))
-        })?;
-        let dst_id = *node_set.get(&dst[i]).ok_or_else(|| {
-            OnagerError::InvalidArgument(format!("Destination node {} not found in graph", dst[i]))
-        })?;
-        graph.add_edge(src_id, dst_id, 1.0);
-    }
-
-    let source_id = node_set
-        .get(&source)
+    let csr = cache::csr_from_edges(src, dst, None, false)?;
+    let source = csr
+        .dense_id(source)
         .ok_or(OnagerError::NodeNotFound(source))?;
-
-    // shortest_paths_parallel takes a slice of sources, returns Vec<HashMap<NodeId, usize>>
-    let results = shortest_paths_parallel(&graph, &[*source_id]);
-    let distances_map = results.into_iter().next().unwrap_or_default();
-
-    let mut node_ids = Vec::with_capacity(distances_map.len());
-    let mut dist_values = Vec::with_capacity(distances_map.len());
-    for (node_id, dist) in distances_map {
-        if let Some(&ext_id) = reverse_map.get(&node_id) {
-            node_ids.push(ext_id);
-            dist_values.push(dist as f64);
-        }
-    }
+    let (_, dist) = level_bfs(&csr, source)?;
+
+    let (node_ids, distances) = csr
+        .ids()
+        .iter()
+        .zip(dist)
+        .filter(|&(_, d)| d != u32::MAX)
+        .map(|(&id, d)| (id, f64::from(d)))
+        .unzip();
     Ok(ShortestPathsParallelResult {
         node_ids,
-        distances: dist_values,
+        distances,
     })
 }
 
@@ -252,41 +229,10 @@ pub fn compute_components_parallel(src: &[i64], dst: &[i64]) -> Result<Connected
         ));
     }
 
-    let mut node_set: HashMap<i64, NodeId> = HashMap::new();
-    let mut reverse_map: HashMap<NodeId, i64> = HashMap::new();
-    let mut graph: Graph<i64, f64> = Graph::new();
-
-    for &node in src.iter().chain(dst.iter()) {
-        if !node_set.contains_key(&node) {
-            let id = graph.add_node(node);
-            node_set.insert(node, id);
-            reverse_map.insert(id, node);
-        }
-    }
-    for i in 0..src.len() {
-        let src_id = *node_set.get(&src[i]).ok_or_else(|| {
-            OnagerError::InvalidArgument(format!("Source node {} not found in graph", src[i]))
-        })?;
-        let dst_id = *node_set.get(&dst[i]).ok_or_else(|| {
-            OnagerError::InvalidArgument(format!("Destination node {} not found in graph", dst[i]))
-        })?;
-        graph.add_edge(src_id, dst_id, 1.0);
-    }
-
-    // connected_components_parallel returns HashMap<NodeId, usize>
-    let components = connected_components_parallel(&graph);
-
-    let mut node_ids = Vec::with_capacity(components.len());
-    let mut component_ids = Vec::with_capacity(components.len());
-    for (internal_id, comp_id) in components {
-        if let Some(&ext_id) = reverse_map.get(&internal_id) {
-            node_ids.push(ext_id);
-            component_ids.push(comp_id as i64);
-        }
-    }
+    let csr = cache::csr_from_edges(src, dst, None, false)?;
     Ok(ConnectedComponentsResult {
-        node_ids,
-        component_ids,
+        node_ids: csr.ids().to_vec(),
+        component_ids: component_labels(&csr),
     })
 }
 
@@ -309,40 +255,10 @@ pub fn compute_clustering_parallel(src: &[i64], dst: &[i64]) -> Result<Clusterin
         ));
     }
 
-    let mut node_set: HashMap<i64, NodeId> = HashMap::new();
-    let mut reverse_map: HashMap<NodeId, i64> = HashMap::new();
-    let mut graph: Graph<i64, f64> = Graph::new();
-
-    for &node in src.iter().chain(dst.iter()) {
-        if !node_set.contains_key(&node) {
-            let id = graph.add_node(node);
-            node_set.insert(node, id);
-            reverse_map.insert(id, node);
-        }
-    }
-    for i in 0..src.len() {
-        let src_id = *node_set.get(&src[i]).ok_or_else(|| {
-            OnagerError::InvalidArgument(format!("Source node {} not found in graph", src[i]))
-        })?;
-        let dst_id = *node_set.get(&dst[i]).ok_or_else(|| {
-            OnagerError::InvalidArgument(format!("Destination node {} not found in graph", dst[i]))
-        })?;
-        graph.add_edge(src_id, dst_id, 1.0);
-    }
-
-    let coefficients = clustering_coefficients_parallel(&graph);
-
-    let mut node_ids = Vec::with_capacity(coefficients.len());
-    let mut coef_values = Vec::with_capacity(coefficients.len());
-    for (node_id, coef) in coefficients {
-        if let Some(&ext_id) = reverse_map.get(&node_id) {
-            node_ids.push(ext_id);
-            coef_values.push(coef);
-        }
-    }
+    let csr = cache::csr_from_edges(src, dst, None, false)?;
     Ok(ClusteringParallelResult {
-        node_ids,
-        coefficients: coef_values,
+        node_ids: csr.ids().to_vec(),
+        coefficients: TriangleCensus::from_csr(&csr).local_clustering(),
     })
 }
 
@@ -359,41 +275,8 @@ pub fn compute_triangles_parallel(src: &[i64], dst: &[i64]) -> Result<TriangleRe
         ));
     }
 
-    let mut node_set: HashMap<i64, NodeId> = HashMap::new();
-    let mut reverse_map: HashMap<NodeId, i64> = HashMap::new();
-    let mut graph: Graph<i64, f64> = Graph::new();
-
-    for &node in src.iter().chain(dst.iter()) {
-        if !node_set.contains_key(&node) {
-            let id = graph.add_node(node);
-            node_set.insert(node, id);
-            reverse_map.insert(id, node);
-        }
-    }
-    for i in 0..src.len() {
-        let src_id = *node_set.get(&src[i]).ok_or_else(|| {
-            OnagerError::InvalidArgument(format!("Source node {} not found in graph", src[i]))
-        })?;
-        let dst_id = *node_set.get(&dst[i]).ok_or_else(|| {
-            OnagerError::InvalidArgument(format!("Destination node {} not found in graph", dst[i]))
-        })?;
-        graph.add_edge(src_id, dst_id, 1.0);
-    }
-
-    let triangles = triangles_parallel(&graph);
-
-    let mut node_ids = Vec::with_capacity(triangles.len());
-    let mut triangle_counts = Vec::with_capacity(triangles.len());
-    for (node_id, count) in triangles {
-        if let Some(&ext_id) = reverse_map.get(&node_id) {
-            node_ids.push(ext_id);
-            triangle_counts.push(count as i64);
-        }
-    }
-    Ok(TriangleResult {
-        node_ids,
-        triangle_counts,
-    })
+    let csr = cache::csr_from_edges(src, dst, None, false)?;
+    Ok(triangle_result(&csr, &TriangleCensus::from_csr(&csr)))
 }
 
 #[cfg(test)]
@@ -413,7 +296,7 @@ mod tests {
     #[test]
     fn test_pagerank_parallel_undirected() {
         let (src, dst) = triangle_graph();
-        let result = compute_pagerank_parallel(&src, &dst, &[], 0.85, 100, false).unwrap();
+        let result = compute_pagerank_parallel(&src, &dst, &[], 0.85, 100, 1e-6, false).unwrap();
 
         assert_eq!(result.node_ids.len(), 3);
         assert_eq!(result.ranks.len(), 3);
@@ -426,7 +309,7 @@ mod tests {
     #[test]
     fn test_pagerank_parallel_directed() {
         let (src, dst) = triangle_graph();
-        let result = compute_pagerank_parallel(&src, &dst, &[], 0.85, 100, true).unwrap();
+        let result = compute_pagerank_parallel(&src, &dst, &[], 0.85, 100, 1e-6, true).unwrap();
 
         assert_eq!(result.node_ids.len(), 3);
         assert!(!result.ranks.is_empty());
@@ -436,11 +319,33 @@ mod tests {
     fn test_pagerank_parallel_with_weights() {
         let (src, dst) = triangle_graph();
         let weights = vec![1.0, 2.0, 1.5];
-        let result = compute_pagerank_parallel(&src, &dst, &weights, 0.85, 100, false).unwrap();
+        let result =
+            compute_pagerank_parallel(&src, &dst, &weights, 0.85, 100, 1e-6, false).unwrap();
 
         assert_eq!(result.node_ids.len(), 3);
     }
 
+    #[test]
+    fn test_pagerank_parallel_weights_shift_rank() {
+        // Node 1 sends most of its rank to 2, which only links back to 1
+        let src = vec![1, 1, 2, 3];
+        let dst = vec![2, 3, 1, 1];
+        let weights = vec![9.0, 1.0, 1.0, 1.0];
+        let result =
+            compute_pagerank_parallel(&src, &dst, &weights, 0.85, 100, 1e-9, true).unwrap();
+        assert!(result.ranks[1] > result.ranks[2]);
+        assert!(compute_pagerank_parallel(
+            &src,
+            &dst,
+            &[1.0, -1.0, 1.0, 1.0],
+            0.85,
+            100,
+            1e-6,
+            true
+        )
+        .is_err());
+    }
+
     #[test]
     fn test_bfs_parallel() {
         let (src, dst) = connected_graph();
@@ -451,6 +356,35 @@ mod tests {
         assert!(result.order.len() <= 4);
     }
 
+    #[test]
+    fn test_bfs_parallel_levels_match_sequential_search() {
+        // A long path with a wide fan at its end, so some levels run in parallel
+        let mut src: Vec<i64> = (0..50).collect();
+        let mut dst: Vec<i64> = (1..51).collect();
+        for leaf in 0..10_000 {
+            src.push(50);
+            dst.push(100 + leaf);
+            src.push(100 + leaf);
+            dst.push(20_000 + leaf % 7);
+        }
+        let bfs = compute_bfs_parallel(&src, &dst, 0).unwrap();
+        assert_eq!(bfs.order.len(), 51 + 10_000 + 7);
+        assert_eq!(&bfs.order[..3], &[0, 1, 2]);
+
+        let paths = compute_shortest_paths_parallel(&src, &dst, 0).unwrap();
+        let dist = |node: i64| {
+            let i = paths.node_ids.iter().position(|&n| n == node).unwrap();
+            paths.distances[i]
+        };
+        assert_eq!(dist(0), 0.0);
+        assert_eq!(dist(50), 50.0);
+        assert_eq!(dist(100), 51.0);
+        assert_eq!(dist(20_003), 52.0);
+        let mut reached = bfs.order.clone();
+        reached.sort_unstable();
+        assert_eq!(paths.node_ids, reached);
+    }
+
     #[test]
     fn test_bfs_parallel_source_not_found() {
         let (src, dst) = triangle_graph();
@@ -493,6 +427,8 @@ mod tests {
         assert_eq!(result.node_ids.len(), 4);
         let unique_components: std::collections::HashSet<_> = result.component_ids.iter().collect();
         assert_eq!(unique_components.len(), 2);
+        assert_eq!(result.node_ids, vec![1, 2, 3, 4]);
+        assert_eq!(result.component_ids, vec![0, 0, 1, 1]);
     }
 
     #[test]
@@ -527,7 +463,7 @@ mod tests {
 
     #[test]
     fn test_empty_graph_errors() {
-        assert!(compute_pagerank_parallel(&[], &[], &[], 0.85, 100, false).is_err());
+        assert!(compute_pagerank_parallel(&[], &[], &[], 0.85, 100, 1e-6, false).is_err());
         assert!(compute_bfs_parallel(&[], &[], 1).is_err());
         assert!(compute_shortest_paths_parallel(&[], &[], 1).is_err());
         assert!(compute_components_parallel(&[], &[]).is_err());
@@ -537,11 +473,13 @@ mod tests {
 
     #[test]
     fn test_mismatched_arrays_error() {
-        assert!(compute_pagerank_parallel(&[1, 2], &[2], &[], 0.85, 100, false).is_err());
+        assert!(compute_pagerank_parallel(&[1, 2], &[2], &[], 0.85, 100, 1e-6, false).is_err());
     }
 
     #[test]
     fn test_mismatched_weights_error() {
-        assert!(compute_pagerank_parallel(&[1, 2], &[2, 3], &[1.0], 0.85, 100, false).is_err());
+        assert!(
+            compute_pagerank_parallel(&[1, 2], &[2, 3], &[1.0], 0.85, 100, 1e-6, false).is_err()
+        );
     }
 }
@@ -3,10 +3,10 @@
 //! Personalized PageRank for node-specific influence computation and recommendations.
 
 use graphina::community::personalized_pagerank::personalized_page_rank;
-use graphina::core::types::{Graph, NodeId};
+use graphina::core::types::NodeId;
 
+use crate::cache;
 use crate::error::{OnagerError, Result};
-use std::collections::HashMap;
 
 /// Result of personalized PageRank computation.
 pub struct PersonalizedPageRankResult {
@@ -52,24 +52,8 @@ pub fn compute_personalized_pagerank(
         ));
     }
 
-    let mut node_set: HashMap<i64, NodeId> = HashMap::new();
-    let mut graph: Graph<i64, f64> = Graph::new();
-
-    for &node in src.iter().chain(dst.iter()) {
-        if !node_set.contains_key(&node) {
-            let id = graph.add_node(node);
-            node_set.insert(node, id);
-        }
-    }
-    for i in 0..src.len() {
-        let src_id = *node_set.get(&src[i]).ok_or_else(|| {
-            OnagerError::InvalidArgument(format!("Source node {} not found in graph", src[i]))
-        })?;
-        let dst_id = *node_set.get(&dst[i]).ok_or_else(|| {
-            OnagerError::InvalidArgument(format!("Destination node {} not found in graph", dst[i]))
-        })?;
-        graph.add_edge(src_id, dst_id, 1.0);
-    }
+    let csr = cache::csr_from_edges(src, dst, None, false)?;
+    let (graph, node_index) = csr.to_graph(|_| 1.0)?;
 
     // Build personalization vector aligned with node indices
     let n = graph.node_count();
@@ -81,7 +65,7 @@ pub fn compute_personalized_pagerank(
         // Create a personalization vector aligned with node order
         let mut p_vec = vec![0.0; n];
         for &(ext_id, weight) in personalization {
-            if let Some(&node_idx) = node_set.get(&ext_id) {
+            if let Some(&node_idx) = node_index.get(&ext_id) {
                 // Find position of node_idx in node_list
                 if let Some(pos) = node_list.iter().position(|&id| id == node_idx) {
                     p_vec[pos] = weight;
@@ -94,12 +78,10 @@ pub fn compute_personalized_pagerank(
     let ranks = personalized_page_rank(&graph, personalization_vec, damping, tolerance, max_iter)
         .map_err(|e| OnagerError::GraphError(e.to_string()))?;
 
-    let reverse_map: HashMap<NodeId, i64> = node_set.iter().map(|(&k, &v)| (v, k)).collect();
-
     let mut node_ids = Vec::with_capacity(ranks.len());
     let mut scores = Vec::with_capacity(ranks.len());
     for (i, &rank) in ranks.iter().enumerate() {
-        if let Some(&ext_id) = reverse_map.get(&node_list[i]) {
+        if let Some(&ext_id) = node_index.external_id(&node_list[i]) {
             node_ids.push(ext_id);
             scores.push(rank);
         }
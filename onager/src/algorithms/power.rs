@@ -0,0 +1,567 @@
+//! Power-iteration engine for PageRank, Katz, and eigenvector centrality.
+//!
+//! Values are pulled along a transposed CSR: every node sums the values of the
+//! nodes with edges into it, so a node's new value is written only by the worker
+//! that owns its range and the value arrays stay contiguous. Node ranges are cut
+//! at roughly equal edge counts, so a few hubs do not stall one worker, and each
+//! range returns its part of the residual and dangling mass, so the reductions
+//! need no shared state. Gathers use four independent accumulators, which keeps
+//! several loads in flight and lets the compiler vectorize the sums. Every pass
+//! starts with a checkpoint, so an interrupted query stops within one pass.
+//!
+//! PageRank stores its rank vectors as `f32` whenever the tolerance allows it,
+//! which halves the memory the random gathers read, and sums them in `f64`.
+
+use std::borrow::Cow;
+use std::ops::Range;
+
+use crate::control;
+use crate::csr::{CsrGraph, WeightSlice};
+use crate::error::Result;
+use crate::profile;
+use crate::workers::{map_parts, worker_count};
+
+/// Node ranges per worker, so workers that finish early pick up more ranges.
+const RANGES_PER_WORKER: usize = 8;
+
+/// Smallest range cost (nodes plus incoming edges) worth handing to a worker.
+const MIN_RANGE_COST: usize = 16 * 1024;
+
+/// A transposed CSR graph: the sources of the edges entering every node.
+pub struct PullGraph<'a> {
+    offsets: Cow<'a, [usize]>,
+    sources: Cow<'a, [u32]>,
+    weights: Option<PullWeights<'a>>,
+    ranges: Vec<Range<usize>>,
+}
+
+/// Edge weights of a pull graph, in the precision the CSR stores them in.
+enum PullWeights<'a> {
+    Double(Cow<'a, [f64]>),
+    Float(Cow<'a, [f32]>),
+}
+
+impl<'a> PullWeights<'a> {
+    fn borrowed(weights: WeightSlice<'a>) -> Self {
+        match weights {
+            WeightSlice::Double(w) => PullWeights::Double(Cow::Borrowed(w)),
+            WeightSlice::Float(w) => PullWeights::Float(Cow::Borrowed(w)),
+        }
+    }
+
+    fn with_capacity(like: Option<WeightSlice>, capacity: usize) -> Self {
+        match like {
+            Some(WeightSlice::Float(_)) => {
+                PullWeights::Float(Cow::Owned(Vec::with_capacity(capacity)))
+            }
+            _ => PullWeights::Double(Cow::Owned(Vec::with_capacity(capacity))),
+        }
+    }
+
+    fn extend(&mut self, weights: Option<WeightSlice>) {
+        match (self, weights) {
+            (PullWeights::Double(out), Some(WeightSlice::Double(w))) => {
+                out.to_mut().extend_from_slice(w)
+            }
+            (PullWeights::Float(out), Some(WeightSlice::Float(w))) => {
+                out.to_mut().extend_from_slice(w)
+            }
+            _ => {}
+        }
+    }
+}
+
+impl<'a> PullGraph<'a> {
+    /// Builds the pull view of a CSR graph.
+    ///
+    /// With `undirected`, every edge is pulled in both directions whatever the
+    /// direction of the CSR, which takes a merged copy of the adjacency. Otherwise
+    /// the incoming adjacency of the CSR is borrowed as is. With `weighted`, the
+    /// edge weights of the CSR scale the pulled values, and an unweighted CSR pulls
+    /// unit weights.
+    pub fn new(csr: &'a CsrGraph, undirected: bool, weighted: bool) -> Self {
+        let (in_offsets, in_sources, in_weights) = csr.in_adjacency();
+        let weighted = weighted && in_weights.is_some();
+        let (offsets, sources, weights) = if undirected {
+            let n = csr.node_count();
+            let mut offsets = Vec::with_capacity(n + 1);
+            let mut sources = Vec::with_capacity(2 * csr.edge_count());
+            let mut weights =
+                weighted.then(|| PullWeights::with_capacity(in_weights, 2 * csr.edge_count()));
+            offsets.push(0);
+            for v in 0..n as u32 {
+                sources.extend_from_slice(csr.in_neighbors(v));
+                sources.extend_from_slice(csr.out_neighbors(v));
+                if let Some(w) = weights.as_mut() {
+                    w.extend(csr.in_weights(v));
+                    w.extend(csr.out_weights(v));
+                }
+                offsets.push(sources.len());
+            }
+            (Cow::Owned(offsets), Cow::Owned(sources), weights)
+        } else {
+            (
+                Cow::Borrowed(in_offsets),
+                Cow::Borrowed(in_sources),
+                in_weights.filter(|_| weighted).map(PullWeights::borrowed),
+            )
+        };
+        let ranges = balanced_ranges(&offsets, worker_count() * RANGES_PER_WORKER);
+        PullGraph {
+            offsets,
+            sources,
+            weights,
+            ranges,
+        }
+    }
+
+    /// Returns the number of nodes.
+    pub fn node_count(&self) -> usize {
+        self.offsets.len() - 1
+    }
+
+    /// Returns the sum of `x` over the sources of the edges entering `v`, scaled by
+    /// the edge weights when the graph is weighted. The sum is taken in `f64`.
+    #[inline]
+    pub fn pull<X: Copy + Into<f64>>(&self, v: usize, x: &[X]) -> f64 {
+        let edges = self.offsets[v]..self.offsets[v + 1];
+        match &self.weights {
+            Some(PullWeights::Double(w)) => gather_dot(&self.sources[edges.clone()], &w[edges], x),
+            Some(PullWeights::Float(w)) => gather_dot(&self.sources[edges.clone()], &w[edges], x),
+            None => gather_sum(&self.sources[edges], x),
+        }
+    }
+
+    /// Runs `f` on every node range with the matching slice of `out`, in parallel,
+    /// and returns the results in range order.
+    pub fn map_ranges<T, R>(
+        &self,
+        out: &mut [T],
+        f: impl Fn(Range<usize>, &mut [T]) -> R + Sync,
+    ) -> Vec<R>
+    where
+        T: Send,
+        R: Send,
+    {
+        let mut parts = Vec::with_capacity(self.ranges.len());
+        let mut rest = out;
+        for range in &self.ranges {
+            let (head, tail) = std::mem::take(&mut rest).split_at_mut(range.len());
+            parts.push((range.clone(), head));
+            rest = tail;
+        }
+        map_parts(parts, |(range, part)| f(range, part))
+    }
+}
+
+/// Cuts the nodes into at most `parts` ranges of roughly equal cost, counting one
+/// unit per node and one per edge of the adjacency that `offsets` delimits.
+pub(crate) fn balanced_ranges(offsets: &[usize], parts: usize) -> Vec<Range<usize>> {
+    let n = offsets.len() - 1;
+    let total = offsets[n] + n;
+    let parts = parts.min(total.div_ceil(MIN_RANGE_COST)).clamp(1, n.max(1));
+    let mut ranges = Vec::with_capacity(parts);
+    let mut start = 0;
+    for p in 1..=parts {
+        let end = if p == parts {
+            n
+        } else {
+            // First node whose cumulative cost reaches the target of this range.
+            let target = total / parts * p;
+            let (mut lo, mut hi) = (start, n);
+            while lo < hi {
+                let mid = lo + (hi - lo) / 2;
+                if offsets[mid] + mid < target {
+                    lo = mid + 1;
+                } else {
+                    hi = mid;
+                }
+            }
+            lo
+        };
+        if end > start {
+            ranges.push(start..end);
+            start = end;
+        }
+    }
+    ranges
+}
+
+/// Sums `x` over `sources` with four independent accumulators.
+#[inline]
+fn gather_sum<X: Copy + Into<f64>>(sources: &[u32], x: &[X]) -> f64 {
+    let mut acc = [0.0; 4];
+    let mut chunks = sources.chunks_exact(4);
+    for c in &mut chunks {
+        acc[0] += x[c[0] as usize].into();
+        acc[1] += x[c[1] as usize].into();
+        acc[2] += x[c[2] as usize].into();
+        acc[3] += x[c[3] as usize].into();
+    }
+    let tail: f64 = chunks
+        .remainder()
+        .iter()
+        .map(|&u| x[u as usize].into())
+        .sum();
+    (acc[0] + acc[1]) + (acc[2] + acc[3]) + tail
+}
+
+/// Sums `x` over `sources` scaled by `weights`, with four independent accumulators.
+#[inline]
+fn gather_dot<T, X>(sources: &[u32], weights: &[T], x: &[X]) -> f64
+where
+    T: Copy + Into<f64>,
+    X: Copy + Into<f64>,
+{
+    let mut acc = [0.0; 4];
+    let mut chunks = sources.chunks_exact(4);
+    let mut weight_chunks = weights.chunks_exact(4);
+    for (c, w) in (&mut chunks).zip(&mut weight_chunks) {
+        acc[0] += x[c[0] as usize].into() * w[0].into();
+        acc[1] += x[c[1] as usize].into() * w[1].into();
+        acc[2] += x[c[2] as usize].into() * w[2].into();
+        acc[3] += x[c[3] as usize].into() * w[3].into();
+    }
+    let tail: f64 = chunks
+        .remainder()
+        .iter()
+        .zip(weight_chunks.remainder())
+        .map(|(&u, &w)| x[u as usize].into() * w.into())
+        .sum();
+    (acc[0] + acc[1]) + (acc[2] + acc[3]) + tail
+}
+
+/// Final values of a power iteration and the number of passes that ran.
+pub struct PowerIteration {
+    pub values: Vec<f64>,
+    pub passes: usize,
+    pub converged: bool,
+}
+
+/// Precision of the rank vectors of PageRank. Sums over them are taken in `f64`.
+trait Rank: Copy + Default + Into<f64> + Send + Sync {
+    fn from_f64(value: f64) -> Self;
+}
+
+impl Rank for f32 {
+    #[inline]
+    fn from_f64(value: f64) -> Self {
+        value as f32
+    }
+}
+
+impl Rank for f64 {
+    #[inline]
+    fn from_f64(value: f64) -> Self {
+        value
+    }
+}
+
+/// Runs PageRank from the starting vector `start`.
+///
+/// `out_total[u]` is the total weight of the edges leaving `u` in the pull graph,
+/// and nodes with a total of zero are dangling: their rank is spread uniformly.
+/// The iteration stops once the L1 change of a pass is below `tolerance` times
+/// the node count, or after `max_iter` passes.
+///
+/// Ranks sum to one, so rounding them all to `f32` moves their L1 sum by at most
+/// half of `f32::EPSILON`. The rank vectors are stored as `f32` when the stopping
+/// threshold is above that, and as `f64` when a tighter tolerance needs it.
+pub fn pagerank(
+    graph: &PullGraph,
+    out_total: &[f64],
+    damping: f64,
+    max_iter: usize,
+    tolerance: f64,
+    start: Vec<f64>,
+) -> Result<PowerIteration> {
+    let threshold = tolerance * graph.node_count() as f64;
+    if threshold >= f32::EPSILON as f64 {
+        let start = start.into_iter().map(|r| r as f32).collect();
+        pagerank_in::<f32>(graph, out_total, damping, max_iter, threshold, start)
+    } else {
+        pagerank_in::<f64>(graph, out_total, damping, max_iter, threshold, start)
+    }
+}
+
+fn pagerank_in<R: Rank>(
+    graph: &PullGraph,
+    out_total: &[f64],
+    damping: f64,
+    max_iter: usize,
+    threshold: f64,
+    start: Vec<R>,
+) -> Result<PowerIteration> {
+    let n = graph.node_count();
+    let inv_total: Vec<f64> = out_total
+        .iter()
+        .map(|&t| if t > 0.0 { 1.0 / t } else { 0.0 })
+        .collect();
+    let mut rank = start;
+    let mut next = vec![R::default(); n];
+    let mut share = vec![R::default(); n];
+    let mut passes = 0;
+    let mut converged = false;
+    while passes < max_iter {
+        control::checkpoint(passes, max_iter)?;
+        passes += 1;
+        // Rank each node sends along one unit of edge weight, and the dangling mass.
+        let dangling: f64 = graph
+            .map_ranges(&mut share, |range, out| {
+                let mut dangling = 0.0;
+                for ((s, &r), &inv) in out
+                    .iter_mut()
+                    .zip(&rank[range.clone()])
+                    .zip(&inv_total[range])
+                {
+                    let r: f64 = r.into();
+                    *s = R::from_f64(r * inv);
+                    if inv == 0.0 {
+                        dangling += r;
+                    }
+                }
+                dangling
+            })
+            .into_iter()
+            .sum();
+        let base = (1.0 - damping + damping * dangling) / n as f64;
+        let change: f64 = graph
+            .map_ranges(&mut next, |range, out| {
+                let mut change = 0.0;
+                for (slot, v) in out.iter_mut().zip(range) {
+                    let value = base + damping * graph.pull(v, &share);
+                    change += (value - rank[v].into()).abs();
+                    *slot = R::from_f64(value);
+                }
+                change
+            })
+            .into_iter()
+            .sum();
+        std::mem::swap(&mut rank, &mut next);
+        if change < threshold {
+            converged = true;
+            break;
+        }
+    }
+    profile::note_iterations(passes);
+    Ok(PowerIteration {
+        values: rank.into_iter().map(Into::into).collect(),
+        passes,
+        converged,
+    })
+}
+
+/// Runs Katz centrality `x = alpha * A^T x + beta` from the zero vector.
+///
+/// The iteration stops once the L1 change of a pass is below `tolerance` times
+/// the node count, or after `max_iter` passes. The values are not normalized.
+pub fn katz(
+    graph: &PullGraph,
+    alpha: f64,
+    beta: f64,
+    max_iter: usize,
+    tolerance: f64,
+) -> Result<PowerIteration> {
+    let n = graph.node_count();
+    let threshold = tolerance * n as f64;
+    let mut x = vec![0.0; n];
+    let mut next = vec![0.0; n];
+    let mut passes = 0;
+    let mut converged = false;
+    while passes < max_iter {
+        control::checkpoint(passes, max_iter)?;
+        passes += 1;
+        let change: f64 = graph
+            .map_ranges(&mut next, |range, out| {
+                let mut change = 0.0;
+                for (slot, v) in out.iter_mut().zip(range) {
+                    let value = alpha * graph.pull(v, &x) + beta;
+                    change += (value - x[v]).abs();
+                    *slot = value;
+                }
+                change
+            })
+            .into_iter()
+            .sum();
+        std::mem::swap(&mut x, &mut next);
+        if !change.is_finite() {
+            break;
+        }
+        if change < threshold {
+            converged = true;
+            break;
+        }
+    }
+    profile::note_iterations(passes);
+    Ok(PowerIteration {
+        values: x,
+        passes,
+        converged,
+    })
+}
+
+/// Runs eigenvector centrality from the uniform vector.
+///
+/// Every pass computes `x + A^T x`, whose identity shift keeps bipartite graphs
+/// from oscillating, and rescales it to unit L2 norm. The iteration stops once
+/// the L1 change of a pass is below `tolerance` times the node count, or after
+/// `max_iter` passes.
+pub fn eigenvector(graph: &PullGraph, max_iter: usize, tolerance: f64) -> Result<PowerIteration> {
+    let n = graph.node_count();
+    let threshold = tolerance * n as f64;
+    let mut x = vec![1.0 / n as f64; n];
+    let mut next = vec![0.0; n];
+    let mut passes = 0;
+    let mut converged = false;
+    while passes < max_iter {
+        control::checkpoint(passes, max_iter)?;
+        passes += 1;
+        let norm_sq: f64 = graph
+            .map_ranges(&mut next, |range, out| {
+                let mut norm_sq = 0.0;
+                for (slot, v) in out.iter_mut().zip(range) {
+                    let value = x[v] + graph.pull(v, &x);
+                    norm_sq += value * value;
+                    *slot = value;
+                }
+                norm_sq
+            })
+            .into_iter()
+            .sum();
+        let scale = if norm_sq > 0.0 {
+            norm_sq.sqrt().recip()
+        } else {
+            1.0
+        };
+        let change: f64 = graph
+            .map_ranges(&mut next, |range, out| {
+                let mut change = 0.0;
+                for (slot, &old) in out.iter_mut().zip(&x[range]) {
+                    *slot *= scale;
+                    change += (*slot - old).abs();
+                }
+                change
+            })
+            .into_iter()
+            .sum();
+        std::mem::swap(&mut x, &mut next);
+        if change < threshold {
+            converged = true;
+            break;
+        }
+    }
+    profile::note_iterations(passes);
+    Ok(PowerIteration {
+        values: x,
+        passes,
+        converged,
+    })
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_balanced_ranges_cover_nodes() {
+        // One hub with 100k incoming edges followed by 100k nodes with one each
+        let mut offsets = vec![0, 100_000];
+        offsets.extend((1..=100_000).map(|i| 100_000 + i));
+        let ranges = balanced_ranges(&offsets, 8);
+        assert!(ranges.len() > 1);
+        assert_eq!(ranges[0].start, 0);
+        assert_eq!(ranges.last().map(|r| r.end), Some(100_001));
+        for pair in ranges.windows(2) {
+            assert_eq!(pair[0].end, pair[1].start);
+        }
+        // The hub fills its own range
+        assert_eq!(ranges[0], 0..1);
+    }
+
+    #[test]
+    fn test_balanced_ranges_small_graph_is_one_range() {
+        assert_eq!(balanced_ranges(&[0, 1, 3], 64), vec![0..2]);
+        assert!(balanced_ranges(&[0], 64).is_empty());
+    }
+
+    #[test]
+    fn test_gathers_match_plain_sums() {
+        let x: Vec<f64> = (0..50).map(|i| i as f64 * 0.5).collect();
+        let sources: Vec<u32> = (0..23).map(|i| (i * 7) % 50).collect();
+        let weights: Vec<f64> = (0..23).map(|i| 1.0 + i as f64).collect();
+        let sum: f64 = sources.iter().map(|&u| x[u as usize]).sum();
+        let dot: f64 = sources
+            .iter()
+            .zip(&weights)
+            .map(|(&u, &w)| x[u as usize] * w)
+            .sum();
+        assert!((gather_sum(&sources, &x) - sum).abs() < 1e-9);
+        assert!((gather_dot(&sources, &weights, &x) - dot).abs() < 1e-9);
+    }
+
+    #[test]
+    fn test_undirected_pull_sees_both_directions() {
+        let csr = CsrGraph::from_edges(&[1, 2], &[2, 3], Some(&[2.0, 5.0]), true).unwrap();
+        let x = [1.0, 10.0, 100.0];
+        let directed = PullGraph::new(&csr, false, true);
+        assert_eq!(directed.pull(1, &x), 2.0);
+        let undirected = PullGraph::new(&csr, true, true);
+        assert_eq!(undirected.pull(1, &x), 2.0 + 500.0);
+        let unweighted = PullGraph::new(&csr, true, false);
+        assert_eq!(unweighted.pull(1, &x), 101.0);
+    }
+
+    #[test]
+    fn test_pagerank_precision_follows_tolerance() {
+        // Cycle 1-2-3-4 plus chord 1-3: nodes 1 and 3 rank equally by symmetry
+        let csr = CsrGraph::from_edges(&[1, 2, 3, 4, 1], &[2, 3, 4, 1, 3], None, false).unwrap();
+        let graph = PullGraph::new(&csr, true, false);
+        let totals = [3.0, 2.0, 3.0, 2.0];
+        for tolerance in [1e-6, 1e-12] {
+            let start = vec![0.25; 4];
+            let result = pagerank(&graph, &totals, 0.85, 200, tolerance, start).unwrap();
+            assert!(result.converged);
+            let sum: f64 = result.values.iter().sum();
+            assert!((sum - 1.0).abs() < 1e-6);
+            assert!((result.values[0] - result.values[2]).abs() < 1e-7);
+            assert!(result.values[0] > result.values[1]);
+        }
+        let coarse = pagerank(&graph, &totals, 0.85, 200, 1e-6, vec![0.25; 4]).unwrap();
+        let fine = pagerank(&graph, &totals, 0.85, 200, 1e-12, vec![0.25; 4]).unwrap();
+        for (a, b) in coarse.values.iter().zip(&fine.values) {
+            assert!((a - b).abs() < 1e-5);
+        }
+        assert!(fine.passes > coarse.passes);
+    }
+
+    #[test]
+    fn test_eigenvector_star() {
+        // Star with hub 1: the hub value is sqrt(3) times each leaf value
+        let csr = CsrGraph::from_edges(&[1, 1, 1], &[2, 3, 4], None, false).unwrap();
+        let graph = PullGraph::new(&csr, true, false);
+        let result = eigenvector(&graph, 200, 1e-10).unwrap();
+        assert!(result.converged);
+        assert!((result.values[0] / result.values[1] - 3f64.sqrt()).abs() < 1e-6);
+        let norm: f64 = result.values.iter().map(|v| v * v).sum();
+        assert!((norm - 1.0).abs() < 1e-9);
+    }
+
+    #[test]
+    fn test_katz_path() {
+        // Path 1-2-3 with alpha 0.1: x2 = 1 + 0.2 x1 and x1 = 1 + 0.1 x2
+        let csr = CsrGraph::from_edges(&[1, 2], &[2, 3], None, false).unwrap();
+        let graph = PullGraph::new(&csr, true, false);
+        let result = katz(&graph, 0.1, 1.0, 100, 1e-12).unwrap();
+        assert!(result.converged);
+        let x1 = 1.1 / 0.98;
+        assert!((result.values[0] - x1).abs() < 1e-9);
+        assert!((result.values[1] - (1.0 + 0.2 * x1)).abs() < 1e-9);
+    }
+
+    #[test]
+    fn test_katz_diverges_with_large_alpha() {
+        let csr = CsrGraph::from_edges(&[1, 2, 3], &[2, 3, 1], None, false).unwrap();
+        let graph = PullGraph::new(&csr, true, false);
+        assert!(!katz(&graph, 0.9, 1.0, 100, 1e-6).unwrap().converged);
+    }
+}
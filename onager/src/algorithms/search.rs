@@ -0,0 +1,1042 @@
+//! Multi-source shortest-distance search module.
+//!
+//! Distances from many sources share one graph build. Unweighted graphs run a
+//! bit-parallel multi-source BFS that advances up to 64 sources per pass, with
+//! one bit per source in each node's frontier word. Weighted graphs run one
+//! Dijkstra per source. Worker threads claim source batches and hand their rows
+//! to the reader through a bounded channel, so rows are streamed as they are
+//! found and only a few chunks are buffered at any time. Workers run under the
+//! control of the call that started them, and each read of the stream resumes
+//! it, so interrupting the query stops both.
+//!
+//! Point-to-point queries run a bidirectional search instead, which grows one
+//! frontier from each end and stops as soon as they meet.
+
+use std::cmp::Reverse;
+use std::collections::BinaryHeap;
+use std::mem::size_of;
+use std::panic::AssertUnwindSafe;
+use std::sync::atomic::{AtomicUsize, Ordering};
+use std::sync::mpsc::{sync_channel, Receiver, SyncSender};
+use std::sync::Arc;
+use std::thread::JoinHandle;
+
+use ordered_float::OrderedFloat;
+
+use crate::cache;
+use crate::control::{self, Control};
+use crate::csr::{CsrGraph, NeighborSets};
+use crate::error::{OnagerError, Result};
+
+/// Sources advanced together by one multi-source BFS pass, one per bit of a `u64`.
+pub const SEARCH_LANES: usize = 64;
+
+/// Rows per chunk handed from a worker to the reader.
+const SEARCH_CHUNK_ROWS: usize = 2048;
+
+/// Chunks buffered per worker before the worker waits for the reader.
+const SEARCH_CHUNKS_PER_WORKER: usize = 2;
+
+/// Query pairs per block when pair distances are computed in parallel.
+const PAIR_BLOCK: usize = 1024;
+
+/// Result of a multi-source distance search.
+pub struct MultiSourceResult {
+    pub sources: Vec<i64>,
+    pub node_ids: Vec<i64>,
+    pub distances: Vec<f64>,
+}
+
+/// Undirected adjacency a search runs on, owned so that it can outlive the CSR.
+enum SearchGraph {
+    Unweighted(NeighborSets),
+    Weighted {
+        offsets: Vec<usize>,
+        targets: Vec<u32>,
+        weights: Vec<f64>,
+    },
+}
+
+impl SearchGraph {
+    /// Treats every edge of the CSR as undirected. Weights that are all 1.0 count as unweighted.
+    fn from_csr(csr: &CsrGraph) -> Result<Self> {
+        let n = csr.node_count() as u32;
+        let what = || format!("a search over {} nodes and {} edges", n, csr.edge_count());
+        if !csr.is_weighted() {
+            control::reserve(&what(), NeighborSets::max_bytes(csr))?;
+            return Ok(SearchGraph::Unweighted(NeighborSets::from_csr(csr)));
+        }
+        let edge = size_of::<u32>() + size_of::<f64>();
+        let offsets = (n as usize + 1) * size_of::<usize>();
+        control::reserve(&what(), offsets + 2 * csr.edge_count() * edge)?;
+
+        let mut offsets = Vec::with_capacity(n as usize + 1);
+        let mut targets = Vec::with_capacity(csr.edge_count() * 2);
+        let mut weights = Vec::with_capacity(csr.edge_count() * 2);
+        offsets.push(0);
+        for u in 0..n {
+            let sides = [
+                (csr.out_neighbors(u), csr.out_weights(u)),
+                (csr.in_neighbors(u), csr.in_weights(u)),
+            ];
+            for (nbrs, w) in sides {
+                for (i, &v) in nbrs.iter().enumerate() {
+                    let w = w.map_or(1.0, |w| w.get(i));
+                    if w.is_nan() || w < 0.0 {
+                        return Err(OnagerError::InvalidArgument(format!(
+                            "Dijkstra requires non-negative edge weights, found {}",
+                            w
+                        )));
+                    }
+                    targets.push(v);
+                    weights.push(w);
+                }
+            }
+            offsets.push(targets.len());
+        }
+        Ok(SearchGraph::Weighted {
+            offsets,
+            targets,
+            weights,
+        })
+    }
+}
+
+/// Validated sources over an owned search graph.
+pub struct MultiSourceSearch {
+    ids: Vec<i64>,
+    graph: SearchGraph,
+    sources: Vec<u32>,
+}
+
+impl MultiSourceSearch {
+    /// Prepares a search from `sources` over a CSR graph.
+    ///
+    /// Repeated sources are searched once, in order of first appearance.
+    pub fn new(csr: &CsrGraph, sources: &[i64]) -> Result<Self> {
+        control::reserve(
+            &format!("the IDs of {} nodes", csr.node_count()),
+            csr.node_count() * (size_of::<i64>() + size_of::<bool>()),
+        )?;
+        let mut dense = Vec::with_capacity(sources.len());
+        let mut queued = vec![false; csr.node_count()];
+        for &s in sources {
+            let u = csr.dense_id(s).ok_or_else(|| {
+                OnagerError::InvalidArgument(format!("Source node {} not found", s))
+            })?;
+            if !std::mem::replace(&mut queued[u as usize], true) {
+                dense.push(u);
+            }
+        }
+        Ok(MultiSourceSearch {
+            ids: csr.ids().to_vec(),
+            graph: SearchGraph::from_csr(csr)?,
+            sources: dense,
+        })
+    }
+
+    /// Returns true if the search runs Dijkstra instead of BFS.
+    pub fn is_weighted(&self) -> bool {
+        matches!(self.graph, SearchGraph::Weighted { .. })
+    }
+
+    /// Starts the worker threads and returns the stream of `(source, node, distance)` rows.
+    pub fn stream(self) -> DistanceStream {
+        let batch = if self.is_weighted() { 1 } else { SEARCH_LANES };
+        let batches = self.sources.len().div_ceil(batch);
+        let search = Arc::new(self);
+        DistanceStream(RowStream::spawn(batches, move |claim, sink| {
+            search.run_worker(batch, claim, sink)
+        }))
+    }
+
+    /// Runs the search to completion and collects every row ordered by source, then node.
+    ///
+    /// Fails if the query is interrupted, which drops the stream and stops its workers.
+    pub fn collect(self) -> Result<MultiSourceResult> {
+        let mut stream = self.stream();
+        let mut rows = Vec::new();
+        let (mut s, mut n, mut d) = (vec![0; 2048], vec![0; 2048], vec![0.0; 2048]);
+        loop {
+            control::check()?;
+            let count = stream.next_batch(&mut s, &mut n, &mut d)?;
+            rows.extend((0..count).map(|i| (s[i], n[i], d[i])));
+            if count < s.len() {
+                break;
+            }
+        }
+        rows.sort_unstable_by_key(|&(s, n, _)| (s, n));
+        Ok(MultiSourceResult {
+            sources: rows.iter().map(|r| r.0).collect(),
+            node_ids: rows.iter().map(|r| r.1).collect(),
+            distances: rows.iter().map(|r| r.2).collect(),
+        })
+    }
+
+    fn run_worker(&self, batch: usize, claim: &Batches, sink: &mut RowSink<(i64, i64, f64)>) {
+        let n = self.ids.len();
+        let claim = || {
+            claim
+                .claim()
+                .map(|b| &self.sources[b * batch..((b + 1) * batch).min(self.sources.len())])
+        };
+        match &self.graph {
+            SearchGraph::Unweighted(sets) => {
+                let mut lanes = LaneScratch::new(n);
+                while let Some(sources) = claim().filter(|_| !sink.is_closed()) {
+                    lanes.run(sets, &self.ids, sources, sink);
+                }
+            }
+            SearchGraph::Weighted {
+                offsets,
+                targets,
+                weights,
+            } => {
+                let mut heap = DijkstraScratch::new(n);
+                while let Some(sources) = claim().filter(|_| !sink.is_closed()) {
+                    for &s in sources {
+                        heap.run(offsets, targets, weights, &self.ids, s, sink);
+                    }
+                }
+            }
+        }
+    }
+}
+
+/// Compute distances from every source node.
+///
+/// Edges are undirected. Without weights, distances are hop counts from a
+/// multi-source BFS; with weights, they come from one Dijkstra per source.
+pub fn compute_multi_source(
+    src: &[i64],
+    dst: &[i64],
+    weights: Option<&[f64]>,
+    sources: &[i64],
+) -> Result<MultiSourceResult> {
+    multi_source_search(src, dst, weights, sources)?.collect()
+}
+
+/// Prepares a multi-source search over parallel edge arrays.
+pub fn multi_source_search(
+    src: &[i64],
+    dst: &[i64],
+    weights: Option<&[f64]>,
+    sources: &[i64],
+) -> Result<MultiSourceSearch> {
+    if src.is_empty() {
+        return Err(OnagerError::InvalidArgument(
+            "Cannot compute on empty graph".to_string(),
+        ));
+    }
+    let csr = cache::csr_from_edges(src, dst, weights, false)?;
+    MultiSourceSearch::new(&csr, sources)
+}
+
+/// Compute distances from every source node on a prebuilt CSR graph.
+pub fn compute_multi_source_csr(csr: &CsrGraph, sources: &[i64]) -> Result<MultiSourceResult> {
+    MultiSourceSearch::new(csr, sources)?.collect()
+}
+
+enum Chunk<R> {
+    Rows(Vec<R>),
+    Failed(String),
+}
+
+/// Buffers rows of one worker and sends them in chunks.
+pub(crate) struct RowSink<R> {
+    rows: Vec<R>,
+    tx: SyncSender<Chunk<R>>,
+    closed: bool,
+}
+
+impl<R> RowSink<R> {
+    #[inline]
+    pub(crate) fn push(&mut self, row: R) {
+        self.rows.push(row);
+        if self.rows.len() == SEARCH_CHUNK_ROWS {
+            self.flush();
+        }
+    }
+
+    /// Returns true once the reader is gone or the query is interrupted, after
+    /// which pushed rows are discarded.
+    #[inline]
+    pub(crate) fn is_closed(&self) -> bool {
+        self.closed
+    }
+
+    /// Sends the buffered rows. A dropped reader or an interrupt closes the sink,
+    /// which stops the worker.
+    fn flush(&mut self) {
+        if self.rows.is_empty() || self.closed {
+            return;
+        }
+        if control::interrupted() {
+            self.closed = true;
+            return;
+        }
+        let rows = std::mem::replace(&mut self.rows, Vec::with_capacity(SEARCH_CHUNK_ROWS));
+        self.closed = self.tx.send(Chunk::Rows(rows)).is_err();
+    }
+}
+
+/// Batches of work claimed by the workers of a [`RowStream`].
+pub(crate) struct Batches {
+    next: AtomicUsize,
+    count: usize,
+}
+
+impl Batches {
+    /// Returns the index of the next unclaimed batch, or None when all are taken.
+    pub(crate) fn claim(&self) -> Option<usize> {
+        if control::interrupted() {
+            return None;
+        }
+        let b = self.next.fetch_add(1, Ordering::Relaxed);
+        (b < self.count).then_some(b)
+    }
+}
+
+/// Rows pushed by worker threads, read in order of arrival.
+///
+/// Dropping the stream stops the workers.
+pub(crate) struct RowStream<R> {
+    rx: Option<Receiver<Chunk<R>>>,
+    handles: Vec<JoinHandle<()>>,
+    control: Option<Control>,
+    pending: Vec<R>,
+    pos: usize,
+}
+
+impl<R: Copy + Send + 'static> RowStream<R> {
+    /// Starts up to one worker per batch, each running `work` until it stops claiming batches.
+    ///
+    /// The workers run under the control of the current call.
+    pub(crate) fn spawn<F>(batches: usize, work: F) -> Self
+    where
+        F: Fn(&Batches, &mut RowSink<R>) + Send + Sync + 'static,
+    {
+        let workers = crate::workers::worker_count().min(batches);
+        crate::profile::note_threads(workers);
+        let call = control::current();
+        let (tx, rx) = sync_channel(workers.max(1) * SEARCH_CHUNKS_PER_WORKER);
+        let work = Arc::new(work);
+        let claim = Arc::new(Batches {
+            next: AtomicUsize::new(0),
+            count: batches,
+        });
+        let handles = (0..workers)
+            .map(|_| {
+                let (work, claim, tx) = (Arc::clone(&work), Arc::clone(&claim), tx.clone());
+                let call = call.clone();
+                std::thread::spawn(move || {
+                    control::scope(call, || {
+                        let mut sink = RowSink {
+                            rows: Vec::with_capacity(SEARCH_CHUNK_ROWS),
+                            tx,
+                            closed: false,
+                        };
+                        let run =
+                            std::panic::catch_unwind(AssertUnwindSafe(|| work(&claim, &mut sink)));
+                        match run {
+                            Ok(()) => sink.flush(),
+                            Err(payload) => {
+                                let msg = payload
+                                    .downcast_ref::<&str>()
+                                    .map(|s| s.to_string())
+                                    .or_else(|| payload.downcast_ref::<String>().cloned())
+                                    .unwrap_or_else(|| "unknown panic".to_string());
+                                let _ = sink.tx.send(Chunk::Failed(format!(
+                                    "Search worker panicked: {}",
+                                    msg
+                                )));
+                            }
+                        }
+                    })
+                })
+            })
+            .collect();
+        RowStream {
+            rx: Some(rx),
+            handles,
+            control: call,
+            pending: Vec::new(),
+            pos: 0,
+        }
+    }
+
+    /// Hands up to `capacity` rows to `put` along with their output position.
+    ///
+    /// Returns the number of rows handed out; fewer than the capacity means the
+    /// stream is exhausted. Resumes the control of the call that started the
+    /// stream and fails with [`OnagerError::Interrupted`] once its query is
+    /// interrupted.
+    pub(crate) fn fill(&mut self, capacity: usize, mut put: impl FnMut(usize, R)) -> Result<usize> {
+        control::resume(self.control.clone());
+        control::check()?;
+        let mut written = 0;
+        while written < capacity {
+            if self.pos == self.pending.len() {
+                let chunk = match &self.rx {
+                    Some(rx) => rx.recv().ok(),
+                    None => None,
+                };
+                match chunk {
+                    Some(Chunk::Rows(rows)) => {
+                        self.pending = rows;
+                        self.pos = 0;
+                    }
+                    Some(Chunk::Failed(msg)) => {
+                        self.rx = None;
+                        return Err(OnagerError::GraphError(msg));
+                    }
+                    None => {
+                        self.rx = None;
+                        control::check()?;
+                        break;
+                    }
+                }
+            }
+            let take = (capacity - written).min(self.pending.len() - self.pos);
+            for (i, &row) in self.pending[self.pos..self.pos + take].iter().enumerate() {
+                put(written + i, row);
+            }
+            self.pos += take;
+            written += take;
+        }
+        Ok(written)
+    }
+}
+
+impl<R> Drop for RowStream<R> {
+    fn drop(&mut self) {
+        self.rx = None;
+        for handle in self.handles.drain(..) {
+            let _ = handle.join();
+        }
+    }
+}
+
+/// Per-worker state of the bit-parallel BFS.
+///
+/// `seen[v]` has bit `i` set once source `i` of the batch reached `v`, and
+/// `visit[v]` holds the sources for which `v` is on the current frontier.
+struct LaneScratch {
+    seen: Vec<u64>,
+    visit: Vec<u64>,
+    next: Vec<u64>,
+    frontier: Vec<u32>,
+    touched: Vec<u32>,
+    reached: Vec<u32>,
+}
+
+impl LaneScratch {
+    fn new(n: usize) -> Self {
+        LaneScratch {
+            seen: vec![0; n],
+            visit: vec![0; n],
+            next: vec![0; n],
+            frontier: Vec::new(),
+            touched: Vec::new(),
+            reached: Vec::new(),
+        }
+    }
+
+    /// Runs one BFS pass for up to [`SEARCH_LANES`] distinct sources.
+    fn run(
+        &mut self,
+        sets: &NeighborSets,
+        ids: &[i64],
+        sources: &[u32],
+        sink: &mut RowSink<(i64, i64, f64)>,
+    ) {
+        for &v in &self.reached {
+            self.seen[v as usize] = 0;
+        }
+        self.reached.clear();
+        self.frontier.clear();
+        for (lane, &s) in sources.iter().enumerate() {
+            let bit = 1u64 << lane;
+            self.seen[s as usize] = bit;
+            self.visit[s as usize] = bit;
+            self.frontier.push(s);
+            self.reached.push(s);
+            sink.push((ids[s as usize], ids[s as usize], 0.0));
+        }
+
+        let mut level = 0.0;
+        while !self.frontier.is_empty() && !sink.is_closed() {
+            level += 1.0;
+            self.touched.clear();
+            for &v in &self.frontier {
+                let bits = self.visit[v as usize];
+                for &w in sets.get(v) {
+                    let next = &mut self.next[w as usize];
+                    if *next == 0 {
+                        self.touched.push(w);
+                    }
+                    *next |= bits;
+                }
+            }
+            for &v in &self.frontier {
+                self.visit[v as usize] = 0;
+            }
+            self.frontier.clear();
+            for &w in &self.touched {
+                let w = w as usize;
+                let fresh = self.next[w] & !self.seen[w];
+                self.next[w] = 0;
+                if fresh == 0 {
+                    continue;
+                }
+                if self.seen[w] == 0 {
+                    self.reached.push(w as u32);
+                }
+                self.seen[w] |= fresh;
+                self.visit[w] = fresh;
+                self.frontier.push(w as u32);
+                let mut bits = fresh;
+                while bits != 0 {
+                    let lane = bits.trailing_zeros() as usize;
+                    bits &= bits - 1;
+                    sink.push((ids[sources[lane] as usize], ids[w], level));
+                }
+            }
+        }
+        for &v in &self.frontier {
+            self.visit[v as usize] = 0;
+        }
+    }
+}
+
+/// Per-worker state of Dijkstra, reset only where the previous source reached.
+struct DijkstraScratch {
+    dist: Vec<f64>,
+    touched: Vec<u32>,
+    heap: BinaryHeap<Reverse<(OrderedFloat<f64>, u32)>>,
+}
+
+impl DijkstraScratch {
+    fn new(n: usize) -> Self {
+        DijkstraScratch {
+            dist: vec![f64::INFINITY; n],
+            touched: Vec::new(),
+            heap: BinaryHeap::new(),
+        }
+    }
+
+    /// Emits each node reachable from `source` as it is settled.
+    fn run(
+        &mut self,
+        offsets: &[usize],
+        targets: &[u32],
+        weights: &[f64],
+        ids: &[i64],
+        source: u32,
+        sink: &mut RowSink<(i64, i64, f64)>,
+    ) {
+        for &v in &self.touched {
+            self.dist[v as usize] = f64::INFINITY;
+        }
+        self.touched.clear();
+        self.heap.clear();
+        self.dist[source as usize] = 0.0;
+        self.touched.push(source);
+        self.heap.push(Reverse((OrderedFloat(0.0), source)));
+        let source_id = ids[source as usize];
+
+        while let Some(Reverse((OrderedFloat(d), u))) = self.heap.pop() {
+            if sink.is_closed() {
+                return;
+            }
+            let u = u as usize;
+            if d > self.dist[u] {
+                continue;
+            }
+            sink.push((source_id, ids[u], d));
+            for e in offsets[u]..offsets[u + 1] {
+                let v = targets[e] as usize;
+                let nd = d + weights[e];
+                if nd < self.dist[v] {
+                    if self.dist[v] == f64::INFINITY {
+                        self.touched.push(v as u32);
+                    }
+                    self.dist[v] = nd;
+                    self.heap.push(Reverse((OrderedFloat(nd), v as u32)));
+                }
+            }
+        }
+    }
+}
+
+/// Stream of `(source, node, distance)` rows produced by search workers.
+///
+/// Rows arrive in no particular order. Dropping the stream stops the workers.
+pub struct DistanceStream(RowStream<(i64, i64, f64)>);
+
+impl DistanceStream {
+    /// Writes up to `sources.len()` rows into the output slices.
+    ///
+    /// Returns the number of rows written; fewer than the capacity means the
+    /// stream is exhausted. The capacity is the shortest of the three slices.
+    pub fn next_batch(
+        &mut self,
+        sources: &mut [i64],
+        nodes: &mut [i64],
+        dist: &mut [f64],
+    ) -> Result<usize> {
+        let capacity = sources.len().min(nodes.len()).min(dist.len());
+        self.0.fill(capacity, |i, (s, n, d)| {
+            sources[i] = s;
+            nodes[i] = n;
+            dist[i] = d;
+        })
+    }
+}
+
+/// Result of point-to-point distance queries, one row per query pair.
+pub struct PairDistanceResult {
+    pub src: Vec<i64>,
+    pub dst: Vec<i64>,
+    pub distances: Vec<f64>,
+}
+
+/// Compute the distance of every `(src, dst)` query pair with a bidirectional search.
+///
+/// Edges are undirected. Pairs that are not connected, whose distance exceeds
+/// `max_depth`, or that name a node missing from the graph get an infinite distance.
+pub fn compute_pair_distances(
+    edge_src: &[i64],
+    edge_dst: &[i64],
+    weights: Option<&[f64]>,
+    src: &[i64],
+    dst: &[i64],
+    max_depth: Option<f64>,
+) -> Result<PairDistanceResult> {
+    if edge_src.is_empty() {
+        return Err(OnagerError::InvalidArgument(
+            "Cannot compute on empty graph".to_string(),
+        ));
+    }
+    let csr = cache::csr_from_edges(edge_src, edge_dst, weights, false)?;
+    compute_pair_distances_csr(&csr, src, dst, max_depth)
+}
+
+/// Compute pair distances on a prebuilt CSR graph.
+///
+/// Unweighted graphs use a bidirectional BFS and weighted graphs a bidirectional
+/// Dijkstra. Pairs are answered in parallel blocks against one search graph.
+pub fn compute_pair_distances_csr(
+    csr: &CsrGraph,
+    src: &[i64],
+    dst: &[i64],
+    max_depth: Option<f64>,
+) -> Result<PairDistanceResult> {
+    if src.len() != dst.len() {
+        return Err(OnagerError::InvalidArgument(
+            "src and dst arrays must have same length".to_string(),
+        ));
+    }
+    if max_depth.is_some_and(|d| d.is_nan() || d < 0.0) {
+        return Err(OnagerError::InvalidArgument(
+            "max_depth must be non-negative".to_string(),
+        ));
+    }
+    let graph = SearchGraph::from_csr(csr)?;
+    let limit = max_depth.unwrap_or(f64::INFINITY);
+    let n = csr.node_count();
+    let blocks = crate::workers::map_blocks(
+        src.len(),
+        PAIR_BLOCK,
+        || MeetScratch::new(n),
+        |scratch, range| {
+            range
+                .map(|i| match (csr.dense_id(src[i]), csr.dense_id(dst[i])) {
+                    (Some(s), Some(t)) => scratch.distance(&graph, s, t, limit),
+                    _ => f64::INFINITY,
+                })
+                .collect::<Vec<f64>>()
+        },
+    );
+    Ok(PairDistanceResult {
+        src: src.to_vec(),
+        dst: dst.to_vec(),
+        distances: blocks.into_iter().flatten().collect(),
+    })
+}
+
+/// Labels of one search direction, valid only where `mark` equals the current epoch.
+struct SideLabels {
+    mark: Vec<u32>,
+    dist: Vec<f64>,
+    frontier: Vec<u32>,
+    next: Vec<u32>,
+    heap: BinaryHeap<Reverse<(OrderedFloat<f64>, u32)>>,
+}
+
+impl SideLabels {
+    fn new(n: usize) -> Self {
+        SideLabels {
+            mark: vec![0; n],
+            dist: vec![f64::INFINITY; n],
+            frontier: Vec::new(),
+            next: Vec::new(),
+            heap: BinaryHeap::new(),
+        }
+    }
+
+    #[inline]
+    fn get(&self, epoch: u32, v: u32) -> Option<f64> {
+        (self.mark[v as usize] == epoch).then(|| self.dist[v as usize])
+    }
+
+    #[inline]
+    fn set(&mut self, epoch: u32, v: u32, d: f64) {
+        self.mark[v as usize] = epoch;
+        self.dist[v as usize] = d;
+    }
+
+    fn start(&mut self, epoch: u32, v: u32) {
+        self.set(epoch, v, 0.0);
+        self.frontier.clear();
+        self.frontier.push(v);
+        self.heap.clear();
+        self.heap.push(Reverse((OrderedFloat(0.0), v)));
+    }
+
+    fn top(&self) -> f64 {
+        self.heap
+            .peek()
+            .map_or(f64::INFINITY, |Reverse((d, _))| d.0)
+    }
+}
+
+/// Per-worker state of the bidirectional searches.
+///
+/// Labels are stamped with a per-query epoch, so starting a query costs nothing
+/// regardless of how much of the graph the previous query touched.
+struct MeetScratch {
+    epoch: u32,
+    fwd: SideLabels,
+    bwd: SideLabels,
+}
+
+impl MeetScratch {
+    fn new(n: usize) -> Self {
+        MeetScratch {
+            epoch: 0,
+            fwd: SideLabels::new(n),
+            bwd: SideLabels::new(n),
+        }
+    }
+
+    fn distance(&mut self, graph: &SearchGraph, s: u32, t: u32, limit: f64) -> f64 {
+        if s == t {
+            return 0.0;
+        }
+        if self.epoch == u32::MAX {
+            self.fwd.mark.fill(0);
+            self.bwd.mark.fill(0);
+            self.epoch = 0;
+        }
+        self.epoch += 1;
+        let epoch = self.epoch;
+        self.fwd.start(epoch, s);
+        self.bwd.start(epoch, t);
+        let d = match graph {
+            SearchGraph::Unweighted(sets) => self.bfs(sets, limit),
+            SearchGraph::Weighted {
+                offsets,
+                targets,
+                weights,
+            } => self.dijkstra(offsets, targets, weights, limit),
+        };
+        if d <= limit {
+            d
+        } else {
+            f64::INFINITY
+        }
+    }
+
+    /// Expands the smaller frontier one level at a time until a node labeled by
+    /// the other side is reached. Every meeting found while expanding a level has
+    /// the same length, so the first one is the shortest path.
+    fn bfs(&mut self, sets: &NeighborSets, limit: f64) -> f64 {
+        let epoch = self.epoch;
+        let (mut depth_f, mut depth_b) = (0.0, 0.0);
+        loop {
+            if self.fwd.frontier.is_empty() || self.bwd.frontier.is_empty() {
+                return f64::INFINITY;
+            }
+            if depth_f + depth_b + 1.0 > limit {
+                return f64::INFINITY;
+            }
+            let forward = self.fwd.frontier.len() <= self.bwd.frontier.len();
+            let (this, other, depth, other_depth) = if forward {
+                (&mut self.fwd, &self.bwd, &mut depth_f, depth_b)
+            } else {
+                (&mut self.bwd, &self.fwd, &mut depth_b, depth_f)
+            };
+            *depth += 1.0;
+            this.next.clear();
+            for &u in &this.frontier {
+                for &w in sets.get(u) {
+                    if other.mark[w as usize] == epoch {
+                        return *depth + other_depth;
+                    }
+                    if this.mark[w as usize] != epoch {
+                        this.mark[w as usize] = epoch;
+                        this.next.push(w);
+                    }
+                }
+            }
+            std::mem::swap(&mut this.frontier, &mut this.next);
+        }
+    }
+
+    /// Settles nodes from whichever side has the closer tentative node and stops
+    /// once the two heap tops together reach the best meeting found so far.
+    fn dijkstra(&mut self, offsets: &[usize], targets: &[u32], weights: &[f64], limit: f64) -> f64 {
+        let epoch = self.epoch;
+        let mut best = f64::INFINITY;
+        loop {
+            let (top_f, top_b) = (self.fwd.top(), self.bwd.top());
+            let reach = top_f + top_b;
+            if reach >= best || reach > limit {
+                return best;
+            }
+            let (this, other) = if top_f <= top_b {
+                (&mut self.fwd, &self.bwd)
+            } else {
+                (&mut self.bwd, &self.fwd)
+            };
+            let Some(Reverse((OrderedFloat(d), u))) = this.heap.pop() else {
+                return best;
+            };
+            if this.get(epoch, u).is_some_and(|du| d > du) {
+                continue;
+            }
+            let u = u as usize;
+            for e in offsets[u]..offsets[u + 1] {
+                let v = targets[e];
+                let nd = d + weights[e];
+                if this.get(epoch, v).is_none_or(|dv| nd < dv) {
+                    this.set(epoch, v, nd);
+                    this.heap.push(Reverse((OrderedFloat(nd), v)));
+                }
+                if let Some(dv) = other.get(epoch, v) {
+                    best = best.min(nd + dv);
+                }
+            }
+        }
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    fn bfs_distances(n: usize, src: &[i64], dst: &[i64], source: usize) -> Vec<f64> {
+        let mut adj = vec![Vec::new(); n];
+        for (&u, &v) in src.iter().zip(dst) {
+            adj[u as usize].push(v as usize);
+            adj[v as usize].push(u as usize);
+        }
+        let mut dist = vec![f64::INFINITY; n];
+        let mut queue = std::collections::VecDeque::from([source]);
+        dist[source] = 0.0;
+        while let Some(u) = queue.pop_front() {
+            for &v in &adj[u] {
+                if dist[v].is_infinite() {
+                    dist[v] = dist[u] + 1.0;
+                    queue.push_back(v);
+                }
+            }
+        }
+        dist
+    }
+
+    #[test]
+    fn test_multi_source_bfs_path() {
+        let result = compute_multi_source(&[1, 2, 3], &[2, 3, 4], None, &[1, 4]).unwrap();
+        assert_eq!(result.sources, vec![1, 1, 1, 1, 4, 4, 4, 4]);
+        assert_eq!(result.node_ids, vec![1, 2, 3, 4, 1, 2, 3, 4]);
+        assert_eq!(
+            result.distances,
+            vec![0.0, 1.0, 2.0, 3.0, 3.0, 2.0, 1.0, 0.0]
+        );
+    }
+
+    #[test]
+    fn test_multi_source_bfs_matches_single_source() {
+        // 150 sources spans three lane batches, the last one partial.
+        let n = 300;
+        let mut rng = crate::rng::SplitMix64::new(11);
+        let (mut src, mut dst) = (Vec::new(), Vec::new());
+        for _ in 0..500 {
+            src.push(rng.below(n as u64) as i64);
+            dst.push(rng.below(n as u64) as i64);
+        }
+        // Keep every node present so each one is a valid source.
+        src.extend(0..n as i64);
+        dst.extend(0..n as i64);
+        let sources: Vec<i64> = (0..150).map(|i| i * 2).collect();
+
+        let result = compute_multi_source(&src, &dst, None, &sources).unwrap();
+        let mut expected = Vec::new();
+        for &s in &sources {
+            let dist = bfs_distances(n, &src, &dst, s as usize);
+            for (v, &d) in dist.iter().enumerate() {
+                if d.is_finite() {
+                    expected.push((s, v as i64, d));
+                }
+            }
+        }
+        expected.sort_by_key(|&(s, v, _)| (s, v));
+        assert_eq!(result.sources.len(), expected.len());
+        for (i, &(s, v, d)) in expected.iter().enumerate() {
+            assert_eq!(
+                (result.sources[i], result.node_ids[i], result.distances[i]),
+                (s, v, d)
+            );
+        }
+    }
+
+    #[test]
+    fn test_multi_source_dijkstra() {
+        let src = vec![1, 2, 1];
+        let dst = vec![2, 3, 3];
+        let weights = vec![1.0, 1.0, 5.0];
+        let search = multi_source_search(&src, &dst, Some(&weights), &[1, 3]).unwrap();
+        assert!(search.is_weighted());
+        let result = search.collect().unwrap();
+        assert_eq!(result.sources, vec![1, 1, 1, 3, 3, 3]);
+        assert_eq!(result.distances, vec![0.0, 1.0, 2.0, 2.0, 1.0, 0.0]);
+    }
+
+    #[test]
+    fn test_multi_source_unit_weights_use_bfs() {
+        let search = multi_source_search(&[1, 2], &[2, 3], Some(&[1.0, 1.0]), &[1]).unwrap();
+        assert!(!search.is_weighted());
+    }
+
+    #[test]
+    fn test_multi_source_skips_unreachable_and_repeats() {
+        let result = compute_multi_source(&[1, 3], &[2, 4], None, &[1, 1]).unwrap();
+        assert_eq!(result.sources, vec![1, 1]);
+        assert_eq!(result.node_ids, vec![1, 2]);
+    }
+
+    #[test]
+    fn test_multi_source_errors() {
+        assert!(compute_multi_source(&[], &[], None, &[1]).is_err());
+        assert!(compute_multi_source(&[1], &[2], None, &[9]).is_err());
+        assert!(compute_multi_source(&[1], &[2], Some(&[-1.0]), &[1]).is_err());
+    }
+
+    #[test]
+    fn test_dropping_stream_stops_workers() {
+        let n = 2000i64;
+        let src: Vec<i64> = (0..n - 1).collect();
+        let dst: Vec<i64> = (1..n).collect();
+        let sources: Vec<i64> = (0..n).collect();
+        let mut stream = multi_source_search(&src, &dst, None, &sources)
+            .unwrap()
+            .stream();
+        let (mut s, mut v, mut d) = ([0i64; 16], [0i64; 16], [0f64; 16]);
+        assert_eq!(stream.next_batch(&mut s, &mut v, &mut d).unwrap(), 16);
+        drop(stream);
+    }
+
+    #[test]
+    fn test_pair_distances_bfs_matches_single_source() {
+        let n = 400;
+        let mut rng = crate::rng::SplitMix64::new(5);
+        let (mut src, mut dst) = (Vec::new(), Vec::new());
+        for _ in 0..600 {
+            src.push(rng.below(n as u64) as i64);
+            dst.push(rng.below(n as u64) as i64);
+        }
+        src.extend(0..n as i64);
+        dst.extend(0..n as i64);
+        let (mut qs, mut qt) = (Vec::new(), Vec::new());
+        for _ in 0..3000 {
+            qs.push(rng.below(n as u64) as i64);
+            qt.push(rng.below(n as u64) as i64);
+        }
+
+        let result = compute_pair_distances(&src, &dst, None, &qs, &qt, None).unwrap();
+        let capped = compute_pair_distances(&src, &dst, None, &qs, &qt, Some(3.0)).unwrap();
+        for i in 0..qs.len() {
+            let expected = bfs_distances(n, &src, &dst, qs[i] as usize)[qt[i] as usize];
+            assert_eq!(result.distances[i], expected);
+            let within = if expected <= 3.0 {
+                expected
+            } else {
+                f64::INFINITY
+            };
+            assert_eq!(capped.distances[i], within);
+        }
+    }
+
+    #[test]
+    fn test_pair_distances_dijkstra() {
+        // 1 - 2 - 3 costs 2, the direct edge costs 5, and 4 is on its own.
+        let src = vec![1, 2, 1, 4];
+        let dst = vec![2, 3, 3, 4];
+        let weights = vec![1.0, 1.0, 5.0, 2.0];
+        let result = compute_pair_distances(
+            &src,
+            &dst,
+            Some(&weights),
+            &[1, 3, 1, 1],
+            &[3, 1, 4, 1],
+            None,
+        )
+        .unwrap();
+        assert_eq!(result.distances, vec![2.0, 2.0, f64::INFINITY, 0.0]);
+        let capped =
+            compute_pair_distances(&src, &dst, Some(&weights), &[1, 1], &[2, 3], Some(1.5))
+                .unwrap();
+        assert_eq!(capped.distances, vec![1.0, f64::INFINITY]);
+    }
+
+    #[test]
+    fn test_pair_distances_missing_nodes() {
+        let result = compute_pair_distances(&[1], &[2], None, &[1, 9], &[9, 9], None).unwrap();
+        assert_eq!(result.distances, vec![f64::INFINITY, f64::INFINITY]);
+        assert!(compute_pair_distances(&[1], &[2], None, &[1], &[2], Some(-1.0)).is_err());
+    }
+
+    #[test]
+    fn test_pair_distances_dijkstra_matches_multi_source() {
+        let n = 200;
+        let mut rng = crate::rng::SplitMix64::new(9);
+        let (mut src, mut dst, mut weights) = (Vec::new(), Vec::new(), Vec::new());
+        for _ in 0..500 {
+            src.push(rng.below(n as u64) as i64);
+            dst.push(rng.below(n as u64) as i64);
+            weights.push(0.5 + rng.next_f64() * 4.0);
+        }
+        let sources: Vec<i64> = (0..20).map(|i| src[i]).collect();
+        let all = compute_multi_source(&src, &dst, Some(&weights), &sources).unwrap();
+        let pairs = compute_pair_distances(
+            &src,
+            &dst,
+            Some(&weights),
+            &all.sources,
+            &all.node_ids,
+            None,
+        )
+        .unwrap();
+        for (i, (&got, &want)) in pairs.distances.iter().zip(&all.distances).enumerate() {
+            assert!(
+                (got - want).abs() < 1e-9,
+                "pair {} got {} want {}",
+                i,
+                got,
+                want
+            );
+        }
+    }
+}
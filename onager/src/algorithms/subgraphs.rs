@@ -1,12 +1,23 @@
 //! Subgraph operations module.
 //!
 //! Ego graph, k-hop neighbors, induced subgraph.
+//!
+//! Neighborhoods of many centers share one graph build. Worker threads claim
+//! batches of centers and run a BFS from each that stops at the radius, marking
+//! nodes in a per-worker bitset that is cleared only where the previous center
+//! reached. Rows are streamed to the reader as in the multi-source search.
+
+use std::mem::size_of;
+use std::sync::Arc;
 
-use graphina::core::types::{Graph, NodeId};
+use graphina::core::types::NodeId;
 use graphina::subgraphs::SubgraphOps;
 
+use super::search::{RowSink, RowStream};
+use crate::cache;
+use crate::control;
+use crate::csr::{CsrGraph, NeighborSets};
 use crate::error::{OnagerError, Result};
-use std::collections::HashMap;
 
 /// Result of ego graph extraction.
 pub struct EgoGraphResult {
@@ -33,28 +44,10 @@ pub fn compute_ego_graph(
         ));
     }
 
-    let mut node_set: HashMap<i64, NodeId> = HashMap::new();
-    let mut reverse_map: HashMap<NodeId, i64> = HashMap::new();
-    let mut graph: Graph<i64, f64> = Graph::new();
-
-    for &node in src.iter().chain(dst.iter()) {
-        if !node_set.contains_key(&node) {
-            let id = graph.add_node(node);
-            node_set.insert(node, id);
-            reverse_map.insert(id, node);
-        }
-    }
-    for i in 0..src.len() {
-        let src_id = *node_set.get(&src[i]).ok_or_else(|| {
-            OnagerError::InvalidArgument(format!("Source node {} not found in graph", src[i]))
-        })?;
-        let dst_id = *node_set.get(&dst[i]).ok_or_else(|| {
-            OnagerError::InvalidArgument(format!("Destination node {} not found in graph", dst[i]))
-        })?;
-        graph.add_edge(src_id, dst_id, 1.0);
-    }
+    let csr = cache::csr_from_edges(src, dst, None, false)?;
+    let (graph, node_index) = csr.to_graph(|_| 1.0)?;
 
-    let center_id = node_set
+    let center_id = node_index
         .get(&center)
         .ok_or(OnagerError::NodeNotFound(center))?;
 
@@ -65,7 +58,9 @@ pub fn compute_ego_graph(
     let mut result_src = Vec::new();
     let mut result_dst = Vec::new();
     for (u, v, _) in ego.edges() {
-        if let (Some(&ext_u), Some(&ext_v)) = (reverse_map.get(&u), reverse_map.get(&v)) {
+        if let (Some(&ext_u), Some(&ext_v)) =
+            (node_index.external_id(&u), node_index.external_id(&v))
+        {
             result_src.push(ext_u);
             result_dst.push(ext_v);
         }
@@ -99,35 +94,17 @@ pub fn compute_k_hop_neighbors(
         ));
     }
 
-    let mut node_set: HashMap<i64, NodeId> = HashMap::new();
-    let mut reverse_map: HashMap<NodeId, i64> = HashMap::new();
-    let mut graph: Graph<i64, f64> = Graph::new();
-
-    for &node in src.iter().chain(dst.iter()) {
-        if !node_set.contains_key(&node) {
-            let id = graph.add_node(node);
-            node_set.insert(node, id);
-            reverse_map.insert(id, node);
-        }
-    }
-    for i in 0..src.len() {
-        let src_id = *node_set.get(&src[i]).ok_or_else(|| {
-            OnagerError::InvalidArgument(format!("Source node {} not found in graph", src[i]))
-        })?;
-        let dst_id = *node_set.get(&dst[i]).ok_or_else(|| {
-            OnagerError::InvalidArgument(format!("Destination node {} not found in graph", dst[i]))
-        })?;
-        graph.add_edge(src_id, dst_id, 1.0);
-    }
+    let csr = cache::csr_from_edges(src, dst, None, false)?;
+    let (graph, node_index) = csr.to_graph(|_| 1.0)?;
 
-    let start_id = node_set
+    let start_id = node_index
         .get(&start)
         .ok_or(OnagerError::NodeNotFound(start))?;
 
     let neighbors = graph.k_hop_neighbors(*start_id, k);
     let node_ids: Vec<i64> = neighbors
         .into_iter()
-        .filter_map(|id| reverse_map.get(&id).copied())
+        .filter_map(|id| node_index.external_id(&id).copied())
         .collect();
 
     Ok(KHopNeighborsResult { node_ids })
@@ -161,31 +138,13 @@ pub fn compute_induced_subgraph(
         ));
     }
 
-    let mut node_map: HashMap<i64, NodeId> = HashMap::new();
-    let mut reverse_map: HashMap<NodeId, i64> = HashMap::new();
-    let mut graph: Graph<i64, f64> = Graph::new();
-
-    for &node in src.iter().chain(dst.iter()) {
-        if !node_map.contains_key(&node) {
-            let id = graph.add_node(node);
-            node_map.insert(node, id);
-            reverse_map.insert(id, node);
-        }
-    }
-    for i in 0..src.len() {
-        let src_id = *node_map.get(&src[i]).ok_or_else(|| {
-            OnagerError::InvalidArgument(format!("Source node {} not found in graph", src[i]))
-        })?;
-        let dst_id = *node_map.get(&dst[i]).ok_or_else(|| {
-            OnagerError::InvalidArgument(format!("Destination node {} not found in graph", dst[i]))
-        })?;
-        graph.add_edge(src_id, dst_id, 1.0);
-    }
+    let csr = cache::csr_from_edges(src, dst, None, false)?;
+    let (graph, node_index) = csr.to_graph(|_| 1.0)?;
 
     // Convert external node IDs to internal NodeIds
     let selected_nodes: std::collections::HashSet<NodeId> = node_ids
         .iter()
-        .filter_map(|&ext_id| node_map.get(&ext_id).copied())
+        .filter_map(|ext_id| node_index.get(ext_id).copied())
         .collect();
 
     let subgraph = graph
@@ -195,7 +154,9 @@ pub fn compute_induced_subgraph(
     let mut result_src = Vec::new();
     let mut result_dst = Vec::new();
     for (u, v, _) in subgraph.edges() {
-        if let (Some(&ext_u), Some(&ext_v)) = (reverse_map.get(&u), reverse_map.get(&v)) {
+        if let (Some(&ext_u), Some(&ext_v)) =
+            (node_index.external_id(&u), node_index.external_id(&v))
+        {
             result_src.push(ext_u);
             result_dst.push(ext_v);
         }
@@ -206,6 +167,233 @@ pub fn compute_induced_subgraph(
     })
 }
 
+/// Centers claimed at a time by one neighborhood worker.
+const CENTER_BATCH: usize = 16;
+
+/// Rows a neighborhood search emits for each center.
+#[derive(Clone, Copy, Debug, PartialEq, Eq)]
+pub enum NeighborhoodRows {
+    /// `(center, node, hop)` for every node within the radius, the center included at hop 0.
+    Nodes,
+    /// `(center, src, dst)` for every edge between two nodes within the radius.
+    Edges,
+}
+
+/// Validated centers of a bounded search over an owned undirected graph.
+pub struct NeighborhoodSearch {
+    ids: Vec<i64>,
+    sets: NeighborSets,
+    centers: Vec<u32>,
+    radius: usize,
+    rows: NeighborhoodRows,
+}
+
+impl NeighborhoodSearch {
+    /// Prepares a search that stops `radius` hops away from each of `centers`.
+    ///
+    /// Edges are undirected, self-loops are ignored, and parallel edges count once.
+    /// Repeated centers are searched once, in order of first appearance.
+    pub fn new(
+        csr: &CsrGraph,
+        centers: &[i64],
+        radius: usize,
+        rows: NeighborhoodRows,
+    ) -> Result<Self> {
+        let n = csr.node_count();
+        control::reserve(
+            &format!("a search over {} nodes and {} edges", n, csr.edge_count()),
+            n * (size_of::<i64>() + size_of::<bool>()) + NeighborSets::max_bytes(csr),
+        )?;
+        let mut dense = Vec::with_capacity(centers.len());
+        let mut queued = vec![false; csr.node_count()];
+        for &c in centers {
+            let u = csr.dense_id(c).ok_or(OnagerError::NodeNotFound(c))?;
+            if !std::mem::replace(&mut queued[u as usize], true) {
+                dense.push(u);
+            }
+        }
+        Ok(NeighborhoodSearch {
+            ids: csr.ids().to_vec(),
+            sets: NeighborSets::from_csr(csr),
+            centers: dense,
+            radius,
+            rows,
+        })
+    }
+
+    /// Starts the worker threads and returns the stream of rows.
+    pub fn stream(self) -> NeighborhoodStream {
+        let batches = self.centers.len().div_ceil(CENTER_BATCH);
+        let search = Arc::new(self);
+        NeighborhoodStream(RowStream::spawn(batches, move |claim, sink| {
+            let mut scratch = HopScratch::new(search.ids.len());
+            while let Some(b) = claim.claim().filter(|_| !sink.is_closed()) {
+                let end = ((b + 1) * CENTER_BATCH).min(search.centers.len());
+                for &c in &search.centers[b * CENTER_BATCH..end] {
+                    scratch.run(&search, c, sink);
+                }
+            }
+        }))
+    }
+
+    /// Runs the search to completion and collects every row ordered by center, then by the
+    /// remaining columns.
+    pub fn collect(self) -> Result<NeighborhoodResult> {
+        let mut stream = self.stream();
+        let mut rows = Vec::new();
+        let (mut c, mut a, mut b) = (vec![0; 2048], vec![0; 2048], vec![0; 2048]);
+        loop {
+            crate::control::check()?;
+            let count = stream.next_batch(&mut c, &mut a, &mut b)?;
+            rows.extend((0..count).map(|i| (c[i], a[i], b[i])));
+            if count < c.len() {
+                break;
+            }
+        }
+        rows.sort_unstable();
+        Ok(NeighborhoodResult {
+            centers: rows.iter().map(|r| r.0).collect(),
+            first: rows.iter().map(|r| r.1).collect(),
+            second: rows.iter().map(|r| r.2).collect(),
+        })
+    }
+}
+
+/// Result of a neighborhood search, one row per node or edge of each neighborhood.
+///
+/// For [`NeighborhoodRows::Nodes`], `first` holds node IDs and `second` their hop
+/// counts; for [`NeighborhoodRows::Edges`], they hold the edge endpoints.
+pub struct NeighborhoodResult {
+    pub centers: Vec<i64>,
+    pub first: Vec<i64>,
+    pub second: Vec<i64>,
+}
+
+/// Prepares a neighborhood search over parallel edge arrays.
+pub fn neighborhood_search(
+    src: &[i64],
+    dst: &[i64],
+    centers: &[i64],
+    radius: usize,
+    rows: NeighborhoodRows,
+) -> Result<NeighborhoodSearch> {
+    if src.len() != dst.len() {
+        return Err(OnagerError::InvalidArgument(
+            "src and dst arrays must have same length".to_string(),
+        ));
+    }
+    if src.is_empty() {
+        return Err(OnagerError::InvalidArgument(
+            "Cannot compute on empty graph".to_string(),
+        ));
+    }
+    let csr = cache::csr_from_edges(src, dst, None, false)?;
+    NeighborhoodSearch::new(&csr, centers, radius, rows)
+}
+
+/// Per-worker state of the bounded BFS.
+///
+/// `visited` holds one bit per node, and `reached` lists the nodes found from the
+/// current center in BFS order, which doubles as the queue and tells the next
+/// center which words of the bitset to clear.
+struct HopScratch {
+    visited: Vec<u64>,
+    reached: Vec<u32>,
+}
+
+impl HopScratch {
+    fn new(n: usize) -> Self {
+        HopScratch {
+            visited: vec![0; n.div_ceil(64)],
+            reached: Vec::new(),
+        }
+    }
+
+    #[inline]
+    fn is_visited(&self, v: u32) -> bool {
+        self.visited[v as usize / 64] & (1 << (v % 64)) != 0
+    }
+
+    /// Searches up to the radius from `center` and emits its rows.
+    fn run(
+        &mut self,
+        search: &NeighborhoodSearch,
+        center: u32,
+        sink: &mut RowSink<(i64, i64, i64)>,
+    ) {
+        for &v in &self.reached {
+            self.visited[v as usize / 64] = 0;
+        }
+        self.reached.clear();
+        self.visited[center as usize / 64] |= 1 << (center % 64);
+        self.reached.push(center);
+        let (ids, sets) = (&search.ids, &search.sets);
+        let center_id = ids[center as usize];
+        let nodes = search.rows == NeighborhoodRows::Nodes;
+        if nodes {
+            sink.push((center_id, center_id, 0));
+        }
+
+        let mut start = 0;
+        let mut hop = 0;
+        while hop < search.radius && start < self.reached.len() && !sink.is_closed() {
+            hop += 1;
+            let end = self.reached.len();
+            for i in start..end {
+                for &w in sets.get(self.reached[i]) {
+                    if self.is_visited(w) {
+                        continue;
+                    }
+                    self.visited[w as usize / 64] |= 1 << (w % 64);
+                    self.reached.push(w);
+                    if nodes {
+                        sink.push((center_id, ids[w as usize], hop as i64));
+                    }
+                }
+            }
+            start = end;
+        }
+
+        if !nodes {
+            // Neighbor sets are sorted and list each edge from both ends, so emitting
+            // it from its smaller end yields it once, with src below dst.
+            for &u in &self.reached {
+                let nbrs = sets.get(u);
+                for &v in &nbrs[nbrs.partition_point(|&v| v <= u)..] {
+                    if self.is_visited(v) {
+                        sink.push((center_id, ids[u as usize], ids[v as usize]));
+                    }
+                }
+            }
+        }
+    }
+}
+
+/// Stream of neighborhood rows produced by search workers.
+///
+/// Rows arrive in no particular order. Dropping the stream stops the workers.
+pub struct NeighborhoodStream(RowStream<(i64, i64, i64)>);
+
+impl NeighborhoodStream {
+    /// Writes up to `centers.len()` rows into the output slices.
+    ///
+    /// Returns the number of rows written; fewer than the capacity means the
+    /// stream is exhausted. The capacity is the shortest of the three slices.
+    pub fn next_batch(
+        &mut self,
+        centers: &mut [i64],
+        first: &mut [i64],
+        second: &mut [i64],
+    ) -> Result<usize> {
+        let capacity = centers.len().min(first.len()).min(second.len());
+        self.0.fill(capacity, |i, (c, a, b)| {
+            centers[i] = c;
+            first[i] = a;
+            second[i] = b;
+        })
+    }
+}
+
 #[cfg(test)]
 mod tests {
     use super::*;
@@ -331,6 +519,53 @@ mod tests {
         assert!(result.is_err());
     }
 
+    #[test]
+    fn test_neighborhood_hops() {
+        let (src, dst) = path_graph();
+        let result = neighborhood_search(&src, &dst, &[3, 1, 3], 1, NeighborhoodRows::Nodes)
+            .unwrap()
+            .collect()
+            .unwrap();
+        assert_eq!(result.centers, vec![1, 1, 3, 3, 3]);
+        assert_eq!(result.first, vec![1, 2, 2, 3, 4]);
+        assert_eq!(result.second, vec![0, 1, 1, 0, 1]);
+
+        let none = neighborhood_search(&src, &dst, &[], 2, NeighborhoodRows::Nodes).unwrap();
+        assert!(none.collect().unwrap().centers.is_empty());
+        assert!(neighborhood_search(&src, &dst, &[9], 1, NeighborhoodRows::Nodes).is_err());
+    }
+
+    #[test]
+    fn test_neighborhood_edges() {
+        // Triangle 1-2-3 with a tail 3-4, a parallel edge, and a self-loop
+        let src = vec![1, 2, 3, 3, 2, 4];
+        let dst = vec![2, 3, 1, 4, 1, 4];
+        let search = neighborhood_search(&src, &dst, &[1, 4], 1, NeighborhoodRows::Edges);
+        let result = search.unwrap().collect().unwrap();
+        assert_eq!(result.centers, vec![1, 1, 1, 4]);
+        assert_eq!(result.first, vec![1, 1, 2, 3]);
+        assert_eq!(result.second, vec![2, 3, 3, 4]);
+
+        let search = neighborhood_search(&src, &dst, &[1], 0, NeighborhoodRows::Edges);
+        assert!(search.unwrap().collect().unwrap().centers.is_empty());
+    }
+
+    #[test]
+    fn test_neighborhood_many_centers() {
+        // Path 0-1-...-199, so every inner node has 5 nodes within 2 hops
+        let src: Vec<i64> = (0..199).collect();
+        let dst: Vec<i64> = (1..200).collect();
+        let centers: Vec<i64> = (0..200).rev().collect();
+        let result = neighborhood_search(&src, &dst, &centers, 2, NeighborhoodRows::Nodes)
+            .unwrap()
+            .collect()
+            .unwrap();
+        assert_eq!(result.centers.len(), 200 * 5 - 6);
+        for (i, (&c, &v)) in result.centers.iter().zip(&result.first).enumerate() {
+            assert_eq!((c - v).unsigned_abs() as i64, result.second[i]);
+        }
+    }
+
     #[test]
     fn test_empty_graph_errors() {
         assert!(compute_ego_graph(&[], &[], 1, 1).is_err());
@@ -1,14 +1,18 @@
 //! Graph traversal and path algorithms module.
 //!
-//! Dijkstra, Bellman-Ford, BFS, DFS.
+//! Dijkstra, Bellman-Ford, Floyd-Warshall, BFS, DFS.
 
-use graphina::core::paths::{bellman_ford, dijkstra, floyd_warshall};
-use graphina::core::types::{Graph, NodeId};
+use std::ops::Range;
+
+use graphina::core::paths::{bellman_ford, dijkstra};
 use graphina::traversal::algorithms::{bfs, dfs};
 use ordered_float::OrderedFloat;
 
+use super::search::compute_pair_distances_csr;
+use crate::cache;
+use crate::control;
+use crate::csr::CsrGraph;
 use crate::error::{OnagerError, Result};
-use std::collections::HashMap;
 
 /// Result of Dijkstra shortest path computation.
 pub struct DijkstraResult {
@@ -17,45 +21,46 @@ pub struct DijkstraResult {
 }
 
 /// Compute shortest distances from a source node.
-pub fn compute_dijkstra(src: &[i64], dst: &[i64], source_node: i64) -> Result<DijkstraResult> {
-    if src.len() != dst.len() {
-        return Err(OnagerError::InvalidArgument(
-            "src and dst arrays must have same length".to_string(),
-        ));
-    }
-    if src.is_empty() {
+///
+/// `weights` is either empty or holds one non-negative weight per edge.
+pub fn compute_dijkstra(
+    src: &[i64],
+    dst: &[i64],
+    weights: &[f64],
+    source_node: i64,
+) -> Result<DijkstraResult> {
+    let csr = cache::csr_from_edges(src, dst, (!weights.is_empty()).then_some(weights), false)?;
+    compute_dijkstra_csr(&csr, source_node)
+}
+
+/// Compute shortest distances from a source node on a prebuilt CSR graph.
+///
+/// Edges are treated as undirected, and their lengths are the CSR's edge weights
+/// when it has them, or 1.0 otherwise.
+pub fn compute_dijkstra_csr(csr: &CsrGraph, source_node: i64) -> Result<DijkstraResult> {
+    if csr.edge_count() == 0 {
         return Err(OnagerError::InvalidArgument(
             "Cannot compute on empty graph".to_string(),
         ));
     }
-
-    let mut node_set: HashMap<i64, NodeId> = HashMap::new();
-    let mut graph: Graph<i64, OrderedFloat<f64>> = Graph::new();
-    for &node in src.iter().chain(dst.iter()) {
-        if !node_set.contains_key(&node) {
-            let id = graph.add_node(node);
-            node_set.insert(node, id);
-        }
-    }
-    for i in 0..src.len() {
-        let src_id = *node_set.get(&src[i]).ok_or_else(|| {
-            OnagerError::InvalidArgument(format!("Source node {} not found in graph", src[i]))
-        })?;
-        let dst_id = *node_set.get(&dst[i]).ok_or_else(|| {
-            OnagerError::InvalidArgument(format!("Destination node {} not found in graph", dst[i]))
-        })?;
-        graph.add_edge(src_id, dst_id, OrderedFloat(1.0));
+    if let Some(w) = csr.find_weight(|w| w.is_nan() || w < 0.0) {
+        return Err(OnagerError::InvalidArgument(format!(
+            "Dijkstra requires non-negative edge weights, found {}",
+            w
+        )));
     }
 
-    let source_id = node_set.get(&source_node).ok_or_else(|| {
+    let (graph, node_index) = csr.to_graph(OrderedFloat)?;
+
+    let source_id = node_index.get(&source_node).ok_or_else(|| {
         OnagerError::InvalidArgument(format!("Source node {} not found", source_node))
     })?;
     let distances =
         dijkstra(&graph, *source_id).map_err(|e| OnagerError::GraphError(e.to_string()))?;
 
-    let mut result_nodes = Vec::with_capacity(node_set.len());
-    let mut result_dist = Vec::with_capacity(node_set.len());
-    for (ext_id, int_id) in &node_set {
+    let mut result_nodes = Vec::with_capacity(node_index.len());
+    let mut result_dist = Vec::with_capacity(node_index.len());
+    for (ext_id, int_id) in node_index.iter() {
         result_nodes.push(*ext_id);
         let dist = distances.get(int_id).and_then(|d| *d);
         result_dist.push(dist.map(|d| d.into_inner()).unwrap_or(f64::INFINITY));
@@ -74,45 +79,28 @@ pub struct BfsResult {
 
 /// Compute BFS traversal from a source node.
 pub fn compute_bfs(src: &[i64], dst: &[i64], source_node: i64) -> Result<BfsResult> {
-    if src.len() != dst.len() {
-        return Err(OnagerError::InvalidArgument(
-            "src and dst arrays must have same length".to_string(),
-        ));
-    }
-    if src.is_empty() {
+    let csr = cache::csr_from_edges(src, dst, None, false)?;
+    compute_bfs_csr(&csr, source_node)
+}
+
+/// Compute BFS traversal from a source node on a prebuilt CSR graph.
+pub fn compute_bfs_csr(csr: &CsrGraph, source_node: i64) -> Result<BfsResult> {
+    if csr.edge_count() == 0 {
         return Err(OnagerError::InvalidArgument(
             "Cannot compute on empty graph".to_string(),
         ));
     }
 
-    let mut node_set: HashMap<i64, NodeId> = HashMap::new();
-    let mut reverse_map: HashMap<NodeId, i64> = HashMap::new();
-    let mut graph: Graph<i64, f64> = Graph::new();
-    for &node in src.iter().chain(dst.iter()) {
-        if !node_set.contains_key(&node) {
-            let id = graph.add_node(node);
-            node_set.insert(node, id);
-            reverse_map.insert(id, node);
-        }
-    }
-    for i in 0..src.len() {
-        let src_id = *node_set.get(&src[i]).ok_or_else(|| {
-            OnagerError::InvalidArgument(format!("Source node {} not found in graph", src[i]))
-        })?;
-        let dst_id = *node_set.get(&dst[i]).ok_or_else(|| {
-            OnagerError::InvalidArgument(format!("Destination node {} not found in graph", dst[i]))
-        })?;
-        graph.add_edge(src_id, dst_id, 1.0);
-    }
+    let (graph, node_index) = csr.to_graph(|_| 1.0)?;
 
-    let source_id = node_set.get(&source_node).ok_or_else(|| {
+    let source_id = node_index.get(&source_node).ok_or_else(|| {
         OnagerError::InvalidArgument(format!("Source node {} not found", source_node))
     })?;
     let traversal = bfs(&graph, *source_id);
 
     let mut order = Vec::new();
     for internal_id in &traversal {
-        if let Some(&ext_id) = reverse_map.get(internal_id) {
+        if let Some(&ext_id) = node_index.external_id(internal_id) {
             order.push(ext_id);
         }
     }
@@ -130,45 +118,28 @@ pub struct DfsResult {
 
 /// Compute DFS traversal from a source node.
 pub fn compute_dfs(src: &[i64], dst: &[i64], source_node: i64) -> Result<DfsResult> {
-    if src.len() != dst.len() {
-        return Err(OnagerError::InvalidArgument(
-            "src and dst arrays must have same length".to_string(),
-        ));
-    }
-    if src.is_empty() {
+    let csr = cache::csr_from_edges(src, dst, None, false)?;
+    compute_dfs_csr(&csr, source_node)
+}
+
+/// Compute DFS traversal from a source node on a prebuilt CSR graph.
+pub fn compute_dfs_csr(csr: &CsrGraph, source_node: i64) -> Result<DfsResult> {
+    if csr.edge_count() == 0 {
         return Err(OnagerError::InvalidArgument(
             "Cannot compute on empty graph".to_string(),
         ));
     }
 
-    let mut node_set: HashMap<i64, NodeId> = HashMap::new();
-    let mut reverse_map: HashMap<NodeId, i64> = HashMap::new();
-    let mut graph: Graph<i64, f64> = Graph::new();
-    for &node in src.iter().chain(dst.iter()) {
-        if !node_set.contains_key(&node) {
-            let id = graph.add_node(node);
-            node_set.insert(node, id);
-            reverse_map.insert(id, node);
-        }
-    }
-    for i in 0..src.len() {
-        let src_id = *node_set.get(&src[i]).ok_or_else(|| {
-            OnagerError::InvalidArgument(format!("Source node {} not found in graph", src[i]))
-        })?;
-        let dst_id = *node_set.get(&dst[i]).ok_or_else(|| {
-            OnagerError::InvalidArgument(format!("Destination node {} not found in graph", dst[i]))
-        })?;
-        graph.add_edge(src_id, dst_id, 1.0);
-    }
+    let (graph, node_index) = csr.to_graph(|_| 1.0)?;
 
-    let source_id = node_set.get(&source_node).ok_or_else(|| {
+    let source_id = node_index.get(&source_node).ok_or_else(|| {
         OnagerError::InvalidArgument(format!("Source node {} not found", source_node))
     })?;
     let traversal = dfs(&graph, *source_id);
 
     let mut order = Vec::new();
     for internal_id in &traversal {
-        if let Some(&ext_id) = reverse_map.get(internal_id) {
+        if let Some(&ext_id) = node_index.external_id(internal_id) {
             order.push(ext_id);
         }
     }
@@ -180,6 +151,7 @@ pub fn compute_dfs(src: &[i64], dst: &[i64], source_node: i64) -> Result<DfsResu
 
 /// Compute shortest distance between two specific nodes.
 /// Returns f64::INFINITY if unreachable, or the distance if reachable.
+/// Runs a bidirectional BFS that stops as soon as the two frontiers meet.
 pub fn compute_shortest_distance(
     src: &[i64],
     dst: &[i64],
@@ -197,36 +169,22 @@ pub fn compute_shortest_distance(
         ));
     }
 
-    let mut node_set: HashMap<i64, NodeId> = HashMap::new();
-    let mut graph: Graph<i64, OrderedFloat<f64>> = Graph::new();
-    for &node in src.iter().chain(dst.iter()) {
-        if !node_set.contains_key(&node) {
-            let id = graph.add_node(node);
-            node_set.insert(node, id);
-        }
+    let csr = cache::csr_from_edges(src, dst, None, false)?;
+    if csr.dense_id(source_node).is_none() {
+        return Err(OnagerError::InvalidArgument(format!(
+            "Source node {} not found",
+            source_node
+        )));
     }
-    for i in 0..src.len() {
-        let src_id = *node_set.get(&src[i]).ok_or_else(|| {
-            OnagerError::InvalidArgument(format!("Source node {} not found in graph", src[i]))
-        })?;
-        let dst_id = *node_set.get(&dst[i]).ok_or_else(|| {
-            OnagerError::InvalidArgument(format!("Destination node {} not found in graph", dst[i]))
-        })?;
-        graph.add_edge(src_id, dst_id, OrderedFloat(1.0));
+    if csr.dense_id(target_node).is_none() {
+        return Err(OnagerError::InvalidArgument(format!(
+            "Target node {} not found",
+            target_node
+        )));
     }
 
-    let source_id = node_set.get(&source_node).ok_or_else(|| {
-        OnagerError::InvalidArgument(format!("Source node {} not found", source_node))
-    })?;
-    let target_id = node_set.get(&target_node).ok_or_else(|| {
-        OnagerError::InvalidArgument(format!("Target node {} not found", target_node))
-    })?;
-
-    let distances =
-        dijkstra(&graph, *source_id).map_err(|e| OnagerError::GraphError(e.to_string()))?;
-
-    let dist = distances.get(target_id).and_then(|d| *d);
-    Ok(dist.map(|d| d.into_inner()).unwrap_or(f64::INFINITY))
+    let result = compute_pair_distances_csr(&csr, &[source_node], &[target_node], None)?;
+    Ok(result.distances.first().copied().unwrap_or(f64::INFINITY))
 }
 
 /// Result of Bellman-Ford shortest path computation.
@@ -254,34 +212,19 @@ pub fn compute_bellman_ford(
         ));
     }
 
-    let mut node_set: HashMap<i64, NodeId> = HashMap::new();
-    let mut graph: Graph<i64, OrderedFloat<f64>> = Graph::new();
-    for &node in src.iter().chain(dst.iter()) {
-        if !node_set.contains_key(&node) {
-            let id = graph.add_node(node);
-            node_set.insert(node, id);
-        }
-    }
-    for i in 0..src.len() {
-        let src_id = *node_set.get(&src[i]).ok_or_else(|| {
-            OnagerError::InvalidArgument(format!("Source node {} not found in graph", src[i]))
-        })?;
-        let dst_id = *node_set.get(&dst[i]).ok_or_else(|| {
-            OnagerError::InvalidArgument(format!("Destination node {} not found in graph", dst[i]))
-        })?;
-        graph.add_edge(src_id, dst_id, OrderedFloat(weights[i]));
-    }
+    let csr = cache::csr_from_edges(src, dst, Some(weights), false)?;
+    let (graph, node_index) = csr.to_graph(OrderedFloat)?;
 
-    let source_id = node_set.get(&source_node).ok_or_else(|| {
+    let source_id = node_index.get(&source_node).ok_or_else(|| {
         OnagerError::InvalidArgument(format!("Source node {} not found", source_node))
     })?;
 
     let distances = bellman_ford(&graph, *source_id)
         .ok_or_else(|| OnagerError::GraphError("Negative cycle detected".to_string()))?;
 
-    let mut result_nodes = Vec::with_capacity(node_set.len());
-    let mut result_dist = Vec::with_capacity(node_set.len());
-    for (ext_id, int_id) in &node_set {
+    let mut result_nodes = Vec::with_capacity(node_index.len());
+    let mut result_dist = Vec::with_capacity(node_index.len());
+    for (ext_id, int_id) in node_index.iter() {
         result_nodes.push(*ext_id);
         let dist = distances.get(int_id).and_then(|d| *d);
         result_dist.push(dist.map(|d| d.into_inner()).unwrap_or(f64::INFINITY));
@@ -299,12 +242,102 @@ pub struct FloydWarshallResult {
     pub distances: Vec<f64>,
 }
 
+/// Side length of the square tiles of the blocked Floyd-Warshall kernel.
+///
+/// A tile of `f64` distances takes 32 KiB, so the tile being relaxed and the
+/// matching pivot rows stay in L2 while each pivot step sweeps them.
+const FLOYD_WARSHALL_TILE: usize = 64;
+
+/// All-pairs shortest distances of a graph, held as a dense row-major matrix.
+///
+/// Pairs are read back in row order with [`DistanceMatrix::next_batch`], which
+/// skips each node's distance to itself and unreachable pairs, so callers can
+/// stream rows out in bounded chunks instead of materializing every pair.
+pub struct DistanceMatrix {
+    ids: Vec<i64>,
+    dist: Vec<f64>,
+    row: usize,
+    col: usize,
+}
+
+impl DistanceMatrix {
+    /// Returns the number of nodes.
+    pub fn node_count(&self) -> usize {
+        self.ids.len()
+    }
+
+    /// Writes up to `src.len()` reachable pairs into the output slices.
+    ///
+    /// Returns the number of pairs written; fewer than the capacity means the
+    /// matrix is exhausted. The capacity is the shortest of the three slices.
+    pub fn next_batch(&mut self, src: &mut [i64], dst: &mut [i64], dist: &mut [f64]) -> usize {
+        let capacity = src.len().min(dst.len()).min(dist.len());
+        let n = self.ids.len();
+        let mut written = 0;
+        while written < capacity && self.row < n {
+            let row = &self.dist[self.row * n..(self.row + 1) * n];
+            while written < capacity && self.col < n {
+                let (col, d) = (self.col, row[self.col]);
+                self.col += 1;
+                if col != self.row && d.is_finite() {
+                    src[written] = self.ids[self.row];
+                    dst[written] = self.ids[col];
+                    dist[written] = d;
+                    written += 1;
+                }
+            }
+            if self.col == n {
+                self.row += 1;
+                self.col = 0;
+            }
+        }
+        written
+    }
+}
+
 /// Compute all-pairs shortest distances using Floyd-Warshall.
+///
+/// Unreachable pairs and each node's distance to itself are left out.
 pub fn compute_floyd_warshall(
     src: &[i64],
     dst: &[i64],
     weights: &[f64],
 ) -> Result<FloydWarshallResult> {
+    let mut matrix = floyd_warshall_matrix(src, dst, weights, None)?;
+    let mut result_src = Vec::new();
+    let mut result_dst = Vec::new();
+    let mut result_dist = Vec::new();
+    let (mut s, mut d, mut w) = (vec![0; 2048], vec![0; 2048], vec![0.0; 2048]);
+    loop {
+        let count = matrix.next_batch(&mut s, &mut d, &mut w);
+        result_src.extend_from_slice(&s[..count]);
+        result_dst.extend_from_slice(&d[..count]);
+        result_dist.extend_from_slice(&w[..count]);
+        if count < s.len() {
+            break;
+        }
+    }
+
+    Ok(FloydWarshallResult {
+        src_nodes: result_src,
+        dst_nodes: result_dst,
+        distances: result_dist,
+    })
+}
+
+/// Compute the all-pairs distance matrix of an undirected weighted edge list.
+///
+/// # Arguments
+/// * `src` - Source node IDs
+/// * `dst` - Destination node IDs
+/// * `weights` - Edge weights, one per edge
+/// * `memory_limit` - Optional cap in bytes on the size of the distance matrix
+pub fn floyd_warshall_matrix(
+    src: &[i64],
+    dst: &[i64],
+    weights: &[f64],
+    memory_limit: Option<usize>,
+) -> Result<DistanceMatrix> {
     if src.len() != dst.len() || src.len() != weights.len() {
         return Err(OnagerError::InvalidArgument(
             "src, dst, and weights arrays must have same length".to_string(),
@@ -316,53 +349,162 @@ pub fn compute_floyd_warshall(
         ));
     }
 
-    let mut node_set: HashMap<i64, NodeId> = HashMap::new();
-    let mut reverse_map: HashMap<NodeId, i64> = HashMap::new();
-    let mut graph: Graph<i64, OrderedFloat<f64>> = Graph::new();
+    let csr = cache::csr_from_edges(src, dst, Some(weights), false)?;
+    floyd_warshall_matrix_csr(&csr, memory_limit)
+}
+
+/// Compute the all-pairs distance matrix of a prebuilt CSR graph.
+///
+/// The matrix needs `8 * n * n` bytes, which is checked against `memory_limit`
+/// and the memory left to the call before anything is allocated. The kernel is
+/// a tiled Floyd-Warshall: for each block of pivot nodes, the pivot rows are
+/// closed first, and then every other band of rows is relaxed against them in
+/// parallel, one tile at a time.
+pub fn floyd_warshall_matrix_csr(
+    csr: &CsrGraph,
+    memory_limit: Option<usize>,
+) -> Result<DistanceMatrix> {
+    let n = csr.node_count();
+    if csr.edge_count() == 0 {
+        return Err(OnagerError::InvalidArgument(
+            "Cannot compute on empty graph".to_string(),
+        ));
+    }
 
-    for &node in src.iter().chain(dst.iter()) {
-        if !node_set.contains_key(&node) {
-            let id = graph.add_node(node);
-            node_set.insert(node, id);
-            reverse_map.insert(id, node);
+    let cells = n.checked_mul(n).ok_or_else(|| {
+        OnagerError::InvalidArgument(format!("Floyd-Warshall on {} nodes is too large", n))
+    })?;
+    let bytes = cells.saturating_mul(std::mem::size_of::<f64>());
+    if let Some(limit) = memory_limit {
+        if bytes > limit {
+            return Err(OnagerError::InvalidArgument(format!(
+                "Floyd-Warshall on {} nodes needs a {} byte distance matrix, which exceeds the memory limit of {} bytes",
+                n, bytes, limit
+            )));
         }
     }
-    for i in 0..src.len() {
-        let src_id = *node_set.get(&src[i]).ok_or_else(|| {
-            OnagerError::InvalidArgument(format!("Source node {} not found in graph", src[i]))
-        })?;
-        let dst_id = *node_set.get(&dst[i]).ok_or_else(|| {
-            OnagerError::InvalidArgument(format!("Destination node {} not found in graph", dst[i]))
-        })?;
-        graph.add_edge(src_id, dst_id, OrderedFloat(weights[i]));
+
+    control::reserve(&format!("Floyd-Warshall on {} nodes", n), bytes)?;
+
+    let mut dist = Vec::new();
+    dist.try_reserve_exact(cells).map_err(|_| {
+        OnagerError::GraphError(format!(
+            "Could not allocate the distance matrix for {} nodes",
+            n
+        ))
+    })?;
+    dist.resize(cells, f64::INFINITY);
+    for u in 0..n {
+        dist[u * n + u] = 0.0;
+    }
+    for u in 0..n as u32 {
+        let weights = csr.out_weights(u);
+        for (i, &v) in csr.out_neighbors(u).iter().enumerate() {
+            let w = weights.map_or(1.0, |w| w.get(i));
+            let (u, v) = (u as usize, v as usize);
+            if w < dist[u * n + v] {
+                dist[u * n + v] = w;
+            }
+            if !csr.is_directed() && w < dist[v * n + u] {
+                dist[v * n + u] = w;
+            }
+        }
     }
 
-    let distances = floyd_warshall(&graph)
-        .ok_or_else(|| OnagerError::GraphError("Negative cycle detected".to_string()))?;
+    let band = FLOYD_WARSHALL_TILE * n;
+    let mut pivot_rows = Vec::with_capacity(band);
+    for (pivot_band, start) in (0..n).step_by(FLOYD_WARSHALL_TILE).enumerate() {
+        let pivots = start..(start + FLOYD_WARSHALL_TILE).min(n);
+        let rows = pivots.start * n..pivots.end * n;
+        close_pivot_band(&mut dist[rows.clone()], n, pivots.clone());
+        pivot_rows.clear();
+        pivot_rows.extend_from_slice(&dist[rows]);
+        crate::workers::for_each_chunk_mut(&mut dist, band, |b, rows| {
+            if b != pivot_band {
+                relax_band(rows, n, &pivot_rows, pivots.clone());
+            }
+        });
+    }
 
-    let mut result_src = Vec::new();
-    let mut result_dst = Vec::new();
-    let mut result_dist = Vec::new();
+    if (0..n).any(|u| dist[u * n + u] < 0.0) {
+        return Err(OnagerError::GraphError(
+            "Negative cycle detected".to_string(),
+        ));
+    }
+
+    Ok(DistanceMatrix {
+        ids: csr.ids().to_vec(),
+        dist,
+        row: 0,
+        col: 0,
+    })
+}
+
+/// Lowers each entry of `row` to `via + pivot` where that is shorter.
+///
+/// Written as a plain select over equal-length slices so it compiles to packed
+/// min-plus instructions.
+#[inline]
+fn min_plus(row: &mut [f64], via: f64, pivot: &[f64]) {
+    for (d, &p) in row.iter_mut().zip(pivot) {
+        let candidate = via + p;
+        if candidate < *d {
+            *d = candidate;
+        }
+    }
+}
+
+/// Returns the column tiles of a row, starting with the tile of the pivots.
+fn column_tiles(n: usize, pivots: &Range<usize>) -> impl Iterator<Item = Range<usize>> {
+    let first = pivots.clone();
+    let rest = (0..n)
+        .step_by(FLOYD_WARSHALL_TILE)
+        .map(move |s| s..(s + FLOYD_WARSHALL_TILE).min(n))
+        .filter(move |t| t.start != first.start);
+    std::iter::once(pivots.clone()).chain(rest)
+}
 
-    for (&from_id, inner) in &distances {
-        if let Some(&from_ext) = reverse_map.get(&from_id) {
-            for (&to_id, &dist_opt) in inner {
-                if let Some(&to_ext) = reverse_map.get(&to_id) {
-                    if from_ext != to_ext {
-                        result_src.push(from_ext);
-                        result_dst.push(to_ext);
-                        result_dist.push(dist_opt.map(|d| d.into_inner()).unwrap_or(f64::INFINITY));
-                    }
+/// Runs the pivot steps of `pivots` over the rows of those same pivots.
+///
+/// The diagonal tile is closed first, so the later tiles of the band read final
+/// distances to the pivots.
+fn close_pivot_band(band: &mut [f64], n: usize, pivots: Range<usize>) {
+    let mut pivot_row = Vec::with_capacity(FLOYD_WARSHALL_TILE);
+    for tile in column_tiles(n, &pivots) {
+        for k in pivots.clone() {
+            let kr = k - pivots.start;
+            pivot_row.clear();
+            pivot_row.extend_from_slice(&band[kr * n + tile.start..kr * n + tile.end]);
+            for r in 0..pivots.len() {
+                let via = band[r * n + k];
+                if r != kr && via.is_finite() {
+                    min_plus(
+                        &mut band[r * n + tile.start..r * n + tile.end],
+                        via,
+                        &pivot_row,
+                    );
                 }
             }
         }
     }
+}
 
-    Ok(FloydWarshallResult {
-        src_nodes: result_src,
-        dst_nodes: result_dst,
-        distances: result_dist,
-    })
+/// Relaxes a band of non-pivot rows through the closed pivot rows.
+fn relax_band(band: &mut [f64], n: usize, pivot_rows: &[f64], pivots: Range<usize>) {
+    let rows = band.len() / n;
+    for tile in column_tiles(n, &pivots) {
+        for k in pivots.clone() {
+            let kr = k - pivots.start;
+            let pivot = &pivot_rows[kr * n + tile.start..kr * n + tile.end];
+            for r in 0..rows {
+                let row = &mut band[r * n..(r + 1) * n];
+                let via = row[k];
+                if via.is_finite() {
+                    min_plus(&mut row[tile.clone()], via, pivot);
+                }
+            }
+        }
+    }
 }
 
 #[cfg(test)]
@@ -395,7 +537,7 @@ mod tests {
         let src = vec![1, 2, 3];
         let dst = vec![2, 3, 4];
 
-        let result = compute_dijkstra(&src, &dst, 1).unwrap();
+        let result = compute_dijkstra(&src, &dst, &[], 1).unwrap();
 
         assert_eq!(result.node_ids.len(), 4);
     }
@@ -451,6 +593,105 @@ mod tests {
         }
     }
 
+    fn naive_floyd_warshall(n: usize, src: &[i64], dst: &[i64], weights: &[f64]) -> Vec<f64> {
+        let mut d = vec![f64::INFINITY; n * n];
+        for u in 0..n {
+            d[u * n + u] = 0.0;
+        }
+        for ((&u, &v), &w) in src.iter().zip(dst).zip(weights) {
+            let (u, v) = (u as usize, v as usize);
+            d[u * n + v] = d[u * n + v].min(w);
+            d[v * n + u] = d[v * n + u].min(w);
+        }
+        for k in 0..n {
+            for i in 0..n {
+                for j in 0..n {
+                    d[i * n + j] = d[i * n + j].min(d[i * n + k] + d[k * n + j]);
+                }
+            }
+        }
+        d
+    }
+
+    #[test]
+    fn test_floyd_warshall_matches_naive_across_tiles() {
+        // 150 nodes spans three tiles, the last one partial.
+        let n = 150;
+        let mut rng = crate::rng::SplitMix64::new(7);
+        let (mut src, mut dst, mut weights) = (Vec::new(), Vec::new(), Vec::new());
+        for _ in 0..400 {
+            src.push(rng.below(n as u64) as i64);
+            dst.push(rng.below(n as u64) as i64);
+            weights.push(1.0 + rng.next_f64() * 9.0);
+        }
+        // Isolate the last node so some pairs are unreachable.
+        let keep: Vec<usize> = (0..src.len())
+            .filter(|&i| src[i] != 149 && dst[i] != 149)
+            .collect();
+        let src: Vec<i64> = keep.iter().map(|&i| src[i]).chain([149]).collect();
+        let dst: Vec<i64> = keep.iter().map(|&i| dst[i]).chain([149]).collect();
+        let weights: Vec<f64> = keep.iter().map(|&i| weights[i]).chain([1.0]).collect();
+
+        let expected = naive_floyd_warshall(n, &src, &dst, &weights);
+        let result = compute_floyd_warshall(&src, &dst, &weights).unwrap();
+        let reachable = (0..n * n)
+            .filter(|&c| c / n != c % n && expected[c].is_finite())
+            .count();
+        assert_eq!(result.src_nodes.len(), reachable);
+        for i in 0..result.src_nodes.len() {
+            let (u, v) = (result.src_nodes[i] as usize, result.dst_nodes[i] as usize);
+            assert!((result.distances[i] - expected[u * n + v]).abs() < 1e-9);
+        }
+        assert!(result.src_nodes.iter().all(|&u| u != 149));
+    }
+
+    #[test]
+    fn test_floyd_warshall_skips_unreachable_pairs() {
+        let result = compute_floyd_warshall(&[1, 3], &[2, 4], &[1.0, 2.0]).unwrap();
+        assert_eq!(result.src_nodes, vec![1, 2, 3, 4]);
+        assert_eq!(result.dst_nodes, vec![2, 1, 4, 3]);
+        assert_eq!(result.distances, vec![1.0, 1.0, 2.0, 2.0]);
+    }
+
+    #[test]
+    fn test_floyd_warshall_batches_resume() {
+        let src = vec![1, 2, 3, 4];
+        let dst = vec![2, 3, 4, 5];
+        let weights = vec![1.0; 4];
+        let mut matrix = floyd_warshall_matrix(&src, &dst, &weights, None).unwrap();
+        assert_eq!(matrix.node_count(), 5);
+        let (mut s, mut d, mut w) = ([0i64; 3], [0i64; 3], [0f64; 3]);
+        let mut total = 0;
+        loop {
+            let count = matrix.next_batch(&mut s, &mut d, &mut w);
+            total += count;
+            if count < s.len() {
+                break;
+            }
+        }
+        assert_eq!(total, 20);
+        assert_eq!(matrix.next_batch(&mut s, &mut d, &mut w), 0);
+    }
+
+    #[test]
+    fn test_floyd_warshall_memory_limit() {
+        let src = vec![1, 2, 3];
+        let dst = vec![2, 3, 4];
+        let weights = vec![1.0; 3];
+        // Four nodes need 4 * 4 * 8 = 128 bytes.
+        assert!(floyd_warshall_matrix(&src, &dst, &weights, Some(128)).is_ok());
+        let err = floyd_warshall_matrix(&src, &dst, &weights, Some(127))
+            .err()
+            .map(|e| e.to_string())
+            .unwrap_or_default();
+        assert!(err.contains("memory limit"));
+    }
+
+    #[test]
+    fn test_floyd_warshall_negative_cycle() {
+        assert!(compute_floyd_warshall(&[1, 2], &[2, 3], &[1.0, -1.0]).is_err());
+    }
+
     #[test]
     fn test_shortest_distance() {
         let src = vec![1, 2, 3];
@@ -474,9 +715,18 @@ mod tests {
         assert!(dist.is_infinite());
     }
 
+    #[test]
+    fn test_dijkstra_follows_weights() {
+        let (src, dst, weights) = ([1, 2, 1], [2, 3, 3], [1.0, 1.5, 5.0]);
+        let result = compute_dijkstra(&src, &dst, &weights, 1).unwrap();
+        assert_eq!(result.node_ids, vec![1, 2, 3]);
+        assert_eq!(result.distances, vec![0.0, 1.0, 2.5]);
+        assert!(compute_dijkstra(&src, &dst, &[1.0, -1.0, 5.0], 1).is_err());
+    }
+
     #[test]
     fn test_empty_graph_errors() {
-        assert!(compute_dijkstra(&[], &[], 1).is_err());
+        assert!(compute_dijkstra(&[], &[], &[], 1).is_err());
         assert!(compute_bfs(&[], &[], 1).is_err());
         assert!(compute_dfs(&[], &[], 1).is_err());
         assert!(compute_bellman_ford(&[], &[], &[], 1).is_err());
@@ -486,7 +736,7 @@ mod tests {
 
     #[test]
     fn test_mismatched_arrays_error() {
-        assert!(compute_dijkstra(&[1, 2], &[2], 1).is_err());
+        assert!(compute_dijkstra(&[1, 2], &[2], &[], 1).is_err());
         assert!(compute_bellman_ford(&[1, 2], &[2, 3], &[1.0], 1).is_err());
         assert!(compute_floyd_warshall(&[1, 2], &[2, 3], &[1.0]).is_err());
     }
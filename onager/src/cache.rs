@@ -0,0 +1,294 @@
+//! Build cache of CSR graphs keyed by the content of their input.
+//!
+//! Table functions that run back to back over the same edge subquery ingest
+//! identical edge arrays, and each would otherwise build the same CSR graph.
+//! With a capacity above zero, [`csr_from_edges`] keeps the most recently used
+//! builds and hands out shared references to them when the same edges come in
+//! again. The capacity bounds the bytes of the cached graphs' arrays, and the
+//! least recently used graphs are evicted until the rest fit in it, so a graph
+//! larger than the whole capacity is never kept. The cache is off by default and
+//! shared by the whole process.
+//!
+//! Inputs are identified by a 128-bit fingerprint of their edges and weights
+//! together with the edge count, direction, and weight precision. The fingerprint does not depend
+//! on row order, since DuckDB may deliver the same subquery in a different order
+//! on another run, and a hit costs one parallel pass over the input instead of a
+//! sort and two bucket passes. A graph reused from a differently ordered input
+//! may list the neighbors of a node in another order, as a fresh build of that
+//! input would.
+
+use std::sync::atomic::{AtomicU64, Ordering};
+use std::sync::Arc;
+
+use once_cell::sync::Lazy;
+use parking_lot::Mutex;
+
+use crate::csr::CsrGraph;
+use crate::error::Result;
+use crate::workers::fold_blocks;
+
+#[derive(Clone, Copy, Debug, PartialEq, Eq)]
+struct Key {
+    fingerprint: [u64; 2],
+    edges: usize,
+    weighted: bool,
+    float_weights: bool,
+    directed: bool,
+}
+
+/// A cached graph and the bytes of its arrays.
+struct Entry {
+    key: Key,
+    csr: Arc<CsrGraph>,
+    bytes: usize,
+}
+
+/// Cached graphs, most recently used last.
+struct GraphCache {
+    capacity: usize,
+    bytes: usize,
+    entries: Vec<Entry>,
+}
+
+impl GraphCache {
+    const fn new() -> Self {
+        GraphCache {
+            capacity: 0,
+            bytes: 0,
+            entries: Vec::new(),
+        }
+    }
+
+    fn get(&mut self, key: &Key) -> Option<Arc<CsrGraph>> {
+        let pos = self.entries.iter().position(|e| e.key == *key)?;
+        let entry = self.entries.remove(pos);
+        let csr = Arc::clone(&entry.csr);
+        self.entries.push(entry);
+        Some(csr)
+    }
+
+    fn insert(&mut self, key: Key, csr: &Arc<CsrGraph>) {
+        let bytes = csr.heap_bytes();
+        if bytes > self.capacity || self.entries.iter().any(|e| e.key == key) {
+            return;
+        }
+        self.bytes += bytes;
+        self.entries.push(Entry {
+            key,
+            csr: Arc::clone(csr),
+            bytes,
+        });
+        self.evict();
+    }
+
+    /// Drops the least recently used graphs until the rest fit in the capacity.
+    fn evict(&mut self) {
+        let mut excess = 0;
+        for entry in &self.entries {
+            if self.bytes <= self.capacity {
+                break;
+            }
+            self.bytes -= entry.bytes;
+            excess += 1;
+        }
+        self.entries.drain(..excess);
+    }
+
+    fn clear(&mut self) -> Vec<Entry> {
+        self.bytes = 0;
+        self.entries.drain(..).collect()
+    }
+}
+
+static CACHE: Lazy<Mutex<GraphCache>> = Lazy::new(|| Mutex::new(GraphCache::new()));
+
+static HITS: AtomicU64 = AtomicU64::new(0);
+static MISSES: AtomicU64 = AtomicU64::new(0);
+
+/// Counters and size of the graph build cache.
+#[repr(C)]
+#[derive(Clone, Copy, Debug, Default, PartialEq, Eq)]
+pub struct GraphCacheStats {
+    pub capacity: u64,
+    pub entries: u64,
+    pub hits: u64,
+    pub misses: u64,
+    pub bytes: u64,
+}
+
+/// Sets the most bytes of graphs the cache keeps, evicting the least recently
+/// used ones until the rest fit. A capacity of zero turns the cache off and empties it.
+pub fn set_capacity(capacity: usize) {
+    let mut cache = CACHE.lock();
+    cache.capacity = capacity;
+    cache.evict();
+}
+
+/// Drops every cached graph without changing the capacity, to make room for a build.
+///
+/// Returns whether any graph was dropped. Graphs still in use by a running call
+/// are freed when that call finishes.
+pub fn release() -> bool {
+    let dropped = CACHE.lock().clear();
+    !dropped.is_empty()
+}
+
+/// Returns the cache's capacity, contents, and hit and miss counts.
+pub fn stats() -> GraphCacheStats {
+    let cache = CACHE.lock();
+    GraphCacheStats {
+        capacity: cache.capacity as u64,
+        entries: cache.entries.len() as u64,
+        hits: HITS.load(Ordering::Relaxed),
+        misses: MISSES.load(Ordering::Relaxed),
+        bytes: cache.bytes as u64,
+    }
+}
+
+const FINGERPRINT_BLOCK: usize = 1 << 16;
+
+#[inline]
+fn mix(mut z: u64) -> u64 {
+    z = (z ^ (z >> 30)).wrapping_mul(0xBF58_476D_1CE4_E5B9);
+    z = (z ^ (z >> 27)).wrapping_mul(0x94D0_49BB_1331_11EB);
+    z ^ (z >> 31)
+}
+
+/// Hashes one edge into two independent 64-bit values.
+#[inline]
+fn edge_hash(u: i64, v: i64, w: u64) -> [u64; 2] {
+    let lane = |seed: u64| mix(mix(mix(u as u64 ^ seed) ^ v as u64) ^ w);
+    [lane(0x243F_6A88_85A3_08D3), lane(0x1319_8A2E_0370_7344)]
+}
+
+/// Fingerprints the multiset of edges, so the same edges in another row order
+/// get the same key. Edge hashes are summed, which makes the result independent
+/// of how the blocks are split across workers.
+fn key(src: &[i64], dst: &[i64], weights: Option<&[f64]>, directed: bool) -> Key {
+    let parts = fold_blocks(
+        src.len(),
+        FINGERPRINT_BLOCK,
+        || [0u64; 2],
+        |acc, range| {
+            for i in range {
+                let w = weights.map_or(0, |w| w[i].to_bits());
+                let [a, b] = edge_hash(src[i], dst[i], w);
+                acc[0] = acc[0].wrapping_add(a);
+                acc[1] = acc[1].wrapping_add(b);
+            }
+        },
+    );
+    let fingerprint = parts.iter().fold([0u64; 2], |acc, p| {
+        [acc[0].wrapping_add(p[0]), acc[1].wrapping_add(p[1])]
+    });
+    Key {
+        fingerprint,
+        edges: src.len(),
+        weighted: weights.is_some(),
+        float_weights: weights.is_some() && crate::control::float_weights(),
+        directed,
+    }
+}
+
+/// Builds a CSR graph from parallel edge arrays, or reuses a cached build of the same edges.
+///
+/// Takes the same arguments as [`CsrGraph::from_edges`]. When the cache is off,
+/// this builds the graph without fingerprinting the input.
+pub fn csr_from_edges(
+    src: &[i64],
+    dst: &[i64],
+    weights: Option<&[f64]>,
+    directed: bool,
+) -> Result<Arc<CsrGraph>> {
+    if CACHE.lock().capacity == 0 {
+        return CsrGraph::from_edges(src, dst, weights, directed).map(Arc::new);
+    }
+    let key = key(src, dst, weights, directed);
+    if let Some(csr) = CACHE.lock().get(&key) {
+        HITS.fetch_add(1, Ordering::Relaxed);
+        crate::profile::note_graph(csr.node_count(), csr.edge_count());
+        return Ok(csr);
+    }
+    MISSES.fetch_add(1, Ordering::Relaxed);
+    let csr = Arc::new(CsrGraph::from_edges(src, dst, weights, directed)?);
+    CACHE.lock().insert(key, &csr);
+    Ok(csr)
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    fn graph(src: &[i64], dst: &[i64]) -> Arc<CsrGraph> {
+        Arc::new(CsrGraph::from_edges(src, dst, None, false).unwrap())
+    }
+
+    #[test]
+    fn test_keys_cover_content_and_direction() {
+        let base = key(&[1, 2], &[2, 3], None, false);
+        assert_eq!(base, key(&[1, 2], &[2, 3], None, false));
+        assert_ne!(base, key(&[1, 2], &[2, 3], None, true));
+        assert_ne!(base, key(&[1, 2], &[2, 3], Some(&[1.0, 1.0]), false));
+        assert_eq!(base, key(&[2, 1], &[3, 2], None, false));
+        assert_ne!(base, key(&[2, 1], &[2, 3], None, false));
+        assert_ne!(base, key(&[1, 2, 2], &[2, 3, 3], None, false));
+        assert_ne!(base, key(&[1, 2, 3], &[2, 3, 1], None, false));
+        assert_ne!(
+            key(&[1], &[2], Some(&[1.0]), false),
+            key(&[1], &[2], Some(&[2.0]), false)
+        );
+    }
+
+    #[test]
+    fn test_least_recently_used_graphs_are_evicted() {
+        let graphs: Vec<_> = (0..3).map(|i| graph(&[i], &[i + 1])).collect();
+        let size = graphs[0].heap_bytes();
+        let mut cache = GraphCache::new();
+        cache.capacity = 2 * size;
+        let keys: Vec<Key> = (0..3).map(|i| key(&[i], &[i + 1], None, false)).collect();
+        cache.insert(keys[0], &graphs[0]);
+        cache.insert(keys[1], &graphs[1]);
+        assert!(Arc::ptr_eq(&cache.get(&keys[0]).unwrap(), &graphs[0]));
+        cache.insert(keys[2], &graphs[2]);
+        assert!(cache.get(&keys[1]).is_none());
+        assert!(cache.get(&keys[0]).is_some());
+        assert!(cache.get(&keys[2]).is_some());
+        assert_eq!(cache.bytes, 2 * size);
+
+        cache.capacity = size;
+        cache.evict();
+        assert_eq!(cache.entries.len(), 1);
+        assert!(cache.get(&keys[2]).is_some());
+        assert_eq!(cache.bytes, size);
+    }
+
+    #[test]
+    fn test_graphs_larger_than_the_capacity_are_not_kept() {
+        let small = graph(&[1], &[2]);
+        let large = graph(&[1, 2, 3, 4], &[2, 3, 4, 5]);
+        let mut cache = GraphCache::new();
+        cache.capacity = small.heap_bytes();
+        let small_key = key(&[1], &[2], None, false);
+        cache.insert(small_key, &small);
+        cache.insert(key(&[1, 2, 3, 4], &[2, 3, 4, 5], None, false), &large);
+        assert_eq!(cache.entries.len(), 1);
+        assert!(cache.get(&small_key).is_some());
+        assert_eq!(cache.bytes, small.heap_bytes());
+    }
+
+    #[test]
+    fn test_repeated_edges_reuse_one_build() {
+        // The cache is process-wide and other tests build graphs concurrently, so
+        // the capacity is large enough that this test's graph is not evicted.
+        set_capacity(1 << 30);
+        let before = stats();
+        let a = csr_from_edges(&[101, 102], &[102, 103], None, false).unwrap();
+        let again = csr_from_edges(&[101, 102], &[102, 103], None, false).unwrap();
+        assert!(Arc::ptr_eq(&a, &again));
+        let after = stats();
+        assert!(after.hits > before.hits);
+        assert!(after.bytes > 0);
+        set_capacity(0);
+        assert_eq!(stats().entries, 0);
+    }
+}
@@ -0,0 +1,429 @@
+//! Cancellation, progress, and thread budget of running computations.
+//!
+//! C++ installs a control on the thread that is about to make an FFI call, in
+//! the same place it opens the call's profile. The control holds two callbacks:
+//! one that tells whether the DuckDB query was interrupted, and one that takes
+//! the fraction of the work done so far. Long-running algorithms poll the first
+//! between iterations or blocks of sources and stop with
+//! [`OnagerError::Interrupted`], and report their progress through the second.
+//! The control also carries the number of threads the call may run on, which
+//! bounds [`crate::workers::worker_count`], and the memory left under DuckDB's
+//! `memory_limit`, which large allocations are checked against with [`reserve`],
+//! and whether the edge weights of graphs built for the call are stored as `f32`.
+//! The worker helpers hand the control of the calling thread to their workers,
+//! and background work started by a call runs under a [`detached`] copy of it.
+//!
+//! Once a poll has seen an interruption, every later poll of the same call sees
+//! it too, and the result of the call is discarded when it is converted for C++.
+
+use std::cell::RefCell;
+use std::os::raw::c_void;
+use std::sync::atomic::{AtomicBool, AtomicU32, Ordering};
+use std::sync::Arc;
+
+use crate::cache;
+use crate::error::{OnagerError, Result};
+use crate::profile;
+
+/// Callbacks and thread budget C++ passes for one FFI call.
+///
+/// `interrupted` and `progress` may be called from several threads at once, and
+/// `data` must stay valid until the call returns. Either callback may be null.
+/// `threads` is the number of threads the call may run on, or 0 for one per core.
+/// `memory_limit` is the number of bytes Rust code in the process may hold while
+/// the call runs, or `u64::MAX` for no limit. `float_weights` asks for the edge
+/// weights of graphs built during the call to be stored in 4 bytes each.
+#[repr(C)]
+#[derive(Clone, Copy, Debug)]
+pub struct OnagerCallControl {
+    pub interrupted: Option<extern "C" fn(data: *mut c_void) -> bool>,
+    pub progress: Option<extern "C" fn(data: *mut c_void, fraction: f64)>,
+    pub data: *mut c_void,
+    pub threads: u64,
+    pub memory_limit: u64,
+    pub float_weights: bool,
+}
+
+/// Progress is reported to C++ in steps of 1 / PROGRESS_STEPS.
+const PROGRESS_STEPS: u32 = 1000;
+
+struct Shared {
+    callbacks: OnagerCallControl,
+    stopped: AtomicBool,
+    /// Highest progress reported so far, in steps.
+    reported: AtomicU32,
+}
+
+// SAFETY: the callbacks are documented as thread-safe, and `data` is only ever
+// passed back to them.
+unsafe impl Send for Shared {}
+unsafe impl Sync for Shared {}
+
+/// Handle on the control of a call, shared by the threads working on it.
+#[derive(Clone)]
+pub struct Control(Arc<Shared>);
+
+thread_local! {
+    static ACTIVE: RefCell<Option<Control>> = const { RefCell::new(None) };
+    static LAST_INTERRUPTED: RefCell<bool> = const { RefCell::new(false) };
+}
+
+/// Installs the control of the next FFI call on this thread.
+pub fn begin(callbacks: OnagerCallControl) {
+    let control = Control(Arc::new(Shared {
+        callbacks,
+        stopped: AtomicBool::new(false),
+        reported: AtomicU32::new(0),
+    }));
+    ACTIVE.with(|cell| *cell.borrow_mut() = Some(control));
+}
+
+/// Removes the control installed on this thread and records whether its call was interrupted.
+pub fn finish() {
+    let control = ACTIVE.with(|cell| cell.borrow_mut().take());
+    let stopped = control.is_some_and(|c| c.0.stopped.load(Ordering::Relaxed));
+    LAST_INTERRUPTED.with(|cell| *cell.borrow_mut() = stopped);
+}
+
+/// Installs `control` on this thread for the rest of the current FFI call.
+///
+/// Calls that continue the work of an earlier one, such as reading rows from a
+/// stream it started, resume that call's control so they see its interrupts and
+/// [`finish`] records whether it stopped.
+pub fn resume(control: Option<Control>) {
+    ACTIVE.with(|cell| *cell.borrow_mut() = control);
+}
+
+/// Returns whether the last FFI call on this thread stopped because its query was interrupted.
+pub fn last_call_interrupted() -> bool {
+    LAST_INTERRUPTED.with(|cell| *cell.borrow())
+}
+
+/// Returns the control installed on this thread, if any.
+pub fn current() -> Option<Control> {
+    ACTIVE.with(|cell| cell.borrow().clone())
+}
+
+/// Returns a control for background work started by the current call, if it has one.
+///
+/// The control keeps the call's thread budget, memory limit, and weight precision
+/// but none of its callbacks, since their data is only valid until the call
+/// returns. Background work under it is never interrupted and reports no progress.
+pub fn detached() -> Option<Control> {
+    let callbacks = with_active(|shared| OnagerCallControl {
+        interrupted: None,
+        progress: None,
+        data: std::ptr::null_mut(),
+        ..shared.callbacks
+    })?;
+    Some(Control(Arc::new(Shared {
+        callbacks,
+        stopped: AtomicBool::new(false),
+        reported: AtomicU32::new(0),
+    })))
+}
+
+/// Runs `f` with `control` installed on this thread, for worker threads of a call.
+pub fn scope<R>(control: Option<Control>, f: impl FnOnce() -> R) -> R {
+    let previous = ACTIVE.with(|cell| std::mem::replace(&mut *cell.borrow_mut(), control));
+    let result = f();
+    ACTIVE.with(|cell| *cell.borrow_mut() = previous);
+    result
+}
+
+fn with_active<R>(f: impl FnOnce(&Shared) -> R) -> Option<R> {
+    ACTIVE.with(|cell| cell.borrow().as_ref().map(|c| f(&c.0)))
+}
+
+/// Returns the number of threads the current call may run on, if C++ set a limit.
+pub fn threads() -> Option<usize> {
+    with_active(|shared| usize::try_from(shared.callbacks.threads).unwrap_or(usize::MAX))
+        .filter(|&n| n > 0)
+}
+
+/// Returns the number of bytes Rust code may hold during the current call, if C++ set a limit.
+pub fn memory_limit() -> Option<usize> {
+    with_active(|shared| shared.callbacks.memory_limit)
+        .filter(|&limit| limit != u64::MAX)
+        .map(|limit| usize::try_from(limit).unwrap_or(usize::MAX))
+}
+
+/// Returns whether graphs built during the current call store their edge weights as `f32`.
+pub fn float_weights() -> bool {
+    with_active(|shared| shared.callbacks.float_weights).unwrap_or(false)
+}
+
+/// Fails with [`OnagerError::OutOfMemory`] if allocating `bytes` more would exceed the memory limit of the current call.
+///
+/// `what` describes the allocation for the error message, such as "a graph of 10
+/// edges". Rust allocations are invisible to DuckDB's buffer manager, so C++
+/// passes the memory left under `memory_limit` when the call starts, and this
+/// compares it with everything Rust code holds now plus `bytes`. When the
+/// allocation does not fit, cached graph builds are dropped before giving up.
+pub fn reserve(what: &str, bytes: usize) -> Result<()> {
+    let Some(limit) = memory_limit() else {
+        return Ok(());
+    };
+    let fits = || profile::allocated_bytes().saturating_add(bytes) <= limit;
+    if fits() || (cache::release() && fits()) {
+        return Ok(());
+    }
+    let left = limit.saturating_sub(profile::allocated_bytes());
+    Err(OnagerError::OutOfMemory(format!(
+        "{} needs about {} bytes, but only {} bytes are left under memory_limit",
+        what, bytes, left
+    )))
+}
+
+/// Returns whether the query of the current call was interrupted.
+///
+/// Cheap enough to call once per iteration or block, and always false outside
+/// a call that C++ installed a control for.
+pub fn interrupted() -> bool {
+    with_active(|shared| {
+        if shared.stopped.load(Ordering::Relaxed) {
+            return true;
+        }
+        let stop = shared
+            .callbacks
+            .interrupted
+            .is_some_and(|f| f(shared.callbacks.data));
+        if stop {
+            shared.stopped.store(true, Ordering::Relaxed);
+        }
+        stop
+    })
+    .unwrap_or(false)
+}
+
+/// Fails with [`OnagerError::Interrupted`] if the query of the current call was interrupted.
+pub fn check() -> Result<()> {
+    if interrupted() {
+        return Err(OnagerError::Interrupted);
+    }
+    Ok(())
+}
+
+/// Reports that `done` of `total` units of work are finished.
+///
+/// Progress only moves forward, so callers with several phases may report each
+/// one against its own total without the reported fraction going back.
+pub fn report(done: usize, total: usize) {
+    if total == 0 {
+        return;
+    }
+    with_active(|shared| {
+        let Some(progress) = shared.callbacks.progress else {
+            return;
+        };
+        let steps = (done.min(total) as u128 * PROGRESS_STEPS as u128 / total as u128) as u32;
+        if shared.reported.fetch_max(steps, Ordering::Relaxed) < steps {
+            progress(
+                shared.callbacks.data,
+                f64::from(steps) / f64::from(PROGRESS_STEPS),
+            );
+        }
+    });
+}
+
+/// Reports progress and then fails if the query was interrupted, for the top of an iteration.
+pub fn checkpoint(done: usize, total: usize) -> Result<()> {
+    report(done, total);
+    check()
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use std::sync::atomic::AtomicU64;
+
+    struct Probe {
+        stop: AtomicBool,
+        polls: AtomicU64,
+        last: AtomicU64,
+    }
+
+    extern "C" fn probe_interrupted(data: *mut c_void) -> bool {
+        let probe = unsafe { &*(data as *const Probe) };
+        probe.polls.fetch_add(1, Ordering::Relaxed);
+        probe.stop.load(Ordering::Relaxed)
+    }
+
+    extern "C" fn probe_progress(data: *mut c_void, fraction: f64) {
+        let probe = unsafe { &*(data as *const Probe) };
+        probe.last.store(fraction.to_bits(), Ordering::Relaxed);
+    }
+
+    fn install(probe: &Probe) {
+        begin(OnagerCallControl {
+            interrupted: Some(probe_interrupted),
+            progress: Some(probe_progress),
+            data: probe as *const Probe as *mut c_void,
+            threads: 0,
+            memory_limit: u64::MAX,
+            float_weights: false,
+        });
+    }
+
+    fn probe() -> Probe {
+        Probe {
+            stop: AtomicBool::new(false),
+            polls: AtomicU64::new(0),
+            last: AtomicU64::new(0),
+        }
+    }
+
+    #[test]
+    fn test_interruption_latches_until_finish() {
+        let probe = probe();
+        install(&probe);
+        assert!(check().is_ok());
+        probe.stop.store(true, Ordering::Relaxed);
+        assert!(matches!(check(), Err(OnagerError::Interrupted)));
+        probe.stop.store(false, Ordering::Relaxed);
+        assert!(interrupted());
+        finish();
+        assert!(last_call_interrupted());
+        assert!(!interrupted());
+
+        install(&probe);
+        finish();
+        assert!(!last_call_interrupted());
+    }
+
+    #[test]
+    fn test_progress_only_moves_forward() {
+        let probe = probe();
+        install(&probe);
+        report(1, 4);
+        assert_eq!(f64::from_bits(probe.last.load(Ordering::Relaxed)), 0.25);
+        report(1, 8);
+        report(0, 0);
+        assert_eq!(f64::from_bits(probe.last.load(Ordering::Relaxed)), 0.25);
+        report(9, 4);
+        assert_eq!(f64::from_bits(probe.last.load(Ordering::Relaxed)), 1.0);
+        finish();
+    }
+
+    #[test]
+    fn test_workers_see_the_control_of_their_call() {
+        let probe = probe();
+        install(&probe);
+        probe.stop.store(true, Ordering::Relaxed);
+        let control = current();
+        let seen = std::thread::scope(|s| s.spawn(|| scope(control, interrupted)).join().unwrap());
+        assert!(seen);
+        assert!(probe.polls.load(Ordering::Relaxed) >= 1);
+        finish();
+        assert!(std::thread::spawn(interrupted)
+            .join()
+            .is_ok_and(|stopped| !stopped));
+    }
+
+    #[test]
+    fn test_detached_control_keeps_budget_without_callbacks() {
+        assert!(detached().is_none());
+        let probe = probe();
+        begin(OnagerCallControl {
+            interrupted: Some(probe_interrupted),
+            progress: Some(probe_progress),
+            data: &probe as *const Probe as *mut c_void,
+            threads: 3,
+            memory_limit: 1 << 40,
+            float_weights: false,
+        });
+        probe.stop.store(true, Ordering::Relaxed);
+        let background = detached();
+        finish();
+        let seen = std::thread::spawn(move || {
+            scope(background, || {
+                report(1, 2);
+                (threads(), memory_limit(), interrupted())
+            })
+        })
+        .join()
+        .unwrap();
+        assert_eq!(seen, (Some(3), Some(1 << 40), false));
+        assert_eq!(probe.polls.load(Ordering::Relaxed), 0);
+        assert_eq!(probe.last.load(Ordering::Relaxed), 0);
+    }
+
+    #[test]
+    fn test_stream_reads_resume_their_call() {
+        use crate::algorithms::multi_source_search;
+
+        let (src, dst): (Vec<i64>, Vec<i64>) = (0..5000).map(|i| (i, i + 1)).unzip();
+        let sources: Vec<i64> = (0..200).collect();
+        let probe = probe();
+        install(&probe);
+        let mut stream = multi_source_search(&src, &dst, None, &sources)
+            .unwrap()
+            .stream();
+        finish();
+
+        let (mut s, mut n, mut d) = (vec![0; 16], vec![0; 16], vec![0.0; 16]);
+        assert_eq!(stream.next_batch(&mut s, &mut n, &mut d).unwrap(), 16);
+        finish();
+        assert!(!last_call_interrupted());
+        probe.stop.store(true, Ordering::Relaxed);
+        let read = stream.next_batch(&mut s, &mut n, &mut d);
+        assert!(matches!(read, Err(OnagerError::Interrupted)));
+        finish();
+        assert!(last_call_interrupted());
+        drop(stream);
+        assert!(!interrupted());
+    }
+
+    fn install_memory_limit(headroom: usize) {
+        begin(OnagerCallControl {
+            interrupted: None,
+            progress: None,
+            data: std::ptr::null_mut(),
+            threads: 0,
+            memory_limit: (profile::allocated_bytes() + headroom) as u64,
+            float_weights: false,
+        });
+    }
+
+    #[test]
+    fn test_reserve_checks_the_memory_limit() {
+        assert!(reserve("anything", usize::MAX).is_ok());
+        install_memory_limit(1 << 30);
+        assert!(reserve("a small table", 1024).is_ok());
+        let err = reserve("a huge table", 1 << 40).unwrap_err();
+        assert!(matches!(err, OnagerError::OutOfMemory(_)));
+        assert!(err.to_string().contains("a huge table needs about"));
+        finish();
+
+        // The ID array alone of this build needs 16 MiB
+        let (src, dst): (Vec<i64>, Vec<i64>) = (0..1 << 20).map(|i| (i, i + 1)).unzip();
+        install_memory_limit(1 << 20);
+        let build = crate::csr::CsrGraph::from_edges(&src, &dst, None, false);
+        assert!(matches!(build, Err(OnagerError::OutOfMemory(_))));
+        finish();
+        assert!(!last_call_interrupted());
+    }
+
+    #[test]
+    fn test_algorithms_stop_when_interrupted() {
+        use crate::algorithms::{compute_betweenness, compute_louvain_parallel, compute_pagerank};
+
+        let src = [1, 2, 3, 4];
+        let dst = [2, 3, 4, 1];
+        let probe = probe();
+        probe.stop.store(true, Ordering::Relaxed);
+        install(&probe);
+        let pagerank = compute_pagerank(&src, &dst, &[], 0.85, 100, 1e-6, false);
+        assert!(matches!(pagerank, Err(OnagerError::Interrupted)));
+        finish();
+        install(&probe);
+        let betweenness = compute_betweenness(&src, &dst, &[], true);
+        assert!(matches!(betweenness, Err(OnagerError::Interrupted)));
+        finish();
+        install(&probe);
+        let louvain = compute_louvain_parallel(&src, &dst, &[], Some(1));
+        assert!(matches!(louvain, Err(OnagerError::Interrupted)));
+        finish();
+        assert!(compute_pagerank(&src, &dst, &[], 0.85, 100, 1e-6, false).is_ok());
+    }
+}
@@ -0,0 +1,1166 @@
+//! Compressed sparse row (CSR) graph representation.
+//!
+//! Algorithms ingest their edge arrays through [`CsrGraph::from_edges`]. External
+//! node IDs are sorted and deduplicated into a compact ID array, every endpoint is
+//! mapped to a dense `u32` ID, and the edges are stored as offset and neighbor
+//! arrays in both directions. No hashing is involved.
+//!
+//! When the IDs fill most of their range, as in the common case of `0..n`, a
+//! build marks them in a table indexed by `id - min` and maps endpoints with a
+//! lookup in that table. Sparse IDs are sorted with a parallel radix sort and
+//! mapped by binary search. Dense IDs follow the order of the external IDs
+//! either way, so results listed by dense ID come out sorted by node ID.
+//!
+//! Edge weights are stored as `f64`, or as `f32` when the call asks for 4-byte
+//! weights with [`control::float_weights`], and read through [`WeightSlice`]
+//! either way.
+//!
+//! The arrays of a graph are [`Array`]s, which builds own and graphs opened from
+//! a snapshot borrow from its memory map, see [`crate::snapshot`].
+//!
+//! Algorithms that run on graphina build their graph from the CSR with
+//! [`CsrGraph::to_graph`] or [`CsrGraph::to_digraph`], which add nodes in dense
+//! ID order and return a [`NodeIndex`] for mapping between graphina node handles
+//! and external IDs.
+
+use graphina::core::types::{Digraph, Graph, NodeId};
+
+use std::fmt;
+use std::mem::size_of;
+use std::ops::{Deref, Range};
+use std::time::Instant;
+
+use crate::control;
+use crate::error::{OnagerError, Result};
+use crate::mmap::MappedSlice;
+use crate::profile;
+use crate::workers::{for_each_chunk_mut, map_blocks, map_parts};
+
+/// A graph in CSR form with dense `u32` node IDs.
+///
+/// Dense ID `u` corresponds to external ID `ids()[u]`, and the ID array is sorted,
+/// so going back to external IDs is an array lookup and going forward is a binary
+/// search. Edges are kept in input order within each source node, and parallel
+/// edges are preserved.
+#[derive(Debug, Clone)]
+pub struct CsrGraph {
+    directed: bool,
+    ids: Array<i64>,
+    out_offsets: Array<usize>,
+    out_targets: Array<u32>,
+    out_weights: Option<EdgeWeights>,
+    in_offsets: Array<usize>,
+    in_sources: Array<u32>,
+    in_weights: Option<EdgeWeights>,
+}
+
+/// Array of a [`CsrGraph`], owned or borrowed from a memory-mapped snapshot.
+#[derive(Clone)]
+pub enum Array<T> {
+    Owned(Vec<T>),
+    Mapped(MappedSlice<T>),
+}
+
+impl<T> Deref for Array<T> {
+    type Target = [T];
+
+    fn deref(&self) -> &[T] {
+        match self {
+            Array::Owned(values) => values,
+            Array::Mapped(values) => values.as_slice(),
+        }
+    }
+}
+
+impl<T> From<Vec<T>> for Array<T> {
+    fn from(values: Vec<T>) -> Self {
+        Array::Owned(values)
+    }
+}
+
+impl<T: fmt::Debug> fmt::Debug for Array<T> {
+    fn fmt(&self, f: &mut fmt::Formatter<'_>) -> fmt::Result {
+        self[..].fmt(f)
+    }
+}
+
+impl<T: PartialEq> PartialEq for Array<T> {
+    fn eq(&self, other: &Self) -> bool {
+        self[..] == other[..]
+    }
+}
+
+/// Edge weights of one direction of a [`CsrGraph`], in the precision they are stored in.
+#[derive(Debug, Clone, PartialEq)]
+pub enum EdgeWeights {
+    Double(Array<f64>),
+    Float(Array<f32>),
+}
+
+impl EdgeWeights {
+    /// Returns all of the weights.
+    pub fn as_slice(&self) -> WeightSlice<'_> {
+        match self {
+            EdgeWeights::Double(w) => WeightSlice::Double(w),
+            EdgeWeights::Float(w) => WeightSlice::Float(w),
+        }
+    }
+
+    /// Returns the number of weights.
+    pub fn len(&self) -> usize {
+        self.as_slice().len()
+    }
+
+    /// Returns true if there are no weights.
+    pub fn is_empty(&self) -> bool {
+        self.len() == 0
+    }
+
+    /// Returns the number of bytes the weights take.
+    pub fn bytes(&self) -> usize {
+        match self {
+            EdgeWeights::Double(w) => w.len() * size_of::<f64>(),
+            EdgeWeights::Float(w) => w.len() * size_of::<f32>(),
+        }
+    }
+}
+
+/// Borrowed run of edge weights, read as `f64` whatever precision they are stored in.
+#[derive(Debug, Clone, Copy, PartialEq)]
+pub enum WeightSlice<'a> {
+    Double(&'a [f64]),
+    Float(&'a [f32]),
+}
+
+impl<'a> WeightSlice<'a> {
+    /// Returns the number of weights.
+    pub fn len(self) -> usize {
+        match self {
+            WeightSlice::Double(w) => w.len(),
+            WeightSlice::Float(w) => w.len(),
+        }
+    }
+
+    /// Returns true if there are no weights.
+    pub fn is_empty(self) -> bool {
+        self.len() == 0
+    }
+
+    /// Returns weight `i`.
+    #[inline]
+    pub fn get(self, i: usize) -> f64 {
+        match self {
+            WeightSlice::Double(w) => w[i],
+            WeightSlice::Float(w) => f64::from(w[i]),
+        }
+    }
+
+    /// Returns the weights in `range`.
+    pub fn slice(self, range: Range<usize>) -> Self {
+        match self {
+            WeightSlice::Double(w) => WeightSlice::Double(&w[range]),
+            WeightSlice::Float(w) => WeightSlice::Float(&w[range]),
+        }
+    }
+
+    /// Iterates over the weights.
+    pub fn iter(self) -> impl Iterator<Item = f64> + 'a {
+        (0..self.len()).map(move |i| self.get(i))
+    }
+}
+
+impl CsrGraph {
+    /// Builds a CSR graph from parallel edge arrays.
+    ///
+    /// # Arguments
+    /// * `src` - Source node IDs
+    /// * `dst` - Destination node IDs
+    /// * `weights` - Optional edge weights, one per edge, stored as `f32` when
+    ///   [`control::float_weights`] is set for the current call
+    /// * `directed` - Whether the edges are directed
+    pub fn from_edges(
+        src: &[i64],
+        dst: &[i64],
+        weights: Option<&[f64]>,
+        directed: bool,
+    ) -> Result<Self> {
+        Self::from_nodes_and_edges(&[], src, dst, weights, directed)
+    }
+
+    /// Builds a CSR graph from a node list and parallel edge arrays.
+    ///
+    /// Nodes in `nodes` are included even if no edge touches them, and edge
+    /// endpoints missing from `nodes` are added.
+    ///
+    /// # Arguments
+    /// * `nodes` - Node IDs to include, in any order and possibly repeated
+    /// * `src` - Source node IDs
+    /// * `dst` - Destination node IDs
+    /// * `weights` - Optional edge weights, one per edge, stored as `f32` when
+    ///   [`control::float_weights`] is set for the current call
+    /// * `directed` - Whether the edges are directed
+    pub fn from_nodes_and_edges(
+        nodes: &[i64],
+        src: &[i64],
+        dst: &[i64],
+        weights: Option<&[f64]>,
+        directed: bool,
+    ) -> Result<Self> {
+        let started = Instant::now();
+        if src.len() != dst.len() {
+            return Err(OnagerError::InvalidArgument(
+                "src and dst arrays must have same length".to_string(),
+            ));
+        }
+        if let Some(w) = weights {
+            if w.len() != src.len() {
+                return Err(OnagerError::InvalidArgument(
+                    "src, dst, and weights arrays must have same length".to_string(),
+                ));
+            }
+        }
+
+        let m = src.len();
+        let what = || format!("building a graph of {} edges", m);
+        control::reserve(&what(), (nodes.len() + 2 * m) * size_of::<i64>())?;
+        let (ids, id_map) = index_ids([nodes, src, dst]);
+        if ids.len() > u32::MAX as usize {
+            return Err(OnagerError::InvalidArgument(format!(
+                "Graph has {} nodes, which exceeds the supported maximum of {}",
+                ids.len(),
+                u32::MAX
+            )));
+        }
+
+        let weight_size = match weights {
+            Some(_) if control::float_weights() => size_of::<f32>(),
+            Some(_) => size_of::<f64>(),
+            None => 0,
+        };
+        control::reserve(&what(), bucket_bytes(ids.len(), m, weight_size))?;
+
+        let src_dense = dense_ids(&ids, &id_map, src);
+        let dst_dense = dense_ids(&ids, &id_map, dst);
+        drop(id_map);
+        let n = ids.len();
+        let float = weight_size == size_of::<f32>();
+        let (out_offsets, out_targets, out_weights) =
+            bucket_edges(n, &src_dense, &dst_dense, weights, float);
+        let (in_offsets, in_sources, in_weights) =
+            bucket_edges(n, &dst_dense, &src_dense, weights, float);
+        profile::note_build(started.elapsed(), n, src.len());
+
+        Ok(CsrGraph {
+            directed,
+            ids: ids.into(),
+            out_offsets: out_offsets.into(),
+            out_targets: out_targets.into(),
+            out_weights,
+            in_offsets: in_offsets.into(),
+            in_sources: in_sources.into(),
+            in_weights,
+        })
+    }
+
+    /// Assembles a CSR graph from its ID array and its outgoing and incoming
+    /// `(offsets, neighbors, weights)` arrays, such as those read from a snapshot.
+    ///
+    /// The arrays are checked for consistency, so that lookups on the graph
+    /// cannot go out of bounds.
+    pub fn from_parts(
+        directed: bool,
+        ids: Array<i64>,
+        outgoing: (Array<usize>, Array<u32>, Option<EdgeWeights>),
+        incoming: (Array<usize>, Array<u32>, Option<EdgeWeights>),
+    ) -> Result<Self> {
+        if ids.len() > u32::MAX as usize || ids.windows(2).any(|w| w[0] >= w[1]) {
+            return Err(OnagerError::InvalidArgument(
+                "node IDs must be strictly increasing".to_string(),
+            ));
+        }
+        let (out_offsets, out_targets, out_weights) = outgoing;
+        let (in_offsets, in_sources, in_weights) = incoming;
+        let n = ids.len();
+        let m = out_targets.len();
+        for (offsets, neighbors, weights) in [
+            (&out_offsets, &out_targets, &out_weights),
+            (&in_offsets, &in_sources, &in_weights),
+        ] {
+            let offsets_valid = offsets.len() == n + 1
+                && offsets.first() == Some(&0)
+                && offsets.last() == Some(&m)
+                && offsets.windows(2).all(|w| w[0] <= w[1]);
+            if !offsets_valid || neighbors.len() != m {
+                return Err(OnagerError::InvalidArgument(
+                    "edge offsets do not match the node and edge counts".to_string(),
+                ));
+            }
+            if neighbors.iter().any(|&v| v as usize >= n) {
+                return Err(OnagerError::InvalidArgument(
+                    "edge endpoint is out of range".to_string(),
+                ));
+            }
+            if weights.as_ref().is_some_and(|w| w.len() != m) {
+                return Err(OnagerError::InvalidArgument(
+                    "edge weights do not match the edge count".to_string(),
+                ));
+            }
+        }
+        let precision =
+            |w: &Option<EdgeWeights>| w.as_ref().map(|w| matches!(w, EdgeWeights::Float(_)));
+        if precision(&out_weights) != precision(&in_weights) {
+            return Err(OnagerError::InvalidArgument(
+                "edge weights must be given for both directions in the same precision".to_string(),
+            ));
+        }
+        Ok(CsrGraph {
+            directed,
+            ids,
+            out_offsets,
+            out_targets,
+            out_weights,
+            in_offsets,
+            in_sources,
+            in_weights,
+        })
+    }
+
+    /// Returns true if the edges are directed.
+    pub fn is_directed(&self) -> bool {
+        self.directed
+    }
+
+    /// Returns the number of nodes.
+    pub fn node_count(&self) -> usize {
+        self.ids.len()
+    }
+
+    /// Returns the number of edges as given in the input.
+    pub fn edge_count(&self) -> usize {
+        self.out_targets.len()
+    }
+
+    /// Returns the number of bytes held by the graph's arrays.
+    pub fn heap_bytes(&self) -> usize {
+        let weights = |w: &Option<EdgeWeights>| w.as_ref().map_or(0, EdgeWeights::bytes);
+        self.ids.len() * size_of::<i64>()
+            + (self.out_offsets.len() + self.in_offsets.len()) * size_of::<usize>()
+            + (self.out_targets.len() + self.in_sources.len()) * size_of::<u32>()
+            + weights(&self.out_weights)
+            + weights(&self.in_weights)
+    }
+
+    /// Returns the sorted external node IDs, indexed by dense ID.
+    pub fn ids(&self) -> &[i64] {
+        &self.ids
+    }
+
+    /// Returns the external ID of a dense node ID.
+    pub fn external_id(&self, node: u32) -> i64 {
+        self.ids[node as usize]
+    }
+
+    /// Returns the dense ID of an external node ID, if the node exists.
+    ///
+    /// This is a subtraction when the IDs form one contiguous range, and a binary
+    /// search otherwise.
+    pub fn dense_id(&self, external: i64) -> Option<u32> {
+        let (&first, &last) = (self.ids.first()?, self.ids.last()?);
+        if last.wrapping_sub(first) as u64 == self.ids.len() as u64 - 1 {
+            return (first..=last)
+                .contains(&external)
+                .then(|| external.wrapping_sub(first) as u32);
+        }
+        self.ids.binary_search(&external).ok().map(|i| i as u32)
+    }
+
+    /// Returns the targets of the edges leaving `node`.
+    pub fn out_neighbors(&self, node: u32) -> &[u32] {
+        let u = node as usize;
+        &self.out_targets[self.out_offsets[u]..self.out_offsets[u + 1]]
+    }
+
+    /// Returns the sources of the edges entering `node`.
+    pub fn in_neighbors(&self, node: u32) -> &[u32] {
+        let u = node as usize;
+        &self.in_sources[self.in_offsets[u]..self.in_offsets[u + 1]]
+    }
+
+    /// Returns the whole outgoing adjacency as its offset, target, and weight arrays.
+    ///
+    /// The targets of node `u` are `targets[offsets[u]..offsets[u + 1]]`.
+    pub fn out_adjacency(&self) -> (&[usize], &[u32], Option<WeightSlice<'_>>) {
+        (
+            &self.out_offsets,
+            &self.out_targets,
+            self.out_weights.as_ref().map(EdgeWeights::as_slice),
+        )
+    }
+
+    /// Returns the whole incoming adjacency as its offset, source, and weight arrays.
+    ///
+    /// The sources of node `v` are `sources[offsets[v]..offsets[v + 1]]`.
+    pub fn in_adjacency(&self) -> (&[usize], &[u32], Option<WeightSlice<'_>>) {
+        (
+            &self.in_offsets,
+            &self.in_sources,
+            self.in_weights.as_ref().map(EdgeWeights::as_slice),
+        )
+    }
+
+    /// Returns the weights of the edges leaving `node`, aligned with `out_neighbors`.
+    pub fn out_weights(&self, node: u32) -> Option<WeightSlice<'_>> {
+        let u = node as usize;
+        self.out_weights.as_ref().map(|w| {
+            w.as_slice()
+                .slice(self.out_offsets[u]..self.out_offsets[u + 1])
+        })
+    }
+
+    /// Returns the weights of the edges entering `node`, aligned with `in_neighbors`.
+    pub fn in_weights(&self, node: u32) -> Option<WeightSlice<'_>> {
+        let u = node as usize;
+        self.in_weights.as_ref().map(|w| {
+            w.as_slice()
+                .slice(self.in_offsets[u]..self.in_offsets[u + 1])
+        })
+    }
+
+    /// Returns the first edge weight, in CSR order, for which `pred` holds.
+    pub fn find_weight(&self, pred: impl Fn(f64) -> bool) -> Option<f64> {
+        self.out_weights
+            .as_ref()?
+            .as_slice()
+            .iter()
+            .find(|&w| pred(w))
+    }
+
+    /// Returns true if the graph has edge weights and any of them is not 1.0.
+    ///
+    /// Engines with a faster unweighted path take it for graphs where this is false.
+    pub fn is_weighted(&self) -> bool {
+        self.find_weight(|w| w != 1.0).is_some()
+    }
+
+    /// Returns the number of edges leaving `node`.
+    pub fn out_degree(&self, node: u32) -> usize {
+        let u = node as usize;
+        self.out_offsets[u + 1] - self.out_offsets[u]
+    }
+
+    /// Returns the number of edges entering `node`.
+    pub fn in_degree(&self, node: u32) -> usize {
+        let u = node as usize;
+        self.in_offsets[u + 1] - self.in_offsets[u]
+    }
+
+    /// Returns the neighbors of `node`: out-neighbors for directed graphs, and
+    /// out-neighbors followed by in-neighbors for undirected graphs.
+    pub fn neighbors(&self, node: u32) -> impl Iterator<Item = u32> + '_ {
+        let incoming: &[u32] = if self.directed {
+            &[]
+        } else {
+            self.in_neighbors(node)
+        };
+        self.out_neighbors(node)
+            .iter()
+            .chain(incoming.iter())
+            .copied()
+    }
+
+    /// Returns about how many bytes a graphina graph of this CSR takes.
+    ///
+    /// Each node costs its ID, its graphina handle, and the lookups of
+    /// [`NodeIndex`], and each edge its weight and the endpoint and adjacency
+    /// links graphina keeps for it.
+    fn graphina_bytes<W>(&self) -> usize {
+        let node = size_of::<i64>() + 3 * size_of::<NodeId>();
+        let edge = size_of::<W>() + 4 * size_of::<NodeId>();
+        self.node_count() * node + self.edge_count() * edge
+    }
+
+    fn reserve_graphina<W>(&self) -> Result<()> {
+        control::reserve(
+            &format!(
+                "a graph of {} nodes and {} edges",
+                self.node_count(),
+                self.edge_count()
+            ),
+            self.graphina_bytes::<W>(),
+        )
+    }
+
+    /// Builds an undirected graphina graph with one edge per input edge.
+    ///
+    /// `weight` maps each edge weight (1.0 when the graph is unweighted) to the
+    /// graphina edge weight type. Fails with [`OnagerError::OutOfMemory`] before
+    /// building if the graph would not fit in the memory limit of the call.
+    pub fn to_graph<W>(
+        &self,
+        weight: impl FnMut(f64) -> W,
+    ) -> Result<(Graph<i64, W>, NodeIndex<'_>)> {
+        self.reserve_graphina::<W>()?;
+        let started = Instant::now();
+        let mut graph: Graph<i64, W> = Graph::new();
+        let handles: Vec<NodeId> = self.ids.iter().map(|&id| graph.add_node(id)).collect();
+        self.for_each_edge(weight, |u, v, w| {
+            graph.add_edge(handles[u as usize], handles[v as usize], w);
+        });
+        profile::note_build(started.elapsed(), self.node_count(), self.edge_count());
+        Ok((graph, NodeIndex::new(&self.ids, handles)))
+    }
+
+    /// Builds a directed graphina graph with one edge per input edge.
+    ///
+    /// `weight` maps each edge weight (1.0 when the graph is unweighted) to the
+    /// graphina edge weight type. Fails with [`OnagerError::OutOfMemory`] before
+    /// building if the graph would not fit in the memory limit of the call.
+    pub fn to_digraph<W>(
+        &self,
+        weight: impl FnMut(f64) -> W,
+    ) -> Result<(Digraph<i64, W>, NodeIndex<'_>)> {
+        self.reserve_graphina::<W>()?;
+        let started = Instant::now();
+        let mut graph: Digraph<i64, W> = Digraph::new();
+        let handles: Vec<NodeId> = self.ids.iter().map(|&id| graph.add_node(id)).collect();
+        self.for_each_edge(weight, |u, v, w| {
+            graph.add_edge(handles[u as usize], handles[v as usize], w);
+        });
+        profile::note_build(started.elapsed(), self.node_count(), self.edge_count());
+        Ok((graph, NodeIndex::new(&self.ids, handles)))
+    }
+
+    /// Calls `f` with the dense endpoints and mapped weight of every edge, in CSR order.
+    pub(crate) fn for_each_edge<W>(
+        &self,
+        mut weight: impl FnMut(f64) -> W,
+        mut f: impl FnMut(u32, u32, W),
+    ) {
+        for u in 0..self.ids.len() as u32 {
+            let targets = self.out_neighbors(u);
+            let weights = self.out_weights(u);
+            for (i, &v) in targets.iter().enumerate() {
+                let w = weights.map_or(1.0, |w| w.get(i));
+                f(u, v, weight(w));
+            }
+        }
+    }
+}
+
+/// Maps external IDs to the graphina node handles of a graph built from a [`CsrGraph`].
+pub struct NodeIndex<'a> {
+    ids: &'a [i64],
+    handles: Vec<NodeId>,
+    dense: Vec<u32>,
+}
+
+impl<'a> NodeIndex<'a> {
+    fn new(ids: &'a [i64], handles: Vec<NodeId>) -> Self {
+        let size = handles.iter().map(|h| h.index() + 1).max().unwrap_or(0);
+        let mut dense = vec![u32::MAX; size];
+        for (i, h) in handles.iter().enumerate() {
+            dense[h.index()] = i as u32;
+        }
+        NodeIndex {
+            ids,
+            handles,
+            dense,
+        }
+    }
+
+    /// Returns the number of nodes.
+    pub fn len(&self) -> usize {
+        self.handles.len()
+    }
+
+    /// Returns true if there are no nodes.
+    pub fn is_empty(&self) -> bool {
+        self.handles.is_empty()
+    }
+
+    /// Returns the graphina node handle of an external ID.
+    pub fn get(&self, external: &i64) -> Option<&NodeId> {
+        self.ids
+            .binary_search(external)
+            .ok()
+            .map(|i| &self.handles[i])
+    }
+
+    /// Returns the dense ID of a graphina node handle.
+    pub fn dense_id(&self, node: &NodeId) -> Option<u32> {
+        match self.dense.get(node.index()) {
+            Some(&u) if u != u32::MAX => Some(u),
+            _ => None,
+        }
+    }
+
+    /// Returns the external ID of a graphina node handle.
+    pub fn external_id(&self, node: &NodeId) -> Option<&i64> {
+        self.dense_id(node).and_then(|u| self.ids.get(u as usize))
+    }
+
+    /// Returns the graphina node handles, indexed by dense ID.
+    pub fn handles(&self) -> &[NodeId] {
+        &self.handles
+    }
+
+    /// Iterates over `(external ID, node handle)` pairs in ascending ID order.
+    pub fn iter(&self) -> impl Iterator<Item = (&i64, &NodeId)> + '_ {
+        self.ids.iter().zip(self.handles.iter())
+    }
+}
+
+/// Nodes per block when building neighbor sets in parallel.
+const NEIGHBOR_BLOCK: usize = 1024;
+
+/// Undirected neighbor sets without self-loops or parallel edges, sorted by dense ID.
+///
+/// Engines that need simple-graph semantics, such as common-neighbor scores or
+/// shortest-path counts, build these once from a [`CsrGraph`].
+pub struct NeighborSets {
+    offsets: Vec<usize>,
+    targets: Vec<u32>,
+}
+
+impl NeighborSets {
+    /// Treats every edge of the CSR as undirected.
+    pub fn from_csr(csr: &CsrGraph) -> Self {
+        let blocks = map_blocks(
+            csr.node_count(),
+            NEIGHBOR_BLOCK,
+            || (),
+            |_, nodes| {
+                let mut lens = Vec::with_capacity(nodes.len());
+                let mut targets = Vec::new();
+                for u in nodes {
+                    let u = u as u32;
+                    let start = targets.len();
+                    targets.extend(
+                        csr.out_neighbors(u)
+                            .iter()
+                            .chain(csr.in_neighbors(u))
+                            .copied()
+                            .filter(|&v| v != u),
+                    );
+                    targets[start..].sort_unstable();
+                    let mut end = start;
+                    for i in start..targets.len() {
+                        if end == start || targets[i] != targets[end - 1] {
+                            targets[end] = targets[i];
+                            end += 1;
+                        }
+                    }
+                    targets.truncate(end);
+                    lens.push(end - start);
+                }
+                (lens, targets)
+            },
+        );
+
+        let mut offsets = Vec::with_capacity(csr.node_count() + 1);
+        offsets.push(0);
+        let mut targets = Vec::new();
+        for (lens, block_targets) in blocks {
+            for len in lens {
+                offsets.push(offsets[offsets.len() - 1] + len);
+            }
+            targets.extend(block_targets);
+        }
+        NeighborSets { offsets, targets }
+    }
+
+    /// Returns the most bytes the neighbor sets of `csr` can take, for reserving them before a build.
+    pub fn max_bytes(csr: &CsrGraph) -> usize {
+        (csr.node_count() + 1) * size_of::<usize>() + 2 * csr.edge_count() * size_of::<u32>()
+    }
+
+    pub fn node_count(&self) -> usize {
+        self.offsets.len() - 1
+    }
+
+    pub fn get(&self, node: u32) -> &[u32] {
+        let u = node as usize;
+        &self.targets[self.offsets[u]..self.offsets[u + 1]]
+    }
+
+    pub fn degree(&self, node: u32) -> usize {
+        let u = node as usize;
+        self.offsets[u + 1] - self.offsets[u]
+    }
+}
+
+/// Undirected weighted neighbor sets without self-loops, sorted by dense ID.
+///
+/// The weighted counterpart of [`NeighborSets`] for engines that follow edge
+/// weights, such as weighted shortest-path counts. Parallel edges collapse into
+/// the lightest of them, and node `u` lists the same weight for `v` as `v` does
+/// for `u`.
+pub struct WeightedSets {
+    offsets: Vec<usize>,
+    targets: Vec<u32>,
+    weights: Vec<f64>,
+}
+
+impl WeightedSets {
+    /// Treats every edge of the CSR as undirected, with weight 1.0 when it has none.
+    pub fn from_csr(csr: &CsrGraph) -> Self {
+        let blocks = map_blocks(
+            csr.node_count(),
+            NEIGHBOR_BLOCK,
+            || (),
+            |_, nodes| {
+                let mut lens = Vec::with_capacity(nodes.len());
+                let mut edges: Vec<(u32, f64)> = Vec::new();
+                for u in nodes {
+                    let u = u as u32;
+                    let start = edges.len();
+                    for (neighbors, weights) in [
+                        (csr.out_neighbors(u), csr.out_weights(u)),
+                        (csr.in_neighbors(u), csr.in_weights(u)),
+                    ] {
+                        for (i, &v) in neighbors.iter().enumerate() {
+                            if v != u {
+                                edges.push((v, weights.map_or(1.0, |w| w.get(i))));
+                            }
+                        }
+                    }
+                    edges[start..].sort_unstable_by(|a, b| a.0.cmp(&b.0).then(a.1.total_cmp(&b.1)));
+                    let mut end = start;
+                    for i in start..edges.len() {
+                        if end == start || edges[i].0 != edges[end - 1].0 {
+                            edges[end] = edges[i];
+                            end += 1;
+                        }
+                    }
+                    edges.truncate(end);
+                    lens.push(end - start);
+                }
+                (lens, edges)
+            },
+        );
+
+        let mut offsets = Vec::with_capacity(csr.node_count() + 1);
+        offsets.push(0);
+        let mut targets = Vec::new();
+        let mut weights = Vec::new();
+        for (lens, edges) in blocks {
+            for len in lens {
+                offsets.push(offsets[offsets.len() - 1] + len);
+            }
+            targets.extend(edges.iter().map(|e| e.0));
+            weights.extend(edges.iter().map(|e| e.1));
+        }
+        WeightedSets {
+            offsets,
+            targets,
+            weights,
+        }
+    }
+
+    pub fn node_count(&self) -> usize {
+        self.offsets.len() - 1
+    }
+
+    /// Returns the neighbors of `node` and the weights of the edges to them.
+    pub fn get(&self, node: u32) -> (&[u32], &[f64]) {
+        let u = node as usize;
+        let range = self.offsets[u]..self.offsets[u + 1];
+        (&self.targets[range.clone()], &self.weights[range])
+    }
+}
+
+/// IDs may take the direct path when their range is at most this many times their count.
+const DIRECT_SPAN_PER_ID: u64 = 2;
+
+/// Endpoints per block when mapping them to dense IDs.
+const DENSE_ID_BLOCK: usize = 1 << 16;
+
+/// Slices shorter than this are sorted with the standard library instead of by radix.
+const RADIX_MIN_LEN: usize = 256;
+
+/// How the endpoints of a build are mapped to dense IDs.
+enum IdMap {
+    /// `rank[id - min]` is the dense ID of `id`.
+    Direct { min: i64, rank: Vec<u32> },
+    /// The dense ID of `id` is its position in the sorted ID array.
+    Sorted,
+}
+
+/// Collects the sorted, distinct IDs of all `parts` and the map from IDs to their positions.
+fn index_ids(parts: [&[i64]; 3]) -> (Vec<i64>, IdMap) {
+    let total: usize = parts.iter().map(|p| p.len()).sum();
+    let Some((min, max)) =
+        parts
+            .iter()
+            .flat_map(|p| p.iter())
+            .fold(None, |range, &x| match range {
+                None => Some((x, x)),
+                Some((lo, hi)) => Some((x.min(lo), x.max(hi))),
+            })
+    else {
+        return (Vec::new(), IdMap::Sorted);
+    };
+    let span = max.wrapping_sub(min) as u64;
+    if span < DIRECT_SPAN_PER_ID.saturating_mul(total as u64) {
+        let mut rank = vec![0u32; span as usize + 1];
+        for &x in parts.iter().flat_map(|p| p.iter()) {
+            rank[x.wrapping_sub(min) as usize] = 1;
+        }
+        let mut ids = Vec::with_capacity(rank.iter().filter(|&&r| r != 0).count());
+        for (offset, r) in rank.iter_mut().enumerate() {
+            if *r != 0 {
+                *r = ids.len() as u32;
+                ids.push(min.wrapping_add(offset as i64));
+            }
+        }
+        return (ids, IdMap::Direct { min, rank });
+    }
+    (sort_unique(parts, min, max, total), IdMap::Sorted)
+}
+
+/// Maps external IDs to dense IDs in parallel. Every ID must be in `ids`.
+fn dense_ids(ids: &[i64], id_map: &IdMap, nodes: &[i64]) -> Vec<u32> {
+    let mut dense = vec![0u32; nodes.len()];
+    for_each_chunk_mut(&mut dense, DENSE_ID_BLOCK, |b, out| {
+        let block = &nodes[b * DENSE_ID_BLOCK..];
+        for (d, &x) in out.iter_mut().zip(block) {
+            *d = match id_map {
+                IdMap::Direct { min, rank } => rank[x.wrapping_sub(*min) as usize],
+                // Err is unreachable since `ids` holds every endpoint
+                IdMap::Sorted => ids.binary_search(&x).unwrap_or_else(|i| i) as u32,
+            };
+        }
+    });
+    dense
+}
+
+/// Maps an ID to an unsigned key with the same order.
+#[inline]
+fn radix_key(x: i64) -> u64 {
+    (x as u64) ^ (1 << 63)
+}
+
+/// Sorts and deduplicates the IDs of all `parts`, whose values lie in `min..=max`.
+///
+/// One pass scatters the IDs into 256 buckets by the highest byte in which `min`
+/// and `max` differ. Higher bytes are the same for every ID, so the buckets are
+/// already in order, and each bucket is then sorted by its lower bytes with an
+/// LSD radix sort and deduplicated in parallel.
+fn sort_unique(parts: [&[i64]; 3], min: i64, max: i64, total: usize) -> Vec<i64> {
+    let top = 63 - (radix_key(min) ^ radix_key(max)).leading_zeros().min(63);
+    let shift = top / 8 * 8;
+    let bucket = |x: i64| ((radix_key(x) >> shift) & 0xFF) as usize;
+
+    let mut starts = [0usize; 257];
+    for &x in parts.iter().flat_map(|p| p.iter()) {
+        starts[bucket(x) + 1] += 1;
+    }
+    for b in 0..256 {
+        starts[b + 1] += starts[b];
+    }
+    let mut scattered = vec![0i64; total];
+    let mut cursor = starts;
+    for &x in parts.iter().flat_map(|p| p.iter()) {
+        let b = bucket(x);
+        scattered[cursor[b]] = x;
+        cursor[b] += 1;
+    }
+
+    let mut buckets = Vec::with_capacity(256);
+    let mut rest = scattered.as_mut_slice();
+    for b in 0..256 {
+        let (head, tail) = rest.split_at_mut(starts[b + 1] - starts[b]);
+        buckets.push(head);
+        rest = tail;
+    }
+    let lens = map_parts(buckets, |part| {
+        radix_sort_low(part, shift);
+        dedup_sorted(part)
+    });
+
+    let mut len = 0;
+    for (b, &unique) in lens.iter().enumerate() {
+        scattered.copy_within(starts[b]..starts[b] + unique, len);
+        len += unique;
+    }
+    scattered.truncate(len);
+    scattered.shrink_to_fit();
+    scattered
+}
+
+/// Sorts IDs that agree on every byte from `bits` up with an LSD radix sort on the bytes below.
+fn radix_sort_low(keys: &mut [i64], bits: u32) {
+    if keys.len() < RADIX_MIN_LEN {
+        keys.sort_unstable();
+        return;
+    }
+    let mut scratch = vec![0i64; keys.len()];
+    let (mut from, mut to) = (&mut *keys, scratch.as_mut_slice());
+    let mut swapped = false;
+    for shift in (0..bits).step_by(8) {
+        let digit = |x: i64| ((radix_key(x) >> shift) & 0xFF) as usize;
+        let mut counts = [0usize; 256];
+        for &x in from.iter() {
+            counts[digit(x)] += 1;
+        }
+        if counts.contains(&from.len()) {
+            continue;
+        }
+        let mut pos = 0;
+        for c in counts.iter_mut() {
+            let n = *c;
+            *c = pos;
+            pos += n;
+        }
+        for &x in from.iter() {
+            let d = digit(x);
+            to[counts[d]] = x;
+            counts[d] += 1;
+        }
+        std::mem::swap(&mut from, &mut to);
+        swapped = !swapped;
+    }
+    if swapped {
+        to.copy_from_slice(from);
+    }
+}
+
+/// Moves the distinct values of a sorted slice to its front and returns their count.
+fn dedup_sorted(keys: &mut [i64]) -> usize {
+    let mut len = 0;
+    for i in 0..keys.len() {
+        if len == 0 || keys[i] != keys[len - 1] {
+            keys[len] = keys[i];
+            len += 1;
+        }
+    }
+    len
+}
+
+/// Returns about how many bytes the dense endpoints and both edge groupings of a
+/// build take, with `weight_size` bytes per stored weight.
+fn bucket_bytes(n: usize, m: usize, weight_size: usize) -> usize {
+    let per_direction = (2 * n + 1) * size_of::<usize>() + m * size_of::<u32>() + m * weight_size;
+    2 * m * size_of::<u32>() + 2 * per_direction
+}
+
+/// Groups edges by their `from` endpoint with a stable counting sort, storing
+/// the weights as `f32` when `float` is set.
+fn bucket_edges(
+    n: usize,
+    from: &[u32],
+    to: &[u32],
+    weights: Option<&[f64]>,
+    float: bool,
+) -> (Vec<usize>, Vec<u32>, Option<EdgeWeights>) {
+    let mut offsets = vec![0usize; n + 1];
+    for &u in from {
+        offsets[u as usize + 1] += 1;
+    }
+    for i in 0..n {
+        offsets[i + 1] += offsets[i];
+    }
+    let mut cursor = offsets[..n].to_vec();
+    let mut targets = vec![0u32; to.len()];
+    let mut doubles = weights.filter(|_| !float).map(|w| vec![0.0f64; w.len()]);
+    let mut floats = weights.filter(|_| float).map(|w| vec![0.0f32; w.len()]);
+    for (e, (&u, &v)) in from.iter().zip(to.iter()).enumerate() {
+        let pos = cursor[u as usize];
+        cursor[u as usize] += 1;
+        targets[pos] = v;
+        if let Some(w) = weights {
+            if let Some(out) = doubles.as_mut() {
+                out[pos] = w[e];
+            } else if let Some(out) = floats.as_mut() {
+                out[pos] = w[e] as f32;
+            }
+        }
+    }
+    let bucketed = match (doubles, floats) {
+        (Some(w), _) => Some(EdgeWeights::Double(w.into())),
+        (None, Some(w)) => Some(EdgeWeights::Float(w.into())),
+        (None, None) => None,
+    };
+    (offsets, targets, bucketed)
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_dense_ids_are_sorted() {
+        let csr = CsrGraph::from_edges(&[30, 10, 20], &[10, 20, 30], None, true).unwrap();
+        assert_eq!(csr.ids(), &[10, 20, 30]);
+        assert_eq!(csr.dense_id(20), Some(1));
+        assert_eq!(csr.dense_id(25), None);
+        assert_eq!(csr.external_id(2), 30);
+    }
+
+    /// Reference build of the ID array and dense endpoints.
+    fn naive_ids(nodes: &[i64], src: &[i64]) -> (Vec<i64>, Vec<u32>) {
+        let mut ids: Vec<i64> = nodes.iter().chain(src).copied().collect();
+        ids.sort_unstable();
+        ids.dedup();
+        let dense = src
+            .iter()
+            .map(|x| ids.binary_search(x).unwrap() as u32)
+            .collect();
+        (ids, dense)
+    }
+
+    #[test]
+    fn test_direct_and_sorted_ids_match_sorting() {
+        let mut state = 0x9E37_79B9_7F4A_7C15u64;
+        let mut next = || {
+            state ^= state << 13;
+            state ^= state >> 7;
+            state ^= state << 17;
+            state
+        };
+        let dense: Vec<i64> = (0..20_000).map(|_| (next() % 15_000) as i64).collect();
+        let sparse: Vec<i64> = (0..20_000).map(|_| next() as i64).collect();
+        let mixed: Vec<i64> = (0..20_000)
+            .map(|i| match i % 3 {
+                0 => i64::MIN + (next() % 1000) as i64,
+                1 => i64::MAX - (next() % 1000) as i64,
+                _ => (next() % 1000) as i64 - 500,
+            })
+            .collect();
+        for ids in [&dense, &sparse, &mixed] {
+            let (nodes, src) = ids.split_at(1000);
+            let csr = CsrGraph::from_nodes_and_edges(nodes, src, src, None, true).unwrap();
+            let (expected, endpoints) = naive_ids(nodes, src);
+            assert_eq!(csr.ids(), expected.as_slice());
+            let sources: Vec<u32> = (0..csr.node_count() as u32)
+                .flat_map(|u| std::iter::repeat_n(u, csr.out_degree(u)))
+                .collect();
+            let mut sorted = endpoints.clone();
+            sorted.sort_unstable();
+            assert_eq!(sources, sorted);
+            for &x in &expected[..50] {
+                assert_eq!(csr.external_id(csr.dense_id(x).unwrap()), x);
+            }
+        }
+        assert!(matches!(
+            index_ids([&[], &dense, &[]]).1,
+            IdMap::Direct { .. }
+        ));
+        assert!(matches!(index_ids([&[], &sparse, &[]]).1, IdMap::Sorted));
+    }
+
+    #[test]
+    fn test_contiguous_ids_are_found_by_offset() {
+        let csr = CsrGraph::from_edges(&[-2, -1, 0], &[-1, 0, 1], None, true).unwrap();
+        assert_eq!(csr.dense_id(-2), Some(0));
+        assert_eq!(csr.dense_id(1), Some(3));
+        assert_eq!(csr.dense_id(2), None);
+        assert_eq!(csr.dense_id(-3), None);
+        let empty = CsrGraph::from_edges(&[], &[], None, true).unwrap();
+        assert_eq!(empty.dense_id(0), None);
+    }
+
+    #[test]
+    fn test_adjacency() {
+        let csr = CsrGraph::from_edges(&[1, 1, 2], &[2, 3, 3], None, true).unwrap();
+        assert_eq!(csr.node_count(), 3);
+        assert_eq!(csr.edge_count(), 3);
+        assert_eq!(csr.out_neighbors(0), &[1, 2]);
+        assert_eq!(csr.in_neighbors(2), &[0, 1]);
+        assert_eq!(csr.out_degree(2), 0);
+        assert_eq!(csr.in_degree(0), 0);
+    }
+
+    #[test]
+    fn test_undirected_neighbors() {
+        let csr = CsrGraph::from_edges(&[1, 2], &[2, 3], None, false).unwrap();
+        let neighbors: Vec<u32> = csr.neighbors(1).collect();
+        assert_eq!(neighbors, vec![2, 0]);
+    }
+
+    #[test]
+    fn test_weights_follow_edges() {
+        let csr =
+            CsrGraph::from_edges(&[2, 1, 1], &[1, 3, 2], Some(&[0.5, 1.5, 2.5]), true).unwrap();
+        assert_eq!(csr.out_neighbors(0), &[2, 1]);
+        assert_eq!(csr.out_weights(0), Some(WeightSlice::Double(&[1.5, 2.5])));
+        assert_eq!(csr.in_weights(0), Some(WeightSlice::Double(&[0.5])));
+    }
+
+    #[test]
+    fn test_weighted_sets_keep_the_lightest_edge() {
+        let csr = CsrGraph::from_edges(
+            &[1, 2, 1, 3, 3],
+            &[2, 1, 3, 3, 1],
+            Some(&[4.0, 2.5, 1.0, 9.0, 7.0]),
+            true,
+        )
+        .unwrap();
+        assert!(csr.is_weighted());
+        let sets = WeightedSets::from_csr(&csr);
+        assert_eq!(sets.get(0), (&[1, 2][..], &[2.5, 1.0][..]));
+        assert_eq!(sets.get(1), (&[0][..], &[2.5][..]));
+        assert_eq!(sets.get(2), (&[0][..], &[1.0][..]));
+
+        let unit = CsrGraph::from_edges(&[1], &[2], Some(&[1.0]), false).unwrap();
+        assert!(!unit.is_weighted());
+        assert_eq!(unit.find_weight(|w| w > 0.5), Some(1.0));
+    }
+
+    #[test]
+    fn test_float_weights_take_four_bytes() {
+        let (src, dst, weights) = ([2, 1, 1], [1, 3, 2], [0.5, 1.5, 0.1]);
+        let double = CsrGraph::from_edges(&src, &dst, Some(&weights), true).unwrap();
+        control::begin(control::OnagerCallControl {
+            interrupted: None,
+            progress: None,
+            data: std::ptr::null_mut(),
+            threads: 0,
+            memory_limit: u64::MAX,
+            float_weights: true,
+        });
+        let float = CsrGraph::from_edges(&src, &dst, Some(&weights), true);
+        control::finish();
+        let float = float.unwrap();
+        assert_eq!(float.out_weights(0), Some(WeightSlice::Float(&[1.5, 0.1])));
+        assert_eq!(float.out_weights(0).unwrap().get(1), f64::from(0.1f32));
+        assert_eq!(double.heap_bytes() - float.heap_bytes(), 2 * 3 * 4);
+        let unweighted = CsrGraph::from_edges(&src, &dst, None, true).unwrap();
+        assert_eq!(unweighted.out_weights(0), None);
+    }
+
+    #[test]
+    fn test_parallel_edges_preserved() {
+        let csr = CsrGraph::from_edges(&[1, 1], &[2, 2], None, true).unwrap();
+        assert_eq!(csr.edge_count(), 2);
+        assert_eq!(csr.out_neighbors(0), &[1, 1]);
+    }
+
+    #[test]
+    fn test_isolated_nodes_included() {
+        let g = CsrGraph::from_nodes_and_edges(&[7, 1, 7], &[1], &[2], None, true).unwrap();
+        assert_eq!(g.ids(), &[1, 2, 7]);
+        assert_eq!(g.edge_count(), 1);
+        assert_eq!(g.out_degree(2), 0);
+        assert_eq!(g.in_degree(2), 0);
+    }
+
+    #[test]
+    fn test_mismatched_lengths() {
+        assert!(CsrGraph::from_edges(&[1, 2], &[2], None, true).is_err());
+        assert!(CsrGraph::from_edges(&[1], &[2], Some(&[]), true).is_err());
+    }
+
+    #[test]
+    fn test_node_index_round_trip() {
+        let csr = CsrGraph::from_edges(&[5, 7], &[7, 9], None, false).unwrap();
+        let (graph, nodes) = csr.to_graph(|w| w).unwrap();
+        assert_eq!(graph.node_count(), 3);
+        assert_eq!(graph.edge_count(), 2);
+        for (ext, handle) in nodes.iter() {
+            assert_eq!(nodes.get(ext), Some(handle));
+            assert_eq!(nodes.external_id(handle), Some(ext));
+        }
+        assert!(nodes.get(&6).is_none());
+    }
+}
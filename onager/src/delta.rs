@@ -0,0 +1,359 @@
+//! Pending changes to registry graphs on top of their compacted CSR form.
+//!
+//! A registry graph keeps a base [`CsrGraph`] and a [`Delta`] of the nodes and
+//! edges inserted and the edges deleted since that base was built. Changes only
+//! touch the delta, so a batch costs time in its own size rather than the
+//! graph's, and degree lookups combine the base and the delta without building
+//! anything. Compaction merges the delta into a new base, which [`crate::graph`]
+//! does when a call needs the CSR form of the graph or, once the delta is large,
+//! in the background.
+//!
+//! A delete removes every edge between its endpoints, whether the edge is in
+//! the base or was inserted since. In undirected graphs the endpoints may be
+//! given in either order. Deleting an edge keeps its endpoints as nodes.
+
+use std::collections::{HashMap, HashSet};
+
+use crate::csr::CsrGraph;
+use crate::error::Result;
+
+/// Operation code of an edge insert in a delta batch.
+pub const INSERT: i64 = 1;
+/// Operation code of an edge delete in a delta batch.
+pub const DELETE: i64 = -1;
+
+/// Nodes and edges inserted and edges deleted since a base graph was built.
+#[derive(Clone, Debug, Default)]
+pub struct Delta {
+    directed: bool,
+    /// Nodes that are not in the base, in the order they were added
+    nodes: Vec<i64>,
+    node_set: HashSet<i64>,
+    /// Inserted edges, set to None when deleted again
+    inserted: Vec<Option<(i64, i64, f64)>>,
+    /// Positions in `inserted` of the edges between each endpoint pair
+    inserted_by_pair: HashMap<(i64, i64), Vec<usize>>,
+    live_inserted: usize,
+    /// Endpoint pairs whose base edges are deleted
+    deleted: HashSet<(i64, i64)>,
+    deleted_base_edges: usize,
+    /// Change of the in-degree and out-degree of each node
+    degrees: HashMap<i64, [i64; 2]>,
+}
+
+impl Delta {
+    /// Creates an empty delta for a graph with the given direction.
+    pub fn new(directed: bool) -> Self {
+        Delta {
+            directed,
+            ..Default::default()
+        }
+    }
+
+    /// Returns the number of nodes, edges, and deleted endpoint pairs recorded.
+    pub fn changes(&self) -> usize {
+        self.nodes.len() + self.inserted.len() + self.deleted.len()
+    }
+
+    /// Returns true if the delta records no change.
+    pub fn is_empty(&self) -> bool {
+        self.changes() == 0
+    }
+
+    /// Returns the key of the edges between `u` and `v`, ignoring their order
+    /// in undirected graphs.
+    fn pair(&self, u: i64, v: i64) -> (i64, i64) {
+        if self.directed || u <= v {
+            (u, v)
+        } else {
+            (v, u)
+        }
+    }
+
+    /// Returns true if the node is in the base or was added since.
+    pub fn contains_node(&self, base: &CsrGraph, node: i64) -> bool {
+        base.dense_id(node).is_some() || self.node_set.contains(&node)
+    }
+
+    /// Adds a node, returning false if the graph already has it.
+    pub fn add_node(&mut self, base: &CsrGraph, node: i64) -> bool {
+        if self.contains_node(base, node) {
+            return false;
+        }
+        self.node_set.insert(node);
+        self.nodes.push(node);
+        true
+    }
+
+    /// Inserts an edge between two nodes that are in the graph.
+    pub fn insert_edge(&mut self, src: i64, dst: i64, weight: f64) {
+        let pair = self.pair(src, dst);
+        self.inserted_by_pair
+            .entry(pair)
+            .or_default()
+            .push(self.inserted.len());
+        self.inserted.push(Some((src, dst, weight)));
+        self.live_inserted += 1;
+        self.shift_degrees(src, dst, 1);
+    }
+
+    /// Deletes every edge between `src` and `dst` and returns how many there were.
+    pub fn delete_edge(&mut self, base: &CsrGraph, src: i64, dst: i64) -> usize {
+        let pair = self.pair(src, dst);
+        let mut removed = 0;
+        if !self.deleted.contains(&pair) {
+            let (forward, backward) = self.base_edges(base, src, dst);
+            if forward + backward > 0 {
+                self.deleted.insert(pair);
+                self.deleted_base_edges += forward + backward;
+                self.shift_degrees(src, dst, -(forward as i64));
+                self.shift_degrees(dst, src, -(backward as i64));
+                removed += forward + backward;
+            }
+        }
+        for i in self.inserted_by_pair.remove(&pair).unwrap_or_default() {
+            if let Some((u, v, _)) = self.inserted[i].take() {
+                self.shift_degrees(u, v, -1);
+                self.live_inserted -= 1;
+                removed += 1;
+            }
+        }
+        removed
+    }
+
+    /// Counts the base edges from `src` to `dst` and, in undirected graphs, from
+    /// `dst` to `src`.
+    fn base_edges(&self, base: &CsrGraph, src: i64, dst: i64) -> (usize, usize) {
+        let (Some(u), Some(v)) = (base.dense_id(src), base.dense_id(dst)) else {
+            return (0, 0);
+        };
+        let count = |a: u32, b: u32| base.out_neighbors(a).iter().filter(|&&t| t == b).count();
+        let backward = if self.directed || u == v {
+            0
+        } else {
+            count(v, u)
+        };
+        (count(u, v), backward)
+    }
+
+    fn shift_degrees(&mut self, src: i64, dst: i64, by: i64) {
+        self.degrees.entry(src).or_default()[1] += by;
+        self.degrees.entry(dst).or_default()[0] += by;
+    }
+
+    /// Returns the number of nodes of the base with the delta applied.
+    pub fn node_count(&self, base: &CsrGraph) -> usize {
+        base.node_count() + self.nodes.len()
+    }
+
+    /// Returns the number of edges of the base with the delta applied.
+    pub fn edge_count(&self, base: &CsrGraph) -> usize {
+        base.edge_count() - self.deleted_base_edges + self.live_inserted
+    }
+
+    /// Returns the in-degree (`inbound`) or out-degree of a node with the delta
+    /// applied, or None if the node is not in the graph. Undirected graphs report
+    /// the node's degree for both.
+    pub fn degree(&self, base: &CsrGraph, node: i64, inbound: bool) -> Option<usize> {
+        let [base_in, base_out] = match base.dense_id(node) {
+            Some(u) => [base.in_degree(u) as i64, base.out_degree(u) as i64],
+            None if self.node_set.contains(&node) => [0, 0],
+            None => return None,
+        };
+        let [change_in, change_out] = self.degrees.get(&node).copied().unwrap_or_default();
+        let (d_in, d_out) = (base_in + change_in, base_out + change_out);
+        let degree = if !self.directed {
+            d_in + d_out
+        } else if inbound {
+            d_in
+        } else {
+            d_out
+        };
+        Some(degree.max(0) as usize)
+    }
+
+    /// Builds the CSR form of the base with the delta merged in.
+    ///
+    /// Base edges keep their order and inserted edges follow them in the order
+    /// they were inserted.
+    pub fn compact(&self, base: &CsrGraph) -> Result<CsrGraph> {
+        let m = self.edge_count(base);
+        let mut src = Vec::with_capacity(m);
+        let mut dst = Vec::with_capacity(m);
+        let mut weights = Vec::with_capacity(m);
+        base.for_each_edge(
+            |w| w,
+            |u, v, w| {
+                let (u, v) = (base.external_id(u), base.external_id(v));
+                if !self.deleted.contains(&self.pair(u, v)) {
+                    src.push(u);
+                    dst.push(v);
+                    weights.push(w);
+                }
+            },
+        );
+        for &(u, v, w) in self.inserted.iter().flatten() {
+            src.push(u);
+            dst.push(v);
+            weights.push(w);
+        }
+        let mut nodes = Vec::with_capacity(self.node_count(base));
+        nodes.extend_from_slice(base.ids());
+        nodes.extend_from_slice(&self.nodes);
+        CsrGraph::from_nodes_and_edges(&nodes, &src, &dst, Some(&weights), self.directed)
+    }
+}
+
+/// Connected components of a registry graph, kept up to date as edges are inserted.
+///
+/// A union-find forest over every node with path halving, so an insert joins
+/// two components in near constant time. A delete can split a component, so the
+/// registry drops the forest when an edge is deleted and builds it again on the
+/// next query.
+#[derive(Clone, Debug)]
+pub struct Components {
+    slots: HashMap<i64, u32>,
+    ids: Vec<i64>,
+    parent: Vec<u32>,
+}
+
+impl Components {
+    /// Builds the components of a CSR graph, treating its edges as undirected.
+    pub fn from_csr(csr: &CsrGraph) -> Self {
+        let ids = csr.ids().to_vec();
+        let mut components = Components {
+            slots: ids
+                .iter()
+                .enumerate()
+                .map(|(i, &id)| (id, i as u32))
+                .collect(),
+            parent: (0..ids.len() as u32).collect(),
+            ids,
+        };
+        csr.for_each_edge(|_| (), |u, v, ()| components.union(u, v));
+        components
+    }
+
+    fn find(&mut self, mut x: u32) -> u32 {
+        while self.parent[x as usize] != x {
+            let grandparent = self.parent[self.parent[x as usize] as usize];
+            self.parent[x as usize] = grandparent;
+            x = grandparent;
+        }
+        x
+    }
+
+    fn union(&mut self, a: u32, b: u32) {
+        let (a, b) = (self.find(a), self.find(b));
+        if a != b {
+            self.parent[a.max(b) as usize] = a.min(b);
+        }
+    }
+
+    fn slot(&mut self, node: i64) -> u32 {
+        if let Some(&slot) = self.slots.get(&node) {
+            return slot;
+        }
+        let slot = self.ids.len() as u32;
+        self.slots.insert(node, slot);
+        self.ids.push(node);
+        self.parent.push(slot);
+        slot
+    }
+
+    /// Adds a node as a component of its own if it is new.
+    pub fn add_node(&mut self, node: i64) {
+        self.slot(node);
+    }
+
+    /// Joins the components of the endpoints of an inserted edge.
+    pub fn insert_edge(&mut self, src: i64, dst: i64) {
+        let (a, b) = (self.slot(src), self.slot(dst));
+        self.union(a, b);
+    }
+
+    /// Returns every node in ascending ID order with its component number.
+    ///
+    /// Components are numbered from 0 in the order of their smallest node ID.
+    pub fn labels(&mut self) -> (Vec<i64>, Vec<i64>) {
+        let mut order: Vec<u32> = (0..self.ids.len() as u32).collect();
+        order.sort_unstable_by_key(|&slot| self.ids[slot as usize]);
+        let mut label = vec![-1i64; self.ids.len()];
+        let mut next = 0;
+        let mut labels = Vec::with_capacity(order.len());
+        for &slot in &order {
+            let root = self.find(slot) as usize;
+            if label[root] < 0 {
+                label[root] = next;
+                next += 1;
+            }
+            labels.push(label[root]);
+        }
+        let nodes = order.iter().map(|&slot| self.ids[slot as usize]).collect();
+        (nodes, labels)
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    fn base(src: &[i64], dst: &[i64], directed: bool) -> CsrGraph {
+        CsrGraph::from_edges(src, dst, None, directed).unwrap()
+    }
+
+    #[test]
+    fn test_deletes_cover_base_and_inserted_edges() {
+        let base = base(&[1, 2, 3], &[2, 1, 4], false);
+        let mut delta = Delta::new(false);
+        assert!(delta.add_node(&base, 5));
+        assert!(!delta.add_node(&base, 5));
+        assert!(!delta.add_node(&base, 1));
+        delta.insert_edge(1, 2, 2.0);
+        delta.insert_edge(4, 5, 1.0);
+        assert_eq!(delta.edge_count(&base), 5);
+        assert_eq!(delta.degree(&base, 1, true), Some(3));
+        assert_eq!(delta.degree(&base, 5, false), Some(1));
+
+        // Both base edges and the inserted one, given in either order
+        assert_eq!(delta.delete_edge(&base, 2, 1), 3);
+        assert_eq!(delta.delete_edge(&base, 1, 2), 0);
+        assert_eq!(delta.delete_edge(&base, 9, 1), 0);
+        assert_eq!(delta.edge_count(&base), 2);
+        assert_eq!(delta.degree(&base, 1, true), Some(0));
+        assert_eq!(delta.degree(&base, 4, true), Some(2));
+        assert_eq!(delta.degree(&base, 9, true), None);
+
+        let merged = delta.compact(&base).unwrap();
+        assert_eq!(merged.ids(), &[1, 2, 3, 4, 5]);
+        assert_eq!(merged.edge_count(), 2);
+        assert_eq!(merged.neighbors(3).collect::<Vec<_>>(), vec![4, 2]);
+    }
+
+    #[test]
+    fn test_directed_deletes_follow_direction() {
+        let base = base(&[1, 2], &[2, 1], true);
+        let mut delta = Delta::new(true);
+        assert_eq!(delta.delete_edge(&base, 1, 2), 1);
+        assert_eq!(delta.degree(&base, 1, false), Some(0));
+        assert_eq!(delta.degree(&base, 1, true), Some(1));
+        delta.insert_edge(1, 2, 0.5);
+        let merged = delta.compact(&base).unwrap();
+        assert_eq!(merged.edge_count(), 2);
+        assert_eq!(merged.out_neighbors(0), &[1]);
+        assert_eq!(merged.out_weights(0).map(|w| w.get(0)), Some(0.5));
+    }
+
+    #[test]
+    fn test_components_follow_inserts() {
+        let csr = base(&[1, 3], &[2, 4], false);
+        let mut components = Components::from_csr(&csr);
+        assert_eq!(components.labels(), (vec![1, 2, 3, 4], vec![0, 0, 1, 1]));
+        components.add_node(0);
+        components.insert_edge(2, 3);
+        assert_eq!(
+            components.labels(),
+            (vec![0, 1, 2, 3, 4], vec![0, 1, 1, 1, 1])
+        );
+    }
+}
@@ -28,9 +28,21 @@ pub enum OnagerError {
     #[error("Graph error: {0}")]
     GraphError(String),
 
+    /// File system error, with the path it occurred on.
+    #[error("I/O error: {0}")]
+    Io(String),
+
     /// Serialization error.
     #[error("Serialization error: {0}")]
     SerializationError(String),
+
+    /// The query that started the computation was interrupted.
+    #[error("Interrupted")]
+    Interrupted,
+
+    /// The computation would need more memory than its query may still use.
+    #[error("Out of memory: {0}")]
+    OutOfMemory(String),
 }
 
 impl From<serde_json::Error> for OnagerError {
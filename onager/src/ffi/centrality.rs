@@ -3,45 +3,42 @@
 //! PageRank, Degree, Betweenness, Closeness, Eigenvector, Katz, Harmonic.
 #![allow(clippy::not_unsafe_ptr_arg_deref)]
 
-use super::common::{clear_last_error, set_last_error};
+use super::common::{clear_last_error, into_result_ptr, set_last_error, OnagerResult};
 use crate::algorithms;
 
 /// Compute PageRank on edge arrays.
+/// `weights_ptr` may be null for an unweighted graph.
 #[no_mangle]
 pub extern "C" fn onager_compute_pagerank(
     src_ptr: *const i64,
     dst_ptr: *const i64,
     edge_count: usize,
+    weights_ptr: *const f64,
+    weights_count: usize,
     damping: f64,
     iterations: usize,
+    tolerance: f64,
     directed: bool,
-    out_nodes: *mut i64,
-    out_ranks: *mut f64,
-) -> i64 {
+) -> *mut OnagerResult {
     clear_last_error();
-    crate::ffi_catch_unwind!(-1, {
+    crate::ffi_catch_unwind!(std::ptr::null_mut(), {
         if src_ptr.is_null() || dst_ptr.is_null() {
             set_last_error("Null pointer for src or dst");
-            return -1;
+            return std::ptr::null_mut();
         }
         let src = unsafe { std::slice::from_raw_parts(src_ptr, edge_count) };
         let dst = unsafe { std::slice::from_raw_parts(dst_ptr, edge_count) };
-        match algorithms::compute_pagerank(src, dst, &[], damping, iterations, directed) {
-            Ok(result) => {
-                let node_count = result.node_ids.len();
-                if !out_nodes.is_null() && !out_ranks.is_null() {
-                    let out_n = unsafe { std::slice::from_raw_parts_mut(out_nodes, node_count) };
-                    let out_r = unsafe { std::slice::from_raw_parts_mut(out_ranks, node_count) };
-                    out_n.copy_from_slice(&result.node_ids);
-                    out_r.copy_from_slice(&result.ranks);
-                }
-                node_count as i64
-            }
-            Err(e) => {
-                set_last_error(&e.to_string());
-                -1
-            }
-        }
+        let weights = if weights_ptr.is_null() || weights_count == 0 {
+            &[]
+        } else {
+            unsafe { std::slice::from_raw_parts(weights_ptr, weights_count) }
+        };
+        into_result_ptr(
+            algorithms::compute_pagerank(
+                src, dst, weights, damping, iterations, tolerance, directed,
+            ),
+            pagerank_result,
+        )
     })
 }
 
@@ -55,15 +52,14 @@ pub extern "C" fn onager_compute_pagerank_parallel(
     weights_count: usize,
     damping: f64,
     iterations: usize,
+    tolerance: f64,
     directed: bool,
-    out_node_ids: *mut i64,
-    out_ranks: *mut f64,
-) -> i64 {
+) -> *mut OnagerResult {
     clear_last_error();
-    crate::ffi_catch_unwind!(-1, {
+    crate::ffi_catch_unwind!(std::ptr::null_mut(), {
         if src_ptr.is_null() || dst_ptr.is_null() {
             set_last_error("Null pointer");
-            return -1;
+            return std::ptr::null_mut();
         }
         let src = unsafe { std::slice::from_raw_parts(src_ptr, edge_count) };
         let dst = unsafe { std::slice::from_raw_parts(dst_ptr, edge_count) };
@@ -72,27 +68,21 @@ pub extern "C" fn onager_compute_pagerank_parallel(
         } else {
             unsafe { std::slice::from_raw_parts(weights_ptr, weights_count) }
         };
-        match algorithms::compute_pagerank_parallel(
-            src, dst, weights, damping, iterations, directed,
-        ) {
-            Ok(result) => {
-                let n = result.node_ids.len();
-                if !out_node_ids.is_null() && !out_ranks.is_null() {
-                    unsafe { std::slice::from_raw_parts_mut(out_node_ids, n) }
-                        .copy_from_slice(&result.node_ids);
-                    unsafe { std::slice::from_raw_parts_mut(out_ranks, n) }
-                        .copy_from_slice(&result.ranks);
-                }
-                n as i64
-            }
-            Err(e) => {
-                set_last_error(&e.to_string());
-                -1
-            }
-        }
+        into_result_ptr(
+            algorithms::compute_pagerank_parallel(
+                src, dst, weights, damping, iterations, tolerance, directed,
+            ),
+            pagerank_result,
+        )
     })
 }
 
+/// Converts a PageRank result into `node_id, rank, iterations` columns.
+pub(crate) fn pagerank_result(result: algorithms::PageRankResult) -> OnagerResult {
+    let iterations = vec![result.iterations as i64; result.node_ids.len()];
+    OnagerResult::new(vec![result.node_ids, iterations], vec![result.ranks])
+}
+
 /// Compute degree centrality on edge arrays.
 #[no_mangle]
 pub extern "C" fn onager_compute_degree(
@@ -100,36 +90,21 @@ pub extern "C" fn onager_compute_degree(
     dst_ptr: *const i64,
     edge_count: usize,
     directed: bool,
-    out_nodes: *mut i64,
-    out_in_degree: *mut f64,
-    out_out_degree: *mut f64,
-) -> i64 {
+) -> *mut OnagerResult {
     clear_last_error();
-    crate::ffi_catch_unwind!(-1, {
+    crate::ffi_catch_unwind!(std::ptr::null_mut(), {
         if src_ptr.is_null() || dst_ptr.is_null() {
             set_last_error("Null pointer");
-            return -1;
+            return std::ptr::null_mut();
         }
         let src = unsafe { std::slice::from_raw_parts(src_ptr, edge_count) };
         let dst = unsafe { std::slice::from_raw_parts(dst_ptr, edge_count) };
-        match algorithms::compute_degree(src, dst, directed) {
-            Ok(result) => {
-                let n = result.node_ids.len();
-                if !out_nodes.is_null() && !out_in_degree.is_null() && !out_out_degree.is_null() {
-                    unsafe { std::slice::from_raw_parts_mut(out_nodes, n) }
-                        .copy_from_slice(&result.node_ids);
-                    unsafe { std::slice::from_raw_parts_mut(out_in_degree, n) }
-                        .copy_from_slice(&result.in_degrees);
-                    unsafe { std::slice::from_raw_parts_mut(out_out_degree, n) }
-                        .copy_from_slice(&result.out_degrees);
-                }
-                n as i64
-            }
-            Err(e) => {
-                set_last_error(&e.to_string());
-                -1
-            }
-        }
+        into_result_ptr(algorithms::compute_degree(src, dst, directed), |result| {
+            OnagerResult::new(
+                vec![result.node_ids],
+                vec![result.in_degrees, result.out_degrees],
+            )
+        })
     })
 }
 
@@ -186,75 +161,71 @@ pub extern "C" fn onager_compute_node_out_degree(
 }
 
 /// Compute betweenness centrality on edge arrays.
+/// A nonzero samples count uses that many random pivot sources chosen with seed,
+/// and `weights_ptr` may be null for an unweighted graph.
 #[no_mangle]
 pub extern "C" fn onager_compute_betweenness(
     src_ptr: *const i64,
     dst_ptr: *const i64,
     edge_count: usize,
+    weights_ptr: *const f64,
+    weights_count: usize,
     normalized: bool,
-    out_nodes: *mut i64,
-    out_centralities: *mut f64,
-) -> i64 {
+    samples: usize,
+    seed: u64,
+) -> *mut OnagerResult {
     clear_last_error();
-    crate::ffi_catch_unwind!(-1, {
+    crate::ffi_catch_unwind!(std::ptr::null_mut(), {
         if src_ptr.is_null() || dst_ptr.is_null() {
             set_last_error("Null pointer");
-            return -1;
+            return std::ptr::null_mut();
         }
         let src = unsafe { std::slice::from_raw_parts(src_ptr, edge_count) };
         let dst = unsafe { std::slice::from_raw_parts(dst_ptr, edge_count) };
-        match algorithms::compute_betweenness(src, dst, normalized) {
-            Ok(result) => {
-                let n = result.node_ids.len();
-                if !out_nodes.is_null() && !out_centralities.is_null() {
-                    unsafe { std::slice::from_raw_parts_mut(out_nodes, n) }
-                        .copy_from_slice(&result.node_ids);
-                    unsafe { std::slice::from_raw_parts_mut(out_centralities, n) }
-                        .copy_from_slice(&result.centralities);
-                }
-                n as i64
-            }
-            Err(e) => {
-                set_last_error(&e.to_string());
-                -1
-            }
-        }
+        let weights = if weights_ptr.is_null() || weights_count == 0 {
+            &[]
+        } else {
+            unsafe { std::slice::from_raw_parts(weights_ptr, weights_count) }
+        };
+        into_result_ptr(
+            if samples == 0 {
+                algorithms::compute_betweenness(src, dst, weights, normalized)
+            } else {
+                algorithms::compute_betweenness_sampled(
+                    src, dst, weights, normalized, samples, seed,
+                )
+            },
+            |result| OnagerResult::new(vec![result.node_ids], vec![result.centralities]),
+        )
     })
 }
 
 /// Compute closeness centrality.
+/// `weights_ptr` may be null for an unweighted graph.
 #[no_mangle]
 pub extern "C" fn onager_compute_closeness(
     src_ptr: *const i64,
     dst_ptr: *const i64,
     edge_count: usize,
-    out_nodes: *mut i64,
-    out_centralities: *mut f64,
-) -> i64 {
+    weights_ptr: *const f64,
+    weights_count: usize,
+) -> *mut OnagerResult {
     clear_last_error();
-    crate::ffi_catch_unwind!(-1, {
+    crate::ffi_catch_unwind!(std::ptr::null_mut(), {
         if src_ptr.is_null() || dst_ptr.is_null() {
             set_last_error("Null pointer");
-            return -1;
+            return std::ptr::null_mut();
         }
         let src = unsafe { std::slice::from_raw_parts(src_ptr, edge_count) };
         let dst = unsafe { std::slice::from_raw_parts(dst_ptr, edge_count) };
-        match algorithms::compute_closeness(src, dst) {
-            Ok(result) => {
-                let n = result.node_ids.len();
-                if !out_nodes.is_null() && !out_centralities.is_null() {
-                    unsafe { std::slice::from_raw_parts_mut(out_nodes, n) }
-                        .copy_from_slice(&result.node_ids);
-                    unsafe { std::slice::from_raw_parts_mut(out_centralities, n) }
-                        .copy_from_slice(&result.centralities);
-                }
-                n as i64
-            }
-            Err(e) => {
-                set_last_error(&e.to_string());
-                -1
-            }
-        }
+        let weights = if weights_ptr.is_null() || weights_count == 0 {
+            &[]
+        } else {
+            unsafe { std::slice::from_raw_parts(weights_ptr, weights_count) }
+        };
+        into_result_ptr(algorithms::compute_closeness(src, dst, weights), |result| {
+            OnagerResult::new(vec![result.node_ids], vec![result.centralities])
+        })
     })
 }
 
@@ -266,33 +237,19 @@ pub extern "C" fn onager_compute_eigenvector(
     edge_count: usize,
     max_iter: usize,
     tolerance: f64,
-    out_nodes: *mut i64,
-    out_centralities: *mut f64,
-) -> i64 {
+) -> *mut OnagerResult {
     clear_last_error();
-    crate::ffi_catch_unwind!(-1, {
+    crate::ffi_catch_unwind!(std::ptr::null_mut(), {
         if src_ptr.is_null() || dst_ptr.is_null() {
             set_last_error("Null pointer");
-            return -1;
+            return std::ptr::null_mut();
         }
         let src = unsafe { std::slice::from_raw_parts(src_ptr, edge_count) };
         let dst = unsafe { std::slice::from_raw_parts(dst_ptr, edge_count) };
-        match algorithms::compute_eigenvector(src, dst, max_iter, tolerance) {
-            Ok(result) => {
-                let n = result.node_ids.len();
-                if !out_nodes.is_null() && !out_centralities.is_null() {
-                    unsafe { std::slice::from_raw_parts_mut(out_nodes, n) }
-                        .copy_from_slice(&result.node_ids);
-                    unsafe { std::slice::from_raw_parts_mut(out_centralities, n) }
-                        .copy_from_slice(&result.centralities);
-                }
-                n as i64
-            }
-            Err(e) => {
-                set_last_error(&e.to_string());
-                -1
-            }
-        }
+        into_result_ptr(
+            algorithms::compute_eigenvector(src, dst, max_iter, tolerance),
+            |result| OnagerResult::new(vec![result.node_ids], vec![result.centralities]),
+        )
     })
 }
 
@@ -305,33 +262,19 @@ pub extern "C" fn onager_compute_katz(
     alpha: f64,
     max_iter: usize,
     tolerance: f64,
-    out_nodes: *mut i64,
-    out_centralities: *mut f64,
-) -> i64 {
+) -> *mut OnagerResult {
     clear_last_error();
-    crate::ffi_catch_unwind!(-1, {
+    crate::ffi_catch_unwind!(std::ptr::null_mut(), {
         if src_ptr.is_null() || dst_ptr.is_null() {
             set_last_error("Null pointer");
-            return -1;
+            return std::ptr::null_mut();
         }
         let src = unsafe { std::slice::from_raw_parts(src_ptr, edge_count) };
         let dst = unsafe { std::slice::from_raw_parts(dst_ptr, edge_count) };
-        match algorithms::compute_katz(src, dst, alpha, max_iter, tolerance) {
-            Ok(result) => {
-                let n = result.node_ids.len();
-                if !out_nodes.is_null() && !out_centralities.is_null() {
-                    unsafe { std::slice::from_raw_parts_mut(out_nodes, n) }
-                        .copy_from_slice(&result.node_ids);
-                    unsafe { std::slice::from_raw_parts_mut(out_centralities, n) }
-                        .copy_from_slice(&result.centralities);
-                }
-                n as i64
-            }
-            Err(e) => {
-                set_last_error(&e.to_string());
-                -1
-            }
-        }
+        into_result_ptr(
+            algorithms::compute_katz(src, dst, alpha, max_iter, tolerance),
+            |result| OnagerResult::new(vec![result.node_ids], vec![result.centralities]),
+        )
     })
 }
 
@@ -341,33 +284,18 @@ pub extern "C" fn onager_compute_harmonic(
     src_ptr: *const i64,
     dst_ptr: *const i64,
     edge_count: usize,
-    out_nodes: *mut i64,
-    out_centralities: *mut f64,
-) -> i64 {
+) -> *mut OnagerResult {
     clear_last_error();
-    crate::ffi_catch_unwind!(-1, {
+    crate::ffi_catch_unwind!(std::ptr::null_mut(), {
         if src_ptr.is_null() || dst_ptr.is_null() {
             set_last_error("Null pointer");
-            return -1;
+            return std::ptr::null_mut();
         }
         let src = unsafe { std::slice::from_raw_parts(src_ptr, edge_count) };
         let dst = unsafe { std::slice::from_raw_parts(dst_ptr, edge_count) };
-        match algorithms::compute_harmonic(src, dst) {
-            Ok(result) => {
-                let n = result.node_ids.len();
-                if !out_nodes.is_null() && !out_centralities.is_null() {
-                    unsafe { std::slice::from_raw_parts_mut(out_nodes, n) }
-                        .copy_from_slice(&result.node_ids);
-                    unsafe { std::slice::from_raw_parts_mut(out_centralities, n) }
-                        .copy_from_slice(&result.centralities);
-                }
-                n as i64
-            }
-            Err(e) => {
-                set_last_error(&e.to_string());
-                -1
-            }
-        }
+        into_result_ptr(algorithms::compute_harmonic(src, dst), |result| {
+            OnagerResult::new(vec![result.node_ids], vec![result.centralities])
+        })
     })
 }
 
@@ -378,30 +306,19 @@ pub extern "C" fn onager_compute_voterank(
     dst_ptr: *const i64,
     edge_count: usize,
     num_seeds: usize,
-    out_nodes: *mut i64,
-) -> i64 {
+) -> *mut OnagerResult {
     clear_last_error();
-    crate::ffi_catch_unwind!(-1, {
+    crate::ffi_catch_unwind!(std::ptr::null_mut(), {
         if src_ptr.is_null() || dst_ptr.is_null() {
             set_last_error("Null pointer");
-            return -1;
+            return std::ptr::null_mut();
         }
         let src = unsafe { std::slice::from_raw_parts(src_ptr, edge_count) };
         let dst = unsafe { std::slice::from_raw_parts(dst_ptr, edge_count) };
-        match algorithms::compute_voterank(src, dst, num_seeds) {
-            Ok(result) => {
-                let n = result.node_ids.len();
-                if !out_nodes.is_null() {
-                    unsafe { std::slice::from_raw_parts_mut(out_nodes, n) }
-                        .copy_from_slice(&result.node_ids);
-                }
-                n as i64
-            }
-            Err(e) => {
-                set_last_error(&e.to_string());
-                -1
-            }
-        }
+        into_result_ptr(
+            algorithms::compute_voterank(src, dst, num_seeds),
+            |result| OnagerResult::new(vec![result.node_ids], vec![]),
+        )
     })
 }
 
@@ -412,33 +329,19 @@ pub extern "C" fn onager_compute_local_reaching(
     dst_ptr: *const i64,
     edge_count: usize,
     distance: usize,
-    out_nodes: *mut i64,
-    out_centralities: *mut f64,
-) -> i64 {
+) -> *mut OnagerResult {
     clear_last_error();
-    crate::ffi_catch_unwind!(-1, {
+    crate::ffi_catch_unwind!(std::ptr::null_mut(), {
         if src_ptr.is_null() || dst_ptr.is_null() {
             set_last_error("Null pointer");
-            return -1;
+            return std::ptr::null_mut();
         }
         let src = unsafe { std::slice::from_raw_parts(src_ptr, edge_count) };
         let dst = unsafe { std::slice::from_raw_parts(dst_ptr, edge_count) };
-        match algorithms::compute_local_reaching(src, dst, distance) {
-            Ok(result) => {
-                let n = result.node_ids.len();
-                if !out_nodes.is_null() && !out_centralities.is_null() {
-                    unsafe { std::slice::from_raw_parts_mut(out_nodes, n) }
-                        .copy_from_slice(&result.node_ids);
-                    unsafe { std::slice::from_raw_parts_mut(out_centralities, n) }
-                        .copy_from_slice(&result.centrality);
-                }
-                n as i64
-            }
-            Err(e) => {
-                set_last_error(&e.to_string());
-                -1
-            }
-        }
+        into_result_ptr(
+            algorithms::compute_local_reaching(src, dst, distance),
+            |result| OnagerResult::new(vec![result.node_ids], vec![result.centrality]),
+        )
     })
 }
 
@@ -448,32 +351,17 @@ pub extern "C" fn onager_compute_laplacian(
     src_ptr: *const i64,
     dst_ptr: *const i64,
     edge_count: usize,
-    out_nodes: *mut i64,
-    out_centralities: *mut f64,
-) -> i64 {
+) -> *mut OnagerResult {
     clear_last_error();
-    crate::ffi_catch_unwind!(-1, {
+    crate::ffi_catch_unwind!(std::ptr::null_mut(), {
         if src_ptr.is_null() || dst_ptr.is_null() {
             set_last_error("Null pointer");
-            return -1;
+            return std::ptr::null_mut();
         }
         let src = unsafe { std::slice::from_raw_parts(src_ptr, edge_count) };
         let dst = unsafe { std::slice::from_raw_parts(dst_ptr, edge_count) };
-        match algorithms::compute_laplacian(src, dst) {
-            Ok(result) => {
-                let n = result.node_ids.len();
-                if !out_nodes.is_null() && !out_centralities.is_null() {
-                    unsafe { std::slice::from_raw_parts_mut(out_nodes, n) }
-                        .copy_from_slice(&result.node_ids);
-                    unsafe { std::slice::from_raw_parts_mut(out_centralities, n) }
-                        .copy_from_slice(&result.centrality);
-                }
-                n as i64
-            }
-            Err(e) => {
-                set_last_error(&e.to_string());
-                -1
-            }
-        }
+        into_result_ptr(algorithms::compute_laplacian(src, dst), |result| {
+            OnagerResult::new(vec![result.node_ids], vec![result.centrality])
+        })
     })
 }
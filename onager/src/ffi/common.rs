@@ -6,11 +6,16 @@ use std::cell::RefCell;
 use std::ffi::{CStr, CString};
 use std::os::raw::c_char;
 use std::panic;
+use std::path::Path;
 
+use crate::cache;
+use crate::control;
 use crate::graph;
+use crate::profile::{self, ProfileId};
 
 /// Wraps an FFI function body with catch_unwind to prevent panics from crossing FFI boundary.
-/// Returns the provided error_value if a panic occurs.
+/// Returns the provided error_value if a panic occurs, and closes the profile
+/// and removes the control installed for the call, if any.
 ///
 /// # Safety
 /// This function catches panics and converts them to error values, preventing undefined behavior
@@ -19,7 +24,10 @@ pub fn catch_unwind_ffi<F, T>(error_value: T, f: F) -> T
 where
     F: FnOnce() -> T + panic::UnwindSafe,
 {
-    match panic::catch_unwind(f) {
+    let outcome = panic::catch_unwind(f);
+    profile::finish();
+    control::finish();
+    match outcome {
         Ok(result) => result,
         Err(panic_info) => {
             // Try to extract a message from the panic
@@ -106,6 +114,298 @@ pub extern "C" fn onager_get_version() -> *mut c_char {
         .unwrap_or(std::ptr::null_mut())
 }
 
+/// Column-oriented algorithm result owned by Rust.
+///
+/// Algorithms run once and hand their output to C++ through an opaque pointer.
+/// C++ reads the row count and column pointers, then releases the result with
+/// `onager_free_result`.
+pub struct OnagerResult {
+    len: usize,
+    i64_columns: Vec<Vec<i64>>,
+    f64_columns: Vec<Vec<f64>>,
+    scalar: f64,
+    profile: Option<ProfileId>,
+}
+
+impl OnagerResult {
+    /// Creates a result from its integer and floating-point columns.
+    /// The row count is the length of the first column.
+    pub fn new(i64_columns: Vec<Vec<i64>>, f64_columns: Vec<Vec<f64>>) -> Self {
+        let len = i64_columns
+            .first()
+            .map(|c| c.len())
+            .or_else(|| f64_columns.first().map(|c| c.len()))
+            .unwrap_or(0);
+        Self {
+            len,
+            i64_columns,
+            f64_columns,
+            scalar: f64::NAN,
+            profile: profile::active(),
+        }
+    }
+
+    /// Attaches a scalar value (for example a total weight or tour cost) to the result.
+    pub fn with_scalar(mut self, scalar: f64) -> Self {
+        self.scalar = scalar;
+        self
+    }
+
+    /// Keeps only the rows whose value in integer column `column` is one of `ids`.
+    ///
+    /// `ids` must be sorted. A missing column leaves the result unchanged.
+    pub fn retain_rows(&mut self, column: usize, ids: &[i64]) {
+        let Some(key) = self.i64_columns.get(column) else {
+            return;
+        };
+        let keep: Vec<bool> = key.iter().map(|v| ids.binary_search(v).is_ok()).collect();
+        fn retain<T>(column: &mut Vec<T>, keep: &[bool]) {
+            let mut row = 0;
+            column.retain(|_| {
+                row += 1;
+                keep[row - 1]
+            });
+        }
+        for c in self.i64_columns.iter_mut() {
+            retain(c, &keep);
+        }
+        for c in self.f64_columns.iter_mut() {
+            retain(c, &keep);
+        }
+        self.len = keep.iter().filter(|&&k| k).count();
+    }
+
+    /// Moves the result to the heap and returns an owning pointer for C++.
+    pub fn into_raw(self) -> *mut OnagerResult {
+        Box::into_raw(Box::new(self))
+    }
+}
+
+/// Converts an algorithm result into an owning result pointer.
+/// Sets the last error and returns null if the algorithm failed, or if its
+/// query was interrupted, since parallel sections that saw the interruption
+/// may have skipped part of their work.
+pub fn into_result_ptr<T, F>(result: crate::error::Result<T>, convert: F) -> *mut OnagerResult
+where
+    F: FnOnce(T) -> OnagerResult,
+{
+    let result = result.and_then(|value| control::check().map(|()| value));
+    match result {
+        Ok(value) => convert(value).into_raw(),
+        Err(e) => {
+            set_last_error(&e.to_string());
+            std::ptr::null_mut()
+        }
+    }
+}
+
+/// Returns the number of rows in a result, or 0 for a null result.
+/// # Safety
+/// The pointer must be null or have been returned by an Onager compute function.
+#[no_mangle]
+pub unsafe extern "C" fn onager_result_len(result: *const OnagerResult) -> usize {
+    match unsafe { result.as_ref() } {
+        Some(r) => r.len,
+        None => 0,
+    }
+}
+
+/// Returns a pointer to an integer column of a result, or null if the column does not exist.
+/// The pointer stays valid until the result is freed.
+/// # Safety
+/// The pointer must be null or have been returned by an Onager compute function.
+#[no_mangle]
+pub unsafe extern "C" fn onager_result_i64_column(
+    result: *const OnagerResult,
+    column: usize,
+) -> *const i64 {
+    match unsafe { result.as_ref() }.and_then(|r| r.i64_columns.get(column)) {
+        Some(c) => c.as_ptr(),
+        None => std::ptr::null(),
+    }
+}
+
+/// Returns a pointer to a floating-point column of a result, or null if the column does not exist.
+/// The pointer stays valid until the result is freed.
+/// # Safety
+/// The pointer must be null or have been returned by an Onager compute function.
+#[no_mangle]
+pub unsafe extern "C" fn onager_result_f64_column(
+    result: *const OnagerResult,
+    column: usize,
+) -> *const f64 {
+    match unsafe { result.as_ref() }.and_then(|r| r.f64_columns.get(column)) {
+        Some(c) => c.as_ptr(),
+        None => std::ptr::null(),
+    }
+}
+
+/// Returns the scalar value attached to a result, or NaN if there is none.
+/// # Safety
+/// The pointer must be null or have been returned by an Onager compute function.
+#[no_mangle]
+pub unsafe extern "C" fn onager_result_scalar(result: *const OnagerResult) -> f64 {
+    match unsafe { result.as_ref() } {
+        Some(r) => r.scalar,
+        None => f64::NAN,
+    }
+}
+
+/// Keeps only the rows of a result whose value in integer column `column` is one of the given IDs.
+///
+/// Table functions use this to drop the rows that a pushed-down node filter
+/// would discard before they are copied into DuckDB vectors. Column pointers
+/// read before this call are no longer valid.
+/// # Safety
+/// The result pointer must be null or have been returned by an Onager compute function,
+/// and `ids_ptr` must point to `ids_count` IDs sorted in ascending order.
+#[no_mangle]
+pub unsafe extern "C" fn onager_result_retain_rows(
+    result: *mut OnagerResult,
+    column: usize,
+    ids_ptr: *const i64,
+    ids_count: usize,
+) {
+    let Some(r) = (unsafe { result.as_mut() }) else {
+        return;
+    };
+    let ids = if ids_ptr.is_null() || ids_count == 0 {
+        &[]
+    } else {
+        unsafe { std::slice::from_raw_parts(ids_ptr, ids_count) }
+    };
+    r.retain_rows(column, ids);
+}
+
+/// Names the function in the profile of the call that returned a result.
+/// # Safety
+/// The result pointer must be null or have been returned by an Onager compute function,
+/// and `function` must be null or a valid null-terminated C string.
+#[no_mangle]
+pub unsafe extern "C" fn onager_result_profile_function(
+    result: *const OnagerResult,
+    function: *const c_char,
+) {
+    let Some(id) = (unsafe { result.as_ref() }).and_then(|r| r.profile) else {
+        return;
+    };
+    if function.is_null() {
+        return;
+    }
+    if let Ok(name) = unsafe { CStr::from_ptr(function) }.to_str() {
+        profile::set_function(id, name);
+    }
+}
+
+/// Adds time spent emitting rows of a result to the profile of the call that returned it.
+/// # Safety
+/// The result pointer must be null or have been returned by an Onager compute function.
+#[no_mangle]
+pub unsafe extern "C" fn onager_result_note_output(
+    result: *const OnagerResult,
+    elapsed_ns: u64,
+    rows: u64,
+) {
+    if let Some(id) = (unsafe { result.as_ref() }).and_then(|r| r.profile) {
+        profile::note_output(id, elapsed_ns, rows);
+    }
+}
+
+/// Opens a profile for the next Onager call on this thread.
+///
+/// `connection` identifies the DuckDB connection the profile belongs to, and
+/// `ingest_ns` is the time spent collecting the call's input.
+#[no_mangle]
+pub extern "C" fn onager_profile_begin(connection: u64, ingest_ns: u64) {
+    profile::begin(connection, ingest_ns);
+}
+
+/// Installs the cancellation and progress callbacks of the next Onager call on this thread.
+///
+/// The callbacks must stay valid until that call returns, and may be called
+/// from worker threads while it runs.
+#[no_mangle]
+pub extern "C" fn onager_call_begin(callbacks: control::OnagerCallControl) {
+    control::begin(callbacks);
+}
+
+/// Returns whether the last Onager call on this thread stopped because its query was interrupted.
+#[no_mangle]
+pub extern "C" fn onager_last_call_interrupted() -> bool {
+    control::last_call_interrupted()
+}
+
+/// Copies the last profile of a connection into `out`.
+///
+/// Returns false, leaving `out` untouched, if the connection has no profile.
+/// # Safety
+/// `out` must be null or point to a writable OnagerProfile.
+#[no_mangle]
+pub unsafe extern "C" fn onager_last_profile(
+    connection: u64,
+    out: *mut profile::OnagerProfile,
+) -> bool {
+    let Some(out) = (unsafe { out.as_mut() }) else {
+        return false;
+    };
+    match profile::last(connection) {
+        Some((_, p)) => {
+            *out = p;
+            true
+        }
+        None => false,
+    }
+}
+
+/// Returns the function name of the last profile of a connection, or null if there is none.
+/// The caller must free the string with onager_free.
+#[no_mangle]
+pub extern "C" fn onager_last_profile_function(connection: u64) -> *mut c_char {
+    profile::last(connection)
+        .and_then(|(function, _)| CString::new(function).ok())
+        .map(|s| s.into_raw())
+        .unwrap_or(std::ptr::null_mut())
+}
+
+/// Forgets the last profile of a connection, for when the connection closes.
+#[no_mangle]
+pub extern "C" fn onager_forget_profile(connection: u64) {
+    profile::forget(connection);
+}
+
+/// Sets the most bytes of built graphs the graph build cache keeps. Zero turns the cache off.
+#[no_mangle]
+pub extern "C" fn onager_graph_cache_set_size(size: u64) {
+    cache::set_capacity(usize::try_from(size).unwrap_or(usize::MAX));
+}
+
+/// Copies the graph build cache's counters and size into `out`.
+///
+/// Returns false if `out` is null.
+/// # Safety
+/// `out` must be null or point to a writable GraphCacheStats.
+#[no_mangle]
+pub unsafe extern "C" fn onager_graph_cache_stats(out: *mut cache::GraphCacheStats) -> bool {
+    let Some(out) = (unsafe { out.as_mut() }) else {
+        return false;
+    };
+    *out = cache::stats();
+    true
+}
+
+/// Frees a result returned by an Onager compute function.
+/// # Safety
+/// The pointer must be null or have been returned by an Onager compute function,
+/// and must not be used after this call.
+#[no_mangle]
+pub unsafe extern "C" fn onager_free_result(result: *mut OnagerResult) {
+    if !result.is_null() {
+        unsafe {
+            drop(Box::from_raw(result));
+        }
+    }
+}
+
 /// Creates a new graph with the given name.
 /// # Safety
 /// The name pointer must be a valid null-terminated C string.
@@ -154,6 +454,62 @@ pub unsafe extern "C" fn onager_drop_graph(name: *const c_char) -> i32 {
     })
 }
 
+/// Converts a graph name and a file path from C strings, setting the last error if either is invalid.
+unsafe fn name_and_path<'a>(
+    name: *const c_char,
+    path: *const c_char,
+) -> Option<(&'a str, &'a Path)> {
+    let Ok(name) = unsafe { CStr::from_ptr(name) }.to_str() else {
+        set_last_error("Invalid UTF-8 in graph name");
+        return None;
+    };
+    let Ok(path) = unsafe { CStr::from_ptr(path) }.to_str() else {
+        set_last_error("Invalid UTF-8 in file path");
+        return None;
+    };
+    Some((name, Path::new(path)))
+}
+
+/// Writes a graph to a snapshot file at the given path.
+/// # Safety
+/// The name and path pointers must be valid null-terminated C strings.
+#[no_mangle]
+pub unsafe extern "C" fn onager_save_graph(name: *const c_char, path: *const c_char) -> i32 {
+    clear_last_error();
+    crate::ffi_catch_unwind!(-1, {
+        let Some((name, path)) = (unsafe { name_and_path(name, path) }) else {
+            return -1;
+        };
+        match graph::save_graph(name, path) {
+            Ok(()) => 0,
+            Err(e) => {
+                set_last_error(&e.to_string());
+                -1
+            }
+        }
+    })
+}
+
+/// Creates a graph with the given name from a snapshot file.
+/// # Safety
+/// The name and path pointers must be valid null-terminated C strings.
+#[no_mangle]
+pub unsafe extern "C" fn onager_open_graph(name: *const c_char, path: *const c_char) -> i32 {
+    clear_last_error();
+    crate::ffi_catch_unwind!(-1, {
+        let Some((name, path)) = (unsafe { name_and_path(name, path) }) else {
+            return -1;
+        };
+        match graph::open_graph(name, path) {
+            Ok(()) => 0,
+            Err(e) => {
+                set_last_error(&e.to_string());
+                -1
+            }
+        }
+    })
+}
+
 /// Returns a JSON array of all graph names.
 #[no_mangle]
 pub extern "C" fn onager_list_graphs() -> *mut c_char {
@@ -226,6 +582,124 @@ pub unsafe extern "C" fn onager_add_edge(
     })
 }
 
+/// Loads edge arrays into the specified graph in one batch, creating it if needed.
+///
+/// `directed` is 1 for directed, 0 for undirected, and negative to keep the
+/// direction of an existing graph or create a directed one. The result has one
+/// row with the number of nodes and edges added.
+/// # Safety
+/// The graph_name pointer must be a valid null-terminated C string. Unless
+/// edge_count is 0, src_ptr and dst_ptr must point to edge_count values, and
+/// weights_ptr must be null or point to edge_count values.
+#[no_mangle]
+pub unsafe extern "C" fn onager_load_graph(
+    graph_name: *const c_char,
+    src_ptr: *const i64,
+    dst_ptr: *const i64,
+    weights_ptr: *const f64,
+    edge_count: usize,
+    directed: i32,
+) -> *mut OnagerResult {
+    clear_last_error();
+    crate::ffi_catch_unwind!(std::ptr::null_mut(), {
+        if graph_name.is_null() || (edge_count > 0 && (src_ptr.is_null() || dst_ptr.is_null())) {
+            set_last_error("Null pointer");
+            return std::ptr::null_mut();
+        }
+        let name = match unsafe { CStr::from_ptr(graph_name) }.to_str() {
+            Ok(s) => s,
+            Err(_) => {
+                set_last_error("Invalid UTF-8 in graph name");
+                return std::ptr::null_mut();
+            }
+        };
+        let (src, dst) = if edge_count == 0 {
+            (&[][..], &[][..])
+        } else {
+            unsafe {
+                (
+                    std::slice::from_raw_parts(src_ptr, edge_count),
+                    std::slice::from_raw_parts(dst_ptr, edge_count),
+                )
+            }
+        };
+        let weights = if weights_ptr.is_null() || edge_count == 0 {
+            None
+        } else {
+            Some(unsafe { std::slice::from_raw_parts(weights_ptr, edge_count) })
+        };
+        let directed = if directed < 0 {
+            None
+        } else {
+            Some(directed != 0)
+        };
+        into_result_ptr(
+            graph::load_edges(name, src, dst, weights, directed),
+            |(nodes, edges)| {
+                OnagerResult::new(vec![vec![nodes as i64], vec![edges as i64]], vec![])
+            },
+        )
+    })
+}
+
+/// Applies a batch of edge inserts and deletes to the specified graph, in order.
+///
+/// Each entry of `ops_ptr` is 1 to insert the edge and -1 to delete every edge
+/// between its endpoints. The result has one row with the number of edges
+/// inserted and deleted.
+/// # Safety
+/// The graph_name pointer must be a valid null-terminated C string. Unless
+/// edge_count is 0, ops_ptr, src_ptr, and dst_ptr must point to edge_count
+/// values, and weights_ptr must be null or point to edge_count values.
+#[no_mangle]
+pub unsafe extern "C" fn onager_apply_delta(
+    graph_name: *const c_char,
+    ops_ptr: *const i64,
+    src_ptr: *const i64,
+    dst_ptr: *const i64,
+    weights_ptr: *const f64,
+    edge_count: usize,
+) -> *mut OnagerResult {
+    clear_last_error();
+    crate::ffi_catch_unwind!(std::ptr::null_mut(), {
+        if graph_name.is_null()
+            || (edge_count > 0 && (ops_ptr.is_null() || src_ptr.is_null() || dst_ptr.is_null()))
+        {
+            set_last_error("Null pointer");
+            return std::ptr::null_mut();
+        }
+        let name = match unsafe { CStr::from_ptr(graph_name) }.to_str() {
+            Ok(s) => s,
+            Err(_) => {
+                set_last_error("Invalid UTF-8 in graph name");
+                return std::ptr::null_mut();
+            }
+        };
+        let (ops, src, dst) = if edge_count == 0 {
+            (&[][..], &[][..], &[][..])
+        } else {
+            unsafe {
+                (
+                    std::slice::from_raw_parts(ops_ptr, edge_count),
+                    std::slice::from_raw_parts(src_ptr, edge_count),
+                    std::slice::from_raw_parts(dst_ptr, edge_count),
+                )
+            }
+        };
+        let weights = if weights_ptr.is_null() || edge_count == 0 {
+            None
+        } else {
+            Some(unsafe { std::slice::from_raw_parts(weights_ptr, edge_count) })
+        };
+        into_result_ptr(
+            graph::apply_delta(name, ops, src, dst, weights),
+            |(inserted, deleted)| {
+                OnagerResult::new(vec![vec![inserted as i64], vec![deleted as i64]], vec![])
+            },
+        )
+    })
+}
+
 /// Returns the number of nodes in the graph.
 /// # Safety
 /// The graph_name pointer must be a valid null-terminated C string.
@@ -321,3 +795,51 @@ pub unsafe extern "C" fn onager_graph_node_out_degree(graph_name: *const c_char,
         }
     })
 }
+
+/// Writes the in-degree (`inbound`) or out-degree of each node to `out_ptr`.
+///
+/// Nodes that are not in the graph get -1. Returns 0 on success and -1 if the
+/// graph does not exist or the arguments are invalid.
+/// # Safety
+/// The graph_name pointer must be a valid null-terminated C string, and unless
+/// count is 0, nodes_ptr and out_ptr must each point to count values.
+#[no_mangle]
+pub unsafe extern "C" fn onager_graph_node_degrees(
+    graph_name: *const c_char,
+    nodes_ptr: *const i64,
+    count: usize,
+    inbound: bool,
+    out_ptr: *mut i64,
+) -> i32 {
+    clear_last_error();
+    crate::ffi_catch_unwind!(-1, {
+        if graph_name.is_null() || (count > 0 && (nodes_ptr.is_null() || out_ptr.is_null())) {
+            set_last_error("Null pointer");
+            return -1;
+        }
+        let name = match unsafe { CStr::from_ptr(graph_name) }.to_str() {
+            Ok(s) => s,
+            Err(_) => {
+                set_last_error("Invalid UTF-8 in graph name");
+                return -1;
+            }
+        };
+        let (nodes, out): (&[i64], &mut [i64]) = if count == 0 {
+            (&[], &mut [])
+        } else {
+            unsafe {
+                (
+                    std::slice::from_raw_parts(nodes_ptr, count),
+                    std::slice::from_raw_parts_mut(out_ptr, count),
+                )
+            }
+        };
+        match graph::get_node_degrees(name, nodes, inbound, out) {
+            Ok(()) => 0,
+            Err(e) => {
+                set_last_error(&e.to_string());
+                -1
+            }
+        }
+    })
+}
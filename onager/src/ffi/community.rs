@@ -1,46 +1,40 @@
 //! Community detection FFI exports.
 //!
-//! Louvain, Connected Components, Label Propagation, Girvan-Newman.
+//! Louvain, Connected Components, Label Propagation, Girvan-Newman, K-Core.
 #![allow(clippy::not_unsafe_ptr_arg_deref)]
 
-use super::common::{clear_last_error, set_last_error};
+use super::common::{clear_last_error, into_result_ptr, set_last_error, OnagerResult};
 use crate::algorithms;
 
 /// Compute Louvain community detection.
+/// `weights_ptr` may be null for an unweighted graph.
 #[no_mangle]
 pub extern "C" fn onager_compute_louvain(
     src_ptr: *const i64,
     dst_ptr: *const i64,
     edge_count: usize,
+    weights_ptr: *const f64,
+    weights_count: usize,
     seed: i64,
-    out_nodes: *mut i64,
-    out_communities: *mut i64,
-) -> i64 {
+) -> *mut OnagerResult {
     clear_last_error();
-    crate::ffi_catch_unwind!(-1, {
+    crate::ffi_catch_unwind!(std::ptr::null_mut(), {
         if src_ptr.is_null() || dst_ptr.is_null() {
             set_last_error("Null pointer");
-            return -1;
+            return std::ptr::null_mut();
         }
         let src = unsafe { std::slice::from_raw_parts(src_ptr, edge_count) };
         let dst = unsafe { std::slice::from_raw_parts(dst_ptr, edge_count) };
+        let weights = if weights_ptr.is_null() || weights_count == 0 {
+            &[]
+        } else {
+            unsafe { std::slice::from_raw_parts(weights_ptr, weights_count) }
+        };
         let seed_opt = if seed < 0 { None } else { Some(seed as u64) };
-        match algorithms::compute_louvain(src, dst, seed_opt) {
-            Ok(result) => {
-                let n = result.node_ids.len();
-                if !out_nodes.is_null() && !out_communities.is_null() {
-                    unsafe { std::slice::from_raw_parts_mut(out_nodes, n) }
-                        .copy_from_slice(&result.node_ids);
-                    unsafe { std::slice::from_raw_parts_mut(out_communities, n) }
-                        .copy_from_slice(&result.community_ids);
-                }
-                n as i64
-            }
-            Err(e) => {
-                set_last_error(&e.to_string());
-                -1
-            }
-        }
+        into_result_ptr(
+            algorithms::compute_louvain(src, dst, weights, seed_opt),
+            |result| OnagerResult::new(vec![result.node_ids, result.community_ids], vec![]),
+        )
     })
 }
 
@@ -50,33 +44,19 @@ pub extern "C" fn onager_compute_connected_components(
     src_ptr: *const i64,
     dst_ptr: *const i64,
     edge_count: usize,
-    out_nodes: *mut i64,
-    out_components: *mut i64,
-) -> i64 {
+) -> *mut OnagerResult {
     clear_last_error();
-    crate::ffi_catch_unwind!(-1, {
+    crate::ffi_catch_unwind!(std::ptr::null_mut(), {
         if src_ptr.is_null() || dst_ptr.is_null() {
             set_last_error("Null pointer");
-            return -1;
+            return std::ptr::null_mut();
         }
         let src = unsafe { std::slice::from_raw_parts(src_ptr, edge_count) };
         let dst = unsafe { std::slice::from_raw_parts(dst_ptr, edge_count) };
-        match algorithms::compute_connected_components(src, dst) {
-            Ok(result) => {
-                let n = result.node_ids.len();
-                if !out_nodes.is_null() && !out_components.is_null() {
-                    unsafe { std::slice::from_raw_parts_mut(out_nodes, n) }
-                        .copy_from_slice(&result.node_ids);
-                    unsafe { std::slice::from_raw_parts_mut(out_components, n) }
-                        .copy_from_slice(&result.component_ids);
-                }
-                n as i64
-            }
-            Err(e) => {
-                set_last_error(&e.to_string());
-                -1
-            }
-        }
+        into_result_ptr(
+            algorithms::compute_connected_components(src, dst),
+            |result| OnagerResult::new(vec![result.node_ids, result.component_ids], vec![]),
+        )
     })
 }
 
@@ -86,33 +66,18 @@ pub extern "C" fn onager_compute_label_propagation(
     src_ptr: *const i64,
     dst_ptr: *const i64,
     edge_count: usize,
-    out_node_ids: *mut i64,
-    out_labels: *mut i64,
-) -> i64 {
+) -> *mut OnagerResult {
     clear_last_error();
-    crate::ffi_catch_unwind!(-1, {
+    crate::ffi_catch_unwind!(std::ptr::null_mut(), {
         if src_ptr.is_null() || dst_ptr.is_null() {
             set_last_error("Null pointer");
-            return -1;
+            return std::ptr::null_mut();
         }
         let src = unsafe { std::slice::from_raw_parts(src_ptr, edge_count) };
         let dst = unsafe { std::slice::from_raw_parts(dst_ptr, edge_count) };
-        match algorithms::compute_label_propagation(src, dst) {
-            Ok(result) => {
-                let n = result.node_ids.len();
-                if !out_node_ids.is_null() && !out_labels.is_null() {
-                    unsafe { std::slice::from_raw_parts_mut(out_node_ids, n) }
-                        .copy_from_slice(&result.node_ids);
-                    unsafe { std::slice::from_raw_parts_mut(out_labels, n) }
-                        .copy_from_slice(&result.labels);
-                }
-                n as i64
-            }
-            Err(e) => {
-                set_last_error(&e.to_string());
-                -1
-            }
-        }
+        into_result_ptr(algorithms::compute_label_propagation(src, dst), |result| {
+            OnagerResult::new(vec![result.node_ids, result.labels], vec![])
+        })
     })
 }
 
@@ -123,33 +88,19 @@ pub extern "C" fn onager_compute_girvan_newman(
     dst_ptr: *const i64,
     edge_count: usize,
     target_communities: i64,
-    out_nodes: *mut i64,
-    out_communities: *mut i64,
-) -> i64 {
+) -> *mut OnagerResult {
     clear_last_error();
-    crate::ffi_catch_unwind!(-1, {
+    crate::ffi_catch_unwind!(std::ptr::null_mut(), {
         if src_ptr.is_null() || dst_ptr.is_null() {
             set_last_error("Null pointer");
-            return -1;
+            return std::ptr::null_mut();
         }
         let src = unsafe { std::slice::from_raw_parts(src_ptr, edge_count) };
         let dst = unsafe { std::slice::from_raw_parts(dst_ptr, edge_count) };
-        match algorithms::compute_girvan_newman(src, dst, target_communities) {
-            Ok(result) => {
-                let n = result.node_ids.len();
-                if !out_nodes.is_null() && !out_communities.is_null() {
-                    unsafe { std::slice::from_raw_parts_mut(out_nodes, n) }
-                        .copy_from_slice(&result.node_ids);
-                    unsafe { std::slice::from_raw_parts_mut(out_communities, n) }
-                        .copy_from_slice(&result.community_ids);
-                }
-                n as i64
-            }
-            Err(e) => {
-                set_last_error(&e.to_string());
-                -1
-            }
-        }
+        into_result_ptr(
+            algorithms::compute_girvan_newman(src, dst, target_communities),
+            |result| OnagerResult::new(vec![result.node_ids, result.community_ids], vec![]),
+        )
     })
 }
 
@@ -161,34 +112,20 @@ pub extern "C" fn onager_compute_spectral_clustering(
     edge_count: usize,
     k: usize,
     seed: i64,
-    out_nodes: *mut i64,
-    out_communities: *mut i64,
-) -> i64 {
+) -> *mut OnagerResult {
     clear_last_error();
-    crate::ffi_catch_unwind!(-1, {
+    crate::ffi_catch_unwind!(std::ptr::null_mut(), {
         if src_ptr.is_null() || dst_ptr.is_null() {
             set_last_error("Null pointer");
-            return -1;
+            return std::ptr::null_mut();
         }
         let src = unsafe { std::slice::from_raw_parts(src_ptr, edge_count) };
         let dst = unsafe { std::slice::from_raw_parts(dst_ptr, edge_count) };
         let seed_opt = if seed < 0 { None } else { Some(seed as u64) };
-        match algorithms::compute_spectral_clustering(src, dst, k, seed_opt) {
-            Ok(result) => {
-                let n = result.node_ids.len();
-                if !out_nodes.is_null() && !out_communities.is_null() {
-                    unsafe { std::slice::from_raw_parts_mut(out_nodes, n) }
-                        .copy_from_slice(&result.node_ids);
-                    unsafe { std::slice::from_raw_parts_mut(out_communities, n) }
-                        .copy_from_slice(&result.community_ids);
-                }
-                n as i64
-            }
-            Err(e) => {
-                set_last_error(&e.to_string());
-                -1
-            }
-        }
+        into_result_ptr(
+            algorithms::compute_spectral_clustering(src, dst, k, seed_opt),
+            |result| OnagerResult::new(vec![result.node_ids, result.community_ids], vec![]),
+        )
     })
 }
 
@@ -200,33 +137,62 @@ pub extern "C" fn onager_compute_infomap(
     edge_count: usize,
     max_iter: usize,
     seed: i64,
-    out_nodes: *mut i64,
-    out_communities: *mut i64,
-) -> i64 {
+) -> *mut OnagerResult {
     clear_last_error();
-    crate::ffi_catch_unwind!(-1, {
+    crate::ffi_catch_unwind!(std::ptr::null_mut(), {
         if src_ptr.is_null() || dst_ptr.is_null() {
             set_last_error("Null pointer");
-            return -1;
+            return std::ptr::null_mut();
         }
         let src = unsafe { std::slice::from_raw_parts(src_ptr, edge_count) };
         let dst = unsafe { std::slice::from_raw_parts(dst_ptr, edge_count) };
         let seed_opt = if seed < 0 { None } else { Some(seed as u64) };
-        match algorithms::compute_infomap(src, dst, max_iter, seed_opt) {
-            Ok(result) => {
-                let n = result.node_ids.len();
-                if !out_nodes.is_null() && !out_communities.is_null() {
-                    unsafe { std::slice::from_raw_parts_mut(out_nodes, n) }
-                        .copy_from_slice(&result.node_ids);
-                    unsafe { std::slice::from_raw_parts_mut(out_communities, n) }
-                        .copy_from_slice(&result.community_ids);
-                }
-                n as i64
-            }
-            Err(e) => {
-                set_last_error(&e.to_string());
-                -1
-            }
+        into_result_ptr(
+            algorithms::compute_infomap(src, dst, max_iter, seed_opt),
+            |result| OnagerResult::new(vec![result.node_ids, result.community_ids], vec![]),
+        )
+    })
+}
+
+/// Compute the core number of every node.
+#[no_mangle]
+pub extern "C" fn onager_compute_kcore(
+    src_ptr: *const i64,
+    dst_ptr: *const i64,
+    edge_count: usize,
+) -> *mut OnagerResult {
+    clear_last_error();
+    crate::ffi_catch_unwind!(std::ptr::null_mut(), {
+        if src_ptr.is_null() || dst_ptr.is_null() {
+            set_last_error("Null pointer");
+            return std::ptr::null_mut();
         }
+        let src = unsafe { std::slice::from_raw_parts(src_ptr, edge_count) };
+        let dst = unsafe { std::slice::from_raw_parts(dst_ptr, edge_count) };
+        into_result_ptr(algorithms::compute_kcore(src, dst), |result| {
+            OnagerResult::new(vec![result.node_ids, result.core_numbers], vec![])
+        })
+    })
+}
+
+/// Extract the edges of the k-core.
+#[no_mangle]
+pub extern "C" fn onager_compute_kcore_edges(
+    src_ptr: *const i64,
+    dst_ptr: *const i64,
+    edge_count: usize,
+    k: i64,
+) -> *mut OnagerResult {
+    clear_last_error();
+    crate::ffi_catch_unwind!(std::ptr::null_mut(), {
+        if src_ptr.is_null() || dst_ptr.is_null() {
+            set_last_error("Null pointer");
+            return std::ptr::null_mut();
+        }
+        let src = unsafe { std::slice::from_raw_parts(src_ptr, edge_count) };
+        let dst = unsafe { std::slice::from_raw_parts(dst_ptr, edge_count) };
+        into_result_ptr(algorithms::compute_kcore_edges(src, dst, k), |result| {
+            OnagerResult::new(vec![result.src, result.dst], vec![])
+        })
     })
 }
@@ -4,95 +4,133 @@
 #![allow(clippy::not_unsafe_ptr_arg_deref)]
 
 use super::common::{clear_last_error, set_last_error};
-use crate::algorithms;
+use crate::algorithms::{EdgeCursor, EdgeGenerator};
+use crate::error::Result;
 
-/// Generate Erdős-Rényi random graph.
+/// Streaming edge generator owned by Rust.
+///
+/// C++ opens one cursor per partition, pulls edges in chunks with
+/// `onager_edge_cursor_next`, and releases both with their free functions.
+pub struct OnagerEdgeGenerator(EdgeGenerator);
+
+/// Resumable cursor over the edges of one generator partition.
+pub struct OnagerEdgeCursor(EdgeCursor);
+
+fn into_generator_ptr(generator: Result<EdgeGenerator>) -> *mut OnagerEdgeGenerator {
+    match generator {
+        Ok(generator) => Box::into_raw(Box::new(OnagerEdgeGenerator(generator))),
+        Err(e) => {
+            set_last_error(&e.to_string());
+            std::ptr::null_mut()
+        }
+    }
+}
+
+/// Open a streaming Erdős-Rényi generator.
 #[no_mangle]
-pub extern "C" fn onager_generate_erdos_renyi(
+pub extern "C" fn onager_edge_generator_erdos_renyi(
     n: usize,
     p: f64,
     seed: u64,
-    out_src: *mut i64,
-    out_dst: *mut i64,
-) -> i64 {
+) -> *mut OnagerEdgeGenerator {
     clear_last_error();
-    crate::ffi_catch_unwind!(-1, {
-        match algorithms::generate_erdos_renyi(n, p, seed) {
-            Ok(result) => {
-                let edge_count = result.src.len();
-                if !out_src.is_null() && !out_dst.is_null() {
-                    unsafe { std::slice::from_raw_parts_mut(out_src, edge_count) }
-                        .copy_from_slice(&result.src);
-                    unsafe { std::slice::from_raw_parts_mut(out_dst, edge_count) }
-                        .copy_from_slice(&result.dst);
-                }
-                edge_count as i64
-            }
-            Err(e) => {
-                set_last_error(&e.to_string());
-                -1
-            }
-        }
+    crate::ffi_catch_unwind!(std::ptr::null_mut(), {
+        into_generator_ptr(EdgeGenerator::erdos_renyi(n, p, seed))
     })
 }
 
-/// Generate Barabási-Albert graph.
+/// Open a streaming Barabási-Albert generator.
 #[no_mangle]
-pub extern "C" fn onager_generate_barabasi_albert(
+pub extern "C" fn onager_edge_generator_barabasi_albert(
     n: usize,
     m: usize,
     seed: u64,
-    out_src: *mut i64,
-    out_dst: *mut i64,
-) -> i64 {
+) -> *mut OnagerEdgeGenerator {
     clear_last_error();
-    crate::ffi_catch_unwind!(-1, {
-        match algorithms::generate_barabasi_albert(n, m, seed) {
-            Ok(result) => {
-                let edge_count = result.src.len();
-                if !out_src.is_null() && !out_dst.is_null() {
-                    unsafe { std::slice::from_raw_parts_mut(out_src, edge_count) }
-                        .copy_from_slice(&result.src);
-                    unsafe { std::slice::from_raw_parts_mut(out_dst, edge_count) }
-                        .copy_from_slice(&result.dst);
-                }
-                edge_count as i64
-            }
-            Err(e) => {
-                set_last_error(&e.to_string());
-                -1
-            }
-        }
+    crate::ffi_catch_unwind!(std::ptr::null_mut(), {
+        into_generator_ptr(EdgeGenerator::barabasi_albert(n, m, seed))
     })
 }
 
-/// Generate Watts-Strogatz graph.
+/// Open a streaming Watts-Strogatz generator.
 #[no_mangle]
-pub extern "C" fn onager_generate_watts_strogatz(
+pub extern "C" fn onager_edge_generator_watts_strogatz(
     n: usize,
     k: usize,
     beta: f64,
     seed: u64,
-    out_src: *mut i64,
-    out_dst: *mut i64,
-) -> i64 {
+) -> *mut OnagerEdgeGenerator {
     clear_last_error();
-    crate::ffi_catch_unwind!(-1, {
-        match algorithms::generate_watts_strogatz(n, k, beta, seed) {
-            Ok(result) => {
-                let edge_count = result.src.len();
-                if !out_src.is_null() && !out_dst.is_null() {
-                    unsafe { std::slice::from_raw_parts_mut(out_src, edge_count) }
-                        .copy_from_slice(&result.src);
-                    unsafe { std::slice::from_raw_parts_mut(out_dst, edge_count) }
-                        .copy_from_slice(&result.dst);
-                }
-                edge_count as i64
-            }
-            Err(e) => {
-                set_last_error(&e.to_string());
-                -1
-            }
-        }
+    crate::ffi_catch_unwind!(std::ptr::null_mut(), {
+        into_generator_ptr(EdgeGenerator::watts_strogatz(n, k, beta, seed))
+    })
+}
+
+/// Get the number of partitions of a generator.
+#[no_mangle]
+pub extern "C" fn onager_edge_generator_partitions(generator: *const OnagerEdgeGenerator) -> usize {
+    if generator.is_null() {
+        return 0;
+    }
+    unsafe { (*generator).0.partition_count() }
+}
+
+/// Open the cursor for one partition of a generator.
+#[no_mangle]
+pub extern "C" fn onager_edge_generator_cursor(
+    generator: *const OnagerEdgeGenerator,
+    partition: usize,
+) -> *mut OnagerEdgeCursor {
+    clear_last_error();
+    if generator.is_null() {
+        set_last_error("Null pointer for generator");
+        return std::ptr::null_mut();
+    }
+    crate::ffi_catch_unwind!(std::ptr::null_mut(), {
+        let cursor = unsafe { (*generator).0.cursor(partition) };
+        Box::into_raw(Box::new(OnagerEdgeCursor(cursor)))
     })
 }
+
+/// Write up to capacity edges from a cursor into the output arrays.
+/// Returns the number of edges written; fewer than capacity means the cursor is exhausted.
+#[no_mangle]
+pub extern "C" fn onager_edge_cursor_next(
+    cursor: *mut OnagerEdgeCursor,
+    src_out: *mut i64,
+    dst_out: *mut i64,
+    capacity: usize,
+) -> usize {
+    if cursor.is_null() || src_out.is_null() || dst_out.is_null() || capacity == 0 {
+        return 0;
+    }
+    crate::ffi_catch_unwind!(0, {
+        let src = unsafe { std::slice::from_raw_parts_mut(src_out, capacity) };
+        let dst = unsafe { std::slice::from_raw_parts_mut(dst_out, capacity) };
+        unsafe { (*cursor).0.next_batch(src, dst) }
+    })
+}
+
+/// Free an edge generator.
+/// # Safety
+/// The pointer must be null or returned by an `onager_edge_generator_*` function.
+#[no_mangle]
+pub unsafe extern "C" fn onager_free_edge_generator(generator: *mut OnagerEdgeGenerator) {
+    if !generator.is_null() {
+        unsafe {
+            drop(Box::from_raw(generator));
+        }
+    }
+}
+
+/// Free an edge cursor.
+/// # Safety
+/// The pointer must be null or returned by `onager_edge_generator_cursor`.
+#[no_mangle]
+pub unsafe extern "C" fn onager_free_edge_cursor(cursor: *mut OnagerEdgeCursor) {
+    if !cursor.is_null() {
+        unsafe {
+            drop(Box::from_raw(cursor));
+        }
+    }
+}
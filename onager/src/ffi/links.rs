@@ -3,200 +3,111 @@
 //! Jaccard, Adamic-Adar, Preferential Attachment, Resource Allocation.
 #![allow(clippy::not_unsafe_ptr_arg_deref)]
 
-use super::common::{clear_last_error, set_last_error};
+use super::common::{clear_last_error, into_result_ptr, set_last_error, OnagerResult};
 use crate::algorithms;
 
-/// Compute Jaccard coefficient.
-#[no_mangle]
-pub extern "C" fn onager_compute_jaccard(
-    src_ptr: *const i64,
-    dst_ptr: *const i64,
-    edge_count: usize,
-    out_node1: *mut i64,
-    out_node2: *mut i64,
-    out_coefficients: *mut f64,
-) -> i64 {
-    clear_last_error();
-    crate::ffi_catch_unwind!(-1, {
-        if src_ptr.is_null() || dst_ptr.is_null() {
-            set_last_error("Null pointer");
-            return -1;
-        }
-        let src = unsafe { std::slice::from_raw_parts(src_ptr, edge_count) };
-        let dst = unsafe { std::slice::from_raw_parts(dst_ptr, edge_count) };
-        match algorithms::compute_jaccard(src, dst) {
-            Ok(result) => {
-                let n = result.node1.len();
-                if !out_node1.is_null() && !out_node2.is_null() && !out_coefficients.is_null() {
-                    unsafe { std::slice::from_raw_parts_mut(out_node1, n) }
-                        .copy_from_slice(&result.node1);
-                    unsafe { std::slice::from_raw_parts_mut(out_node2, n) }
-                        .copy_from_slice(&result.node2);
-                    unsafe { std::slice::from_raw_parts_mut(out_coefficients, n) }
-                        .copy_from_slice(&result.scores);
-                }
-                n as i64
-            }
-            Err(e) => {
-                set_last_error(&e.to_string());
-                -1
-            }
-        }
-    })
+/// Node IDs that query filters allow in one output column of a link score.
+///
+/// An inactive filter allows every node, and `ids` may then be null. An active
+/// filter with no IDs allows none.
+#[repr(C)]
+#[derive(Clone, Copy)]
+pub struct OnagerNodeFilter {
+    pub active: bool,
+    pub ids: *const i64,
+    pub len: usize,
 }
 
-/// Compute Adamic-Adar index.
-#[no_mangle]
-pub extern "C" fn onager_compute_adamic_adar(
-    src_ptr: *const i64,
-    dst_ptr: *const i64,
-    edge_count: usize,
-    out_node1: *mut i64,
-    out_node2: *mut i64,
-    out_scores: *mut f64,
-) -> i64 {
-    clear_last_error();
-    crate::ffi_catch_unwind!(-1, {
-        if src_ptr.is_null() || dst_ptr.is_null() {
-            set_last_error("Null pointer");
-            return -1;
+impl OnagerNodeFilter {
+    /// Returns the allowed IDs, or None if every node is allowed.
+    ///
+    /// # Safety
+    /// An active filter with a non-zero `len` must point to `len` readable IDs.
+    unsafe fn ids<'a>(self) -> Option<&'a [i64]> {
+        if !self.active {
+            return None;
         }
-        let src = unsafe { std::slice::from_raw_parts(src_ptr, edge_count) };
-        let dst = unsafe { std::slice::from_raw_parts(dst_ptr, edge_count) };
-        match algorithms::compute_adamic_adar(src, dst) {
-            Ok(result) => {
-                let n = result.node1.len();
-                if !out_node1.is_null() && !out_node2.is_null() && !out_scores.is_null() {
-                    unsafe { std::slice::from_raw_parts_mut(out_node1, n) }
-                        .copy_from_slice(&result.node1);
-                    unsafe { std::slice::from_raw_parts_mut(out_node2, n) }
-                        .copy_from_slice(&result.node2);
-                    unsafe { std::slice::from_raw_parts_mut(out_scores, n) }
-                        .copy_from_slice(&result.scores);
-                }
-                n as i64
-            }
-            Err(e) => {
-                set_last_error(&e.to_string());
-                -1
-            }
+        if self.ids.is_null() || self.len == 0 {
+            return Some(&[]);
         }
-    })
+        Some(unsafe { std::slice::from_raw_parts(self.ids, self.len) })
+    }
 }
 
-/// Compute preferential attachment.
+/// Score every pair of distinct nodes for a link prediction metric.
+/// Metric codes: 0 Jaccard, 1 Adamic-Adar, 2 resource allocation, 3 preferential attachment.
+///
+/// Rows have node1 below node2. Only pairs whose nodes pass `node1` and `node2`
+/// are scored.
 #[no_mangle]
-pub extern "C" fn onager_compute_preferential_attachment(
+pub extern "C" fn onager_compute_link_scores(
     src_ptr: *const i64,
     dst_ptr: *const i64,
     edge_count: usize,
-    out_node1: *mut i64,
-    out_node2: *mut i64,
-    out_scores: *mut f64,
-) -> i64 {
+    metric: u32,
+    node1: OnagerNodeFilter,
+    node2: OnagerNodeFilter,
+) -> *mut OnagerResult {
     clear_last_error();
-    crate::ffi_catch_unwind!(-1, {
+    crate::ffi_catch_unwind!(std::ptr::null_mut(), {
         if src_ptr.is_null() || dst_ptr.is_null() {
             set_last_error("Null pointer");
-            return -1;
+            return std::ptr::null_mut();
         }
         let src = unsafe { std::slice::from_raw_parts(src_ptr, edge_count) };
         let dst = unsafe { std::slice::from_raw_parts(dst_ptr, edge_count) };
-        match algorithms::compute_preferential_attachment(src, dst) {
-            Ok(result) => {
-                let n = result.node1.len();
-                if !out_node1.is_null() && !out_node2.is_null() && !out_scores.is_null() {
-                    unsafe { std::slice::from_raw_parts_mut(out_node1, n) }
-                        .copy_from_slice(&result.node1);
-                    unsafe { std::slice::from_raw_parts_mut(out_node2, n) }
-                        .copy_from_slice(&result.node2);
-                    unsafe { std::slice::from_raw_parts_mut(out_scores, n) }
-                        .copy_from_slice(&result.scores);
-                }
-                n as i64
-            }
-            Err(e) => {
-                set_last_error(&e.to_string());
-                -1
-            }
-        }
+        let (node1, node2) = unsafe { (node1.ids(), node2.ids()) };
+        let result = algorithms::LinkMetric::from_code(metric)
+            .and_then(|metric| algorithms::compute_link_scores(src, dst, metric, node1, node2));
+        into_result_ptr(result, |result| {
+            OnagerResult::new(vec![result.node1, result.node2], vec![result.scores])
+        })
     })
 }
 
-/// Compute resource allocation index.
+/// Compute common neighbors count.
 #[no_mangle]
-pub extern "C" fn onager_compute_resource_allocation(
+pub extern "C" fn onager_compute_common_neighbors(
     src_ptr: *const i64,
     dst_ptr: *const i64,
     edge_count: usize,
-    out_node1: *mut i64,
-    out_node2: *mut i64,
-    out_scores: *mut f64,
-) -> i64 {
+) -> *mut OnagerResult {
     clear_last_error();
-    crate::ffi_catch_unwind!(-1, {
+    crate::ffi_catch_unwind!(std::ptr::null_mut(), {
         if src_ptr.is_null() || dst_ptr.is_null() {
             set_last_error("Null pointer");
-            return -1;
+            return std::ptr::null_mut();
         }
         let src = unsafe { std::slice::from_raw_parts(src_ptr, edge_count) };
         let dst = unsafe { std::slice::from_raw_parts(dst_ptr, edge_count) };
-        match algorithms::compute_resource_allocation(src, dst) {
-            Ok(result) => {
-                let n = result.node1.len();
-                if !out_node1.is_null() && !out_node2.is_null() && !out_scores.is_null() {
-                    unsafe { std::slice::from_raw_parts_mut(out_node1, n) }
-                        .copy_from_slice(&result.node1);
-                    unsafe { std::slice::from_raw_parts_mut(out_node2, n) }
-                        .copy_from_slice(&result.node2);
-                    unsafe { std::slice::from_raw_parts_mut(out_scores, n) }
-                        .copy_from_slice(&result.scores);
-                }
-                n as i64
-            }
-            Err(e) => {
-                set_last_error(&e.to_string());
-                -1
-            }
-        }
+        into_result_ptr(algorithms::compute_common_neighbors(src, dst), |result| {
+            OnagerResult::new(vec![result.node1, result.node2, result.counts], vec![])
+        })
     })
 }
 
-/// Compute common neighbors count.
+/// Compute the top-k new links per node for a link prediction metric.
+/// Metric codes: 0 Jaccard, 1 Adamic-Adar, 2 resource allocation, 3 preferential attachment.
 #[no_mangle]
-pub extern "C" fn onager_compute_common_neighbors(
+pub extern "C" fn onager_compute_link_top_k(
     src_ptr: *const i64,
     dst_ptr: *const i64,
     edge_count: usize,
-    out_node1: *mut i64,
-    out_node2: *mut i64,
-    out_counts: *mut i64,
-) -> i64 {
+    metric: u32,
+    top_k: usize,
+) -> *mut OnagerResult {
     clear_last_error();
-    crate::ffi_catch_unwind!(-1, {
+    crate::ffi_catch_unwind!(std::ptr::null_mut(), {
         if src_ptr.is_null() || dst_ptr.is_null() {
             set_last_error("Null pointer");
-            return -1;
+            return std::ptr::null_mut();
         }
         let src = unsafe { std::slice::from_raw_parts(src_ptr, edge_count) };
         let dst = unsafe { std::slice::from_raw_parts(dst_ptr, edge_count) };
-        match algorithms::compute_common_neighbors(src, dst) {
-            Ok(result) => {
-                let n = result.node1.len();
-                if !out_node1.is_null() && !out_node2.is_null() && !out_counts.is_null() {
-                    unsafe { std::slice::from_raw_parts_mut(out_node1, n) }
-                        .copy_from_slice(&result.node1);
-                    unsafe { std::slice::from_raw_parts_mut(out_node2, n) }
-                        .copy_from_slice(&result.node2);
-                    unsafe { std::slice::from_raw_parts_mut(out_counts, n) }
-                        .copy_from_slice(&result.counts);
-                }
-                n as i64
-            }
-            Err(e) => {
-                set_last_error(&e.to_string());
-                -1
-            }
-        }
+        let result = algorithms::LinkMetric::from_code(metric)
+            .and_then(|metric| algorithms::compute_link_top_k(src, dst, metric, top_k));
+        into_result_ptr(result, |result| {
+            OnagerResult::new(vec![result.node1, result.node2], vec![result.scores])
+        })
     })
 }
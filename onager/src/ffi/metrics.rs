@@ -3,7 +3,7 @@
 //! Diameter, Radius, Average Clustering, Average Path Length, Transitivity, Triangle Count, Assortativity.
 #![allow(clippy::not_unsafe_ptr_arg_deref)]
 
-use super::common::{clear_last_error, set_last_error};
+use super::common::{clear_last_error, into_result_ptr, set_last_error, OnagerResult};
 use crate::algorithms;
 
 /// Compute graph diameter.
@@ -137,33 +137,18 @@ pub extern "C" fn onager_compute_triangle_count(
     src_ptr: *const i64,
     dst_ptr: *const i64,
     edge_count: usize,
-    out_nodes: *mut i64,
-    out_counts: *mut i64,
-) -> i64 {
+) -> *mut OnagerResult {
     clear_last_error();
-    crate::ffi_catch_unwind!(-1, {
+    crate::ffi_catch_unwind!(std::ptr::null_mut(), {
         if src_ptr.is_null() || dst_ptr.is_null() {
             set_last_error("Null pointer");
-            return -1;
+            return std::ptr::null_mut();
         }
         let src = unsafe { std::slice::from_raw_parts(src_ptr, edge_count) };
         let dst = unsafe { std::slice::from_raw_parts(dst_ptr, edge_count) };
-        match algorithms::compute_triangle_count(src, dst) {
-            Ok(result) => {
-                let n = result.node_ids.len();
-                if !out_nodes.is_null() && !out_counts.is_null() {
-                    unsafe { std::slice::from_raw_parts_mut(out_nodes, n) }
-                        .copy_from_slice(&result.node_ids);
-                    unsafe { std::slice::from_raw_parts_mut(out_counts, n) }
-                        .copy_from_slice(&result.triangle_counts);
-                }
-                n as i64
-            }
-            Err(e) => {
-                set_last_error(&e.to_string());
-                -1
-            }
-        }
+        into_result_ptr(algorithms::compute_triangle_count(src, dst), |result| {
+            OnagerResult::new(vec![result.node_ids, result.triangle_counts], vec![])
+        })
     })
 }
 
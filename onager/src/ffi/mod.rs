@@ -13,6 +13,8 @@ mod metrics;
 mod mst;
 mod parallel;
 mod personalized;
+mod search;
+mod registry;
 mod subgraphs;
 mod traversal;
 
@@ -27,5 +29,7 @@ pub use metrics::*;
 pub use mst::*;
 pub use parallel::*;
 pub use personalized::*;
+pub use search::*;
+pub use registry::*;
 pub use subgraphs::*;
 pub use traversal::*;
@@ -1,10 +1,10 @@
 //! Parallel algorithms FFI exports.
 //!
-//! Parallel BFS, shortest paths, components, clustering, triangles.
+//! Parallel BFS, shortest paths, components, clustering, triangles, Louvain.
 //! Note: Parallel PageRank is in centrality.rs.
 #![allow(clippy::not_unsafe_ptr_arg_deref)]
 
-use super::common::{clear_last_error, set_last_error};
+use super::common::{clear_last_error, into_result_ptr, set_last_error, OnagerResult};
 use crate::algorithms;
 
 /// Compute parallel BFS from a single source.
@@ -14,30 +14,19 @@ pub extern "C" fn onager_compute_bfs_parallel(
     dst_ptr: *const i64,
     edge_count: usize,
     source: i64,
-    out_order: *mut i64,
-) -> i64 {
+) -> *mut OnagerResult {
     clear_last_error();
-    crate::ffi_catch_unwind!(-1, {
+    crate::ffi_catch_unwind!(std::ptr::null_mut(), {
         if src_ptr.is_null() || dst_ptr.is_null() {
             set_last_error("Null pointer");
-            return -1;
+            return std::ptr::null_mut();
         }
         let src = unsafe { std::slice::from_raw_parts(src_ptr, edge_count) };
         let dst = unsafe { std::slice::from_raw_parts(dst_ptr, edge_count) };
-        match algorithms::compute_bfs_parallel(src, dst, source) {
-            Ok(result) => {
-                let n = result.order.len();
-                if !out_order.is_null() {
-                    unsafe { std::slice::from_raw_parts_mut(out_order, n) }
-                        .copy_from_slice(&result.order);
-                }
-                n as i64
-            }
-            Err(e) => {
-                set_last_error(&e.to_string());
-                -1
-            }
-        }
+        into_result_ptr(
+            algorithms::compute_bfs_parallel(src, dst, source),
+            |result| OnagerResult::new(vec![result.order], vec![]),
+        )
     })
 }
 
@@ -48,33 +37,19 @@ pub extern "C" fn onager_compute_shortest_paths_parallel(
     dst_ptr: *const i64,
     edge_count: usize,
     source: i64,
-    out_nodes: *mut i64,
-    out_distances: *mut f64,
-) -> i64 {
+) -> *mut OnagerResult {
     clear_last_error();
-    crate::ffi_catch_unwind!(-1, {
+    crate::ffi_catch_unwind!(std::ptr::null_mut(), {
         if src_ptr.is_null() || dst_ptr.is_null() {
             set_last_error("Null pointer");
-            return -1;
+            return std::ptr::null_mut();
         }
         let src = unsafe { std::slice::from_raw_parts(src_ptr, edge_count) };
         let dst = unsafe { std::slice::from_raw_parts(dst_ptr, edge_count) };
-        match algorithms::compute_shortest_paths_parallel(src, dst, source) {
-            Ok(result) => {
-                let n = result.node_ids.len();
-                if !out_nodes.is_null() && !out_distances.is_null() {
-                    unsafe { std::slice::from_raw_parts_mut(out_nodes, n) }
-                        .copy_from_slice(&result.node_ids);
-                    unsafe { std::slice::from_raw_parts_mut(out_distances, n) }
-                        .copy_from_slice(&result.distances);
-                }
-                n as i64
-            }
-            Err(e) => {
-                set_last_error(&e.to_string());
-                -1
-            }
-        }
+        into_result_ptr(
+            algorithms::compute_shortest_paths_parallel(src, dst, source),
+            |result| OnagerResult::new(vec![result.node_ids], vec![result.distances]),
+        )
     })
 }
 
@@ -84,33 +59,19 @@ pub extern "C" fn onager_compute_components_parallel(
     src_ptr: *const i64,
     dst_ptr: *const i64,
     edge_count: usize,
-    out_nodes: *mut i64,
-    out_components: *mut i64,
-) -> i64 {
+) -> *mut OnagerResult {
     clear_last_error();
-    crate::ffi_catch_unwind!(-1, {
+    crate::ffi_catch_unwind!(std::ptr::null_mut(), {
         if src_ptr.is_null() || dst_ptr.is_null() {
             set_last_error("Null pointer");
-            return -1;
+            return std::ptr::null_mut();
         }
         let src = unsafe { std::slice::from_raw_parts(src_ptr, edge_count) };
         let dst = unsafe { std::slice::from_raw_parts(dst_ptr, edge_count) };
-        match algorithms::compute_components_parallel(src, dst) {
-            Ok(result) => {
-                let n = result.node_ids.len();
-                if !out_nodes.is_null() && !out_components.is_null() {
-                    unsafe { std::slice::from_raw_parts_mut(out_nodes, n) }
-                        .copy_from_slice(&result.node_ids);
-                    unsafe { std::slice::from_raw_parts_mut(out_components, n) }
-                        .copy_from_slice(&result.component_ids);
-                }
-                n as i64
-            }
-            Err(e) => {
-                set_last_error(&e.to_string());
-                -1
-            }
-        }
+        into_result_ptr(
+            algorithms::compute_components_parallel(src, dst),
+            |result| OnagerResult::new(vec![result.node_ids, result.component_ids], vec![]),
+        )
     })
 }
 
@@ -120,33 +81,19 @@ pub extern "C" fn onager_compute_clustering_parallel(
     src_ptr: *const i64,
     dst_ptr: *const i64,
     edge_count: usize,
-    out_nodes: *mut i64,
-    out_coefficients: *mut f64,
-) -> i64 {
+) -> *mut OnagerResult {
     clear_last_error();
-    crate::ffi_catch_unwind!(-1, {
+    crate::ffi_catch_unwind!(std::ptr::null_mut(), {
         if src_ptr.is_null() || dst_ptr.is_null() {
             set_last_error("Null pointer");
-            return -1;
+            return std::ptr::null_mut();
         }
         let src = unsafe { std::slice::from_raw_parts(src_ptr, edge_count) };
         let dst = unsafe { std::slice::from_raw_parts(dst_ptr, edge_count) };
-        match algorithms::compute_clustering_parallel(src, dst) {
-            Ok(result) => {
-                let n = result.node_ids.len();
-                if !out_nodes.is_null() && !out_coefficients.is_null() {
-                    unsafe { std::slice::from_raw_parts_mut(out_nodes, n) }
-                        .copy_from_slice(&result.node_ids);
-                    unsafe { std::slice::from_raw_parts_mut(out_coefficients, n) }
-                        .copy_from_slice(&result.coefficients);
-                }
-                n as i64
-            }
-            Err(e) => {
-                set_last_error(&e.to_string());
-                -1
-            }
-        }
+        into_result_ptr(
+            algorithms::compute_clustering_parallel(src, dst),
+            |result| OnagerResult::new(vec![result.node_ids], vec![result.coefficients]),
+        )
     })
 }
 
@@ -156,32 +103,51 @@ pub extern "C" fn onager_compute_triangles_parallel(
     src_ptr: *const i64,
     dst_ptr: *const i64,
     edge_count: usize,
-    out_nodes: *mut i64,
-    out_counts: *mut i64,
-) -> i64 {
+) -> *mut OnagerResult {
     clear_last_error();
-    crate::ffi_catch_unwind!(-1, {
+    crate::ffi_catch_unwind!(std::ptr::null_mut(), {
         if src_ptr.is_null() || dst_ptr.is_null() {
             set_last_error("Null pointer");
-            return -1;
+            return std::ptr::null_mut();
         }
         let src = unsafe { std::slice::from_raw_parts(src_ptr, edge_count) };
         let dst = unsafe { std::slice::from_raw_parts(dst_ptr, edge_count) };
-        match algorithms::compute_triangles_parallel(src, dst) {
-            Ok(result) => {
-                let n = result.node_ids.len();
-                if !out_nodes.is_null() && !out_counts.is_null() {
-                    unsafe { std::slice::from_raw_parts_mut(out_nodes, n) }
-                        .copy_from_slice(&result.node_ids);
-                    unsafe { std::slice::from_raw_parts_mut(out_counts, n) }
-                        .copy_from_slice(&result.triangle_counts);
-                }
-                n as i64
-            }
-            Err(e) => {
-                set_last_error(&e.to_string());
-                -1
-            }
+        into_result_ptr(algorithms::compute_triangles_parallel(src, dst), |result| {
+            OnagerResult::new(vec![result.node_ids, result.triangle_counts], vec![])
+        })
+    })
+}
+
+/// Compute Louvain community detection in parallel.
+///
+/// `weights_ptr` may be null for an unweighted graph, and a negative seed selects
+/// the default seed.
+#[no_mangle]
+pub extern "C" fn onager_compute_louvain_parallel(
+    src_ptr: *const i64,
+    dst_ptr: *const i64,
+    edge_count: usize,
+    weights_ptr: *const f64,
+    weights_count: usize,
+    seed: i64,
+) -> *mut OnagerResult {
+    clear_last_error();
+    crate::ffi_catch_unwind!(std::ptr::null_mut(), {
+        if src_ptr.is_null() || dst_ptr.is_null() {
+            set_last_error("Null pointer");
+            return std::ptr::null_mut();
         }
+        let src = unsafe { std::slice::from_raw_parts(src_ptr, edge_count) };
+        let dst = unsafe { std::slice::from_raw_parts(dst_ptr, edge_count) };
+        let weights = if weights_ptr.is_null() || weights_count == 0 {
+            &[]
+        } else {
+            unsafe { std::slice::from_raw_parts(weights_ptr, weights_count) }
+        };
+        let seed_opt = if seed < 0 { None } else { Some(seed as u64) };
+        into_result_ptr(
+            algorithms::compute_louvain_parallel(src, dst, weights, seed_opt),
+            |result| OnagerResult::new(vec![result.node_ids, result.community_ids], vec![]),
+        )
     })
 }
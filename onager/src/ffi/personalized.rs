@@ -1,7 +1,7 @@
 //! Personalized PageRank FFI exports.
 #![allow(clippy::not_unsafe_ptr_arg_deref)]
 
-use super::common::{clear_last_error, set_last_error};
+use super::common::{clear_last_error, into_result_ptr, set_last_error, OnagerResult};
 use crate::algorithms;
 
 /// Compute personalized PageRank.
@@ -16,14 +16,12 @@ pub extern "C" fn onager_compute_personalized_pagerank(
     damping: f64,
     max_iter: usize,
     tolerance: f64,
-    out_nodes: *mut i64,
-    out_scores: *mut f64,
-) -> i64 {
+) -> *mut OnagerResult {
     clear_last_error();
-    crate::ffi_catch_unwind!(-1, {
+    crate::ffi_catch_unwind!(std::ptr::null_mut(), {
         if src_ptr.is_null() || dst_ptr.is_null() {
             set_last_error("Null pointer");
-            return -1;
+            return std::ptr::null_mut();
         }
         let src = unsafe { std::slice::from_raw_parts(src_ptr, edge_count) };
         let dst = unsafe { std::slice::from_raw_parts(dst_ptr, edge_count) };
@@ -42,28 +40,16 @@ pub extern "C" fn onager_compute_personalized_pagerank(
                 Vec::new()
             };
 
-        match algorithms::compute_personalized_pagerank(
-            src,
-            dst,
-            &personalization,
-            damping,
-            max_iter,
-            tolerance,
-        ) {
-            Ok(result) => {
-                let n = result.node_ids.len();
-                if !out_nodes.is_null() && !out_scores.is_null() {
-                    unsafe { std::slice::from_raw_parts_mut(out_nodes, n) }
-                        .copy_from_slice(&result.node_ids);
-                    unsafe { std::slice::from_raw_parts_mut(out_scores, n) }
-                        .copy_from_slice(&result.scores);
-                }
-                n as i64
-            }
-            Err(e) => {
-                set_last_error(&e.to_string());
-                -1
-            }
-        }
+        into_result_ptr(
+            algorithms::compute_personalized_pagerank(
+                src,
+                dst,
+                &personalization,
+                damping,
+                max_iter,
+                tolerance,
+            ),
+            |result| OnagerResult::new(vec![result.node_ids], vec![result.scores]),
+        )
     })
 }
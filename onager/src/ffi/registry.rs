@@ -0,0 +1,530 @@
+//! Registry graph FFI exports.
+//!
+//! Algorithms that run on a named graph from the graph registry instead of edge arrays.
+//! Each call runs on a snapshot of the graph's CSR form, which is reused until the graph changes.
+
+use std::ffi::CStr;
+use std::os::raw::c_char;
+
+use super::centrality::pagerank_result;
+use super::common::{clear_last_error, into_result_ptr, set_last_error, OnagerResult};
+use super::search::{into_stream_ptr, source_slice, OnagerDistanceStream};
+use super::subgraphs::{into_neighborhood_ptr, neighborhood_rows, OnagerNeighborhoodStream};
+use crate::algorithms;
+use crate::csr::CsrGraph;
+use crate::error::Result;
+use crate::graph;
+
+/// Runs an algorithm on the named graph and converts its result.
+///
+/// # Safety
+/// The graph_name pointer must be null or a valid null-terminated C string.
+unsafe fn run_on_graph<T>(
+    graph_name: *const c_char,
+    compute: impl FnOnce(&CsrGraph) -> Result<T>,
+    convert: impl FnOnce(T) -> OnagerResult,
+) -> *mut OnagerResult {
+    match unsafe { graph_name_str(graph_name) } {
+        Some(name) => into_result_ptr(graph::with_csr(name, compute), convert),
+        None => std::ptr::null_mut(),
+    }
+}
+
+/// Reads a graph name, recording the error and returning None if it is null or not UTF-8.
+///
+/// # Safety
+/// The graph_name pointer must be null or a valid null-terminated C string.
+unsafe fn graph_name_str<'a>(graph_name: *const c_char) -> Option<&'a str> {
+    if graph_name.is_null() {
+        set_last_error("Null pointer for graph name");
+        return None;
+    }
+    match unsafe { CStr::from_ptr(graph_name) }.to_str() {
+        Ok(s) => Some(s),
+        Err(_) => {
+            set_last_error("Invalid UTF-8 in graph name");
+            None
+        }
+    }
+}
+
+/// Compute PageRank on a named graph.
+///
+/// The `prior_count` pairs of `prior_nodes_ptr` and `prior_ranks_ptr` seed the
+/// starting vector with the ranks of an earlier run; a count of zero starts uniform.
+/// # Safety
+/// The graph_name pointer must be a valid null-terminated C string, and the prior
+/// pointers must be valid for `prior_count` elements when it is non-zero.
+#[no_mangle]
+pub unsafe extern "C" fn onager_graph_compute_pagerank(
+    graph_name: *const c_char,
+    damping: f64,
+    iterations: usize,
+    tolerance: f64,
+    prior_nodes_ptr: *const i64,
+    prior_ranks_ptr: *const f64,
+    prior_count: usize,
+) -> *mut OnagerResult {
+    clear_last_error();
+    crate::ffi_catch_unwind!(std::ptr::null_mut(), {
+        if prior_count > 0 && (prior_nodes_ptr.is_null() || prior_ranks_ptr.is_null()) {
+            set_last_error("Null pointer for prior ranks");
+            return std::ptr::null_mut();
+        }
+        let prior: Vec<(i64, f64)> = if prior_count == 0 {
+            Vec::new()
+        } else {
+            let nodes = unsafe { std::slice::from_raw_parts(prior_nodes_ptr, prior_count) };
+            let ranks = unsafe { std::slice::from_raw_parts(prior_ranks_ptr, prior_count) };
+            nodes.iter().copied().zip(ranks.iter().copied()).collect()
+        };
+        unsafe {
+            run_on_graph(
+                graph_name,
+                |csr| algorithms::compute_pagerank_csr(csr, damping, iterations, tolerance, &prior),
+                pagerank_result,
+            )
+        }
+    })
+}
+
+/// Compute degree centrality on a named graph.
+/// # Safety
+/// The graph_name pointer must be a valid null-terminated C string.
+#[no_mangle]
+pub unsafe extern "C" fn onager_graph_compute_degree(
+    graph_name: *const c_char,
+) -> *mut OnagerResult {
+    clear_last_error();
+    crate::ffi_catch_unwind!(std::ptr::null_mut(), {
+        unsafe {
+            run_on_graph(graph_name, algorithms::compute_degree_csr, |result| {
+                OnagerResult::new(
+                    vec![result.node_ids],
+                    vec![result.in_degrees, result.out_degrees],
+                )
+            })
+        }
+    })
+}
+
+/// Compute betweenness centrality on a named graph.
+/// A nonzero samples count uses that many random pivot sources chosen with seed.
+/// # Safety
+/// The graph_name pointer must be a valid null-terminated C string.
+#[no_mangle]
+pub unsafe extern "C" fn onager_graph_compute_betweenness(
+    graph_name: *const c_char,
+    normalized: bool,
+    samples: usize,
+    seed: u64,
+) -> *mut OnagerResult {
+    clear_last_error();
+    crate::ffi_catch_unwind!(std::ptr::null_mut(), {
+        unsafe {
+            run_on_graph(
+                graph_name,
+                |csr| {
+                    let samples = if samples == 0 { None } else { Some(samples) };
+                    algorithms::compute_betweenness_csr(csr, normalized, samples, seed)
+                },
+                |result| OnagerResult::new(vec![result.node_ids], vec![result.centralities]),
+            )
+        }
+    })
+}
+
+/// Compute closeness centrality on a named graph.
+/// # Safety
+/// The graph_name pointer must be a valid null-terminated C string.
+#[no_mangle]
+pub unsafe extern "C" fn onager_graph_compute_closeness(
+    graph_name: *const c_char,
+) -> *mut OnagerResult {
+    clear_last_error();
+    crate::ffi_catch_unwind!(std::ptr::null_mut(), {
+        unsafe {
+            run_on_graph(graph_name, algorithms::compute_closeness_csr, |result| {
+                OnagerResult::new(vec![result.node_ids], vec![result.centralities])
+            })
+        }
+    })
+}
+
+/// Compute harmonic centrality on a named graph.
+/// # Safety
+/// The graph_name pointer must be a valid null-terminated C string.
+#[no_mangle]
+pub unsafe extern "C" fn onager_graph_compute_harmonic(
+    graph_name: *const c_char,
+) -> *mut OnagerResult {
+    clear_last_error();
+    crate::ffi_catch_unwind!(std::ptr::null_mut(), {
+        unsafe {
+            run_on_graph(graph_name, algorithms::compute_harmonic_csr, |result| {
+                OnagerResult::new(vec![result.node_ids], vec![result.centralities])
+            })
+        }
+    })
+}
+
+/// Compute eigenvector centrality on a named graph.
+/// # Safety
+/// The graph_name pointer must be a valid null-terminated C string.
+#[no_mangle]
+pub unsafe extern "C" fn onager_graph_compute_eigenvector(
+    graph_name: *const c_char,
+    max_iter: usize,
+    tolerance: f64,
+) -> *mut OnagerResult {
+    clear_last_error();
+    crate::ffi_catch_unwind!(std::ptr::null_mut(), {
+        unsafe {
+            run_on_graph(
+                graph_name,
+                |csr| algorithms::compute_eigenvector_csr(csr, max_iter, tolerance),
+                |result| OnagerResult::new(vec![result.node_ids], vec![result.centralities]),
+            )
+        }
+    })
+}
+
+/// Compute Katz centrality on a named graph.
+/// # Safety
+/// The graph_name pointer must be a valid null-terminated C string.
+#[no_mangle]
+pub unsafe extern "C" fn onager_graph_compute_katz(
+    graph_name: *const c_char,
+    alpha: f64,
+    max_iter: usize,
+    tolerance: f64,
+) -> *mut OnagerResult {
+    clear_last_error();
+    crate::ffi_catch_unwind!(std::ptr::null_mut(), {
+        unsafe {
+            run_on_graph(
+                graph_name,
+                |csr| algorithms::compute_katz_csr(csr, alpha, max_iter, tolerance),
+                |result| OnagerResult::new(vec![result.node_ids], vec![result.centralities]),
+            )
+        }
+    })
+}
+
+/// Compute Louvain community detection on a named graph.
+/// # Safety
+/// The graph_name pointer must be a valid null-terminated C string.
+#[no_mangle]
+pub unsafe extern "C" fn onager_graph_compute_louvain(
+    graph_name: *const c_char,
+    seed: i64,
+) -> *mut OnagerResult {
+    clear_last_error();
+    crate::ffi_catch_unwind!(std::ptr::null_mut(), {
+        let seed_opt = if seed < 0 { None } else { Some(seed as u64) };
+        unsafe {
+            run_on_graph(
+                graph_name,
+                |csr| algorithms::compute_louvain_csr(csr, seed_opt),
+                |result| OnagerResult::new(vec![result.node_ids, result.community_ids], vec![]),
+            )
+        }
+    })
+}
+
+/// Compute Louvain community detection in parallel on a named graph, using its edge weights.
+/// # Safety
+/// The graph_name pointer must be a valid null-terminated C string.
+#[no_mangle]
+pub unsafe extern "C" fn onager_graph_compute_louvain_parallel(
+    graph_name: *const c_char,
+    seed: i64,
+) -> *mut OnagerResult {
+    clear_last_error();
+    crate::ffi_catch_unwind!(std::ptr::null_mut(), {
+        let seed_opt = if seed < 0 { None } else { Some(seed as u64) };
+        unsafe {
+            run_on_graph(
+                graph_name,
+                |csr| algorithms::compute_louvain_parallel_csr(csr, seed_opt),
+                |result| OnagerResult::new(vec![result.node_ids, result.community_ids], vec![]),
+            )
+        }
+    })
+}
+
+/// Compute connected components on a named graph.
+///
+/// The components are kept up to date as edges are inserted, see
+/// [`graph::connected_components`], and numbered by their smallest node ID.
+/// # Safety
+/// The graph_name pointer must be a valid null-terminated C string.
+#[no_mangle]
+pub unsafe extern "C" fn onager_graph_compute_connected_components(
+    graph_name: *const c_char,
+) -> *mut OnagerResult {
+    clear_last_error();
+    crate::ffi_catch_unwind!(std::ptr::null_mut(), {
+        match unsafe { graph_name_str(graph_name) } {
+            Some(name) => into_result_ptr(graph::connected_components(name), |(nodes, labels)| {
+                OnagerResult::new(vec![nodes, labels], vec![])
+            }),
+            None => std::ptr::null_mut(),
+        }
+    })
+}
+
+/// Compute label propagation on a named graph.
+/// # Safety
+/// The graph_name pointer must be a valid null-terminated C string.
+#[no_mangle]
+pub unsafe extern "C" fn onager_graph_compute_label_propagation(
+    graph_name: *const c_char,
+) -> *mut OnagerResult {
+    clear_last_error();
+    crate::ffi_catch_unwind!(std::ptr::null_mut(), {
+        unsafe {
+            run_on_graph(
+                graph_name,
+                algorithms::compute_label_propagation_csr,
+                |result| OnagerResult::new(vec![result.node_ids, result.labels], vec![]),
+            )
+        }
+    })
+}
+
+/// Compute the core number of every node of a named graph.
+/// # Safety
+/// The graph_name pointer must be a valid null-terminated C string.
+#[no_mangle]
+pub unsafe extern "C" fn onager_graph_compute_kcore(
+    graph_name: *const c_char,
+) -> *mut OnagerResult {
+    clear_last_error();
+    crate::ffi_catch_unwind!(std::ptr::null_mut(), {
+        unsafe {
+            run_on_graph(graph_name, algorithms::compute_kcore_csr, |result| {
+                OnagerResult::new(vec![result.node_ids, result.core_numbers], vec![])
+            })
+        }
+    })
+}
+
+/// Extract the edges of the k-core of a named graph.
+/// # Safety
+/// The graph_name pointer must be a valid null-terminated C string.
+#[no_mangle]
+pub unsafe extern "C" fn onager_graph_compute_kcore_edges(
+    graph_name: *const c_char,
+    k: i64,
+) -> *mut OnagerResult {
+    clear_last_error();
+    crate::ffi_catch_unwind!(std::ptr::null_mut(), {
+        unsafe {
+            run_on_graph(
+                graph_name,
+                |csr| algorithms::compute_kcore_edges_csr(csr, k),
+                |result| OnagerResult::new(vec![result.src, result.dst], vec![]),
+            )
+        }
+    })
+}
+
+/// Compute Dijkstra shortest distances on a named graph.
+/// # Safety
+/// The graph_name pointer must be a valid null-terminated C string.
+#[no_mangle]
+pub unsafe extern "C" fn onager_graph_compute_dijkstra(
+    graph_name: *const c_char,
+    source_node: i64,
+) -> *mut OnagerResult {
+    clear_last_error();
+    crate::ffi_catch_unwind!(std::ptr::null_mut(), {
+        unsafe {
+            run_on_graph(
+                graph_name,
+                |csr| algorithms::compute_dijkstra_csr(csr, source_node),
+                |result| OnagerResult::new(vec![result.node_ids], vec![result.distances]),
+            )
+        }
+    })
+}
+
+/// Compute BFS traversal on a named graph.
+/// # Safety
+/// The graph_name pointer must be a valid null-terminated C string.
+#[no_mangle]
+pub unsafe extern "C" fn onager_graph_compute_bfs(
+    graph_name: *const c_char,
+    source_node: i64,
+) -> *mut OnagerResult {
+    clear_last_error();
+    crate::ffi_catch_unwind!(std::ptr::null_mut(), {
+        unsafe {
+            run_on_graph(
+                graph_name,
+                |csr| algorithms::compute_bfs_csr(csr, source_node),
+                |result| OnagerResult::new(vec![result.order], vec![]),
+            )
+        }
+    })
+}
+
+/// Compute DFS traversal on a named graph.
+/// # Safety
+/// The graph_name pointer must be a valid null-terminated C string.
+#[no_mangle]
+pub unsafe extern "C" fn onager_graph_compute_dfs(
+    graph_name: *const c_char,
+    source_node: i64,
+) -> *mut OnagerResult {
+    clear_last_error();
+    crate::ffi_catch_unwind!(std::ptr::null_mut(), {
+        unsafe {
+            run_on_graph(
+                graph_name,
+                |csr| algorithms::compute_dfs_csr(csr, source_node),
+                |result| OnagerResult::new(vec![result.order], vec![]),
+            )
+        }
+    })
+}
+
+/// Score candidate node pairs on a named graph with a link prediction metric.
+/// Metric codes match `onager_compute_link_top_k`. The node pointers may be null when
+/// pair_count is 0.
+/// # Safety
+/// The graph_name pointer must be a valid null-terminated C string, and the node
+/// pointers must point to pair_count values each.
+#[no_mangle]
+pub unsafe extern "C" fn onager_graph_score_link_pairs(
+    graph_name: *const c_char,
+    node1_ptr: *const i64,
+    node2_ptr: *const i64,
+    pair_count: usize,
+    metric: u32,
+) -> *mut OnagerResult {
+    clear_last_error();
+    crate::ffi_catch_unwind!(std::ptr::null_mut(), {
+        if pair_count > 0 && (node1_ptr.is_null() || node2_ptr.is_null()) {
+            set_last_error("Null pointer");
+            return std::ptr::null_mut();
+        }
+        let (node1, node2): (&[i64], &[i64]) = if pair_count == 0 {
+            (&[], &[])
+        } else {
+            unsafe {
+                (
+                    std::slice::from_raw_parts(node1_ptr, pair_count),
+                    std::slice::from_raw_parts(node2_ptr, pair_count),
+                )
+            }
+        };
+        unsafe {
+            run_on_graph(
+                graph_name,
+                |csr| {
+                    let metric = algorithms::LinkMetric::from_code(metric)?;
+                    algorithms::score_link_pairs_csr(csr, node1, node2, metric)
+                },
+                |result| OnagerResult::new(vec![result.node1, result.node2], vec![result.scores]),
+            )
+        }
+    })
+}
+
+/// Start a multi-source distance search on a named graph.
+/// The sources pointer may be null when source_count is 0. The search copies
+/// the adjacency it needs, so the registry lock is released before rows are read.
+/// # Safety
+/// The graph_name pointer must be a valid null-terminated C string, and the sources
+/// pointer must point to source_count values.
+#[no_mangle]
+pub unsafe extern "C" fn onager_graph_multi_source_search(
+    graph_name: *const c_char,
+    sources_ptr: *const i64,
+    source_count: usize,
+) -> *mut OnagerDistanceStream {
+    clear_last_error();
+    crate::ffi_catch_unwind!(std::ptr::null_mut(), {
+        if source_count > 0 && sources_ptr.is_null() {
+            set_last_error("Null pointer");
+            return std::ptr::null_mut();
+        }
+        let sources = unsafe { source_slice(sources_ptr, source_count) };
+        match unsafe { graph_name_str(graph_name) } {
+            Some(name) => into_stream_ptr(graph::with_csr(name, |csr| {
+                algorithms::MultiSourceSearch::new(csr, sources)
+            })),
+            None => std::ptr::null_mut(),
+        }
+    })
+}
+
+/// Start a search for the nodes or edges within radius hops of each center on a named graph.
+/// Emits `(center, src, dst)` edge rows when edges is true and `(center, node, hop)`
+/// rows otherwise. The centers pointer may be null when center_count is 0. The
+/// search copies the adjacency it needs, so the registry lock is released before
+/// rows are read.
+/// # Safety
+/// The graph_name pointer must be a valid null-terminated C string, and the centers
+/// pointer must point to center_count values.
+#[no_mangle]
+pub unsafe extern "C" fn onager_graph_neighborhood_search(
+    graph_name: *const c_char,
+    centers_ptr: *const i64,
+    center_count: usize,
+    radius: usize,
+    edges: bool,
+) -> *mut OnagerNeighborhoodStream {
+    clear_last_error();
+    crate::ffi_catch_unwind!(std::ptr::null_mut(), {
+        if center_count > 0 && centers_ptr.is_null() {
+            set_last_error("Null pointer");
+            return std::ptr::null_mut();
+        }
+        let centers = unsafe { source_slice(centers_ptr, center_count) };
+        match unsafe { graph_name_str(graph_name) } {
+            Some(name) => into_neighborhood_ptr(graph::with_csr(name, |csr| {
+                algorithms::NeighborhoodSearch::new(csr, centers, radius, neighborhood_rows(edges))
+            })),
+            None => std::ptr::null_mut(),
+        }
+    })
+}
+
+/// Compute the distance of candidate node pairs on a named graph with a bidirectional search.
+/// A negative max_depth means no cutoff. The node pointers may be null when pair_count is 0.
+/// # Safety
+/// The graph_name pointer must be a valid null-terminated C string, and the node
+/// pointers must point to pair_count values each.
+#[no_mangle]
+pub unsafe extern "C" fn onager_graph_compute_pair_distances(
+    graph_name: *const c_char,
+    src_ptr: *const i64,
+    dst_ptr: *const i64,
+    pair_count: usize,
+    max_depth: f64,
+) -> *mut OnagerResult {
+    clear_last_error();
+    crate::ffi_catch_unwind!(std::ptr::null_mut(), {
+        if pair_count > 0 && (src_ptr.is_null() || dst_ptr.is_null()) {
+            set_last_error("Null pointer");
+            return std::ptr::null_mut();
+        }
+        let src = unsafe { source_slice(src_ptr, pair_count) };
+        let dst = unsafe { source_slice(dst_ptr, pair_count) };
+        let max_depth = if max_depth < 0.0 {
+            None
+        } else {
+            Some(max_depth)
+        };
+        unsafe {
+            run_on_graph(
+                graph_name,
+                |csr| algorithms::compute_pair_distances_csr(csr, src, dst, max_depth),
+                |result| OnagerResult::new(vec![result.src, result.dst], vec![result.distances]),
+            )
+        }
+    })
+}
@@ -0,0 +1,110 @@
+//! Multi-source search FFI exports.
+//!
+//! Streaming distances from many sources.
+#![allow(clippy::not_unsafe_ptr_arg_deref)]
+
+use super::common::{clear_last_error, set_last_error};
+use crate::algorithms::{self, DistanceStream, MultiSourceSearch};
+use crate::error::Result;
+
+/// Stream of `(source, node, distance)` rows owned by Rust.
+///
+/// C++ pulls rows in chunks with `onager_distance_stream_next` and releases the
+/// stream with `onager_free_distance_stream`, which also stops its workers.
+pub struct OnagerDistanceStream(DistanceStream);
+
+/// Starts a search and boxes its stream, or records the error and returns null.
+pub(crate) fn into_stream_ptr(search: Result<MultiSourceSearch>) -> *mut OnagerDistanceStream {
+    match search {
+        Ok(search) => Box::into_raw(Box::new(OnagerDistanceStream(search.stream()))),
+        Err(e) => {
+            set_last_error(&e.to_string());
+            std::ptr::null_mut()
+        }
+    }
+}
+
+/// Reads a node ID list whose pointer may be null when it is empty.
+///
+/// # Safety
+/// A non-null pointer must point to source_count values.
+pub(crate) unsafe fn source_slice<'a>(sources_ptr: *const i64, source_count: usize) -> &'a [i64] {
+    if source_count == 0 {
+        &[]
+    } else {
+        unsafe { std::slice::from_raw_parts(sources_ptr, source_count) }
+    }
+}
+
+/// Start a multi-source distance search over edge arrays.
+/// The weight pointer may be null for an unweighted search, and the sources
+/// pointer may be null when source_count is 0.
+#[no_mangle]
+pub extern "C" fn onager_multi_source_search(
+    src_ptr: *const i64,
+    dst_ptr: *const i64,
+    weight_ptr: *const f64,
+    edge_count: usize,
+    sources_ptr: *const i64,
+    source_count: usize,
+) -> *mut OnagerDistanceStream {
+    clear_last_error();
+    crate::ffi_catch_unwind!(std::ptr::null_mut(), {
+        if src_ptr.is_null() || dst_ptr.is_null() || (source_count > 0 && sources_ptr.is_null()) {
+            set_last_error("Null pointer");
+            return std::ptr::null_mut();
+        }
+        let sources = unsafe { source_slice(sources_ptr, source_count) };
+        let src = unsafe { std::slice::from_raw_parts(src_ptr, edge_count) };
+        let dst = unsafe { std::slice::from_raw_parts(dst_ptr, edge_count) };
+        let weights = if weight_ptr.is_null() {
+            None
+        } else {
+            Some(unsafe { std::slice::from_raw_parts(weight_ptr, edge_count) })
+        };
+        into_stream_ptr(algorithms::multi_source_search(src, dst, weights, sources))
+    })
+}
+
+/// Write up to capacity rows from a distance stream into the output arrays.
+/// Returns the number of rows written, where fewer than capacity means the
+/// stream is exhausted, or -1 on error. Reading from a stream whose query was
+/// interrupted fails, with `onager_last_call_interrupted` set.
+#[no_mangle]
+pub extern "C" fn onager_distance_stream_next(
+    stream: *mut OnagerDistanceStream,
+    source_out: *mut i64,
+    node_out: *mut i64,
+    dist_out: *mut f64,
+    capacity: usize,
+) -> i64 {
+    clear_last_error();
+    if stream.is_null() || source_out.is_null() || node_out.is_null() || dist_out.is_null() {
+        set_last_error("Null pointer");
+        return -1;
+    }
+    crate::ffi_catch_unwind!(-1, {
+        let sources = unsafe { std::slice::from_raw_parts_mut(source_out, capacity) };
+        let nodes = unsafe { std::slice::from_raw_parts_mut(node_out, capacity) };
+        let dist = unsafe { std::slice::from_raw_parts_mut(dist_out, capacity) };
+        match unsafe { (*stream).0.next_batch(sources, nodes, dist) } {
+            Ok(count) => count as i64,
+            Err(e) => {
+                set_last_error(&e.to_string());
+                -1
+            }
+        }
+    })
+}
+
+/// Free a distance stream and stop its workers.
+/// # Safety
+/// The pointer must be null or returned by a multi-source search function.
+#[no_mangle]
+pub unsafe extern "C" fn onager_free_distance_stream(stream: *mut OnagerDistanceStream) {
+    if !stream.is_null() {
+        unsafe {
+            drop(Box::from_raw(stream));
+        }
+    }
+}
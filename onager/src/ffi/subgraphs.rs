@@ -1,10 +1,42 @@
 //! Subgraph operations FFI exports.
 //!
-//! Ego graph, k-hop neighbors, induced subgraph.
+//! Ego graph, k-hop neighbors, induced subgraph, and streaming neighborhoods of many centers.
 #![allow(clippy::not_unsafe_ptr_arg_deref)]
 
-use super::common::{clear_last_error, set_last_error};
-use crate::algorithms;
+use super::common::{clear_last_error, into_result_ptr, set_last_error, OnagerResult};
+use super::search::source_slice;
+use crate::algorithms::{self, NeighborhoodRows, NeighborhoodSearch, NeighborhoodStream};
+use crate::error::Result;
+
+/// Stream of neighborhood rows owned by Rust.
+///
+/// Rows are `(center, node, hop)` or `(center, src, dst)`, depending on how the
+/// search was started. C++ pulls rows in chunks with `onager_neighborhood_stream_next`
+/// and releases the stream with `onager_free_neighborhood_stream`, which also stops
+/// its workers.
+pub struct OnagerNeighborhoodStream(NeighborhoodStream);
+
+/// Starts a search and boxes its stream, or records the error and returns null.
+pub(crate) fn into_neighborhood_ptr(
+    search: Result<NeighborhoodSearch>,
+) -> *mut OnagerNeighborhoodStream {
+    match search {
+        Ok(search) => Box::into_raw(Box::new(OnagerNeighborhoodStream(search.stream()))),
+        Err(e) => {
+            set_last_error(&e.to_string());
+            std::ptr::null_mut()
+        }
+    }
+}
+
+/// Picks the rows a neighborhood search emits.
+pub(crate) fn neighborhood_rows(edges: bool) -> NeighborhoodRows {
+    if edges {
+        NeighborhoodRows::Edges
+    } else {
+        NeighborhoodRows::Nodes
+    }
+}
 
 /// Compute ego graph.
 #[no_mangle]
@@ -14,33 +46,19 @@ pub extern "C" fn onager_compute_ego_graph(
     edge_count: usize,
     center: i64,
     radius: usize,
-    out_src: *mut i64,
-    out_dst: *mut i64,
-) -> i64 {
+) -> *mut OnagerResult {
     clear_last_error();
-    crate::ffi_catch_unwind!(-1, {
+    crate::ffi_catch_unwind!(std::ptr::null_mut(), {
         if src_ptr.is_null() || dst_ptr.is_null() {
             set_last_error("Null pointer");
-            return -1;
+            return std::ptr::null_mut();
         }
         let src = unsafe { std::slice::from_raw_parts(src_ptr, edge_count) };
         let dst = unsafe { std::slice::from_raw_parts(dst_ptr, edge_count) };
-        match algorithms::compute_ego_graph(src, dst, center, radius) {
-            Ok(result) => {
-                let n = result.src.len();
-                if !out_src.is_null() && !out_dst.is_null() {
-                    unsafe { std::slice::from_raw_parts_mut(out_src, n) }
-                        .copy_from_slice(&result.src);
-                    unsafe { std::slice::from_raw_parts_mut(out_dst, n) }
-                        .copy_from_slice(&result.dst);
-                }
-                n as i64
-            }
-            Err(e) => {
-                set_last_error(&e.to_string());
-                -1
-            }
-        }
+        into_result_ptr(
+            algorithms::compute_ego_graph(src, dst, center, radius),
+            |result| OnagerResult::new(vec![result.src, result.dst], vec![]),
+        )
     })
 }
 
@@ -52,30 +70,19 @@ pub extern "C" fn onager_compute_k_hop_neighbors(
     edge_count: usize,
     start: i64,
     k: usize,
-    out_nodes: *mut i64,
-) -> i64 {
+) -> *mut OnagerResult {
     clear_last_error();
-    crate::ffi_catch_unwind!(-1, {
+    crate::ffi_catch_unwind!(std::ptr::null_mut(), {
         if src_ptr.is_null() || dst_ptr.is_null() {
             set_last_error("Null pointer");
-            return -1;
+            return std::ptr::null_mut();
         }
         let src = unsafe { std::slice::from_raw_parts(src_ptr, edge_count) };
         let dst = unsafe { std::slice::from_raw_parts(dst_ptr, edge_count) };
-        match algorithms::compute_k_hop_neighbors(src, dst, start, k) {
-            Ok(result) => {
-                let n = result.node_ids.len();
-                if !out_nodes.is_null() {
-                    unsafe { std::slice::from_raw_parts_mut(out_nodes, n) }
-                        .copy_from_slice(&result.node_ids);
-                }
-                n as i64
-            }
-            Err(e) => {
-                set_last_error(&e.to_string());
-                -1
-            }
-        }
+        into_result_ptr(
+            algorithms::compute_k_hop_neighbors(src, dst, start, k),
+            |result| OnagerResult::new(vec![result.node_ids], vec![]),
+        )
     })
 }
 
@@ -87,29 +94,78 @@ pub extern "C" fn onager_compute_induced_subgraph(
     edge_count: usize,
     node_ids_ptr: *const i64,
     node_count: usize,
-    out_src: *mut i64,
-    out_dst: *mut i64,
-) -> i64 {
+) -> *mut OnagerResult {
     clear_last_error();
-    crate::ffi_catch_unwind!(-1, {
+    crate::ffi_catch_unwind!(std::ptr::null_mut(), {
         if src_ptr.is_null() || dst_ptr.is_null() || node_ids_ptr.is_null() {
             set_last_error("Null pointer");
-            return -1;
+            return std::ptr::null_mut();
         }
         let src = unsafe { std::slice::from_raw_parts(src_ptr, edge_count) };
         let dst = unsafe { std::slice::from_raw_parts(dst_ptr, edge_count) };
         let node_ids = unsafe { std::slice::from_raw_parts(node_ids_ptr, node_count) };
-        match algorithms::compute_induced_subgraph(src, dst, node_ids) {
-            Ok(result) => {
-                let n = result.src.len();
-                if !out_src.is_null() && !out_dst.is_null() {
-                    unsafe { std::slice::from_raw_parts_mut(out_src, n) }
-                        .copy_from_slice(&result.src);
-                    unsafe { std::slice::from_raw_parts_mut(out_dst, n) }
-                        .copy_from_slice(&result.dst);
-                }
-                n as i64
-            }
+        into_result_ptr(
+            algorithms::compute_induced_subgraph(src, dst, node_ids),
+            |result| OnagerResult::new(vec![result.src, result.dst], vec![]),
+        )
+    })
+}
+
+/// Start a search for the nodes or edges within radius hops of each center.
+/// Emits `(center, src, dst)` edge rows when edges is true and `(center, node, hop)`
+/// rows otherwise. The centers pointer may be null when center_count is 0.
+#[no_mangle]
+pub extern "C" fn onager_neighborhood_search(
+    src_ptr: *const i64,
+    dst_ptr: *const i64,
+    edge_count: usize,
+    centers_ptr: *const i64,
+    center_count: usize,
+    radius: usize,
+    edges: bool,
+) -> *mut OnagerNeighborhoodStream {
+    clear_last_error();
+    crate::ffi_catch_unwind!(std::ptr::null_mut(), {
+        if src_ptr.is_null() || dst_ptr.is_null() || (center_count > 0 && centers_ptr.is_null()) {
+            set_last_error("Null pointer");
+            return std::ptr::null_mut();
+        }
+        let centers = unsafe { source_slice(centers_ptr, center_count) };
+        let src = unsafe { std::slice::from_raw_parts(src_ptr, edge_count) };
+        let dst = unsafe { std::slice::from_raw_parts(dst_ptr, edge_count) };
+        into_neighborhood_ptr(algorithms::neighborhood_search(
+            src,
+            dst,
+            centers,
+            radius,
+            neighborhood_rows(edges),
+        ))
+    })
+}
+
+/// Write up to capacity rows from a neighborhood stream into the output arrays.
+/// Returns the number of rows written, where fewer than capacity means the
+/// stream is exhausted, or -1 on error. Reading from a stream whose query was
+/// interrupted fails, with `onager_last_call_interrupted` set.
+#[no_mangle]
+pub extern "C" fn onager_neighborhood_stream_next(
+    stream: *mut OnagerNeighborhoodStream,
+    center_out: *mut i64,
+    first_out: *mut i64,
+    second_out: *mut i64,
+    capacity: usize,
+) -> i64 {
+    clear_last_error();
+    if stream.is_null() || center_out.is_null() || first_out.is_null() || second_out.is_null() {
+        set_last_error("Null pointer");
+        return -1;
+    }
+    crate::ffi_catch_unwind!(-1, {
+        let centers = unsafe { std::slice::from_raw_parts_mut(center_out, capacity) };
+        let first = unsafe { std::slice::from_raw_parts_mut(first_out, capacity) };
+        let second = unsafe { std::slice::from_raw_parts_mut(second_out, capacity) };
+        match unsafe { (*stream).0.next_batch(centers, first, second) } {
+            Ok(count) => count as i64,
             Err(e) => {
                 set_last_error(&e.to_string());
                 -1
@@ -117,3 +173,15 @@ pub extern "C" fn onager_compute_induced_subgraph(
         }
     })
 }
+
+/// Free a neighborhood stream and stop its workers.
+/// # Safety
+/// The pointer must be null or returned by a neighborhood search function.
+#[no_mangle]
+pub unsafe extern "C" fn onager_free_neighborhood_stream(stream: *mut OnagerNeighborhoodStream) {
+    if !stream.is_null() {
+        unsafe {
+            drop(Box::from_raw(stream));
+        }
+    }
+}
@@ -3,43 +3,37 @@
 //! Dijkstra, BFS, DFS, Bellman-Ford, Floyd-Warshall, Shortest Distance.
 #![allow(clippy::not_unsafe_ptr_arg_deref)]
 
-use super::common::{clear_last_error, set_last_error};
+use super::common::{clear_last_error, into_result_ptr, set_last_error, OnagerResult};
 use crate::algorithms;
 
 /// Compute Dijkstra shortest paths.
+/// `weights_ptr` may be null for an unweighted graph.
 #[no_mangle]
 pub extern "C" fn onager_compute_dijkstra(
     src_ptr: *const i64,
     dst_ptr: *const i64,
     edge_count: usize,
+    weights_ptr: *const f64,
+    weights_count: usize,
     source_node: i64,
-    out_nodes: *mut i64,
-    out_distances: *mut f64,
-) -> i64 {
+) -> *mut OnagerResult {
     clear_last_error();
-    crate::ffi_catch_unwind!(-1, {
+    crate::ffi_catch_unwind!(std::ptr::null_mut(), {
         if src_ptr.is_null() || dst_ptr.is_null() {
             set_last_error("Null pointer");
-            return -1;
+            return std::ptr::null_mut();
         }
         let src = unsafe { std::slice::from_raw_parts(src_ptr, edge_count) };
         let dst = unsafe { std::slice::from_raw_parts(dst_ptr, edge_count) };
-        match algorithms::compute_dijkstra(src, dst, source_node) {
-            Ok(result) => {
-                let n = result.node_ids.len();
-                if !out_nodes.is_null() && !out_distances.is_null() {
-                    unsafe { std::slice::from_raw_parts_mut(out_nodes, n) }
-                        .copy_from_slice(&result.node_ids);
-                    unsafe { std::slice::from_raw_parts_mut(out_distances, n) }
-                        .copy_from_slice(&result.distances);
-                }
-                n as i64
-            }
-            Err(e) => {
-                set_last_error(&e.to_string());
-                -1
-            }
-        }
+        let weights = if weights_ptr.is_null() || weights_count == 0 {
+            &[]
+        } else {
+            unsafe { std::slice::from_raw_parts(weights_ptr, weights_count) }
+        };
+        into_result_ptr(
+            algorithms::compute_dijkstra(src, dst, weights, source_node),
+            |result| OnagerResult::new(vec![result.node_ids], vec![result.distances]),
+        )
     })
 }
 
@@ -50,30 +44,18 @@ pub extern "C" fn onager_compute_bfs(
     dst_ptr: *const i64,
     edge_count: usize,
     source_node: i64,
-    out_order: *mut i64,
-) -> i64 {
+) -> *mut OnagerResult {
     clear_last_error();
-    crate::ffi_catch_unwind!(-1, {
+    crate::ffi_catch_unwind!(std::ptr::null_mut(), {
         if src_ptr.is_null() || dst_ptr.is_null() {
             set_last_error("Null pointer");
-            return -1;
+            return std::ptr::null_mut();
         }
         let src = unsafe { std::slice::from_raw_parts(src_ptr, edge_count) };
         let dst = unsafe { std::slice::from_raw_parts(dst_ptr, edge_count) };
-        match algorithms::compute_bfs(src, dst, source_node) {
-            Ok(result) => {
-                let n = result.order.len();
-                if !out_order.is_null() {
-                    unsafe { std::slice::from_raw_parts_mut(out_order, n) }
-                        .copy_from_slice(&result.order);
-                }
-                n as i64
-            }
-            Err(e) => {
-                set_last_error(&e.to_string());
-                -1
-            }
-        }
+        into_result_ptr(algorithms::compute_bfs(src, dst, source_node), |result| {
+            OnagerResult::new(vec![result.order], vec![])
+        })
     })
 }
 
@@ -84,30 +66,18 @@ pub extern "C" fn onager_compute_dfs(
     dst_ptr: *const i64,
     edge_count: usize,
     source_node: i64,
-    out_order: *mut i64,
-) -> i64 {
+) -> *mut OnagerResult {
     clear_last_error();
-    crate::ffi_catch_unwind!(-1, {
+    crate::ffi_catch_unwind!(std::ptr::null_mut(), {
         if src_ptr.is_null() || dst_ptr.is_null() {
             set_last_error("Null pointer");
-            return -1;
+            return std::ptr::null_mut();
         }
         let src = unsafe { std::slice::from_raw_parts(src_ptr, edge_count) };
         let dst = unsafe { std::slice::from_raw_parts(dst_ptr, edge_count) };
-        match algorithms::compute_dfs(src, dst, source_node) {
-            Ok(result) => {
-                let n = result.order.len();
-                if !out_order.is_null() {
-                    unsafe { std::slice::from_raw_parts_mut(out_order, n) }
-                        .copy_from_slice(&result.order);
-                }
-                n as i64
-            }
-            Err(e) => {
-                set_last_error(&e.to_string());
-                -1
-            }
-        }
+        into_result_ptr(algorithms::compute_dfs(src, dst, source_node), |result| {
+            OnagerResult::new(vec![result.order], vec![])
+        })
     })
 }
 
@@ -119,78 +89,102 @@ pub extern "C" fn onager_compute_bellman_ford(
     weight_ptr: *const f64,
     edge_count: usize,
     source: i64,
-    out_nodes: *mut i64,
-    out_distances: *mut f64,
-) -> i64 {
+) -> *mut OnagerResult {
     clear_last_error();
-    crate::ffi_catch_unwind!(-1, {
+    crate::ffi_catch_unwind!(std::ptr::null_mut(), {
         if src_ptr.is_null() || dst_ptr.is_null() || weight_ptr.is_null() {
             set_last_error("Null pointer");
-            return -1;
+            return std::ptr::null_mut();
         }
         let src = unsafe { std::slice::from_raw_parts(src_ptr, edge_count) };
         let dst = unsafe { std::slice::from_raw_parts(dst_ptr, edge_count) };
         let weights = unsafe { std::slice::from_raw_parts(weight_ptr, edge_count) };
-        match algorithms::compute_bellman_ford(src, dst, weights, source) {
-            Ok(result) => {
-                let n = result.node_ids.len();
-                if !out_nodes.is_null() && !out_distances.is_null() {
-                    unsafe { std::slice::from_raw_parts_mut(out_nodes, n) }
-                        .copy_from_slice(&result.node_ids);
-                    unsafe { std::slice::from_raw_parts_mut(out_distances, n) }
-                        .copy_from_slice(&result.distances);
-                }
-                n as i64
-            }
-            Err(e) => {
-                set_last_error(&e.to_string());
-                -1
-            }
-        }
+        into_result_ptr(
+            algorithms::compute_bellman_ford(src, dst, weights, source),
+            |result| OnagerResult::new(vec![result.node_ids], vec![result.distances]),
+        )
     })
 }
 
-/// Compute Floyd-Warshall all-pairs shortest paths.
+/// All-pairs distance matrix owned by Rust.
+///
+/// C++ pulls reachable pairs in chunks with `onager_distance_matrix_next` and
+/// releases the matrix with `onager_free_distance_matrix`.
+pub struct OnagerDistanceMatrix(algorithms::DistanceMatrix);
+
+/// Compute the Floyd-Warshall distance matrix for streaming.
+/// A nonzero memory_limit caps the matrix size in bytes; the call fails before
+/// allocating when the graph needs more.
 #[no_mangle]
-pub extern "C" fn onager_compute_floyd_warshall(
+pub extern "C" fn onager_floyd_warshall_matrix(
     src_ptr: *const i64,
     dst_ptr: *const i64,
     weight_ptr: *const f64,
     edge_count: usize,
-    out_src: *mut i64,
-    out_dst: *mut i64,
-    out_distances: *mut f64,
-) -> i64 {
+    memory_limit: usize,
+) -> *mut OnagerDistanceMatrix {
     clear_last_error();
-    crate::ffi_catch_unwind!(-1, {
+    crate::ffi_catch_unwind!(std::ptr::null_mut(), {
         if src_ptr.is_null() || dst_ptr.is_null() || weight_ptr.is_null() {
             set_last_error("Null pointer");
-            return -1;
+            return std::ptr::null_mut();
         }
         let src = unsafe { std::slice::from_raw_parts(src_ptr, edge_count) };
         let dst = unsafe { std::slice::from_raw_parts(dst_ptr, edge_count) };
         let weights = unsafe { std::slice::from_raw_parts(weight_ptr, edge_count) };
-        match algorithms::compute_floyd_warshall(src, dst, weights) {
-            Ok(result) => {
-                let n = result.src_nodes.len();
-                if !out_src.is_null() && !out_dst.is_null() && !out_distances.is_null() {
-                    unsafe { std::slice::from_raw_parts_mut(out_src, n) }
-                        .copy_from_slice(&result.src_nodes);
-                    unsafe { std::slice::from_raw_parts_mut(out_dst, n) }
-                        .copy_from_slice(&result.dst_nodes);
-                    unsafe { std::slice::from_raw_parts_mut(out_distances, n) }
-                        .copy_from_slice(&result.distances);
-                }
-                n as i64
-            }
+        let limit = if memory_limit == 0 {
+            None
+        } else {
+            Some(memory_limit)
+        };
+        match algorithms::floyd_warshall_matrix(src, dst, weights, limit) {
+            Ok(matrix) => Box::into_raw(Box::new(OnagerDistanceMatrix(matrix))),
             Err(e) => {
                 set_last_error(&e.to_string());
-                -1
+                std::ptr::null_mut()
             }
         }
     })
 }
 
+/// Write up to capacity reachable pairs from a distance matrix into the output arrays.
+/// Returns the number of pairs written; fewer than capacity means the matrix is exhausted.
+#[no_mangle]
+pub extern "C" fn onager_distance_matrix_next(
+    matrix: *mut OnagerDistanceMatrix,
+    src_out: *mut i64,
+    dst_out: *mut i64,
+    dist_out: *mut f64,
+    capacity: usize,
+) -> usize {
+    if matrix.is_null()
+        || src_out.is_null()
+        || dst_out.is_null()
+        || dist_out.is_null()
+        || capacity == 0
+    {
+        return 0;
+    }
+    crate::ffi_catch_unwind!(0, {
+        let src = unsafe { std::slice::from_raw_parts_mut(src_out, capacity) };
+        let dst = unsafe { std::slice::from_raw_parts_mut(dst_out, capacity) };
+        let dist = unsafe { std::slice::from_raw_parts_mut(dist_out, capacity) };
+        unsafe { (*matrix).0.next_batch(src, dst, dist) }
+    })
+}
+
+/// Free a distance matrix.
+/// # Safety
+/// The pointer must be null or returned by `onager_floyd_warshall_matrix`.
+#[no_mangle]
+pub unsafe extern "C" fn onager_free_distance_matrix(matrix: *mut OnagerDistanceMatrix) {
+    if !matrix.is_null() {
+        unsafe {
+            drop(Box::from_raw(matrix));
+        }
+    }
+}
+
 /// Compute shortest distance between two nodes (scalar).
 #[no_mangle]
 pub extern "C" fn onager_compute_shortest_distance(
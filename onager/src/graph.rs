@@ -1,131 +1,245 @@
 //! Graph storage and operations module.
 //!
-//! This module provides a thread-safe graph registry that stores named graphs
-//! and wraps the graphina library for graph operations.
-
+//! This module provides a thread-safe registry of named graphs. Each graph is
+//! a base CSR graph and a [`Delta`] of the changes made since the base was
+//! built, so adding nodes, adding edges, and applying insert and delete batches
+//! with [`apply_delta`] do not rebuild the graph, and node and edge counts and
+//! degrees are answered from the base and the delta together.
+//!
+//! Algorithms run on a snapshot of the graph, see [`with_csr`]. A snapshot of a
+//! graph with pending changes compacts them into a new base, which later calls
+//! reuse until the graph changes again. Compaction runs without the registry
+//! lock, and once a delta holds changes for an eighth of the base's edges it is
+//! also started in the background after the batch that grew it, so that reads
+//! find the merged base ready.
+
+use std::collections::hash_map::Entry;
 use std::collections::HashMap;
+use std::panic::AssertUnwindSafe;
+use std::path::Path;
+use std::sync::atomic::{AtomicU64, Ordering};
 use std::sync::Arc;
 
-use graphina::core::types::{Digraph, Graph, NodeId};
 use once_cell::sync::Lazy;
-use parking_lot::RwLock;
+use parking_lot::{Mutex, RwLock};
 
+use crate::control;
+use crate::csr::CsrGraph;
+use crate::delta::{self, Components, Delta};
 use crate::error::{OnagerError, Result};
+use crate::snapshot;
 
-/// Wrapper for an undirected graph with external ID mapping.
-pub struct UndirectedGraphWrapper {
-    graph: Graph<i64, f64>,
-    /// Maps external node IDs (provided by user) to internal graphina NodeIds
-    node_mapping: HashMap<i64, NodeId>,
-}
+/// Fewest pending changes that start a background compaction.
+const COMPACT_MIN_CHANGES: usize = 4096;
+/// A background compaction starts once the pending changes reach the base's
+/// edge count divided by this.
+const COMPACT_RATIO: usize = 8;
 
-/// Wrapper for a directed graph with external ID mapping.
-pub struct DirectedGraphWrapper {
-    graph: Digraph<i64, f64>,
-    /// Maps external node IDs (provided by user) to internal graphina NodeIds
-    node_mapping: HashMap<i64, NodeId>,
+/// Source of graph versions, unique across all graphs of the process.
+static VERSIONS: AtomicU64 = AtomicU64::new(0);
+
+fn next_version() -> u64 {
+    VERSIONS.fetch_add(1, Ordering::Relaxed)
 }
 
-/// A graph that can be either directed or undirected.
-pub enum GraphType {
-    Directed(DirectedGraphWrapper),
-    Undirected(UndirectedGraphWrapper),
+/// A named graph: a compacted base and the changes made since.
+pub struct GraphType {
+    /// Compacted form of the graph, shared with the calls reading it
+    base: Arc<CsrGraph>,
+    /// Changes since `base` was built
+    delta: Delta,
+    /// Changes on every modification, so a compaction can tell if the graph moved on
+    version: u64,
+    /// Set while a background compaction of the graph runs
+    compacting: bool,
+    /// Connected components, built on first query and kept up to date on inserts
+    components: Mutex<Option<Components>>,
 }
 
 impl GraphType {
     /// Creates a new graph with the specified direction.
-    pub fn new(directed: bool) -> Self {
-        if directed {
-            GraphType::Directed(DirectedGraphWrapper {
-                graph: Digraph::new(),
-                node_mapping: HashMap::new(),
-            })
-        } else {
-            GraphType::Undirected(UndirectedGraphWrapper {
-                graph: Graph::new(),
-                node_mapping: HashMap::new(),
-            })
+    pub fn new(directed: bool) -> Result<Self> {
+        Ok(Self::from_csr(CsrGraph::from_edges(
+            &[],
+            &[],
+            Some(&[]),
+            directed,
+        )?))
+    }
+
+    /// Creates a graph with the nodes and edges of a CSR graph as its base.
+    fn from_csr(csr: CsrGraph) -> Self {
+        GraphType {
+            delta: Delta::new(csr.is_directed()),
+            base: Arc::new(csr),
+            version: next_version(),
+            compacting: false,
+            components: Mutex::new(None),
         }
     }
 
     /// Returns true if the graph is directed.
     pub fn is_directed(&self) -> bool {
-        matches!(self, GraphType::Directed(_))
+        self.base.is_directed()
     }
 
     /// Returns the number of nodes in the graph.
     pub fn node_count(&self) -> usize {
-        match self {
-            GraphType::Directed(w) => w.graph.node_count(),
-            GraphType::Undirected(w) => w.graph.node_count(),
-        }
+        self.delta.node_count(&self.base)
     }
 
     /// Returns the number of edges in the graph.
     pub fn edge_count(&self) -> usize {
-        match self {
-            GraphType::Directed(w) => w.graph.edge_count(),
-            GraphType::Undirected(w) => w.graph.edge_count(),
+        self.delta.edge_count(&self.base)
+    }
+
+    /// Adds a node if it is not in the graph yet, returning whether it was added.
+    fn insert_node(&mut self, node_id: i64) -> bool {
+        if !self.delta.add_node(&self.base, node_id) {
+            return false;
+        }
+        if let Some(components) = self.components.get_mut() {
+            components.add_node(node_id);
+        }
+        true
+    }
+
+    /// Inserts an edge between two nodes of the graph.
+    fn insert_edge(&mut self, src: i64, dst: i64, weight: f64) {
+        self.delta.insert_edge(src, dst, weight);
+        if let Some(components) = self.components.get_mut() {
+            components.insert_edge(src, dst);
         }
     }
 
     /// Adds a node with the given external ID to the graph.
-    /// The node_id is used both as the key in our mapping and stored as the node's value.
     pub fn add_node(&mut self, node_id: i64) -> Result<()> {
-        match self {
-            GraphType::Directed(w) => {
-                if w.node_mapping.contains_key(&node_id) {
-                    return Err(OnagerError::InvalidArgument(format!(
-                        "Node {} already exists",
-                        node_id
-                    )));
-                }
-                let internal_id = w.graph.add_node(node_id);
-                w.node_mapping.insert(node_id, internal_id);
-                Ok(())
-            }
-            GraphType::Undirected(w) => {
-                if w.node_mapping.contains_key(&node_id) {
-                    return Err(OnagerError::InvalidArgument(format!(
-                        "Node {} already exists",
-                        node_id
-                    )));
-                }
-                let internal_id = w.graph.add_node(node_id);
-                w.node_mapping.insert(node_id, internal_id);
-                Ok(())
-            }
+        if !self.insert_node(node_id) {
+            return Err(OnagerError::InvalidArgument(format!(
+                "Node {} already exists",
+                node_id
+            )));
         }
+        self.version = next_version();
+        Ok(())
     }
 
     /// Adds an edge between two nodes with the given weight.
     pub fn add_edge(&mut self, src: i64, dst: i64, weight: f64) -> Result<()> {
-        match self {
-            GraphType::Directed(w) => {
-                let src_id = w
-                    .node_mapping
-                    .get(&src)
-                    .ok_or(OnagerError::NodeNotFound(src))?;
-                let dst_id = w
-                    .node_mapping
-                    .get(&dst)
-                    .ok_or(OnagerError::NodeNotFound(dst))?;
-                w.graph.add_edge(*src_id, *dst_id, weight);
-                Ok(())
+        for node in [src, dst] {
+            if !self.delta.contains_node(&self.base, node) {
+                return Err(OnagerError::NodeNotFound(node));
             }
-            GraphType::Undirected(w) => {
-                let src_id = w
-                    .node_mapping
-                    .get(&src)
-                    .ok_or(OnagerError::NodeNotFound(src))?;
-                let dst_id = w
-                    .node_mapping
-                    .get(&dst)
-                    .ok_or(OnagerError::NodeNotFound(dst))?;
-                w.graph.add_edge(*src_id, *dst_id, weight);
-                Ok(())
+        }
+        self.insert_edge(src, dst, weight);
+        self.version = next_version();
+        Ok(())
+    }
+
+    /// Returns the in-degree (`inbound`) or out-degree of a node, or None if it does not exist.
+    /// Undirected graphs report the node's degree for both.
+    fn node_degree(&self, node_id: i64, inbound: bool) -> Option<usize> {
+        self.delta.degree(&self.base, node_id, inbound)
+    }
+
+    /// Adds a batch of nodes and edges to the graph.
+    ///
+    /// Nodes that already exist are skipped, and every edge endpoint must be in
+    /// `nodes` or already in the graph. Returns the number of nodes and edges added.
+    fn load(
+        &mut self,
+        nodes: &[i64],
+        src: &[i64],
+        dst: &[i64],
+        weights: Option<&[f64]>,
+    ) -> Result<(usize, usize)> {
+        let mut nodes_added = 0;
+        for &node_id in nodes {
+            if self.insert_node(node_id) {
+                nodes_added += 1;
+            }
+        }
+        for (i, (&u, &v)) in src.iter().zip(dst).enumerate() {
+            for node in [u, v] {
+                if !self.delta.contains_node(&self.base, node) {
+                    return Err(OnagerError::NodeNotFound(node));
+                }
+            }
+            self.insert_edge(u, v, weights.map_or(1.0, |w| w[i]));
+        }
+        self.version = next_version();
+        Ok((nodes_added, src.len()))
+    }
+
+    /// Applies a batch of edge inserts and deletes in order.
+    ///
+    /// `ops` holds [`delta::INSERT`] or [`delta::DELETE`] for each edge. Inserts
+    /// add their endpoints as nodes if needed and take their weight from
+    /// `weights`, or 1.0 without weights. Deletes remove every edge between their
+    /// endpoints and are no-ops when there is none. Returns the number of edges
+    /// inserted and deleted.
+    fn apply(
+        &mut self,
+        ops: &[i64],
+        src: &[i64],
+        dst: &[i64],
+        weights: Option<&[f64]>,
+    ) -> Result<(usize, usize)> {
+        if let Some(op) = ops
+            .iter()
+            .find(|&&op| op != delta::INSERT && op != delta::DELETE)
+        {
+            return Err(OnagerError::InvalidArgument(format!(
+                "Unknown delta operation {}",
+                op
+            )));
+        }
+        let (mut inserted, mut deleted) = (0, 0);
+        for (i, &op) in ops.iter().enumerate() {
+            let (u, v) = (src[i], dst[i]);
+            if op == delta::INSERT {
+                self.insert_node(u);
+                self.insert_node(v);
+                self.insert_edge(u, v, weights.map_or(1.0, |w| w[i]));
+                inserted += 1;
+            } else {
+                let removed = self.delta.delete_edge(&self.base, u, v);
+                if removed > 0 {
+                    *self.components.get_mut() = None;
+                }
+                deleted += removed;
             }
         }
+        self.version = next_version();
+        Ok((inserted, deleted))
+    }
+
+    /// Returns the base and delta to merge and the version they make up, or None
+    /// if there are no pending changes.
+    fn pending(&self) -> Option<(Arc<CsrGraph>, Delta, u64)> {
+        if self.delta.is_empty() {
+            return None;
+        }
+        Some((Arc::clone(&self.base), self.delta.clone(), self.version))
+    }
+
+    /// Marks the graph as compacting and returns what to merge, if its delta is
+    /// large enough for a background compaction and none is running.
+    fn start_compaction(&mut self) -> Option<(Arc<CsrGraph>, Delta, u64)> {
+        let threshold = COMPACT_MIN_CHANGES.max(self.base.edge_count() / COMPACT_RATIO);
+        if self.compacting || self.delta.changes() < threshold {
+            return None;
+        }
+        self.compacting = true;
+        self.pending()
+    }
+
+    /// Makes a merged graph the new base, unless the graph changed since `version`.
+    fn install(&mut self, merged: Arc<CsrGraph>, version: u64) {
+        if self.version == version {
+            self.base = merged;
+            self.delta = Delta::new(self.base.is_directed());
+        }
     }
 }
 
@@ -139,7 +253,7 @@ pub fn create_graph(name: &str, directed: bool) -> Result<()> {
     if registry.contains_key(name) {
         return Err(OnagerError::GraphAlreadyExists(name.to_string()));
     }
-    registry.insert(name.to_string(), GraphType::new(directed));
+    registry.insert(name.to_string(), GraphType::new(directed)?);
     Ok(())
 }
 
@@ -177,6 +291,185 @@ pub fn add_edge(graph_name: &str, src: i64, dst: i64, weight: f64) -> Result<()>
     graph.add_edge(src, dst, weight)
 }
 
+/// Checks that parallel edge arrays, and weights if given, have the same length.
+fn check_lengths(src: &[i64], dst: &[i64], weights: Option<&[f64]>) -> Result<()> {
+    if src.len() != dst.len() {
+        return Err(OnagerError::InvalidArgument(
+            "src and dst arrays must have same length".to_string(),
+        ));
+    }
+    if weights.is_some_and(|w| w.len() != src.len()) {
+        return Err(OnagerError::InvalidArgument(
+            "src, dst, and weights arrays must have same length".to_string(),
+        ));
+    }
+    Ok(())
+}
+
+/// Loads edges into the named graph in one batch.
+///
+/// The graph is created if it does not exist, as directed unless `directed` is
+/// `Some(false)`. If it exists and `directed` is given, the direction must match.
+/// Edge endpoints that are not yet in the graph are added as nodes, and missing
+/// weights default to 1.0. The registry write lock is taken once for the whole
+/// batch. Returns the number of nodes and edges added.
+pub fn load_edges(
+    graph_name: &str,
+    src: &[i64],
+    dst: &[i64],
+    weights: Option<&[f64]>,
+    directed: Option<bool>,
+) -> Result<(usize, usize)> {
+    check_lengths(src, dst, weights)?;
+
+    let mut nodes = Vec::with_capacity(src.len() * 2);
+    nodes.extend_from_slice(src);
+    nodes.extend_from_slice(dst);
+    nodes.sort_unstable();
+    nodes.dedup();
+
+    let mut registry = GRAPH_REGISTRY.write();
+    if let (Some(graph), Some(directed)) = (registry.get(graph_name), directed) {
+        if graph.is_directed() != directed {
+            return Err(OnagerError::InvalidArgument(format!(
+                "Graph {} is {}",
+                graph_name,
+                if graph.is_directed() {
+                    "directed"
+                } else {
+                    "undirected"
+                }
+            )));
+        }
+    }
+    let graph = match registry.entry(graph_name.to_string()) {
+        Entry::Occupied(slot) => slot.into_mut(),
+        Entry::Vacant(slot) => slot.insert(GraphType::new(directed.unwrap_or(true))?),
+    };
+    let counts = graph.load(&nodes, src, dst, weights)?;
+    let compaction = graph.start_compaction();
+    drop(registry);
+    if let Some(pending) = compaction {
+        compact_in_background(graph_name, pending);
+    }
+    Ok(counts)
+}
+
+/// Applies a batch of edge inserts and deletes to the named graph, in order.
+///
+/// `ops` holds [`delta::INSERT`] or [`delta::DELETE`] for each edge, and the
+/// batch is rejected before any change if it holds another code. Inserted edges
+/// add their endpoints as nodes if needed, with missing weights defaulting to
+/// 1.0, and a delete removes every edge between its endpoints. Calls reading
+/// the graph keep the snapshot they started with. Returns the number of edges
+/// inserted and deleted.
+pub fn apply_delta(
+    graph_name: &str,
+    ops: &[i64],
+    src: &[i64],
+    dst: &[i64],
+    weights: Option<&[f64]>,
+) -> Result<(usize, usize)> {
+    check_lengths(src, dst, weights)?;
+    if ops.len() != src.len() {
+        return Err(OnagerError::InvalidArgument(
+            "ops, src, and dst arrays must have same length".to_string(),
+        ));
+    }
+    let mut registry = GRAPH_REGISTRY.write();
+    let graph = registry
+        .get_mut(graph_name)
+        .ok_or_else(|| OnagerError::GraphNotFound(graph_name.to_string()))?;
+    let counts = graph.apply(ops, src, dst, weights)?;
+    let compaction = graph.start_compaction();
+    drop(registry);
+    if let Some(pending) = compaction {
+        compact_in_background(graph_name, pending);
+    }
+    Ok(counts)
+}
+
+/// Merges a graph's pending changes on a background thread and installs the
+/// result if the graph has not changed in the meantime.
+///
+/// The merge runs under a detached copy of the current call's control, so it
+/// keeps to the call's thread budget and its build is checked against the
+/// memory left under the call's limit. A failed or panicked build is dropped,
+/// since the next snapshot of the graph compacts again and reports the error to
+/// its call.
+fn compact_in_background(graph_name: &str, (base, delta, version): (Arc<CsrGraph>, Delta, u64)) {
+    let name = graph_name.to_string();
+    let call = control::detached();
+    let spawned = std::thread::Builder::new()
+        .name("onager-compact".to_string())
+        .spawn(move || {
+            let merged = control::scope(call, || {
+                std::panic::catch_unwind(AssertUnwindSafe(|| delta.compact(&base)))
+            });
+            let mut registry = GRAPH_REGISTRY.write();
+            if let Some(graph) = registry.get_mut(&name) {
+                graph.compacting = false;
+                if let Ok(Ok(merged)) = merged {
+                    graph.install(Arc::new(merged), version);
+                }
+            }
+        });
+    if spawned.is_err() {
+        if let Some(graph) = GRAPH_REGISTRY.write().get_mut(graph_name) {
+            graph.compacting = false;
+        }
+    }
+}
+
+/// Returns the CSR form of the named graph with every change made so far, and
+/// the version of the graph it shows.
+///
+/// Pending changes are merged without the registry lock, and the merged graph
+/// becomes the new base unless the graph changed while it was built.
+fn snapshot_version(graph_name: &str) -> Result<(Arc<CsrGraph>, u64)> {
+    let (base, delta, version) = {
+        let registry = GRAPH_REGISTRY.read();
+        let graph = registry
+            .get(graph_name)
+            .ok_or_else(|| OnagerError::GraphNotFound(graph_name.to_string()))?;
+        match graph.pending() {
+            Some(pending) => pending,
+            None => return Ok((Arc::clone(&graph.base), graph.version)),
+        }
+    };
+    let merged = Arc::new(delta.compact(&base)?);
+    if let Some(graph) = GRAPH_REGISTRY.write().get_mut(graph_name) {
+        graph.install(Arc::clone(&merged), version);
+    }
+    Ok((merged, version))
+}
+
+/// Writes the named graph to a snapshot file, see [`crate::snapshot`].
+///
+/// The snapshot holds the graph's CSR form, which pending changes are merged into first.
+pub fn save_graph(graph_name: &str, path: &Path) -> Result<()> {
+    let (csr, _) = snapshot_version(graph_name)?;
+    snapshot::write(path, &csr)
+}
+
+/// Creates a graph with the given name from a snapshot file written by [`save_graph`].
+///
+/// The snapshot is read without holding the registry lock, and its CSR becomes
+/// the base of the graph.
+pub fn open_graph(graph_name: &str, path: &Path) -> Result<()> {
+    if GRAPH_REGISTRY.read().contains_key(graph_name) {
+        return Err(OnagerError::GraphAlreadyExists(graph_name.to_string()));
+    }
+    let graph = GraphType::from_csr(snapshot::read(path)?);
+    match GRAPH_REGISTRY.write().entry(graph_name.to_string()) {
+        Entry::Occupied(_) => Err(OnagerError::GraphAlreadyExists(graph_name.to_string())),
+        Entry::Vacant(slot) => {
+            slot.insert(graph);
+            Ok(())
+        }
+    }
+}
+
 /// Returns the number of nodes in the graph.
 pub fn node_count(graph_name: &str) -> Result<usize> {
     let registry = GRAPH_REGISTRY.read();
@@ -195,33 +488,63 @@ pub fn edge_count(graph_name: &str) -> Result<usize> {
     Ok(graph.edge_count())
 }
 
+/// Runs `f` on a snapshot of the CSR form of the named graph.
+///
+/// The snapshot holds every change made before the call, and changes made while
+/// `f` runs do not affect it, so they need not wait for `f` to finish. The
+/// registry lock is not held while `f` runs. A snapshot is built on the first
+/// call after a modification and reused by later calls.
+pub fn with_csr<T>(graph_name: &str, f: impl FnOnce(&CsrGraph) -> Result<T>) -> Result<T> {
+    let (csr, _) = snapshot_version(graph_name)?;
+    crate::profile::note_graph(csr.node_count(), csr.edge_count());
+    f(&csr)
+}
+
+/// Returns every node of the named graph in ascending ID order with its
+/// connected component, treating edges as undirected.
+///
+/// Components are numbered from 0 in the order of their smallest node ID. They
+/// are computed on the first call and then kept up to date as edges and nodes
+/// are inserted, so later calls do not revisit the graph. Deleting an edge
+/// discards them until the next call.
+pub fn connected_components(graph_name: &str) -> Result<(Vec<i64>, Vec<i64>)> {
+    {
+        let registry = GRAPH_REGISTRY.read();
+        let graph = registry
+            .get(graph_name)
+            .ok_or_else(|| OnagerError::GraphNotFound(graph_name.to_string()))?;
+        if graph.edge_count() == 0 {
+            return Err(OnagerError::InvalidArgument(
+                "Cannot compute on empty graph".to_string(),
+            ));
+        }
+        let mut components = graph.components.lock();
+        if let Some(components) = components.as_mut() {
+            crate::profile::note_graph(graph.node_count(), graph.edge_count());
+            return Ok(components.labels());
+        }
+    }
+    let (csr, version) = snapshot_version(graph_name)?;
+    crate::profile::note_graph(csr.node_count(), csr.edge_count());
+    let mut components = Components::from_csr(&csr);
+    let labels = components.labels();
+    if let Some(graph) = GRAPH_REGISTRY.read().get(graph_name) {
+        if graph.version == version {
+            *graph.components.lock() = Some(components);
+        }
+    }
+    Ok(labels)
+}
+
 /// Returns the in-degree of a node in the named graph.
 pub fn get_node_in_degree(graph_name: &str, external_node_id: i64) -> Result<usize> {
     let registry = GRAPH_REGISTRY.read();
     let graph = registry
         .get(graph_name)
         .ok_or_else(|| OnagerError::GraphNotFound(graph_name.to_string()))?;
-
-    match graph {
-        GraphType::Directed(w) => {
-            let node_id = w
-                .node_mapping
-                .get(&external_node_id)
-                .ok_or(OnagerError::NodeNotFound(external_node_id))?;
-            w.graph
-                .in_degree(*node_id)
-                .ok_or(OnagerError::NodeNotFound(external_node_id))
-        }
-        GraphType::Undirected(w) => {
-            let node_id = w
-                .node_mapping
-                .get(&external_node_id)
-                .ok_or(OnagerError::NodeNotFound(external_node_id))?;
-            w.graph
-                .degree(*node_id)
-                .ok_or(OnagerError::NodeNotFound(external_node_id))
-        }
-    }
+    graph
+        .node_degree(external_node_id, true)
+        .ok_or(OnagerError::NodeNotFound(external_node_id))
 }
 
 /// Returns the out-degree of a node in the named graph.
@@ -230,32 +553,42 @@ pub fn get_node_out_degree(graph_name: &str, external_node_id: i64) -> Result<us
     let graph = registry
         .get(graph_name)
         .ok_or_else(|| OnagerError::GraphNotFound(graph_name.to_string()))?;
+    graph
+        .node_degree(external_node_id, false)
+        .ok_or(OnagerError::NodeNotFound(external_node_id))
+}
 
-    match graph {
-        GraphType::Directed(w) => {
-            let node_id = w
-                .node_mapping
-                .get(&external_node_id)
-                .ok_or(OnagerError::NodeNotFound(external_node_id))?;
-            w.graph
-                .out_degree(*node_id)
-                .ok_or(OnagerError::NodeNotFound(external_node_id))
-        }
-        GraphType::Undirected(w) => {
-            let node_id = w
-                .node_mapping
-                .get(&external_node_id)
-                .ok_or(OnagerError::NodeNotFound(external_node_id))?;
-            w.graph
-                .degree(*node_id)
-                .ok_or(OnagerError::NodeNotFound(external_node_id))
-        }
+/// Writes the in-degree or out-degree of each node in `nodes` to `out`.
+///
+/// The graph is resolved once and the registry read lock is held for the whole
+/// batch. Nodes that are not in the graph get -1.
+pub fn get_node_degrees(
+    graph_name: &str,
+    nodes: &[i64],
+    inbound: bool,
+    out: &mut [i64],
+) -> Result<()> {
+    if nodes.len() != out.len() {
+        return Err(OnagerError::InvalidArgument(
+            "nodes and output arrays must have same length".to_string(),
+        ));
     }
+    let registry = GRAPH_REGISTRY.read();
+    let graph = registry
+        .get(graph_name)
+        .ok_or_else(|| OnagerError::GraphNotFound(graph_name.to_string()))?;
+    for (slot, &node) in out.iter_mut().zip(nodes) {
+        *slot = graph
+            .node_degree(node, inbound)
+            .map_or(-1, |degree| degree as i64);
+    }
+    Ok(())
 }
 
 #[cfg(test)]
 mod tests {
     use super::*;
+    use crate::csr::WeightSlice;
 
     #[test]
     fn test_create_and_drop_graph() {
@@ -284,4 +617,220 @@ mod tests {
 
         drop_graph(name).unwrap();
     }
+
+    #[test]
+    fn test_load_edges() {
+        let name = "test_graph_load";
+        create_graph(name, false).unwrap();
+        add_node(name, 1).unwrap();
+
+        let (nodes, edges) =
+            load_edges(name, &[1, 2, 2], &[2, 3, 1], Some(&[0.5, 1.0, 2.0]), None).unwrap();
+        assert_eq!((nodes, edges), (2, 3));
+        assert_eq!(node_count(name).unwrap(), 3);
+        assert_eq!(edge_count(name).unwrap(), 3);
+
+        let (nodes, edges) = load_edges(name, &[3], &[4], None, Some(false)).unwrap();
+        assert_eq!((nodes, edges), (1, 1));
+        assert!(load_edges(name, &[1], &[2], None, Some(true)).is_err());
+        assert!(load_edges(name, &[1, 2], &[2], None, None).is_err());
+        assert_eq!(edge_count(name).unwrap(), 4);
+        drop_graph(name).unwrap();
+
+        let created = "test_graph_load_created";
+        load_edges(created, &[5], &[6], None, None).unwrap();
+        with_csr(created, |csr| {
+            assert!(csr.is_directed());
+            assert_eq!(csr.out_weights(0), Some(WeightSlice::Double(&[1.0])));
+            Ok(())
+        })
+        .unwrap();
+        drop_graph(created).unwrap();
+    }
+
+    #[test]
+    fn test_node_degrees_batch() {
+        let name = "test_graph_degrees";
+        load_edges(name, &[1, 1, 2], &[2, 3, 3], None, Some(true)).unwrap();
+
+        let mut out = [0; 4];
+        get_node_degrees(name, &[1, 2, 3, 99], true, &mut out).unwrap();
+        assert_eq!(out, [0, 1, 2, -1]);
+        get_node_degrees(name, &[1, 2, 3, 99], false, &mut out).unwrap();
+        assert_eq!(out, [2, 1, 0, -1]);
+        assert!(get_node_degrees(name, &[1], false, &mut out).is_err());
+        assert!(get_node_degrees("test_graph_degrees_missing", &[], true, &mut []).is_err());
+        drop_graph(name).unwrap();
+    }
+
+    #[test]
+    fn test_csr_cache_follows_modifications() {
+        let name = "test_graph_csr";
+        create_graph(name, true).unwrap();
+        add_node(name, 10).unwrap();
+        add_node(name, 20).unwrap();
+        add_node(name, 30).unwrap();
+        add_edge(name, 10, 20, 2.5).unwrap();
+
+        with_csr(name, |csr| {
+            assert!(csr.is_directed());
+            assert_eq!(csr.ids(), &[10, 20, 30]);
+            assert_eq!(csr.edge_count(), 1);
+            assert_eq!(csr.out_weights(0), Some(WeightSlice::Double(&[2.5])));
+            Ok(())
+        })
+        .unwrap();
+
+        add_edge(name, 20, 30, 1.0).unwrap();
+        let edges = with_csr(name, |csr| Ok(csr.edge_count())).unwrap();
+        assert_eq!(edges, 2);
+
+        assert!(with_csr("test_graph_csr_missing", |_| Ok(())).is_err());
+        drop_graph(name).unwrap();
+    }
+
+    #[test]
+    fn test_save_and_open_graph() {
+        let dir = tempfile::tempdir().unwrap();
+        let path = dir.path().join("graph.onager");
+        let name = "test_graph_snapshot";
+        load_edges(
+            name,
+            &[1, 2, 2],
+            &[2, 3, 3],
+            Some(&[0.5, 1.0, 2.0]),
+            Some(false),
+        )
+        .unwrap();
+        add_node(name, 9).unwrap();
+        save_graph(name, &path).unwrap();
+        assert!(save_graph("test_graph_snapshot_missing", &path).is_err());
+        assert!(open_graph(name, &path).is_err());
+
+        let opened = "test_graph_snapshot_opened";
+        open_graph(opened, &path).unwrap();
+        assert_eq!(node_count(opened).unwrap(), 4);
+        assert_eq!(edge_count(opened).unwrap(), 3);
+        assert_eq!(get_node_out_degree(opened, 2).unwrap(), 3);
+        with_csr(opened, |csr| {
+            assert!(!csr.is_directed());
+            assert_eq!(csr.ids(), &[1, 2, 3, 9]);
+            assert_eq!(csr.out_weights(1), Some(WeightSlice::Double(&[1.0, 2.0])));
+            Ok(())
+        })
+        .unwrap();
+
+        // The opened graph can be modified like any other
+        add_edge(opened, 9, 1, 1.0).unwrap();
+        assert_eq!(with_csr(opened, |csr| Ok(csr.edge_count())).unwrap(), 4);
+        drop_graph(opened).unwrap();
+        drop_graph(name).unwrap();
+    }
+
+    #[test]
+    fn test_apply_delta() {
+        let name = "test_graph_delta";
+        load_edges(name, &[1, 2, 3], &[2, 3, 4], None, Some(false)).unwrap();
+        let before = with_csr(name, |csr| Ok(csr.edge_count())).unwrap();
+        assert_eq!(before, 3);
+
+        let ops = [delta::INSERT, delta::DELETE, delta::INSERT, delta::DELETE];
+        let counts = apply_delta(
+            name,
+            &ops,
+            &[4, 3, 5, 8],
+            &[5, 2, 1, 9],
+            Some(&[0.5, 1.0, 2.0, 1.0]),
+        )
+        .unwrap();
+        assert_eq!(counts, (2, 1));
+        assert_eq!(node_count(name).unwrap(), 5);
+        assert_eq!(edge_count(name).unwrap(), 4);
+        assert_eq!(get_node_out_degree(name, 3).unwrap(), 1);
+        assert_eq!(get_node_in_degree(name, 5).unwrap(), 2);
+        with_csr(name, |csr| {
+            assert_eq!(csr.ids(), &[1, 2, 3, 4, 5]);
+            assert_eq!(csr.edge_count(), 4);
+            Ok(())
+        })
+        .unwrap();
+
+        assert!(apply_delta(name, &[delta::INSERT, 7], &[1, 1], &[2, 3], None).is_err());
+        assert!(apply_delta(name, &[delta::INSERT], &[1, 1], &[2, 3], None).is_err());
+        assert_eq!(edge_count(name).unwrap(), 4);
+        assert!(apply_delta("test_graph_delta_missing", &[], &[], &[], None).is_err());
+        drop_graph(name).unwrap();
+    }
+
+    #[test]
+    fn test_delta_rows_apply_in_order() {
+        let name = "test_graph_delta_order";
+        create_graph(name, false).unwrap();
+        let ops = [delta::INSERT, delta::DELETE];
+        assert_eq!(
+            apply_delta(name, &ops, &[1, 2], &[2, 1], None).unwrap(),
+            (1, 1)
+        );
+        assert_eq!(edge_count(name).unwrap(), 0);
+        let ops = [delta::DELETE, delta::INSERT];
+        assert_eq!(
+            apply_delta(name, &ops, &[1, 2], &[2, 1], None).unwrap(),
+            (1, 0)
+        );
+        assert_eq!(edge_count(name).unwrap(), 1);
+        drop_graph(name).unwrap();
+    }
+
+    #[test]
+    fn test_snapshots_are_unaffected_by_later_deltas() {
+        let name = "test_graph_delta_snapshot";
+        load_edges(name, &[1, 2], &[2, 3], None, Some(true)).unwrap();
+        let (snapshot, _) = snapshot_version(name).unwrap();
+        apply_delta(name, &[delta::DELETE], &[1], &[2], None).unwrap();
+        assert_eq!(snapshot.edge_count(), 2);
+        assert_eq!(with_csr(name, |csr| Ok(csr.edge_count())).unwrap(), 1);
+        drop_graph(name).unwrap();
+    }
+
+    #[test]
+    fn test_components_follow_deltas() {
+        let name = "test_graph_delta_components";
+        load_edges(name, &[1, 3], &[2, 4], None, Some(false)).unwrap();
+        assert_eq!(
+            connected_components(name).unwrap(),
+            (vec![1, 2, 3, 4], vec![0, 0, 1, 1])
+        );
+        apply_delta(name, &[delta::INSERT], &[2], &[3], None).unwrap();
+        assert!(GRAPH_REGISTRY.read()[name].components.lock().is_some());
+        assert_eq!(connected_components(name).unwrap().1, vec![0, 0, 0, 0]);
+
+        apply_delta(name, &[delta::DELETE], &[3], &[2], None).unwrap();
+        assert!(GRAPH_REGISTRY.read()[name].components.lock().is_none());
+        assert_eq!(connected_components(name).unwrap().1, vec![0, 0, 1, 1]);
+        assert!(connected_components("test_graph_delta_components_missing").is_err());
+        drop_graph(name).unwrap();
+    }
+
+    #[test]
+    fn test_large_deltas_compact_in_the_background() {
+        let name = "test_graph_delta_compaction";
+        create_graph(name, true).unwrap();
+        let src: Vec<i64> = (0..COMPACT_MIN_CHANGES as i64).collect();
+        let dst: Vec<i64> = src.iter().map(|v| v + 1).collect();
+        let ops = vec![delta::INSERT; src.len()];
+        apply_delta(name, &ops, &src, &dst, None).unwrap();
+        for _ in 0..1000 {
+            if GRAPH_REGISTRY.read()[name].delta.is_empty() {
+                break;
+            }
+            std::thread::sleep(std::time::Duration::from_millis(5));
+        }
+        let registry = GRAPH_REGISTRY.read();
+        let graph = &registry[name];
+        assert!(graph.delta.is_empty());
+        assert!(!graph.compacting);
+        assert_eq!(graph.base.edge_count(), src.len());
+        drop(registry);
+        drop_graph(name).unwrap();
+    }
 }
@@ -4,8 +4,17 @@
 //! powered by the graphina library.
 
 pub mod algorithms;
+pub mod cache;
+pub mod control;
+pub mod csr;
+pub mod delta;
 pub mod error;
 pub mod ffi;
 pub mod graph;
+pub mod mmap;
+pub mod profile;
+pub mod rng;
+pub mod snapshot;
+pub mod workers;
 
 pub use error::OnagerError;
@@ -0,0 +1,166 @@
+//! Read-only memory maps of files.
+//!
+//! Graph snapshots are mapped rather than read, so a graph opened from one
+//! borrows its arrays from the operating system's page cache instead of copying
+//! them onto the heap, and several processes opening the same snapshot share
+//! one copy. Mapping needs Unix; [`Mapping::new`] returns `None` elsewhere and
+//! callers read the file instead.
+//!
+//! A mapping stays valid while the file it maps is replaced by a rename, but
+//! not while the file is truncated in place, which is why snapshots are always
+//! written to a new file that is renamed over the old one.
+
+use std::fs::File;
+use std::marker::PhantomData;
+use std::mem::{align_of, size_of};
+use std::sync::Arc;
+
+/// Types any bit pattern of the right size and alignment is a valid value of.
+///
+/// # Safety
+/// An implementor must have no padding, no invalid bit patterns, and no drop glue.
+pub unsafe trait Plain: Copy + 'static {}
+
+unsafe impl Plain for i64 {}
+unsafe impl Plain for u64 {}
+unsafe impl Plain for usize {}
+unsafe impl Plain for u32 {}
+unsafe impl Plain for f64 {}
+unsafe impl Plain for f32 {}
+
+/// A read-only, shared memory map of a whole file.
+pub struct Mapping {
+    ptr: *const u8,
+    len: usize,
+}
+
+// SAFETY: the mapped memory is never written, so it may be read from any thread.
+unsafe impl Send for Mapping {}
+unsafe impl Sync for Mapping {}
+
+impl Mapping {
+    /// Maps the first `len` bytes of `file`, or returns `None` where mapping is not supported.
+    #[cfg(unix)]
+    pub fn new(file: &File, len: usize) -> std::io::Result<Option<Mapping>> {
+        use std::os::unix::io::AsRawFd;
+
+        if len == 0 {
+            return Ok(None);
+        }
+        // SAFETY: a fresh read-only mapping of an open file does not alias any Rust memory.
+        let ptr = unsafe {
+            libc::mmap(
+                std::ptr::null_mut(),
+                len,
+                libc::PROT_READ,
+                libc::MAP_SHARED,
+                file.as_raw_fd(),
+                0,
+            )
+        };
+        if ptr == libc::MAP_FAILED {
+            return Err(std::io::Error::last_os_error());
+        }
+        Ok(Some(Mapping {
+            ptr: ptr as *const u8,
+            len,
+        }))
+    }
+
+    /// Maps the first `len` bytes of `file`, or returns `None` where mapping is not supported.
+    #[cfg(not(unix))]
+    pub fn new(_file: &File, _len: usize) -> std::io::Result<Option<Mapping>> {
+        Ok(None)
+    }
+
+    /// Returns the mapped bytes.
+    pub fn bytes(&self) -> &[u8] {
+        // SAFETY: the mapping covers `len` readable bytes until it is dropped.
+        unsafe { std::slice::from_raw_parts(self.ptr, self.len) }
+    }
+}
+
+impl Drop for Mapping {
+    fn drop(&mut self) {
+        #[cfg(unix)]
+        // SAFETY: `ptr` and `len` describe a mapping made by `new` that nothing borrows any more.
+        unsafe {
+            libc::munmap(self.ptr as *mut libc::c_void, self.len);
+        }
+    }
+}
+
+/// Array of values borrowed from a mapping, which it keeps alive.
+pub struct MappedSlice<T> {
+    mapping: Arc<Mapping>,
+    offset: usize,
+    len: usize,
+    _values: PhantomData<T>,
+}
+
+impl<T: Plain> MappedSlice<T> {
+    /// Borrows `len` values starting `offset` bytes into the mapping.
+    ///
+    /// Returns `None` if they do not fit in the mapping or are not aligned for `T`.
+    pub fn new(mapping: &Arc<Mapping>, offset: usize, len: usize) -> Option<Self> {
+        let end = len.checked_mul(size_of::<T>())?.checked_add(offset)?;
+        let start = mapping.bytes().get(offset..end)?.as_ptr();
+        if !(start as usize).is_multiple_of(align_of::<T>()) {
+            return None;
+        }
+        Some(MappedSlice {
+            mapping: Arc::clone(mapping),
+            offset,
+            len,
+            _values: PhantomData,
+        })
+    }
+}
+
+impl<T> MappedSlice<T> {
+    /// Returns the values.
+    pub fn as_slice(&self) -> &[T] {
+        // SAFETY: `new` checked that the range is inside the mapping and aligned,
+        // and every bit pattern is a valid `T` since `T: Plain`.
+        unsafe {
+            let start = self.mapping.bytes().as_ptr().add(self.offset);
+            std::slice::from_raw_parts(start as *const T, self.len)
+        }
+    }
+}
+
+impl<T> Clone for MappedSlice<T> {
+    fn clone(&self) -> Self {
+        MappedSlice {
+            mapping: Arc::clone(&self.mapping),
+            offset: self.offset,
+            len: self.len,
+            _values: PhantomData,
+        }
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use std::io::Write;
+
+    #[test]
+    fn test_mapped_slice_borrows_aligned_values() {
+        let mut file = tempfile::tempfile().unwrap();
+        for value in [7u64, 8, 9] {
+            file.write_all(&value.to_le_bytes()).unwrap();
+        }
+        let Some(mapping) = Mapping::new(&file, 24).unwrap() else {
+            return;
+        };
+        let mapping = Arc::new(mapping);
+        let values = MappedSlice::<u64>::new(&mapping, 8, 2).unwrap();
+        drop(mapping);
+        if cfg!(target_endian = "little") {
+            assert_eq!(values.clone().as_slice(), &[8, 9]);
+        }
+        assert!(MappedSlice::<u64>::new(&values.mapping, 4, 1).is_none());
+        assert!(MappedSlice::<u64>::new(&values.mapping, 8, 3).is_none());
+    }
+}
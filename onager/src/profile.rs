@@ -0,0 +1,373 @@
+//! Per-call profiles of Onager computations.
+//!
+//! C++ opens a profile on the thread that is about to run a computation, with
+//! the ID of the DuckDB connection and the time spent collecting the input. The
+//! next FFI call on that thread fills it in: graph builds, iterations, and
+//! worker threads are noted by the code that does them, and the call's total
+//! time minus its build time is reported as compute time. The finished profile
+//! is kept as the last one of its connection, and the result the call returns
+//! adds the time spent emitting its rows.
+//!
+//! Peak memory comes from a counting global allocator. Each open profile holds
+//! one of a fixed set of peak slots, which the allocator raises to the bytes
+//! allocated whenever they grow, so a call that starts while another runs never
+//! lowers the other's peak. The count covers every Rust allocation in the
+//! process, so calls that overlap can only inflate each other's peaks. When all
+//! slots are taken, a profile reports the growth between its start and finish.
+
+use std::alloc::{GlobalAlloc, Layout, System};
+use std::cell::RefCell;
+use std::collections::HashMap;
+use std::sync::atomic::{AtomicU64, AtomicUsize, Ordering};
+use std::time::{Duration, Instant};
+
+use once_cell::sync::Lazy;
+use parking_lot::Mutex;
+
+/// Phase timings and sizes of one profiled call.
+///
+/// Times are in nanoseconds. `iterations` is -1 for algorithms that do not iterate.
+#[repr(C)]
+#[derive(Clone, Copy, Debug, Default, PartialEq)]
+pub struct OnagerProfile {
+    pub ingest_ns: u64,
+    pub build_ns: u64,
+    pub compute_ns: u64,
+    pub output_ns: u64,
+    pub nodes: u64,
+    pub edges: u64,
+    pub iterations: i64,
+    pub threads: u64,
+    pub peak_bytes: u64,
+    pub rows: u64,
+}
+
+/// Identifies one finished profile, so a result only updates the profile of its own call.
+#[derive(Clone, Copy, Debug, PartialEq, Eq)]
+pub struct ProfileId {
+    connection: u64,
+    sequence: u64,
+}
+
+struct Recorder {
+    id: ProfileId,
+    started: Instant,
+    base_bytes: usize,
+    slot: Option<usize>,
+    profile: OnagerProfile,
+}
+
+impl Drop for Recorder {
+    fn drop(&mut self) {
+        if let Some(slot) = self.slot {
+            OPEN_SLOTS.fetch_and(!(1 << slot), Ordering::Release);
+        }
+    }
+}
+
+struct Entry {
+    sequence: u64,
+    function: String,
+    profile: OnagerProfile,
+}
+
+thread_local! {
+    static ACTIVE: RefCell<Option<Recorder>> = const { RefCell::new(None) };
+}
+
+static SEQUENCE: AtomicU64 = AtomicU64::new(0);
+
+static LAST: Lazy<Mutex<HashMap<u64, Entry>>> = Lazy::new(|| Mutex::new(HashMap::new()));
+
+static ALLOCATED: AtomicUsize = AtomicUsize::new(0);
+
+/// Number of profiles whose peaks can be tracked at the same time.
+const PEAK_SLOTS: usize = 64;
+
+/// Peak bytes allocated since the profile holding each slot began.
+static PEAKS: [AtomicUsize; PEAK_SLOTS] = [const { AtomicUsize::new(0) }; PEAK_SLOTS];
+/// Bit `i` is set while slot `i` of `PEAKS` belongs to an open profile.
+static OPEN_SLOTS: AtomicU64 = AtomicU64::new(0);
+
+/// Claims a free peak slot and starts it at the bytes allocated now.
+///
+/// Returns the slot, if one was free, and the bytes allocated when it started.
+fn claim_slot() -> (Option<usize>, usize) {
+    let mut open = OPEN_SLOTS.load(Ordering::Relaxed);
+    while open != u64::MAX {
+        let slot = (!open).trailing_zeros() as usize;
+        match OPEN_SLOTS.compare_exchange_weak(
+            open,
+            open | (1 << slot),
+            Ordering::Acquire,
+            Ordering::Relaxed,
+        ) {
+            Ok(_) => {
+                let base_bytes = ALLOCATED.load(Ordering::Relaxed);
+                PEAKS[slot].store(base_bytes, Ordering::Relaxed);
+                return (Some(slot), base_bytes);
+            }
+            Err(current) => open = current,
+        }
+    }
+    (None, ALLOCATED.load(Ordering::Relaxed))
+}
+
+/// System allocator that tracks the bytes currently allocated and the peak of every open profile.
+pub struct CountingAllocator;
+
+impl CountingAllocator {
+    #[inline]
+    fn grow(size: usize) {
+        let now = ALLOCATED.fetch_add(size, Ordering::Relaxed) + size;
+        let mut open = OPEN_SLOTS.load(Ordering::Relaxed);
+        while open != 0 {
+            let peak = &PEAKS[open.trailing_zeros() as usize];
+            if now > peak.load(Ordering::Relaxed) {
+                peak.fetch_max(now, Ordering::Relaxed);
+            }
+            open &= open - 1;
+        }
+    }
+}
+
+unsafe impl GlobalAlloc for CountingAllocator {
+    unsafe fn alloc(&self, layout: Layout) -> *mut u8 {
+        let ptr = unsafe { System.alloc(layout) };
+        if !ptr.is_null() {
+            Self::grow(layout.size());
+        }
+        ptr
+    }
+
+    unsafe fn alloc_zeroed(&self, layout: Layout) -> *mut u8 {
+        let ptr = unsafe { System.alloc_zeroed(layout) };
+        if !ptr.is_null() {
+            Self::grow(layout.size());
+        }
+        ptr
+    }
+
+    unsafe fn dealloc(&self, ptr: *mut u8, layout: Layout) {
+        unsafe { System.dealloc(ptr, layout) };
+        ALLOCATED.fetch_sub(layout.size(), Ordering::Relaxed);
+    }
+
+    unsafe fn realloc(&self, ptr: *mut u8, layout: Layout, new_size: usize) -> *mut u8 {
+        let new_ptr = unsafe { System.realloc(ptr, layout, new_size) };
+        if !new_ptr.is_null() {
+            if new_size > layout.size() {
+                Self::grow(new_size - layout.size());
+            } else {
+                ALLOCATED.fetch_sub(layout.size() - new_size, Ordering::Relaxed);
+            }
+        }
+        new_ptr
+    }
+}
+
+#[global_allocator]
+static GLOBAL: CountingAllocator = CountingAllocator;
+
+fn nanos(duration: Duration) -> u64 {
+    u64::try_from(duration.as_nanos()).unwrap_or(u64::MAX)
+}
+
+fn with_active(f: impl FnOnce(&mut Recorder)) {
+    ACTIVE.with(|cell| {
+        if let Some(recorder) = cell.borrow_mut().as_mut() {
+            f(recorder);
+        }
+    });
+}
+
+/// Returns the number of bytes Rust code in the process has allocated and not freed.
+pub fn allocated_bytes() -> usize {
+    ALLOCATED.load(Ordering::Relaxed)
+}
+
+/// Opens a profile for the next FFI call on this thread.
+pub fn begin(connection: u64, ingest_ns: u64) {
+    let (slot, base_bytes) = claim_slot();
+    let recorder = Recorder {
+        id: ProfileId {
+            connection,
+            sequence: SEQUENCE.fetch_add(1, Ordering::Relaxed),
+        },
+        started: Instant::now(),
+        base_bytes,
+        slot,
+        profile: OnagerProfile {
+            ingest_ns,
+            iterations: -1,
+            threads: 1,
+            ..OnagerProfile::default()
+        },
+    };
+    ACTIVE.with(|cell| *cell.borrow_mut() = Some(recorder));
+}
+
+/// Returns the ID of the profile open on this thread, if any.
+pub fn active() -> Option<ProfileId> {
+    ACTIVE.with(|cell| cell.borrow().as_ref().map(|r| r.id))
+}
+
+/// Notes the graph an algorithm runs on.
+pub fn note_graph(nodes: usize, edges: usize) {
+    with_active(|r| {
+        r.profile.nodes = nodes as u64;
+        r.profile.edges = edges as u64;
+    });
+}
+
+/// Notes a graph build and the graph it produced.
+pub fn note_build(elapsed: Duration, nodes: usize, edges: usize) {
+    note_graph(nodes, edges);
+    with_active(|r| r.profile.build_ns += nanos(elapsed));
+}
+
+/// Notes the number of passes of an iterative algorithm.
+pub fn note_iterations(passes: usize) {
+    with_active(|r| r.profile.iterations = passes as i64);
+}
+
+/// Notes the number of threads a parallel section ran on.
+pub fn note_threads(threads: usize) {
+    with_active(|r| r.profile.threads = r.profile.threads.max(threads as u64));
+}
+
+/// Closes the profile open on this thread and stores it as the last one of its connection.
+pub fn finish() {
+    let Some(mut recorder) = ACTIVE.with(|cell| cell.borrow_mut().take()) else {
+        return;
+    };
+    let peak = match recorder.slot {
+        Some(slot) => PEAKS[slot].load(Ordering::Relaxed),
+        None => ALLOCATED.load(Ordering::Relaxed),
+    };
+    let profile = &mut recorder.profile;
+    profile.compute_ns = nanos(recorder.started.elapsed()).saturating_sub(profile.build_ns);
+    profile.peak_bytes = peak.saturating_sub(recorder.base_bytes) as u64;
+    tracing::debug!(
+        connection = recorder.id.connection,
+        build_ns = profile.build_ns,
+        compute_ns = profile.compute_ns,
+        nodes = profile.nodes,
+        edges = profile.edges,
+        iterations = profile.iterations,
+        threads = profile.threads,
+        peak_bytes = profile.peak_bytes,
+        "onager call finished"
+    );
+    LAST.lock().insert(
+        recorder.id.connection,
+        Entry {
+            sequence: recorder.id.sequence,
+            function: String::new(),
+            profile: recorder.profile,
+        },
+    );
+}
+
+fn update(id: ProfileId, f: impl FnOnce(&mut Entry)) {
+    if let Some(entry) = LAST.lock().get_mut(&id.connection) {
+        if entry.sequence == id.sequence {
+            f(entry);
+        }
+    }
+}
+
+/// Names the function of a finished profile.
+pub fn set_function(id: ProfileId, function: &str) {
+    update(id, |e| e.function = function.to_string());
+}
+
+/// Adds the time spent emitting rows of a finished profile's result.
+pub fn note_output(id: ProfileId, elapsed_ns: u64, rows: u64) {
+    update(id, |e| {
+        e.profile.output_ns += elapsed_ns;
+        e.profile.rows += rows;
+    });
+}
+
+/// Returns the function name and profile of the last profiled call of a connection.
+pub fn last(connection: u64) -> Option<(String, OnagerProfile)> {
+    LAST.lock()
+        .get(&connection)
+        .map(|e| (e.function.clone(), e.profile))
+}
+
+/// Forgets the last profile of a connection.
+pub fn forget(connection: u64) {
+    LAST.lock().remove(&connection);
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_profile_phases() {
+        begin(u64::MAX - 1, 7);
+        let id = active().unwrap();
+        note_build(Duration::from_nanos(5), 3, 4);
+        note_iterations(12);
+        note_threads(4);
+        note_threads(2);
+        let scratch: Vec<u64> = vec![1; 1 << 16];
+        finish();
+        drop(std::hint::black_box(scratch));
+        assert!(active().is_none());
+
+        note_output(id, 9, 3);
+        set_function(id, "PageRank");
+        let (function, profile) = last(u64::MAX - 1).unwrap();
+        assert_eq!(function, "PageRank");
+        assert_eq!(profile.ingest_ns, 7);
+        assert_eq!(profile.build_ns, 5);
+        assert_eq!((profile.nodes, profile.edges), (3, 4));
+        assert_eq!(profile.iterations, 12);
+        assert_eq!(profile.threads, 4);
+        assert_eq!((profile.output_ns, profile.rows), (9, 3));
+        assert!(profile.peak_bytes >= 8 << 16);
+        forget(u64::MAX - 1);
+        assert!(last(u64::MAX - 1).is_none());
+    }
+
+    #[test]
+    fn test_stale_result_does_not_update_newer_profile() {
+        begin(u64::MAX - 2, 0);
+        let old = active().unwrap();
+        finish();
+        begin(u64::MAX - 2, 0);
+        finish();
+        note_output(old, 100, 100);
+        assert_eq!(last(u64::MAX - 2).unwrap().1.rows, 0);
+        forget(u64::MAX - 2);
+    }
+
+    #[test]
+    fn test_overlapping_call_does_not_lower_peak() {
+        begin(u64::MAX - 3, 0);
+        let scratch: Vec<u64> = vec![1; 1 << 16];
+        drop(std::hint::black_box(scratch));
+        std::thread::spawn(|| {
+            begin(u64::MAX - 4, 0);
+            finish();
+        })
+        .join()
+        .unwrap();
+        finish();
+        assert!(last(u64::MAX - 3).unwrap().1.peak_bytes >= 8 << 16);
+        forget(u64::MAX - 3);
+        forget(u64::MAX - 4);
+    }
+
+    #[test]
+    fn test_notes_without_profile_are_ignored() {
+        note_iterations(3);
+        note_threads(8);
+        finish();
+        assert!(active().is_none());
+    }
+}
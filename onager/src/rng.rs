@@ -0,0 +1,88 @@
+//! Seeded pseudo-random numbers for generators and sampling algorithms.
+//!
+//! SplitMix64 is small, fast, and fully determined by its seed, so results that
+//! depend on randomness are reproducible for a given `seed` parameter.
+
+/// SplitMix64 pseudo-random number generator.
+pub struct SplitMix64(u64);
+
+impl SplitMix64 {
+    /// Creates a generator from a seed.
+    pub fn new(seed: u64) -> Self {
+        let mut rng = SplitMix64(seed);
+        rng.next_u64();
+        rng
+    }
+
+    /// Creates an independent stream for one partition of a seeded computation.
+    pub fn for_partition(seed: u64, partition: usize) -> Self {
+        Self::new(seed ^ (partition as u64).wrapping_mul(0xD1B5_4A32_D192_ED03))
+    }
+
+    /// Returns the next 64 random bits.
+    pub fn next_u64(&mut self) -> u64 {
+        self.0 = self.0.wrapping_add(0x9E37_79B9_7F4A_7C15);
+        let mut z = self.0;
+        z = (z ^ (z >> 30)).wrapping_mul(0xBF58_476D_1CE4_E5B9);
+        z = (z ^ (z >> 27)).wrapping_mul(0x94D0_49BB_1331_11EB);
+        z ^ (z >> 31)
+    }
+
+    /// Returns a uniform value in [0, 1).
+    pub fn next_f64(&mut self) -> f64 {
+        (self.next_u64() >> 11) as f64 * (1.0 / (1u64 << 53) as f64)
+    }
+
+    /// Returns a uniform value in [0, bound).
+    pub fn below(&mut self, bound: u64) -> u64 {
+        ((self.next_u64() as u128 * bound as u128) >> 64) as u64
+    }
+
+    /// Returns `k` distinct values from [0, n) in random order, or all of them if k >= n.
+    pub fn sample(&mut self, n: usize, k: usize) -> Vec<u32> {
+        let mut values: Vec<u32> = (0..n as u32).collect();
+        let k = k.min(n);
+        for i in 0..k {
+            let j = i + self.below((n - i) as u64) as usize;
+            values.swap(i, j);
+        }
+        values.truncate(k);
+        values
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_same_seed_same_stream() {
+        let mut a = SplitMix64::new(7);
+        let mut b = SplitMix64::new(7);
+        for _ in 0..100 {
+            assert_eq!(a.next_u64(), b.next_u64());
+        }
+    }
+
+    #[test]
+    fn test_bounds() {
+        let mut rng = SplitMix64::new(1);
+        for _ in 0..1000 {
+            assert!(rng.below(10) < 10);
+            let x = rng.next_f64();
+            assert!((0.0..1.0).contains(&x));
+        }
+    }
+
+    #[test]
+    fn test_sample_is_distinct() {
+        let mut rng = SplitMix64::new(3);
+        let mut picked = rng.sample(100, 30);
+        assert_eq!(picked.len(), 30);
+        picked.sort_unstable();
+        picked.dedup();
+        assert_eq!(picked.len(), 30);
+        assert!(picked.iter().all(|&v| v < 100));
+        assert_eq!(rng.sample(5, 10).len(), 5);
+    }
+}
@@ -0,0 +1,474 @@
+//! Binary snapshots of CSR graphs.
+//!
+//! A snapshot stores the arrays of a [`CsrGraph`] as they are in memory, so a
+//! graph is reloaded without sorting, hashing, or bucketing its edges. All
+//! values are little-endian, and arrays of 4-byte values are padded with zeros
+//! to a multiple of 8 bytes, so every section starts at a multiple of 8 bytes:
+//!
+//! | Section        | Type              | Present           |
+//! |----------------|-------------------|-------------------|
+//! | magic          | `b"ONAGRCSR"`     | always            |
+//! | version        | `u32`             | always            |
+//! | flags          | `u32`             | always            |
+//! | node count `n` | `u64`             | always            |
+//! | edge count `m` | `u64`             | always            |
+//! | node IDs       | `i64 * n`         | always            |
+//! | out offsets    | `u64 * (n + 1)`   | always            |
+//! | in offsets     | `u64 * (n + 1)`   | always            |
+//! | out targets    | `u32 * m`, padded | always            |
+//! | in sources     | `u32 * m`, padded | always            |
+//! | out weights    | `f64 * m`         | if `WEIGHTED` set |
+//! | in weights     | `f64 * m`         | if `WEIGHTED` set |
+//!
+//! Weights are `f32` instead of `f64`, and padded, when `FLOAT_WEIGHTS` is also
+//! set. Version 1 files, which had no padding, are rejected.
+//!
+//! The reader checks the header against the file length and validates the
+//! arrays before building the graph, so a truncated or corrupt file is an error.
+//!
+//! On 64-bit little-endian Unix, where the file layout is the in-memory layout,
+//! the reader maps the file and the graph borrows its arrays from the mapping,
+//! so opening a snapshot copies nothing and the graph lives in the shared page
+//! cache rather than on the heap. Elsewhere each array is read into a buffer of
+//! its own, checked against the call's memory limit first. The writer writes a
+//! new file next to the snapshot and renames it into place, so a failed save
+//! leaves the previous snapshot intact and graphs mapped from it stay valid.
+
+use std::fs::File;
+use std::io::{BufReader, BufWriter, Read, Write};
+use std::mem::size_of;
+use std::path::{Path, PathBuf};
+use std::sync::atomic::{AtomicU64, Ordering};
+use std::sync::Arc;
+
+use crate::control;
+use crate::csr::{Array, CsrGraph, EdgeWeights, WeightSlice};
+use crate::error::{OnagerError, Result};
+use crate::mmap::{MappedSlice, Mapping, Plain};
+
+const MAGIC: &[u8; 8] = b"ONAGRCSR";
+const VERSION: u32 = 2;
+const HEADER_BYTES: u64 = 32;
+
+const DIRECTED: u32 = 1;
+const WEIGHTED: u32 = 2;
+const FLOAT_WEIGHTS: u32 = 4;
+
+/// Whether the arrays of a snapshot file can be borrowed as they are.
+const BORROWABLE: bool = cfg!(all(target_endian = "little", target_pointer_width = "64"));
+
+fn io_error(path: &Path, err: std::io::Error) -> OnagerError {
+    OnagerError::Io(format!("{}: {}", path.display(), err))
+}
+
+fn format_error(path: &Path, what: &str) -> OnagerError {
+    OnagerError::SerializationError(format!(
+        "{} is not a valid graph snapshot: {}",
+        path.display(),
+        what
+    ))
+}
+
+/// Returns a path next to `path` for writing its replacement to.
+fn temp_path(path: &Path) -> PathBuf {
+    static COUNTER: AtomicU64 = AtomicU64::new(0);
+    let name = path
+        .file_name()
+        .map(|n| n.to_string_lossy().into_owned())
+        .unwrap_or_default();
+    path.with_file_name(format!(
+        ".{}.{}-{}.tmp",
+        name,
+        std::process::id(),
+        COUNTER.fetch_add(1, Ordering::Relaxed)
+    ))
+}
+
+/// Writes a CSR graph to a snapshot file, replacing the file if it exists.
+///
+/// The old file is only replaced once the new one is complete.
+pub fn write(path: &Path, csr: &CsrGraph) -> Result<()> {
+    let temp = temp_path(path);
+    let written = write_file(&temp, csr).and_then(|()| std::fs::rename(&temp, path));
+    if written.is_err() {
+        let _ = std::fs::remove_file(&temp);
+    }
+    written.map_err(|e| io_error(path, e))
+}
+
+fn write_file(path: &Path, csr: &CsrGraph) -> std::io::Result<()> {
+    let (out_offsets, out_targets, out_weights) = csr.out_adjacency();
+    let (in_offsets, in_sources, in_weights) = csr.in_adjacency();
+    let mut flags = 0;
+    if csr.is_directed() {
+        flags |= DIRECTED;
+    }
+    if out_weights.is_some() && in_weights.is_some() {
+        flags |= WEIGHTED;
+    }
+    if matches!(out_weights, Some(WeightSlice::Float(_))) {
+        flags |= FLOAT_WEIGHTS;
+    }
+
+    let mut w = BufWriter::new(File::create(path)?);
+    let mut put = |bytes: &[u8]| w.write_all(bytes);
+    put(MAGIC)?;
+    put(&VERSION.to_le_bytes())?;
+    put(&flags.to_le_bytes())?;
+    put(&(csr.node_count() as u64).to_le_bytes())?;
+    put(&(csr.edge_count() as u64).to_le_bytes())?;
+    for &id in csr.ids() {
+        put(&id.to_le_bytes())?;
+    }
+    for &offset in out_offsets.iter().chain(in_offsets) {
+        put(&(offset as u64).to_le_bytes())?;
+    }
+    let pad = [0u8; 4];
+    let odd = csr.edge_count() % 2 == 1;
+    for nodes in [out_targets, in_sources] {
+        for &node in nodes {
+            put(&node.to_le_bytes())?;
+        }
+        if odd {
+            put(&pad)?;
+        }
+    }
+    match (out_weights, in_weights) {
+        (Some(WeightSlice::Double(out_w)), Some(WeightSlice::Double(in_w))) => {
+            for &weight in out_w.iter().chain(in_w) {
+                put(&weight.to_le_bytes())?;
+            }
+        }
+        (Some(WeightSlice::Float(out_w)), Some(WeightSlice::Float(in_w))) => {
+            for weights in [out_w, in_w] {
+                for &weight in weights {
+                    put(&weight.to_le_bytes())?;
+                }
+                if odd {
+                    put(&pad)?;
+                }
+            }
+        }
+        _ => {}
+    }
+    w.into_inner().map_err(|e| e.into_error())?.sync_all()
+}
+
+/// A value stored in a snapshot, as `SIZE` little-endian bytes.
+trait Stored: Plain {
+    const SIZE: usize;
+    fn decode(bytes: &[u8]) -> Self;
+}
+
+macro_rules! stored {
+    ($($t:ty => $disk:ty),*) => {$(
+        impl Stored for $t {
+            const SIZE: usize = size_of::<$disk>();
+            fn decode(bytes: &[u8]) -> Self {
+                let mut value = [0u8; size_of::<$disk>()];
+                value.copy_from_slice(bytes);
+                <$disk>::from_le_bytes(value) as $t
+            }
+        }
+    )*};
+}
+stored!(i64 => i64, usize => u64, u32 => u32, f64 => f64, f32 => f32);
+
+/// Where the arrays of a snapshot come from.
+enum Sections {
+    /// The file is mapped and arrays are borrowed by their byte offset.
+    Mapped(Arc<Mapping>, usize),
+    /// The file is read in order, starting after the header.
+    Read(BufReader<File>),
+}
+
+impl Sections {
+    /// Returns the next `count` values of the snapshot at `path`, skipping the
+    /// padding after them if `padded` is set and they take an odd multiple of 4 bytes.
+    fn next<T: Stored>(&mut self, path: &Path, count: usize, padded: bool) -> Result<Array<T>> {
+        const CHUNK: usize = 8192;
+        let bytes = count * T::SIZE;
+        let padding = if padded { bytes % 8 } else { 0 };
+        match self {
+            Sections::Mapped(mapping, offset) => {
+                let values = MappedSlice::new(mapping, *offset, count)
+                    .ok_or_else(|| format_error(path, "section is out of place"))?;
+                *offset += bytes + padding;
+                Ok(Array::Mapped(values))
+            }
+            Sections::Read(reader) => {
+                control::reserve(
+                    &format!("reading {}", path.display()),
+                    count * size_of::<T>(),
+                )?;
+                let mut values = Vec::with_capacity(count);
+                let mut chunk = vec![0u8; T::SIZE * CHUNK.min(count)];
+                let read = (|| {
+                    while values.len() < count {
+                        let take = (count - values.len()).min(CHUNK) * T::SIZE;
+                        reader.read_exact(&mut chunk[..take])?;
+                        values.extend(chunk[..take].chunks_exact(T::SIZE).map(T::decode));
+                    }
+                    reader.read_exact(&mut [0u8; 8][..padding])
+                })();
+                read.map_err(|e| io_error(path, e))?;
+                Ok(Array::Owned(values))
+            }
+        }
+    }
+}
+
+/// Reads a CSR graph from a snapshot file written by [`write`].
+pub fn read(path: &Path) -> Result<CsrGraph> {
+    read_from(path, BORROWABLE)
+}
+
+/// Reads a snapshot, borrowing its arrays from a memory map if `map` is set and the file can be mapped.
+fn read_from(path: &Path, map: bool) -> Result<CsrGraph> {
+    let mut file = File::open(path).map_err(|e| io_error(path, e))?;
+    let file_len = file.metadata().map_err(|e| io_error(path, e))?.len();
+
+    let mut header = [0u8; HEADER_BYTES as usize];
+    if file_len < HEADER_BYTES {
+        return Err(format_error(path, "file is too short"));
+    }
+    file.read_exact(&mut header)
+        .map_err(|e| io_error(path, e))?;
+    let word = |at: usize| {
+        u32::from_le_bytes([header[at], header[at + 1], header[at + 2], header[at + 3]])
+    };
+    let count = |at: usize| {
+        let mut bytes = [0u8; 8];
+        bytes.copy_from_slice(&header[at..at + 8]);
+        u64::from_le_bytes(bytes)
+    };
+    if &header[..8] != MAGIC {
+        return Err(format_error(path, "bad magic"));
+    }
+    let version = word(8);
+    if version != VERSION {
+        return Err(format_error(
+            path,
+            &format!("unsupported version {} (expected {})", version, VERSION),
+        ));
+    }
+    let flags = word(12);
+    let (n, m) = (count(16), count(24));
+    let weighted = flags & WEIGHTED != 0;
+    let float = weighted && flags & FLOAT_WEIGHTS != 0;
+    let expected = (|| {
+        let ids = n.checked_mul(8)?;
+        let offsets = n.checked_add(1)?.checked_mul(16)?;
+        // Each 4-byte section takes m rounded up to even values
+        let padded = m.checked_add(m % 2)?.checked_mul(8)?;
+        let weights = match (weighted, float) {
+            (false, _) => 0,
+            (true, false) => m.checked_mul(16)?,
+            (true, true) => padded,
+        };
+        HEADER_BYTES
+            .checked_add(ids)?
+            .checked_add(offsets)?
+            .checked_add(padded)?
+            .checked_add(weights)
+    })();
+    if expected != Some(file_len) {
+        return Err(format_error(path, "file length does not match its header"));
+    }
+    let (n, m) = (n as usize, m as usize);
+
+    let mapping = match map {
+        true => usize::try_from(file_len)
+            .ok()
+            .and_then(|len| Mapping::new(&file, len).ok().flatten()),
+        false => None,
+    };
+    let mut sections = match mapping {
+        Some(mapping) => Sections::Mapped(Arc::new(mapping), HEADER_BYTES as usize),
+        None => Sections::Read(BufReader::new(file)),
+    };
+    let ids = sections.next(path, n, false)?;
+    let out_offsets = sections.next(path, n + 1, false)?;
+    let in_offsets = sections.next(path, n + 1, false)?;
+    let out_targets = sections.next(path, m, true)?;
+    let in_sources = sections.next(path, m, true)?;
+    let (out_weights, in_weights) = match (weighted, float) {
+        (false, _) => (None, None),
+        (true, false) => (
+            Some(EdgeWeights::Double(sections.next(path, m, false)?)),
+            Some(EdgeWeights::Double(sections.next(path, m, false)?)),
+        ),
+        (true, true) => (
+            Some(EdgeWeights::Float(sections.next(path, m, true)?)),
+            Some(EdgeWeights::Float(sections.next(path, m, true)?)),
+        ),
+    };
+    let outgoing = (out_offsets, out_targets, out_weights);
+    let incoming = (in_offsets, in_sources, in_weights);
+    CsrGraph::from_parts(flags & DIRECTED != 0, ids, outgoing, incoming)
+        .map_err(|e| format_error(path, &e.to_string()))
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    fn roundtrip(csr: &CsrGraph) -> CsrGraph {
+        let dir = tempfile::tempdir().unwrap();
+        let path = dir.path().join("graph.onager");
+        write(&path, csr).unwrap();
+        read(&path).unwrap()
+    }
+
+    #[test]
+    fn test_snapshot_roundtrip() {
+        let csr = CsrGraph::from_nodes_and_edges(
+            &[99],
+            &[10, 20, 10, 30],
+            &[20, 30, 30, 10],
+            Some(&[0.5, 1.0, 2.0, 4.0]),
+            true,
+        )
+        .unwrap();
+        let loaded = roundtrip(&csr);
+        assert!(loaded.is_directed());
+        assert_eq!(loaded.ids(), csr.ids());
+        assert_eq!(loaded.out_adjacency(), csr.out_adjacency());
+        assert_eq!(loaded.in_adjacency(), csr.in_adjacency());
+        assert_eq!(loaded.dense_id(99), Some(3));
+
+        let float = CsrGraph::from_parts(
+            false,
+            vec![1, 2, 3].into(),
+            (
+                vec![0, 1, 2, 2].into(),
+                vec![1, 2].into(),
+                Some(EdgeWeights::Float(vec![0.25, 3.5].into())),
+            ),
+            (
+                vec![0, 0, 1, 2].into(),
+                vec![0, 1].into(),
+                Some(EdgeWeights::Float(vec![0.25, 3.5].into())),
+            ),
+        )
+        .unwrap();
+        let loaded = roundtrip(&float);
+        assert_eq!(loaded.out_adjacency(), float.out_adjacency());
+        assert_eq!(loaded.in_weights(2), Some(WeightSlice::Float(&[3.5])));
+
+        // An odd edge count pads every 4-byte section
+        let odd = CsrGraph::from_parts(
+            true,
+            vec![1, 2].into(),
+            (
+                vec![0, 1, 1].into(),
+                vec![1].into(),
+                Some(EdgeWeights::Float(vec![1.5].into())),
+            ),
+            (
+                vec![0, 0, 1].into(),
+                vec![0].into(),
+                Some(EdgeWeights::Float(vec![1.5].into())),
+            ),
+        )
+        .unwrap();
+        let dir = tempfile::tempdir().unwrap();
+        let path = dir.path().join("odd.onager");
+        write(&path, &odd).unwrap();
+        let len = std::fs::metadata(&path).unwrap().len();
+        assert_eq!(len, HEADER_BYTES + 2 * 8 + 2 * 3 * 8 + 4 * 8);
+        let loaded = read(&path).unwrap();
+        assert_eq!(loaded.in_adjacency(), odd.in_adjacency());
+        assert_eq!(loaded.out_weights(0), Some(WeightSlice::Float(&[1.5])));
+
+        let unweighted = CsrGraph::from_edges(&[1, 2], &[2, 3], None, false).unwrap();
+        let loaded = roundtrip(&unweighted);
+        assert!(!loaded.is_directed());
+        assert_eq!(loaded.out_weights(0), None);
+        assert_eq!(loaded.neighbors(1).collect::<Vec<_>>(), vec![2, 0]);
+    }
+
+    #[test]
+    fn test_snapshot_rejects_bad_files() {
+        let dir = tempfile::tempdir().unwrap();
+        let csr = CsrGraph::from_edges(&[1, 2], &[2, 3], Some(&[1.0, 2.0]), true).unwrap();
+        let path = dir.path().join("graph.onager");
+        write(&path, &csr).unwrap();
+        let bytes = std::fs::read(&path).unwrap();
+
+        let bad = dir.path().join("bad.onager");
+        std::fs::write(&bad, &bytes[..bytes.len() - 1]).unwrap();
+        assert!(read(&bad).unwrap_err().to_string().contains("file length"));
+
+        let mut wrong_version = bytes.clone();
+        wrong_version[8] = 9;
+        std::fs::write(&bad, &wrong_version).unwrap();
+        assert!(read(&bad).unwrap_err().to_string().contains("version 9"));
+
+        let mut bad_magic = bytes.clone();
+        bad_magic[0] = b'X';
+        std::fs::write(&bad, &bad_magic).unwrap();
+        assert!(read(&bad).unwrap_err().to_string().contains("magic"));
+
+        // Point the first out target past the last node
+        let mut bad_target = bytes.clone();
+        let targets = (HEADER_BYTES + 3 * 8 + 2 * 4 * 8) as usize;
+        bad_target[targets..targets + 4].copy_from_slice(&7u32.to_le_bytes());
+        std::fs::write(&bad, &bad_target).unwrap();
+        assert!(read(&bad).is_err());
+
+        assert!(read(&dir.path().join("missing.onager")).is_err());
+    }
+
+    #[test]
+    fn test_snapshot_read_without_mapping() {
+        let dir = tempfile::tempdir().unwrap();
+        let path = dir.path().join("graph.onager");
+        let csr =
+            CsrGraph::from_edges(&[1, 2, 3], &[2, 3, 1], Some(&[0.5, 1.5, 2.5]), true).unwrap();
+        write(&path, &csr).unwrap();
+        let loaded = read_from(&path, false).unwrap();
+        assert_eq!(loaded.out_adjacency(), csr.out_adjacency());
+        assert_eq!(loaded.in_adjacency(), csr.in_adjacency());
+
+        // Reading counts against the call's memory limit, and mapping does not
+        control::begin(control::OnagerCallControl {
+            interrupted: None,
+            progress: None,
+            data: std::ptr::null_mut(),
+            threads: 0,
+            memory_limit: 0,
+            float_weights: false,
+        });
+        let copied = read_from(&path, false);
+        let mapped = read_from(&path, true);
+        control::finish();
+        assert!(matches!(copied, Err(OnagerError::OutOfMemory(_))));
+        if BORROWABLE && cfg!(unix) {
+            assert_eq!(mapped.unwrap().out_adjacency(), csr.out_adjacency());
+        }
+    }
+
+    #[test]
+    fn test_snapshot_write_replaces_file_whole() {
+        let dir = tempfile::tempdir().unwrap();
+        let path = dir.path().join("graph.onager");
+        let first = CsrGraph::from_edges(&[1, 2], &[2, 3], None, true).unwrap();
+        let second = CsrGraph::from_edges(&[5], &[6], None, false).unwrap();
+        write(&path, &first).unwrap();
+        let opened = read(&path).unwrap();
+        write(&path, &second).unwrap();
+        assert_eq!(opened.ids(), &[1, 2, 3]);
+        assert_eq!(opened.out_adjacency(), first.out_adjacency());
+        assert_eq!(read(&path).unwrap().ids(), &[5, 6]);
+        assert_eq!(std::fs::read_dir(dir.path()).unwrap().count(), 1);
+
+        // A save that cannot be put in place leaves no partial file behind
+        let taken = dir.path().join("taken");
+        std::fs::create_dir(&taken).unwrap();
+        std::fs::write(taken.join("file"), b"x").unwrap();
+        assert!(write(&taken, &first).is_err());
+        assert_eq!(std::fs::read_dir(dir.path()).unwrap().count(), 2);
+        assert!(taken.join("file").exists());
+    }
+}
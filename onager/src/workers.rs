@@ -0,0 +1,287 @@
+//! Block-parallel helpers for the native CSR engines.
+//!
+//! Work over an index range is split into fixed-size blocks that scoped worker
+//! threads claim from a shared counter. Each worker keeps its own scratch state,
+//! and results come back in block order, so the output does not depend on the
+//! number of threads or on scheduling. Reductions over per-worker state go
+//! through [`fold_blocks`], in-place updates of disjoint slices go through
+//! [`for_each_chunk_mut`], and caller-made parts of uneven size go through
+//! [`map_parts`]. Workers run with the call control of the thread that started
+//! them, so code in a block can poll for interruption.
+//!
+//! The number of workers is the thread budget of the current call, which C++
+//! sets from DuckDB's `threads` setting or `onager_threads`, and one per core
+//! outside a call. A helper called from inside a worker runs on that worker
+//! alone, so nested parallel sections never start more threads than the budget.
+
+use std::cell::Cell;
+use std::ops::Range;
+use std::sync::atomic::{AtomicUsize, Ordering};
+
+use parking_lot::Mutex;
+
+use crate::control;
+use crate::profile;
+
+thread_local! {
+    static IN_WORKER: Cell<bool> = const { Cell::new(false) };
+}
+
+/// Returns the number of worker threads to use.
+///
+/// This is 1 on a worker thread, the thread budget of the current call if C++
+/// set one, and the number of cores otherwise.
+pub fn worker_count() -> usize {
+    if IN_WORKER.with(Cell::get) {
+        return 1;
+    }
+    control::threads().unwrap_or_else(|| {
+        std::thread::available_parallelism()
+            .map(|n| n.get())
+            .unwrap_or(1)
+    })
+}
+
+/// Runs the body of one worker thread with the control of its call.
+fn run_worker<R>(call: Option<control::Control>, f: impl FnOnce() -> R) -> R {
+    IN_WORKER.with(|w| w.set(true));
+    control::scope(call, f)
+}
+
+/// Applies `f` to every block of `0..len` and returns the results in block order.
+///
+/// `init` creates the scratch state of one worker, which `f` receives for every
+/// block that worker processes. A panic in a worker is propagated to the caller.
+pub fn map_blocks<S, T>(
+    len: usize,
+    block: usize,
+    init: impl Fn() -> S + Sync,
+    f: impl Fn(&mut S, Range<usize>) -> T + Sync,
+) -> Vec<T>
+where
+    S: Send,
+    T: Send,
+{
+    let block = block.max(1);
+    let workers = fold_blocks(
+        len,
+        block,
+        || (init(), Vec::new()),
+        |(scratch, out), range| {
+            let b = range.start / block;
+            out.push((b, f(scratch, range)));
+        },
+    );
+    let mut parts: Vec<(usize, T)> = workers.into_iter().flat_map(|(_, out)| out).collect();
+    parts.sort_unstable_by_key(|(b, _)| *b);
+    parts.into_iter().map(|(_, t)| t).collect()
+}
+
+/// Folds every block of `0..len` into per-worker state and returns one state per worker.
+///
+/// Callers reduce the returned states themselves. Which blocks a worker sees depends
+/// on scheduling, so floating-point reductions may differ in the last bits between runs.
+pub fn fold_blocks<S>(
+    len: usize,
+    block: usize,
+    init: impl Fn() -> S + Sync,
+    f: impl Fn(&mut S, Range<usize>) + Sync,
+) -> Vec<S>
+where
+    S: Send,
+{
+    let block = block.max(1);
+    let blocks = len.div_ceil(block);
+    let range = |b: usize| b * block..((b + 1) * block).min(len);
+    let workers = worker_count().min(blocks);
+    profile::note_threads(workers);
+    if workers <= 1 {
+        let mut state = init();
+        for b in 0..blocks {
+            f(&mut state, range(b));
+        }
+        return vec![state];
+    }
+
+    let next = AtomicUsize::new(0);
+    let call = control::current();
+    std::thread::scope(|scope| {
+        let handles: Vec<_> = (0..workers)
+            .map(|_| {
+                let call = call.clone();
+                scope.spawn(|| {
+                    run_worker(call, || {
+                        let mut state = init();
+                        loop {
+                            let b = next.fetch_add(1, Ordering::Relaxed);
+                            if b >= blocks {
+                                break;
+                            }
+                            f(&mut state, range(b));
+                        }
+                        state
+                    })
+                })
+            })
+            .collect();
+        handles
+            .into_iter()
+            .map(|h| match h.join() {
+                Ok(state) => state,
+                Err(payload) => std::panic::resume_unwind(payload),
+            })
+            .collect()
+    })
+}
+
+/// Applies `f` to every `chunk`-sized slice of `data` with exclusive access.
+///
+/// `f` receives the chunk index and the chunk, and chunks are handed out to
+/// worker threads in order. A panic in a worker is propagated to the caller.
+pub fn for_each_chunk_mut<T>(data: &mut [T], chunk: usize, f: impl Fn(usize, &mut [T]) + Sync)
+where
+    T: Send,
+{
+    let parts: Vec<_> = data.chunks_mut(chunk.max(1)).enumerate().collect();
+    map_parts(parts, |(i, part)| f(i, part));
+}
+
+/// Applies `f` to every part and returns the results in part order.
+///
+/// Parts are handed out to worker threads in order, so callers that split their
+/// data unevenly (for example by edge count) still get dynamic load balancing.
+/// A panic in a worker is propagated to the caller.
+pub fn map_parts<P, R>(parts: Vec<P>, f: impl Fn(P) -> R + Sync) -> Vec<R>
+where
+    P: Send,
+    R: Send,
+{
+    let count = parts.len();
+    let workers = worker_count().min(count);
+    profile::note_threads(workers);
+    if workers <= 1 {
+        return parts.into_iter().map(f).collect();
+    }
+
+    let queue = Mutex::new(parts.into_iter().enumerate());
+    let call = control::current();
+    let mut results: Vec<(usize, R)> = std::thread::scope(|scope| {
+        let handles: Vec<_> = (0..workers)
+            .map(|_| {
+                let call = call.clone();
+                scope.spawn(|| {
+                    run_worker(call, || {
+                        let mut done = Vec::new();
+                        loop {
+                            let next = queue.lock().next();
+                            match next {
+                                Some((i, part)) => done.push((i, f(part))),
+                                None => break done,
+                            }
+                        }
+                    })
+                })
+            })
+            .collect();
+        handles
+            .into_iter()
+            .flat_map(|h| match h.join() {
+                Ok(done) => done,
+                Err(payload) => std::panic::resume_unwind(payload),
+            })
+            .collect()
+    });
+    results.sort_unstable_by_key(|(i, _)| *i);
+    results.into_iter().map(|(_, r)| r).collect()
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_blocks_cover_range_in_order() {
+        let ranges = map_blocks(10_000, 37, || (), |_, r| r);
+        assert_eq!(ranges.len(), 10_000usize.div_ceil(37));
+        let flat: Vec<usize> = ranges.into_iter().flatten().collect();
+        assert_eq!(flat, (0..10_000).collect::<Vec<_>>());
+    }
+
+    #[test]
+    fn test_empty_range() {
+        let out: Vec<usize> = map_blocks(0, 8, || (), |_, r| r.len());
+        assert!(out.is_empty());
+    }
+
+    #[test]
+    fn test_scratch_is_reused_per_worker() {
+        let sums = map_blocks(1000, 10, Vec::<usize>::new, |scratch, r| {
+            scratch.clear();
+            scratch.extend(r);
+            scratch.iter().sum::<usize>()
+        });
+        assert_eq!(sums.iter().sum::<usize>(), (0..1000).sum::<usize>());
+    }
+
+    #[test]
+    fn test_fold_blocks_visits_every_index_once() {
+        let states = fold_blocks(
+            5000,
+            64,
+            || vec![0u8; 5000],
+            |seen, r| {
+                for i in r {
+                    seen[i] += 1;
+                }
+            },
+        );
+        let mut total = vec![0u8; 5000];
+        for seen in states {
+            for (t, s) in total.iter_mut().zip(seen) {
+                *t += s;
+            }
+        }
+        assert!(total.iter().all(|&c| c == 1));
+    }
+
+    #[test]
+    fn test_for_each_chunk_mut_writes_every_chunk() {
+        let mut data = vec![0usize; 1001];
+        for_each_chunk_mut(&mut data, 10, |i, part| {
+            for x in part.iter_mut() {
+                *x = i;
+            }
+        });
+        assert!(data.iter().enumerate().all(|(j, &x)| x == j / 10));
+    }
+
+    #[test]
+    fn test_nested_sections_run_on_their_worker() {
+        let counts = map_parts((0..64).collect(), |_| worker_count());
+        if worker_count() > 1 {
+            assert!(counts.iter().all(|&n| n == 1));
+        }
+
+        let two = control::OnagerCallControl {
+            interrupted: None,
+            progress: None,
+            data: std::ptr::null_mut(),
+            threads: 2,
+            memory_limit: u64::MAX,
+            float_weights: false,
+        };
+        control::begin(two);
+        assert_eq!(worker_count(), 2);
+        let states = fold_blocks(1000, 1, || (), |_, _| ());
+        assert!(states.len() <= 2);
+        control::finish();
+    }
+
+    #[test]
+    fn test_map_parts_keeps_part_order() {
+        let parts: Vec<usize> = (0..1000).map(|i| (i * 7919) % 1000).collect();
+        let out = map_parts(parts.clone(), |p| p * 2);
+        assert_eq!(out, parts.iter().map(|p| p * 2).collect::<Vec<_>>());
+        assert!(map_parts(Vec::<usize>::new(), |p| p).is_empty());
+    }
+}
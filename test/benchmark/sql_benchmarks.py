@@ -0,0 +1,171 @@
+#!/usr/bin/env python3
+"""End-to-end benchmarks of Onager table functions in the DuckDB shell.
+
+Every function runs on generated Barabasi-Albert graphs of several sizes, once
+per DuckDB thread count. The wall time of each call is taken from the shell's
+timer, and the ingest, build, compute, and output phases of the same call are
+read from `onager_last_profile()`. The report is written as one JSON document.
+
+Usage:
+    python3 test/benchmark/sql_benchmarks.py --output results.json
+"""
+
+import argparse
+import json
+import os
+import re
+import statistics
+import subprocess
+import sys
+import tempfile
+
+SEED = 42
+
+# Benchmark name -> query over an edge table, with `{edges}` as the edge subquery.
+BENCHMARKS = {
+    "pagerank": "select * from onager_ctr_pagerank({edges})",
+    "par_pagerank": "select * from onager_par_pagerank({edges})",
+    "degree": "select * from onager_ctr_degree({edges})",
+    "betweenness": "select * from onager_ctr_betweenness({edges}, samples := 64, seed := 42)",
+    "louvain": "select * from onager_cmm_louvain({edges}, seed := 42)",
+    "components": "select * from onager_cmm_components({edges})",
+    "kcore": "select * from onager_cmm_kcore({edges})",
+    "triangles": "select * from onager_mtr_triangles({edges})",
+    "bfs": "select * from onager_trv_bfs({edges}, source := 0)",
+}
+
+TIMER = re.compile(r"^Run Time \(s\): real ([0-9.]+)")
+
+
+def parse_list(text, kind):
+    return [kind(item) for item in text.split(",") if item.strip()]
+
+
+def run_shell(duckdb, database, script):
+    """Runs a script in the DuckDB shell and returns its timer readings and JSON results."""
+    proc = subprocess.run(
+        [duckdb, "-json", database],
+        input=script,
+        capture_output=True,
+        text=True,
+        check=False,
+    )
+    if proc.returncode != 0 or proc.stderr.strip():
+        raise RuntimeError(f"duckdb failed: {proc.stderr.strip()}")
+
+    timings, body = [], []
+    for line in proc.stdout.splitlines():
+        match = TIMER.match(line)
+        if match:
+            timings.append(float(match.group(1)) * 1e3)
+        else:
+            body.append(line)
+    text, results, decoder, pos = "\n".join(body), [], json.JSONDecoder(), 0
+    while True:
+        while pos < len(text) and text[pos].isspace():
+            pos += 1
+        if pos >= len(text):
+            break
+        value, pos = decoder.raw_decode(text, pos)
+        results.append(value)
+    return timings, results
+
+
+def create_graphs(duckdb, database, sizes):
+    script = "".join(
+        f"create or replace table edges_{n} as "
+        f"select src, dst from onager_gen_barabasi_albert({n}, 4, seed := {SEED});\n"
+        for n in sizes
+    )
+    script += "".join(
+        f"select {n} as size, count(*) as edges, "
+        f"(select count(*) from (select src from edges_{n} union select dst from edges_{n})) as nodes "
+        f"from edges_{n};\n"
+        for n in sizes
+    )
+    _, results = run_shell(duckdb, database, script)
+    return {row[0]["size"]: row[0] for row in results}
+
+
+def summarize(values):
+    return {
+        "min": min(values),
+        "median": statistics.median(values),
+        "mean": statistics.fmean(values),
+    }
+
+
+def run_benchmark(duckdb, database, query, threads, samples, warmup):
+    # Counting the rows keeps the result out of the shell's output, while the
+    # function still emits every row.
+    call = f"select count(*) as rows from ({query});\nselect * from onager_last_profile();\n"
+    script = f"set threads = {threads};\n.timer on\n" + call * (warmup + samples)
+    timings, results = run_shell(duckdb, database, script)
+    # The timer reports one reading per statement: the query, then its profile.
+    walls = timings[0::2][warmup:]
+    profiles = [rows[0] for rows in results[1::2]][warmup:]
+    if len(walls) != samples or len(profiles) != samples:
+        raise RuntimeError("unexpected duckdb output")
+    last = profiles[-1]
+    return {
+        "wall_ms": summarize(walls),
+        **{
+            phase: statistics.median(p[phase] for p in profiles)
+            for phase in ("ingest_ms", "build_ms", "compute_ms", "output_ms")
+        },
+        "iterations": last["iterations"],
+        "onager_threads": last["threads"],
+        "peak_bytes": last["peak_bytes"],
+        "rows": last["rows"],
+    }
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--duckdb", default="build/release/duckdb", help="DuckDB shell with Onager linked in")
+    parser.add_argument("--sizes", default="1000,10000,100000", help="comma-separated node counts")
+    parser.add_argument("--threads", default="1,4,16", help="comma-separated DuckDB thread counts")
+    parser.add_argument("--samples", type=int, default=5, help="timed runs per benchmark")
+    parser.add_argument("--warmup", type=int, default=1, help="untimed runs per benchmark")
+    parser.add_argument("--filter", default="", help="only run benchmarks whose name contains this string")
+    parser.add_argument("--output", help="file to write the report to instead of stdout")
+    args = parser.parse_args()
+
+    if not os.path.exists(args.duckdb):
+        sys.exit(f"{args.duckdb} not found, build the extension with `make release` first")
+    if args.samples <= 0:
+        sys.exit("--samples must be > 0")
+    sizes = parse_list(args.sizes, int)
+    thread_counts = parse_list(args.threads, int)
+
+    results = []
+    with tempfile.TemporaryDirectory() as tmp:
+        database = os.path.join(tmp, "bench.duckdb")
+        graphs = create_graphs(args.duckdb, database, sizes)
+        for name, template in BENCHMARKS.items():
+            if args.filter not in name:
+                continue
+            for n in sizes:
+                query = template.format(edges=f"(select src, dst from edges_{n})")
+                for threads in thread_counts:
+                    measured = run_benchmark(args.duckdb, database, query, threads, args.samples, args.warmup)
+                    print(f"{name}/{n}/{threads}: median {measured['wall_ms']['median']:.3f} ms", file=sys.stderr)
+                    results.append({
+                        "benchmark": name,
+                        "graph": f"barabasi_albert_{n}",
+                        "nodes": graphs[n]["nodes"],
+                        "edges": graphs[n]["edges"],
+                        "threads": threads,
+                        **measured,
+                    })
+
+    report = json.dumps({"suite": "sql", "samples": args.samples, "results": results}, indent=2)
+    if args.output:
+        with open(args.output, "w") as f:
+            f.write(report + "\n")
+    else:
+        print(report)
+
+
+if __name__ == "__main__":
+    main()